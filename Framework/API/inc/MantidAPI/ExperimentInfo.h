@@ -15,6 +15,8 @@
 #include "MantidKernel/V3D.h"
 #include "MantidKernel/cow_ptr.h"
 
+#include <atomic>
+#include <memory>
 #include <mutex>
 
 namespace Mantid {
@@ -38,6 +40,7 @@ class XMLInstrumentParameter;
 namespace API {
 class Run;
 class Sample;
+class SpectrumGeometry;
 class SpectrumInfo;
 
 /** This class is shared by a few Workspace types
@@ -152,6 +155,7 @@ public:
 
   const SpectrumInfo &spectrumInfo() const;
   SpectrumInfo &mutableSpectrumInfo();
+  std::shared_ptr<const SpectrumGeometry> spectrumGeometry() const;
 
   const Geometry::ComponentInfo &componentInfo() const;
   Geometry::ComponentInfo &mutableComponentInfo();
@@ -213,6 +217,10 @@ private:
   // This vector stores boolean flags but uses char to do so since
   // std::vector<bool> is not thread-safe.
   mutable std::vector<char> m_spectrumDefinitionNeedsUpdate;
+
+  mutable std::shared_ptr<const SpectrumGeometry> m_spectrumGeometry;
+  mutable std::atomic<bool> m_spectrumGeometryValid{false};
+  mutable std::mutex m_spectrumGeometryMutex;
 };
 
 /// Shared pointer to ExperimentInfo
@@ -0,0 +1,81 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidAPI/DllConfig.h"
+#include "MantidKernel/V3D.h"
+
+#include <vector>
+
+namespace Mantid {
+namespace API {
+class SpectrumInfo;
+
+/** SpectrumGeometry : an immutable snapshot of the geometry of every spectrum
+  of a workspace, held in contiguous arrays.
+
+  The values are those returned by SpectrumInfo, averaged over the detectors
+  of each spectrum, but computed once, in parallel, so that loops over the
+  spectra read them from flat arrays instead of going through SpectrumInfo,
+  DetectorInfo and the beamline layers for every call.
+
+  Where SpectrumInfo would throw, for spectra without detectors or for the
+  angles of monitors, the values are NaN and the flags are false. DIFC is the
+  uncalibrated value, without offsets.
+
+  The snapshot of a workspace is obtained from ExperimentInfo::spectrumGeometry,
+  which shares it until the instrument, its parameters or the detector grouping
+  are changed.
+*/
+class MANTID_API_DLL SpectrumGeometry {
+public:
+  explicit SpectrumGeometry(const SpectrumInfo &spectrumInfo);
+
+  /// @return the number of spectra
+  size_t size() const { return m_l2.size(); }
+
+  /// @return the source-sample distance
+  double l1() const { return m_l1; }
+  const Kernel::V3D &sourcePosition() const { return m_sourcePosition; }
+  const Kernel::V3D &samplePosition() const { return m_samplePosition; }
+
+  /// Flags of each spectrum, stored as char rather than bool
+  const std::vector<char> &hasDetectors() const { return m_hasDetectors; }
+  const std::vector<char> &hasUniqueDetector() const {
+    return m_hasUniqueDetector;
+  }
+  const std::vector<char> &isMonitor() const { return m_isMonitor; }
+  const std::vector<char> &isMasked() const { return m_isMasked; }
+
+  /// Geometry of each spectrum, distances in metres and angles in radians
+  const std::vector<double> &l2() const { return m_l2; }
+  const std::vector<double> &twoTheta() const { return m_twoTheta; }
+  const std::vector<double> &signedTwoTheta() const {
+    return m_signedTwoTheta;
+  }
+  const std::vector<double> &azimuthal() const { return m_azimuthal; }
+  const std::vector<double> &difc() const { return m_difc; }
+  const std::vector<Kernel::V3D> &position() const { return m_position; }
+
+private:
+  double m_l1;
+  Kernel::V3D m_sourcePosition;
+  Kernel::V3D m_samplePosition;
+  std::vector<char> m_hasDetectors;
+  std::vector<char> m_hasUniqueDetector;
+  std::vector<char> m_isMonitor;
+  std::vector<char> m_isMasked;
+  std::vector<double> m_l2;
+  std::vector<double> m_twoTheta;
+  std::vector<double> m_signedTwoTheta;
+  std::vector<double> m_azimuthal;
+  std::vector<double> m_difc;
+  std::vector<Kernel::V3D> m_position;
+};
+
+} // namespace API
+} // namespace Mantid
@@ -10,6 +10,7 @@
 #include "MantidAPI/ResizeRectangularDetectorHelper.h"
 #include "MantidAPI/Run.h"
 #include "MantidAPI/Sample.h"
+#include "MantidAPI/SpectrumGeometry.h"
 #include "MantidAPI/SpectrumInfo.h"
 
 #include "MantidGeometry/Crystal/OrientedLattice.h"
@@ -19,6 +20,7 @@
 #include "MantidGeometry/Instrument/ComponentInfo.h"
 #include "MantidGeometry/Instrument/Detector.h"
 #include "MantidGeometry/Instrument/DetectorInfo.h"
+#include "MantidGeometry/Instrument/InstrumentCache.h"
 #include "MantidGeometry/Instrument/InstrumentDefinitionParser.h"
 #include "MantidGeometry/Instrument/ParComponentFactory.h"
 #include "MantidGeometry/Instrument/ParameterFactory.h"
@@ -183,6 +185,7 @@ void checkDetectorInfoSize(const Instrument &instr,
  */
 void ExperimentInfo::setInstrument(const Instrument_const_sptr &instr) {
   m_spectrumInfoWrapper = nullptr;
+  m_spectrumGeometryValid = false;
 
   // Detector IDs that were previously dropped because they were not part of the
   // instrument may now suddenly be valid, so we have to reinitialize the
@@ -221,6 +224,7 @@ Instrument_const_sptr ExperimentInfo::getInstrument() const {
  */
 Geometry::ParameterMap &ExperimentInfo::instrumentParameters() {
   populateIfNotLoaded();
+  m_spectrumGeometryValid = false;
   return *m_parmap;
 }
 
@@ -456,6 +460,7 @@ void ExperimentInfo::setNumberOfDetectorGroups(const size_t count) const {
   m_spectrumDefinitionNeedsUpdate.resize(count, 1);
   m_spectrumInfo = std::make_unique<Beamline::SpectrumInfo>(count);
   m_spectrumInfoWrapper = nullptr;
+  m_spectrumGeometryValid = false;
 }
 
 /** Returns the number of detector groups.
@@ -792,6 +797,7 @@ const Geometry::DetectorInfo &ExperimentInfo::detectorInfo() const {
 /** Return a non-const reference to the DetectorInfo object. */
 Geometry::DetectorInfo &ExperimentInfo::mutableDetectorInfo() {
   populateIfNotLoaded();
+  m_spectrumGeometryValid = false;
   return m_parmap->mutableDetectorInfo();
 }
 
@@ -849,15 +855,36 @@ const SpectrumInfo &ExperimentInfo::spectrumInfo() const {
 /** Return a non-const reference to the SpectrumInfo object. Not thread safe.
  */
 SpectrumInfo &ExperimentInfo::mutableSpectrumInfo() {
+  m_spectrumGeometryValid = false;
   return const_cast<SpectrumInfo &>(
       static_cast<const ExperimentInfo &>(*this).spectrumInfo());
 }
 
+/** Return a snapshot of the geometry of all spectra.
+ *
+ * The snapshot is built on first use and shared until the instrument, its
+ * parameters or the detector grouping are modified through this class, i.e.,
+ * by a call to a non-const accessor such as mutableDetectorInfo or
+ * mutableSpectrumInfo. Changes made later through references obtained from
+ * such accessors beforehand are not seen.
+ */
+std::shared_ptr<const SpectrumGeometry>
+ExperimentInfo::spectrumGeometry() const {
+  const auto &info = spectrumInfo();
+  std::lock_guard<std::mutex> lock{m_spectrumGeometryMutex};
+  if (!m_spectrumGeometryValid || !m_spectrumGeometry) {
+    m_spectrumGeometry = std::make_shared<const SpectrumGeometry>(info);
+    m_spectrumGeometryValid = true;
+  }
+  return m_spectrumGeometry;
+}
+
 const Geometry::ComponentInfo &ExperimentInfo::componentInfo() const {
   return m_parmap->componentInfo();
 }
 
 ComponentInfo &ExperimentInfo::mutableComponentInfo() {
+  m_spectrumGeometryValid = false;
   return m_parmap->mutableComponentInfo();
 }
 
@@ -875,6 +902,7 @@ void ExperimentInfo::setSpectrumDefinitions(
     invalidateAllSpectrumDefinitions();
   }
   m_spectrumInfoWrapper = nullptr;
+  m_spectrumGeometryValid = false;
 }
 
 /** Notifies the ExperimentInfo that a spectrum definition has changed.
@@ -886,6 +914,7 @@ void ExperimentInfo::invalidateSpectrumDefinition(const size_t index) {
   // This uses a vector of char, such that flags for different indices can be
   // set from different threads (std::vector<bool> is not thread-safe).
   m_spectrumDefinitionNeedsUpdate.at(index) = 1;
+  m_spectrumGeometryValid = false;
 }
 
 void ExperimentInfo::updateSpectrumDefinitionIfNecessary(
@@ -921,6 +950,7 @@ void ExperimentInfo::cacheDefaultDetectorGrouping() const {
 void ExperimentInfo::invalidateAllSpectrumDefinitions() {
   std::fill(m_spectrumDefinitionNeedsUpdate.begin(),
             m_spectrumDefinitionNeedsUpdate.end(), 1);
+  m_spectrumGeometryValid = false;
 }
 
 /** Save the object to an open NeXus file.
@@ -1117,8 +1147,9 @@ void ExperimentInfo::setInstumentFromXML(const std::string &nxFilename,
       // If it does, just use the one from the one stored there
       instr = InstrumentDataService::Instance().retrieve(instrumentNameMangled);
     } else {
-      // Really create the instrument
-      instr = parser.parseXML(nullptr);
+      // Really create the instrument, or rebuild it from the cache
+      instr =
+          parser.parseXMLUsingCache(InstrumentCache::fromConfig(), nullptr);
       // Parse the instrument tree (internally create ComponentInfo and
       // DetectorInfo). This is an optimization that avoids duplicate parsing
       // of the instrument tree when loading multiple workspaces with the same
@@ -0,0 +1,73 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidAPI/SpectrumGeometry.h"
+#include "MantidAPI/SpectrumInfo.h"
+#include "MantidGeometry/Instrument.h"
+#include "MantidKernel/MultiThreaded.h"
+
+#include <limits>
+#include <stdexcept>
+
+namespace Mantid {
+namespace API {
+
+namespace {
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+/// @return the value of an angle, or NaN if it is not defined
+template <typename Getter> double angleOrNaN(Getter &&getter) {
+  try {
+    return getter();
+  } catch (const std::exception &) {
+    return NaN;
+  }
+}
+} // namespace
+
+/**
+ * Compute the geometry of every spectrum
+ * @param spectrumInfo :: the spectra of a workspace
+ * @throw std::runtime_error if the instrument has no source or sample
+ */
+SpectrumGeometry::SpectrumGeometry(const SpectrumInfo &spectrumInfo)
+    : m_l1(spectrumInfo.l1()),
+      m_sourcePosition(spectrumInfo.sourcePosition()),
+      m_samplePosition(spectrumInfo.samplePosition()),
+      m_hasDetectors(spectrumInfo.size(), 0),
+      m_hasUniqueDetector(spectrumInfo.size(), 0),
+      m_isMonitor(spectrumInfo.size(), 0), m_isMasked(spectrumInfo.size(), 0),
+      m_l2(spectrumInfo.size(), NaN), m_twoTheta(spectrumInfo.size(), NaN),
+      m_signedTwoTheta(spectrumInfo.size(), NaN),
+      m_azimuthal(spectrumInfo.size(), NaN), m_difc(spectrumInfo.size(), NaN),
+      m_position(spectrumInfo.size(), Kernel::V3D(NaN, NaN, NaN)) {
+  const auto numberOfSpectra = static_cast<int64_t>(spectrumInfo.size());
+  PARALLEL_FOR_NO_WSP_CHECK()
+  for (int64_t i = 0; i < numberOfSpectra; ++i) {
+    const auto index = static_cast<size_t>(i);
+    if (!spectrumInfo.hasDetectors(index))
+      continue;
+    m_hasDetectors[index] = 1;
+    m_hasUniqueDetector[index] = spectrumInfo.hasUniqueDetector(index);
+    m_isMonitor[index] = spectrumInfo.isMonitor(index);
+    m_isMasked[index] = spectrumInfo.isMasked(index);
+    m_l2[index] = spectrumInfo.l2(index);
+    m_position[index] = spectrumInfo.position(index);
+    if (m_isMonitor[index])
+      continue;
+    m_twoTheta[index] =
+        angleOrNaN([&] { return spectrumInfo.twoTheta(index); });
+    m_signedTwoTheta[index] =
+        angleOrNaN([&] { return spectrumInfo.signedTwoTheta(index); });
+    m_azimuthal[index] =
+        angleOrNaN([&] { return spectrumInfo.azimuthal(index); });
+    m_difc[index] = 1. / Geometry::Conversion::tofToDSpacingFactor(
+                             m_l1, m_l2[index], m_twoTheta[index], 0.);
+  }
+}
+
+} // namespace API
+} // namespace Mantid
@@ -0,0 +1,205 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include <cxxtest/TestSuite.h>
+
+#include "MantidAPI/SpectrumGeometry.h"
+#include "MantidAPI/SpectrumInfo.h"
+#include "MantidGeometry/Instrument.h"
+#include "MantidGeometry/Instrument/DetectorInfo.h"
+
+#include "MantidTestHelpers/FakeObjects.h"
+#include "MantidTestHelpers/InstrumentCreationHelper.h"
+
+#include <cmath>
+
+using namespace Mantid::API;
+using Mantid::Kernel::V3D;
+
+class SpectrumGeometryTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static SpectrumGeometryTest *createSuite() {
+    return new SpectrumGeometryTest();
+  }
+  static void destroySuite(SpectrumGeometryTest *suite) { delete suite; }
+
+  void test_matches_spectrum_info() {
+    auto ws = makeWorkspace();
+    assertMatchesSpectrumInfo(ws);
+  }
+
+  void test_grouped_matches_spectrum_info() {
+    auto ws = makeWorkspace();
+    ws.getSpectrum(0).setDetectorIDs({2, 3});
+    ws.getSpectrum(1).setDetectorIDs({1, 4}); // partial monitor
+    ws.getSpectrum(2).setDetectorIDs({4, 5}); // full monitor
+    ws.getSpectrum(3).setDetectorIDs({1, 2, 3, 4, 5});
+    ws.getSpectrum(4).clearDetectorIDs();
+    assertMatchesSpectrumInfo(ws);
+  }
+
+  void test_undefined_values_are_nan() {
+    auto ws = makeWorkspace();
+    ws.getSpectrum(1).setDetectorIDs({1, 4});
+    ws.getSpectrum(2).clearDetectorIDs();
+    const auto geometry = ws.spectrumGeometry();
+    // A monitor has a distance but no angles
+    TS_ASSERT(geometry->isMonitor()[4]);
+    TS_ASSERT(!std::isnan(geometry->l2()[4]));
+    TS_ASSERT(std::isnan(geometry->twoTheta()[4]));
+    TS_ASSERT(std::isnan(geometry->difc()[4]));
+    // So has a group that includes a monitor
+    TS_ASSERT(!geometry->isMonitor()[1]);
+    TS_ASSERT(std::isnan(geometry->signedTwoTheta()[1]));
+    // A spectrum without detectors has nothing
+    TS_ASSERT(!geometry->hasDetectors()[2]);
+    TS_ASSERT(!geometry->isMasked()[2]);
+    TS_ASSERT(std::isnan(geometry->l2()[2]));
+    TS_ASSERT(std::isnan(geometry->position()[2].X()));
+  }
+
+  void test_difc() {
+    auto ws = makeWorkspace();
+    const auto geometry = ws.spectrumGeometry();
+    const auto &spectrumInfo = ws.spectrumInfo();
+    // DIFC = 2 m_n (L1 + L2) sin(theta) / h, in microseconds per Angstrom
+    const double difc = 505.556 * (spectrumInfo.l1() + spectrumInfo.l2(1)) *
+                        std::sin(spectrumInfo.twoTheta(1) / 2.);
+    TS_ASSERT_DELTA(geometry->difc()[1], difc, 1e-3 * difc);
+  }
+
+  void test_snapshot_is_shared() {
+    auto ws = makeWorkspace();
+    const auto geometry = ws.spectrumGeometry();
+    static_cast<void>(ws.spectrumInfo());
+    static_cast<void>(ws.componentInfo());
+    TS_ASSERT_EQUALS(ws.spectrumGeometry(), geometry);
+  }
+
+  void test_snapshot_is_rebuilt_after_masking() {
+    auto ws = makeWorkspace();
+    const auto geometry = ws.spectrumGeometry();
+    TS_ASSERT(!geometry->isMasked()[1]);
+    ws.mutableDetectorInfo().setMasked(1, true);
+    const auto masked = ws.spectrumGeometry();
+    TS_ASSERT_DIFFERS(masked, geometry);
+    TS_ASSERT(masked->isMasked()[1]);
+    // The old snapshot is left as it was
+    TS_ASSERT(!geometry->isMasked()[1]);
+  }
+
+  void test_snapshot_is_rebuilt_after_moving_a_detector() {
+    auto ws = makeWorkspace();
+    const auto geometry = ws.spectrumGeometry();
+    const V3D position(1.0, 0.0, 2.0);
+    ws.mutableDetectorInfo().setPosition(1, position);
+    const auto moved = ws.spectrumGeometry();
+    TS_ASSERT_DIFFERS(moved, geometry);
+    TS_ASSERT_EQUALS(moved->position()[1], position);
+    TS_ASSERT_DELTA(moved->l2()[1], position.norm(), 1e-12);
+  }
+
+  void test_snapshot_is_rebuilt_after_regrouping() {
+    auto ws = makeWorkspace();
+    const auto geometry = ws.spectrumGeometry();
+    TS_ASSERT(geometry->hasUniqueDetector()[0]);
+    ws.getSpectrum(0).setDetectorIDs({2, 3});
+    const auto grouped = ws.spectrumGeometry();
+    TS_ASSERT_DIFFERS(grouped, geometry);
+    TS_ASSERT(!grouped->hasUniqueDetector()[0]);
+    TS_ASSERT_EQUALS(grouped->position()[0], ws.spectrumInfo().position(0));
+  }
+
+private:
+  WorkspaceTester makeWorkspace() {
+    WorkspaceTester ws;
+    ws.initialize(5, 2, 1);
+    // Detectors 4 and 5 are monitors
+    InstrumentCreationHelper::addFullInstrumentToWorkspace(
+        ws, true, true, "SimpleFakeInstrument");
+    ws.mutableDetectorInfo().setMasked(0, true);
+    ws.mutableDetectorInfo().setMasked(3, true);
+    return ws;
+  }
+
+  void assertMatchesSpectrumInfo(const MatrixWorkspace &ws) {
+    const auto geometry = ws.spectrumGeometry();
+    const auto &spectrumInfo = ws.spectrumInfo();
+    TS_ASSERT_EQUALS(geometry->size(), spectrumInfo.size());
+    TS_ASSERT_EQUALS(geometry->l1(), spectrumInfo.l1());
+    TS_ASSERT_EQUALS(geometry->sourcePosition(), spectrumInfo.sourcePosition());
+    TS_ASSERT_EQUALS(geometry->samplePosition(), spectrumInfo.samplePosition());
+    for (size_t i = 0; i < spectrumInfo.size(); ++i) {
+      TS_ASSERT_EQUALS(geometry->hasDetectors()[i] != 0,
+                       spectrumInfo.hasDetectors(i));
+      if (!spectrumInfo.hasDetectors(i))
+        continue;
+      TS_ASSERT_EQUALS(geometry->hasUniqueDetector()[i] != 0,
+                       spectrumInfo.hasUniqueDetector(i));
+      TS_ASSERT_EQUALS(geometry->isMonitor()[i] != 0,
+                       spectrumInfo.isMonitor(i));
+      TS_ASSERT_EQUALS(geometry->isMasked()[i] != 0, spectrumInfo.isMasked(i));
+      TS_ASSERT_EQUALS(geometry->l2()[i], spectrumInfo.l2(i));
+      TS_ASSERT_EQUALS(geometry->position()[i], spectrumInfo.position(i));
+      assertAngle(geometry->twoTheta()[i],
+                  [&] { return spectrumInfo.twoTheta(i); });
+      assertAngle(geometry->signedTwoTheta()[i],
+                  [&] { return spectrumInfo.signedTwoTheta(i); });
+      assertAngle(geometry->azimuthal()[i],
+                  [&] { return spectrumInfo.azimuthal(i); });
+    }
+  }
+
+  /// Check an angle is the one given, or NaN if getting it throws
+  template <typename Getter>
+  void assertAngle(const double angle, Getter &&getter) {
+    double expected;
+    try {
+      expected = getter();
+    } catch (const std::exception &) {
+      TS_ASSERT(std::isnan(angle));
+      return;
+    }
+    TS_ASSERT_EQUALS(angle, expected);
+  }
+};
+
+class SpectrumGeometryTestPerformance : public CxxTest::TestSuite {
+public:
+  static SpectrumGeometryTestPerformance *createSuite() {
+    return new SpectrumGeometryTestPerformance();
+  }
+  static void destroySuite(SpectrumGeometryTestPerformance *suite) {
+    delete suite;
+  }
+
+  SpectrumGeometryTestPerformance() {
+    m_workspace.initialize(10000, 2, 1);
+    InstrumentCreationHelper::addFullInstrumentToWorkspace(
+        m_workspace, false, true, "SimpleFakeInstrument");
+  }
+
+  void test_typical() {
+    // The same sum as SpectrumInfoTestPerformance, read from the snapshot
+    double result = 0.0;
+    const auto geometry = m_workspace.spectrumGeometry();
+    const auto &l2 = geometry->l2();
+    const auto &twoTheta = geometry->twoTheta();
+    for (size_t i = 0; i < 10000; ++i) {
+      result += geometry->l1();
+      result += l2[i];
+      result += twoTheta[i];
+    }
+    TS_ASSERT_DELTA(result, 5214709.740869, 1e-6);
+  }
+
+private:
+  WorkspaceTester m_workspace;
+};
@@ -109,6 +109,19 @@ protected:
                          const API::MatrixWorkspace &ws, const bool signedTheta,
                          int64_t wsIndex, double &efixed, double &l2,
                          double &twoTheta);
+  /// As above, reading the geometry from a snapshot of the spectra
+  bool getDetectorValues(const API::SpectrumGeometry &geometry,
+                         const API::SpectrumInfo &spectrumInfo,
+                         const Kernel::Unit &outputUnit, int emode,
+                         const API::MatrixWorkspace &ws, const bool signedTheta,
+                         int64_t wsIndex, double &efixed, double &l2,
+                         double &twoTheta);
+  /// Get the efixed of an indirect detector or the values for a monitor
+  void getEfixedOrMonitorValues(const API::SpectrumInfo &spectrumInfo,
+                                const Kernel::Unit &outputUnit, int emode,
+                                const API::MatrixWorkspace &ws,
+                                const bool isMonitor, int64_t wsIndex,
+                                double &efixed, double &l2, double &twoTheta);
 
   /// Convert the workspace units using TOF as an intermediate step in the
   /// conversion
@@ -13,13 +13,21 @@
 #include "MantidAlgorithms/SampleCorrections/MCInteractionStatistics.h"
 #include "MantidHistogramData/Histogram.h"
 #include "MantidKernel/DeltaEMode.h"
+#include <memory>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 namespace Mantid {
 namespace API {
 class Sample;
 }
+namespace Geometry {
+class BoundingBox;
+class Track;
+} // namespace Geometry
 namespace Kernel {
+class Material;
 class PseudoRandomNumberGenerator;
 class V3D;
 class Logger;
@@ -37,6 +45,12 @@ class MonteCarloAbsorption;
   The error on all points is defined to be \f$\frac{SD}{\sqrt{N}}\f$, where SD
   is the standard deviation of the attenuation factors across the simulated
   tracks and N is the number of events generated.
+
+  Unless the tracks are regenerated for each wavelength, a single pair of
+  tracks is generated per event and the attenuation factors of all the
+  wavelengths are computed together: the attenuation coefficient of each
+  material is found once per wavelength and the factors are evaluated as
+  \f$\exp(-\sum_i \mu_i(\lambda) l_i)\f$ over the links of both tracks.
 */
 class MANTID_ALGORITHMS_DLL MCAbsorptionStrategy
     : public IMCAbsorptionStrategy {
@@ -55,6 +69,53 @@ public:
                          MCInteractionStatistics &stats) override;
 
 private:
+  /// The attenuation coefficients of each material met along the tracks, at
+  /// the wavelengths before and after scattering
+  class AttenuationCoefficients {
+  public:
+    AttenuationCoefficients(const std::vector<double> &lambdas,
+                            const double lambdaFixed,
+                            const Kernel::DeltaEMode::Type emode);
+    void addExponents(const Geometry::Track &track, const bool beforeScatter,
+                      std::vector<double> &exponents);
+
+  private:
+    struct Entry {
+      const Kernel::Material *material;
+      std::vector<double> before;
+      std::vector<double> after;
+    };
+    const std::vector<double> &find(const Kernel::Material &material,
+                                    const bool beforeScatter);
+    std::vector<double> m_lambdasIn;
+    std::vector<double> m_lambdasOut;
+    /// Few materials are met, so a linear search is quickest
+    std::vector<Entry> m_materials;
+  };
+
+  std::pair<std::shared_ptr<Geometry::Track>, std::shared_ptr<Geometry::Track>>
+  generateTracks(Kernel::PseudoRandomNumberGenerator &rng,
+                 const Geometry::BoundingBox &scatterBounds,
+                 const Kernel::V3D &finalPos,
+                 MCInteractionStatistics &stats) const;
+  void calculateWithNewTracks(Kernel::PseudoRandomNumberGenerator &rng,
+                              const Kernel::V3D &finalPos,
+                              const std::vector<double> &lambdas,
+                              const double lambdaFixed,
+                              std::vector<double> &attenuationFactors,
+                              std::vector<double> &attFactorErrors,
+                              MCInteractionStatistics &stats);
+  void calculateWithSharedTracks(Kernel::PseudoRandomNumberGenerator &rng,
+                                 const Kernel::V3D &finalPos,
+                                 const std::vector<double> &lambdas,
+                                 const double lambdaFixed,
+                                 std::vector<double> &attenuationFactors,
+                                 std::vector<double> &attFactorErrors,
+                                 MCInteractionStatistics &stats);
+  static std::pair<double, double>
+  wavelengths(const double lambda, const double lambdaFixed,
+              const Kernel::DeltaEMode::Type emode);
+
   const IBeamProfile &m_beamProfile;
   const IMCInteractionVolume &m_scatterVol;
   const size_t m_nevents;
@@ -8,6 +8,7 @@
 #include "MantidAPI/AlgorithmFactory.h"
 #include "MantidAPI/Axis.h"
 #include "MantidAPI/Run.h"
+#include "MantidAPI/SpectrumGeometry.h"
 #include "MantidAPI/SpectrumInfo.h"
 #include "MantidAPI/WorkspaceUnitValidator.h"
 #include "MantidDataObjects/EventWorkspace.h"
@@ -21,6 +22,7 @@
 #include "MantidKernel/UnitFactory.h"
 #include "MantidParallel/Communicator.h"
 
+#include <cmath>
 #include <numeric>
 
 namespace Mantid {
@@ -410,7 +412,8 @@ bool ConvertUnits::getDetectorValues(const API::SpectrumInfo &spectrumInfo,
 
   l2 = spectrumInfo.l2(wsIndex);
 
-  if (!spectrumInfo.isMonitor(wsIndex)) {
+  const bool isMonitor = spectrumInfo.isMonitor(wsIndex);
+  if (!isMonitor) {
     // The scattering angle for this detector (in radians).
     try {
       if (signedTheta)
@@ -421,6 +424,69 @@ bool ConvertUnits::getDetectorValues(const API::SpectrumInfo &spectrumInfo,
       g_log.warning(e.what());
       twoTheta = std::numeric_limits<double>::quiet_NaN();
     }
+  }
+  getEfixedOrMonitorValues(spectrumInfo, outputUnit, emode, ws, isMonitor,
+                           wsIndex, efixed, l2, twoTheta);
+  return true;
+}
+
+/** Get the L2, theta and efixed values for a workspace index, reading the
+ * geometry from a snapshot of the spectra of the workspace
+ * @param geometry :: SpectrumGeometry of the workspace
+ * @param spectrumInfo :: SpectrumInfo of the workspace
+ * @param outputUnit :: The output unit
+ * @param emode :: The energy mode
+ * @param ws :: The workspace
+ * @param signedTheta :: Return twotheta with sign or without
+ * @param wsIndex :: The workspace index
+ * @param efixed :: the returned fixed energy
+ * @param l2 :: The returned sample - detector distance
+ * @param twoTheta :: the returned two theta angle
+ * @returns true if lookup successful, false on error
+ */
+bool ConvertUnits::getDetectorValues(const API::SpectrumGeometry &geometry,
+                                     const API::SpectrumInfo &spectrumInfo,
+                                     const Kernel::Unit &outputUnit, int emode,
+                                     const MatrixWorkspace &ws,
+                                     const bool signedTheta, int64_t wsIndex,
+                                     double &efixed, double &l2,
+                                     double &twoTheta) {
+  if (!geometry.hasDetectors()[wsIndex])
+    return false;
+
+  l2 = geometry.l2()[wsIndex];
+
+  const bool isMonitor = geometry.isMonitor()[wsIndex] != 0;
+  if (!isMonitor) {
+    // The scattering angle for this detector (in radians).
+    twoTheta = signedTheta ? geometry.signedTwoTheta()[wsIndex]
+                           : geometry.twoTheta()[wsIndex];
+    if (std::isnan(twoTheta))
+      g_log.warning() << "Scattering angle is not defined for workspace index "
+                      << wsIndex << "\n";
+  }
+  getEfixedOrMonitorValues(spectrumInfo, outputUnit, emode, ws, isMonitor,
+                           wsIndex, efixed, l2, twoTheta);
+  return true;
+}
+
+/** Get efixed from the instrument of an indirect detector, or set the values
+ * used for a monitor
+ * @param spectrumInfo :: SpectrumInfo of the workspace
+ * @param outputUnit :: The output unit
+ * @param emode :: The energy mode
+ * @param ws :: The workspace
+ * @param isMonitor :: Whether the spectrum is a monitor
+ * @param wsIndex :: The workspace index
+ * @param efixed :: the returned fixed energy
+ * @param l2 :: The sample - detector distance, zero for monitors in DeltaE
+ * @param twoTheta :: The two theta angle, zero for monitors
+ */
+void ConvertUnits::getEfixedOrMonitorValues(
+    const API::SpectrumInfo &spectrumInfo, const Kernel::Unit &outputUnit,
+    int emode, const MatrixWorkspace &ws, const bool isMonitor,
+    int64_t wsIndex, double &efixed, double &l2, double &twoTheta) {
+  if (!isMonitor) {
     // If an indirect instrument, try getting Efixed from the geometry
     if (emode == 2 && efixed == EMPTY_DBL()) // indirect
     {
@@ -443,7 +509,6 @@ bool ConvertUnits::getDetectorValues(const API::SpectrumInfo &spectrumInfo,
       l2 = 0.0;
     }
   }
-  return true;
 }
 
 /** Convert the workspace units using TOF as an intermediate step in the
@@ -545,7 +610,9 @@ ConvertUnits::convertViaTOF(Kernel::Unit_const_sptr fromUnit,
       std::dynamic_pointer_cast<EventWorkspace>(outputWS);
   assert(static_cast<bool>(eventWS) == m_inputEvents); // Sanity check
 
-  auto &outSpectrumInfo = outputWS->mutableSpectrumInfo();
+  const auto &outSpectrumInfo = outputWS->spectrumInfo();
+  // Read the geometry of the spectra from a snapshot, built once for the loop
+  const auto outGeometry = outputWS->spectrumGeometry();
   // Loop over the histograms (detector spectra)
   for (int64_t i = 0; i < numberOfSpectra_i; ++i) {
     double efixed = efixedProp;
@@ -553,8 +620,8 @@ ConvertUnits::convertViaTOF(Kernel::Unit_const_sptr fromUnit,
     // Now get the detector object for this histogram
     double l2;
     double twoTheta;
-    if (getDetectorValues(outSpectrumInfo, *outputUnit, emode, *outputWS,
-                          signedTheta, i, efixed, l2, twoTheta)) {
+    if (getDetectorValues(*outGeometry, outSpectrumInfo, *outputUnit, emode,
+                          *outputWS, signedTheta, i, efixed, l2, twoTheta)) {
 
       /// @todo Don't yet consider hold-off (delta)
       const double delta = 0.0;
@@ -579,8 +646,8 @@ ConvertUnits::convertViaTOF(Kernel::Unit_const_sptr fromUnit,
       // the same as just zeroing out the data (calling clearData on the
       // spectrum)
       outputWS->getSpectrum(i).clearData();
-      if (outSpectrumInfo.hasDetectors(i))
-        outSpectrumInfo.setMasked(i, true);
+      if (outGeometry->hasDetectors()[i])
+        outputWS->mutableSpectrumInfo().setMasked(i, true);
     }
 
     prog.report("Convert to " + m_outputUnit->unitID());
@@ -11,6 +11,11 @@
 
 #include "MantidAlgorithms/SampleCorrections/RectangularBeamProfile.h"
 #include "MantidGeometry/Objects/CSGObject.h"
+#include "MantidGeometry/Objects/Track.h"
+#include "MantidKernel/Material.h"
+
+#include <algorithm>
+#include <cmath>
 
 namespace Mantid {
 using Kernel::DeltaEMode;
@@ -18,6 +23,30 @@ using Kernel::PseudoRandomNumberGenerator;
 
 namespace Algorithms {
 
+namespace {
+/**
+ * Add the weight of one event to the running sums of a wavelength
+ * @param event The index of the event, counting from 0
+ * @param wgt The attenuation factor of the event
+ * @param wgtMean The running mean of the weights
+ * @param wgtM2 The running sum of squared differences from the mean
+ * @param attenuationFactor The sum of the attenuation factors
+ * @param attFactorError The standard deviation of the attenuation factors
+ */
+inline void addEvent(const size_t event, const double wgt, double &wgtMean,
+                     double &wgtM2, double &attenuationFactor,
+                     double &attFactorError) {
+  attenuationFactor += wgt;
+  // increment standard deviation using Welford algorithm
+  const double delta = wgt - wgtMean;
+  wgtMean += delta / static_cast<double>(event + 1);
+  wgtM2 += delta * (wgt - wgtMean);
+  // calculate sample SD (M2/n-1)
+  // will give NaN for m_events=1, but that's correct
+  attFactorError = sqrt(wgtM2 / static_cast<double>(event));
+}
+} // namespace
+
 /**
  * Constructor
  * @param interactionVolume A reference to the MCInteractionVolume dependency
@@ -79,62 +108,12 @@ void MCAbsorptionStrategy::calculate(Kernel::PseudoRandomNumberGenerator &rng,
                                      std::vector<double> &attenuationFactors,
                                      std::vector<double> &attFactorErrors,
                                      MCInteractionStatistics &stats) {
-  const auto scatterBounds = m_scatterVol.getBoundingBox();
-  const auto nbins = static_cast<int>(lambdas.size());
-
-  std::vector<double> wgtMean(attenuationFactors.size()),
-      wgtM2(attenuationFactors.size());
-
-  for (size_t i = 0; i < m_nevents; ++i) {
-    std::shared_ptr<Geometry::Track> beforeScatter;
-    std::shared_ptr<Geometry::Track> afterScatter;
-    for (int j = 0; j < nbins; ++j) {
-      size_t attempts(0);
-      do {
-        bool success = false;
-        if (m_regenerateTracksForEachLambda || j == 0) {
-          const auto neutron = m_beamProfile.generatePoint(rng, scatterBounds);
-          std::tie(success, beforeScatter, afterScatter) =
-              m_scatterVol.calculateBeforeAfterTrack(rng, neutron.startPos,
-                                                     finalPos, stats);
-        } else {
-          success = true;
-        }
-        if (!success) {
-          ++attempts;
-        } else {
-          const double lambdaStep = lambdas[j];
-          double lambdaIn(lambdaStep), lambdaOut(lambdaStep);
-          if (m_EMode == DeltaEMode::Direct) {
-            lambdaIn = lambdaFixed;
-          } else if (m_EMode == DeltaEMode::Indirect) {
-            lambdaOut = lambdaFixed;
-          } else {
-            // elastic case already initialized
-          }
-          const double wgt = beforeScatter->calculateAttenuation(lambdaIn) *
-                             afterScatter->calculateAttenuation(lambdaOut);
-          attenuationFactors[j] += wgt;
-          // increment standard deviation using Welford algorithm
-          double delta = wgt - wgtMean[j];
-          wgtMean[j] += delta / static_cast<double>(i + 1);
-          wgtM2[j] += delta * (wgt - wgtMean[j]);
-          // calculate sample SD (M2/n-1)
-          // will give NaN for m_events=1, but that's correct
-          attFactorErrors[j] = sqrt(wgtM2[j] / static_cast<double>(i));
-
-          break;
-        }
-        if (attempts == m_maxScatterAttempts) {
-          throw std::runtime_error("Unable to generate valid track through "
-                                   "sample interaction volume after " +
-                                   std::to_string(m_maxScatterAttempts) +
-                                   " attempts. Try increasing the maximum "
-                                   "threshold or if this does not help then "
-                                   "please check the defined shape.");
-        }
-      } while (true);
-    }
+  if (m_regenerateTracksForEachLambda) {
+    calculateWithNewTracks(rng, finalPos, lambdas, lambdaFixed,
+                           attenuationFactors, attFactorErrors, stats);
+  } else {
+    calculateWithSharedTracks(rng, finalPos, lambdas, lambdaFixed,
+                              attenuationFactors, attFactorErrors, stats);
   }
 
   std::transform(attenuationFactors.begin(), attenuationFactors.end(),
@@ -149,5 +128,185 @@ void MCAbsorptionStrategy::calculate(Kernel::PseudoRandomNumberGenerator &rng,
                  });
 }
 
+/**
+ * Generate a pair of tracks through a new scatter point
+ * @param rng A reference to a PseudoRandomNumberGenerator
+ * @param scatterBounds The bounding box of the interaction volume
+ * @param finalPos The final position of the neutron
+ * @param stats The statistics on the generated tracks
+ * @return the tracks before and after scattering
+ * @throws std::runtime_error if no scatter point was found in the maximum
+ * number of attempts
+ */
+std::pair<std::shared_ptr<Geometry::Track>, std::shared_ptr<Geometry::Track>>
+MCAbsorptionStrategy::generateTracks(Kernel::PseudoRandomNumberGenerator &rng,
+                                     const Geometry::BoundingBox &scatterBounds,
+                                     const Kernel::V3D &finalPos,
+                                     MCInteractionStatistics &stats) const {
+  for (size_t attempts = 0; attempts < m_maxScatterAttempts; ++attempts) {
+    const auto neutron = m_beamProfile.generatePoint(rng, scatterBounds);
+    const auto [success, beforeScatter, afterScatter] =
+        m_scatterVol.calculateBeforeAfterTrack(rng, neutron.startPos, finalPos,
+                                               stats);
+    if (success)
+      return {beforeScatter, afterScatter};
+  }
+  throw std::runtime_error("Unable to generate valid track through "
+                           "sample interaction volume after " +
+                           std::to_string(m_maxScatterAttempts) +
+                           " attempts. Try increasing the maximum "
+                           "threshold or if this does not help then "
+                           "please check the defined shape.");
+}
+
+/**
+ * Run the simulation with new tracks for every event and wavelength
+ * @param rng A reference to a PseudoRandomNumberGenerator
+ * @param finalPos The final position of the neutron
+ * @param lambdas Set of wavelength values from the input workspace
+ * @param lambdaFixed Efixed value for a detector ID converted to wavelength
+ * @param attenuationFactors The sum of the attenuation factors
+ * @param attFactorErrors The standard deviation of the attenuation factors
+ * @param stats The statistics on the generated tracks
+ */
+void MCAbsorptionStrategy::calculateWithNewTracks(
+    Kernel::PseudoRandomNumberGenerator &rng, const Kernel::V3D &finalPos,
+    const std::vector<double> &lambdas, const double lambdaFixed,
+    std::vector<double> &attenuationFactors,
+    std::vector<double> &attFactorErrors, MCInteractionStatistics &stats) {
+  const auto scatterBounds = m_scatterVol.getBoundingBox();
+  const auto nbins = lambdas.size();
+  std::vector<double> wgtMean(nbins), wgtM2(nbins);
+
+  for (size_t i = 0; i < m_nevents; ++i) {
+    for (size_t j = 0; j < nbins; ++j) {
+      const auto [beforeScatter, afterScatter] =
+          generateTracks(rng, scatterBounds, finalPos, stats);
+      const auto [lambdaIn, lambdaOut] =
+          wavelengths(lambdas[j], lambdaFixed, m_EMode);
+      const double wgt = beforeScatter->calculateAttenuation(lambdaIn) *
+                         afterScatter->calculateAttenuation(lambdaOut);
+      addEvent(i, wgt, wgtMean[j], wgtM2[j], attenuationFactors[j],
+               attFactorErrors[j]);
+    }
+  }
+}
+
+/**
+ * Run the simulation with one pair of tracks per event for all the
+ * wavelengths. The length of each track within each material is found once
+ * and the attenuation factors of all the wavelengths computed together from
+ * attenuation coefficients found once per material and wavelength.
+ * @param rng A reference to a PseudoRandomNumberGenerator
+ * @param finalPos The final position of the neutron
+ * @param lambdas Set of wavelength values from the input workspace
+ * @param lambdaFixed Efixed value for a detector ID converted to wavelength
+ * @param attenuationFactors The sum of the attenuation factors
+ * @param attFactorErrors The standard deviation of the attenuation factors
+ * @param stats The statistics on the generated tracks
+ */
+void MCAbsorptionStrategy::calculateWithSharedTracks(
+    Kernel::PseudoRandomNumberGenerator &rng, const Kernel::V3D &finalPos,
+    const std::vector<double> &lambdas, const double lambdaFixed,
+    std::vector<double> &attenuationFactors,
+    std::vector<double> &attFactorErrors, MCInteractionStatistics &stats) {
+  const auto scatterBounds = m_scatterVol.getBoundingBox();
+  const auto nbins = lambdas.size();
+  std::vector<double> wgtMean(nbins), wgtM2(nbins), exponents(nbins);
+  AttenuationCoefficients coefficients(lambdas, lambdaFixed, m_EMode);
+
+  for (size_t i = 0; i < m_nevents; ++i) {
+    const auto [beforeScatter, afterScatter] =
+        generateTracks(rng, scatterBounds, finalPos, stats);
+    std::fill(exponents.begin(), exponents.end(), 0.);
+    coefficients.addExponents(*beforeScatter, true, exponents);
+    coefficients.addExponents(*afterScatter, false, exponents);
+    for (auto &exponent : exponents)
+      exponent = std::exp(-exponent);
+    for (size_t j = 0; j < nbins; ++j)
+      addEvent(i, exponents[j], wgtMean[j], wgtM2[j], attenuationFactors[j],
+               attFactorErrors[j]);
+  }
+}
+
+/**
+ * The wavelengths before and after scattering for a wavelength of the
+ * workspace
+ * @param lambda A wavelength value from the input workspace
+ * @param lambdaFixed Efixed value for a detector ID converted to wavelength
+ * @param emode The energy mode of the instrument
+ * @return the wavelengths before and after scattering
+ */
+std::pair<double, double>
+MCAbsorptionStrategy::wavelengths(const double lambda, const double lambdaFixed,
+                                  const DeltaEMode::Type emode) {
+  if (emode == DeltaEMode::Direct)
+    return {lambdaFixed, lambda};
+  if (emode == DeltaEMode::Indirect)
+    return {lambda, lambdaFixed};
+  // elastic case
+  return {lambda, lambda};
+}
+
+/**
+ * Constructor
+ * @param lambdas Set of wavelength values from the input workspace
+ * @param lambdaFixed Efixed value for a detector ID converted to wavelength
+ * @param emode The energy mode of the instrument
+ */
+MCAbsorptionStrategy::AttenuationCoefficients::AttenuationCoefficients(
+    const std::vector<double> &lambdas, const double lambdaFixed,
+    const DeltaEMode::Type emode)
+    : m_lambdasIn(lambdas.size()), m_lambdasOut(lambdas.size()) {
+  for (size_t j = 0; j < lambdas.size(); ++j) {
+    std::tie(m_lambdasIn[j], m_lambdasOut[j]) =
+        wavelengths(lambdas[j], lambdaFixed, emode);
+  }
+}
+
+/**
+ * Add the exponents of the attenuation along a track at each wavelength
+ * @param track A track through the sample and its environment
+ * @param beforeScatter True for the track before the scatter point
+ * @param exponents The sum of the attenuation coefficient times the distance
+ * in each object, at each wavelength
+ */
+void MCAbsorptionStrategy::AttenuationCoefficients::addExponents(
+    const Geometry::Track &track, const bool beforeScatter,
+    std::vector<double> &exponents) {
+  for (const auto &link : track) {
+    const auto &coefficients = find(link.object->material(), beforeScatter);
+    const double distance = link.distInsideObject;
+    for (size_t j = 0; j < exponents.size(); ++j)
+      exponents[j] += coefficients[j] * distance;
+  }
+}
+
+/**
+ * The attenuation coefficients of a material at each wavelength, computed
+ * the first time the material is met
+ * @param material A material met along a track
+ * @param beforeScatter True for the wavelengths before scattering
+ * @return the attenuation coefficient at each wavelength
+ */
+const std::vector<double> &MCAbsorptionStrategy::AttenuationCoefficients::find(
+    const Kernel::Material &material, const bool beforeScatter) {
+  auto found = std::find_if(
+      m_materials.begin(), m_materials.end(),
+      [&material](const auto &entry) { return entry.material == &material; });
+  if (found == m_materials.end()) {
+    Entry entry{&material, {}, {}};
+    entry.before.reserve(m_lambdasIn.size());
+    for (const auto lambda : m_lambdasIn)
+      entry.before.emplace_back(material.attenuationCoefficient(lambda));
+    entry.after.reserve(m_lambdasOut.size());
+    for (const auto lambda : m_lambdasOut)
+      entry.after.emplace_back(material.attenuationCoefficient(lambda));
+    m_materials.emplace_back(std::move(entry));
+    found = std::prev(m_materials.end());
+  }
+  return beforeScatter ? found->before : found->after;
+}
+
 } // namespace Algorithms
 } // namespace Mantid
@@ -14,6 +14,7 @@
 #include "MantidGeometry/Instrument.h"
 #include "MantidGeometry/Instrument/ComponentInfo.h"
 #include "MantidGeometry/Instrument/DetectorInfo.h"
+#include "MantidGeometry/Instrument/SolidAngleEngine.h"
 #include "MantidKernel/BoundedValidator.h"
 #include "MantidKernel/ListValidator.h"
 #include "MantidKernel/UnitFactory.h"
@@ -108,11 +109,28 @@ protected:
   std::unique_ptr<const AlphaAngleCalculator> m_alphaAngleCalculator;
 };
 
+/**
+ * Computes the solid angles of all the detectors needed up front, so that
+ * detectors of the same shape share the work.
+ */
 struct GenericShape : public SolidAngleCalculator {
-  using SolidAngleCalculator::SolidAngleCalculator;
+  GenericShape(const ComponentInfo &componentInfo,
+               const DetectorInfo &detectorInfo, const std::string &method,
+               const double pixelArea,
+               const std::vector<size_t> &detectorIndices)
+      : SolidAngleCalculator(componentInfo, detectorInfo, method, pixelArea),
+        m_solidAngles(detectorInfo.size()) {
+    SolidAngleEngine engine(componentInfo);
+    const auto solidAngles = engine.solidAngles(detectorIndices, m_samplePos);
+    for (size_t i = 0; i < detectorIndices.size(); ++i)
+      m_solidAngles[detectorIndices[i]] = solidAngles[i];
+  }
   double solidAngle(size_t index) const override {
-    return m_detectorInfo.detector(index).solidAngle(m_samplePos);
+    return m_solidAngles[index];
   }
+
+private:
+  std::vector<double> m_solidAngles;
 };
 
 struct Rectangle : public SolidAngleCalculator {
@@ -253,8 +271,24 @@ void SolidAngle::exec() {
 
   std::unique_ptr<SolidAngleCalculator> solidAngleCalculator;
   if (method == GENERIC_SHAPE) {
+    // The detectors of the requested spectra that are counted
+    std::vector<bool> counted(detectorInfo.size(), false);
+    for (int j = m_MinSpec; j <= m_MaxSpec; ++j) {
+      if (!spectrumInfo.hasDetectors(j))
+        continue;
+      for (const auto detID : inputWS->getSpectrum(j).getDetectorIDs()) {
+        const auto index = detectorInfo.indexOf(detID);
+        counted[index] =
+            !detectorInfo.isMasked(index) && !detectorInfo.isMonitor(index);
+      }
+    }
+    std::vector<size_t> detectorIndices;
+    for (size_t index = 0; index < counted.size(); ++index) {
+      if (counted[index])
+        detectorIndices.emplace_back(index);
+    }
     solidAngleCalculator = std::make_unique<GenericShape>(
-        componentInfo, detectorInfo, method, pixelArea);
+        componentInfo, detectorInfo, method, pixelArea, detectorIndices);
   } else if (method == RECTANGLE) {
     solidAngleCalculator = std::make_unique<Rectangle>(
         componentInfo, detectorInfo, method, pixelArea);
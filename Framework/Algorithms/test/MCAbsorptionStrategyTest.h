@@ -203,6 +203,58 @@ public:
     TS_ASSERT_EQUALS(attenuationFactors[0], 3.0);
   }
 
+  void test_all_wavelengths_share_tracks() {
+    using Mantid::Kernel::V3D;
+    using namespace MonteCarloTesting;
+    using namespace ::testing;
+
+    // 6cm radius sphere with an absorbing material, scattered at the centre
+    Mantid::API::Sample testSampleSphere;
+    auto shape = ComponentCreationHelper::createSphere(0.06);
+    const Mantid::Kernel::Material material(
+        "test",
+        Mantid::PhysicalConstants::NeutronAtom(
+            0, 0, 0, 0, 0, 1 /*total scattering xs*/, 2 /*absorption xs*/),
+        0.5);
+    shape->setMaterial(material);
+    testSampleSphere.setShape(shape);
+
+    MockBeamProfile testBeamProfile;
+    EXPECT_CALL(testBeamProfile, defineActiveRegion(_))
+        .WillOnce(Return(testSampleSphere.getShape().getBoundingBox()));
+    const size_t nevents(2), maxTries(100);
+    MCInteractionVolume interactionVolume(testSampleSphere);
+    MCAbsorptionStrategy mcabsorb(interactionVolume, testBeamProfile,
+                                  Mantid::Kernel::DeltaEMode::Type::Indirect,
+                                  nevents, maxTries, false);
+    // one scatter point per event, whatever the number of wavelengths
+    MockRNG rng;
+    EXPECT_CALL(rng, nextValue())
+        .Times(Exactly(3 * nevents))
+        .WillRepeatedly(Return(0.5));
+    const Mantid::Algorithms::IBeamProfile::Ray testRay = {V3D(0, 0, -0.08),
+                                                           V3D(0, 0, 1)};
+    EXPECT_CALL(testBeamProfile, generatePoint(_, _))
+        .Times(Exactly(static_cast<int>(nevents)))
+        .WillRepeatedly(Return(testRay));
+    const V3D endPos(0, 0, 0.08);
+    const double lambdaFixed(3.5);
+
+    std::vector<double> lambdas = {1.0, 2.5, 4.0};
+    std::vector<double> attenuationFactors(lambdas.size(), 0.);
+    std::vector<double> attenuationFactorErrors(lambdas.size(), 0.);
+    MCInteractionStatistics trackStatistics(-1, testSampleSphere);
+    mcabsorb.calculate(rng, endPos, lambdas, lambdaFixed, attenuationFactors,
+                       attenuationFactorErrors, trackStatistics);
+    TS_ASSERT(Mock::VerifyAndClearExpectations(&rng));
+    for (size_t i = 0; i < lambdas.size(); ++i) {
+      const double expected = material.attenuation(0.06, lambdas[i]) *
+                              material.attenuation(0.06, lambdaFixed);
+      TS_ASSERT_DELTA(expected, attenuationFactors[i], 1e-12);
+      TS_ASSERT_DELTA(0., attenuationFactorErrors[i], 1e-12);
+    }
+  }
+
   //----------------------------------------------------------------------------
   // Failure cases
   //----------------------------------------------------------------------------
@@ -0,0 +1,80 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidDataHandling/DllConfig.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Mantid {
+namespace DataHandling {
+
+/** BankReadAhead : limits how far the reading of event banks can run ahead of
+  their processing while loading event NeXus files.
+
+  The disk task reading a bank takes a ticket for the memory the fields it
+  reads will occupy before it reads them. Fields mapped from the file are left
+  out, as the system pages them in and out as needed. The ticket is handed on
+  to the tasks that process the bank and is given back when the last of them
+  lets go of it, so reading overlaps with the processing of earlier banks but
+  never holds more than the configured number of banks (the queue depth) or
+  bytes in memory. A bank is always allowed through when nothing else is in
+  flight, so a single bank larger than the memory limit can still be loaded.
+
+  The time spent reading, processing and waiting for processing to catch up
+  is accumulated so the balance between I/O and compute can be reported.
+*/
+class MANTID_DATAHANDLING_DLL BankReadAhead {
+public:
+  /// Ticket for a bank in flight. Releases its share of the budget when the
+  /// last copy is destroyed.
+  using Ticket = std::shared_ptr<void>;
+
+  BankReadAhead(const size_t maxBanks, const size_t maxBytes);
+  static BankReadAhead fromConfig();
+
+  Ticket acquire(const size_t bytes);
+
+  void addReadTime(const double seconds);
+  void addProcessTime(const double seconds);
+
+  /// Maximum number of banks read but not yet processed
+  size_t maxBanks() const { return m_maxBanks; }
+  /// Maximum number of bytes read but not yet processed
+  size_t maxBytes() const { return m_maxBytes; }
+  size_t banksInFlight() const;
+  size_t bytesInFlight() const;
+  double readTime() const;
+  double processTime() const;
+  double waitTime() const;
+  std::string summary() const;
+
+  /// Default number of banks that can be read ahead of processing
+  static constexpr size_t DEFAULT_DEPTH = 4;
+  /// Default memory for banks read ahead of processing, in MB
+  static constexpr size_t DEFAULT_MEMORY_MB = 2048;
+
+private:
+  void release(const size_t bytes);
+
+  const size_t m_maxBanks;
+  const size_t m_maxBytes;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_released;
+  size_t m_banksInFlight{0};
+  size_t m_bytesInFlight{0};
+  double m_readTime{0.};
+  double m_processTime{0.};
+  double m_waitTime{0.};
+};
+
+} // namespace DataHandling
+} // namespace Mantid
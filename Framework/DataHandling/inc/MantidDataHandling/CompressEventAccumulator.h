@@ -0,0 +1,102 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidDataHandling/DllConfig.h"
+#include "MantidDataObjects/Events.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Mantid {
+namespace DataHandling {
+
+/// How the tolerance of CompressEventAccumulator is applied
+enum class CompressBinningMode { LINEAR, LOGARITHMIC };
+
+/** CompressEventAccumulator : compresses the events of one event list while
+  they arrive, in any order, without keeping them.
+
+  The time-of-flight axis is cut into a grid of bins: [n*tolerance,
+  (n+1)*tolerance) in LINEAR mode, or [T*(1+tolerance)^n, T*(1+tolerance)^(n+1))
+  with T = 1 microsecond in LOGARITHMIC mode. Every bin that receives events
+  becomes a single event holding the summed weights and squared errors and
+  the average time-of-flight, as EventList::compressEvents does. Events added
+  with a pulse time become WeightedEvent's with the average pulse time of the
+  bin, otherwise WeightedEventNoTime's. Only one kind should be added to an
+  accumulator.
+  The bins are fixed, so unlike EventList::compressEvents the events do not
+  need sorting first, but an event close to a grid line is not combined with
+  a close event on the other side of it. A tolerance of zero in LINEAR mode
+  only combines events with identical times-of-flight. In LOGARITHMIC mode all
+  the events with a time-of-flight that is not positive are combined.
+
+  New events are kept in a small buffer that is folded into the sorted bins
+  when it reaches the number of bins, so the memory used stays proportional
+  to the number of compressed events. Accumulators filled from different
+  parts of the data can be merged.
+*/
+class MANTID_DATAHANDLING_DLL CompressEventAccumulator {
+public:
+  CompressEventAccumulator(const double tolerance,
+                           const CompressBinningMode mode);
+
+  /// Add an event with a weight of one
+  void addEvent(const double tof) { addEvent(tof, 1.f, 1.f); }
+  void addEvent(const double tof, const float weight, const float errorSquared);
+  /// Add an event with a pulse time and a weight of one
+  void addEvent(const double tof, const Types::Core::DateAndTime pulseTime) {
+    addEvent(tof, pulseTime, 1.f, 1.f);
+  }
+  void addEvent(const double tof, const Types::Core::DateAndTime pulseTime,
+                const float weight, const float errorSquared);
+  void merge(CompressEventAccumulator &other);
+
+  void createWeightedEvents(
+      std::vector<DataObjects::WeightedEventNoTime> &events);
+  void createWeightedEvents(std::vector<DataObjects::WeightedEvent> &events);
+
+  /// True if no events were added
+  bool empty() const { return m_bins.empty() && m_pending.empty(); }
+  size_t numberOfBins();
+
+private:
+  /// Sums of the events that fall into one bin of the grid
+  struct Bin {
+    int64_t index;
+    double tofSum;
+    double normalization;
+    double weight;
+    double errorSquared;
+    /// Sum of the pulse times relative to m_pulseTimeReference, in ns
+    double pulseTimeSum;
+    uint64_t count;
+  };
+
+  void addBin(const Bin &bin);
+  int64_t binIndex(const double tof) const;
+  double lowerEdge(const int64_t index) const;
+  double averageTof(const Bin &bin) const;
+  void flush();
+
+  /// Width of a bin, or relative width in LOGARITHMIC mode
+  double m_tolerance;
+  /// How the grid is laid out
+  CompressBinningMode m_mode;
+  /// 1 / log(1 + tolerance), used in LOGARITHMIC mode
+  double m_inverseLogStep;
+  /// Bins with events, sorted by index
+  std::vector<Bin> m_bins;
+  /// Bins of the events added since the last flush, in arrival order
+  std::vector<Bin> m_pending;
+  /// Pulse time the pulse times are summed relative to, in ns, which keeps
+  /// the sums precise
+  int64_t m_pulseTimeReference{0};
+};
+
+} // namespace DataHandling
+} // namespace Mantid
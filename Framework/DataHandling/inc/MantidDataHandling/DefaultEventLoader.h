@@ -7,6 +7,7 @@
 #pragma once
 
 #include "MantidAPI/Axis.h"
+#include "MantidDataHandling/BankReadAhead.h"
 #include "MantidDataHandling/DllConfig.h"
 #include "MantidDataHandling/EventWorkspaceCollection.h"
 
@@ -27,7 +28,7 @@ public:
        bool event_id_is_spec, std::vector<std::string> bankNames,
        const std::vector<int> &periodLog, const std::string &classType,
        std::vector<std::size_t> bankNumEvents, const bool oldNeXusFileNames,
-       const bool precount, const int chunk, const int totalChunks);
+       const int chunk, const int totalChunks);
 
   /// Flag for dealing with a simulated file
   bool m_haveWeights;
@@ -38,9 +39,6 @@ public:
   /// whether or not to launch multiple ProcessBankData jobs per bank
   bool splitProcessing;
 
-  /// Do we pre-count the # of events in each pixel ID?
-  bool precount;
-
   /// Offset in the pixelID_to_wi_vector to use.
   detid_t pixelID_to_wi_offset;
 
@@ -76,11 +74,17 @@ public:
   /// One entry of pulse times for each preprocessor
   std::vector<std::shared_ptr<BankPulseTimes>> m_bankPulseTimes;
 
+  /// Limits how far reading the banks runs ahead of processing them
+  BankReadAhead readAhead;
+
+  /// Map event ids and times of flight straight from the file when possible
+  bool memoryMap;
+
 private:
   DefaultEventLoader(LoadEventNexus *alg, EventWorkspaceCollection &ws,
                      bool haveWeights, bool event_id_is_spec,
-                     const size_t numBanks, const bool precount,
-                     const int chunk, const int totalChunks);
+                     const size_t numBanks, const int chunk,
+                     const int totalChunks);
   std::pair<size_t, size_t>
   setupChunking(std::vector<std::string> &bankNames,
                 std::vector<std::size_t> &bankNumEvents);
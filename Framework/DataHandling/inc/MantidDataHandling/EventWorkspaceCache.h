@@ -0,0 +1,82 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidDataHandling/DllConfig.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Mantid {
+namespace DataObjects {
+class EventList;
+}
+namespace DataHandling {
+
+/** EventWorkspaceCache : keeps the event lists built by LoadEventNexus in a
+  local directory so that loading the same file with the same options again
+  skips decoding, mapping and sorting the events.
+
+  Entries are named by a key built from the absolute path, modification time
+  and size of the file and the loader options, which include the identity of
+  the instrument and of the spectrum mapping, so a changed file, instrument
+  definition or option simply misses. Each entry is a single native binary
+  file: a header, a table giving the type, sort order and position of every
+  event list, then the raw events of every list, which are mapped back into
+  memory on a hit. Entries are written under a temporary name and renamed, so
+  a reader never sees a partial entry.
+
+  The directory and its size budget are set with the
+  loadeventnexus.cache.directory and loadeventnexus.cache.size (MB) keys; the
+  cache is disabled if no directory is set. Once an entry is added, the least
+  recently used entries are removed until the cache fits its budget.
+*/
+class MANTID_DATAHANDLING_DLL EventWorkspaceCache {
+public:
+  /// Totals of a load that are stored alongside its events
+  struct LoadStatistics {
+    double shortestTof{0.};
+    double longestTof{0.};
+    uint64_t badTofs{0};
+    uint64_t discardedEvents{0};
+  };
+
+  EventWorkspaceCache(std::string directory, const uint64_t maxBytes);
+  static EventWorkspaceCache fromConfig();
+
+  /// True if a cache directory was given
+  bool enabled() const { return !m_directory.empty(); }
+  /// Maximum size of all the entries, in bytes
+  uint64_t maxBytes() const { return m_maxBytes; }
+
+  static std::string makeKey(const std::string &filename,
+                             const std::string &options);
+  static std::string fileIdentity(const std::string &filename);
+
+  bool load(const std::string &key,
+            const std::vector<DataObjects::EventList *> &lists,
+            LoadStatistics &statistics) const;
+  void save(const std::string &key,
+            const std::vector<const DataObjects::EventList *> &lists,
+            const LoadStatistics &statistics) const;
+  void evict(const std::string &keep = "") const;
+
+  std::string entryPath(const std::string &key) const;
+
+  /// Default size of the cache, in MB
+  static constexpr uint64_t DEFAULT_SIZE_MB = 10240;
+
+private:
+  /// Directory holding the entries
+  std::string m_directory;
+  /// Maximum size of all the entries, in bytes
+  uint64_t m_maxBytes;
+};
+
+} // namespace DataHandling
+} // namespace Mantid
@@ -20,7 +20,8 @@ namespace DataHandling {
 class DefaultEventLoader;
 
 /** This task does the disk IO from loading the NXS file, and so will be on a
-  disk IO mutex
+  disk IO mutex. How far it may read ahead of the processing of earlier banks
+  is limited by DefaultEventLoader::readAhead.
 */
 class MANTID_DATAHANDLING_DLL LoadBankFromDiskTask : public Kernel::Task {
 
@@ -42,9 +43,17 @@ private:
   void prepareEventId(::NeXus::File &file, int64_t &start_event,
                       int64_t &stop_event,
                       const std::vector<uint64_t> &event_index);
-  std::unique_ptr<std::vector<uint32_t>> loadEventId(::NeXus::File &file);
-  std::unique_ptr<std::vector<float>> loadTof(::NeXus::File &file);
+  std::string eventIdKey() const;
+  std::string tofKey() const;
+  std::shared_ptr<const float> mapTof(::NeXus::File &file);
+  std::shared_ptr<const uint32_t>
+  loadEventId(::NeXus::File &file, std::shared_ptr<const uint32_t> mapped);
+  std::shared_ptr<const float> loadTof(::NeXus::File &file,
+                                       std::shared_ptr<const float> mapped);
   std::unique_ptr<std::vector<float>> loadEventWeights(::NeXus::File &file);
+  template <typename T>
+  std::shared_ptr<const T> mapDataset(const std::string &key) const;
+  size_t bankMemory(const bool readIds, const bool readTofs) const;
   int64_t recalculateDataSize(const int64_t &size);
 
   /// Algorithm being run
@@ -10,6 +10,8 @@
 #include "MantidAPI/NexusFileLoader.h"
 #include "MantidAPI/WorkspaceGroup.h"
 #include "MantidDataHandling/BankPulseTimes.h"
+#include "MantidDataHandling/CompressEventAccumulator.h"
+#include "MantidDataHandling/EventWorkspaceCache.h"
 #include "MantidDataHandling/EventWorkspaceCollection.h"
 #include "MantidDataHandling/LoadGeometry.h"
 #include "MantidDataObjects/EventWorkspace.h"
@@ -192,6 +194,11 @@ public:
 
   /// Tolerance for CompressEvents; use -1 to mean don't compress.
   double compressTolerance;
+  /// Compress the events of each pixel while they are read instead of after
+  /// each bank
+  bool compressWhileLoading;
+  /// Grid used to compress while loading
+  CompressBinningMode compressBinningMode;
 
   /// Pulse times for ALL banks, taken from proton_charge log.
   std::shared_ptr<BankPulseTimes> m_allBanksPulseTimes;
@@ -230,6 +237,11 @@ private:
   void runLoadMonitors();
   /// Set the filters on TOF.
   void setTimeFilters(const bool monitors);
+  std::string eventCacheKey() const;
+  bool loadEventsFromCache(const EventWorkspaceCache &cache,
+                           const std::string &key);
+  void saveEventsToCache(const EventWorkspaceCache &cache,
+                         const std::string &key);
 
   /// Load a spectra mapping from the given file
   std::unique_ptr<std::pair<std::vector<int32_t>, std::vector<int32_t>>>
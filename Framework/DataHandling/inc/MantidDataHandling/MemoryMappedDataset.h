@@ -0,0 +1,48 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidDataHandling/DllConfig.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace Mantid {
+namespace DataHandling {
+namespace MemoryMappedDataset {
+
+/** Map part of a one dimensional HDF5 dataset straight into memory.
+
+  This only works when the dataset is stored contiguously in the file,
+  without compression or other filters, in external storage or a multi-file
+  driver, and with exactly the requested type in the native byte order. Then
+  its elements can be used in place from the mapped pages without being read
+  into a buffer first.
+
+  @param filename :: the HDF5 file
+  @param datasetPath :: absolute path of the dataset in the file
+  @param start :: index of the first element to map
+  @param count :: number of elements to map
+  @return a pointer to the first mapped element that keeps the mapping alive,
+  or nullptr if the dataset cannot be mapped and must be read the usual way
+ */
+template <typename T>
+std::shared_ptr<const T> map(const std::string &filename,
+                             const std::string &datasetPath,
+                             const size_t start, const size_t count);
+
+/// Number of datasets mapped by map since the start of the process
+MANTID_DATAHANDLING_DLL size_t mappedCount();
+
+/// Whether mapping is enabled with the loadeventnexus.memorymap key
+MANTID_DATAHANDLING_DLL bool enabled();
+
+} // namespace MemoryMappedDataset
+} // namespace DataHandling
+} // namespace Mantid
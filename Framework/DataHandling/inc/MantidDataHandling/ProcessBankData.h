@@ -12,7 +12,9 @@
 #include "MantidKernel/Task.h"
 #include "MantidKernel/Timer.h"
 
+#include <limits>
 #include <memory>
+#include <vector>
 
 namespace Mantid {
 namespace API {
@@ -22,7 +24,14 @@ namespace DataHandling {
 class DefaultEventLoader;
 
 /** This task does the disk IO from loading the NXS file,
- * and so will be on a disk IO mutex */
+ * and so will be on a disk IO mutex.
+ *
+ * The events of a bank are scattered into the event lists in two parallel
+ * passes (count, then fill into preallocated storage), so a single bank with
+ * most of the events can still use every core. When asked to compress while
+ * loading, the events of each pixel are instead folded into a
+ * CompressEventAccumulator as they are read, the pulses being split between
+ * the cores. */
 class ProcessBankData : public Mantid::Kernel::Task {
 public:
   /** Constructor
@@ -45,8 +54,8 @@ public:
    */ // API::IFileLoader<Kernel::NexusDescriptor>
   ProcessBankData(DefaultEventLoader &loader, std::string entry_name,
                   API::Progress *prog,
-                  std::shared_ptr<std::vector<uint32_t>> event_id,
-                  std::shared_ptr<std::vector<float>> event_time_of_flight,
+                  std::shared_ptr<const uint32_t> event_id,
+                  std::shared_ptr<const float> event_time_of_flight,
                   size_t numEvents, size_t startAt,
                   std::shared_ptr<std::vector<uint64_t>> event_index,
                   std::shared_ptr<BankPulseTimes> thisBankPulseTimes,
@@ -57,6 +66,34 @@ public:
   void run() override;
 
 private:
+  /// Tallies gathered while filling the events of a bank
+  struct BankStatistics {
+    /// Shortest time-of-flight seen
+    double shortestTof{
+        static_cast<double>(std::numeric_limits<uint32_t>::max()) * 0.1};
+    /// Longest time-of-flight seen
+    double longestTof{0.};
+    /// Number of time-of-flights that were too high
+    size_t badTofs{0};
+    /// Number of events without an event list to go to
+    size_t discardedEvents{0};
+    /// Which detector IDs had events added, relative to the minimum ID
+    std::vector<bool> usedDetIds;
+  };
+
+  /// Don't split the fill across threads for fewer events than this per slice
+  static constexpr size_t MIN_EVENTS_PER_SLICE = 100000;
+
+  template <typename EventType>
+  BankStatistics fillEvents(
+      const std::vector<std::vector<std::vector<EventType> *>> &eventVectors);
+  template <typename EventType>
+  BankStatistics fillCompressed(
+      const std::vector<std::vector<std::vector<EventType> *>> &eventVectors);
+  std::vector<size_t> splitPulses(const size_t numKeys) const;
+  template <typename Visitor>
+  void visitEvents(const size_t firstPulse, const size_t lastPulse,
+                   Visitor &&visit) const;
   size_t getWorkspaceIndexFromPixelID(const detid_t pixID);
   size_t getFirstEventIndex(const size_t pulseIndex) const;
   size_t getLastEventIndex(const size_t pulseIndex,
@@ -74,9 +111,9 @@ private:
   /// Progress reporting
   API::Progress *prog;
   /// event pixel ID array
-  std::shared_ptr<std::vector<uint32_t>> event_id;
+  std::shared_ptr<const uint32_t> event_id;
   /// event TOF array
-  std::shared_ptr<std::vector<float>> event_time_of_flight;
+  std::shared_ptr<const float> event_time_of_flight;
   /// # of events in arrays
   size_t numEvents;
   /// index of the first event from event_index
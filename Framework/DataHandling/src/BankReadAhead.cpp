@@ -0,0 +1,127 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidDataHandling/BankReadAhead.h"
+#include "MantidKernel/ConfigService.h"
+#include "MantidKernel/Timer.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace Mantid {
+namespace DataHandling {
+
+/** Constructor
+ * @param maxBanks :: maximum number of banks read but not yet processed
+ * (at least 1)
+ * @param maxBytes :: maximum number of bytes read but not yet processed
+ */
+BankReadAhead::BankReadAhead(const size_t maxBanks, const size_t maxBytes)
+    : m_maxBanks(std::max(maxBanks, size_t{1})), m_maxBytes(maxBytes) {}
+
+/** Create using the limits in the configuration,
+ * loadeventnexus.readahead.depth (number of banks) and
+ * loadeventnexus.readahead.memory (MB), falling back to the defaults.
+ * @return a new BankReadAhead
+ */
+BankReadAhead BankReadAhead::fromConfig() {
+  auto &config = Kernel::ConfigService::Instance();
+  const auto depth = config.getValue<int>("loadeventnexus.readahead.depth");
+  const auto memory = config.getValue<int>("loadeventnexus.readahead.memory");
+  const size_t maxBanks = (depth.is_initialized() && depth.get() > 0)
+                              ? static_cast<size_t>(depth.get())
+                              : DEFAULT_DEPTH;
+  const size_t maxMB = (memory.is_initialized() && memory.get() > 0)
+                           ? static_cast<size_t>(memory.get())
+                           : DEFAULT_MEMORY_MB;
+  return BankReadAhead(maxBanks, maxMB * 1024 * 1024);
+}
+
+/** Wait until there is room for another bank of the given size, then take it.
+ * Never waits if nothing else is in flight.
+ * @param bytes :: memory the bank will use
+ * @return a ticket that gives the room back when the last copy is destroyed
+ */
+BankReadAhead::Ticket BankReadAhead::acquire(const size_t bytes) {
+  Kernel::Timer timer;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_released.wait(lock, [this, bytes] {
+    return m_banksInFlight == 0 || (m_banksInFlight < m_maxBanks &&
+                                    m_bytesInFlight + bytes <= m_maxBytes);
+  });
+  ++m_banksInFlight;
+  m_bytesInFlight += bytes;
+  m_waitTime += timer.elapsed();
+  return Ticket(nullptr, [this, bytes](void *) { release(bytes); });
+}
+
+/// Give back the room taken by a bank
+void BankReadAhead::release(const size_t bytes) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    --m_banksInFlight;
+    m_bytesInFlight -= bytes;
+  }
+  m_released.notify_all();
+}
+
+/// Add to the total time spent reading banks
+void BankReadAhead::addReadTime(const double seconds) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_readTime += seconds;
+}
+
+/// Add to the total time spent processing banks
+void BankReadAhead::addProcessTime(const double seconds) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_processTime += seconds;
+}
+
+/// @return the number of banks read but not yet processed
+size_t BankReadAhead::banksInFlight() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_banksInFlight;
+}
+
+/// @return the number of bytes read but not yet processed
+size_t BankReadAhead::bytesInFlight() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_bytesInFlight;
+}
+
+/// @return the total time spent reading banks, in seconds
+double BankReadAhead::readTime() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_readTime;
+}
+
+/// @return the total time spent processing banks, summed over threads, in
+/// seconds
+double BankReadAhead::processTime() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_processTime;
+}
+
+/// @return the total time reading was held up waiting for processing to
+/// catch up, in seconds
+double BankReadAhead::waitTime() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_waitTime;
+}
+
+/// @return a one line description of where the time went
+std::string BankReadAhead::summary() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::ostringstream out;
+  out << "reading " << m_readTime << " s, processing " << m_processTime
+      << " s (all threads), reading waited " << m_waitTime
+      << " s for processing (depth " << m_maxBanks << " banks, "
+      << m_maxBytes / (1024 * 1024) << " MB)";
+  return out.str();
+}
+
+} // namespace DataHandling
+} // namespace Mantid
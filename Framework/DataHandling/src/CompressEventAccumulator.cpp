@@ -0,0 +1,240 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidDataHandling/CompressEventAccumulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+using Mantid::DataObjects::WeightedEvent;
+using Mantid::DataObjects::WeightedEventNoTime;
+using Mantid::Types::Core::DateAndTime;
+
+namespace Mantid {
+namespace DataHandling {
+
+namespace {
+/// Bins are folded in once at least this many events are waiting
+constexpr size_t MIN_PENDING = 64;
+
+/// Weight of an event in the average time-of-flight, as in EventList
+inline double calcNorm(const double errorSquared) {
+  if (errorSquared == 0.)
+    return 0;
+  else if (errorSquared == 1.)
+    return 1.;
+  else
+    return 1. / std::sqrt(errorSquared);
+}
+} // namespace
+
+/** Constructor
+ * @param tolerance :: width of the bins, in the units of the times-of-flight
+ * for LINEAR, relative for LOGARITHMIC
+ * @param mode :: how the bins are laid out
+ * @throws std::invalid_argument if the tolerance is negative, or not positive
+ * in LOGARITHMIC mode
+ */
+CompressEventAccumulator::CompressEventAccumulator(
+    const double tolerance, const CompressBinningMode mode)
+    : m_tolerance(tolerance), m_mode(mode), m_inverseLogStep(0.) {
+  if (!(tolerance >= 0.))
+    throw std::invalid_argument(
+        "CompressEventAccumulator: the tolerance cannot be negative");
+  if (mode == CompressBinningMode::LOGARITHMIC) {
+    if (tolerance == 0.)
+      throw std::invalid_argument("CompressEventAccumulator: logarithmic "
+                                  "compression needs a positive tolerance");
+    m_inverseLogStep = 1. / std::log1p(tolerance);
+  }
+}
+
+/** Add an event
+ * @param tof :: its time-of-flight
+ * @param weight :: its weight
+ * @param errorSquared :: the square of the error on its weight
+ */
+void CompressEventAccumulator::addEvent(const double tof, const float weight,
+                                        const float errorSquared) {
+  const double norm = calcNorm(errorSquared);
+  addBin({binIndex(tof), tof * norm, norm, weight, errorSquared, 0., 1});
+}
+
+/** Add an event with a pulse time
+ * @param tof :: its time-of-flight
+ * @param pulseTime :: its pulse time
+ * @param weight :: its weight
+ * @param errorSquared :: the square of the error on its weight
+ */
+void CompressEventAccumulator::addEvent(const double tof,
+                                        const DateAndTime pulseTime,
+                                        const float weight,
+                                        const float errorSquared) {
+  if (empty())
+    m_pulseTimeReference = pulseTime.totalNanoseconds();
+  const double norm = calcNorm(errorSquared);
+  const auto pulseTimeOffset =
+      static_cast<double>(pulseTime.totalNanoseconds() - m_pulseTimeReference);
+  addBin({binIndex(tof), tof * norm, norm, weight, errorSquared,
+          pulseTimeOffset, 1});
+}
+
+/** Move the events of another accumulator, with the same tolerance and
+ * mode, into this one
+ * @param other :: the accumulator to empty into this one
+ */
+void CompressEventAccumulator::merge(CompressEventAccumulator &other) {
+  other.flush();
+  if (empty()) {
+    m_bins.swap(other.m_bins);
+    m_pulseTimeReference = other.m_pulseTimeReference;
+    return;
+  }
+  flush();
+  const auto shift = static_cast<double>(other.m_pulseTimeReference -
+                                         m_pulseTimeReference);
+  m_pending.reserve(other.m_bins.size());
+  for (auto bin : other.m_bins) {
+    bin.pulseTimeSum += shift * static_cast<double>(bin.count);
+    m_pending.emplace_back(bin);
+  }
+  std::vector<Bin>().swap(other.m_bins);
+  flush();
+}
+
+/** Replace the contents of a vector with one event per bin, in increasing
+ * order of time-of-flight. The accumulator is left empty.
+ * @param events :: the compressed events
+ */
+void CompressEventAccumulator::createWeightedEvents(
+    std::vector<WeightedEventNoTime> &events) {
+  flush();
+  events.clear();
+  events.reserve(m_bins.size());
+  for (const auto &bin : m_bins)
+    events.emplace_back(averageTof(bin), bin.weight, bin.errorSquared);
+  std::vector<Bin>().swap(m_bins);
+}
+
+/** Replace the contents of a vector with one event per bin, in increasing
+ * order of time-of-flight, each at the average pulse time of its events. The
+ * accumulator is left empty.
+ * @param events :: the compressed events
+ */
+void CompressEventAccumulator::createWeightedEvents(
+    std::vector<WeightedEvent> &events) {
+  flush();
+  events.clear();
+  events.reserve(m_bins.size());
+  for (const auto &bin : m_bins) {
+    const DateAndTime pulseTime(
+        m_pulseTimeReference +
+        std::llround(bin.pulseTimeSum / static_cast<double>(bin.count)));
+    events.emplace_back(averageTof(bin), pulseTime, bin.weight,
+                        bin.errorSquared);
+  }
+  std::vector<Bin>().swap(m_bins);
+}
+
+/// @return the number of compressed events so far
+size_t CompressEventAccumulator::numberOfBins() {
+  flush();
+  return m_bins.size();
+}
+
+/// Queue the bin of a new event, folding the queue in once it is long enough
+void CompressEventAccumulator::addBin(const Bin &bin) {
+  m_pending.emplace_back(bin);
+  if (m_pending.size() >= std::max(MIN_PENDING, m_bins.size()))
+    flush();
+}
+
+/** Index of the bin of the grid holding a time-of-flight. Indices increase
+ * with the time-of-flight.
+ * @param tof :: the time-of-flight
+ */
+int64_t CompressEventAccumulator::binIndex(const double tof) const {
+  if (m_mode == CompressBinningMode::LOGARITHMIC) {
+    if (!(tof > 0.))
+      return std::numeric_limits<int64_t>::min();
+    return static_cast<int64_t>(std::floor(std::log(tof) * m_inverseLogStep));
+  }
+  if (m_tolerance == 0.) {
+    // Order the bit patterns of the times-of-flight like their values
+    int64_t bits;
+    std::memcpy(&bits, &tof, sizeof(bits));
+    return bits < 0 ? std::numeric_limits<int64_t>::min() - bits - 1 : bits;
+  }
+  return static_cast<int64_t>(std::floor(tof / m_tolerance));
+}
+
+/** Smallest time-of-flight of a bin, the inverse of binIndex
+ * @param index :: the index of the bin
+ */
+double CompressEventAccumulator::lowerEdge(const int64_t index) const {
+  if (m_mode == CompressBinningMode::LOGARITHMIC) {
+    if (index == std::numeric_limits<int64_t>::min())
+      return 0.;
+    return std::exp(static_cast<double>(index) / m_inverseLogStep);
+  }
+  if (m_tolerance == 0.) {
+    const int64_t bits =
+        index < 0 ? std::numeric_limits<int64_t>::min() - index - 1 : index;
+    double tof;
+    std::memcpy(&tof, &bits, sizeof(tof));
+    return tof;
+  }
+  return static_cast<double>(index) * m_tolerance;
+}
+
+/** Average time-of-flight of the events of a bin. Events without an error
+ * have no say in the average, so a bin holding only such events is put at
+ * its lower edge.
+ * @param bin :: the bin
+ */
+double CompressEventAccumulator::averageTof(const Bin &bin) const {
+  return bin.normalization != 0. ? bin.tofSum / bin.normalization
+                                 : lowerEdge(bin.index);
+}
+
+/// Fold the pending events into the sorted bins
+void CompressEventAccumulator::flush() {
+  if (m_pending.empty())
+    return;
+  std::sort(m_pending.begin(), m_pending.end(),
+            [](const Bin &a, const Bin &b) { return a.index < b.index; });
+
+  std::vector<Bin> merged;
+  merged.reserve(m_bins.size() + m_pending.size());
+  auto bin = m_bins.cbegin();
+  auto pending = m_pending.cbegin();
+  while (bin != m_bins.cend() || pending != m_pending.cend()) {
+    const Bin &next =
+        pending == m_pending.cend() ||
+                (bin != m_bins.cend() && bin->index <= pending->index)
+            ? *bin++
+            : *pending++;
+    if (!merged.empty() && merged.back().index == next.index) {
+      auto &last = merged.back();
+      last.tofSum += next.tofSum;
+      last.normalization += next.normalization;
+      last.weight += next.weight;
+      last.errorSquared += next.errorSquared;
+      last.pulseTimeSum += next.pulseTimeSum;
+      last.count += next.count;
+    } else {
+      merged.emplace_back(next);
+    }
+  }
+  m_bins.swap(merged);
+  m_pending.clear();
+}
+
+} // namespace DataHandling
+} // namespace Mantid
@@ -8,8 +8,10 @@
 #include "MantidAPI/Progress.h"
 #include "MantidDataHandling/LoadBankFromDiskTask.h"
 #include "MantidDataHandling/LoadEventNexus.h"
+#include "MantidDataHandling/MemoryMappedDataset.h"
 #include "MantidKernel/ThreadPool.h"
 #include "MantidKernel/ThreadSchedulerMutexes.h"
+#include "MantidKernel/Timer.h"
 
 using namespace Mantid::Kernel;
 
@@ -22,10 +24,10 @@ void DefaultEventLoader::load(LoadEventNexus *alg, EventWorkspaceCollection &ws,
                               const std::vector<int> &periodLog,
                               const std::string &classType,
                               std::vector<std::size_t> bankNumEvents,
-                              const bool oldNeXusFileNames, const bool precount,
-                              const int chunk, const int totalChunks) {
+                              const bool oldNeXusFileNames, const int chunk,
+                              const int totalChunks) {
   DefaultEventLoader loader(alg, ws, haveWeights, event_id_is_spec,
-                            bankNames.size(), precount, chunk, totalChunks);
+                            bankNames.size(), chunk, totalChunks);
 
   auto bankRange = loader.setupChunking(bankNames, bankNumEvents);
 
@@ -47,19 +49,28 @@ void DefaultEventLoader::load(LoadEventNexus *alg, EventWorkspaceCollection &ws,
           prog.get(), diskIOMutex, *scheduler, periodLog));
   }
   // Start and end all threads
+  Timer timer;
+  const size_t mappedBefore = MemoryMappedDataset::mappedCount();
   pool.joinAll();
   diskIOMutex.reset();
+  auto &log = alg->getLogger().information();
+  log << "Loaded banks in " << timer.elapsed() << " s: "
+      << loader.readAhead.summary();
+  if (loader.memoryMap)
+    log << ", " << MemoryMappedDataset::mappedCount() - mappedBefore
+        << " fields mapped from the file";
+  log << "\n";
 }
 
 DefaultEventLoader::DefaultEventLoader(LoadEventNexus *alg,
                                        EventWorkspaceCollection &ws,
                                        bool haveWeights, bool event_id_is_spec,
-                                       const size_t numBanks,
-                                       const bool precount, const int chunk,
+                                       const size_t numBanks, const int chunk,
                                        const int totalChunks)
     : m_haveWeights(haveWeights), event_id_is_spec(event_id_is_spec),
-      precount(precount), chunk(chunk), totalChunks(totalChunks), alg(alg),
-      m_ws(ws) {
+      chunk(chunk), totalChunks(totalChunks), alg(alg),
+      m_ws(ws), readAhead(BankReadAhead::fromConfig()),
+      memoryMap(MemoryMappedDataset::enabled()) {
   // This map will be used to find the workspace index
   if (event_id_is_spec)
     pixelID_to_wi_vector =
@@ -0,0 +1,416 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidDataHandling/EventWorkspaceCache.h"
+#include "MantidDataObjects/EventList.h"
+#include "MantidKernel/ChecksumHelper.h"
+#include "MantidKernel/ConfigService.h"
+#include "MantidKernel/Logger.h"
+#include "MantidKernel/Timer.h"
+
+#include <Poco/DirectoryIterator.h>
+#include <Poco/File.h>
+#include <Poco/Path.h>
+#include <Poco/TemporaryFile.h>
+#include <Poco/Timestamp.h>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "tbb/parallel_for.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <tuple>
+
+using Mantid::DataObjects::EventList;
+using Mantid::DataObjects::WeightedEvent;
+using Mantid::DataObjects::WeightedEventNoTime;
+using Mantid::Types::Event::TofEvent;
+
+namespace Mantid {
+namespace DataHandling {
+
+namespace {
+/// static logger
+Kernel::Logger g_log("EventWorkspaceCache");
+
+/// Extension of the entries
+const std::string EXTENSION = ".eventcache";
+/// Marks the start of an entry
+constexpr char MAGIC[8] = {'M', 'T', 'D', 'E', 'V', 'C', 'A', 'C'};
+/// Changed whenever the layout of an entry changes
+constexpr uint32_t FORMAT_VERSION = 1;
+
+/// Start of an entry
+struct Header {
+  char magic[8];
+  uint32_t version;
+  /// Sizes of the event types, as written by this build
+  uint32_t eventSizes[3];
+  uint64_t fileSize;
+  uint64_t numLists;
+  double shortestTof;
+  double longestTof;
+  uint64_t badTofs;
+  uint64_t discardedEvents;
+};
+
+/// Where the events of one list are in an entry
+struct ListEntry {
+  uint32_t eventType;
+  uint32_t sortOrder;
+  uint64_t offset;
+  uint64_t numEvents;
+};
+
+/// Size of one event of a type
+size_t eventSize(const uint32_t eventType) {
+  switch (eventType) {
+  case API::TOF:
+    return sizeof(TofEvent);
+  case API::WEIGHTED:
+    return sizeof(WeightedEvent);
+  case API::WEIGHTED_NOTIME:
+    return sizeof(WeightedEventNoTime);
+  default:
+    return 0;
+  }
+}
+
+/// Write events as raw bytes
+template <typename EventType>
+void writeEvents(std::ostream &out, const std::vector<EventType> &events) {
+  out.write(reinterpret_cast<const char *>(events.data()),
+            static_cast<std::streamsize>(events.size() * sizeof(EventType)));
+}
+
+/** Write the events of a list as rows. Lists held as columns or compact
+ * events are converted one at a time through the storage-agnostic accessors,
+ * so saving neither changes their storage nor leaves a row copy behind.
+ * @param out :: the stream to write to
+ * @param list :: the list to write
+ */
+void writeEvents(std::ostream &out, const EventList &list) {
+  if (list.getStorageType() == DataObjects::ROW_STORAGE) {
+    switch (list.getEventType()) {
+    case API::TOF:
+      writeEvents(out, list.getEvents());
+      break;
+    case API::WEIGHTED:
+      writeEvents(out, list.getWeightedEvents());
+      break;
+    default:
+      writeEvents(out, list.getWeightedEventsNoTime());
+      break;
+    }
+    return;
+  }
+
+  const auto tofs = list.getTofs();
+  switch (list.getEventType()) {
+  case API::TOF: {
+    const auto pulseTimes = list.getPulseTimes();
+    std::vector<TofEvent> events;
+    events.reserve(tofs.size());
+    for (size_t i = 0; i < tofs.size(); ++i)
+      events.emplace_back(tofs[i], pulseTimes[i]);
+    writeEvents(out, events);
+    break;
+  }
+  case API::WEIGHTED: {
+    const auto pulseTimes = list.getPulseTimes();
+    const auto weights = list.getWeights();
+    const auto errors = list.getWeightErrors();
+    std::vector<WeightedEvent> events;
+    events.reserve(tofs.size());
+    for (size_t i = 0; i < tofs.size(); ++i)
+      events.emplace_back(tofs[i], pulseTimes[i], weights[i],
+                          errors[i] * errors[i]);
+    writeEvents(out, events);
+    break;
+  }
+  default: {
+    const auto weights = list.getWeights();
+    const auto errors = list.getWeightErrors();
+    std::vector<WeightedEventNoTime> events;
+    events.reserve(tofs.size());
+    for (size_t i = 0; i < tofs.size(); ++i)
+      events.emplace_back(tofs[i], weights[i], errors[i] * errors[i]);
+    writeEvents(out, events);
+    break;
+  }
+  }
+}
+
+/// Copy events from a mapped entry into a list
+template <typename EventType>
+void assignEvents(std::vector<EventType> &events, const char *data,
+                  const size_t numEvents) {
+  const auto *first = reinterpret_cast<const EventType *>(data);
+  events.assign(first, first + numEvents);
+}
+} // namespace
+
+/** Constructor
+ * @param directory :: where the entries are kept; empty to disable the cache
+ * @param maxBytes :: maximum size of all the entries
+ */
+EventWorkspaceCache::EventWorkspaceCache(std::string directory,
+                                         const uint64_t maxBytes)
+    : m_directory(std::move(directory)), m_maxBytes(maxBytes) {}
+
+/** Create using the loadeventnexus.cache.directory and
+ * loadeventnexus.cache.size (MB) keys of the configuration
+ * @return a new EventWorkspaceCache, disabled if no directory is set
+ */
+EventWorkspaceCache EventWorkspaceCache::fromConfig() {
+  auto &config = Kernel::ConfigService::Instance();
+  const auto size = config.getValue<int>("loadeventnexus.cache.size");
+  const uint64_t sizeMB = (size.is_initialized() && size.get() > 0)
+                              ? static_cast<uint64_t>(size.get())
+                              : DEFAULT_SIZE_MB;
+  return EventWorkspaceCache(
+      config.getString("loadeventnexus.cache.directory"),
+      sizeMB * 1024 * 1024);
+}
+
+/** Build the key of the entry for a file loaded with some options
+ * @param filename :: the file being loaded
+ * @param options :: every loader option that can change the events
+ * @return a key that changes with the file or the options
+ */
+std::string EventWorkspaceCache::makeKey(const std::string &filename,
+                                         const std::string &options) {
+  std::ostringstream identity;
+  identity << FORMAT_VERSION << '\n' << fileIdentity(filename) << options;
+  return Kernel::ChecksumHelper::sha1FromString(identity.str());
+}
+
+/** Identity of a file for a key: its absolute path, modification time and
+ * size, one per line
+ * @param filename :: an existing file
+ * @return text that changes when the file does
+ */
+std::string EventWorkspaceCache::fileIdentity(const std::string &filename) {
+  const Poco::File file(filename);
+  std::ostringstream identity;
+  identity << Poco::Path(filename).absolute().toString() << '\n'
+           << file.getLastModified().epochMicroseconds() << '\n'
+           << file.getSize() << '\n';
+  return identity.str();
+}
+
+/** Path of the entry for a key
+ * @param key :: from makeKey
+ */
+std::string EventWorkspaceCache::entryPath(const std::string &key) const {
+  Poco::Path path(m_directory);
+  path.makeDirectory();
+  path.setFileName(key + EXTENSION);
+  return path.toString();
+}
+
+/** Fill event lists from the entry for a key, if there is one
+ * @param key :: from makeKey
+ * @param lists :: the lists to fill, all periods one after the other; they
+ * must be as many as when the entry was saved
+ * @param statistics :: [output] the totals of the load that was saved
+ * @return true on a hit; on a miss the lists are untouched
+ */
+bool EventWorkspaceCache::load(const std::string &key,
+                               const std::vector<EventList *> &lists,
+                               LoadStatistics &statistics) const {
+  if (!enabled())
+    return false;
+  const std::string path = entryPath(key);
+  Kernel::Timer timer;
+  try {
+    Poco::File entry(path);
+    if (!entry.exists()) {
+      g_log.information() << "Event cache miss for key " << key << "\n";
+      return false;
+    }
+
+    using namespace boost::interprocess;
+    const file_mapping file(path.c_str(), read_only);
+    mapped_region region(file, read_only);
+    const auto *base = static_cast<const char *>(region.get_address());
+    const size_t fileSize = region.get_size();
+
+    Header header;
+    if (fileSize < sizeof(header))
+      throw std::runtime_error("truncated header");
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != FORMAT_VERSION ||
+        header.eventSizes[0] != sizeof(TofEvent) ||
+        header.eventSizes[1] != sizeof(WeightedEvent) ||
+        header.eventSizes[2] != sizeof(WeightedEventNoTime) ||
+        header.fileSize != fileSize)
+      throw std::runtime_error("not an entry written by this version");
+    if (header.numLists != lists.size())
+      throw std::runtime_error("the number of spectra differs");
+    if (fileSize < sizeof(header) + lists.size() * sizeof(ListEntry))
+      throw std::runtime_error("truncated table");
+
+    std::vector<ListEntry> table(lists.size());
+    std::memcpy(table.data(), base + sizeof(header),
+                table.size() * sizeof(ListEntry));
+    for (const auto &listEntry : table) {
+      const size_t size = eventSize(listEntry.eventType);
+      if (size == 0 || listEntry.offset > fileSize ||
+          listEntry.numEvents > (fileSize - listEntry.offset) / size)
+        throw std::runtime_error("corrupt table");
+    }
+
+    region.advise(mapped_region::advice_sequential);
+    tbb::parallel_for(size_t{0}, lists.size(), [&](const size_t i) {
+      const auto &listEntry = table[i];
+      auto &list = *lists[i];
+      const char *data = base + listEntry.offset;
+      const auto numEvents = static_cast<size_t>(listEntry.numEvents);
+      list.clear(false);
+      list.switchTo(static_cast<API::EventType>(listEntry.eventType));
+      switch (listEntry.eventType) {
+      case API::TOF:
+        assignEvents(list.getEvents(), data, numEvents);
+        break;
+      case API::WEIGHTED:
+        assignEvents(list.getWeightedEvents(), data, numEvents);
+        break;
+      default:
+        assignEvents(list.getWeightedEventsNoTime(), data, numEvents);
+      }
+      list.setSortOrder(
+          static_cast<DataObjects::EventSortType>(listEntry.sortOrder));
+    });
+
+    statistics.shortestTof = header.shortestTof;
+    statistics.longestTof = header.longestTof;
+    statistics.badTofs = header.badTofs;
+    statistics.discardedEvents = header.discardedEvents;
+
+    // Mark the entry as recently used
+    entry.setLastModified(Poco::Timestamp());
+    g_log.information() << "Event cache hit for key " << key << ": read "
+                        << fileSize / (1024 * 1024) << " MB in " << timer
+                        << "\n";
+    return true;
+  } catch (const std::exception &e) {
+    g_log.warning() << "Ignoring event cache entry " << path << ": "
+                    << e.what() << "\n";
+  }
+  return false;
+}
+
+/** Save event lists as the entry for a key, then evict old entries. Failures
+ * are logged, never thrown, so they cannot fail a load.
+ * @param key :: from makeKey
+ * @param lists :: the lists to save, all periods one after the other
+ * @param statistics :: the totals of the load
+ */
+void EventWorkspaceCache::save(const std::string &key,
+                               const std::vector<const EventList *> &lists,
+                               const LoadStatistics &statistics) const {
+  if (!enabled())
+    return;
+  Kernel::Timer timer;
+  std::string temporary;
+  try {
+    Poco::File(m_directory).createDirectories();
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.eventSizes[0] = sizeof(TofEvent);
+    header.eventSizes[1] = sizeof(WeightedEvent);
+    header.eventSizes[2] = sizeof(WeightedEventNoTime);
+    header.numLists = lists.size();
+    header.shortestTof = statistics.shortestTof;
+    header.longestTof = statistics.longestTof;
+    header.badTofs = statistics.badTofs;
+    header.discardedEvents = statistics.discardedEvents;
+
+    std::vector<ListEntry> table(lists.size());
+    uint64_t offset = sizeof(header) + table.size() * sizeof(ListEntry);
+    for (size_t i = 0; i < lists.size(); ++i) {
+      auto &listEntry = table[i];
+      listEntry.eventType = static_cast<uint32_t>(lists[i]->getEventType());
+      listEntry.sortOrder = static_cast<uint32_t>(lists[i]->getSortType());
+      listEntry.offset = offset;
+      listEntry.numEvents = lists[i]->getNumberEvents();
+      offset += listEntry.numEvents * eventSize(listEntry.eventType);
+    }
+    header.fileSize = offset;
+
+    // Write under another name so readers never see a partial entry
+    temporary = Poco::TemporaryFile::tempName(m_directory);
+    std::ofstream out(temporary, std::ios::binary);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(table.data()),
+              static_cast<std::streamsize>(table.size() * sizeof(ListEntry)));
+    for (const auto *list : lists)
+      writeEvents(out, *list);
+    out.close();
+    if (!out)
+      throw std::runtime_error("could not write " + temporary);
+    Poco::File(temporary).renameTo(entryPath(key));
+    g_log.information() << "Saved " << offset / (1024 * 1024)
+                        << " MB to the event cache for key " << key << " in "
+                        << timer << "\n";
+  } catch (const std::exception &e) {
+    g_log.warning() << "Could not save to the event cache in " << m_directory
+                    << ": " << e.what() << "\n";
+    if (!temporary.empty()) {
+      try {
+        Poco::File(temporary).remove();
+      } catch (const std::exception &) {
+      }
+    }
+    return;
+  }
+  evict(key);
+}
+
+/** Remove the least recently used entries until the cache fits its budget
+ * @param keep :: key of an entry that must not be removed
+ */
+void EventWorkspaceCache::evict(const std::string &keep) const {
+  if (!enabled())
+    return;
+  try {
+    const std::string keepName = keep.empty() ? "" : keep + EXTENSION;
+    std::vector<std::tuple<Poco::Timestamp, uint64_t, std::string>> entries;
+    uint64_t totalBytes = 0;
+    for (Poco::DirectoryIterator it(m_directory), end; it != end; ++it) {
+      if (!it->isFile() || Poco::Path(it->path()).getExtension() !=
+                               EXTENSION.substr(1))
+        continue;
+      const auto size = static_cast<uint64_t>(it->getSize());
+      entries.emplace_back(it->getLastModified(), size, it->path());
+      totalBytes += size;
+    }
+    std::sort(entries.begin(), entries.end());
+    for (const auto &entry : entries) {
+      if (totalBytes <= m_maxBytes)
+        break;
+      const auto &path = std::get<2>(entry);
+      if (Poco::Path(path).getFileName() == keepName)
+        continue;
+      Poco::File(path).remove();
+      totalBytes -= std::get<1>(entry);
+      g_log.information() << "Evicted " << path << " from the event cache\n";
+    }
+  } catch (const std::exception &e) {
+    g_log.warning() << "Could not evict from the event cache in "
+                    << m_directory << ": " << e.what() << "\n";
+  }
+}
+
+} // namespace DataHandling
+} // namespace Mantid
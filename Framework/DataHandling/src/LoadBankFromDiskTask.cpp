@@ -8,7 +8,9 @@
 #include "MantidDataHandling/BankPulseTimes.h"
 #include "MantidDataHandling/DefaultEventLoader.h"
 #include "MantidDataHandling/LoadEventNexus.h"
+#include "MantidDataHandling/MemoryMappedDataset.h"
 #include "MantidDataHandling/ProcessBankData.h"
+#include "MantidKernel/Timer.h"
 #include "MantidKernel/Unit.h"
 #include "MantidNexus/NexusIOHelper.h"
 #include <algorithm>
@@ -185,21 +187,70 @@ void LoadBankFromDiskTask::prepareEventId(
   m_loader.alg->getLogger().debug()
       << entry_name << ": start_event " << start_event << " stop_event "
       << stop_event << "\n";
+  file.closeData();
+}
+
+/** Map a field of this bank straight from the file if that is enabled and
+ * the field is stored in a way that allows it
+ * @param key :: name of the field in the bank
+ * @return the mapped part of the field to load, or nullptr if it has to be
+ * read instead
+ */
+template <typename T>
+std::shared_ptr<const T>
+LoadBankFromDiskTask::mapDataset(const std::string &key) const {
+  if (!m_loader.memoryMap)
+    return nullptr;
+  const std::string path =
+      "/" + m_loader.alg->m_top_entry_name + "/" + entry_name + "/" + key;
+  return MemoryMappedDataset::map<T>(m_loader.alg->m_filename, path,
+                                     static_cast<size_t>(m_loadStart[0]),
+                                     static_cast<size_t>(m_loadSize[0]));
+}
+
+/// @return the name of the event_id field in this file
+std::string LoadBankFromDiskTask::eventIdKey() const {
+  return m_oldNexusFileNames ? "event_pixel_id" : "event_id";
+}
+
+/// @return the name of the event_time_offset field in this file
+std::string LoadBankFromDiskTask::tofKey() const {
+  return m_oldNexusFileNames ? "event_time_of_flight" : "event_time_offset";
 }
 
-/** Load the event_id field, which has been opened
+/** Map the times-of-flight if they are stored as float microseconds, which
+ * can be used as they are in the file
  * @param file An NeXus::File object opened at the correct group
+ * @returns the mapped times-of-flight, or nullptr if they have to be read
+ */
+std::shared_ptr<const float> LoadBankFromDiskTask::mapTof(::NeXus::File &file) {
+  if (!m_loader.memoryMap)
+    return nullptr;
+  const std::string key = tofKey();
+  std::string tof_unit;
+  file.openData(key);
+  const ::NeXus::Info tof_info = file.getInfo();
+  file.getAttr("units", tof_unit);
+  file.closeData();
+  if (tof_info.type != ::NeXus::FLOAT32 ||
+      Kernel::Units::timeConversionValue(tof_unit, "microseconds") != 1.)
+    return nullptr;
+  return mapDataset<float>(key);
+}
+
+/** Open and load the event_id field
+ * @param file An NeXus::File object opened at the correct group
+ * @param mapped :: the field mapped by mapDataset, or nullptr to read it
  * @returns A new array containing the event Ids for this bank
  */
-std::unique_ptr<std::vector<uint32_t>>
-LoadBankFromDiskTask::loadEventId(::NeXus::File &file) {
+std::shared_ptr<const uint32_t>
+LoadBankFromDiskTask::loadEventId(::NeXus::File &file,
+                                  std::shared_ptr<const uint32_t> mapped) {
+  file.openData(eventIdKey());
   // This is the data size
   ::NeXus::Info id_info = file.getInfo();
   int64_t dim0 = recalculateDataSize(id_info.dims[0]);
 
-  // Now we allocate the required arrays
-  auto event_id = std::make_unique<std::vector<uint32_t>>(m_loadSize[0]);
-
   // Check that the required space is there in the file.
   if (dim0 < m_loadSize[0] + m_loadStart[0]) {
     m_loader.alg->getLogger().warning()
@@ -212,23 +263,31 @@ LoadBankFromDiskTask::loadEventId(::NeXus::File &file) {
   if (m_loader.alg->getCancel())
     m_loadError = true; // To allow cancelling the algorithm
 
+  std::shared_ptr<const uint32_t> event_id;
   if (!m_loadError) {
     // Must be uint32
-    if (id_info.type == ::NeXus::UINT32)
-      file.getSlab(event_id->data(), m_loadStart, m_loadSize);
-    else {
+    if (id_info.type == ::NeXus::UINT32) {
+      event_id = std::move(mapped);
+      if (!event_id) {
+        auto ids = std::make_shared<std::vector<uint32_t>>(m_loadSize[0]);
+        file.getSlab(ids->data(), m_loadStart, m_loadSize);
+        event_id = std::shared_ptr<const uint32_t>(ids, ids->data());
+      }
+    } else {
       m_loader.alg->getLogger().warning()
           << "Entry " << entry_name
           << "'s event_id field is not UINT32! It will be skipped.\n";
       m_loadError = true;
     }
     file.closeData();
+  }
 
+  if (event_id) {
     // determine the range of pixel ids
-    m_min_id =
-        *(std::min_element(event_id->data(), event_id->data() + m_loadSize[0]));
-    m_max_id =
-        *(std::max_element(event_id->data(), event_id->data() + m_loadSize[0]));
+    const auto range =
+        std::minmax_element(event_id.get(), event_id.get() + m_loadSize[0]);
+    m_min_id = *range.first;
+    m_max_id = *range.second;
 
     if (m_min_id > static_cast<uint32_t>(m_loader.eventid_max)) {
       // All the detector IDs in the bank are higher than the highest 'known'
@@ -254,20 +313,15 @@ LoadBankFromDiskTask::loadEventId(::NeXus::File &file) {
 
 /** Open and load the times-of-flight data
  * @param file An NeXus::File object opened at the correct group
+ * @param mapped :: the field mapped by mapTof, or nullptr to read it
  * @returns A new array containing the time of flights for this bank
  */
-std::unique_ptr<std::vector<float>>
-LoadBankFromDiskTask::loadTof(::NeXus::File &file) {
-  // Allocate the array
-  auto event_time_of_flight =
-      std::make_unique<std::vector<float>>(m_loadSize[0]);
-
+std::shared_ptr<const float>
+LoadBankFromDiskTask::loadTof(::NeXus::File &file,
+                              std::shared_ptr<const float> mapped) {
   // Get the list of event_time_of_flight's
-  std::string key, tof_unit;
-  if (!m_oldNexusFileNames)
-    key = "event_time_offset";
-  else
-    key = "event_time_of_flight";
+  const std::string key = tofKey();
+  std::string tof_unit;
   file.openData(key);
 
   // Check that the required space is there in the file.
@@ -280,23 +334,26 @@ LoadBankFromDiskTask::loadTof(::NeXus::File &file) {
            "to load the desired data.\n";
     m_loadError = true;
   }
+  if (mapped) {
+    file.closeData();
+    return mapped;
+  }
+  file.getAttr("units", tof_unit);
 
   // Mantid assumes event_time_offset to be float.
   // Nexus only requires event_time_offset to be a NXNumber.
   // We thus have to consider 32-bit or 64-bit options, and we
   // explicitly allow downcasting using the additional AllowDowncasting
   // template argument.
-  auto vec =
-      NeXus::NeXusIOHelper::readNexusSlab<float,
-                                          NeXus::NeXusIOHelper::AllowNarrowing>(
-          file, key, m_loadStart, m_loadSize);
-  file.getAttr("units", tof_unit);
+  auto vec = std::make_shared<std::vector<float>>(
+      NeXus::NeXusIOHelper::readNexusSlab<
+          float, NeXus::NeXusIOHelper::AllowNarrowing>(file, key, m_loadStart,
+                                                       m_loadSize));
   file.closeData();
   // Convert Tof to microseconds
-  Kernel::Units::timeConversionVector(vec, tof_unit, "microseconds");
-  std::copy(vec.begin(), vec.end(), event_time_of_flight->data());
+  Kernel::Units::timeConversionVector(*vec, tof_unit, "microseconds");
 
-  return event_time_of_flight;
+  return std::shared_ptr<const float>(vec, vec->data());
 }
 
 /** Load weight of weigthed events if they exist
@@ -357,11 +414,15 @@ void LoadBankFromDiskTask::run() {
   prog->report(entry_name + ": load from disk");
 
   // arrays to load into
-  std::unique_ptr<std::vector<uint32_t>> event_id;
-  std::unique_ptr<std::vector<float>> event_time_of_flight;
+  std::shared_ptr<const uint32_t> event_id;
+  std::shared_ptr<const float> event_time_of_flight;
   std::unique_ptr<std::vector<float>> event_weight;
   std::vector<uint64_t> event_index;
 
+  // Holds a share of the read-ahead budget until the bank is processed
+  BankReadAhead::Ticket ticket;
+  Kernel::Timer timer;
+
   // Open the file
   ::NeXus::File file(m_loader.alg->m_filename);
   try {
@@ -385,7 +446,7 @@ void LoadBankFromDiskTask::run() {
             << " has a mismatch between the number of event_index entries "
                "and the number of pulse times in event_time_zero.\n";
 
-      // Open and validate event_id field.
+      // Validate event_id field.
       int64_t start_event = 0;
       int64_t stop_event = 0;
       this->prepareEventId(file, start_event, stop_event, event_index);
@@ -395,8 +456,20 @@ void LoadBankFromDiskTask::run() {
       m_loadSize[0] = stop_event - start_event;
 
       if ((m_loadSize[0] > 0) && (m_loadStart[0] >= 0)) {
+        // Mapped fields are paged in from the file as they are used, so only
+        // the fields that have to be read count against the budget
+        event_id = this->mapDataset<uint32_t>(eventIdKey());
+        event_time_of_flight = this->mapTof(file);
+
+        // Wait for processing of earlier banks to make room for this one
+        const double readSoFar = timer.elapsed();
+        ticket = m_loader.readAhead.acquire(
+            bankMemory(!event_id, !event_time_of_flight));
+        timer.reset();
+        m_loader.readAhead.addReadTime(readSoFar);
+
         // Load pixel IDs
-        event_id = this->loadEventId(file);
+        event_id = this->loadEventId(file, std::move(event_id));
         if (m_loader.alg->getCancel()) {
           m_loader.alg->getLogger().error()
               << "Loading bank " << entry_name << " is cancelled.\n";
@@ -405,7 +478,8 @@ void LoadBankFromDiskTask::run() {
 
         // And TOF.
         if (!m_loadError) {
-          event_time_of_flight = this->loadTof(file);
+          event_time_of_flight =
+              this->loadTof(file, std::move(event_time_of_flight));
           if (m_have_weight) {
             event_weight = this->loadEventWeights(file);
           }
@@ -438,6 +512,7 @@ void LoadBankFromDiskTask::run() {
   // Close up the file even if errors occured.
   file.closeGroup();
   file.close();
+  m_loader.readAhead.addReadTime(timer.elapsed());
 
   // Abort if anything failed
   if (m_loadError) {
@@ -483,10 +558,12 @@ void LoadBankFromDiskTask::run() {
   auto numEvents = static_cast<size_t>(m_loadSize[0]);
   auto startAt = static_cast<size_t>(m_loadStart[0]);
 
-  // convert things to shared_arrays to share between tasks
-  std::shared_ptr<std::vector<uint32_t>> event_id_shrd(event_id.release());
-  std::shared_ptr<std::vector<float>> event_time_of_flight_shrd(
-      event_time_of_flight.release());
+  // convert things to shared_arrays to share between tasks. The ticket goes
+  // with the event ids, so the room is given back once they are processed.
+  std::shared_ptr<const uint32_t> event_id_shrd(
+      event_id.get(), [ticket, event_id](const uint32_t *) {});
+  std::shared_ptr<const float> event_time_of_flight_shrd(
+      std::move(event_time_of_flight));
   std::shared_ptr<std::vector<float>> event_weight_shrd(event_weight.release());
   auto event_index_shrd =
       std::make_shared<std::vector<uint64_t>>(std::move(event_index));
@@ -505,6 +582,21 @@ void LoadBankFromDiskTask::run() {
   }
 }
 
+/** Estimate the memory needed to hold the events of this bank while they
+ * wait to be processed
+ * @param readIds :: whether event_id is read rather than mapped
+ * @param readTofs :: whether event_time_offset is read rather than mapped
+ * @return size in bytes
+ */
+size_t LoadBankFromDiskTask::bankMemory(const bool readIds,
+                                        const bool readTofs) const {
+  // The fields that are read, plus the weights if there are any
+  const size_t bytesPerEvent = (readIds ? sizeof(uint32_t) : 0) +
+                               (readTofs ? sizeof(float) : 0) +
+                               (m_have_weight ? sizeof(float) : 0);
+  return static_cast<size_t>(m_loadSize[0]) * bytesPerEvent;
+}
+
 /**
  * Interpret the value describing the number of events. If the number is
  * positive return it unchanged.
@@ -30,6 +30,8 @@
 #include "MantidNexus/NexusIOHelper.h"
 
 #include <H5Cpp.h>
+#include <Poco/File.h>
+#include <boost/functional/hash.hpp>
 #include <memory>
 
 #include <regex>
@@ -79,7 +81,9 @@ bool exists(const std::map<std::string, std::string> &entries,
 LoadEventNexus::LoadEventNexus()
     : filter_tof_min(0), filter_tof_max(0), m_specMin(0), m_specMax(0),
       longest_tof(0), shortest_tof(0), bad_tofs(0), discarded_events(0),
-      compressTolerance(0), m_instrument_loaded_correctly(false),
+      compressTolerance(0), compressWhileLoading(false),
+      compressBinningMode(CompressBinningMode::LINEAR),
+      m_instrument_loaded_correctly(false),
       loadlogs(false), event_id_is_spec(false) {}
 
 //----------------------------------------------------------------------------------------------
@@ -180,10 +184,10 @@ void LoadEventNexus::init() {
   declareProperty(
       std::make_unique<PropertyWithValue<bool>>("Precount", true,
                                                 Direction::Input),
-      "Pre-count the number of events in each pixel before allocating memory "
-      "(optional, default True). "
-      "This can significantly reduce memory use and memory fragmentation; it "
-      "may also speed up loading.");
+      "Deprecated. Pre-count the number of events in each pixel before "
+      "allocating memory (optional, default True). Only the Multiprocess "
+      "LoadType uses it; the default loader always counts the events of each "
+      "pixel first and ignores it.");
 
   declareProperty(std::make_unique<PropertyWithValue<double>>(
                       "CompressTolerance", -1.0, Direction::Input),
@@ -192,6 +196,20 @@ void LoadEventNexus::init() {
                   "This specified the tolerance to use (in microseconds) when "
                   "compressing.");
 
+  std::vector<std::string> binningModes{"Default", "Linear", "Logarithmic"};
+  declareProperty(
+      "CompressBinningMode", "Default",
+      std::make_shared<Kernel::StringListValidator>(binningModes),
+      "How CompressTolerance is applied. Default runs CompressEvents on each "
+      "bank once it is loaded. Linear and Logarithmic compress the events of "
+      "each pixel while they are read, onto a fixed grid of bins of width "
+      "CompressTolerance (Linear) or of relative width CompressTolerance "
+      "(Logarithmic), so the uncompressed events are never stored in the "
+      "workspace. The compressed events keep their average pulse time.");
+  setPropertySettings("CompressBinningMode",
+                      std::make_unique<VisibleWhenProperty>("CompressTolerance",
+                                                            IS_NOT_DEFAULT));
+
   auto mustBePositive = std::make_shared<BoundedValidator<int>>();
   mustBePositive->setLower(1);
   declareProperty("ChunkNumber", EMPTY_INT(), mustBePositive,
@@ -209,6 +227,7 @@ void LoadEventNexus::init() {
   std::string grp3 = "Reduce Memory Use";
   setPropertyGroup("Precount", grp3);
   setPropertyGroup("CompressTolerance", grp3);
+  setPropertyGroup("CompressBinningMode", grp3);
   setPropertyGroup("ChunkNumber", grp3);
   setPropertyGroup("TotalChunks", grp3);
 
@@ -385,6 +404,16 @@ void LoadEventNexus::execLoader() {
   m_filename = getPropertyValue("Filename");
 
   compressTolerance = getProperty("CompressTolerance");
+  const std::string binningMode = getProperty("CompressBinningMode");
+  compressWhileLoading = compressTolerance >= 0 && binningMode != "Default";
+  compressBinningMode = binningMode == "Logarithmic"
+                            ? CompressBinningMode::LOGARITHMIC
+                            : CompressBinningMode::LINEAR;
+  if (compressWhileLoading &&
+      compressBinningMode == CompressBinningMode::LOGARITHMIC &&
+      compressTolerance == 0.)
+    throw std::invalid_argument(
+        "Logarithmic compression needs a positive CompressTolerance");
 
   loadlogs = getProperty("LoadLogs");
 
@@ -978,9 +1007,17 @@ void LoadEventNexus::loadEvents(API::Progress *const prog,
       static_cast<double>(std::numeric_limits<uint32_t>::max()) * 0.1;
   longest_tof = 0.;
 
-  bool loaded{false};
+  // Reuse the events of an earlier load of the same file with the same
+  // options if they are in the cache
+  const auto cache = EventWorkspaceCache::fromConfig();
+  const std::string cacheKey =
+      (cache.enabled() && !monitors) ? eventCacheKey() : "";
+  const bool fromCache =
+      !cacheKey.empty() && loadEventsFromCache(cache, cacheKey);
+
+  bool loaded{fromCache};
   auto loaderType = defineLoaderType(haveWeights, oldNeXusFileNames, classType);
-  if (loaderType != LoaderType::DEFAULT) {
+  if (!loaded && loaderType != LoaderType::DEFAULT) {
     auto ws = m_ws->getSingleHeldWorkspace();
     m_file->close();
     if (loaderType == LoaderType::MPI) {
@@ -1029,14 +1066,19 @@ void LoadEventNexus::loadEvents(API::Progress *const prog,
     safeOpenFile(m_filename);
   }
   if (!loaded) {
-    bool precount = getProperty("Precount");
+    if (!isDefault("Precount"))
+      g_log.warning() << "Precount is deprecated and ignored: the events of "
+                         "each pixel are always counted before they are "
+                         "stored.\n";
     int chunk = getProperty("ChunkNumber");
     int totalChunks = getProperty("TotalChunks");
     DefaultEventLoader::load(this, *m_ws, haveWeights, event_id_is_spec,
                              bankNames, periodLog->valuesAsVector(), classType,
-                             bankNumEvents, oldNeXusFileNames, precount, chunk,
+                             bankNumEvents, oldNeXusFileNames, chunk,
                              totalChunks);
   }
+  if (!cacheKey.empty() && !fromCache && !getCancel())
+    saveEventsToCache(cache, cacheKey);
 
   // Info reporting
   const std::size_t eventsLoaded = m_ws->getNumberEvents();
@@ -1258,6 +1300,90 @@ void LoadEventNexus::deleteBanks(const EventWorkspaceCollection_sptr &workspace,
   }
 }
 //-----------------------------------------------------------------------------
+/**
+ * Key of the event cache entry for this execution, built from the file, the
+ * values of all the input properties, the instrument and the spectrum
+ * mapping. The events are assigned to spectra through the detector IDs of the
+ * instrument, which can change with the instrument definition while the file
+ * does not.
+ * @return the key
+ */
+std::string LoadEventNexus::eventCacheKey() const {
+  std::ostringstream options;
+  for (const auto *property : getProperties()) {
+    if (property->direction() == Direction::Input)
+      options << property->name() << '=' << property->value() << '\n';
+  }
+
+  const auto instrument = m_ws->getInstrument();
+  options << "Instrument=" << instrument->getName() << '\n'
+          << "ValidFrom=" << instrument->getValidFromDate().toISO8601String()
+          << '\n';
+  const auto &definition = instrument->getFilename();
+  if (!definition.empty() && definition != m_filename &&
+      Poco::File(definition).exists())
+    options << EventWorkspaceCache::fileIdentity(definition);
+
+  size_t mapping = 0;
+  for (size_t wi = 0; wi < m_ws->getNumberHistograms(); ++wi) {
+    const auto &spectrum = m_ws->getSpectrum(wi);
+    boost::hash_combine(mapping, spectrum.getSpectrumNo());
+    for (const auto detectorID : spectrum.getDetectorIDs())
+      boost::hash_combine(mapping, detectorID);
+  }
+  options << "Mapping=" << mapping << '\n';
+  return EventWorkspaceCache::makeKey(m_filename, options.str());
+}
+
+namespace {
+/** All the event lists of the output, period by period
+ * @param workspace :: the workspaces being loaded
+ */
+template <typename EventListType>
+std::vector<EventListType *>
+allEventLists(EventWorkspaceCollection &workspace) {
+  std::vector<EventListType *> lists;
+  lists.reserve(workspace.nPeriods() * workspace.getNumberHistograms());
+  for (size_t period = 0; period < workspace.nPeriods(); ++period)
+    for (size_t wi = 0; wi < workspace.getNumberHistograms(); ++wi)
+      lists.emplace_back(&workspace.getSpectrum(wi, period));
+  return lists;
+}
+} // namespace
+
+/**
+ * Fill the events from the event cache
+ * @param cache :: the event cache
+ * @param key :: key of the entry for this execution
+ * @return true if the entry was found and used
+ */
+bool LoadEventNexus::loadEventsFromCache(const EventWorkspaceCache &cache,
+                                         const std::string &key) {
+  EventWorkspaceCache::LoadStatistics statistics;
+  if (!cache.load(key, allEventLists<EventList>(*m_ws), statistics))
+    return false;
+  shortest_tof = statistics.shortestTof;
+  longest_tof = statistics.longestTof;
+  bad_tofs = static_cast<size_t>(statistics.badTofs);
+  discarded_events = static_cast<size_t>(statistics.discardedEvents);
+  return true;
+}
+
+/**
+ * Save the events just loaded to the event cache
+ * @param cache :: the event cache
+ * @param key :: key of the entry for this execution
+ */
+void LoadEventNexus::saveEventsToCache(const EventWorkspaceCache &cache,
+                                       const std::string &key) {
+  EventWorkspaceCache::LoadStatistics statistics;
+  statistics.shortestTof = shortest_tof;
+  statistics.longestTof = longest_tof;
+  statistics.badTofs = bad_tofs;
+  statistics.discardedEvents = discarded_events;
+  cache.save(key, allEventLists<const EventList>(*m_ws), statistics);
+}
+
 /**
  * Create the required spectra mapping. If the file contains an
  * isis_vms_compat block then the mapping is read from there, otherwise a 1:1
@@ -12,6 +12,7 @@
 #include "MantidAPI/Progress.h"
 #include "MantidDataHandling/LoadGeometry.h"
 #include "MantidGeometry/Instrument.h"
+#include "MantidGeometry/Instrument/InstrumentCache.h"
 #include "MantidGeometry/Instrument/InstrumentDefinitionParser.h"
 #include "MantidKernel/ArrayProperty.h"
 #include "MantidKernel/ConfigService.h"
@@ -212,9 +213,10 @@ void LoadInstrument::exec() {
     } else {
 
       if (loader_type < LoaderType::Nxs) {
-        // Really create the instrument
+        // Really create the instrument, or rebuild it from the cache
         Progress prog(this, 0.0, 1.0, 100);
-        instrument = parser.parseXML(&prog);
+        instrument =
+            parser.parseXMLUsingCache(InstrumentCache::fromConfig(), &prog);
         // Parse the instrument tree (internally create ComponentInfo and
         // DetectorInfo). This is an optimization that avoids duplicate parsing
         // of the instrument tree when loading multiple workspaces with the same
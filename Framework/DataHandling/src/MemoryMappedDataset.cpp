@@ -0,0 +1,137 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidDataHandling/MemoryMappedDataset.h"
+#include "MantidDataHandling/H5Util.h"
+#include "MantidKernel/ConfigService.h"
+#include "MantidKernel/Logger.h"
+
+#include <H5Cpp.h>
+#include <atomic>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace Mantid {
+namespace DataHandling {
+namespace MemoryMappedDataset {
+
+namespace {
+/// static logger
+Kernel::Logger g_log("MemoryMappedDataset");
+/// Number of mappings made so far
+std::atomic<size_t> g_mappedCount{0};
+
+/// Keeps a file mapped for as long as anything points into it
+struct Mapping {
+  Mapping(const std::string &filename, const size_t offset, const size_t bytes)
+      : file(filename.c_str(), boost::interprocess::read_only),
+        region(file, boost::interprocess::read_only,
+               static_cast<boost::interprocess::offset_t>(offset), bytes) {}
+  boost::interprocess::file_mapping file;
+  boost::interprocess::mapped_region region;
+};
+
+/** Find where the requested elements of a dataset live in the file.
+ * @param filename :: the HDF5 file
+ * @param datasetPath :: absolute path of the dataset in the file
+ * @param type :: the type the elements must have
+ * @param start :: index of the first element
+ * @param count :: number of elements
+ * @return byte offset of the first element in the file, or -1 if the
+ * elements are not stored as plain contiguous bytes
+ */
+int64_t findContiguousOffset(const std::string &filename,
+                             const std::string &datasetPath,
+                             const H5::DataType &type, const size_t start,
+                             const size_t count) {
+  // The NeXus API may have the file open already, with a strong close degree.
+  // HDF5 refuses to open a file again with a different one.
+  H5::FileAccPropList access;
+  access.setFcloseDegree(H5F_CLOSE_STRONG);
+  H5::H5File file(filename, H5F_ACC_RDONLY, H5::FileCreatPropList::DEFAULT,
+                  access);
+  // Other drivers split the address space over several files
+  if (file.getAccessPlist().getDriver() != H5FD_SEC2)
+    return -1;
+
+  H5::DataSet dataset = file.openDataSet(datasetPath);
+  const H5::DSetCreatPropList properties = dataset.getCreatePlist();
+  if (properties.getLayout() != H5D_CONTIGUOUS ||
+      properties.getNfilters() != 0 || properties.getExternalCount() != 0)
+    return -1;
+  // Same class, size, sign and byte order
+  if (!(dataset.getDataType() == type))
+    return -1;
+
+  const H5::DataSpace space = dataset.getSpace();
+  if (space.getSimpleExtentNdims() != 1)
+    return -1;
+  hsize_t length = 0;
+  space.getSimpleExtentDims(&length);
+  if (start + count > length)
+    return -1;
+
+  // Undefined if the storage has not been allocated
+  const haddr_t offset = dataset.getOffset();
+  if (offset == HADDR_UNDEF)
+    return -1;
+  return static_cast<int64_t>(offset + start * type.getSize());
+}
+} // namespace
+
+template <typename T>
+std::shared_ptr<const T> map(const std::string &filename,
+                             const std::string &datasetPath,
+                             const size_t start, const size_t count) {
+  if (count == 0)
+    return nullptr;
+  try {
+    H5::Exception::dontPrint();
+    const int64_t offset = findContiguousOffset(
+        filename, datasetPath, H5Util::getType<T>(), start, count);
+    if (offset < 0) {
+      g_log.debug() << datasetPath
+                    << " is not stored contiguously and uncompressed. It "
+                       "will be read rather than mapped.\n";
+      return nullptr;
+    }
+    auto mapping = std::make_shared<Mapping>(
+        filename, static_cast<size_t>(offset), count * sizeof(T));
+    const auto *data =
+        static_cast<const T *>(mapping->region.get_address());
+    // Advise the kernel we will read it once, front to back
+    mapping->region.advise(
+        boost::interprocess::mapped_region::advice_sequential);
+    ++g_mappedCount;
+    return std::shared_ptr<const T>(mapping, data);
+  } catch (const H5::Exception &e) {
+    g_log.debug() << "Cannot map " << datasetPath << ": "
+                  << e.getDetailMsg() << '\n';
+  } catch (const boost::interprocess::interprocess_exception &e) {
+    g_log.debug() << "Cannot map " << datasetPath << ": " << e.what() << '\n';
+  }
+  return nullptr;
+}
+
+size_t mappedCount() { return g_mappedCount; }
+
+bool enabled() {
+  const auto enabled =
+      Kernel::ConfigService::Instance().getValue<bool>(
+          "loadeventnexus.memorymap");
+  return enabled.get_value_or(false);
+}
+
+template MANTID_DATAHANDLING_DLL std::shared_ptr<const uint32_t>
+map<uint32_t>(const std::string &, const std::string &, const size_t,
+              const size_t);
+template MANTID_DATAHANDLING_DLL std::shared_ptr<const float>
+map<float>(const std::string &, const std::string &, const size_t,
+           const size_t);
+
+} // namespace MemoryMappedDataset
+} // namespace DataHandling
+} // namespace Mantid
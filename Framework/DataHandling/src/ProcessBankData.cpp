@@ -4,11 +4,18 @@
 //   NScD Oak Ridge National Laboratory, European Spallation Source,
 //   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
 // SPDX - License - Identifier: GPL - 3.0 +
+#include <algorithm>
+#include <memory>
+#include <type_traits>
 #include <utility>
 
+#include "MantidDataHandling/CompressEventAccumulator.h"
 #include "MantidDataHandling/DefaultEventLoader.h"
 #include "MantidDataHandling/LoadEventNexus.h"
 #include "MantidDataHandling/ProcessBankData.h"
+#include "MantidKernel/ThreadPool.h"
+
+#include "tbb/parallel_for.h"
 
 using namespace Mantid::DataObjects;
 
@@ -17,8 +24,8 @@ namespace DataHandling {
 
 ProcessBankData::ProcessBankData(
     DefaultEventLoader &m_loader, std::string entry_name, API::Progress *prog,
-    std::shared_ptr<std::vector<uint32_t>> event_id,
-    std::shared_ptr<std::vector<float>> event_time_of_flight, size_t numEvents,
+    std::shared_ptr<const uint32_t> event_id,
+    std::shared_ptr<const float> event_time_of_flight, size_t numEvents,
     size_t startAt, std::shared_ptr<std::vector<uint64_t>> event_index,
     std::shared_ptr<BankPulseTimes> thisBankPulseTimes, bool have_weight,
     std::shared_ptr<std::vector<float>> event_weight, detid_t min_event_id,
@@ -65,76 +72,368 @@ getPulseIndex(const size_t event_index, const size_t last_pulse_index,
 } // namespace
 
 /** Run the data processing
- * FIXME/TODO - split run() into readable methods
  */
 void ProcessBankData::run() { // override {
-  // Local tof limits
-  double my_shortest_tof =
-      static_cast<double>(std::numeric_limits<uint32_t>::max()) * 0.1;
-  double my_longest_tof = 0.;
-  // A count of "bad" TOFs that were too high
-  size_t badTofs = 0;
-  size_t my_discarded_events(0);
-
-  prog->report(entry_name + ": precount");
-  // ---- Pre-counting events per pixel ID ----
+  Kernel::Timer timer;
+  prog->report(entry_name + ": count");
   auto &outputWS = m_loader.m_ws;
   auto *alg = m_loader.alg;
-  if (m_loader.precount) {
 
-    std::vector<size_t> counts(m_max_id - m_min_id + 1, 0);
-    for (size_t i = 0; i < numEvents; i++) {
-      const auto thisId = detid_t((*event_id)[i]);
-      if (thisId >= m_min_id && thisId <= m_max_id)
-        counts[thisId - m_min_id]++;
-    }
+  // Default pulse time (if none are found)
+  const bool pulsetimesincreasing = std::is_sorted(
+      thisBankPulseTimes->pulseTimes,
+      thisBankPulseTimes->pulseTimes + thisBankPulseTimes->numPulses);
+  if (!std::is_sorted(event_index->cbegin(), event_index->cend()))
+    throw std::runtime_error("Event index is not sorted");
 
-    // Now we pre-allocate (reserve) the vectors of events in each pixel
-    // counted
-    const size_t numEventLists = outputWS.getNumberHistograms();
+  prog->report(entry_name + ": filling events");
+
+  // The events are counted and then written straight into place, so the
+  // event lists always end up allocated to exactly the right size. When
+  // compressing while loading only the compressed events are ever stored.
+  BankStatistics stats;
+  if (alg->compressWhileLoading) {
+    if (have_weight)
+      stats = fillCompressed(m_loader.weightedEventVectors);
+    else
+      stats = fillCompressed(m_loader.eventVectors);
+  } else if (have_weight) {
+    stats = fillEvents(m_loader.weightedEventVectors);
+  } else {
+    stats = fillEvents(m_loader.eventVectors);
+  }
+
+  // Check for canceled algorithm
+  if (alg->getCancel()) {
+    return;
+  }
+
+  //------------ Compress Events (or set sort order) ------------------
+  // Do it on all the detector IDs we touched
+  if (alg->compressTolerance >= 0 && !alg->compressWhileLoading) {
     for (detid_t pixID = m_min_id; pixID <= m_max_id; ++pixID) {
-      if (counts[pixID - m_min_id] > 0) {
-        size_t wi = getWorkspaceIndexFromPixelID(pixID);
+      if (stats.usedDetIds[pixID - m_min_id]) {
         // Find the the workspace index corresponding to that pixel ID
-        // Allocate it
-        if (wi < numEventLists) {
-          outputWS.reserveEventListAt(wi, counts[pixID - m_min_id]);
-        }
-        if (alg->getCancel())
-          break; // User cancellation
+        size_t wi = getWorkspaceIndexFromPixelID(pixID);
+        auto &el = outputWS.getSpectrum(wi);
+        el.compressEvents(alg->compressTolerance, &el);
       }
     }
   }
+  prog->report(entry_name + ": filled events");
 
-  // Check for canceled algorithm
-  if (alg->getCancel()) {
-    return;
+  alg->getLogger().debug() << entry_name
+                           << (pulsetimesincreasing ? " had "
+                                                    : " DID NOT have ")
+                           << "monotonically increasing pulse times\n";
+
+  // Join back up the tof limits to the global ones
+  // This is not thread safe, so only one thread at a time runs this.
+  {
+    std::lock_guard<std::mutex> _lock(alg->m_tofMutex);
+    if (stats.shortestTof < alg->shortest_tof) {
+      alg->shortest_tof = stats.shortestTof;
+    }
+    if (stats.longestTof > alg->longest_tof) {
+      alg->longest_tof = stats.longestTof;
+    }
+    alg->bad_tofs += stats.badTofs;
+    alg->discarded_events += stats.discardedEvents;
   }
 
-  // Default pulse time (if none are found)
-  const bool pulsetimesincreasing = std::is_sorted(
-      thisBankPulseTimes->pulseTimes,
-      thisBankPulseTimes->pulseTimes + thisBankPulseTimes->numPulses);
-  if (!std::is_sorted(event_index->cbegin(), event_index->cend()))
-    throw std::runtime_error("Event index is not sorted");
+  m_loader.readAhead.addProcessTime(timer.elapsed());
 
-  // And there are this many pulses
-  const auto NUM_PULSES = thisBankPulseTimes->numPulses;
-  prog->report(entry_name + ": filling events");
+#ifndef _WIN32
+  alg->getLogger().debug() << "Time to process " << entry_name << " " << m_timer
+                           << "\n";
+#endif
+} // END-OF-RUN()
 
-  // Will we need to compress?
-  const bool compress = (alg->compressTolerance >= 0);
+/** Fill the events of this bank into the event lists in two passes.
+ *
+ * The pulses are split into slices holding roughly equal numbers of events.
+ * The first pass counts, in parallel, the events each slice contributes to
+ * every event list. A prefix sum over the slices then gives each slice its
+ * own range of every list, the lists are resized once, and the second pass
+ * writes the events into place in parallel without any locking. Events end up
+ * in the same order as a serial fill.
+ *
+ * @param eventVectors :: per period, the event vector for each detector ID
+ * @return statistics on the events processed
+ */
+template <typename EventType>
+ProcessBankData::BankStatistics ProcessBankData::fillEvents(
+    const std::vector<std::vector<std::vector<EventType> *>> &eventVectors) {
+  auto *alg = m_loader.alg;
+  const size_t numDetIds = static_cast<size_t>(m_max_id - m_min_id + 1);
+  const size_t numKeys = eventVectors.size() * numDetIds;
+  const auto slices = splitPulses(numKeys);
+  const size_t numSlices = slices.size() - 1;
+
+  // index into the per-slice counts for an event
+  const auto key = [this, numDetIds](const int periodIndex,
+                                     const detid_t detId) {
+    return static_cast<size_t>(periodIndex) * numDetIds +
+           static_cast<size_t>(detId - m_min_id);
+  };
+
+  // ---- Pass 1: count the events per slice and event list ----
+  std::vector<BankStatistics> sliceStats(numSlices);
+  std::vector<std::vector<size_t>> cursors(numSlices);
+  tbb::parallel_for(size_t{0}, numSlices, [&](const size_t slice) {
+    auto &stats = sliceStats[slice];
+    auto &counts = cursors[slice];
+    counts.assign(numKeys, 0);
+    visitEvents(slices[slice], slices[slice + 1],
+                [&](size_t, const int periodIndex, const detid_t detId,
+                    const double tof, const Types::Core::DateAndTime &) {
+                  // Skip any events that are the cause of bad DAS data (e.g. a
+                  // negative number in uint32 -> 2.4 billion * 100 nanosec =
+                  // 2.4e8 microsec)
+                  if (tof < 2e8) {
+                    stats.longestTof = std::max(stats.longestTof, tof);
+                    stats.shortestTof = std::min(stats.shortestTof, tof);
+                  } else {
+                    ++stats.badTofs;
+                  }
+                  // NULL eventVector indicates a bad spectrum lookup
+                  if (eventVectors[periodIndex][detId])
+                    ++counts[key(periodIndex, detId)];
+                  else
+                    ++stats.discardedEvents;
+                });
+  });
+
+  BankStatistics total;
+  total.usedDetIds.assign(numDetIds, false);
+  for (const auto &stats : sliceStats) {
+    total.shortestTof = std::min(total.shortestTof, stats.shortestTof);
+    total.longestTof = std::max(total.longestTof, stats.longestTof);
+    total.badTofs += stats.badTofs;
+    total.discardedEvents += stats.discardedEvents;
+  }
+  if (alg->getCancel())
+    return total;
+
+  // ---- Prefix sum: turn the counts into write positions and allocate ----
+  for (size_t period = 0; period < eventVectors.size(); ++period) {
+    for (size_t detIndex = 0; detIndex < numDetIds; ++detIndex) {
+      const size_t k = period * numDetIds + detIndex;
+      size_t numNew = 0;
+      for (const auto &counts : cursors)
+        numNew += counts[k];
+      if (numNew == 0)
+        continue;
+      auto *eventVector = eventVectors[period][m_min_id + detIndex];
+      size_t position = eventVector->size();
+      for (auto &counts : cursors) {
+        const size_t count = counts[k];
+        counts[k] = position;
+        position += count;
+      }
+      eventVector->resize(position);
+      total.usedDetIds[detIndex] = true;
+    }
+  }
 
-  // Which detector IDs were touched? - only matters if compress is on
-  std::vector<bool> usedDetIds;
-  if (compress)
-    usedDetIds.assign(m_max_id - m_min_id + 1, false);
+  // ---- Pass 2: write every event into its own slot ----
+  constexpr bool isWeighted = std::is_same<EventType, WeightedEvent>::value;
+  tbb::parallel_for(size_t{0}, numSlices, [&](const size_t slice) {
+    auto &sliceCursors = cursors[slice];
+    visitEvents(slices[slice], slices[slice + 1],
+                [&](const size_t eventIndex, const int periodIndex,
+                    const detid_t detId, const double tof,
+                    const Types::Core::DateAndTime &pulsetime) {
+                  auto *eventVector = eventVectors[periodIndex][detId];
+                  if (!eventVector)
+                    return;
+                  auto &event =
+                      (*eventVector)[sliceCursors[key(periodIndex, detId)]++];
+                  if constexpr (isWeighted) {
+                    // Handle simulated data
+                    const auto weight =
+                        static_cast<double>((*event_weight)[eventIndex]);
+                    event = EventType(tof, pulsetime, weight, weight * weight);
+                  } else {
+                    event = EventType(tof, pulsetime);
+                  }
+                });
+  });
+
+  return total;
+}
 
+/** Compress the events of this bank into the event lists as they are read.
+ *
+ * The pulses are split into slices holding roughly equal numbers of events,
+ * as for fillEvents. Each slice is read by one thread, which folds its events
+ * into accumulators of its own, so no locking is needed and no uncompressed
+ * events are stored in the event lists. The event lists are then looked up
+ * one at a time, and the accumulators of the slices are merged, in parallel
+ * over the lists, with the events already there, e.g. from other banks with
+ * the same pixels. The compressed events keep the average pulse time of the
+ * events they hold.
+ *
+ * @param eventVectors :: per period, the event vector for each detector ID;
+ * only used to know which events to discard
+ * @return statistics on the events processed
+ */
+template <typename EventType>
+ProcessBankData::BankStatistics ProcessBankData::fillCompressed(
+    const std::vector<std::vector<std::vector<EventType> *>> &eventVectors) {
+  auto *alg = m_loader.alg;
+  const size_t numDetIds = static_cast<size_t>(m_max_id - m_min_id + 1);
+  const size_t numKeys = eventVectors.size() * numDetIds;
+  const auto slices = splitPulses(numKeys);
+  const size_t numSlices = slices.size() - 1;
+  const CompressEventAccumulator emptyAccumulator(alg->compressTolerance,
+                                                  alg->compressBinningMode);
+
+  // ---- Compress the events of each slice on its own ----
+  using Accumulators = std::vector<std::unique_ptr<CompressEventAccumulator>>;
+  std::vector<BankStatistics> sliceStats(numSlices);
+  std::vector<Accumulators> sliceAccumulators(numSlices);
+  tbb::parallel_for(size_t{0}, numSlices, [&](const size_t slice) {
+    auto &stats = sliceStats[slice];
+    auto &accumulators = sliceAccumulators[slice];
+    accumulators.resize(numKeys);
+    visitEvents(slices[slice], slices[slice + 1],
+                [&](const size_t eventIndex, const int periodIndex,
+                    const detid_t detId, const double tof,
+                    const Types::Core::DateAndTime &pulsetime) {
+                  // Skip any events that are the cause of bad DAS data
+                  if (tof < 2e8) {
+                    stats.longestTof = std::max(stats.longestTof, tof);
+                    stats.shortestTof = std::min(stats.shortestTof, tof);
+                  } else {
+                    ++stats.badTofs;
+                  }
+                  // NULL eventVector indicates a bad spectrum lookup
+                  if (!eventVectors[periodIndex][detId]) {
+                    ++stats.discardedEvents;
+                    return;
+                  }
+                  auto &accumulator =
+                      accumulators[static_cast<size_t>(periodIndex) *
+                                       numDetIds +
+                                   static_cast<size_t>(detId - m_min_id)];
+                  if (!accumulator)
+                    accumulator = std::make_unique<CompressEventAccumulator>(
+                        emptyAccumulator);
+                  if (have_weight) {
+                    // Handle simulated data
+                    const auto weight = (*event_weight)[eventIndex];
+                    accumulator->addEvent(tof, pulsetime, weight,
+                                          weight * weight);
+                  } else {
+                    accumulator->addEvent(tof, pulsetime);
+                  }
+                });
+  });
+
+  BankStatistics total;
+  total.usedDetIds.assign(numDetIds, false);
+  for (const auto &stats : sliceStats) {
+    total.shortestTof = std::min(total.shortestTof, stats.shortestTof);
+    total.longestTof = std::max(total.longestTof, stats.longestTof);
+    total.badTofs += stats.badTofs;
+    total.discardedEvents += stats.discardedEvents;
+  }
+  if (alg->getCancel())
+    return total;
+
+  // ---- Look up the event lists with events, one at a time ----
+  std::vector<std::pair<size_t, EventList *>> lists;
+  for (size_t period = 0; period < eventVectors.size(); ++period) {
+    for (size_t detIndex = 0; detIndex < numDetIds; ++detIndex) {
+      const size_t k = period * numDetIds + detIndex;
+      if (std::none_of(sliceAccumulators.cbegin(), sliceAccumulators.cend(),
+                       [k](const Accumulators &accumulators) {
+                         return static_cast<bool>(accumulators[k]);
+                       }))
+        continue;
+      const auto detId = m_min_id + static_cast<detid_t>(detIndex);
+      auto &el = m_loader.m_ws.getSpectrum(getWorkspaceIndexFromPixelID(detId),
+                                           period);
+      el.switchTo(API::WEIGHTED);
+      lists.emplace_back(k, &el);
+      total.usedDetIds[detIndex] = true;
+    }
+  }
+
+  // ---- Merge the slices and the events already in each list ----
+  tbb::parallel_for(size_t{0}, lists.size(), [&](const size_t i) {
+    const size_t k = lists[i].first;
+    auto &el = *lists[i].second;
+    CompressEventAccumulator accumulator(emptyAccumulator);
+    for (auto &accumulators : sliceAccumulators) {
+      if (accumulators[k]) {
+        accumulator.merge(*accumulators[k]);
+        accumulators[k].reset();
+      }
+    }
+    auto &events = el.getWeightedEvents();
+    for (const auto &event : events)
+      accumulator.addEvent(event.tof(), event.pulseTime(), event.weight(),
+                           event.errorSquared());
+    accumulator.createWeightedEvents(events);
+    el.setSortOrder(TOF_SORT);
+  });
+  return total;
+}
+
+/** Split the pulses of this bank into slices that hold similar numbers of
+ * events, one per core for large banks.
+ * @param numKeys :: number of counters each slice needs
+ * @return boundaries of the slices as pulse indices; slice i covers pulses
+ * [result[i], result[i+1])
+ */
+std::vector<size_t> ProcessBankData::splitPulses(const size_t numKeys) const {
+  const size_t numPulses = thisBankPulseTimes->numPulses;
+  const size_t firstPulse = getPulseIndex(startAt, 0, event_index);
+
+  // Each slice needs its own counters, so don't use more slices than make
+  // sense for the number of events
+  size_t numSlices = std::min(Kernel::ThreadPool::getNumPhysicalCores(),
+                              numEvents / MIN_EVENTS_PER_SLICE);
+  numSlices = std::min(numSlices, numEvents / std::max(numKeys, size_t{1}));
+  numSlices = std::max(numSlices, size_t{1});
+
+  std::vector<size_t> boundaries{firstPulse};
+  const auto indexBegin = event_index->cbegin();
+  const auto indexEnd =
+      indexBegin + std::min(event_index->size(), numPulses);
+  for (size_t slice = 1; slice < numSlices; ++slice) {
+    const uint64_t target = startAt + slice * numEvents / numSlices;
+    const auto pulse = static_cast<size_t>(std::distance(
+        indexBegin, std::lower_bound(indexBegin, indexEnd, target)));
+    boundaries.emplace_back(
+        std::min(std::max(pulse, boundaries.back()), numPulses));
+  }
+  boundaries.emplace_back(std::max(numPulses, firstPulse));
+  return boundaries;
+}
+
+/** Call visit for every event of the pulses [firstPulse, lastPulse) that has
+ * a detector ID and time-of-flight inside the limits.
+ * @param firstPulse :: first pulse to look at
+ * @param lastPulse :: one past the last pulse to look at
+ * @param visit :: callable taking (event index, period index, detector ID,
+ * time-of-flight, pulse time)
+ */
+template <typename Visitor>
+void ProcessBankData::visitEvents(const size_t firstPulse,
+                                  const size_t lastPulse,
+                                  Visitor &&visit) const {
+  auto *alg = m_loader.alg;
   const double TOF_MIN = alg->filter_tof_min;
   const double TOF_MAX = alg->filter_tof_max;
+  const auto NUM_PULSES = thisBankPulseTimes->numPulses;
+  const uint32_t *eventIds = event_id.get();
+  const float *tofs = event_time_of_flight.get();
 
-  for (std::size_t pulseIndex = getPulseIndex(startAt, 0, event_index);
-       pulseIndex < NUM_PULSES; pulseIndex++) {
+  for (std::size_t pulseIndex = firstPulse; pulseIndex < lastPulse;
+       pulseIndex++) {
     // Save the pulse time at this index for creating those events
     const auto pulsetime = thisBankPulseTimes->pulseTimes[pulseIndex];
     const int logPeriodNumber = thisBankPulseTimes->periodNumbers[pulseIndex];
@@ -159,115 +458,20 @@ void ProcessBankData::run() { // override {
 
     for (std::size_t eventIndex = firstEventIndex; eventIndex < lastEventIndex;
          ++eventIndex) {
-      // We cached a pointer to the vector<tofEvent> -> so retrieve it and add
-      // the event
-      const detid_t detId = (*event_id)[eventIndex];
+      const detid_t detId = eventIds[eventIndex];
       if (detId >= m_min_id && detId <= m_max_id) {
-        // Create the tofevent
-        const auto tof =
-            static_cast<double>((*event_time_of_flight)[eventIndex]);
+        const auto tof = static_cast<double>(tofs[eventIndex]);
         // this is fancy for check if value is in range
         if ((tof - TOF_MIN) * (tof - TOF_MAX) <= 0.) {
-          // Handle simulated data if present
-          if (have_weight) {
-            auto *eventVector =
-                m_loader.weightedEventVectors[periodIndex][detId];
-            // NULL eventVector indicates a bad spectrum lookup
-            if (eventVector) {
-              const auto weight =
-                  static_cast<double>((*event_weight)[eventIndex]);
-              const double errorSq = weight * weight;
-              eventVector->emplace_back(tof, pulsetime, weight, errorSq);
-            } else {
-              ++my_discarded_events;
-            }
-          } else {
-            // We have cached the vector of events for this detector ID
-            auto *eventVector = m_loader.eventVectors[periodIndex][detId];
-            // NULL eventVector indicates a bad spectrum lookup
-            if (eventVector) {
-              eventVector->emplace_back(tof, pulsetime);
-            } else {
-              ++my_discarded_events;
-            }
-          }
-
-          // Skip any events that are the cause of bad DAS data (e.g. a negative
-          // number in uint32 -> 2.4 billion * 100 nanosec = 2.4e8 microsec)
-          if (tof < 2e8) {
-            // tof limits from things observed here
-            if (tof > my_longest_tof) {
-              my_longest_tof = tof;
-            }
-            if (tof < my_shortest_tof) {
-              my_shortest_tof = tof;
-            }
-          } else
-            badTofs++;
-
-          // Track all the touched wi (only necessary when compressing events,
-          // for thread safety)
-          if (compress)
-            usedDetIds[detId - m_min_id] = true;
+          visit(eventIndex, periodIndex, detId, tof, pulsetime);
         } // valid time-of-flight
-
-      } // valid detector IDs
-    }   // for events in pulse
+      }   // valid detector IDs
+    }     // for events in pulse
     // check if cancelled after each pulse
     if (alg->getCancel())
       break;
   } // for pulses
-
-  // Check for canceled algorithm
-  if (alg->getCancel()) {
-    return;
-  }
-
-  //------------ Compress Events (or set sort order) ------------------
-  // Do it on all the detector IDs we touched
-  if (compress) {
-    for (detid_t pixID = m_min_id; pixID <= m_max_id; ++pixID) {
-      if (usedDetIds[pixID - m_min_id]) {
-        // Find the the workspace index corresponding to that pixel ID
-        size_t wi = getWorkspaceIndexFromPixelID(pixID);
-        auto &el = outputWS.getSpectrum(wi);
-        if (compress)
-          el.compressEvents(alg->compressTolerance, &el);
-        else {
-          if (pulsetimesincreasing)
-            el.setSortOrder(DataObjects::PULSETIME_SORT);
-          else
-            el.setSortOrder(DataObjects::UNSORTED);
-        }
-      }
-    }
-  }
-  prog->report(entry_name + ": filled events");
-
-  alg->getLogger().debug() << entry_name
-                           << (pulsetimesincreasing ? " had "
-                                                    : " DID NOT have ")
-                           << "monotonically increasing pulse times\n";
-
-  // Join back up the tof limits to the global ones
-  // This is not thread safe, so only one thread at a time runs this.
-  {
-    std::lock_guard<std::mutex> _lock(alg->m_tofMutex);
-    if (my_shortest_tof < alg->shortest_tof) {
-      alg->shortest_tof = my_shortest_tof;
-    }
-    if (my_longest_tof > alg->longest_tof) {
-      alg->longest_tof = my_longest_tof;
-    }
-    alg->bad_tofs += badTofs;
-    alg->discarded_events += my_discarded_events;
-  }
-
-#ifndef _WIN32
-  alg->getLogger().debug() << "Time to process " << entry_name << " " << m_timer
-                           << "\n";
-#endif
-} // END-OF-RUN()
+}
 
 size_t ProcessBankData::getFirstEventIndex(const size_t pulseIndex) const {
   const auto firstEventIndex = event_index->operator[](pulseIndex);
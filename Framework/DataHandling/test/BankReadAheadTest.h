@@ -0,0 +1,97 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include <cxxtest/TestSuite.h>
+
+#include "MantidDataHandling/BankReadAhead.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using Mantid::DataHandling::BankReadAhead;
+
+class BankReadAheadTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static BankReadAheadTest *createSuite() { return new BankReadAheadTest(); }
+  static void destroySuite(BankReadAheadTest *suite) { delete suite; }
+
+  void test_tickets_are_released_with_their_last_copy() {
+    BankReadAhead readAhead(2, 1000);
+    auto ticket = readAhead.acquire(100);
+    TS_ASSERT_EQUALS(readAhead.banksInFlight(), 1);
+    TS_ASSERT_EQUALS(readAhead.bytesInFlight(), 100);
+
+    auto copy = ticket;
+    ticket.reset();
+    TS_ASSERT_EQUALS(readAhead.banksInFlight(), 1);
+    copy.reset();
+    TS_ASSERT_EQUALS(readAhead.banksInFlight(), 0);
+    TS_ASSERT_EQUALS(readAhead.bytesInFlight(), 0);
+  }
+
+  void test_bank_larger_than_budget_goes_through_when_alone() {
+    BankReadAhead readAhead(2, 10);
+    auto ticket = readAhead.acquire(1000);
+    TS_ASSERT_EQUALS(readAhead.bytesInFlight(), 1000);
+  }
+
+  void test_zero_depth_means_one_bank() {
+    BankReadAhead readAhead(0, 10);
+    TS_ASSERT_EQUALS(readAhead.maxBanks(), 1);
+  }
+
+  void test_acquire_waits_for_depth() {
+    BankReadAhead readAhead(1, 1000);
+    auto first = readAhead.acquire(10);
+
+    std::atomic<bool> acquired{false};
+    std::thread reader([&]() {
+      auto second = readAhead.acquire(10);
+      acquired = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    TS_ASSERT(!acquired);
+
+    first.reset();
+    reader.join();
+    TS_ASSERT(acquired);
+    TS_ASSERT_EQUALS(readAhead.banksInFlight(), 0);
+    TS_ASSERT_LESS_THAN(0., readAhead.waitTime());
+  }
+
+  void test_acquire_waits_for_memory() {
+    BankReadAhead readAhead(10, 100);
+    auto first = readAhead.acquire(60);
+
+    std::atomic<bool> acquired{false};
+    std::thread reader([&]() {
+      auto second = readAhead.acquire(60);
+      acquired = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    TS_ASSERT(!acquired);
+
+    first.reset();
+    reader.join();
+    TS_ASSERT(acquired);
+  }
+
+  void test_times_are_accumulated() {
+    BankReadAhead readAhead(1, 1);
+    readAhead.addReadTime(1.5);
+    readAhead.addReadTime(0.5);
+    readAhead.addProcessTime(3.);
+    TS_ASSERT_EQUALS(readAhead.readTime(), 2.);
+    TS_ASSERT_EQUALS(readAhead.processTime(), 3.);
+    TS_ASSERT_DIFFERS(readAhead.summary().find("reading 2 s"),
+                      std::string::npos);
+  }
+};
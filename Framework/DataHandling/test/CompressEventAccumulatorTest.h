@@ -0,0 +1,208 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include <cxxtest/TestSuite.h>
+
+#include "MantidDataHandling/CompressEventAccumulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using Mantid::DataHandling::CompressBinningMode;
+using Mantid::DataHandling::CompressEventAccumulator;
+using Mantid::DataObjects::WeightedEvent;
+using Mantid::DataObjects::WeightedEventNoTime;
+using Mantid::Types::Core::DateAndTime;
+
+class CompressEventAccumulatorTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static CompressEventAccumulatorTest *createSuite() {
+    return new CompressEventAccumulatorTest();
+  }
+  static void destroySuite(CompressEventAccumulatorTest *suite) {
+    delete suite;
+  }
+
+  void test_invalid_tolerance() {
+    TS_ASSERT_THROWS(
+        CompressEventAccumulator(-1., CompressBinningMode::LINEAR),
+        const std::invalid_argument &);
+    TS_ASSERT_THROWS(
+        CompressEventAccumulator(0., CompressBinningMode::LOGARITHMIC),
+        const std::invalid_argument &);
+    TS_ASSERT_THROWS_NOTHING(
+        CompressEventAccumulator(0., CompressBinningMode::LINEAR));
+  }
+
+  void test_linear_bins_in_any_order() {
+    CompressEventAccumulator accumulator(1., CompressBinningMode::LINEAR);
+    TS_ASSERT(accumulator.empty());
+    for (const double tof : {5.5, 0.25, 5.25, 0.75, 2.})
+      accumulator.addEvent(tof);
+    TS_ASSERT(!accumulator.empty());
+    TS_ASSERT_EQUALS(accumulator.numberOfBins(), 3);
+
+    std::vector<WeightedEventNoTime> events;
+    accumulator.createWeightedEvents(events);
+    TS_ASSERT(accumulator.empty());
+    TS_ASSERT_EQUALS(events.size(), 3);
+    TS_ASSERT_DELTA(events[0].tof(), 0.5, 1e-12);
+    TS_ASSERT_EQUALS(events[0].weight(), 2.);
+    TS_ASSERT_EQUALS(events[0].errorSquared(), 2.);
+    TS_ASSERT_DELTA(events[1].tof(), 2., 1e-12);
+    TS_ASSERT_EQUALS(events[1].weight(), 1.);
+    TS_ASSERT_DELTA(events[2].tof(), 5.375, 1e-12);
+    TS_ASSERT_EQUALS(events[2].weight(), 2.);
+  }
+
+  void test_weighted_events() {
+    CompressEventAccumulator accumulator(10., CompressBinningMode::LINEAR);
+    // Times-of-flight are averaged with the inverse of the errors
+    accumulator.addEvent(1., 2.f, 4.f);
+    accumulator.addEvent(4., 1.f, 1.f);
+    // Events without an error do not move the average
+    accumulator.addEvent(9., 3.f, 0.f);
+    // A bin with only such events sits at its lower edge
+    accumulator.addEvent(15., 3.f, 0.f);
+
+    std::vector<WeightedEventNoTime> events;
+    accumulator.createWeightedEvents(events);
+    TS_ASSERT_EQUALS(events.size(), 2);
+    TS_ASSERT_DELTA(events[0].tof(), (1. * 0.5 + 4.) / 1.5, 1e-12);
+    TS_ASSERT_EQUALS(events[0].weight(), 6.);
+    TS_ASSERT_EQUALS(events[0].errorSquared(), 5.);
+    TS_ASSERT_DELTA(events[1].tof(), 10., 1e-12);
+    TS_ASSERT_EQUALS(events[1].weight(), 3.);
+    TS_ASSERT_EQUALS(events[1].errorSquared(), 0.);
+  }
+
+  void test_events_keep_the_average_pulse_time() {
+    CompressEventAccumulator accumulator(1., CompressBinningMode::LINEAR);
+    const DateAndTime start("2021-01-01T00:00:00");
+    accumulator.addEvent(0.25, start + 10.);
+    accumulator.addEvent(0.75, start + 20.);
+    accumulator.addEvent(2.5, start, 2.f, 4.f);
+
+    std::vector<WeightedEvent> events;
+    accumulator.createWeightedEvents(events);
+    TS_ASSERT(accumulator.empty());
+    TS_ASSERT_EQUALS(events.size(), 2);
+    if (events.size() != 2)
+      return;
+    TS_ASSERT_DELTA(events[0].tof(), 0.5, 1e-12);
+    TS_ASSERT_EQUALS(events[0].pulseTime(), start + 15.);
+    TS_ASSERT_EQUALS(events[0].weight(), 2.);
+    TS_ASSERT_EQUALS(events[1].pulseTime(), start);
+    TS_ASSERT_EQUALS(events[1].weight(), 2.);
+    TS_ASSERT_EQUALS(events[1].errorSquared(), 4.);
+  }
+
+  void test_merge() {
+    const DateAndTime start("2021-01-01T00:00:00");
+    CompressEventAccumulator first(1., CompressBinningMode::LINEAR);
+    first.addEvent(0.5, start);
+    first.addEvent(3.5, start);
+    CompressEventAccumulator second(1., CompressBinningMode::LINEAR);
+    second.addEvent(0.5, start + 100.);
+    second.addEvent(5.5, start + 100.);
+
+    first.merge(second);
+    TS_ASSERT(second.empty());
+    std::vector<WeightedEvent> events;
+    first.createWeightedEvents(events);
+    TS_ASSERT_EQUALS(events.size(), 3);
+    if (events.size() != 3)
+      return;
+    TS_ASSERT_EQUALS(events[0].weight(), 2.);
+    TS_ASSERT_EQUALS(events[0].pulseTime(), start + 50.);
+    TS_ASSERT_EQUALS(events[1].pulseTime(), start);
+    TS_ASSERT_EQUALS(events[2].pulseTime(), start + 100.);
+
+    // Into an empty accumulator
+    CompressEventAccumulator empty(1., CompressBinningMode::LINEAR);
+    second.addEvent(7.5, start + 5.);
+    empty.merge(second);
+    empty.createWeightedEvents(events);
+    TS_ASSERT_EQUALS(events.size(), 1);
+    if (!events.empty())
+      TS_ASSERT_EQUALS(events[0].pulseTime(), start + 5.);
+  }
+
+  void test_zero_tolerance_only_combines_identical_tofs() {
+    CompressEventAccumulator accumulator(0., CompressBinningMode::LINEAR);
+    for (const double tof : {3., -1., 3., 0., 3.0000001, -2., -1.})
+      accumulator.addEvent(tof);
+
+    std::vector<WeightedEventNoTime> events;
+    accumulator.createWeightedEvents(events);
+    TS_ASSERT_EQUALS(events.size(), 5);
+    const std::vector<double> tofs{-2., -1., 0., 3., 3.0000001};
+    const std::vector<double> weights{1., 2., 1., 2., 1.};
+    for (size_t i = 0; i < std::min(events.size(), tofs.size()); ++i) {
+      TS_ASSERT_EQUALS(events[i].tof(), tofs[i]);
+      TS_ASSERT_EQUALS(events[i].weight(), weights[i]);
+    }
+  }
+
+  void test_logarithmic_bins() {
+    CompressEventAccumulator accumulator(0.01,
+                                         CompressBinningMode::LOGARITHMIC);
+    // Bins are 1% wide wherever they are
+    for (const double tof : {110., 110.5, 10000., 10000.5, 10101., -5., 0.})
+      accumulator.addEvent(tof);
+
+    std::vector<WeightedEventNoTime> events;
+    accumulator.createWeightedEvents(events);
+    TS_ASSERT_EQUALS(events.size(), 4);
+    TS_ASSERT_DELTA(events[0].tof(), -2.5, 1e-12);
+    TS_ASSERT_EQUALS(events[0].weight(), 2.);
+    TS_ASSERT_DELTA(events[1].tof(), 110.25, 1e-12);
+    TS_ASSERT_DELTA(events[2].tof(), 10000.25, 1e-12);
+    TS_ASSERT_DELTA(events[3].tof(), 10101., 1e-12);
+  }
+
+  void test_matches_sorting_then_binning() {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> distribution(0., 20000.);
+    std::vector<double> tofs(100000);
+    for (auto &tof : tofs)
+      tof = distribution(generator);
+
+    const double tolerance = 5.;
+    CompressEventAccumulator accumulator(tolerance,
+                                         CompressBinningMode::LINEAR);
+    for (const double tof : tofs)
+      accumulator.addEvent(tof);
+    std::vector<WeightedEventNoTime> events;
+    accumulator.createWeightedEvents(events);
+
+    std::sort(tofs.begin(), tofs.end());
+    std::vector<double> expected;
+    double lastIndex = -1.;
+    for (const double tof : tofs) {
+      const double index = std::floor(tof / tolerance);
+      if (index != lastIndex)
+        expected.emplace_back(0.);
+      lastIndex = index;
+      expected.back() += 1.;
+    }
+    TS_ASSERT_EQUALS(events.size(), expected.size());
+    double total = 0.;
+    bool sameWeights = events.size() == expected.size();
+    for (size_t i = 0; sameWeights && i < events.size(); ++i) {
+      sameWeights = events[i].weight() == expected[i];
+      total += events[i].weight();
+    }
+    TS_ASSERT(sameWeights);
+    TS_ASSERT_EQUALS(total, static_cast<double>(tofs.size()));
+    TS_ASSERT(std::is_sorted(events.cbegin(), events.cend()));
+  }
+};
@@ -0,0 +1,171 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include <cxxtest/TestSuite.h>
+
+#include "MantidDataHandling/EventWorkspaceCache.h"
+#include "MantidDataObjects/EventList.h"
+
+#include <Poco/File.h>
+#include <Poco/Path.h>
+
+#include <fstream>
+
+using Mantid::DataHandling::EventWorkspaceCache;
+using namespace Mantid::DataObjects;
+using Mantid::Types::Core::DateAndTime;
+using Mantid::Types::Event::TofEvent;
+
+class EventWorkspaceCacheTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static EventWorkspaceCacheTest *createSuite() {
+    return new EventWorkspaceCacheTest();
+  }
+  static void destroySuite(EventWorkspaceCacheTest *suite) { delete suite; }
+
+  EventWorkspaceCacheTest()
+      : m_directory(Poco::Path(Poco::Path(Poco::Path::temp()),
+                               "EventWorkspaceCacheTest")
+                        .toString()) {}
+
+  void tearDown() override {
+    Poco::File directory(m_directory);
+    if (directory.exists())
+      directory.remove(true);
+  }
+
+  void test_disabled_without_directory() {
+    EventWorkspaceCache cache("", 1024);
+    TS_ASSERT(!cache.enabled());
+    EventList list;
+    EventWorkspaceCache::LoadStatistics statistics;
+    cache.save("key", {&list}, statistics);
+    TS_ASSERT(!cache.load("key", {&list}, statistics));
+  }
+
+  void test_makeKey_changes_with_options() {
+    const std::string filename = m_directory + "_file.nxs";
+    std::ofstream(filename) << "not really a NeXus file";
+    const auto key = EventWorkspaceCache::makeKey(filename, "Precount=1");
+    TS_ASSERT_EQUALS(key, EventWorkspaceCache::makeKey(filename, "Precount=1"));
+    TS_ASSERT_DIFFERS(key,
+                      EventWorkspaceCache::makeKey(filename, "Precount=0"));
+    Poco::File(filename).remove();
+  }
+
+  void test_miss() {
+    EventWorkspaceCache cache(m_directory, 1024 * 1024);
+    EventList list;
+    list.addEventQuickly(TofEvent(1., DateAndTime(10)));
+    EventWorkspaceCache::LoadStatistics statistics;
+    TS_ASSERT(!cache.load("missing", {&list}, statistics));
+    TS_ASSERT_EQUALS(list.getNumberEvents(), 1);
+  }
+
+  void test_save_and_load() {
+    EventList tof;
+    tof.addEventQuickly(TofEvent(2., DateAndTime(20)));
+    tof.addEventQuickly(TofEvent(1., DateAndTime(10)));
+    tof.setSortOrder(PULSETIME_SORT);
+    EventList weighted(tof);
+    weighted.switchTo(Mantid::API::WEIGHTED);
+    weighted.getWeightedEvents()[0].m_weight = 3.f;
+    EventList noTime(weighted);
+    noTime.compressEvents(10., &noTime);
+    EventList empty;
+
+    EventWorkspaceCache::LoadStatistics saved;
+    saved.shortestTof = 1.;
+    saved.longestTof = 2.;
+    saved.badTofs = 3;
+    saved.discardedEvents = 4;
+    EventWorkspaceCache cache(m_directory, 1024 * 1024);
+    cache.save("run", {&tof, &weighted, &noTime, &empty}, saved);
+    TS_ASSERT(Poco::File(cache.entryPath("run")).exists());
+
+    std::vector<EventList> loaded(4);
+    loaded[3].addEventQuickly(TofEvent(5., DateAndTime(50)));
+    EventWorkspaceCache::LoadStatistics statistics;
+    TS_ASSERT(cache.load("run",
+                         {&loaded[0], &loaded[1], &loaded[2], &loaded[3]},
+                         statistics));
+    TS_ASSERT(loaded[0] == tof);
+    TS_ASSERT_EQUALS(loaded[0].getSortType(), PULSETIME_SORT);
+    TS_ASSERT(loaded[1] == weighted);
+    TS_ASSERT_EQUALS(loaded[1].getWeightedEvents()[0].weight(), 3.f);
+    TS_ASSERT_EQUALS(loaded[2].getEventType(), Mantid::API::WEIGHTED_NOTIME);
+    TS_ASSERT(loaded[2] == noTime);
+    TS_ASSERT_EQUALS(loaded[3].getNumberEvents(), 0);
+    TS_ASSERT_EQUALS(statistics.shortestTof, 1.);
+    TS_ASSERT_EQUALS(statistics.longestTof, 2.);
+    TS_ASSERT_EQUALS(statistics.badTofs, 3);
+    TS_ASSERT_EQUALS(statistics.discardedEvents, 4);
+
+    // An entry for a different number of spectra is not used
+    TS_ASSERT(!cache.load("run", {&loaded[0]}, statistics));
+  }
+
+  void test_save_keeps_the_storage_of_the_lists() {
+    EventList tof;
+    tof.addEventQuickly(TofEvent(2., DateAndTime(20)));
+    tof.addEventQuickly(TofEvent(1., DateAndTime(10)));
+    EventList weighted(tof);
+    weighted.switchTo(Mantid::API::WEIGHTED);
+    weighted.getWeightedEvents()[0].m_weight = 3.f;
+    weighted.getWeightedEvents()[0].m_errorSquared = 5.f;
+    EventList noTime(weighted);
+    noTime.switchTo(Mantid::API::WEIGHTED_NOTIME);
+    std::vector<EventList> expected{tof, weighted, noTime, tof};
+
+    EventList compact(tof);
+    compact.setStorageType(COMPACT_STORAGE);
+    tof.setStorageType(COLUMN_STORAGE);
+    weighted.setStorageType(COLUMN_STORAGE);
+    noTime.setStorageType(COLUMN_STORAGE);
+    const std::vector<const EventList *> lists{&tof, &weighted, &noTime,
+                                               &compact};
+    std::vector<size_t> memory;
+    for (const auto *list : lists)
+      memory.emplace_back(list->getMemorySize());
+
+    EventWorkspaceCache cache(m_directory, 1024 * 1024);
+    cache.save("run", lists, EventWorkspaceCache::LoadStatistics());
+    // Saving neither converts the lists nor keeps a row copy of them
+    TS_ASSERT_EQUALS(tof.getStorageType(), COLUMN_STORAGE);
+    TS_ASSERT_EQUALS(compact.getStorageType(), COMPACT_STORAGE);
+    for (size_t i = 0; i < lists.size(); ++i)
+      TS_ASSERT_EQUALS(lists[i]->getMemorySize(), memory[i]);
+
+    std::vector<EventList> loaded(4);
+    EventWorkspaceCache::LoadStatistics statistics;
+    TS_ASSERT(cache.load("run",
+                         {&loaded[0], &loaded[1], &loaded[2], &loaded[3]},
+                         statistics));
+    for (size_t i = 0; i < loaded.size(); ++i)
+      TS_ASSERT(loaded[i] == expected[i]);
+    TS_ASSERT_EQUALS(loaded[1].getWeightedEvents()[0].errorSquared(), 5.f);
+  }
+
+  void test_evicts_least_recently_used() {
+    EventList list;
+    for (int i = 0; i < 1000; ++i)
+      list.addEventQuickly(TofEvent(i, DateAndTime(i)));
+    EventWorkspaceCache::LoadStatistics statistics;
+    // Room for one entry only
+    EventWorkspaceCache cache(m_directory, 1000 * sizeof(TofEvent) + 1024);
+    cache.save("first", {&list}, statistics);
+    cache.save("second", {&list}, statistics);
+    TS_ASSERT(!Poco::File(cache.entryPath("first")).exists());
+    TS_ASSERT(Poco::File(cache.entryPath("second")).exists());
+  }
+
+private:
+  std::string m_directory;
+};
@@ -7,17 +7,21 @@
 #pragma once
 
 #include "MantidAPI/AlgorithmManager.h"
+#include "MantidAPI/FileFinder.h"
 #include "MantidAPI/FrameworkManager.h"
 #include "MantidAPI/MatrixWorkspace.h"
 #include "MantidAPI/Run.h"
 #include "MantidAPI/SpectrumInfo.h"
 #include "MantidAPI/Workspace.h"
+#include "MantidDataHandling/EventWorkspaceCache.h"
 #include "MantidDataHandling/LoadEventNexus.h"
+#include "MantidDataHandling/MemoryMappedDataset.h"
 #include "MantidDataObjects/EventWorkspace.h"
 #include "MantidGeometry/Instrument/DetectorInfo.h"
 #include "MantidIndexing/IndexInfo.h"
 #include "MantidIndexing/SpectrumIndexSet.h"
 #include "MantidIndexing/SpectrumNumber.h"
+#include "MantidKernel/ConfigService.h"
 #include "MantidKernel/Property.h"
 #include "MantidKernel/TimeSeriesProperty.h"
 #include "MantidNexusGeometry/Hdf5Version.h"
@@ -26,6 +30,9 @@
 #include "MantidTestHelpers/ParallelAlgorithmCreation.h"
 #include "MantidTestHelpers/ParallelRunner.h"
 
+#include <H5Cpp.h>
+#include <Poco/File.h>
+#include <Poco/Path.h>
 #include <cxxtest/TestSuite.h>
 
 using namespace Mantid;
@@ -90,6 +97,59 @@ void run_multiprocess_load(const std::string &file, bool precount) {
 }
 
 namespace {
+/// Rewrite a field without chunking or compression, keeping its attributes
+void make_contiguous(H5::Group &group, const std::string &name) {
+  H5::DataSet dataset = group.openDataSet(name);
+  const H5::DataType type = dataset.getDataType();
+  hsize_t length = 0;
+  dataset.getSpace().getSimpleExtentDims(&length);
+  std::vector<char> data(length * type.getSize());
+  dataset.read(data.data(), type);
+  std::vector<H5::Attribute> attributes;
+  for (int i = 0; i < dataset.getNumAttrs(); ++i)
+    attributes.emplace_back(dataset.openAttribute(static_cast<unsigned>(i)));
+  group.unlink(name);
+
+  H5::DataSet contiguous =
+      group.createDataSet(name, type, H5::DataSpace(1, &length));
+  contiguous.write(data.data(), type);
+  for (const auto &attribute : attributes) {
+    const H5::DataType attributeType = attribute.getDataType();
+    const H5::DataSpace space = attribute.getSpace();
+    std::vector<char> value(
+        static_cast<size_t>(space.getSimpleExtentNpoints()) *
+        attributeType.getSize());
+    attribute.read(attributeType, value.data());
+    contiguous.createAttribute(attribute.getName(), attributeType, space)
+        .write(attributeType, value.data());
+  }
+}
+
+/// Copy a file with the event_id and event_time_offset fields of every bank
+/// stored contiguously, so that they can be mapped
+std::string contiguous_copy(const std::string &filename) {
+  const std::string copy =
+      Poco::Path(ConfigService::Instance().getTempDir())
+          .append("LoadEventNexusTest_" + filename)
+          .toString();
+  Poco::File(FileFinder::Instance().getFullPath(filename)).copyTo(copy);
+  H5::H5File file(copy, H5F_ACC_RDWR);
+  H5::Group entry = file.openGroup("entry");
+  const std::string suffix = "_events";
+  for (hsize_t i = 0; i < entry.getNumObjs(); ++i) {
+    const std::string name = entry.getObjnameByIdx(i);
+    if (name.size() <= suffix.size() ||
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+      continue;
+    H5::Group bank = entry.openGroup(name);
+    if (H5Lexists(bank.getId(), "event_id", H5P_DEFAULT) <= 0)
+      continue;
+    make_contiguous(bank, "event_id");
+    make_contiguous(bank, "event_time_offset");
+  }
+  return copy;
+}
+
 std::shared_ptr<const EventWorkspace>
 load_reference_workspace(const std::string &filename) {
   // Construct default communicator *without* threading backend. In non-MPI run
@@ -199,6 +259,18 @@ private:
                      filteredLogEndTime.toSimpleString());
   }
 
+  EventWorkspace_sptr loadWithoutLogs(const std::string &filename,
+                                      const std::string &wsName) {
+    LoadEventNexus ld;
+    ld.initialize();
+    ld.setPropertyValue("Filename", filename);
+    ld.setPropertyValue("OutputWorkspace", wsName);
+    ld.setProperty<bool>("LoadLogs", false);
+    TS_ASSERT_THROWS_NOTHING(ld.execute());
+    TS_ASSERT(ld.isExecuted());
+    return AnalysisDataService::Instance().retrieveWS<EventWorkspace>(wsName);
+  }
+
 public:
   void test_load_event_nexus_v20_ess() {
     const std::string file = "V20_ESS_example.nxs";
@@ -735,6 +807,139 @@ public:
         ads.retrieveWS<MatrixWorkspace>("cncs_compressed")->monitorWorkspace());
   }
 
+  void test_Load_And_CompressEvents_while_loading() {
+    LoadEventNexus ld;
+    std::string outws_name = "cncs_compressed_while_loading";
+    ld.initialize();
+    ld.setPropertyValue("Filename", "CNCS_7860_event.nxs");
+    ld.setPropertyValue("OutputWorkspace", outws_name);
+    ld.setPropertyValue("CompressTolerance", "0.05");
+    ld.setPropertyValue("CompressBinningMode", "Linear");
+    ld.setProperty<bool>("LoadLogs", false); // Time-saver
+    ld.execute();
+    TS_ASSERT(ld.isExecuted());
+
+    EventWorkspace_sptr WS =
+        AnalysisDataService::Instance().retrieveWS<EventWorkspace>(outws_name);
+    TS_ASSERT(WS);
+    TS_ASSERT_EQUALS(WS->getNumberHistograms(), 51200);
+    const DateAndTime runDay("2010-03-25T00:00:00");
+    // Fewer events, but all of the 112266 raw events are accounted for
+    TS_ASSERT_LESS_THAN(WS->getNumberEvents(), 112266);
+    double totalWeight = 0.;
+    for (size_t wi = 0; wi < WS->getNumberHistograms(); wi++) {
+      const auto &el = WS->getSpectrum(wi);
+      if (el.getNumberEvents() == 0)
+        continue;
+      // The pulse times are kept
+      TS_ASSERT_EQUALS(el.getEventType(), WEIGHTED);
+      TS_ASSERT(el.isSortedByTof());
+      for (const auto &event : el.getWeightedEvents()) {
+        totalWeight += event.weight();
+        TS_ASSERT_LESS_THAN(runDay, event.pulseTime());
+      }
+    }
+    TS_ASSERT_DELTA(totalWeight, 112266., 1e-6);
+    AnalysisDataService::Instance().remove(outws_name);
+  }
+
+  void test_memory_mapped_fields_are_used() {
+    const std::string filename = contiguous_copy("CNCS_7860_event.nxs");
+    auto &config = ConfigService::Instance();
+    const std::string key = "loadeventnexus.memorymap";
+    const std::string previous = config.getString(key);
+
+    config.setString(key, "1");
+    const size_t mappedBefore = MemoryMappedDataset::mappedCount();
+    const auto mapped = loadWithoutLogs(filename, "mapped");
+    const size_t mappedFields =
+        MemoryMappedDataset::mappedCount() - mappedBefore;
+    config.setString(key, "0");
+    const auto read = loadWithoutLogs(filename, "read");
+    config.setString(key, previous);
+    Poco::File(filename).remove();
+
+    // event_id and event_time_offset of every bank with events
+    TS_ASSERT_LESS_THAN(1u, mappedFields);
+    TS_ASSERT_EQUALS(mappedFields % 2, 0u);
+    TS_ASSERT(mapped);
+    TS_ASSERT(read);
+    if (!mapped || !read)
+      return;
+    TS_ASSERT_EQUALS(mapped->getNumberEvents(), read->getNumberEvents());
+    TS_ASSERT_EQUALS(mapped->getNumberHistograms(),
+                     read->getNumberHistograms());
+    // Banks may be processed in parts, in any order
+    mapped->sortAll(PULSETIMETOF_SORT, nullptr);
+    read->sortAll(PULSETIMETOF_SORT, nullptr);
+    for (size_t i = 0; i < read->getNumberHistograms(); ++i) {
+      TS_ASSERT_EQUALS(mapped->getSpectrum(i), read->getSpectrum(i));
+      if (!(mapped->getSpectrum(i) == read->getSpectrum(i)))
+        break;
+    }
+    AnalysisDataService::Instance().remove("mapped");
+    AnalysisDataService::Instance().remove("read");
+  }
+
+  void test_second_load_uses_the_event_cache() {
+    auto &config = ConfigService::Instance();
+    const std::string key = "loadeventnexus.cache.directory";
+    const std::string previous = config.getString(key);
+    const std::string directory =
+        Poco::Path(Poco::Path(Poco::Path::temp()), "LoadEventNexusTestCache")
+            .toString();
+    config.setString(key, directory);
+
+    const auto first = loadWithoutLogs("CNCS_7860_event.nxs", "first");
+    std::vector<std::string> entries;
+    Poco::File(directory).list(entries);
+    TS_ASSERT_EQUALS(entries.size(), 1);
+    TS_ASSERT(first);
+    if (entries.size() != 1 || !first) {
+      config.setString(key, previous);
+      return;
+    }
+
+    // Replace the entry by the same events less those of one spectrum, so
+    // only a load that reads the entry misses them
+    const auto cache = EventWorkspaceCache::fromConfig();
+    const std::string entryKey = Poco::Path(entries.front()).getBaseName();
+    const size_t emptied = 42;
+    const size_t numberEvents = first->getSpectrum(emptied).getNumberEvents();
+    first->getSpectrum(emptied).clear(false);
+    std::vector<const EventList *> lists;
+    for (size_t i = 0; i < first->getNumberHistograms(); ++i)
+      lists.emplace_back(&first->getSpectrum(i));
+    cache.save(entryKey, lists, EventWorkspaceCache::LoadStatistics());
+
+    const auto second = loadWithoutLogs("CNCS_7860_event.nxs", "second");
+    config.setString(key, previous);
+    Poco::File(directory).remove(true);
+
+    TS_ASSERT_LESS_THAN(0u, numberEvents);
+    TS_ASSERT(second);
+    if (!second)
+      return;
+    TS_ASSERT_EQUALS(second->getNumberEvents(), first->getNumberEvents());
+    TS_ASSERT_EQUALS(second->getSpectrum(emptied).getNumberEvents(), 0);
+    TS_ASSERT_EQUALS(second->getSpectrum(emptied + 1),
+                     first->getSpectrum(emptied + 1));
+    AnalysisDataService::Instance().remove("first");
+    AnalysisDataService::Instance().remove("second");
+  }
+
+  void test_Logarithmic_compression_needs_a_tolerance() {
+    LoadEventNexus ld;
+    ld.initialize();
+    ld.setRethrows(true);
+    ld.setPropertyValue("Filename", "CNCS_7860_event.nxs");
+    ld.setPropertyValue("OutputWorkspace", "cncs_not_loaded");
+    ld.setPropertyValue("CompressTolerance", "0");
+    ld.setPropertyValue("CompressBinningMode", "Logarithmic");
+    ld.setProperty<bool>("LoadLogs", false);
+    TS_ASSERT_THROWS(ld.execute(), const std::invalid_argument &);
+  }
+
   void doTestSingleBank(bool SingleBankPixelsOnly, bool Precount,
                         const std::string &BankName = "bank36",
                         bool willFail = false) {
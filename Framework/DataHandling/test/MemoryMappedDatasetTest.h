@@ -0,0 +1,121 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include <cxxtest/TestSuite.h>
+
+#include "MantidDataHandling/H5Util.h"
+#include "MantidDataHandling/MemoryMappedDataset.h"
+
+#include <H5Cpp.h>
+#include <Poco/File.h>
+
+#include <numeric>
+
+using namespace H5;
+using namespace Mantid::DataHandling;
+
+class MemoryMappedDatasetTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static MemoryMappedDatasetTest *createSuite() {
+    return new MemoryMappedDatasetTest();
+  }
+  static void destroySuite(MemoryMappedDatasetTest *suite) { delete suite; }
+
+  MemoryMappedDatasetTest() : m_ids(1000), m_tofs(1000) {
+    std::iota(m_ids.begin(), m_ids.end(), 100u);
+    std::iota(m_tofs.begin(), m_tofs.end(), 0.5f);
+
+    removeFile();
+    H5File file(FILENAME, H5F_ACC_EXCL);
+    Group group = file.createGroup("entry");
+    DataSpace space = H5Util::getDataSpace(m_ids);
+    // contiguous, the default layout
+    group.createDataSet("event_id", PredType::NATIVE_UINT32, space)
+        .write(m_ids.data(), PredType::NATIVE_UINT32);
+    group.createDataSet("event_time_offset", PredType::NATIVE_FLOAT, space)
+        .write(m_tofs.data(), PredType::NATIVE_FLOAT);
+    // chunked and compressed
+    const auto compressed = H5Util::setCompressionAttributes(m_ids.size());
+    group
+        .createDataSet("compressed_id", PredType::NATIVE_UINT32, space,
+                       compressed)
+        .write(m_ids.data(), PredType::NATIVE_UINT32);
+    file.close();
+  }
+
+  ~MemoryMappedDatasetTest() override { removeFile(); }
+
+  void test_map_contiguous_uint32() {
+    const auto ids =
+        MemoryMappedDataset::map<uint32_t>(FILENAME, "/entry/event_id", 0, 1000);
+    TS_ASSERT(ids);
+    if (ids) {
+      TS_ASSERT_EQUALS(ids.get()[0], 100u);
+      TS_ASSERT_EQUALS(ids.get()[999], 1099u);
+    }
+  }
+
+  void test_map_part_of_dataset_float() {
+    const auto tofs = MemoryMappedDataset::map<float>(
+        FILENAME, "/entry/event_time_offset", 250, 10);
+    TS_ASSERT(tofs);
+    if (tofs) {
+      TS_ASSERT_EQUALS(tofs.get()[0], m_tofs[250]);
+      TS_ASSERT_EQUALS(tofs.get()[9], m_tofs[259]);
+    }
+  }
+
+  void test_map_while_the_file_is_open_with_a_strong_close_degree() {
+    // As the NeXus API keeps it open while a bank is loaded
+    FileAccPropList access;
+    access.setFcloseDegree(H5F_CLOSE_STRONG);
+    H5File file(FILENAME, H5F_ACC_RDONLY, FileCreatPropList::DEFAULT, access);
+    DataSet dataset = file.openDataSet("/entry/event_id");
+
+    const size_t before = MemoryMappedDataset::mappedCount();
+    const auto ids =
+        MemoryMappedDataset::map<uint32_t>(FILENAME, "/entry/event_id", 0, 10);
+    TS_ASSERT(ids);
+    TS_ASSERT_EQUALS(MemoryMappedDataset::mappedCount(), before + 1);
+    if (ids)
+      TS_ASSERT_EQUALS(ids.get()[9], 109u);
+  }
+
+  void test_compressed_dataset_is_not_mapped() {
+    TS_ASSERT(!MemoryMappedDataset::map<uint32_t>(FILENAME,
+                                                  "/entry/compressed_id", 0,
+                                                  1000));
+  }
+
+  void test_wrong_type_is_not_mapped() {
+    TS_ASSERT(!MemoryMappedDataset::map<float>(FILENAME, "/entry/event_id", 0,
+                                               1000));
+  }
+
+  void test_range_past_end_is_not_mapped() {
+    TS_ASSERT(!MemoryMappedDataset::map<uint32_t>(FILENAME, "/entry/event_id",
+                                                  995, 10));
+  }
+
+  void test_missing_dataset_is_not_mapped() {
+    TS_ASSERT(!MemoryMappedDataset::map<uint32_t>(FILENAME, "/entry/nothing",
+                                                  0, 1));
+  }
+
+private:
+  void removeFile() {
+    if (Poco::File(FILENAME).exists())
+      Poco::File(FILENAME).remove();
+  }
+
+  const std::string FILENAME{"MemoryMappedDatasetTest.h5"};
+  std::vector<uint32_t> m_ids;
+  std::vector<float> m_tofs;
+};
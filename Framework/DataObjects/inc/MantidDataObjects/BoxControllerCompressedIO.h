@@ -0,0 +1,174 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidAPI/BoxController.h"
+#include "MantidAPI/IBoxControllerIO.h"
+#include "MantidKernel/System.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <nexus/NeXusFile.hpp>
+
+namespace Mantid {
+namespace DataObjects {
+
+/** BoxControllerCompressedIO : saves and loads the events of MD workspaces
+  compressed, block by block, in the NeXus file holding the workspace.
+
+  Each block of events given to saveBlock is compressed on its own and its
+  bytes put in one byte array. A block index maps the position of the first
+  event of each block, as used by the boxes and the DiskBuffer, to its bytes.
+  A block is compressed by:
+  - replacing every value by its XOR with the value of the same column in the
+    previous event, which clears the sign, exponent and leading mantissa bits
+    shared by the events of a box,
+  - shuffling the bytes so that the n-th bytes of all values are together,
+  - deflating the result with zlib at its fastest level.
+
+  Loading a block reads the bytes of the blocks following it in the file in
+  the same call, up to READ_AHEAD_BYTES, so loading boxes in file order reads
+  the file in large sequential pieces. SaveMD writes the boxes in the Morton
+  order of their centres, so boxes near each other in space are near each
+  other in the file.
+
+  A rewritten block goes back in place when it fits. Otherwise it goes in the
+  smallest free range of the byte array that holds it, or at the end of the
+  array. The ranges left by moved or replaced blocks are kept in a free list,
+  rebuilt from the gaps between the blocks when the file is opened, and a free
+  range at the end of the array shortens it.
+*/
+class DLLExport BoxControllerCompressedIO : public API::IBoxControllerIO {
+public:
+  /// Name of the NeXus group holding the compressed events
+  static const std::string EVENT_GROUP_NAME;
+  /// Largest number of bytes read in one call when loading a block
+  static constexpr size_t READ_AHEAD_BYTES = 4 << 20;
+
+  BoxControllerCompressedIO(API::BoxController *const bc);
+  ~BoxControllerCompressedIO() override;
+
+  ///@return true if the file to write events is opened and false otherwise
+  bool isOpened() const override { return m_File != nullptr; }
+  /// get the full file name of the file used for IO operations
+  const std::string &getFileName() const override { return m_fileName; }
+  /// Number of events the DiskBuffer should gather before writing
+  size_t getDataChunk() const override { return DATA_CHUNK; }
+
+  bool openFile(const std::string &fileName, const std::string &mode) override;
+
+  void saveBlock(const std::vector<float> &DataBlock,
+                 const uint64_t blockPosition) const override;
+  void loadBlock(std::vector<float> &Block, const uint64_t blockPosition,
+                 const size_t nPoints) const override;
+  void saveBlock(const std::vector<double> &DataBlock,
+                 const uint64_t blockPosition) const override;
+  void loadBlock(std::vector<double> &Block, const uint64_t blockPosition,
+                 const size_t nPoints) const override;
+
+  void flushData() const override;
+  void closeFile() override;
+
+  void setDataType(const size_t blockSize,
+                   const std::string &typeName) override;
+  void getDataType(size_t &CoordSize, std::string &typeName) const override;
+
+  /// Number of bytes taken by the compressed events in the file
+  uint64_t getCompressedSize() const;
+
+  static std::vector<uint8_t> compressBlock(const std::vector<float> &block,
+                                            const size_t nColumns);
+  static std::vector<uint8_t> compressBlock(const std::vector<double> &block,
+                                            const size_t nColumns);
+  static void decompressBlock(const std::vector<uint8_t> &bytes,
+                              const size_t nColumns, std::vector<float> &block);
+  static void decompressBlock(const std::vector<uint8_t> &bytes,
+                              const size_t nColumns,
+                              std::vector<double> &block);
+
+private:
+  /// Number of events the DiskBuffer gathers before writing
+  enum { DATA_CHUNK = 10000 };
+  /// The place of a compressed block in the byte array
+  struct BlockEntry {
+    /// Number of events in the block
+    uint64_t nEvents;
+    /// Offset of the bytes of the block
+    uint64_t offset;
+    /// Number of bytes of the block
+    uint64_t size;
+    /// Number of bytes reserved for the block
+    uint64_t capacity;
+  };
+  using BlockMap = std::map<uint64_t, BlockEntry>;
+
+  void createEventGroup();
+  void openEventGroup();
+  void writeIndex() const;
+  void releaseBytes(const uint64_t offset, const uint64_t size) const;
+  uint64_t allocateBytes(const uint64_t size) const;
+  void writeFreeSpace();
+  std::vector<uint8_t> readBytes(BlockMap::const_iterator block) const;
+  void writeBytes(std::vector<uint8_t> &bytes, const uint64_t offset) const;
+
+  void prefetchBlock(const uint64_t blockPosition,
+                     const uint64_t nPoints) override;
+
+  template <typename Type>
+  void saveGenericBlock(const std::vector<Type> &DataBlock,
+                        const uint64_t blockPosition) const;
+  template <typename Type>
+  void writeGenericBlock(const std::vector<Type> &DataBlock,
+                         const uint64_t blockPosition) const;
+  template <typename Type>
+  void loadGenericBlock(std::vector<Type> &Block, const uint64_t blockPosition,
+                        const size_t nPoints) const;
+  template <typename Type>
+  void decodeBlock(const std::vector<uint8_t> &bytes, const uint64_t nEvents,
+                   std::vector<Type> &events) const;
+
+  /// full file name (with path) of the NeXus file
+  std::string m_fileName;
+  /// the file handler, opened in the group of the compressed events
+  std::unique_ptr<::NeXus::File> m_File;
+  /// whether the file is open only for reading
+  bool m_ReadOnly;
+  /// the box controller using this IO
+  API::BoxController *const m_bc;
+  /// number of bytes of the coordinates given to save/load (float or double)
+  unsigned int m_CoordSize;
+  /// number of bytes of the coordinates stored in the file
+  unsigned int m_fileCoordSize;
+  /// the event types this class understands; the index is the event type
+  std::vector<std::string> m_EventsTypesSupported;
+  /// index of the type of the events in m_EventsTypesSupported
+  size_t m_EventType;
+  /// number of values stored for each event
+  size_t m_nColumns;
+
+  /// the blocks in the file, by position of their first event
+  mutable BlockMap m_blocks;
+  /// number of bytes used in the byte array
+  mutable uint64_t m_bytesLength;
+  /// the unused ranges of the byte array, size by offset
+  mutable std::map<uint64_t, uint64_t> m_freeBytes;
+  /// number of rows of the block index in the file
+  mutable uint64_t m_indexRows;
+  /// offset of the bytes last read ahead
+  mutable uint64_t m_readAheadOffset;
+  /// the bytes last read ahead
+  mutable std::vector<uint8_t> m_readAhead;
+  /// lock for the file and the block index
+  mutable std::mutex m_fileMutex;
+};
+
+} // namespace DataObjects
+} // namespace Mantid
@@ -139,10 +139,20 @@ private:
     /// conversion btween fload/double requested by the client
   } m_ReadConversion;
 
+  void prefetchBlock(const uint64_t blockPosition,
+                     const uint64_t nPoints) override;
+  void readBlock(std::vector<float> &Block, const uint64_t blockPosition,
+                 const size_t nPoints) const;
+  void readBlock(std::vector<double> &Block, const uint64_t blockPosition,
+                 const size_t nPoints) const;
+
   template <typename Type>
   void saveGenericBlock(const std::vector<Type> &DataBlock,
                         const uint64_t blockPosition) const;
   template <typename Type>
+  void writeGenericBlock(const std::vector<Type> &DataBlock,
+                         const uint64_t blockPosition) const;
+  template <typename Type>
   void loadGenericBlock(std::vector<Type> &Block, const uint64_t blockPosition,
                         const size_t nPoints) const;
 };
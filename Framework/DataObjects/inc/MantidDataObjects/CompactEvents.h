@@ -0,0 +1,118 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidKernel/System.h"
+#include "MantidKernel/TimeSplitter.h"
+#include "MantidKernel/cow_ptr.h"
+#include "MantidTypes/Event/TofEvent.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Mantid {
+namespace DataObjects {
+
+/// Sorted, unique pulse times referred to by the pulse index of CompactEvent
+using PulseTimeTable = std::vector<Types::Core::DateAndTime>;
+
+/** An unweighted event packed into 8 bytes: a single precision
+ * time-of-flight and the index of its pulse time in a PulseTimeTable.
+ */
+struct CompactEvent {
+  /// Time-of-flight (or other X unit)
+  float tof;
+  /// Index of the pulse time in the table
+  uint32_t pulseIndex;
+};
+
+/** CompactEvents : a compact store for the events of an unweighted EventList.
+
+  A TofEvent carries a 64-bit pulse time, but the events of a run only ever
+  refer to the few thousand (or, for a long run, few million) pulses of the
+  run. CompactEvents stores each event as a CompactEvent, replacing the pulse
+  time by its index in a sorted table of pulse times that is shared by all
+  the lists of a workspace, which halves the memory of the events.
+
+  The time-of-flight is held in single precision, the precision it is stored
+  with in event NeXus files. Operations on pulse times (filtering, splitting
+  and histogramming) are done on the pulse indices, after converting the
+  requested times into index ranges once.
+*/
+class DLLExport CompactEvents {
+public:
+  static std::shared_ptr<const PulseTimeTable>
+  makePulseTimeTable(const std::vector<Types::Event::TofEvent> &events);
+  static std::shared_ptr<const PulseTimeTable>
+  makePulseTimeTable(PulseTimeTable times);
+  static void addPulseTimes(PulseTimeTable &times,
+                            const std::vector<Types::Event::TofEvent> &events);
+
+  void assign(const std::vector<Types::Event::TofEvent> &events,
+              std::shared_ptr<const PulseTimeTable> pulseTimes);
+  void extract(std::vector<Types::Event::TofEvent> &events) const;
+  bool push_back(const Types::Event::TofEvent &event);
+
+  /// Number of events
+  size_t size() const { return m_events.size(); }
+  /// True if there are no events
+  bool empty() const { return m_events.empty(); }
+  /// The events
+  const std::vector<CompactEvent> &events() const { return m_events; }
+  /// The table of pulse times that the events refer to
+  const std::shared_ptr<const PulseTimeTable> &pulseTimeTable() const {
+    return m_pulseTimes;
+  }
+  /// The pulse time of an event
+  Types::Core::DateAndTime pulseTime(const CompactEvent &event) const {
+    return (*m_pulseTimes)[event.pulseIndex];
+  }
+
+  void clear();
+  void reserve(size_t num);
+  size_t getMemorySize() const;
+
+  void sortTof();
+  void sortPulseTime();
+  void reverse();
+  void convertTof(const double factor, const double offset);
+  void convertTof(const std::function<double(double)> &func);
+
+  void getTofs(std::vector<double> &tofs) const;
+  void getPulseTimes(std::vector<Types::Core::DateAndTime> &times) const;
+  Types::Core::DateAndTime getPulseTimeMin() const;
+  Types::Core::DateAndTime getPulseTimeMax() const;
+
+  void histogram(const MantidVec &X, MantidVec &Y, MantidVec &E,
+                 bool skipError) const;
+  void histogramPulseTime(const MantidVec &X, MantidVec &Y) const;
+
+  void filterByPulseTime(const Types::Core::DateAndTime start,
+                         const Types::Core::DateAndTime stop,
+                         CompactEvents &output) const;
+  void splitByPulseTime(const Kernel::TimeSplitterType &splitter,
+                        std::map<int, CompactEvents *> &outputs) const;
+
+  bool operator==(const CompactEvents &rhs) const;
+
+private:
+  std::pair<uint32_t, uint32_t>
+  pulseIndexRange(const Types::Core::DateAndTime start,
+                  const Types::Core::DateAndTime stop) const;
+
+  /// The events
+  std::vector<CompactEvent> m_events;
+  /// Sorted pulse times that CompactEvent::pulseIndex refers to
+  std::shared_ptr<const PulseTimeTable> m_pulseTimes;
+};
+
+} // namespace DataObjects
+} // namespace Mantid
@@ -51,6 +51,15 @@ public:
   void apply(const coord_t *inputVector, coord_t *outVector) const override;
   Mantid::Kernel::Matrix<coord_t> makeAffineMatrix() const override;
 
+  /// Index in the input of the dimension of each output dimension
+  const std::vector<size_t> &getDimensionToBinFrom() const {
+    return m_dimensionToBinFrom;
+  }
+  /// Offset (minimum) position in each of the output dimensions
+  const std::vector<coord_t> &getOrigin() const { return m_origin; }
+  /// Scaling from the input to each output dimension
+  const std::vector<coord_t> &getScaling() const { return m_scaling; }
+
 protected:
   /// For each dimension in the output, index in the input workspace of which
   /// dimension it is
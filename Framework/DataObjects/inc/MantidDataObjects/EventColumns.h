@@ -0,0 +1,100 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidAPI/MatrixWorkspace_fwd.h" // get MantidVec declaration
+#include "MantidDataObjects/Events.h"
+#include "MantidKernel/System.h"
+#include <cstdint>
+#include <vector>
+
+namespace Mantid {
+namespace DataObjects {
+
+/** EventColumns : a structure-of-arrays store for the events of an EventList.
+
+  The time-of-flight, pulse time, weight and squared error of each event are
+  kept in separate contiguous columns. Loops that only need the time-of-flight
+  (histogramming, unit conversion, sorting) then stream 8 bytes per event
+  rather than the full 16-24 byte event structure and can be vectorized by the
+  compiler.
+
+  Which columns are populated depends on the kind of events stored:
+    - TofEvent: tof + pulse time
+    - WeightedEvent: tof + pulse time + weight + error squared
+    - WeightedEventNoTime: tof + weight + error squared
+*/
+class DLLExport EventColumns {
+public:
+  void assign(const std::vector<Types::Event::TofEvent> &events);
+  void assign(const std::vector<WeightedEvent> &events);
+  void assign(const std::vector<WeightedEventNoTime> &events);
+
+  void extract(std::vector<Types::Event::TofEvent> &events) const;
+  void extract(std::vector<WeightedEvent> &events) const;
+  void extract(std::vector<WeightedEventNoTime> &events) const;
+
+  void push_back(const Types::Event::TofEvent &event);
+  void push_back(const WeightedEvent &event);
+  void push_back(const WeightedEventNoTime &event);
+
+  /// Number of events held in the columns
+  size_t size() const { return m_tof.size(); }
+  /// True if there are no events
+  bool empty() const { return m_tof.empty(); }
+  /// True if the pulse time column is in use
+  bool hasPulseTimes() const { return m_hasPulseTimes; }
+  /// True if the weight and error columns are in use
+  bool hasWeights() const { return m_hasWeights; }
+
+  void clear();
+  void reserve(size_t num);
+  size_t getMemorySize() const;
+
+  void addWeights();
+  void dropPulseTimes();
+
+  /// Time-of-flight column
+  const std::vector<double> &tofs() const { return m_tof; }
+  /// Time-of-flight column
+  std::vector<double> &tofs() { return m_tof; }
+  /// Pulse time column, in nanoseconds since the GPS epoch
+  const std::vector<int64_t> &pulseTimes() const { return m_pulseTime; }
+  /// Weight column
+  const std::vector<float> &weights() const { return m_weight; }
+  /// Squared error column
+  const std::vector<float> &errorSquared() const { return m_errorSquared; }
+
+  void sortTof();
+  void reverse();
+  void convertTof(const double factor, const double offset);
+
+  void histogram(const MantidVec &X, MantidVec &Y, MantidVec &E,
+                 bool skipError) const;
+
+  bool operator==(const EventColumns &rhs) const;
+
+private:
+  template <typename T> void permute(std::vector<T> &column,
+                                     const std::vector<size_t> &order) const;
+
+  /// Time-of-flight (or other X unit) of each event
+  std::vector<double> m_tof;
+  /// Pulse time of each event, in nanoseconds
+  std::vector<int64_t> m_pulseTime;
+  /// Weight of each event
+  std::vector<float> m_weight;
+  /// Squared error of each event
+  std::vector<float> m_errorSquared;
+  /// Whether m_pulseTime is populated
+  bool m_hasPulseTimes{true};
+  /// Whether m_weight and m_errorSquared are populated
+  bool m_hasWeights{false};
+};
+
+} // namespace DataObjects
+} // namespace Mantid
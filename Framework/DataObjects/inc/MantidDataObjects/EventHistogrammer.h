@@ -0,0 +1,96 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidAPI/MatrixWorkspace_fwd.h" // get MantidVec declaration
+#include "MantidDataObjects/Events.h"
+#include "MantidKernel/System.h"
+#include <vector>
+
+namespace Mantid {
+namespace DataObjects {
+struct CompactEvent;
+
+/** EventHistogrammer : bins events into a histogram with fixed bin edges.
+
+  The bin edges are inspected on construction, or their layout is reused when
+  the same edges were seen last by the thread. When they are equally spaced
+  (linear) or equally spaced in log(x) (logarithmic) the bin of each event
+  sorted by time-of-flight is computed arithmetically instead of being
+  searched for. Bin indices are computed for a block of events at a time in a
+  tight loop that the compiler vectorizes; on x86-64 Linux builds with GCC
+  that loop is compiled for AVX-512, AVX2 and the baseline instruction set and
+  the best version is selected at runtime. Each estimate is checked against
+  the real bin edges, so the result is identical to a binary search whatever
+  the rounding.
+
+  Arbitrary bin edges fall back to walking the edges alongside the events.
+  Events that are not sorted by time-of-flight are binned with a binary search
+  per event.
+
+  In every case bin i holds the events with X[i] <= tof < X[i+1].
+*/
+class DLLExport EventHistogrammer {
+public:
+  /// How the bin edges are laid out
+  enum class Layout { Linear, Logarithmic, Arbitrary };
+
+  explicit EventHistogrammer(const MantidVec &X);
+
+  /// The layout detected for the bin edges
+  Layout layout() const { return m_layout; }
+  /// Number of bins, i.e. the size of the output histogram
+  size_t numBins() const { return m_numBins; }
+
+  void countEvents(const std::vector<Types::Event::TofEvent> &events,
+                   const bool sorted, MantidVec &Y) const;
+  void countEvents(const std::vector<CompactEvent> &events, const bool sorted,
+                   MantidVec &Y) const;
+  void sumWeights(const std::vector<WeightedEvent> &events, const bool sorted,
+                  MantidVec &Y, MantidVec &E) const;
+  void sumWeights(const std::vector<WeightedEventNoTime> &events,
+                  const bool sorted, MantidVec &Y, MantidVec &E) const;
+
+  void countEvents(const double *tofs, const size_t numEvents,
+                   const bool sorted, MantidVec &Y) const;
+  void sumWeights(const double *tofs, const float *weights,
+                  const float *errorSquared, const size_t numEvents,
+                  const bool sorted, MantidVec &Y, MantidVec &E) const;
+
+  static Layout detectLayout(const MantidVec &X);
+
+private:
+  template <typename TofAt, typename AddToBin>
+  void binEvents(const size_t numEvents, const bool sorted, TofAt tofAt,
+                 AddToBin addToBin) const;
+  template <typename TofAt, typename AddToBin>
+  void binArithmetic(const size_t numEvents, TofAt tofAt,
+                     AddToBin addToBin) const;
+  template <typename TofAt, typename AddToBin>
+  void binSorted(const size_t numEvents, TofAt tofAt, AddToBin addToBin) const;
+  template <typename TofAt, typename AddToBin>
+  void binUnsorted(const size_t numEvents, TofAt tofAt,
+                   AddToBin addToBin) const;
+  template <typename EventType>
+  void sumEventWeights(const std::vector<EventType> &events, const bool sorted,
+                       MantidVec &Y, MantidVec &E) const;
+  void resetOutput(MantidVec &Y) const;
+
+  /// The bin edges
+  const MantidVec &m_X;
+  /// Number of bins, X.size() - 1 (0 if X has fewer than two entries)
+  size_t m_numBins;
+  /// Layout of the bin edges
+  Layout m_layout;
+  /// Lowest edge: X[0] for linear bins, log(X[0]) for logarithmic ones
+  double m_start{0.};
+  /// Inverse of the (log) bin width
+  double m_inverseWidth{0.};
+};
+
+} // namespace DataObjects
+} // namespace Mantid
@@ -7,10 +7,13 @@
 #pragma once
 
 #include "MantidAPI/IEventList.h"
+#include "MantidDataObjects/CompactEvents.h"
+#include "MantidDataObjects/EventColumns.h"
 #include "MantidDataObjects/Events.h"
 #include "MantidKernel/MultiThreaded.h"
 #include "MantidKernel/System.h"
 #include "MantidKernel/cow_ptr.h"
+#include <atomic>
 #include <iosfwd>
 #include <vector>
 
@@ -26,6 +29,7 @@ using TimeSplitterType = std::vector<SplittingInterval>;
 class Unit;
 } // namespace Kernel
 namespace DataObjects {
+class EventSplitter;
 class EventWorkspaceMRU;
 
 /// How the event list is sorted.
@@ -38,6 +42,16 @@ enum EventSortType {
   TIMEATSAMPLE_SORT
 };
 
+/// How the events of a list are laid out in memory.
+enum EventStorageType {
+  /// One vector of event structures (array of structs)
+  ROW_STORAGE,
+  /// One contiguous column per event field (struct of arrays)
+  COLUMN_STORAGE,
+  /// 8-byte unweighted events indexing a shared pulse time table
+  COMPACT_STORAGE
+};
+
 //==========================================================================================
 /** @class Mantid::DataObjects::EventList
 
@@ -50,6 +64,19 @@ enum EventSortType {
     or WeightedEvent (where each neutron can have a non-1 weight).
     This is done transparently.
 
+    The events can optionally be held in columnar form (see EventColumns and
+    setStorageType()). Histogramming, sorting by TOF, linear TOF conversion
+    and the getTofs(), getPulseTimes(), getWeights() and getWeightErrors()
+    accessors work directly on the columns. Other const operations read a row
+    copy of the events that is kept until the list is next modified, and
+    sorting by other keys is written back to the columns, so const access
+    never changes the storage. Other modifying operations convert the list
+    back to row storage first.
+
+    Unweighted events can also be held in compact form (see CompactEvents),
+    which halves their memory. Besides the operations above, filtering,
+    splitting and histogramming by pulse time work on the compact events.
+
     @author Janik Zikovsky, SNS ORNL
     @date 4/02/2010
 */
@@ -104,7 +131,20 @@ public:
    * @param event :: TofEvent to add at the end of the list.
    * */
   inline void addEventQuickly(const Types::Event::TofEvent &event) {
-    this->events.emplace_back(event);
+    if (m_storageType == ROW_STORAGE) {
+      this->events.emplace_back(event);
+      this->order = UNSORTED;
+      return;
+    }
+    if (m_hasRowCopy)
+      this->dropRowCopy();
+    if (m_storageType == COLUMN_STORAGE) {
+      this->m_columns.push_back(event);
+    } else if (!this->m_compact.push_back(event)) {
+      // The pulse is not in the compact table, so go back to rows
+      this->ensureRowStorage();
+      this->events.emplace_back(event);
+    }
     this->order = UNSORTED;
   }
 
@@ -114,7 +154,13 @@ public:
    * @param event :: WeightedEvent to add at the end of the list.
    * */
   inline void addEventQuickly(const WeightedEvent &event) {
-    this->weightedEvents.emplace_back(event);
+    if (m_storageType == COLUMN_STORAGE) {
+      if (m_hasRowCopy)
+        this->dropRowCopy();
+      this->m_columns.push_back(event);
+    } else {
+      this->weightedEvents.emplace_back(event);
+    }
     this->order = UNSORTED;
   }
 
@@ -124,7 +170,13 @@ public:
    * @param event :: WeightedEventNoTime to add at the end of the list.
    * */
   inline void addEventQuickly(const WeightedEventNoTime &event) {
-    this->weightedEventsNoTime.emplace_back(event);
+    if (m_storageType == COLUMN_STORAGE) {
+      if (m_hasRowCopy)
+        this->dropRowCopy();
+      this->m_columns.push_back(event);
+    } else {
+      this->weightedEventsNoTime.emplace_back(event);
+    }
     this->order = UNSORTED;
   }
 
@@ -167,6 +219,12 @@ public:
 
   EventSortType getSortType() const;
 
+  EventStorageType getStorageType() const;
+
+  void setStorageType(
+      const EventStorageType storage,
+      const std::shared_ptr<const PulseTimeTable> &pulseTimes = nullptr);
+
   // X-vector accessors. These reset the MRU for this spectrum
   void setX(const Kernel::cow_ptr<HistogramData::HistogramX> &X) override;
   MantidVec &dataX() override;
@@ -377,6 +435,21 @@ private:
   /// List of WeightedEvent's
   mutable std::vector<WeightedEventNoTime> weightedEventsNoTime;
 
+  /// Columnar copy of the events, used instead of the vectors above when the
+  /// list is in COLUMN_STORAGE
+  mutable EventColumns m_columns;
+
+  /// Compact copy of the events, used instead of the vectors above when the
+  /// list is in COMPACT_STORAGE
+  mutable CompactEvents m_compact;
+
+  /// Where the events currently live
+  EventStorageType m_storageType{ROW_STORAGE};
+
+  /// True when the vectors above hold a copy of the column-stored or compact
+  /// events for const readers
+  mutable std::atomic<bool> m_hasRowCopy{false};
+
   /// What type of event is in our list.
   Mantid::API::EventType eventType;
 
@@ -412,6 +485,11 @@ private:
 
   void switchToWeightedEvents();
   void switchToWeightedEventsNoTime();
+  void ensureRowStorage();
+  void makeRowCopy() const;
+  void fillRowCopy() const;
+  void storeRowCopy() const;
+  void dropRowCopy();
   // should not be called externally
   void sortPulseTimeTOFDelta(const Types::Core::DateAndTime &start,
                              const double seconds) const;
@@ -435,10 +513,6 @@ private:
       const double seconds);
 
   template <class T>
-  static void histogramForWeightsHelper(const std::vector<T> &events,
-                                        const MantidVec &X, MantidVec &Y,
-                                        MantidVec &E);
-  template <class T>
   static void integrateHelper(std::vector<T> &events, const double minX,
                               const double maxX, const bool entireRange,
                               double &sum, double &error);
@@ -498,10 +572,16 @@ private:
   void splitByTimeHelper(Kernel::TimeSplitterType &splitter,
                          std::vector<EventList *> outputs,
                          typename std::vector<T> &events) const;
-  template <class T>
-  void splitByFullTimeHelper(Kernel::TimeSplitterType &splitter,
-                             std::map<int, EventList *> outputs,
-                             typename std::vector<T> &events, bool docorrection,
+  std::pair<std::vector<EventList *>, std::map<int, int>>
+  prepareSplitOutputs(const std::map<int, EventList *> &outputs) const;
+  void splitByFullTimeWith(const EventSplitter &splitter,
+                           const std::vector<EventList *> &outputs,
+                           bool docorrection, double toffactor,
+                           double tofshift) const;
+  template <class T>
+  void splitByFullTimeHelper(const EventSplitter &splitter,
+                             const std::vector<EventList *> &outputs,
+                             const std::vector<T> &events, bool docorrection,
                              double toffactor, double tofshift) const;
   /// Split events by pulse time
   template <class T>
@@ -517,18 +597,6 @@ private:
                                    std::map<int, EventList *> outputs,
                                    typename std::vector<T> &events) const;
 
-  template <class T>
-  std::string splitByFullTimeVectorSplitterHelper(
-      const std::vector<int64_t> &vectimes, const std::vector<int> &vecgroups,
-      std::map<int, EventList *> outputs, typename std::vector<T> &vecEvents,
-      bool docorrection, double toffactor, double tofshift) const;
-
-  template <class T>
-  std::string splitByFullTimeSparseVectorSplitterHelper(
-      const std::vector<int64_t> &vectimes, const std::vector<int> &vecgroups,
-      std::map<int, EventList *> outputs, typename std::vector<T> &vecEvents,
-      bool docorrection, double toffactor, double tofshift) const;
-
   template <class T>
   static void multiplyHelper(std::vector<T> &events, const double value,
                              const double error = 0.0);
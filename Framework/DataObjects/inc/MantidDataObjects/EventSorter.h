@@ -0,0 +1,95 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidDataObjects/Events.h"
+#include "MantidKernel/System.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Mantid {
+namespace DataObjects {
+struct CompactEvent;
+
+/**
+ * Calculate the corrected full time in nanoseconds
+ * @param event : The event with pulse time and time-of-flight
+ * @param tofFactor : Time of flight coefficient factor
+ * @param tofShift : Tof shift in seconds
+ * @return Corrected full time at sample in Nanoseconds.
+ */
+template <typename EventType>
+int64_t calculateCorrectedFullTime(const EventType &event,
+                                   const double tofFactor,
+                                   const double tofShift) {
+  return event.pulseTime().totalNanoseconds() +
+         static_cast<int64_t>(tofFactor * (event.tof() * 1.0E3) +
+                              (tofShift * 1.0E9));
+}
+
+/** EventSorter : sorts the events of a single list by time-of-flight, pulse
+  time, pulse time then time-of-flight or time at sample.
+
+  Small lists are sorted by comparison. Larger ones use a least significant
+  digit radix sort on the bytes of the key, skipping the bytes that are the
+  same for every event (typically the high bytes of the pulse times of a
+  run), so they take a few linear passes instead of O(n log n) comparisons.
+  Very large lists, such as monitors or hot pixels, are radix sorted by
+  several threads, each scattering its own block of events.
+
+  Every strategy is stable: events with equal keys keep the order they were
+  loaded in, and lists that are already in order are left untouched.
+
+  The radix sorts scatter the events into a scratch buffer as large as the
+  list, so a list takes twice its memory while it is sorted; std::stable_sort
+  also takes a buffer of up to the size of the list. When that buffer cannot
+  be allocated the list is sorted with std::stable_sort, which then merges in
+  place, more slowly, without extra memory.
+*/
+class DLLExport EventSorter {
+public:
+  /// How to sort
+  enum class Strategy { Automatic, Comparison, Radix, ParallelRadix };
+
+  static Strategy chooseStrategy(const size_t numEvents);
+
+  explicit EventSorter(const Strategy strategy = Strategy::Automatic)
+      : m_strategy(strategy) {}
+
+  void sortTof(std::vector<Types::Event::TofEvent> &events) const;
+  void sortTof(std::vector<WeightedEvent> &events) const;
+  void sortTof(std::vector<WeightedEventNoTime> &events) const;
+  void sortTof(std::vector<CompactEvent> &events) const;
+
+  void sortPulseTime(std::vector<Types::Event::TofEvent> &events) const;
+  void sortPulseTime(std::vector<WeightedEvent> &events) const;
+  void sortPulseTime(std::vector<CompactEvent> &events) const;
+
+  void sortPulseTimeTof(std::vector<Types::Event::TofEvent> &events) const;
+  void sortPulseTimeTof(std::vector<WeightedEvent> &events) const;
+
+  void sortTimeAtSample(std::vector<Types::Event::TofEvent> &events,
+                        const double tofFactor, const double tofShift) const;
+  void sortTimeAtSample(std::vector<WeightedEvent> &events,
+                        const double tofFactor, const double tofShift) const;
+  void sortTimeAtSample(std::vector<WeightedEventNoTime> &events,
+                        const double tofFactor, const double tofShift) const;
+
+private:
+  template <typename EventType, typename Key>
+  void sort(std::vector<EventType> &events, const Key &key) const;
+  template <typename EventType, typename First, typename Second>
+  void sortByTwoKeys(std::vector<EventType> &events, const First &first,
+                     const Second &second) const;
+
+  /// The strategy asked for
+  Strategy m_strategy;
+};
+
+} // namespace DataObjects
+} // namespace Mantid
@@ -0,0 +1,64 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidDataObjects/Events.h"
+#include "MantidKernel/System.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Mantid {
+namespace DataObjects {
+
+/** EventSplitter : splits the events of one list between several outputs by
+  the absolute time of each event (pulse time plus time-of-flight, possibly
+  corrected to the sample).
+
+  The splitters are a sorted vector of times, the interval [times[i],
+  times[i+1]) going to one of the outputs. The interval of each event is
+  found by galloping from the interval of the previous event, which is one
+  or two steps for events in time order and a binary search otherwise, so
+  the cost hardly depends on the number of splitters. The events going to
+  each output are counted first, every output is grown once to its final
+  size, then the events are copied into place. Large lists are handled by
+  several threads, each taking a block of events; the outputs keep the order
+  of the input either way.
+*/
+class DLLExport EventSplitter {
+public:
+  /// Destination of the events that are not kept
+  static constexpr int NO_OUTPUT = -1;
+
+  EventSplitter(std::vector<int64_t> times, std::vector<int> destinations,
+                const int outside);
+
+  /// Number of intervals
+  size_t numberOfIntervals() const { return m_destinations.size(); }
+
+  template <typename EventType>
+  void split(const std::vector<EventType> &events,
+             const std::vector<std::vector<EventType> *> &outputs,
+             const bool correct, const double tofFactor,
+             const double tofShift) const;
+
+  size_t findInterval(const int64_t time, const size_t hint) const;
+
+  /// Returned by findInterval for times outside all intervals
+  static constexpr size_t OUTSIDE = static_cast<size_t>(-1);
+
+private:
+  /// Boundaries of the intervals, increasing
+  std::vector<int64_t> m_times;
+  /// Output of each interval, or NO_OUTPUT
+  std::vector<int> m_destinations;
+  /// Output of the events outside all intervals, or NO_OUTPUT
+  int m_outside;
+};
+
+} // namespace DataObjects
+} // namespace Mantid
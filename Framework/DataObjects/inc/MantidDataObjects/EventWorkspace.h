@@ -142,6 +142,11 @@ public:
   // Change the event type
   void switchEventType(const Mantid::API::EventType type);
 
+  // Change how the events of every list are laid out in memory
+  void setStorageType(const EventStorageType storage);
+
+  EventStorageType getStorageType() const;
+
   // Returns true always - an EventWorkspace always represents histogramm-able
   // data
   bool isHistogramData() const override;
@@ -56,8 +56,11 @@ public:
 
   /*** this function tries to set file positions of the boxes to
         make data physically located close to each other to be as close as
-     possible on the HDD */
-  void setBoxesFilePositions(bool setFileBacked);
+     possible on the HDD. With mortonOrder, the boxes follow the Morton
+     (Z-order) curve through their centres rather than their IDs */
+  void setBoxesFilePositions(bool setFileBacked, bool mortonOrder = false);
+  /**Sort boxes along the Morton curve through their centres*/
+  void sortByMortonOrder(std::vector<API::IMDNode *> &boxes) const;
 
   /**Save flat box structure into a file, defined by the file name*/
   void saveBoxStructure(const std::string &fileName);
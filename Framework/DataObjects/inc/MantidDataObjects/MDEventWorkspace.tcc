@@ -20,6 +20,7 @@
 #include "MantidKernel/FunctionTask.h"
 #include "MantidKernel/Logger.h"
 #include "MantidKernel/Memory.h"
+#include "MantidKernel/MultiThreaded.h"
 #include "MantidKernel/ProgressBase.h"
 #include "MantidKernel/Task.h"
 #include "MantidKernel/ThreadPool.h"
@@ -32,6 +33,7 @@
 #include <functional>
 #include <iomanip>
 #include <ostream>
+#include <unordered_map>
 
 // Test for gcc 4.4
 #if __GNUC__ > 4 ||                                                            \
@@ -597,6 +599,146 @@ TMDE(size_t MDEventWorkspace)::addEvents(const std::vector<MDE> &events) {
   return data->addEvents(events);
 }
 
+//-----------------------------------------------------------------------------------------------
+/** Add a vector of MDEvents to the workspace, keeping its box structure.
+ *
+ * The events are sorted along the Morton (Z-order) curve through the extents
+ * of the workspace, so that consecutive events mostly go to the same box, and
+ * each is added to the leaf box holding it. Only the boxes given events are
+ * split if needed, and the signal, error and number of events are updated
+ * only for them and the boxes above them. The time taken thus grows with the
+ * number of events added rather than with the size of the workspace.
+ *
+ * @param events :: the events to add
+ * @return the number of events outside the workspace, which are not added
+ */
+TMDE(size_t MDEventWorkspace)::appendEvents(const std::vector<MDE> &events) {
+  if (events.empty())
+    return 0;
+
+  // Morton keys of the event centres, with the same number of bits in each
+  // dimension
+  const size_t bits = std::min<size_t>(21, 64 / nd);
+  const double cells = static_cast<double>(uint64_t{1} << bits);
+  double minimum[nd];
+  double scale[nd];
+  for (size_t d = 0; d < nd; ++d) {
+    const auto &extents = data->getExtents(d);
+    minimum[d] = extents.getMin();
+    const double width = extents.getSize();
+    scale[d] = width > 0 ? cells / width : 0.;
+  }
+  std::vector<std::pair<uint64_t, size_t>> order(events.size());
+  const auto numEvents = static_cast<int64_t>(events.size());
+  PARALLEL_FOR_NO_WSP_CHECK()
+  for (int64_t i = 0; i < numEvents; ++i) {
+    const MDE &event = events[i];
+    uint64_t cell[nd];
+    for (size_t d = 0; d < nd; ++d) {
+      const double scaled = (event.getCenter(d) - minimum[d]) * scale[d];
+      cell[d] =
+          static_cast<uint64_t>(std::min(std::max(scaled, 0.), cells - 1));
+    }
+    uint64_t key = 0;
+    for (size_t bit = bits; bit > 0; --bit)
+      for (size_t d = 0; d < nd; ++d)
+        key = (key << 1) | ((cell[d] >> (bit - 1)) & 1);
+    order[i] = {key, static_cast<size_t>(i)};
+  }
+  std::sort(order.begin(), order.end());
+
+  const auto isInside = [](const MDBoxBase<MDE, nd> *box, const MDE &event) {
+    for (size_t d = 0; d < nd; ++d)
+      if (box->getExtents(d).outside(event.getCenter(d)))
+        return false;
+    return true;
+  };
+  // The leaf box holding an event, or nullptr if it is outside the workspace
+  const auto findLeaf = [this, &isInside](const MDE &event) {
+    MDBoxBase<MDE, nd> *box = data.get();
+    if (!isInside(box, event))
+      return static_cast<MDBox<MDE, nd> *>(nullptr);
+    while (auto grid = dynamic_cast<MDGridBox<MDE, nd> *>(box)) {
+      const size_t numChildren = grid->getNumChildren();
+      size_t index = grid->calculateChildIndex(event);
+      // As in MDGridBox::addEvent, events on the upper boundary of the last
+      // child go to it
+      if (index == numChildren)
+        index = numChildren - 1;
+      if (index > numChildren)
+        return static_cast<MDBox<MDE, nd> *>(nullptr);
+      box = dynamic_cast<MDBoxBase<MDE, nd> *>(grid->getChild(index));
+    }
+    return dynamic_cast<MDBox<MDE, nd> *>(box);
+  };
+
+  /// What was added to one leaf box
+  struct Added {
+    MDBox<MDE, nd> *box;
+    size_t numEvents;
+    double signal;
+    double errorSquared;
+  };
+  std::vector<Added> added;
+  std::unordered_map<MDBox<MDE, nd> *, size_t> addedIndex;
+  size_t numBad = 0;
+  MDBox<MDE, nd> *leaf = nullptr;
+  Added *current = nullptr;
+  for (const auto &entry : order) {
+    const MDE &event = events[entry.second];
+    if (!leaf || !isInside(leaf, event)) {
+      leaf = findLeaf(event);
+      if (!leaf) {
+        ++numBad;
+        continue;
+      }
+      const auto found = addedIndex.emplace(leaf, added.size());
+      if (found.second)
+        added.push_back({leaf, 0, 0., 0.});
+      current = &added[found.first->second];
+    }
+    leaf->addEventUnsafe(event);
+    ++current->numEvents;
+    current->signal += event.getSignal();
+    current->errorSquared += event.getErrorSquared();
+  }
+
+  for (const auto &entry : added) {
+    MDBox<MDE, nd> *box = entry.box;
+    // Add what changed to the boxes above
+    for (auto parent = box->getParent(); parent; parent = parent->getParent()) {
+      auto grid = dynamic_cast<MDGridBox<MDE, nd> *>(parent);
+      if (!grid)
+        break;
+      grid->setNPoints(grid->getNPoints() + entry.numEvents);
+      grid->setSignal(grid->getSignal() + entry.signal);
+      grid->setErrorSquared(grid->getErrorSquared() + entry.errorSquared);
+      grid->setTotalWeight(grid->getTotalWeight() +
+                           static_cast<double>(entry.numEvents));
+    }
+
+    auto parent = dynamic_cast<MDGridBox<MDE, nd> *>(box->getParent());
+    if (parent && m_BoxController->willSplit(box->getNPoints(),
+                                              box->getDepth())) {
+      const size_t index = parent->getChildIndexFromID(box->getID());
+      parent->splitContents(index, nullptr);
+      parent->getChild(index)->refreshCache();
+    } else if (!parent && m_BoxController->willSplit(box->getNPoints(),
+                                                     box->getDepth())) {
+      // The top box itself was a leaf
+      this->splitBox();
+      data->splitAllIfNeeded(nullptr);
+      data->refreshCache();
+    } else {
+      box->refreshCache();
+    }
+  }
+
+  if (!added.empty())
+    this->setFileNeedsUpdating(true);
+  return numBad;
+}
+
 //-----------------------------------------------------------------------------------------------
 /** Split the contained MDBox into a MDGridBox or MDSplitBox, if it is not
  * that already.
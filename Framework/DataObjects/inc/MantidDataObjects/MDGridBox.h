@@ -112,6 +112,8 @@ public:
   bool isBox() const override { return false; }
 
   size_t getChildIndexFromID(size_t childId) const;
+  /// Compute the index of the child box for the given event
+  size_t calculateChildIndex(const MDE &event) const;
   API::IMDNode *getChild(size_t index) override;
   void setChild(size_t index, MDGridBox<MDE, nd> *newChild);
 
@@ -222,9 +224,6 @@ public:
   using boxVector_t = std::vector<MDBoxBase<MDE, nd> *>;
 
 private:
-  /// Compute the index of the child box for the given event
-  size_t calculateChildIndex(const MDE &event) const;
-
   /// Each dimension is split into this many equally-sized boxes
   size_t split[nd];
   /** Cumulative dimension splitting: split[n] = 1*split[0]*split[..]*split[n-1]
@@ -0,0 +1,127 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidDataObjects/DllConfig.h"
+#include "MantidGeometry/MDGeometry/MDTypes.h"
+
+#include <string>
+#include <vector>
+
+namespace Mantid {
+namespace DataObjects {
+
+class MDHistoWorkspace;
+
+/** MDHistoOperationChain : a chain of element-by-element operations on the
+  signal, error and number of events of an MDHistoWorkspace, evaluated in a
+  single pass over the workspace.
+
+  The operations are those of MDHistoWorkspace, with the same error
+  propagation. Instead of running each operation over the whole workspace,
+  the workspace is split into blocks small enough to stay in the cache of a
+  core; the blocks are shared out between threads and every operation of the
+  chain is run on a block before moving to the next one. No intermediate
+  workspace is created.
+
+  For example, the normalized difference (a - b) / c * 2 is:
+
+    MDHistoOperationChain().subtract(b).divide(c).multiply(2., 0.).applyTo(a);
+
+  The workspaces given as operands must outlive the chain and have the same
+  number of bins as the workspace the chain is applied to.
+*/
+class MANTID_DATAOBJECTS_DLL MDHistoOperationChain {
+public:
+  /// Number of bins processed together by all operations of the chain
+  static constexpr size_t BLOCK_SIZE = 4096;
+
+  MDHistoOperationChain &add(const MDHistoWorkspace &b);
+  MDHistoOperationChain &add(const signal_t signal, const signal_t error);
+  MDHistoOperationChain &subtract(const MDHistoWorkspace &b);
+  MDHistoOperationChain &subtract(const signal_t signal, const signal_t error);
+  MDHistoOperationChain &multiply(const MDHistoWorkspace &b);
+  MDHistoOperationChain &multiply(const signal_t signal, const signal_t error);
+  MDHistoOperationChain &divide(const MDHistoWorkspace &b);
+  MDHistoOperationChain &divide(const signal_t signal, const signal_t error);
+
+  MDHistoOperationChain &log(const double filler = 0.0);
+  MDHistoOperationChain &log10(const double filler = 0.0);
+  MDHistoOperationChain &exp();
+  MDHistoOperationChain &power(const double exponent);
+
+  MDHistoOperationChain &operatorAnd(const MDHistoWorkspace &b);
+  MDHistoOperationChain &operatorOr(const MDHistoWorkspace &b);
+  MDHistoOperationChain &operatorXor(const MDHistoWorkspace &b);
+  MDHistoOperationChain &operatorNot();
+
+  MDHistoOperationChain &lessThan(const MDHistoWorkspace &b);
+  MDHistoOperationChain &lessThan(const signal_t signal);
+  MDHistoOperationChain &greaterThan(const MDHistoWorkspace &b);
+  MDHistoOperationChain &greaterThan(const signal_t signal);
+  MDHistoOperationChain &equalTo(const MDHistoWorkspace &b,
+                                 const signal_t tolerance = 1e-5);
+  MDHistoOperationChain &equalTo(const signal_t signal,
+                                 const signal_t tolerance = 1e-5);
+
+  void applyTo(MDHistoWorkspace &ws) const;
+
+  /// @return the number of operations in the chain
+  size_t size() const { return m_steps.size(); }
+
+private:
+  enum class Operation {
+    AddWorkspace,
+    AddScalar,
+    SubtractWorkspace,
+    SubtractScalar,
+    MultiplyWorkspace,
+    MultiplyScalar,
+    DivideWorkspace,
+    DivideScalar,
+    Log,
+    Log10,
+    Exp,
+    Power,
+    And,
+    Or,
+    Xor,
+    Not,
+    LessThanWorkspace,
+    LessThanScalar,
+    GreaterThanWorkspace,
+    GreaterThanScalar,
+    EqualToWorkspace,
+    EqualToScalar
+  };
+  /// One operation of the chain
+  struct Step {
+    Operation operation;
+    /// the workspace on the right hand side, if any
+    const MDHistoWorkspace *operand;
+    /// the scalar signal, filler or exponent, if any
+    signal_t value;
+    /// the squared error of the scalar
+    signal_t errorSquared;
+    /// the tolerance of an equality
+    signal_t tolerance;
+  };
+
+  MDHistoOperationChain &addStep(const Operation operation,
+                                 const MDHistoWorkspace *operand,
+                                 const signal_t value = 0.,
+                                 const signal_t errorSquared = 0.,
+                                 const signal_t tolerance = 0.);
+  static std::string name(const Operation operation);
+  static void applyStep(const Step &step, MDHistoWorkspace &ws,
+                        const size_t begin, const size_t end);
+
+  std::vector<Step> m_steps;
+};
+
+} // namespace DataObjects
+} // namespace Mantid
@@ -447,6 +447,9 @@ public:
   bool isMDHistoWorkspace() const override { return true; }
 
 private:
+  /// Applies element-by-element operations to the arrays of the workspace
+  friend class MDHistoOperationChain;
+
   MDHistoWorkspace *doClone() const override {
     return new MDHistoWorkspace(*this);
   }
@@ -0,0 +1,773 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidDataObjects/BoxControllerCompressedIO.h"
+
+#include "MantidAPI/FileFinder.h"
+#include "MantidDataObjects/MDBoxFlatTree.h"
+#include "MantidDataObjects/MDEvent.h"
+#include "MantidKernel/ConfigService.h"
+#include "MantidKernel/Exception.h"
+#include "MantidKernel/Logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include <zlib.h>
+
+namespace Mantid {
+namespace DataObjects {
+
+namespace {
+/// static logger
+Kernel::Logger g_log("BoxControllerCompressedIO");
+/// The version of the group of compressed events
+const std::string EVENTS_VERSION("1.0");
+/// Name of the byte array holding the compressed blocks
+const std::string BYTES_DATA_NAME("event_blocks");
+/// Name of the block index
+const std::string INDEX_DATA_NAME("block_index");
+/// Name of the free space blocks of the DiskBuffer
+const std::string FREE_SPACE_DATA_NAME("free_space_blocks");
+/// Number of values in a row of the block index: position, number of events,
+/// offset, size and capacity of the bytes
+constexpr int64_t INDEX_COLUMNS = 5;
+/// Number of bytes in a chunk of the byte array in the file
+constexpr int64_t BYTES_CHUNK = 1 << 16;
+/// Description of the values of each event
+const char *EVENT_HEADERS[] = {
+    "signal, errorSquared, center (each dim.)",
+    "signal, errorSquared, runIndex, detectorId, center (each dim.)"};
+
+/// The unsigned integer with the bits of a float or a double
+template <typename Type> struct BitsOf;
+template <> struct BitsOf<float> { using type = uint32_t; };
+template <> struct BitsOf<double> { using type = uint64_t; };
+
+/** Compress events stored one after the other
+ * @param data :: the values of the events
+ * @param nEvents :: the number of events
+ * @param nColumns :: the number of values of each event
+ * @return the compressed bytes
+ */
+template <typename Type>
+std::vector<uint8_t> compressColumns(const Type *data, const size_t nEvents,
+                                     const size_t nColumns) {
+  using Bits = typename BitsOf<Type>::type;
+  constexpr size_t width = sizeof(Bits);
+  const size_t nValues = nEvents * nColumns;
+
+  // XOR with the previous event, column by column, with the n-th bytes of all
+  // the values together
+  std::vector<uint8_t> shuffled(nValues * width);
+  size_t k = 0;
+  for (size_t column = 0; column < nColumns; ++column) {
+    Bits previous = 0;
+    for (size_t event = 0; event < nEvents; ++event, ++k) {
+      Bits bits;
+      std::memcpy(&bits, data + event * nColumns + column, width);
+      const Bits delta = bits ^ previous;
+      previous = bits;
+      for (size_t byte = 0; byte < width; ++byte)
+        shuffled[byte * nValues + k] =
+            static_cast<uint8_t>(delta >> (8 * byte));
+    }
+  }
+
+  auto size = compressBound(static_cast<uLong>(shuffled.size()));
+  std::vector<uint8_t> bytes(size);
+  if (compress2(bytes.data(), &size, shuffled.data(),
+                static_cast<uLong>(shuffled.size()), Z_BEST_SPEED) != Z_OK)
+    throw std::runtime_error("Failed to compress a block of MD events");
+  bytes.resize(size);
+  return bytes;
+}
+
+/** Decompress events compressed by compressColumns
+ * @param bytes :: the compressed bytes
+ * @param nBytes :: the number of compressed bytes
+ * @param nEvents :: the number of events
+ * @param nColumns :: the number of values of each event
+ * @param data :: [out] the values of the events
+ */
+template <typename Type>
+void decompressColumns(const uint8_t *bytes, const size_t nBytes,
+                       const size_t nEvents, const size_t nColumns,
+                       Type *data) {
+  using Bits = typename BitsOf<Type>::type;
+  constexpr size_t width = sizeof(Bits);
+  const size_t nValues = nEvents * nColumns;
+
+  std::vector<uint8_t> shuffled(nValues * width);
+  auto size = static_cast<uLongf>(shuffled.size());
+  if (uncompress(shuffled.data(), &size, bytes, static_cast<uLong>(nBytes)) !=
+          Z_OK ||
+      size != shuffled.size())
+    throw std::runtime_error("Failed to decompress a block of MD events");
+
+  size_t k = 0;
+  for (size_t column = 0; column < nColumns; ++column) {
+    Bits previous = 0;
+    for (size_t event = 0; event < nEvents; ++event, ++k) {
+      Bits delta = 0;
+      for (size_t byte = 0; byte < width; ++byte)
+        delta |= static_cast<Bits>(shuffled[byte * nValues + k]) << (8 * byte);
+      previous ^= delta;
+      std::memcpy(data + event * nColumns + column, &previous, width);
+    }
+  }
+}
+} // namespace
+
+const std::string BoxControllerCompressedIO::EVENT_GROUP_NAME(
+    "compressed_event_data");
+
+/** Constructor
+ * @param bc :: the box controller using this IO
+ */
+BoxControllerCompressedIO::BoxControllerCompressedIO(
+    API::BoxController *const bc)
+    : m_File(nullptr), m_ReadOnly(true), m_bc(bc),
+      m_CoordSize(sizeof(coord_t)), m_fileCoordSize(sizeof(coord_t)),
+      m_EventsTypesSupported{MDLeanEvent<1>::getTypeName(),
+                             MDEvent<1>::getTypeName()},
+      m_EventType(1), m_nColumns(4 + bc->getNDims()), m_bytesLength(0),
+      m_indexRows(0), m_readAheadOffset(0) {}
+
+BoxControllerCompressedIO::~BoxControllerCompressedIO() {
+  try {
+    this->closeFile();
+  } catch (const std::exception &e) {
+    g_log.error() << "Failed to close " << m_fileName << ": " << e.what()
+                  << '\n';
+  }
+}
+
+/** Set the type of the events and the size of their coordinates
+ * @param blockSize :: size (in bytes) of the coordinates, 4 or 8
+ * @param typeName :: the name of the event type
+ */
+void BoxControllerCompressedIO::setDataType(const size_t blockSize,
+                                            const std::string &typeName) {
+  if (blockSize != 4 && blockSize != 8)
+    throw std::invalid_argument("The class currently supports 4(float) and "
+                                "8(double) event coordinates only");
+  const auto type = std::find(m_EventsTypesSupported.cbegin(),
+                              m_EventsTypesSupported.cend(), typeName);
+  if (type == m_EventsTypesSupported.cend())
+    throw std::invalid_argument("Unsupported event type: " + typeName +
+                                " provided ");
+
+  m_CoordSize = static_cast<unsigned int>(blockSize);
+  m_EventType = static_cast<size_t>(
+      std::distance(m_EventsTypesSupported.cbegin(), type));
+  m_nColumns = (m_EventType == 0 ? 2 : 4) + m_bc->getNDims();
+}
+
+/** Get the type of the events and the size of their coordinates
+ * @param CoordSize :: [out] size (in bytes) of the coordinates
+ * @param typeName :: [out] the name of the event type
+ */
+void BoxControllerCompressedIO::getDataType(size_t &CoordSize,
+                                            std::string &typeName) const {
+  CoordSize = m_CoordSize;
+  typeName = m_EventsTypesSupported[m_EventType];
+}
+
+/** Open the file to use in IO operations with events
+ * @param fileName :: the name of the file to open. Searched for within the
+ * Mantid search path.
+ * @param mode :: opening mode, read/write if it contains w or W, read
+ * otherwise
+ * @return false if the file was already opened
+ */
+bool BoxControllerCompressedIO::openFile(const std::string &fileName,
+                                         const std::string &mode) {
+  if (m_File)
+    return false;
+
+  std::lock_guard<std::mutex> lock(m_fileMutex);
+  m_ReadOnly = mode.find('w') == std::string::npos &&
+               mode.find('W') == std::string::npos;
+
+  m_fileName = API::FileFinder::Instance().getFullPath(fileName);
+  if (m_fileName.empty()) {
+    if (m_ReadOnly)
+      throw Kernel::Exception::FileError("Can not open file to read ",
+                                         m_fileName);
+    const std::string filePath =
+        Kernel::ConfigService::Instance().getString("defaultsave.directory");
+    m_fileName = filePath.empty() ? fileName : filePath + "/" + fileName;
+  }
+
+  auto nDims = static_cast<int>(m_bc->getNDims());
+  bool groupExists;
+  m_File.reset(MDBoxFlatTree::createOrOpenMDWSgroup(
+      m_fileName, nDims, m_EventsTypesSupported[m_EventType], m_ReadOnly,
+      groupExists));
+
+  m_blocks.clear();
+  m_bytesLength = 0;
+  m_freeBytes.clear();
+  m_indexRows = 0;
+  m_readAhead.clear();
+  std::map<std::string, std::string> groupEntries;
+  m_File->getEntries(groupEntries);
+  if (groupEntries.find(EVENT_GROUP_NAME) != groupEntries.end())
+    openEventGroup();
+  else
+    createEventGroup();
+
+  m_File->openData(BYTES_DATA_NAME);
+  return true;
+}
+
+/// Create the group of the compressed events, with an empty index
+void BoxControllerCompressedIO::createEventGroup() {
+  if (m_ReadOnly)
+    throw Kernel::Exception::FileError("The NXdata group: " + EVENT_GROUP_NAME +
+                                           " does not exist in the file "
+                                           "opened for read",
+                                       m_fileName);
+
+  m_File->makeGroup(EVENT_GROUP_NAME, "NXdata", true);
+  m_File->putAttr("version", EVENTS_VERSION);
+  m_File->putAttr("description", std::string(EVENT_HEADERS[m_EventType]));
+  m_File->putAttr("coordinate_size", static_cast<int>(m_CoordSize));
+  m_File->putAttr("compression",
+                  std::string("xor-delta, byte-shuffle, zlib"));
+  m_fileCoordSize = m_CoordSize;
+
+  const std::vector<int64_t> bytesDims{NX_UNLIMITED};
+  const std::vector<int64_t> bytesChunk{BYTES_CHUNK};
+  m_File->makeCompData(BYTES_DATA_NAME, ::NeXus::UINT8, bytesDims,
+                       ::NeXus::NONE, bytesChunk);
+
+  // The NeXus API does not tell an empty array from an array of one row, so
+  // the arrays start with an unused row of zeros
+  std::vector<uint64_t> index(INDEX_COLUMNS, 0);
+  std::vector<int64_t> indexDims{1, INDEX_COLUMNS};
+  std::vector<int64_t> indexChunk{16384, INDEX_COLUMNS};
+  m_File->writeExtendibleData(INDEX_DATA_NAME, index, indexDims, indexChunk);
+  m_indexRows = 1;
+
+  std::vector<uint64_t> freeSpace(2, 0);
+  std::vector<int64_t> freeDims{1, 2};
+  std::vector<int64_t> freeChunk{static_cast<int64_t>(DATA_CHUNK), 2};
+  m_File->writeExtendibleData(FREE_SPACE_DATA_NAME, freeSpace, freeDims,
+                              freeChunk);
+  this->setFileLength(0);
+}
+
+/// Open the group of the compressed events and read its index
+void BoxControllerCompressedIO::openEventGroup() {
+  m_File->openGroup(EVENT_GROUP_NAME, "NXdata");
+  std::string version;
+  m_File->getAttr("version", version);
+  if (version != EVENTS_VERSION)
+    throw Kernel::Exception::FileError(
+        "Unsupported version of compressed MD events: " + version,
+        m_fileName);
+  int coordSize;
+  m_File->getAttr("coordinate_size", coordSize);
+  m_fileCoordSize = static_cast<unsigned int>(coordSize);
+
+  std::vector<uint64_t> index;
+  m_File->readData(INDEX_DATA_NAME, index);
+  m_indexRows = index.size() / INDEX_COLUMNS;
+  uint64_t fileLength = 0;
+  for (size_t row = 0; row < m_indexRows; ++row) {
+    const uint64_t *values = index.data() + row * INDEX_COLUMNS;
+    // Rows of zero events are padding
+    if (values[1] == 0)
+      continue;
+    m_blocks[values[0]] = {values[1], values[2], values[3], values[4]};
+    m_bytesLength = std::max(m_bytesLength, values[2] + values[4]);
+    fileLength = std::max(fileLength, values[0] + values[1]);
+  }
+  this->setFileLength(fileLength);
+
+  // The gaps between the bytes of the blocks are free
+  std::map<uint64_t, uint64_t> used;
+  for (const auto &block : m_blocks)
+    used[block.second.offset] = block.second.capacity;
+  uint64_t end = 0;
+  for (const auto &range : used) {
+    if (range.first > end)
+      m_freeBytes[end] = range.first - end;
+    end = std::max(end, range.first + range.second);
+  }
+
+  std::vector<uint64_t> freeSpace;
+  m_File->readData(FREE_SPACE_DATA_NAME, freeSpace);
+  this->setFreeSpaceVector(freeSpace);
+}
+
+/// Write the block index to the file. Must be called under the file lock.
+void BoxControllerCompressedIO::writeIndex() const {
+  std::vector<uint64_t> index;
+  index.reserve((m_blocks.size() + 1) * INDEX_COLUMNS);
+  for (const auto &block : m_blocks) {
+    const auto &entry = block.second;
+    index.insert(index.end(), {block.first, entry.nEvents, entry.offset,
+                               entry.size, entry.capacity});
+  }
+  // Pad with rows of zero events to overwrite all the rows already written
+  const auto rows = std::max<uint64_t>(
+      std::max<uint64_t>(m_blocks.size(), m_indexRows), 1);
+  index.resize(rows * INDEX_COLUMNS, 0);
+  std::vector<int64_t> dims{static_cast<int64_t>(rows), INDEX_COLUMNS};
+
+  m_File->closeData();
+  m_File->writeUpdatedData(INDEX_DATA_NAME, index, dims);
+  m_File->openData(BYTES_DATA_NAME);
+  m_indexRows = rows;
+}
+
+/** Add a range of the byte array to the free list, joining it to the free
+ * ranges next to it. A free range at the end of the array shortens it. Must
+ * be called under the file lock.
+ * @param offset :: the first byte of the range
+ * @param size :: the number of bytes of the range
+ */
+void BoxControllerCompressedIO::releaseBytes(const uint64_t offset,
+                                             const uint64_t size) const {
+  if (size == 0)
+    return;
+  auto range = m_freeBytes.emplace(offset, size).first;
+  if (range != m_freeBytes.begin()) {
+    auto before = std::prev(range);
+    if (before->first + before->second == range->first) {
+      before->second += range->second;
+      m_freeBytes.erase(range);
+      range = before;
+    }
+  }
+  auto after = std::next(range);
+  if (after != m_freeBytes.end() &&
+      range->first + range->second == after->first) {
+    range->second += after->second;
+    m_freeBytes.erase(after);
+  }
+  if (range->first + range->second == m_bytesLength) {
+    m_bytesLength = range->first;
+    m_freeBytes.erase(range);
+  }
+}
+
+/** Find room for bytes in the byte array: the smallest free range that holds
+ * them, else the end of the array. Must be called under the file lock.
+ * @param size :: the number of bytes
+ * @return the offset of the room
+ */
+uint64_t BoxControllerCompressedIO::allocateBytes(const uint64_t size) const {
+  auto best = m_freeBytes.end();
+  for (auto range = m_freeBytes.begin(); range != m_freeBytes.end(); ++range) {
+    if (range->second >= size &&
+        (best == m_freeBytes.end() || range->second < best->second))
+      best = range;
+  }
+  if (best == m_freeBytes.end()) {
+    const uint64_t offset = m_bytesLength;
+    m_bytesLength += size;
+    return offset;
+  }
+  const uint64_t offset = best->first;
+  const uint64_t left = best->second - size;
+  m_freeBytes.erase(best);
+  if (left > 0)
+    m_freeBytes.emplace(offset + size, left);
+  return offset;
+}
+
+/// Write the free space blocks of the DiskBuffer to the file
+void BoxControllerCompressedIO::writeFreeSpace() {
+  std::vector<uint64_t> freeSpace;
+  this->getFreeSpaceVector(freeSpace);
+  if (freeSpace.empty())
+    return;
+  std::vector<int64_t> dims{static_cast<int64_t>(freeSpace.size() / 2), 2};
+  m_File->closeData();
+  m_File->writeUpdatedData(FREE_SPACE_DATA_NAME, freeSpace, dims);
+  m_File->openData(BYTES_DATA_NAME);
+}
+
+/** Get the bytes of a block. If they are not among the bytes last read ahead,
+ * read them together with the bytes of the following blocks that are next to
+ * them in the file. Must be called under the file lock.
+ * @param block :: the block
+ * @return the bytes of the block
+ */
+std::vector<uint8_t> BoxControllerCompressedIO::readBytes(
+    BlockMap::const_iterator block) const {
+  const auto &entry = block->second;
+  const bool readAhead =
+      entry.offset >= m_readAheadOffset &&
+      entry.offset + entry.size <= m_readAheadOffset + m_readAhead.size();
+  if (!readAhead) {
+    uint64_t end = entry.offset + entry.size;
+    uint64_t next = entry.offset + entry.capacity;
+    for (auto following = std::next(block); following != m_blocks.cend();
+         ++following) {
+      const auto &followingEntry = following->second;
+      if (followingEntry.offset != next ||
+          followingEntry.offset + followingEntry.size - entry.offset >
+              READ_AHEAD_BYTES)
+        break;
+      end = followingEntry.offset + followingEntry.size;
+      next = followingEntry.offset + followingEntry.capacity;
+    }
+    m_readAheadOffset = entry.offset;
+    m_readAhead.resize(end - entry.offset);
+    const std::vector<int64_t> start{static_cast<int64_t>(entry.offset)};
+    const std::vector<int64_t> size{static_cast<int64_t>(m_readAhead.size())};
+    m_File->getSlab(m_readAhead.data(), start, size);
+    this->recordRead(m_readAhead.size());
+  }
+  const auto first = m_readAhead.cbegin() + (entry.offset - m_readAheadOffset);
+  return std::vector<uint8_t>(first, first + entry.size);
+}
+
+/** Write bytes to the byte array. Must be called under the file lock.
+ * @param bytes :: the bytes
+ * @param offset :: where to write them
+ */
+void BoxControllerCompressedIO::writeBytes(std::vector<uint8_t> &bytes,
+                                           const uint64_t offset) const {
+  std::vector<int64_t> start{static_cast<int64_t>(offset)};
+  std::vector<int64_t> size{static_cast<int64_t>(bytes.size())};
+  m_File->putSlab(bytes, start, size);
+  this->recordWrite(bytes.size());
+  // Forget what was read ahead if it is overwritten
+  if (offset < m_readAheadOffset + m_readAhead.size() &&
+      offset + bytes.size() > m_readAheadOffset)
+    m_readAhead.clear();
+}
+
+/** Compress and save a block of events
+ * @param DataBlock :: the values of the events
+ * @param blockPosition :: the position of the first event
+ */
+template <typename Type>
+void BoxControllerCompressedIO::saveGenericBlock(
+    const std::vector<Type> &DataBlock, const uint64_t blockPosition) const {
+  if (m_ReadOnly)
+    throw Kernel::Exception::FileError(
+        "Attempt to write events to a file opened for reading", m_fileName);
+  const uint64_t nEvents = DataBlock.size() / m_nColumns;
+  if (nEvents == 0)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(m_fileMutex);
+    if (blockPosition + nEvents > this->getFileLength())
+      this->setFileLength(blockPosition + nEvents);
+  }
+  if (!this->hasBackgroundIO()) {
+    writeGenericBlock(DataBlock, blockPosition);
+    return;
+  }
+  // Compress and write behind the caller, from a copy of the events
+  auto block = std::make_shared<std::vector<Type>>(DataBlock);
+  this->runInBackground(blockPosition, nEvents, true,
+                        [this, block, blockPosition] {
+                          writeGenericBlock(*block, blockPosition);
+                        });
+}
+
+/** Compress and write a block of events
+ * @param DataBlock :: the values of the events
+ * @param blockPosition :: the position of the first event
+ */
+template <typename Type>
+void BoxControllerCompressedIO::writeGenericBlock(
+    const std::vector<Type> &DataBlock, const uint64_t blockPosition) const {
+  const uint64_t nEvents = DataBlock.size() / m_nColumns;
+  // Compress outside of the lock, so that threads saving boxes compress them
+  // at the same time
+  std::vector<uint8_t> bytes;
+  if (sizeof(Type) == m_fileCoordSize) {
+    bytes = compressBlock(DataBlock, m_nColumns);
+  } else if (m_fileCoordSize == sizeof(float)) {
+    const std::vector<float> converted(DataBlock.cbegin(), DataBlock.cend());
+    bytes = compressBlock(converted, m_nColumns);
+  } else {
+    const std::vector<double> converted(DataBlock.cbegin(), DataBlock.cend());
+    bytes = compressBlock(converted, m_nColumns);
+  }
+
+  std::lock_guard<std::mutex> lock(m_fileMutex);
+  BlockEntry entry{nEvents, 0, bytes.size(), 0};
+  bool inPlace = false;
+
+  // The DiskBuffer only gives out free space, so the blocks overlapping the
+  // new one are no longer used. A block at the same position whose bytes have
+  // room for the new ones is overwritten, the others are freed.
+  auto overlapping = m_blocks.lower_bound(blockPosition);
+  if (overlapping != m_blocks.begin()) {
+    auto before = std::prev(overlapping);
+    if (before->first + before->second.nEvents > blockPosition)
+      overlapping = before;
+  }
+  while (overlapping != m_blocks.end() &&
+         overlapping->first < blockPosition + nEvents) {
+    const auto &previous = overlapping->second;
+    if (overlapping->first == blockPosition &&
+        previous.capacity >= bytes.size()) {
+      entry.offset = previous.offset;
+      entry.capacity = previous.capacity;
+      inPlace = true;
+    } else {
+      releaseBytes(previous.offset, previous.capacity);
+    }
+    overlapping = m_blocks.erase(overlapping);
+  }
+
+  if (!inPlace) {
+    entry.offset = allocateBytes(bytes.size());
+    entry.capacity = bytes.size();
+  }
+  m_blocks[blockPosition] = entry;
+  writeBytes(bytes, entry.offset);
+}
+
+/** Decompress a block into the type stored in the file, then the type asked
+ * for
+ * @param bytes :: the compressed bytes
+ * @param nEvents :: the number of events of the block
+ * @param events :: [out] the values of the events
+ */
+template <typename Type>
+void BoxControllerCompressedIO::decodeBlock(const std::vector<uint8_t> &bytes,
+                                            const uint64_t nEvents,
+                                            std::vector<Type> &events) const {
+  events.resize(nEvents * m_nColumns);
+  if (sizeof(Type) == m_fileCoordSize) {
+    decompressBlock(bytes, m_nColumns, events);
+  } else if (m_fileCoordSize == sizeof(float)) {
+    std::vector<float> stored(events.size());
+    decompressBlock(bytes, m_nColumns, stored);
+    std::copy(stored.cbegin(), stored.cend(), events.begin());
+  } else {
+    std::vector<double> stored(events.size());
+    decompressBlock(bytes, m_nColumns, stored);
+    std::transform(stored.cbegin(), stored.cend(), events.begin(),
+                   [](const double value) { return static_cast<Type>(value); });
+  }
+}
+
+/** Load events, from any number of blocks
+ * @param Block :: [out] the values of the events
+ * @param blockPosition :: the position of the first event
+ * @param nPoints :: the number of events
+ */
+template <typename Type>
+void BoxControllerCompressedIO::loadGenericBlock(std::vector<Type> &Block,
+                                                 const uint64_t blockPosition,
+                                                 const size_t nPoints) const {
+  if (blockPosition + nPoints > this->getFileLength())
+    throw Kernel::Exception::FileError("Attemtp to read behind the file end",
+                                       m_fileName);
+  Block.resize(nPoints * m_nColumns);
+  if (nPoints == 0)
+    return;
+
+  // Copy the bytes under the lock and decompress them outside of it
+  std::vector<std::pair<uint64_t, uint64_t>> pieces;
+  std::vector<std::vector<uint8_t>> bytes;
+  {
+    std::lock_guard<std::mutex> lock(m_fileMutex);
+    auto block = m_blocks.upper_bound(blockPosition);
+    if (block != m_blocks.cbegin())
+      --block;
+    for (; block != m_blocks.cend() && block->first < blockPosition + nPoints;
+         ++block) {
+      if (block->first + block->second.nEvents <= blockPosition)
+        continue;
+      pieces.emplace_back(block->first, block->second.nEvents);
+      bytes.emplace_back(readBytes(block));
+    }
+  }
+
+  uint64_t next = blockPosition;
+  std::vector<Type> events;
+  for (size_t i = 0; i < pieces.size(); ++i) {
+    const uint64_t position = pieces[i].first;
+    const uint64_t nEvents = pieces[i].second;
+    if (position > next)
+      break;
+    decodeBlock(bytes[i], nEvents, events);
+    // Copy the events of the block within the range asked for
+    const uint64_t first = std::max(position, blockPosition);
+    const uint64_t last = std::min(position + nEvents, blockPosition + nPoints);
+    std::copy(events.cbegin() + (first - position) * m_nColumns,
+              events.cbegin() + (last - position) * m_nColumns,
+              Block.begin() + (first - blockPosition) * m_nColumns);
+    next = last;
+  }
+  if (next < blockPosition + nPoints)
+    throw Kernel::Exception::FileError(
+        "Events were read from a part of the file that was never written",
+        m_fileName);
+}
+
+/** Save a block of events with float values
+ * @param DataBlock :: the values of the events
+ * @param blockPosition :: the position of the first event
+ */
+void BoxControllerCompressedIO::saveBlock(const std::vector<float> &DataBlock,
+                                          const uint64_t blockPosition) const {
+  this->saveGenericBlock(DataBlock, blockPosition);
+}
+
+/** Save a block of events with double values
+ * @param DataBlock :: the values of the events
+ * @param blockPosition :: the position of the first event
+ */
+void BoxControllerCompressedIO::saveBlock(const std::vector<double> &DataBlock,
+                                          const uint64_t blockPosition) const {
+  this->saveGenericBlock(DataBlock, blockPosition);
+}
+
+/** Load events with float values
+ * @param Block :: [out] the values of the events
+ * @param blockPosition :: the position of the first event
+ * @param nPoints :: the number of events
+ */
+void BoxControllerCompressedIO::loadBlock(std::vector<float> &Block,
+                                          const uint64_t blockPosition,
+                                          const size_t nPoints) const {
+  if (!this->takePrefetched(Block, blockPosition, nPoints))
+    this->loadGenericBlock(Block, blockPosition, nPoints);
+}
+
+/** Load events with double values
+ * @param Block :: [out] the values of the events
+ * @param blockPosition :: the position of the first event
+ * @param nPoints :: the number of events
+ */
+void BoxControllerCompressedIO::loadBlock(std::vector<double> &Block,
+                                          const uint64_t blockPosition,
+                                          const size_t nPoints) const {
+  if (!this->takePrefetched(Block, blockPosition, nPoints))
+    this->loadGenericBlock(Block, blockPosition, nPoints);
+}
+
+/** Read ahead a block of events in the background
+ * @param blockPosition :: the position of the first event
+ * @param nPoints :: the number of events
+ */
+void BoxControllerCompressedIO::prefetchBlock(const uint64_t blockPosition,
+                                              const uint64_t nPoints) {
+  if (!m_File || blockPosition + nPoints > this->getFileLength())
+    return;
+  const auto read = [this, blockPosition, nPoints] {
+    const auto n = static_cast<size_t>(nPoints);
+    if (m_CoordSize == sizeof(float)) {
+      std::vector<float> block;
+      this->loadGenericBlock(block, blockPosition, n);
+      this->storePrefetched(blockPosition, nPoints, std::move(block));
+    } else {
+      std::vector<double> block;
+      this->loadGenericBlock(block, blockPosition, n);
+      this->storePrefetched(blockPosition, nPoints, std::move(block));
+    }
+  };
+  this->runInBackground(blockPosition, nPoints, false, read);
+}
+
+/// Write the block index and clear the NeXus internal cache, after the writes
+/// in the background, and wait until it is done
+void BoxControllerCompressedIO::flushData() const {
+  this->runInBackground(0, 0, true, [this] {
+    std::lock_guard<std::mutex> lock(m_fileMutex);
+    if (!m_ReadOnly)
+      writeIndex();
+    m_File->flush();
+  });
+  this->waitForIO();
+}
+
+/// Save the events still in the DiskBuffer, write the indexes and close the
+/// file
+void BoxControllerCompressedIO::closeFile() {
+  if (!m_File)
+    return;
+  this->flushCache();
+  // finish the reads and writes done in the background, rethrowing their error
+  this->waitForIO();
+  this->setBackgroundIO(false);
+  std::lock_guard<std::mutex> lock(m_fileMutex);
+  if (!m_ReadOnly) {
+    writeIndex();
+    writeFreeSpace();
+  }
+  m_File->closeData();  // close the compressed events
+  m_File->closeGroup(); // close events group
+  m_File->closeGroup(); // close workspace group
+  m_File->close();
+  m_File = nullptr;
+  m_readAhead.clear();
+  m_freeBytes.clear();
+}
+
+/// Number of bytes taken by the compressed events in the file
+uint64_t BoxControllerCompressedIO::getCompressedSize() const {
+  std::lock_guard<std::mutex> lock(m_fileMutex);
+  return m_bytesLength;
+}
+
+/** Compress a block of events
+ * @param block :: the values of the events, one event after the other
+ * @param nColumns :: the number of values of each event
+ * @return the compressed bytes
+ */
+std::vector<uint8_t>
+BoxControllerCompressedIO::compressBlock(const std::vector<float> &block,
+                                         const size_t nColumns) {
+  return compressColumns(block.data(), block.size() / nColumns, nColumns);
+}
+
+/** Compress a block of events
+ * @param block :: the values of the events, one event after the other
+ * @param nColumns :: the number of values of each event
+ * @return the compressed bytes
+ */
+std::vector<uint8_t>
+BoxControllerCompressedIO::compressBlock(const std::vector<double> &block,
+                                         const size_t nColumns) {
+  return compressColumns(block.data(), block.size() / nColumns, nColumns);
+}
+
+/** Decompress a block of events
+ * @param bytes :: the bytes given by compressBlock
+ * @param nColumns :: the number of values of each event
+ * @param block :: [out] the values of the events; must have the size of the
+ * block
+ */
+void BoxControllerCompressedIO::decompressBlock(
+    const std::vector<uint8_t> &bytes, const size_t nColumns,
+    std::vector<float> &block) {
+  decompressColumns(bytes.data(), bytes.size(), block.size() / nColumns,
+                    nColumns, block.data());
+}
+
+/** Decompress a block of events
+ * @param bytes :: the bytes given by compressBlock
+ * @param nColumns :: the number of values of each event
+ * @param block :: [out] the values of the events; must have the size of the
+ * block
+ */
+void BoxControllerCompressedIO::decompressBlock(
+    const std::vector<uint8_t> &bytes, const size_t nColumns,
+    std::vector<double> &block) {
+  decompressColumns(bytes.data(), bytes.size(), block.size() / nColumns,
+                    nColumns, block.data());
+}
+
+} // namespace DataObjects
+} // namespace Mantid
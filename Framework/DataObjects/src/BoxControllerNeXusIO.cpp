@@ -13,11 +13,18 @@
 #include "MantidDataObjects/MDEvent.h"
 #include "MantidKernel/ConfigService.h"
 #include "MantidKernel/Exception.h"
+#include "MantidKernel/Logger.h"
 
+#include <memory>
 #include <string>
 
 namespace Mantid {
 namespace DataObjects {
+namespace {
+/// static logger
+Kernel::Logger g_log("BoxControllerNeXusIO");
+} // namespace
+
 // Default headers(attributes) describing the contents of the data, written by
 // this class
 const char *EventHeaders[] = {
@@ -335,6 +342,32 @@ void BoxControllerNeXusIO::getDiskBufferFileData() {
 template <typename Type>
 void BoxControllerNeXusIO::saveGenericBlock(
     const std::vector<Type> &DataBlock, const uint64_t blockPosition) const {
+  const auto nEvents =
+      static_cast<uint64_t>(DataBlock.size() / this->getNDataColums());
+  {
+    std::lock_guard<std::mutex> _lock(m_fileMutex);
+    if (blockPosition + nEvents > this->getFileLength())
+      this->setFileLength(blockPosition + nEvents);
+  }
+  if (!this->hasBackgroundIO()) {
+    writeGenericBlock(DataBlock, blockPosition);
+    return;
+  }
+  // write behind the caller, from a copy of the data
+  auto block = std::make_shared<std::vector<Type>>(DataBlock);
+  this->runInBackground(blockPosition, nEvents, true,
+                        [this, block, blockPosition] {
+                          writeGenericBlock(*block, blockPosition);
+                        });
+}
+
+/** Write generic data block on specific position within properly opened NeXus
+ *data array
+ *@param DataBlock     -- the vector with data to write
+ *@param blockPosition -- The starting place to save data to   */
+template <typename Type>
+void BoxControllerNeXusIO::writeGenericBlock(
+    const std::vector<Type> &DataBlock, const uint64_t blockPosition) const {
   std::vector<int64_t> start(2, 0);
   // Specify the dimensions
   std::vector<int64_t> dims(m_BlockSize);
@@ -347,12 +380,8 @@ void BoxControllerNeXusIO::saveGenericBlock(
   // makes putSlab method non-constant
   auto &mData = const_cast<std::vector<Type> &>(DataBlock);
 
-  {
-    m_File->putSlab<Type>(mData, start, dims);
-
-    if (blockPosition + dims[0] > this->getFileLength())
-      this->setFileLength(blockPosition + dims[0]);
-  }
+  m_File->putSlab<Type>(mData, start, dims);
+  this->recordWrite(DataBlock.size() * sizeof(Type));
 }
 
 /** Save float data block on specific position within properly opened NeXus data
@@ -398,6 +427,7 @@ void BoxControllerNeXusIO::loadGenericBlock(std::vector<Type> &Block,
   Block.resize(size[0] * size[1]);
 
   m_File->getSlab(&Block[0], start, size);
+  this->recordRead(Block.size() * sizeof(Type));
 }
 
 /** Helper funcion which allows to convert one data fomat into another */
@@ -419,6 +449,18 @@ void convertFormats(const std::vector<FROM> &inData, std::vector<TO> &outData) {
 void BoxControllerNeXusIO::loadBlock(std::vector<float> &Block,
                                      const uint64_t blockPosition,
                                      const size_t nPoints) const {
+  if (!this->takePrefetched(Block, blockPosition, nPoints))
+    this->readBlock(Block, blockPosition, nPoints);
+}
+
+/** Read float data block from the opened NeXus file, converting it if needed
+ *@param Block         -- the storage vector to place data into
+ *@param blockPosition -- The starting place to read data from
+ *@param nPoints       -- number of data points (events) to read
+ */
+void BoxControllerNeXusIO::readBlock(std::vector<float> &Block,
+                                     const uint64_t blockPosition,
+                                     const size_t nPoints) const {
   std::vector<double> tmp;
   switch (m_ReadConversion) {
   case (noConversion):
@@ -444,6 +486,18 @@ void BoxControllerNeXusIO::loadBlock(std::vector<float> &Block,
 void BoxControllerNeXusIO::loadBlock(std::vector<double> &Block,
                                      const uint64_t blockPosition,
                                      const size_t nPoints) const {
+  if (!this->takePrefetched(Block, blockPosition, nPoints))
+    this->readBlock(Block, blockPosition, nPoints);
+}
+
+/** Read double data block from the opened NeXus file, converting it if needed
+ *@param Block         -- the storage vector to place data into
+ *@param blockPosition -- The starting place to read data from
+ *@param nPoints       -- number of data points (events) to read
+ */
+void BoxControllerNeXusIO::readBlock(std::vector<double> &Block,
+                                     const uint64_t blockPosition,
+                                     const size_t nPoints) const {
   std::vector<float> tmp;
   switch (m_ReadConversion) {
   case (noConversion):
@@ -462,16 +516,48 @@ void BoxControllerNeXusIO::loadBlock(std::vector<double> &Block,
 
 //-------------------------------------------------------------------------------------------------------------------------------------
 
-/// Clear NeXus internal cache
+/** Read ahead a block of events in the background, as coordinates of the
+ * size set by setDataType
+ *@param blockPosition -- The starting place to read data from
+ *@param nPoints       -- number of data points (events) to read
+ */
+void BoxControllerNeXusIO::prefetchBlock(const uint64_t blockPosition,
+                                         const uint64_t nPoints) {
+  if (!m_File || blockPosition + nPoints > this->getFileLength())
+    return;
+  const auto read = [this, blockPosition, nPoints] {
+    const auto n = static_cast<size_t>(nPoints);
+    if (m_CoordSize == sizeof(float)) {
+      std::vector<float> block;
+      this->readBlock(block, blockPosition, n);
+      this->storePrefetched(blockPosition, nPoints, std::move(block));
+    } else {
+      std::vector<double> block;
+      this->readBlock(block, blockPosition, n);
+      this->storePrefetched(blockPosition, nPoints, std::move(block));
+    }
+  };
+  this->runInBackground(blockPosition, nPoints, false, read);
+}
+
+/// Clear NeXus internal cache, after the writes in the background, and wait
+/// until it is done
 void BoxControllerNeXusIO::flushData() const {
-  std::lock_guard<std::mutex> _lock(m_fileMutex);
-  m_File->flush();
+  this->runInBackground(0, 0, true, [this] {
+    std::lock_guard<std::mutex> _lock(m_fileMutex);
+    m_File->flush();
+  });
+  this->waitForIO();
 }
 /** flush disk buffer data from memory and close underlying NeXus file*/
 void BoxControllerNeXusIO::closeFile() {
   if (m_File) {
     // write all file-backed data still stack in the data buffer into the file.
     this->flushCache();
+    // finish the reads and writes done in the background, rethrowing their
+    // error
+    this->waitForIO();
+    this->setBackgroundIO(false);
     // lock file
     std::lock_guard<std::mutex> _lock(m_fileMutex);
 
@@ -495,6 +581,13 @@ void BoxControllerNeXusIO::closeFile() {
   }
 }
 
-BoxControllerNeXusIO::~BoxControllerNeXusIO() { this->closeFile(); }
+BoxControllerNeXusIO::~BoxControllerNeXusIO() {
+  try {
+    this->closeFile();
+  } catch (const std::exception &e) {
+    g_log.error() << "Failed to close " << m_fileName << ": " << e.what()
+                  << '\n';
+  }
+}
 } // namespace DataObjects
 } // namespace Mantid
@@ -0,0 +1,393 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidDataObjects/CompactEvents.h"
+#include "MantidDataObjects/EventHistogrammer.h"
+#include "MantidDataObjects/EventSorter.h"
+
+#ifdef _MSC_VER
+// qualifier applied to function type has no meaning; ignored
+#pragma warning(disable : 4180)
+#endif
+#include "tbb/parallel_sort.h"
+#ifdef _MSC_VER
+#pragma warning(default : 4180)
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace Mantid {
+namespace DataObjects {
+using Types::Core::DateAndTime;
+using Types::Event::TofEvent;
+
+namespace {
+/// @return the index of time in the table, or the table size if not present
+size_t findPulse(const PulseTimeTable &table, const DateAndTime time) {
+  const auto it = std::lower_bound(table.cbegin(), table.cend(), time);
+  if (it == table.cend() || *it != time)
+    return table.size();
+  return static_cast<size_t>(std::distance(table.cbegin(), it));
+}
+} // namespace
+
+/** Make a table holding the pulse times of a list of events
+ * @param events :: events whose pulse times are needed
+ * @return the sorted, unique pulse times
+ */
+std::shared_ptr<const PulseTimeTable>
+CompactEvents::makePulseTimeTable(const std::vector<TofEvent> &events) {
+  PulseTimeTable times;
+  addPulseTimes(times, events);
+  return makePulseTimeTable(std::move(times));
+}
+
+/** Make a table from pulse times collected by addPulseTimes
+ * @param times :: pulse times in any order, with repeats
+ * @return the sorted, unique pulse times
+ */
+std::shared_ptr<const PulseTimeTable>
+CompactEvents::makePulseTimeTable(PulseTimeTable times) {
+  tbb::parallel_sort(times.begin(), times.end());
+  times.erase(std::unique(times.begin(), times.end()), times.end());
+  times.shrink_to_fit();
+  return std::make_shared<const PulseTimeTable>(std::move(times));
+}
+
+/** Collect the pulse times of a list of events, to make a table of the
+ * pulse times of several lists with a single sort
+ * @param times :: pulse times in any order, appended to
+ * @param events :: events whose pulse times are needed
+ */
+void CompactEvents::addPulseTimes(PulseTimeTable &times,
+                                  const std::vector<TofEvent> &events) {
+  // Consecutive events mostly come from the same pulse
+  for (const auto &event : events) {
+    const DateAndTime time = event.pulseTime();
+    if (times.empty() || times.back() != time)
+      times.emplace_back(time);
+  }
+}
+
+/** Fill from a vector of TofEvent
+ * @param events :: events to copy
+ * @param pulseTimes :: table holding the pulse time of every event
+ * @throws std::invalid_argument if a pulse time is missing from the table
+ */
+void CompactEvents::assign(const std::vector<TofEvent> &events,
+                           std::shared_ptr<const PulseTimeTable> pulseTimes) {
+  if (pulseTimes->size() > std::numeric_limits<uint32_t>::max())
+    throw std::invalid_argument(
+        "CompactEvents: too many pulse times for a 32-bit pulse index");
+
+  const auto &table = *pulseTimes;
+  std::vector<CompactEvent> compact(events.size());
+  // Consecutive events mostly come from the same pulse
+  size_t index = table.size();
+  for (size_t i = 0; i < events.size(); ++i) {
+    const auto time = events[i].pulseTime();
+    if (index == table.size() || table[index] != time) {
+      index = findPulse(table, time);
+      if (index == table.size())
+        throw std::invalid_argument(
+            "CompactEvents: pulse time of an event is not in the table");
+    }
+    compact[i].tof = static_cast<float>(events[i].tof());
+    compact[i].pulseIndex = static_cast<uint32_t>(index);
+  }
+  m_events.swap(compact);
+  m_pulseTimes = std::move(pulseTimes);
+}
+
+/** Rebuild a vector of TofEvent
+ * @param events :: output vector, replaced
+ */
+void CompactEvents::extract(std::vector<TofEvent> &events) const {
+  events.clear();
+  events.reserve(m_events.size());
+  for (const auto &event : m_events)
+    events.emplace_back(static_cast<double>(event.tof), pulseTime(event));
+}
+
+/** Append a TofEvent
+ * @param event :: the event to add
+ * @return false, leaving the events unchanged, if its pulse time is not in
+ * the table
+ */
+bool CompactEvents::push_back(const TofEvent &event) {
+  if (!m_pulseTimes)
+    return false;
+  const auto index = findPulse(*m_pulseTimes, event.pulseTime());
+  if (index == m_pulseTimes->size())
+    return false;
+  m_events.push_back(
+      {static_cast<float>(event.tof()), static_cast<uint32_t>(index)});
+  return true;
+}
+
+/// Remove all events, release their memory and let go of the table
+void CompactEvents::clear() {
+  std::vector<CompactEvent>().swap(m_events);
+  m_pulseTimes.reset();
+}
+
+/** Reserve space for events
+ * @param num :: number of events that will be held
+ */
+void CompactEvents::reserve(size_t num) { m_events.reserve(num); }
+
+/// @return the memory used by the events in bytes (using their capacity). The
+/// shared pulse time table is not included.
+size_t CompactEvents::getMemorySize() const {
+  return m_events.capacity() * sizeof(CompactEvent);
+}
+
+/// Sort by increasing time-of-flight
+void CompactEvents::sortTof() { EventSorter().sortTof(m_events); }
+
+/// Sort by increasing pulse time, which is the order of the pulse indices
+void CompactEvents::sortPulseTime() { EventSorter().sortPulseTime(m_events); }
+
+/// Reverse the order of the events
+void CompactEvents::reverse() {
+  std::reverse(m_events.begin(), m_events.end());
+}
+
+/** Convert the time of flight by tof'=tof*factor+offset
+ * @param factor :: The value to scale the time-of-flight by
+ * @param offset :: The value to shift the time-of-flight by
+ */
+void CompactEvents::convertTof(const double factor, const double offset) {
+  for (auto &event : m_events)
+    event.tof = static_cast<float>(static_cast<double>(event.tof) * factor +
+                                   offset);
+}
+
+/** Convert the time of flight by applying a function
+ * @param func :: The function taking the old time of flight
+ */
+void CompactEvents::convertTof(const std::function<double(double)> &func) {
+  for (auto &event : m_events)
+    event.tof = static_cast<float>(func(static_cast<double>(event.tof)));
+}
+
+/** Fill a vector with the times of flight
+ * @param tofs :: output vector, replaced
+ */
+void CompactEvents::getTofs(std::vector<double> &tofs) const {
+  tofs.resize(m_events.size());
+  std::transform(
+      m_events.cbegin(), m_events.cend(), tofs.begin(),
+      [](const CompactEvent &event) { return static_cast<double>(event.tof); });
+}
+
+/** Fill a vector with the pulse times
+ * @param times :: output vector, replaced
+ */
+void CompactEvents::getPulseTimes(std::vector<DateAndTime> &times) const {
+  times.resize(m_events.size());
+  std::transform(
+      m_events.cbegin(), m_events.cend(), times.begin(),
+      [this](const CompactEvent &event) { return pulseTime(event); });
+}
+
+/// @return the earliest pulse time, or DateAndTime::maximum() if empty
+DateAndTime CompactEvents::getPulseTimeMin() const {
+  if (m_events.empty())
+    return DateAndTime::maximum();
+  return pulseTime(*std::min_element(
+      m_events.cbegin(), m_events.cend(),
+      [](const CompactEvent &a, const CompactEvent &b) {
+        return a.pulseIndex < b.pulseIndex;
+      }));
+}
+
+/// @return the latest pulse time, or DateAndTime::minimum() if empty
+DateAndTime CompactEvents::getPulseTimeMax() const {
+  if (m_events.empty())
+    return DateAndTime::minimum();
+  return pulseTime(*std::max_element(
+      m_events.cbegin(), m_events.cend(),
+      [](const CompactEvent &a, const CompactEvent &b) {
+        return a.pulseIndex < b.pulseIndex;
+      }));
+}
+
+/** Histogram the events by time-of-flight. They must already be sorted by
+ * time-of-flight.
+ *
+ * @param X :: The x bins
+ * @param Y :: The generated counts histogram
+ * @param E :: The generated error histogram
+ * @param skipError :: skip calculating the error
+ */
+void CompactEvents::histogram(const MantidVec &X, MantidVec &Y, MantidVec &E,
+                              bool skipError) const {
+  EventHistogrammer(X).countEvents(m_events, true, Y);
+  if (!skipError) {
+    E.resize(Y.size());
+    std::transform(Y.cbegin(), Y.cend(), E.begin(),
+                   static_cast<double (*)(double)>(sqrt));
+  }
+}
+
+/** Histogram the events by pulse time, in any order. The bin edges are
+ * turned into pulse indices once, so each event only needs a search through
+ * the (few) bins.
+ *
+ * @param X :: The bins, in nanoseconds since the GPS epoch
+ * @param Y :: The generated counts histogram
+ */
+void CompactEvents::histogramPulseTime(const MantidVec &X,
+                                       MantidVec &Y) const {
+  if (X.size() <= 1) {
+    Y.clear();
+    return;
+  }
+  Y.assign(X.size() - 1, 0.0);
+  if (m_events.empty())
+    return;
+
+  // The first pulse index at or after each bin edge
+  const auto &table = *m_pulseTimes;
+  std::vector<uint32_t> edges(X.size());
+  std::transform(X.cbegin(), X.cend(), edges.begin(), [&table](double x) {
+    const auto it = std::partition_point(
+        table.cbegin(), table.cend(), [x](const DateAndTime &time) {
+          return static_cast<double>(time.totalNanoseconds()) < x;
+        });
+    return static_cast<uint32_t>(std::distance(table.cbegin(), it));
+  });
+
+  for (const auto &event : m_events) {
+    if (event.pulseIndex < edges.front() || event.pulseIndex >= edges.back())
+      continue;
+    const auto bin =
+        std::upper_bound(edges.cbegin(), edges.cend(), event.pulseIndex) -
+        edges.cbegin() - 1;
+    Y[bin] += 1.0;
+  }
+}
+
+/** Copy the events with start <= pulse time < stop, keeping their order
+ * @param start :: start time (absolute)
+ * @param stop :: end time (absolute)
+ * @param output :: receives the events and shares the pulse time table
+ */
+void CompactEvents::filterByPulseTime(const DateAndTime start,
+                                      const DateAndTime stop,
+                                      CompactEvents &output) const {
+  output.m_events.clear();
+  output.m_pulseTimes = m_pulseTimes;
+  if (m_events.empty())
+    return;
+  const auto range = pulseIndexRange(start, stop);
+  std::copy_if(m_events.cbegin(), m_events.cend(),
+               std::back_inserter(output.m_events),
+               [&range](const CompactEvent &event) {
+                 return event.pulseIndex >= range.first &&
+                        event.pulseIndex < range.second;
+               });
+}
+
+/** Split the events by pulse time, in any order, the same way as
+ * EventList::splitByPulseTime: events in an interval go to the output of its
+ * index, events between intervals to output -1 and events after the last
+ * interval are dropped. The intervals must be sorted and not overlap.
+ *
+ * @param splitter :: the intervals to split by
+ * @param outputs :: outputs by interval index, replaced with the events and
+ * sharing the pulse time table. Events for indices without an output are
+ * dropped.
+ */
+void CompactEvents::splitByPulseTime(
+    const Kernel::TimeSplitterType &splitter,
+    std::map<int, CompactEvents *> &outputs) const {
+  for (auto &output : outputs) {
+    output.second->m_events.clear();
+    output.second->m_pulseTimes = m_pulseTimes;
+  }
+  if (m_events.empty() || splitter.empty())
+    return;
+
+  // Pulse index ranges of the intervals
+  std::vector<uint32_t> starts, stops;
+  std::vector<CompactEvents *> destinations;
+  starts.reserve(splitter.size());
+  stops.reserve(splitter.size());
+  destinations.reserve(splitter.size());
+  for (const auto &interval : splitter) {
+    const auto range = pulseIndexRange(interval.start(), interval.stop());
+    starts.emplace_back(range.first);
+    stops.emplace_back(range.second);
+    const auto output = outputs.find(interval.index());
+    destinations.emplace_back(output == outputs.end() ? nullptr
+                                                      : output->second);
+  }
+  const auto unfiltered = outputs.find(-1);
+  CompactEvents *between =
+      unfiltered == outputs.end() ? nullptr : unfiltered->second;
+
+  for (const auto &event : m_events) {
+    // The first interval that has not ended at this pulse
+    const auto i = static_cast<size_t>(
+        std::upper_bound(stops.cbegin(), stops.cend(), event.pulseIndex) -
+        stops.cbegin());
+    if (i == stops.size())
+      continue;
+    auto *destination =
+        event.pulseIndex >= starts[i] ? destinations[i] : between;
+    if (destination)
+      destination->m_events.emplace_back(event);
+  }
+}
+
+/** Equality operator, comparing the events and their pulse times
+ * @param rhs :: other events to compare
+ * @return :: true if equal.
+ */
+bool CompactEvents::operator==(const CompactEvents &rhs) const {
+  if (m_events.size() != rhs.m_events.size())
+    return false;
+  if (m_events.empty())
+    return true;
+  if (m_pulseTimes != rhs.m_pulseTimes && *m_pulseTimes != *rhs.m_pulseTimes) {
+    // Different tables, so compare the pulse times themselves
+    return std::equal(m_events.cbegin(), m_events.cend(),
+                      rhs.m_events.cbegin(),
+                      [this, &rhs](const CompactEvent &a,
+                                   const CompactEvent &b) {
+                        return a.tof == b.tof &&
+                               pulseTime(a) == rhs.pulseTime(b);
+                      });
+  }
+  return std::equal(m_events.cbegin(), m_events.cend(), rhs.m_events.cbegin(),
+                    [](const CompactEvent &a, const CompactEvent &b) {
+                      return a.tof == b.tof && a.pulseIndex == b.pulseIndex;
+                    });
+}
+
+/** Convert a time range into a range of pulse indices
+ * @param start :: start time (absolute), included
+ * @param stop :: end time (absolute), excluded
+ * @return the first index at or after start and the first at or after stop
+ */
+std::pair<uint32_t, uint32_t>
+CompactEvents::pulseIndexRange(const DateAndTime start,
+                               const DateAndTime stop) const {
+  const auto &table = *m_pulseTimes;
+  const auto first = std::lower_bound(table.cbegin(), table.cend(), start);
+  const auto last = std::lower_bound(first, table.cend(), stop);
+  return {static_cast<uint32_t>(std::distance(table.cbegin(), first)),
+          static_cast<uint32_t>(std::distance(table.cbegin(), last))};
+}
+
+} // namespace DataObjects
+} // namespace Mantid
@@ -0,0 +1,286 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidDataObjects/EventColumns.h"
+#include "MantidDataObjects/EventHistogrammer.h"
+
+#ifdef _MSC_VER
+// qualifier applied to function type has no meaning; ignored
+#pragma warning(disable : 4180)
+#endif
+#include "tbb/parallel_sort.h"
+#ifdef _MSC_VER
+#pragma warning(default : 4180)
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace Mantid {
+namespace DataObjects {
+using Types::Core::DateAndTime;
+using Types::Event::TofEvent;
+
+/** Fill the columns from a vector of TofEvent
+ * @param events :: events to copy
+ */
+void EventColumns::assign(const std::vector<TofEvent> &events) {
+  clear();
+  m_hasPulseTimes = true;
+  m_hasWeights = false;
+  m_tof.resize(events.size());
+  m_pulseTime.resize(events.size());
+  for (size_t i = 0; i < events.size(); ++i) {
+    m_tof[i] = events[i].tof();
+    m_pulseTime[i] = events[i].pulseTime().totalNanoseconds();
+  }
+}
+
+/** Fill the columns from a vector of WeightedEvent
+ * @param events :: events to copy
+ */
+void EventColumns::assign(const std::vector<WeightedEvent> &events) {
+  clear();
+  m_hasPulseTimes = true;
+  m_hasWeights = true;
+  m_tof.resize(events.size());
+  m_pulseTime.resize(events.size());
+  m_weight.resize(events.size());
+  m_errorSquared.resize(events.size());
+  for (size_t i = 0; i < events.size(); ++i) {
+    m_tof[i] = events[i].tof();
+    m_pulseTime[i] = events[i].pulseTime().totalNanoseconds();
+    m_weight[i] = events[i].m_weight;
+    m_errorSquared[i] = events[i].m_errorSquared;
+  }
+}
+
+/** Fill the columns from a vector of WeightedEventNoTime
+ * @param events :: events to copy
+ */
+void EventColumns::assign(const std::vector<WeightedEventNoTime> &events) {
+  clear();
+  m_hasPulseTimes = false;
+  m_hasWeights = true;
+  m_tof.resize(events.size());
+  m_weight.resize(events.size());
+  m_errorSquared.resize(events.size());
+  for (size_t i = 0; i < events.size(); ++i) {
+    m_tof[i] = events[i].tof();
+    m_weight[i] = events[i].m_weight;
+    m_errorSquared[i] = events[i].m_errorSquared;
+  }
+}
+
+/** Rebuild a vector of TofEvent from the columns
+ * @param events :: output vector, replaced
+ */
+void EventColumns::extract(std::vector<TofEvent> &events) const {
+  events.clear();
+  events.reserve(m_tof.size());
+  for (size_t i = 0; i < m_tof.size(); ++i)
+    events.emplace_back(m_tof[i], m_hasPulseTimes ? DateAndTime(m_pulseTime[i])
+                                                  : DateAndTime(0));
+}
+
+/** Rebuild a vector of WeightedEvent from the columns
+ * @param events :: output vector, replaced
+ */
+void EventColumns::extract(std::vector<WeightedEvent> &events) const {
+  events.clear();
+  events.reserve(m_tof.size());
+  for (size_t i = 0; i < m_tof.size(); ++i)
+    events.emplace_back(
+        m_tof[i],
+        m_hasPulseTimes ? DateAndTime(m_pulseTime[i]) : DateAndTime(0),
+        m_hasWeights ? m_weight[i] : 1.0f,
+        m_hasWeights ? m_errorSquared[i] : 1.0f);
+}
+
+/** Rebuild a vector of WeightedEventNoTime from the columns
+ * @param events :: output vector, replaced
+ */
+void EventColumns::extract(std::vector<WeightedEventNoTime> &events) const {
+  events.clear();
+  events.reserve(m_tof.size());
+  for (size_t i = 0; i < m_tof.size(); ++i)
+    events.emplace_back(m_tof[i], m_hasWeights ? m_weight[i] : 1.0f,
+                        m_hasWeights ? m_errorSquared[i] : 1.0f);
+}
+
+/// Append a TofEvent to the columns
+void EventColumns::push_back(const TofEvent &event) {
+  m_tof.emplace_back(event.tof());
+  if (m_hasPulseTimes)
+    m_pulseTime.emplace_back(event.pulseTime().totalNanoseconds());
+  if (m_hasWeights) {
+    m_weight.emplace_back(1.0f);
+    m_errorSquared.emplace_back(1.0f);
+  }
+}
+
+/// Append a WeightedEvent to the columns
+void EventColumns::push_back(const WeightedEvent &event) {
+  m_tof.emplace_back(event.tof());
+  if (m_hasPulseTimes)
+    m_pulseTime.emplace_back(event.pulseTime().totalNanoseconds());
+  if (m_hasWeights) {
+    m_weight.emplace_back(event.m_weight);
+    m_errorSquared.emplace_back(event.m_errorSquared);
+  }
+}
+
+/// Append a WeightedEventNoTime to the columns
+void EventColumns::push_back(const WeightedEventNoTime &event) {
+  m_tof.emplace_back(event.tof());
+  if (m_hasPulseTimes)
+    m_pulseTime.emplace_back(0);
+  if (m_hasWeights) {
+    m_weight.emplace_back(event.m_weight);
+    m_errorSquared.emplace_back(event.m_errorSquared);
+  }
+}
+
+/// Remove all events and release the memory held by the columns
+void EventColumns::clear() {
+  std::vector<double>().swap(m_tof);
+  std::vector<int64_t>().swap(m_pulseTime);
+  std::vector<float>().swap(m_weight);
+  std::vector<float>().swap(m_errorSquared);
+}
+
+/** Reserve space in each column that is in use
+ * @param num :: number of events that will be held
+ */
+void EventColumns::reserve(size_t num) {
+  m_tof.reserve(num);
+  if (m_hasPulseTimes)
+    m_pulseTime.reserve(num);
+  if (m_hasWeights) {
+    m_weight.reserve(num);
+    m_errorSquared.reserve(num);
+  }
+}
+
+/// @return the memory used by the columns in bytes (using their capacity)
+size_t EventColumns::getMemorySize() const {
+  return m_tof.capacity() * sizeof(double) +
+         m_pulseTime.capacity() * sizeof(int64_t) +
+         (m_weight.capacity() + m_errorSquared.capacity()) * sizeof(float);
+}
+
+/// Start carrying weights: every existing event gets weight and error 1
+void EventColumns::addWeights() {
+  if (m_hasWeights)
+    return;
+  m_weight.assign(m_tof.size(), 1.0f);
+  m_errorSquared.assign(m_tof.size(), 1.0f);
+  m_hasWeights = true;
+}
+
+/// Stop carrying pulse times and free that column
+void EventColumns::dropPulseTimes() {
+  std::vector<int64_t>().swap(m_pulseTime);
+  m_hasPulseTimes = false;
+}
+
+/** Reorder a column so that entry i becomes column[order[i]]
+ * @param column :: column to reorder in place
+ * @param order :: permutation, as indices into the current column
+ */
+template <typename T>
+void EventColumns::permute(std::vector<T> &column,
+                           const std::vector<size_t> &order) const {
+  if (column.empty())
+    return;
+  std::vector<T> sorted(column.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    sorted[i] = column[order[i]];
+  column.swap(sorted);
+}
+
+/// Sort all columns by increasing time-of-flight
+void EventColumns::sortTof() {
+  if (std::is_sorted(m_tof.cbegin(), m_tof.cend()))
+    return;
+
+  if (!m_hasPulseTimes && !m_hasWeights) {
+    tbb::parallel_sort(m_tof.begin(), m_tof.end());
+    return;
+  }
+
+  // Sort a permutation by the tof key, then gather every column through it
+  std::vector<size_t> order(m_tof.size());
+  std::iota(order.begin(), order.end(), size_t{0});
+  const auto &tof = m_tof;
+  tbb::parallel_sort(order.begin(), order.end(),
+                     [&tof](const size_t a, const size_t b) {
+                       return tof[a] < tof[b];
+                     });
+  permute(m_tof, order);
+  permute(m_pulseTime, order);
+  permute(m_weight, order);
+  permute(m_errorSquared, order);
+}
+
+/// Reverse the order of the events in all columns
+void EventColumns::reverse() {
+  std::reverse(m_tof.begin(), m_tof.end());
+  std::reverse(m_pulseTime.begin(), m_pulseTime.end());
+  std::reverse(m_weight.begin(), m_weight.end());
+  std::reverse(m_errorSquared.begin(), m_errorSquared.end());
+}
+
+/** Convert the time of flight by tof'=tof*factor+offset. Only the tof column
+ * is touched.
+ * @param factor :: The value to scale the time-of-flight by
+ * @param offset :: The value to shift the time-of-flight by
+ */
+void EventColumns::convertTof(const double factor, const double offset) {
+  double *tof = m_tof.data();
+  const size_t numEvents = m_tof.size();
+  for (size_t i = 0; i < numEvents; ++i)
+    tof[i] = tof[i] * factor + offset;
+}
+
+/** Histogram the events, which must already be sorted by time-of-flight.
+ *
+ * @param X :: The x bins
+ * @param Y :: The generated counts histogram
+ * @param E :: The generated error histogram
+ * @param skipError :: skip calculating the error for unweighted events
+ */
+void EventColumns::histogram(const MantidVec &X, MantidVec &Y, MantidVec &E,
+                             bool skipError) const {
+  const EventHistogrammer histogrammer(X);
+  if (m_hasWeights) {
+    histogrammer.sumWeights(m_tof.data(), m_weight.data(),
+                            m_errorSquared.data(), m_tof.size(), true, Y, E);
+    return;
+  }
+
+  histogrammer.countEvents(m_tof.data(), m_tof.size(), true, Y);
+  if (!skipError) {
+    E.resize(Y.size());
+    std::transform(Y.cbegin(), Y.cend(), E.begin(),
+                   static_cast<double (*)(double)>(sqrt));
+  }
+}
+
+/** Equality operator, comparing all columns in use
+ * @param rhs :: other columns to compare
+ * @return :: true if equal.
+ */
+bool EventColumns::operator==(const EventColumns &rhs) const {
+  return m_hasPulseTimes == rhs.m_hasPulseTimes &&
+         m_hasWeights == rhs.m_hasWeights && m_tof == rhs.m_tof &&
+         m_pulseTime == rhs.m_pulseTime && m_weight == rhs.m_weight &&
+         m_errorSquared == rhs.m_errorSquared;
+}
+
+} // namespace DataObjects
+} // namespace Mantid
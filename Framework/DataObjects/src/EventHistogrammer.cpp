@@ -0,0 +1,419 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidDataObjects/EventHistogrammer.h"
+#include "MantidDataObjects/CompactEvents.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+// GCC can build several copies of a function for different instruction sets
+// and pick one when the library is loaded, based on what the CPU supports.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) &&        \
+    defined(__linux__)
+#define HISTOGRAM_KERNEL                                                       \
+  __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define HISTOGRAM_KERNEL
+#endif
+
+namespace Mantid {
+namespace DataObjects {
+using Types::Event::TofEvent;
+
+namespace {
+/// Number of events whose bin indices are computed in one go
+constexpr size_t BLOCK_SIZE = 1024;
+
+/** Estimate the bin index of each tof for equally spaced bins. The estimate
+ * is clamped to [0, maxIndex] and may be out by one due to rounding.
+ * @param tofs :: times-of-flight
+ * @param count :: number of entries in tofs
+ * @param start :: the first bin edge
+ * @param inverseWidth :: 1/(bin width)
+ * @param maxIndex :: index of the last bin
+ * @param indices :: output estimates
+ */
+HISTOGRAM_KERNEL
+void linearBinIndices(const double *tofs, const size_t count,
+                      const double start, const double inverseWidth,
+                      const double maxIndex, int *indices) {
+  for (size_t i = 0; i < count; ++i) {
+    double estimate = (tofs[i] - start) * inverseWidth;
+    // Written so that NaN ends up in bin 0 rather than being cast to int
+    estimate = estimate > 0. ? estimate : 0.;
+    estimate = estimate < maxIndex ? estimate : maxIndex;
+    indices[i] = static_cast<int>(estimate);
+  }
+}
+
+/** Estimate the bin index of each tof for bins equally spaced in log(tof).
+ * The estimate is clamped to [0, maxIndex] and may be out by one due to
+ * rounding.
+ * @param tofs :: times-of-flight
+ * @param count :: number of entries in tofs
+ * @param firstEdge :: the first bin edge, which must be positive
+ * @param logStart :: log of the first bin edge
+ * @param inverseWidth :: 1/(bin width in log(tof))
+ * @param maxIndex :: index of the last bin
+ * @param indices :: output estimates
+ */
+HISTOGRAM_KERNEL
+void logarithmicBinIndices(const double *tofs, const size_t count,
+                           const double firstEdge, const double logStart,
+                           const double inverseWidth, const double maxIndex,
+                           int *indices) {
+  for (size_t i = 0; i < count; ++i) {
+    // Keep the argument of log positive; anything below the first edge is
+    // discarded later anyway
+    const double tof = tofs[i] > firstEdge ? tofs[i] : firstEdge;
+    double estimate = (std::log(tof) - logStart) * inverseWidth;
+    estimate = estimate > 0. ? estimate : 0.;
+    estimate = estimate < maxIndex ? estimate : maxIndex;
+    indices[i] = static_cast<int>(estimate);
+  }
+}
+
+/** Find the first event with tof >= value in events sorted by tof
+ * @param numEvents :: number of events
+ * @param tofAt :: callable returning the tof of event i
+ * @param value :: value to look for
+ * @return index of the first event not below value, or numEvents
+ */
+template <typename TofAt>
+size_t firstEventNotBelow(const size_t numEvents, TofAt tofAt,
+                          const double value) {
+  size_t low = 0;
+  size_t high = numEvents;
+  while (low < high) {
+    const size_t middle = low + (high - low) / 2;
+    if (tofAt(middle) < value)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  return low;
+}
+
+/** Check whether values are close enough to equally spaced that an
+ * arithmetic estimate of the bin lands within one bin of the right one.
+ * @param values :: bin edges, or their logarithm
+ * @param width :: the average spacing
+ * @return true if every value is within a quarter bin of its ideal position
+ */
+bool isEquallySpaced(const std::vector<double> &values, const double width) {
+  if (!(width > 0.) || !std::isfinite(width))
+    return false;
+  const double start = values.front();
+  const double tolerance = 0.25 * width;
+  for (size_t i = 0; i < values.size(); ++i) {
+    const double ideal = start + static_cast<double>(i) * width;
+    if (!(std::abs(values[i] - ideal) <= tolerance))
+      return false;
+  }
+  return true;
+}
+
+/// The bin edges last seen by a thread and their layout
+struct CachedLayout {
+  const double *data{nullptr};
+  size_t size{0};
+  double front{0.};
+  double back{0.};
+  EventHistogrammer::Layout layout{EventHistogrammer::Layout::Arbitrary};
+};
+
+/** Layout of the bin edges, reusing the result for the edges seen last by
+ * this thread. The spectra of a workspace usually share their X, so the edges
+ * are only inspected once. An out of date layout for edges changed in place
+ * costs speed but not correctness, as every estimate of a bin is checked
+ * against the real edges; the first and last edge, from which the estimates
+ * are made, are part of the key.
+ * @param X :: The bin edges
+ * @return the layout of the edges
+ */
+EventHistogrammer::Layout cachedLayout(const MantidVec &X) {
+  thread_local CachedLayout cache;
+  if (X.empty())
+    return EventHistogrammer::Layout::Arbitrary;
+  if (cache.data != X.data() || cache.size != X.size() ||
+      cache.front != X.front() || cache.back != X.back()) {
+    cache.layout = EventHistogrammer::detectLayout(X);
+    cache.data = X.data();
+    cache.size = X.size();
+    cache.front = X.front();
+    cache.back = X.back();
+  }
+  return cache.layout;
+}
+} // namespace
+
+/** Constructor. Looks up the layout of the bin edges to choose how events
+ * are binned.
+ * @param X :: The bin edges. They must outlive the histogrammer.
+ */
+EventHistogrammer::EventHistogrammer(const MantidVec &X)
+    : m_X(X), m_numBins(X.size() > 1 ? X.size() - 1 : 0),
+      m_layout(cachedLayout(X)) {
+  switch (m_layout) {
+  case Layout::Linear:
+    m_start = X.front();
+    m_inverseWidth =
+        static_cast<double>(m_numBins) / (X.back() - X.front());
+    break;
+  case Layout::Logarithmic:
+    m_start = std::log(X.front());
+    m_inverseWidth = static_cast<double>(m_numBins) /
+                     (std::log(X.back()) - std::log(X.front()));
+    break;
+  case Layout::Arbitrary:
+    break;
+  }
+}
+
+/** Work out whether bin edges are linear, logarithmic or neither
+ * @param X :: The bin edges
+ * @return the layout of the edges
+ */
+EventHistogrammer::Layout EventHistogrammer::detectLayout(const MantidVec &X) {
+  if (X.size() < 2 ||
+      X.size() - 1 > static_cast<size_t>(std::numeric_limits<int>::max()))
+    return Layout::Arbitrary;
+  const auto numBins = static_cast<double>(X.size() - 1);
+
+  if (isEquallySpaced(X, (X.back() - X.front()) / numBins))
+    return Layout::Linear;
+
+  if (X.front() > 0.) {
+    std::vector<double> logX(X.size());
+    std::transform(X.cbegin(), X.cend(), logX.begin(),
+                   static_cast<double (*)(double)>(std::log));
+    if (isEquallySpaced(logX, (logX.back() - logX.front()) / numBins))
+      return Layout::Logarithmic;
+  }
+  return Layout::Arbitrary;
+}
+
+/** Histogram unweighted events
+ * @param events :: The events to bin
+ * @param sorted :: true if the events are sorted by time-of-flight
+ * @param Y :: The generated counts histogram
+ */
+void EventHistogrammer::countEvents(const std::vector<TofEvent> &events,
+                                    const bool sorted, MantidVec &Y) const {
+  resetOutput(Y);
+  binEvents(
+      events.size(), sorted, [&events](size_t i) { return events[i].tof(); },
+      [&Y](size_t, size_t bin) { Y[bin] += 1.0; });
+}
+
+/** Histogram compact unweighted events
+ * @param events :: The events to bin
+ * @param sorted :: true if the events are sorted by time-of-flight
+ * @param Y :: The generated counts histogram
+ */
+void EventHistogrammer::countEvents(const std::vector<CompactEvent> &events,
+                                    const bool sorted, MantidVec &Y) const {
+  resetOutput(Y);
+  binEvents(
+      events.size(), sorted,
+      [&events](size_t i) { return static_cast<double>(events[i].tof); },
+      [&Y](size_t, size_t bin) { Y[bin] += 1.0; });
+}
+
+/** Histogram unweighted events held as a column of times-of-flight
+ * @param tofs :: The times-of-flight
+ * @param numEvents :: The number of events
+ * @param sorted :: true if the events are sorted by time-of-flight
+ * @param Y :: The generated counts histogram
+ */
+void EventHistogrammer::countEvents(const double *tofs, const size_t numEvents,
+                                    const bool sorted, MantidVec &Y) const {
+  resetOutput(Y);
+  binEvents(
+      numEvents, sorted, [tofs](size_t i) { return tofs[i]; },
+      [&Y](size_t, size_t bin) { Y[bin] += 1.0; });
+}
+
+/** Histogram weighted events
+ * @param events :: The events to bin
+ * @param sorted :: true if the events are sorted by time-of-flight
+ * @param Y :: The generated histogram of summed weights
+ * @param E :: The generated error histogram
+ */
+void EventHistogrammer::sumWeights(const std::vector<WeightedEvent> &events,
+                                   const bool sorted, MantidVec &Y,
+                                   MantidVec &E) const {
+  sumEventWeights(events, sorted, Y, E);
+}
+
+/** Histogram weighted events without pulse times
+ * @param events :: The events to bin
+ * @param sorted :: true if the events are sorted by time-of-flight
+ * @param Y :: The generated histogram of summed weights
+ * @param E :: The generated error histogram
+ */
+void EventHistogrammer::sumWeights(
+    const std::vector<WeightedEventNoTime> &events, const bool sorted,
+    MantidVec &Y, MantidVec &E) const {
+  sumEventWeights(events, sorted, Y, E);
+}
+
+/** Histogram weighted events held in columns
+ * @param tofs :: The times-of-flight
+ * @param weights :: The weight of each event
+ * @param errorSquared :: The squared error of each event
+ * @param numEvents :: The number of events
+ * @param sorted :: true if the events are sorted by time-of-flight
+ * @param Y :: The generated histogram of summed weights
+ * @param E :: The generated error histogram
+ */
+void EventHistogrammer::sumWeights(const double *tofs, const float *weights,
+                                   const float *errorSquared,
+                                   const size_t numEvents, const bool sorted,
+                                   MantidVec &Y, MantidVec &E) const {
+  if (m_numBins == 0) {
+    Y.clear();
+    return;
+  }
+  resetOutput(Y);
+  resetOutput(E);
+  // convert to double before adding, to preserve precision
+  binEvents(
+      numEvents, sorted, [tofs](size_t i) { return tofs[i]; },
+      [&](size_t i, size_t bin) {
+        Y[bin] += static_cast<double>(weights[i]);
+        E[bin] += static_cast<double>(errorSquared[i]);
+      });
+  std::transform(E.begin(), E.end(), E.begin(),
+                 static_cast<double (*)(double)>(sqrt));
+}
+
+template <typename EventType>
+void EventHistogrammer::sumEventWeights(const std::vector<EventType> &events,
+                                        const bool sorted, MantidVec &Y,
+                                        MantidVec &E) const {
+  if (m_numBins == 0) {
+    Y.clear();
+    return;
+  }
+  resetOutput(Y);
+  resetOutput(E);
+  // Errors are squared until the last step
+  binEvents(
+      events.size(), sorted, [&events](size_t i) { return events[i].tof(); },
+      [&](size_t i, size_t bin) {
+        Y[bin] += events[i].weight();
+        E[bin] += events[i].errorSquared();
+      });
+  std::transform(E.begin(), E.end(), E.begin(),
+                 static_cast<double (*)(double)>(sqrt));
+}
+
+/// Size the output to the number of bins and zero it
+void EventHistogrammer::resetOutput(MantidVec &Y) const {
+  Y.assign(m_numBins, 0.0);
+}
+
+/** Pass every event that falls inside the bins to addToBin together with its
+ * bin index.
+ * @param numEvents :: number of events
+ * @param sorted :: true if the events are sorted by time-of-flight
+ * @param tofAt :: callable returning the tof of event i
+ * @param addToBin :: callable taking (event index, bin index)
+ */
+template <typename TofAt, typename AddToBin>
+void EventHistogrammer::binEvents(const size_t numEvents, const bool sorted,
+                                  TofAt tofAt, AddToBin addToBin) const {
+  if (m_numBins == 0 || numEvents == 0)
+    return;
+
+  if (!sorted) {
+    binUnsorted(numEvents, tofAt, addToBin);
+  } else if (m_layout != Layout::Arbitrary) {
+    // Only look at the events inside the bins
+    const size_t first = firstEventNotBelow(numEvents, tofAt, m_X.front());
+    const size_t last = firstEventNotBelow(numEvents, tofAt, m_X.back());
+    binArithmetic(
+        last - first, [&tofAt, first](size_t i) { return tofAt(first + i); },
+        [&addToBin, first](size_t i, size_t bin) { addToBin(first + i, bin); });
+  } else {
+    binSorted(numEvents, tofAt, addToBin);
+  }
+}
+
+/// Bin events by computing the bin index from the (log) bin width
+template <typename TofAt, typename AddToBin>
+void EventHistogrammer::binArithmetic(const size_t numEvents, TofAt tofAt,
+                                      AddToBin addToBin) const {
+  const double xMin = m_X.front();
+  const double xMax = m_X.back();
+  const auto maxIndex = static_cast<double>(m_numBins - 1);
+
+  std::array<double, BLOCK_SIZE> tofs;
+  std::array<int, BLOCK_SIZE> indices;
+  for (size_t begin = 0; begin < numEvents; begin += BLOCK_SIZE) {
+    const size_t count = std::min(BLOCK_SIZE, numEvents - begin);
+    for (size_t i = 0; i < count; ++i)
+      tofs[i] = tofAt(begin + i);
+
+    if (m_layout == Layout::Linear)
+      linearBinIndices(tofs.data(), count, m_start, m_inverseWidth, maxIndex,
+                       indices.data());
+    else
+      logarithmicBinIndices(tofs.data(), count, xMin, m_start, m_inverseWidth,
+                            maxIndex, indices.data());
+
+    for (size_t i = 0; i < count; ++i) {
+      const double tof = tofs[i];
+      if (!(tof >= xMin && tof < xMax))
+        continue;
+      // Correct for rounding in the estimate
+      auto bin = static_cast<size_t>(indices[i]);
+      while (tof < m_X[bin])
+        --bin;
+      while (tof >= m_X[bin + 1])
+        ++bin;
+      addToBin(begin + i, bin);
+    }
+  }
+}
+
+/// Bin events sorted by tof by walking the bin edges alongside them
+template <typename TofAt, typename AddToBin>
+void EventHistogrammer::binSorted(const size_t numEvents, TofAt tofAt,
+                                  AddToBin addToBin) const {
+  size_t bin = 0;
+  for (size_t i = firstEventNotBelow(numEvents, tofAt, m_X.front());
+       i < numEvents; ++i) {
+    const double tof = tofAt(i);
+    while (bin < m_numBins && tof >= m_X[bin + 1])
+      ++bin;
+    if (bin == m_numBins)
+      break;
+    addToBin(i, bin);
+  }
+}
+
+/// Bin events in any order with a binary search per event
+template <typename TofAt, typename AddToBin>
+void EventHistogrammer::binUnsorted(const size_t numEvents, TofAt tofAt,
+                                    AddToBin addToBin) const {
+  const double xMin = m_X.front();
+  const double xMax = m_X.back();
+  for (size_t i = 0; i < numEvents; ++i) {
+    const double tof = tofAt(i);
+    if (!(tof >= xMin && tof < xMax))
+      continue;
+    const auto upper = std::upper_bound(m_X.cbegin(), m_X.cend(), tof);
+    addToBin(i, static_cast<size_t>(std::distance(m_X.cbegin(), upper)) - 1);
+  }
+}
+
+} // namespace DataObjects
+} // namespace Mantid
@@ -6,6 +6,9 @@
 // SPDX - License - Identifier: GPL - 3.0 +
 #include "MantidDataObjects/EventList.h"
 #include "MantidAPI/MatrixWorkspace.h"
+#include "MantidDataObjects/EventHistogrammer.h"
+#include "MantidDataObjects/EventSorter.h"
+#include "MantidDataObjects/EventSplitter.h"
 #include "MantidDataObjects/EventWorkspaceMRU.h"
 #include "MantidDataObjects/Histogram1D.h"
 #include "MantidKernel/DateAndTime.h"
@@ -43,82 +46,11 @@ using namespace Mantid::API;
 namespace {
 
 const double SEC_TO_NANO = 1.e9;
-
-/**
- * Calculate the corrected full time in nanoseconds
- * @param event : The event with pulse time and time-of-flight
- * @param tofFactor : Time of flight coefficient factor
- * @param tofShift : Tof shift in seconds
- * @return Corrected full time at sample in Nanoseconds.
- */
-template <typename EventType>
-int64_t calculateCorrectedFullTime(const EventType &event,
-                                   const double tofFactor,
-                                   const double tofShift) {
-  return event.pulseTime().totalNanoseconds() +
-         static_cast<int64_t>(tofFactor * (event.tof() * 1.0E3) +
-                              (tofShift * 1.0E9));
-}
-
-/**
- * Type for comparing events in terms of time at sample
- */
-template <typename EventType> class CompareTimeAtSample {
-private:
-  const double m_tofFactor;
-  const double m_tofShift;
-
-public:
-  CompareTimeAtSample(const double tofFactor, const double tofShift)
-      : m_tofFactor(tofFactor), m_tofShift(tofShift) {}
-
-  /**
-   * Compare two events based on the time they arrived at the sample.
-   * Coefficient is used to provide scaling.
-   * For elastic scattering coefficient is L1 / (L1 + L2)
-   * @param e1 :: first event to compare
-   * @param e2 :: second event to compare
-   * @param coefficient :: scaling coefficient
-   * @return True if first event evaluates to be < second event, otherwise false
-   */
-  bool operator()(const EventType &e1, const EventType &e2) const {
-    const auto tAtSample1 =
-        calculateCorrectedFullTime(e1, m_tofFactor, m_tofShift);
-    const auto tAtSample2 =
-        calculateCorrectedFullTime(e2, m_tofFactor, m_tofShift);
-    return (tAtSample1 < tAtSample2);
-  }
-};
 } // namespace
 //==========================================================================
 /// --------------------- TofEvent Comparators
 /// ----------------------------------
 //==========================================================================
-/** Compare two events' FRAME id, return true if e1 should be before e2.
- * @param e1 :: first event
- * @param e2 :: second event
- *  */
-bool compareEventPulseTime(const TofEvent &e1, const TofEvent &e2) {
-  return (e1.pulseTime() < e2.pulseTime());
-}
-
-/** Compare two events' FRAME id, return true if e1 should be before e2.
- *  Assuming that if e1's pulse time is earlier than e2's, then e1 must be
- * earlier regardless TOF value
- * @param e1 :: first event
- * @param e2 :: second event
- *  */
-bool compareEventPulseTimeTOF(const TofEvent &e1, const TofEvent &e2) {
-
-  if (e1.pulseTime() < e2.pulseTime()) {
-    return true;
-  } else if ((e1.pulseTime() == e2.pulseTime()) && (e1.tof() < e2.tof())) {
-    return true;
-  }
-
-  return false;
-}
-
 // comparator for pulse time with tolerance
 struct comparePulseTimeTOFDelta {
   explicit comparePulseTimeTOFDelta(const Types::Core::DateAndTime &start,
@@ -228,6 +160,10 @@ void EventList::copyDataInto(EventList &sink) const {
   sink.events = events;
   sink.weightedEvents = weightedEvents;
   sink.weightedEventsNoTime = weightedEventsNoTime;
+  sink.m_columns = m_columns;
+  sink.m_compact = m_compact;
+  sink.m_storageType = m_storageType;
+  sink.m_hasRowCopy = m_hasRowCopy.load();
   sink.eventType = eventType;
   sink.order = order;
 }
@@ -254,6 +190,7 @@ void EventList::createFromHistogram(const ISpectrum *inSpec, bool GenerateZeros,
                                     int MaxEventsPerBin) {
   // Fresh start
   this->clear(true);
+  this->ensureRowStorage();
 
   // Get the input histogram
   const MantidVec &X = inSpec->readX();
@@ -338,6 +275,10 @@ EventList &EventList::operator=(const EventList &rhs) {
   events = rhs.events;
   weightedEvents = rhs.weightedEvents;
   weightedEventsNoTime = rhs.weightedEventsNoTime;
+  m_columns = rhs.m_columns;
+  m_compact = rhs.m_compact;
+  m_storageType = rhs.m_storageType;
+  m_hasRowCopy = rhs.m_hasRowCopy.load();
   eventType = rhs.eventType;
   order = rhs.order;
   return *this;
@@ -349,7 +290,7 @@ EventList &EventList::operator=(const EventList &rhs) {
  * @return reference to this
  * */
 EventList &EventList::operator+=(const TofEvent &event) {
-
+  this->ensureRowStorage();
   switch (this->eventType) {
   case TOF:
     // Simply push the events
@@ -377,6 +318,7 @@ EventList &EventList::operator+=(const TofEvent &event) {
  * @return reference to this
  * */
 EventList &EventList::operator+=(const std::vector<TofEvent> &more_events) {
+  this->ensureRowStorage();
   switch (this->eventType) {
   case TOF:
     // Simply push the events
@@ -417,6 +359,7 @@ EventList &EventList::operator+=(const std::vector<TofEvent> &more_events) {
  * @return reference to this
  * */
 EventList &EventList::operator+=(const WeightedEvent &event) {
+  this->ensureRowStorage();
   this->switchTo(WEIGHTED);
   this->weightedEvents.emplace_back(event);
   this->order = UNSORTED;
@@ -433,6 +376,7 @@ EventList &EventList::operator+=(const WeightedEvent &event) {
  * */
 EventList &EventList::
 operator+=(const std::vector<WeightedEvent> &more_events) {
+  this->ensureRowStorage();
   switch (this->eventType) {
   case TOF:
     // Need to switch to weighted
@@ -470,6 +414,7 @@ operator+=(const std::vector<WeightedEvent> &more_events) {
  * */
 EventList &EventList::
 operator+=(const std::vector<WeightedEventNoTime> &more_events) {
+  this->ensureRowStorage();
   switch (this->eventType) {
   case TOF:
   case WEIGHTED:
@@ -498,6 +443,8 @@ operator+=(const std::vector<WeightedEventNoTime> &more_events) {
  * @return reference to this
  * */
 EventList &EventList::operator+=(const EventList &more_events) {
+  this->ensureRowStorage();
+  more_events.makeRowCopy();
   // We'll let the += operator for the given vector of event lists handle it
   switch (more_events.getEventType()) {
   case TOF:
@@ -565,6 +512,8 @@ EventList &EventList::operator-=(const EventList &more_events) {
     this->clearData();
     return *this;
   }
+  this->ensureRowStorage();
+  more_events.makeRowCopy();
 
   // We'll let the -= operator for the given vector of event lists handle it
   switch (this->getEventType()) {
@@ -619,6 +568,12 @@ bool EventList::operator==(const EventList &rhs) const {
     return false;
   if (this->eventType != rhs.eventType)
     return false;
+  if (m_storageType == COLUMN_STORAGE && rhs.m_storageType == COLUMN_STORAGE)
+    return m_columns == rhs.m_columns;
+  if (m_storageType == COMPACT_STORAGE && rhs.m_storageType == COMPACT_STORAGE)
+    return m_compact == rhs.m_compact;
+  this->makeRowCopy();
+  rhs.makeRowCopy();
   // Check all event lists; The empty ones will compare equal
   if (events != rhs.events)
     return false;
@@ -645,6 +600,9 @@ bool EventList::equals(const EventList &rhs, const double tolTof,
   if (this->eventType != rhs.eventType)
     return false;
 
+  this->makeRowCopy();
+  rhs.makeRowCopy();
+
   // loop over the events
   size_t numEvents = this->getNumberEvents();
   switch (this->eventType) {
@@ -726,12 +684,20 @@ void EventList::switchToWeightedEvents() {
     break;
 
   case TOF:
+    // Compact events cannot carry weights
+    if (m_storageType == COMPACT_STORAGE)
+      this->ensureRowStorage();
+    eventType = WEIGHTED;
+    if (m_storageType == COLUMN_STORAGE) {
+      this->dropRowCopy();
+      m_columns.addWeights();
+      break;
+    }
     weightedEventsNoTime.clear();
     // Convert and copy all TofEvents to the weightedEvents list.
     this->weightedEvents.assign(events.cbegin(), events.cend());
     // Get rid of the old events
     events.clear();
-    eventType = WEIGHTED;
     break;
   }
 }
@@ -747,6 +713,16 @@ void EventList::switchToWeightedEventsNoTime() {
     return;
 
   case TOF: {
+    // Compact events cannot carry weights
+    if (m_storageType == COMPACT_STORAGE)
+      this->ensureRowStorage();
+    if (m_storageType == COLUMN_STORAGE) {
+      this->dropRowCopy();
+      m_columns.addWeights();
+      m_columns.dropPulseTimes();
+      eventType = WEIGHTED_NOTIME;
+      break;
+    }
     // Convert and copy all TofEvents to the weightedEvents list.
     this->weightedEventsNoTime.assign(events.cbegin(), events.cend());
     // Get rid of the old events
@@ -756,6 +732,12 @@ void EventList::switchToWeightedEventsNoTime() {
   } break;
 
   case WEIGHTED: {
+    if (m_storageType == COLUMN_STORAGE) {
+      this->dropRowCopy();
+      m_columns.dropPulseTimes();
+      eventType = WEIGHTED_NOTIME;
+      break;
+    }
     // Convert and copy all TofEvents to the weightedEvents list.
     this->weightedEventsNoTime.assign(weightedEvents.cbegin(),
                                       weightedEvents.cend());
@@ -779,6 +761,7 @@ void EventList::switchToWeightedEventsNoTime() {
  * @return a WeightedEvent
  */
 WeightedEvent EventList::getEvent(size_t event_number) {
+  this->ensureRowStorage();
   switch (eventType) {
   case TOF:
     return WeightedEvent(events[event_number]);
@@ -809,6 +792,7 @@ const std::vector<TofEvent> &EventList::getEvents() const {
     throw std::runtime_error("EventList::getEvents() called for an EventList "
                              "that has weights. Use getWeightedEvents() or "
                              "getWeightedEventsNoTime().");
+  this->makeRowCopy();
   return this->events;
 }
 
@@ -824,6 +808,7 @@ std::vector<TofEvent> &EventList::getEvents() {
     throw std::runtime_error("EventList::getEvents() called for an EventList "
                              "that has weights. Use getWeightedEvents() or "
                              "getWeightedEventsNoTime().");
+  this->ensureRowStorage();
   return this->events;
 }
 
@@ -839,6 +824,7 @@ std::vector<WeightedEvent> &EventList::getWeightedEvents() {
     throw std::runtime_error("EventList::getWeightedEvents() called for an "
                              "EventList not of type WeightedEvent. Use "
                              "getEvents() or getWeightedEventsNoTime().");
+  this->ensureRowStorage();
   return this->weightedEvents;
 }
 
@@ -854,6 +840,7 @@ const std::vector<WeightedEvent> &EventList::getWeightedEvents() const {
     throw std::runtime_error("EventList::getWeightedEvents() called for an "
                              "EventList not of type WeightedEvent. Use "
                              "getEvents() or getWeightedEventsNoTime().");
+  this->makeRowCopy();
   return this->weightedEvents;
 }
 
@@ -867,6 +854,7 @@ std::vector<WeightedEventNoTime> &EventList::getWeightedEventsNoTime() {
     throw std::runtime_error("EventList::getWeightedEvents() called for an "
                              "EventList not of type WeightedEventNoTime. Use "
                              "getEvents() or getWeightedEvents().");
+  this->ensureRowStorage();
   return this->weightedEventsNoTime;
 }
 
@@ -881,11 +869,13 @@ EventList::getWeightedEventsNoTime() const {
     throw std::runtime_error("EventList::getWeightedEventsNoTime() called for "
                              "an EventList not of type WeightedEventNoTime. "
                              "Use getEvents() or getWeightedEvents().");
+  this->makeRowCopy();
   return this->weightedEventsNoTime;
 }
 
 /** Clear the list of events and any
- * associated detector ID's.
+ * associated detector ID's. The storage type is kept, and compact lists keep
+ * their pulse time table.
  * */
 void EventList::clear(const bool removeDetIDs) {
   if (mru)
@@ -898,6 +888,12 @@ void EventList::clear(const bool removeDetIDs) {
   this->weightedEventsNoTime.clear();
   std::vector<WeightedEventNoTime>().swap(
       this->weightedEventsNoTime); // STL Trick to release memory
+  m_hasRowCopy = false;
+  m_columns.clear();
+  if (m_storageType == COMPACT_STORAGE)
+    m_compact.assign({}, m_compact.pulseTimeTable());
+  else
+    m_compact.clear();
   if (removeDetIDs)
     this->clearDetectorIDs();
 }
@@ -940,6 +936,14 @@ void EventList::setMRU(EventWorkspaceMRU *newMRU) { mru = newMRU; }
  * @param num :: number of events that will be in this EventList
  */
 void EventList::reserve(size_t num) {
+  if (m_storageType == COLUMN_STORAGE) {
+    m_columns.reserve(num);
+    return;
+  }
+  if (m_storageType == COMPACT_STORAGE) {
+    m_compact.reserve(num);
+    return;
+  }
   switch (this->eventType) {
   case TOF:
     this->events.reserve(num);
@@ -992,7 +996,7 @@ void EventList::setSortOrder(const EventSortType order) const {
 }
 
 // --------------------------------------------------------------------------
-/** Sort events by TOF in one thread */
+/** Sort events by TOF */
 void EventList::sortTof() const {
   if (this->order == TOF_SORT)
     return; // nothing to do
@@ -1003,16 +1007,27 @@ void EventList::sortTof() const {
   if (this->order == TOF_SORT)
     return;
 
+  if (m_storageType == COLUMN_STORAGE || m_storageType == COMPACT_STORAGE) {
+    if (m_storageType == COLUMN_STORAGE)
+      m_columns.sortTof();
+    else
+      m_compact.sortTof();
+    // Keep a row copy given to const readers in the same order
+    if (m_hasRowCopy)
+      fillRowCopy();
+    this->order = TOF_SORT;
+    return;
+  }
+
   switch (eventType) {
   case TOF:
-    tbb::parallel_sort(events.begin(), events.end());
+    EventSorter().sortTof(events);
     break;
   case WEIGHTED:
-    tbb::parallel_sort(weightedEvents.begin(), weightedEvents.end());
+    EventSorter().sortTof(weightedEvents);
     break;
   case WEIGHTED_NOTIME:
-    tbb::parallel_sort(weightedEventsNoTime.begin(),
-                       weightedEventsNoTime.end());
+    EventSorter().sortTof(weightedEventsNoTime);
     break;
   }
   // Save the order to avoid unnecessary re-sorting.
@@ -1041,23 +1056,23 @@ void EventList::sortTimeAtSample(const double &tofFactor,
   if (this->order == TIMEATSAMPLE_SORT && !forceResort)
     return;
 
+  // Column-stored or compact events are sorted through their row copy
+  if (!m_hasRowCopy)
+    fillRowCopy();
+
   // Perform sort.
   switch (eventType) {
-  case TOF: {
-    CompareTimeAtSample<TofEvent> comparitor(tofFactor, tofShift);
-    tbb::parallel_sort(events.begin(), events.end(), comparitor);
-  } break;
-  case WEIGHTED: {
-    CompareTimeAtSample<WeightedEvent> comparitor(tofFactor, tofShift);
-    tbb::parallel_sort(weightedEvents.begin(), weightedEvents.end(),
-                       comparitor);
-  } break;
-  case WEIGHTED_NOTIME: {
-    CompareTimeAtSample<WeightedEventNoTime> comparitor(tofFactor, tofShift);
-    tbb::parallel_sort(weightedEventsNoTime.begin(), weightedEventsNoTime.end(),
-                       comparitor);
-  } break;
+  case TOF:
+    EventSorter().sortTimeAtSample(events, tofFactor, tofShift);
+    break;
+  case WEIGHTED:
+    EventSorter().sortTimeAtSample(weightedEvents, tofFactor, tofShift);
+    break;
+  case WEIGHTED_NOTIME:
+    EventSorter().sortTimeAtSample(weightedEventsNoTime, tofFactor, tofShift);
+    break;
   }
+  storeRowCopy();
   // Save the order to avoid unnecessary re-sorting.
   this->order = TIMEATSAMPLE_SORT;
 }
@@ -1074,19 +1089,31 @@ void EventList::sortPulseTime() const {
   if (this->order == PULSETIME_SORT)
     return;
 
+  if (m_storageType == COMPACT_STORAGE) {
+    m_compact.sortPulseTime();
+    if (m_hasRowCopy)
+      fillRowCopy();
+    this->order = PULSETIME_SORT;
+    return;
+  }
+
+  // Column-stored events are sorted through their row copy
+  if (!m_hasRowCopy)
+    fillRowCopy();
+
   // Perform sort.
   switch (eventType) {
   case TOF:
-    tbb::parallel_sort(events.begin(), events.end(), compareEventPulseTime);
+    EventSorter().sortPulseTime(events);
     break;
   case WEIGHTED:
-    tbb::parallel_sort(weightedEvents.begin(), weightedEvents.end(),
-                       compareEventPulseTime);
+    EventSorter().sortPulseTime(weightedEvents);
     break;
   case WEIGHTED_NOTIME:
     // Do nothing; there is no time to sort
     break;
   }
+  storeRowCopy();
   // Save the order to avoid unnecessary re-sorting.
   this->order = PULSETIME_SORT;
 }
@@ -1105,18 +1132,22 @@ void EventList::sortPulseTimeTOF() const {
   if (this->order == PULSETIMETOF_SORT)
     return;
 
+  // Column-stored or compact events are sorted through their row copy
+  if (!m_hasRowCopy)
+    fillRowCopy();
+
   switch (eventType) {
   case TOF:
-    tbb::parallel_sort(events.begin(), events.end(), compareEventPulseTimeTOF);
+    EventSorter().sortPulseTimeTof(events);
     break;
   case WEIGHTED:
-    tbb::parallel_sort(weightedEvents.begin(), weightedEvents.end(),
-                       compareEventPulseTimeTOF);
+    EventSorter().sortPulseTimeTof(weightedEvents);
     break;
   case WEIGHTED_NOTIME:
     // Do nothing; there is no time to sort
     break;
   }
+  storeRowCopy();
 
   // Save
   this->order = PULSETIMETOF_SORT;
@@ -1134,6 +1165,10 @@ void EventList::sortPulseTimeTOFDelta(const Types::Core::DateAndTime &start,
   // Avoid sorting from multiple threads
   std::lock_guard<std::mutex> _lock(m_sortMutex);
 
+  // Column-stored or compact events are sorted through their row copy
+  if (!m_hasRowCopy)
+    fillRowCopy();
+
   std::function<bool(const TofEvent &, const TofEvent &)> comparator =
       comparePulseTimeTOFDelta(start, seconds);
 
@@ -1149,6 +1184,7 @@ void EventList::sortPulseTimeTOFDelta(const Types::Core::DateAndTime &start,
     // Do nothing; there is no time to sort
     break;
   }
+  storeRowCopy();
 
   this->order = UNSORTED; // so the function always re-runs
 }
@@ -1161,6 +1197,147 @@ bool EventList::isSortedByTof() const { return (this->order == TOF_SORT); }
 /** Return the type of sorting used in this event list */
 EventSortType EventList::getSortType() const { return this->order; }
 
+// --------------------------------------------------------------------------
+/** Return how the events are laid out in memory */
+EventStorageType EventList::getStorageType() const {
+  return this->m_storageType;
+}
+
+// --------------------------------------------------------------------------
+/** Choose how the events are laid out in memory. The events are moved
+ * between the event vectors, the columns and the compact events; the sort
+ * order is kept.
+ * @param storage :: ROW_STORAGE, COLUMN_STORAGE or COMPACT_STORAGE
+ * @param pulseTimes :: for COMPACT_STORAGE, a table holding the pulse time of
+ * every event, usually shared with the other lists of the workspace. A table
+ * of this list's own pulse times is made if it is not given.
+ * @throws std::runtime_error if COMPACT_STORAGE is requested for weighted
+ * events
+ */
+void EventList::setStorageType(
+    const EventStorageType storage,
+    const std::shared_ptr<const PulseTimeTable> &pulseTimes) {
+  if (storage == m_storageType &&
+      (storage != COMPACT_STORAGE || !pulseTimes ||
+       pulseTimes == m_compact.pulseTimeTable()))
+    return;
+  if (storage == COMPACT_STORAGE && eventType != TOF)
+    throw std::runtime_error("EventList::setStorageType() called with "
+                             "COMPACT_STORAGE on an EventList with weights. "
+                             "Only TofEvent's can be held compactly.");
+
+  this->ensureRowStorage();
+  switch (storage) {
+  case ROW_STORAGE:
+    return;
+  case COLUMN_STORAGE:
+    switch (eventType) {
+    case TOF:
+      m_columns.assign(events);
+      break;
+    case WEIGHTED:
+      m_columns.assign(weightedEvents);
+      break;
+    case WEIGHTED_NOTIME:
+      m_columns.assign(weightedEventsNoTime);
+      break;
+    }
+    break;
+  case COMPACT_STORAGE:
+    m_compact.assign(events, pulseTimes
+                                 ? pulseTimes
+                                 : CompactEvents::makePulseTimeTable(events));
+    break;
+  }
+  std::vector<TofEvent>().swap(this->events);
+  std::vector<WeightedEvent>().swap(this->weightedEvents);
+  std::vector<WeightedEventNoTime>().swap(this->weightedEventsNoTime);
+  m_storageType = storage;
+}
+
+// --------------------------------------------------------------------------
+/** Move column-stored or compact events back into the event vectors so that
+ * code modifying TofEvent/WeightedEvent objects can be used.
+ */
+void EventList::ensureRowStorage() {
+  if (m_storageType == ROW_STORAGE)
+    return;
+
+  if (!m_hasRowCopy)
+    fillRowCopy();
+  m_columns.clear();
+  m_compact.clear();
+  m_hasRowCopy = false;
+  m_storageType = ROW_STORAGE;
+}
+
+/** Fill the event vectors with a copy of the column-stored or compact events
+ * so that const code reading TofEvent/WeightedEvent objects can be used. The
+ * storage type is unchanged and the columns stay valid, so other threads can
+ * keep histogramming from them. Like the sorting methods this is protected by
+ * the sort mutex.
+ */
+void EventList::makeRowCopy() const {
+  if (m_storageType == ROW_STORAGE || m_hasRowCopy)
+    return;
+
+  std::lock_guard<std::mutex> _lock(m_sortMutex);
+  // Another thread may have done the work while we waited for the lock
+  if (!m_hasRowCopy)
+    fillRowCopy();
+}
+
+/// Fill the row copy of the events. The sort mutex must be held.
+void EventList::fillRowCopy() const {
+  if (m_storageType == COMPACT_STORAGE) {
+    m_compact.extract(events);
+  } else if (m_storageType == COLUMN_STORAGE) {
+    switch (eventType) {
+    case TOF:
+      m_columns.extract(events);
+      break;
+    case WEIGHTED:
+      m_columns.extract(weightedEvents);
+      break;
+    case WEIGHTED_NOTIME:
+      m_columns.extract(weightedEventsNoTime);
+      break;
+    }
+  }
+  m_hasRowCopy = m_storageType != ROW_STORAGE;
+}
+
+/** Write the row copy back to the columns or the compact events, after it was
+ * reordered by a sort. The sort mutex must be held.
+ */
+void EventList::storeRowCopy() const {
+  if (m_storageType == COMPACT_STORAGE) {
+    m_compact.assign(events, m_compact.pulseTimeTable());
+  } else if (m_storageType == COLUMN_STORAGE) {
+    switch (eventType) {
+    case TOF:
+      m_columns.assign(events);
+      break;
+    case WEIGHTED:
+      m_columns.assign(weightedEvents);
+      break;
+    case WEIGHTED_NOTIME:
+      m_columns.assign(weightedEventsNoTime);
+      break;
+    }
+  }
+}
+
+/// Release the row copy before the columns or compact events are modified
+void EventList::dropRowCopy() {
+  if (!m_hasRowCopy)
+    return;
+  std::vector<TofEvent>().swap(this->events);
+  std::vector<WeightedEvent>().swap(this->weightedEvents);
+  std::vector<WeightedEventNoTime>().swap(this->weightedEventsNoTime);
+  m_hasRowCopy = false;
+}
+
 // --------------------------------------------------------------------------
 /** Reverse the histogram boundaries and the associated events if they are
  * sorted
@@ -1173,7 +1350,12 @@ void EventList::reverse() {
   std::reverse(x.begin(), x.end());
 
   // flip the events if they are tof sorted
-  if (this->isSortedByTof()) {
+  this->dropRowCopy();
+  if (this->isSortedByTof() && m_storageType == COLUMN_STORAGE) {
+    m_columns.reverse();
+  } else if (this->isSortedByTof() && m_storageType == COMPACT_STORAGE) {
+    m_compact.reverse();
+  } else if (this->isSortedByTof()) {
     switch (eventType) {
     case TOF:
       std::reverse(this->events.begin(), this->events.end());
@@ -1200,6 +1382,10 @@ void EventList::reverse() {
  * @return the number of events in the list.
  *  */
 size_t EventList::getNumberEvents() const {
+  if (m_storageType == COLUMN_STORAGE)
+    return m_columns.size();
+  if (m_storageType == COMPACT_STORAGE)
+    return m_compact.size();
   switch (eventType) {
   case TOF:
     return this->events.size();
@@ -1215,6 +1401,10 @@ size_t EventList::getNumberEvents() const {
  * Much like stl containers, returns true if there is nothing in the event list.
  */
 bool EventList::empty() const {
+  if (m_storageType == COLUMN_STORAGE)
+    return m_columns.empty();
+  if (m_storageType == COMPACT_STORAGE)
+    return m_compact.empty();
   switch (eventType) {
   case TOF:
     return this->events.empty();
@@ -1234,17 +1424,26 @@ bool EventList::empty() const {
  * @return :: the memory used by the EventList, in bytes.
  * */
 size_t EventList::getMemorySize() const {
+  size_t rows = 0;
   switch (eventType) {
   case TOF:
-    return this->events.capacity() * sizeof(TofEvent) + sizeof(EventList);
+    rows = this->events.capacity() * sizeof(TofEvent);
+    break;
   case WEIGHTED:
-    return this->weightedEvents.capacity() * sizeof(WeightedEvent) +
-           sizeof(EventList);
+    rows = this->weightedEvents.capacity() * sizeof(WeightedEvent);
+    break;
   case WEIGHTED_NOTIME:
-    return this->weightedEventsNoTime.capacity() * sizeof(WeightedEventNoTime) +
-           sizeof(EventList);
+    rows = this->weightedEventsNoTime.capacity() * sizeof(WeightedEventNoTime);
+    break;
+  default:
+    throw std::runtime_error("EventList: invalid event type value was found.");
   }
-  throw std::runtime_error("EventList: invalid event type value was found.");
+  // Column-stored and compact lists may also hold a row copy for readers
+  if (m_storageType == COLUMN_STORAGE)
+    return m_columns.getMemorySize() + rows + sizeof(EventList);
+  if (m_storageType == COMPACT_STORAGE)
+    return m_compact.getMemorySize() + rows + sizeof(EventList);
+  return rows + sizeof(EventList);
 }
 
 // --------------------------------------------------------------------------
@@ -1761,6 +1960,8 @@ inline void EventList::compressFatEventsHelper(
  *be == this.
  */
 void EventList::compressEvents(double tolerance, EventList *destination) {
+  this->ensureRowStorage();
+  destination->ensureRowStorage();
   if (!this->empty()) {
     this->sortTof();
     switch (eventType) {
@@ -1817,6 +2018,8 @@ void EventList::compressEvents(double tolerance, EventList *destination) {
 void EventList::compressFatEvents(
     const double tolerance, const Mantid::Types::Core::DateAndTime &timeStart,
     const double seconds, EventList *destination) {
+  this->ensureRowStorage();
+  destination->ensureRowStorage();
 
   // only worry about non-empty EventLists
   if (!this->empty()) {
@@ -1944,101 +2147,6 @@ typename std::vector<T>::iterator static findFirstEvent(std::vector<T> &events,
                           [seek_tof](const T &x) { return x < seek_tof; });
 }
 
-// --------------------------------------------------------------------------
-/** Generates both the Y and E (error) histograms
- * for an EventList with WeightedEvents.
- *
- * @param events: vector of events (with weights)
- * @param X: X-bins supplied
- * @param Y: counts returned
- * @param E: errors returned
- * @throw runtime_error if the EventList does not have weighted events
- */
-template <class T>
-void EventList::histogramForWeightsHelper(const std::vector<T> &events,
-                                          const MantidVec &X, MantidVec &Y,
-                                          MantidVec &E) {
-  // For slight speed=up.
-  size_t x_size = X.size();
-
-  if (x_size <= 1) {
-    // X was not set. Return an empty array.
-    Y.resize(0, 0);
-    return;
-  }
-
-  // If the sizes are the same, then the "resize" command will NOT clear the
-  // original values.
-  bool mustFill = (Y.size() == x_size - 1);
-  // Clear the Y data, assign all to 0.
-  Y.resize(x_size - 1, 0.0);
-  // Clear the Error data, assign all to 0.
-  // Note: Errors will be squared until the last step.
-  E.resize(x_size - 1, 0.0);
-
-  if (mustFill) {
-    // We must make sure the starting point is 0.0
-    std::fill(Y.begin(), Y.end(), 0.0);
-    std::fill(E.begin(), E.end(), 0.0);
-  }
-
-  //---------------------- Histogram without weights
-  //---------------------------------
-
-  // Do we even have any events to do?
-  if (!events.empty()) {
-    // Iterate through all events (sorted by tof)
-    auto itev = findFirstEvent(events, T(X[0]));
-    auto itev_end = events.cend();
-    // The above can still take you to end() if no events above X[0], so check
-    // again.
-    if (itev == itev_end)
-      return;
-
-    // Find the first bin
-    size_t bin = 0;
-    // The tof is greater the first bin boundary, so we need to find the first
-    // bin
-    double tof = itev->tof();
-    while (bin < x_size - 1) {
-      // Within range?
-      if ((tof >= X[bin]) && (tof < X[bin + 1])) {
-        // Add up the weight (convert to double before adding, to preserve
-        // precision)
-        Y[bin] += double(itev->m_weight);
-        E[bin] += double(itev->m_errorSquared); // square of error
-        break;
-      }
-      ++bin;
-    }
-    // Go to the next event, we've already binned this first one.
-    ++itev;
-
-    // Keep going through all the events
-    while ((itev != itev_end) && (bin < x_size - 1)) {
-      tof = itev->tof();
-      while (bin < x_size - 1) {
-        // Within range? Since both events and X are sorted, they are going to
-        // have
-        // tof >= X[bin] because the previous event was.
-        if (tof < X[bin + 1]) {
-          // Add up the weight (convert to double before adding, to preserve
-          // precision)
-          Y[bin] += double(itev->m_weight);
-          E[bin] += double(itev->m_errorSquared); // square of error
-          break;
-        }
-        ++bin;
-      }
-      ++itev;
-    }
-  } // end if (there are any events to histogram)
-
-  // Now do the sqrt of all errors
-  std::transform(E.begin(), E.end(), E.begin(),
-                 static_cast<double (*)(double)>(sqrt));
-}
-
 // --------------------------------------------------------------------------
 /** Generates both the Y and E (error) histograms w.r.t Pulse Time
  * for an EventList with or without WeightedEvents.
@@ -2051,6 +2159,15 @@ void EventList::histogramForWeightsHelper(const std::vector<T> &events,
  */
 void EventList::generateHistogramPulseTime(const MantidVec &X, MantidVec &Y,
                                            MantidVec &E, bool skipError) const {
+  if (m_storageType == COMPACT_STORAGE) {
+    // No need to sort, the bin edges are turned into pulse indices
+    m_compact.histogramPulseTime(X, Y);
+    if (!skipError)
+      this->generateErrorsHistogram(Y, E);
+    return;
+  }
+
+  this->makeRowCopy();
   // All types of weights need to be sorted by Pulse Time
   this->sortPulseTime();
 
@@ -2088,6 +2205,7 @@ void EventList::generateHistogramTimeAtSample(const MantidVec &X, MantidVec &Y,
                                               const double &tofFactor,
                                               const double &tofOffset,
                                               bool skipError) const {
+  this->makeRowCopy();
   // All types of weights need to be sorted by time at sample
   this->sortTimeAtSample(tofFactor, tofOffset);
 
@@ -2125,6 +2243,15 @@ void EventList::generateHistogram(const MantidVec &X, MantidVec &Y,
 
   this->sortTof();
 
+  if (m_storageType == COLUMN_STORAGE) {
+    m_columns.histogram(X, Y, E, skipError);
+    return;
+  }
+  if (m_storageType == COMPACT_STORAGE) {
+    m_compact.histogram(X, Y, E, skipError);
+    return;
+  }
+
   switch (eventType) {
   case TOF:
     // Make the single ones
@@ -2134,11 +2261,11 @@ void EventList::generateHistogram(const MantidVec &X, MantidVec &Y,
     break;
 
   case WEIGHTED:
-    histogramForWeightsHelper(this->weightedEvents, X, Y, E);
+    EventHistogrammer(X).sumWeights(this->weightedEvents, true, Y, E);
     break;
 
   case WEIGHTED_NOTIME:
-    histogramForWeightsHelper(this->weightedEventsNoTime, X, Y, E);
+    EventHistogrammer(X).sumWeights(this->weightedEventsNoTime, true, Y, E);
     break;
   }
 }
@@ -2231,6 +2358,7 @@ void EventList::generateCountsHistogramPulseTime(const double &xMin,
                                                  MantidVec &Y,
                                                  const double TOF_min,
                                                  const double TOF_max) const {
+  this->makeRowCopy();
 
   if (this->events.empty())
     return;
@@ -2344,32 +2472,10 @@ void EventList::generateCountsHistogram(const MantidVec &X,
     return;
   }
 
+  this->makeRowCopy();
   // Sort the events by tof
   this->sortTof();
-  // Clear the Y data, assign all to 0.
-  Y.resize(x_size - 1, 0);
-
-  //---------------------- Histogram without weights
-  //---------------------------------
-
-  // Do we even have any events to do?
-  if (!this->events.empty()) {
-    // Iterate through all events (sorted by tof) placing them in the correct
-    // bin.
-    auto itev = findFirstEvent(this->events, TofEvent(X[0]));
-    // Go through all the events,
-    for (auto itx = X.cbegin(); itev != events.end(); ++itev) {
-      double tof = itev->tof();
-      itx = std::find_if(itx, X.cend(),
-                         [tof](const double x) { return tof < x; });
-      if (itx == X.cend()) {
-        break;
-      }
-      auto bin =
-          std::max(std::distance(X.cbegin(), itx) - 1, std::ptrdiff_t{0});
-      ++Y[bin];
-    }
-  } // end if (there are any events to histogram)
+  EventHistogrammer(X).countEvents(this->events, true, Y);
 }
 
 // --------------------------------------------------------------------------
@@ -2484,6 +2590,7 @@ double EventList::integrate(const double minX, const double maxX,
 void EventList::integrate(const double minX, const double maxX,
                           const bool entireRange, double &sum,
                           double &error) const {
+  this->makeRowCopy();
   sum = 0;
   error = 0;
   if (!entireRange) {
@@ -2535,6 +2642,17 @@ void EventList::convertTof(std::function<double(double)> func,
   if (this->getNumberEvents() <= 0)
     return;
 
+  this->dropRowCopy();
+  if (m_storageType == COLUMN_STORAGE) {
+    auto &tofs = m_columns.tofs();
+    std::transform(tofs.begin(), tofs.end(), tofs.begin(), func);
+    return;
+  }
+  if (m_storageType == COMPACT_STORAGE) {
+    m_compact.convertTof(func);
+    return;
+  }
+
   // Convert the list
   switch (eventType) {
   case TOF:
@@ -2579,6 +2697,16 @@ void EventList::convertTof(const double factor, const double offset) {
   if (this->getNumberEvents() <= 0)
     return;
 
+  this->dropRowCopy();
+  if (m_storageType == COLUMN_STORAGE) {
+    m_columns.convertTof(factor, offset);
+    return;
+  }
+  if (m_storageType == COMPACT_STORAGE) {
+    m_compact.convertTof(factor, offset);
+    return;
+  }
+
   // Convert the list
   switch (eventType) {
   case TOF:
@@ -2665,6 +2793,7 @@ void EventList::addPulsetimesHelper(std::vector<T> &events,
  * @param seconds :: The value to shift the pulsetime by, in seconds
  */
 void EventList::addPulsetime(const double seconds) {
+  this->ensureRowStorage();
   if (this->getNumberEvents() <= 0)
     return;
 
@@ -2690,6 +2819,7 @@ void EventList::addPulsetime(const double seconds) {
  * @param seconds :: A set of values to shift the pulsetime by, in seconds
  */
 void EventList::addPulsetimes(const std::vector<double> &seconds) {
+  this->ensureRowStorage();
   if (this->getNumberEvents() <= 0)
     return;
   if (this->getNumberEvents() != seconds.size()) {
@@ -2760,6 +2890,7 @@ std::size_t EventList::maskTofHelper(std::vector<T> &events,
  * @param tofMax :: upper bound of TOF to filter out
  */
 void EventList::maskTof(const double tofMin, const double tofMax) {
+  this->ensureRowStorage();
   if (tofMax <= tofMin)
     throw std::runtime_error("EventList::maskTof: tofMax must be > tofMin");
 
@@ -2830,6 +2961,7 @@ std::size_t EventList::maskConditionHelper(std::vector<T> &events,
  * @param mask :: condition vector
  */
 void EventList::maskCondition(const std::vector<bool> &mask) {
+  this->ensureRowStorage();
 
   // mask size must match the number of events
   if (this->getNumberEvents() != mask.size())
@@ -2879,6 +3011,15 @@ void EventList::getTofsHelper(const std::vector<T> &events,
  *  @param tofs :: A reference to the vector to be filled
  */
 void EventList::getTofs(std::vector<double> &tofs) const {
+  if (m_storageType == COLUMN_STORAGE) {
+    tofs.assign(m_columns.tofs().cbegin(), m_columns.tofs().cend());
+    return;
+  }
+  if (m_storageType == COMPACT_STORAGE) {
+    m_compact.getTofs(tofs);
+    return;
+  }
+
   // Set the capacity of the vector to avoid multiple resizes
   tofs.reserve(this->getNumberEvents());
 
@@ -2925,6 +3066,16 @@ void EventList::getWeightsHelper(const std::vector<T> &events,
  *  @param weights :: A reference to the vector to be filled
  */
 void EventList::getWeights(std::vector<double> &weights) const {
+  if (eventType == TOF) {
+    // not a weighted event type, return 1.0 for all.
+    weights.assign(this->getNumberEvents(), 1.0);
+    return;
+  }
+  if (m_storageType == COLUMN_STORAGE) {
+    weights.assign(m_columns.weights().cbegin(), m_columns.weights().cend());
+    return;
+  }
+  this->makeRowCopy();
   // Set the capacity of the vector to avoid multiple resizes
   weights.reserve(this->getNumberEvents());
 
@@ -2973,6 +3124,21 @@ void EventList::getWeightErrorsHelper(const std::vector<T> &events,
  *  @param weightErrors :: A reference to the vector to be filled
  */
 void EventList::getWeightErrors(std::vector<double> &weightErrors) const {
+  if (eventType == TOF) {
+    // not a weighted event type, return 1.0 for all.
+    weightErrors.assign(this->getNumberEvents(), 1.0);
+    return;
+  }
+  if (m_storageType == COLUMN_STORAGE) {
+    const auto &errorSquared = m_columns.errorSquared();
+    weightErrors.resize(errorSquared.size());
+    std::transform(errorSquared.cbegin(), errorSquared.cend(),
+                   weightErrors.begin(), [](const float error2) {
+                     return std::sqrt(static_cast<double>(error2));
+                   });
+    return;
+  }
+  this->makeRowCopy();
   // Set the capacity of the vector to avoid multiple resizes
   weightErrors.reserve(this->getNumberEvents());
 
@@ -3023,6 +3189,16 @@ void EventList::getPulseTimesHelper(
  */
 std::vector<Mantid::Types::Core::DateAndTime> EventList::getPulseTimes() const {
   std::vector<Mantid::Types::Core::DateAndTime> times;
+  if (m_storageType == COMPACT_STORAGE) {
+    m_compact.getPulseTimes(times);
+    return times;
+  }
+  if (m_storageType == COLUMN_STORAGE && m_columns.hasPulseTimes()) {
+    const auto &pulseTimes = m_columns.pulseTimes();
+    times.assign(pulseTimes.cbegin(), pulseTimes.cend());
+    return times;
+  }
+  this->makeRowCopy();
   // Set the capacity of the vector to avoid multiple resizes
   times.reserve(this->getNumberEvents());
 
@@ -3053,6 +3229,23 @@ double EventList::getTofMin() const {
   if (this->empty())
     return tMin;
 
+  if (m_storageType == COLUMN_STORAGE) {
+    const auto &tofs = m_columns.tofs();
+    return this->order == TOF_SORT
+               ? tofs.front()
+               : *std::min_element(tofs.cbegin(), tofs.cend());
+  }
+  if (m_storageType == COMPACT_STORAGE) {
+    const auto &compact = m_compact.events();
+    if (this->order == TOF_SORT)
+      return compact.front().tof;
+    return std::min_element(compact.cbegin(), compact.cend(),
+                            [](const CompactEvent &a, const CompactEvent &b) {
+                              return a.tof < b.tof;
+                            })
+        ->tof;
+  }
+
   // when events are ordered by tof just need the first value
   if (this->order == TOF_SORT) {
     switch (eventType) {
@@ -3097,6 +3290,23 @@ double EventList::getTofMax() const {
   if (this->empty())
     return tMax;
 
+  if (m_storageType == COLUMN_STORAGE) {
+    const auto &tofs = m_columns.tofs();
+    return this->order == TOF_SORT
+               ? tofs.back()
+               : *std::max_element(tofs.cbegin(), tofs.cend());
+  }
+  if (m_storageType == COMPACT_STORAGE) {
+    const auto &compact = m_compact.events();
+    if (this->order == TOF_SORT)
+      return compact.back().tof;
+    return std::max_element(compact.cbegin(), compact.cend(),
+                            [](const CompactEvent &a, const CompactEvent &b) {
+                              return a.tof < b.tof;
+                            })
+        ->tof;
+  }
+
   // when events are ordered by tof just need the first value
   if (this->order == TOF_SORT) {
     switch (eventType) {
@@ -3135,6 +3345,9 @@ double EventList::getTofMax() const {
  * @return The minimum tof value for the list of the events.
  */
 DateAndTime EventList::getPulseTimeMin() const {
+  if (m_storageType == COMPACT_STORAGE)
+    return m_compact.getPulseTimeMin();
+  this->makeRowCopy();
   // set up as the maximum available date time.
   DateAndTime tMin = DateAndTime::maximum();
 
@@ -3179,6 +3392,9 @@ DateAndTime EventList::getPulseTimeMin() const {
  * @return The maximum tof value for the list of events.
  */
 DateAndTime EventList::getPulseTimeMax() const {
+  if (m_storageType == COMPACT_STORAGE)
+    return m_compact.getPulseTimeMax();
+  this->makeRowCopy();
   // set up as the minimum available date time.
   DateAndTime tMax = DateAndTime::minimum();
 
@@ -3222,6 +3438,12 @@ DateAndTime EventList::getPulseTimeMax() const {
 void EventList::getPulseTimeMinMax(
     Mantid::Types::Core::DateAndTime &tMin,
     Mantid::Types::Core::DateAndTime &tMax) const {
+  if (m_storageType == COMPACT_STORAGE) {
+    tMin = m_compact.getPulseTimeMin();
+    tMax = m_compact.getPulseTimeMax();
+    return;
+  }
+  this->makeRowCopy();
   // set up as the minimum available date time.
   tMax = DateAndTime::minimum();
   tMin = DateAndTime::maximum();
@@ -3272,6 +3494,7 @@ void EventList::getPulseTimeMinMax(
 
 DateAndTime EventList::getTimeAtSampleMax(const double &tofFactor,
                                           const double &tofOffset) const {
+  this->makeRowCopy();
   // set up as the minimum available date time.
   DateAndTime tMax = DateAndTime::minimum();
 
@@ -3319,6 +3542,7 @@ DateAndTime EventList::getTimeAtSampleMax(const double &tofFactor,
 
 DateAndTime EventList::getTimeAtSampleMin(const double &tofFactor,
                                           const double &tofOffset) const {
+  this->makeRowCopy();
   // set up as the minimum available date time.
   DateAndTime tMin = DateAndTime::maximum();
 
@@ -3391,6 +3615,7 @@ void EventList::setTofsHelper(std::vector<T> &events,
  * @param tofs :: The vector of doubles to set the tofs to.
  */
 void EventList::setTofs(const MantidVec &tofs) {
+  this->ensureRowStorage();
   this->order = UNSORTED;
 
   // Convert the list
@@ -3493,6 +3718,7 @@ EventList &EventList::operator*=(const double value) {
  * @param error: error on 'value'. Can be 0.
  */
 void EventList::multiply(const double value, const double error) {
+  this->ensureRowStorage();
   // Do nothing if multiplying by exactly one and there is no error
   if ((value == 1.0) && (error == 0.0))
     return;
@@ -3621,6 +3847,7 @@ void EventList::multiplyHistogramHelper(std::vector<T> &events,
  */
 void EventList::multiply(const MantidVec &X, const MantidVec &Y,
                          const MantidVec &E) {
+  this->ensureRowStorage();
   switch (eventType) {
   case TOF:
     // Switch to weights if needed.
@@ -3761,6 +3988,7 @@ void EventList::divideHistogramHelper(std::vector<T> &events,
  */
 void EventList::divide(const MantidVec &X, const MantidVec &Y,
                        const MantidVec &E) {
+  this->ensureRowStorage();
   switch (eventType) {
   case TOF:
     // Switch to weights if needed.
@@ -3898,10 +4126,25 @@ void EventList::filterByPulseTime(DateAndTime start, DateAndTime stop,
     throw std::invalid_argument("In-place filtering is not allowed");
   }
 
+  if (m_storageType == COMPACT_STORAGE) {
+    // Compare pulse indices, which needs no sorting. The output stays compact.
+    output.clear();
+    output.switchTo(eventType);
+    output.setDetectorIDs(this->getDetectorIDs());
+    output.setHistogram(m_histogram);
+    m_compact.filterByPulseTime(start, stop, output.m_compact);
+    output.m_storageType = COMPACT_STORAGE;
+    output.setSortOrder(this->order);
+    return;
+  }
+
+  this->makeRowCopy();
+
   // Start by sorting the event list by pulse time.
   this->sortPulseTime();
   // Clear the output
   output.clear();
+  output.ensureRowStorage();
   // Has to match the given type
   output.switchTo(eventType);
   output.setDetectorIDs(this->getDetectorIDs());
@@ -3928,6 +4171,7 @@ void EventList::filterByTimeAtSample(Types::Core::DateAndTime start,
                                      Types::Core::DateAndTime stop,
                                      double tofFactor, double tofOffset,
                                      EventList &output) const {
+  this->makeRowCopy();
   if (this == &output) {
     throw std::invalid_argument("In-place filtering is not allowed");
   }
@@ -3936,6 +4180,7 @@ void EventList::filterByTimeAtSample(Types::Core::DateAndTime start,
   this->sortTimeAtSample(tofFactor, tofOffset);
   // Clear the output
   output.clear();
+  output.ensureRowStorage();
   // Has to match the given type
   output.switchTo(eventType);
   output.setDetectorIDs(this->getDetectorIDs());
@@ -4043,6 +4288,7 @@ void EventList::filterInPlaceHelper(Kernel::TimeSplitterType &splitter,
  *     that will be kept. Any other events will be deleted.
  */
 void EventList::filterInPlace(Kernel::TimeSplitterType &splitter) {
+  this->ensureRowStorage();
   // Start by sorting the event list by pulse time.
   this->sortPulseTime();
 
@@ -4134,6 +4380,7 @@ void EventList::splitByTimeHelper(Kernel::TimeSplitterType &splitter,
  */
 void EventList::splitByTime(Kernel::TimeSplitterType &splitter,
                             std::vector<EventList *> outputs) const {
+  this->makeRowCopy();
   if (eventType == WEIGHTED_NOTIME)
     throw std::runtime_error("EventList::splitByTime() called on an EventList "
                              "that no longer has time information.");
@@ -4145,6 +4392,7 @@ void EventList::splitByTime(Kernel::TimeSplitterType &splitter,
   size_t numOutputs = outputs.size();
   for (size_t i = 0; i < numOutputs; i++) {
     outputs[i]->clear();
+    outputs[i]->ensureRowStorage();
     outputs[i]->setDetectorIDs(this->getDetectorIDs());
     outputs[i]->setHistogram(m_histogram);
     // Match the output event type.
@@ -4168,15 +4416,13 @@ void EventList::splitByTime(Kernel::TimeSplitterType &splitter,
 }
 
 //------------------------------------------------------------------------------------------------
-/** Split the event list into n outputs, operating on a vector of either
- *TofEvent's or WeightedEvent's
- *  The comparison between neutron event and splitter is based on neutron
- *event's pulse time plus
+/** Split the events of a vector of either TofEvent's or WeightedEvent's
+ * between the outputs with an EventSplitter. The outputs keep the sort order
+ * of this list.
  *
- * @param splitter :: a TimeSplitterType giving where to split
- * @param outputs :: a vector of where the split events will end up. The # of
- *entries in there should
- *        be big enough to accommodate the indices.
+ * @param splitter :: gives the output of each event
+ * @param outputs :: the outputs, indexed like the destinations of the
+ * splitter; already cleared and of the type of this list
  * @param events :: either this->events or this->weightedEvents.
  * @param docorrection :: flag to determine whether or not to apply correction
  * @param toffactor :: factor to correct TOF in formula toffactor*tof+tofshift
@@ -4184,79 +4430,76 @@ void EventList::splitByTime(Kernel::TimeSplitterType &splitter,
  *toffactor*tof+tofshift
  */
 template <class T>
-void EventList::splitByFullTimeHelper(Kernel::TimeSplitterType &splitter,
-                                      std::map<int, EventList *> outputs,
-                                      typename std::vector<T> &events,
+void EventList::splitByFullTimeHelper(const EventSplitter &splitter,
+                                      const std::vector<EventList *> &outputs,
+                                      const std::vector<T> &events,
                                       bool docorrection, double toffactor,
                                       double tofshift) const {
-  // 1. Prepare to Iterate through the splitter at the same time
-  auto itspl = splitter.begin();
-  auto itspl_end = splitter.end();
-
-  // 2. Prepare to Iterate through all events (sorted by tof)
-  auto itev = events.begin();
-  auto itev_end = events.end();
-
-  // 3. This is the time of the first section. Anything before is thrown out.
-  while (itspl != itspl_end) {
-    // Get the splitting interval times and destination
-    int64_t start = itspl->start().totalNanoseconds();
-    int64_t stop = itspl->stop().totalNanoseconds();
-    const int index = itspl->index();
-
-    // a) Skip the events before the start of the time
-    // TODO This step can be
-    EventList *myOutput = outputs[-1];
-    while (itev != itev_end) {
-      int64_t fulltime;
-      if (docorrection)
-        fulltime = calculateCorrectedFullTime(*itev, toffactor, tofshift);
-      else
-        fulltime = itev->m_pulsetime.totalNanoseconds() +
-                   static_cast<int64_t>(itev->m_tof * 1000);
-      if (fulltime < start) {
-        // a1) Record to index = -1 space
-        const T eventCopy(*itev);
-        myOutput->addEventQuickly(eventCopy);
-        itev++;
-      } else {
-        break;
-      }
-    }
-
-    // b) Go through all the events that are in the interval (if any)
-    while (itev != itev_end) {
-      int64_t fulltime;
-      if (docorrection)
-        fulltime = itev->m_pulsetime.totalNanoseconds() +
-                   static_cast<int64_t>(toffactor * itev->m_tof * 1000 +
-                                        tofshift * 1.0E9);
-      else
-        fulltime = itev->m_pulsetime.totalNanoseconds() +
-                   static_cast<int64_t>(itev->m_tof * 1000);
-      if (fulltime < stop) {
-        // b1) Add a copy to the output
-        outputs[index]->addEventQuickly(*itev);
-        ++itev;
-      } else {
-        break;
-      }
-    }
-
-    // Go to the next interval
-    ++itspl;
-    // But if we reached the end, then we are done.
-    if (itspl == itspl_end)
-      break;
+  std::vector<std::vector<T> *> outputEvents(outputs.size());
+  for (size_t i = 0; i < outputs.size(); ++i)
+    getEventsFrom(*outputs[i], outputEvents[i]);
+  splitter.split(events, outputEvents, docorrection, toffactor, tofshift);
+  for (auto *output : outputs)
+    output->order = this->order;
+}
+
+/** Clear the outputs of a split and give them the type, detector IDs and X
+ * of this list
+ * @param outputs :: a map of where the split events will end up
+ * @return the outputs that are set, and the index of each in that vector
+ */
+std::pair<std::vector<EventList *>, std::map<int, int>>
+EventList::prepareSplitOutputs(
+    const std::map<int, EventList *> &outputs) const {
+  std::vector<EventList *> lists;
+  std::map<int, int> indices;
+  for (const auto &output : outputs) {
+    EventList *opeventlist = output.second;
+    if (!opeventlist)
+      continue;
+    opeventlist->clear();
+    opeventlist->ensureRowStorage();
+    opeventlist->setDetectorIDs(this->getDetectorIDs());
+    opeventlist->setHistogram(m_histogram);
+    // Match the output event type.
+    opeventlist->switchTo(eventType);
+    indices.emplace(output.first, static_cast<int>(lists.size()));
+    lists.emplace_back(opeventlist);
+  }
+  return {lists, indices};
+}
 
-    // No need to keep looping through the filter if we are out of events
-    if (itev == itev_end)
-      break;
-  } // END-WHILE Splitter
+/** Split the events between outputs with an EventSplitter
+ * @param splitter :: gives the output of each event
+ * @param outputs :: the outputs, indexed like the destinations of the
+ * splitter
+ * @param docorrection :: flag to determine whether or not to apply correction
+ * @param toffactor :: factor to correct TOF
+ * @param tofshift :: amount to shift (in SECOND) to correct TOF
+ */
+void EventList::splitByFullTimeWith(const EventSplitter &splitter,
+                                    const std::vector<EventList *> &outputs,
+                                    bool docorrection, double toffactor,
+                                    double tofshift) const {
+  switch (eventType) {
+  case TOF:
+    splitByFullTimeHelper(splitter, outputs, this->events, docorrection,
+                          toffactor, tofshift);
+    break;
+  case WEIGHTED:
+    splitByFullTimeHelper(splitter, outputs, this->weightedEvents,
+                          docorrection, toffactor, tofshift);
+    break;
+  case WEIGHTED_NOTIME:
+    break;
+  }
 }
 
 //------------------------------------------------------------------------------------------------
 /** Split the event list into n outputs by event's full time (tof + pulse time)
+ *
+ * Events before the first splitting interval, or between two intervals, go to
+ * output -1; events after the last interval are dropped.
  *
  * @param splitter :: a TimeSplitterType giving where to split
  * @param outputs :: a map of where the split events will end up. The # of
@@ -4271,6 +4514,7 @@ void EventList::splitByFullTime(Kernel::TimeSplitterType &splitter,
                                 std::map<int, EventList *> outputs,
                                 bool docorrection, double toffactor,
                                 double tofshift) const {
+  this->makeRowCopy();
   if (eventType == WEIGHTED_NOTIME)
     throw std::runtime_error("EventList::splitByTime() called on an EventList "
                              "that no longer has time information.");
@@ -4279,229 +4523,72 @@ void EventList::splitByFullTime(Kernel::TimeSplitterType &splitter,
   this->sortPulseTimeTOF();
 
   // 2. Initialize all the outputs
-  std::map<int, EventList *>::iterator outiter;
-  for (outiter = outputs.begin(); outiter != outputs.end(); ++outiter) {
-    EventList *opeventlist = outiter->second;
-    opeventlist->clear();
-    opeventlist->setDetectorIDs(this->getDetectorIDs());
-    opeventlist->setHistogram(m_histogram);
-    // Match the output event type.
-    opeventlist->switchTo(eventType);
-  }
+  const auto prepared = prepareSplitOutputs(outputs);
+  const auto outputIndex = [&prepared](const int group) {
+    const auto found = prepared.second.find(group);
+    return found == prepared.second.end() ? EventSplitter::NO_OUTPUT
+                                          : found->second;
+  };
 
   // Do nothing if there are no entries
   if (splitter.empty()) {
     // 3A. Copy all events to group workspace = -1
     (*outputs[-1]) = (*this);
     // this->duplicate(outputs[-1]);
-  } else {
-    // 3B. Split
-    switch (eventType) {
-    case TOF:
-      splitByFullTimeHelper(splitter, outputs, this->events, docorrection,
-                            toffactor, tofshift);
-      break;
-    case WEIGHTED:
-      splitByFullTimeHelper(splitter, outputs, this->weightedEvents,
-                            docorrection, toffactor, tofshift);
-      break;
-    case WEIGHTED_NOTIME:
-      break;
-    }
+    return;
   }
-}
-
-//------------------------------------------------------------------------------------------------
-/** Split the event list into n outputs, operating on a vector of either
- *TofEvent's or WeightedEvent's
- *  The comparison between neutron event and splitter is based on neutron
- *event's pulse time plus
- *
- * @param vectimes :: a vector of absolute time in nanoseconds serving as
- *boundaries of splitters
- * @param vecgroups :: a vector of integer serving as the target workspace group
- *for splitters
- * @param outputs :: a vector of where the split events will end up. The # of
- *entries in there should
- *        be big enough to accommodate the indices.
- * @param vecEvents :: either this->events or this->weightedEvents.
- * @param docorrection :: flag to determine whether or not to apply correction
- * @param toffactor :: factor multiplied to TOF for correcting event time from
- *detector to sample
- * @param tofshift :: shift in SECOND to TOF for correcting event time from
- *detector to sample
- */
-template <class T>
-std::string EventList::splitByFullTimeVectorSplitterHelper(
-    const std::vector<int64_t> &vectimes, const std::vector<int> &vecgroups,
-    std::map<int, EventList *> outputs, typename std::vector<T> &vecEvents,
-    bool docorrection, double toffactor, double tofshift) const {
-  // Define variables for events
-  // size_t numevents = events.size();
-  typename std::vector<T>::iterator eviter;
-  std::stringstream msgss;
 
-  // Loop through events
-  for (eviter = vecEvents.begin(); eviter != vecEvents.end(); ++eviter) {
-    // Obtain time of event
-    int64_t evabstimens;
-    if (docorrection)
-      evabstimens = eviter->m_pulsetime.totalNanoseconds() +
-                    static_cast<int64_t>(toffactor * eviter->m_tof * 1000 +
-                                         tofshift * 1.0E9);
-    else
-      evabstimens = eviter->m_pulsetime.totalNanoseconds() +
-                    static_cast<int64_t>(eviter->m_tof * 1000);
-
-    // Search in vector
-    int index = static_cast<int>(
-        lower_bound(vectimes.begin(), vectimes.end(), evabstimens) -
-        vectimes.begin());
-    int group;
-    // FIXME - whether lower_bound() equal to vectimes.size()-1 should be
-    // filtered out?
-    if (index == 0 || index > static_cast<int>(vectimes.size() - 1)) {
-      // Event is before first splitter or after last splitter.  Put to -1
-      group = -1;
-    } else {
-      group = vecgroups[index - 1];
-    }
-
-    // Copy event to the proper group
-    EventList *myOutput = outputs[group];
-    if (!myOutput) {
-      std::stringstream errss;
-      errss << "Group " << group << " has a NULL output EventList. "
-            << "\n";
-      msgss << errss.str();
-    } else {
-      const T eventCopy(*eviter);
-      myOutput->addEventQuickly(eventCopy);
+  // 3B. Turn the intervals into boundaries, the gaps going to -1.
+  // Overlapping intervals are clipped to the end of the previous one.
+  std::vector<int64_t> times{std::numeric_limits<int64_t>::min()};
+  std::vector<int> destinations;
+  for (const auto &interval : splitter) {
+    const int64_t start =
+        std::max(interval.start().totalNanoseconds(), times.back());
+    const int64_t stop = interval.stop().totalNanoseconds();
+    if (stop <= start)
+      continue;
+    if (start > times.back()) {
+      destinations.emplace_back(outputIndex(-1));
+      times.emplace_back(start);
     }
+    destinations.emplace_back(outputIndex(interval.index()));
+    times.emplace_back(stop);
   }
+  if (destinations.empty())
+    destinations.emplace_back(outputIndex(-1));
+  if (times.size() == destinations.size())
+    times.emplace_back(std::numeric_limits<int64_t>::max());
 
-  return (msgss.str());
-}
-
-//------------------------------------------------------------------------------------------------
-/** Split the event list into n outputs, operating on a vector of either
- *TofEvent's or WeightedEvent's
- *  The comparison between neutron event and splitter is based on neutron
- *event's pulse time plus
- *
- * @param vectimes :: a vector of absolute time in nanoseconds serving as
- *boundaries of splitters
- * @param vecgroups :: a vector of integer serving as the target workspace group
- *for splitters
- * @param outputs :: a vector of where the split events will end up. The # of
- *entries in there should
- *        be big enough to accommodate the indices.
- * @param vecEvents :: either this->events or this->weightedEvents.
- * @param docorrection :: flag to determine whether or not to apply correction
- * @param toffactor :: factor multiplied to TOF for correcting event time from
- *detector to sample
- * @param tofshift :: shift in SECOND to TOF for correcting event time from
- *detector to sample
- */
-template <class T>
-std::string EventList::splitByFullTimeSparseVectorSplitterHelper(
-    const std::vector<int64_t> &vectimes, const std::vector<int> &vecgroups,
-    std::map<int, EventList *> outputs, typename std::vector<T> &vecEvents,
-    bool docorrection, double toffactor, double tofshift) const {
-  // Define variables for events
-  // size_t numevents = events.size();
-  // typename std::vector<T>::iterator eviter;
-  std::stringstream msgss;
-
-  size_t num_splitters = vecgroups.size();
-  // prepare to Iterate through all events (sorted by tof)
-  auto iter_events = vecEvents.begin();
-  auto iter_events_end = vecEvents.end();
-
-  // std::stringstream debug_ss;
-  // debug_ss << "\nFilter events...:\n";
-
-  for (size_t i = 0; i < num_splitters; ++i) {
-    // get one splitter
-    int64_t start_i64 = vectimes[i];
-    int64_t stop_i64 = vectimes[i + 1];
-    int group = vecgroups[i];
-    // debug_ss << "working on splitter: " << i << " from " << start_i64 << " to
-    // " << stop_i64 << "\n";
-
-    // go over events
-    while (iter_events != iter_events_end) {
-      int64_t absolute_time;
-      if (docorrection)
-        absolute_time =
-            iter_events->m_pulsetime.totalNanoseconds() +
-            static_cast<int64_t>(toffactor * iter_events->m_tof * 1000 +
-                                 tofshift * 1.0E9);
-      else
-        absolute_time = iter_events->m_pulsetime.totalNanoseconds() +
-                        static_cast<int64_t>(iter_events->m_tof * 1000);
-
-      // debug_ss << "  event " << iter_events - vecEvents.begin() << " abs.time
-      // = " << absolute_time << "\n";
-
-      if (absolute_time < start_i64) {
-        // event occurs before the splitter. only can happen with first
-        // splitter. Then ignore and move to next
-        ++iter_events;
-        continue;
-      }
-
-      if (absolute_time < stop_i64) {
-        // in the splitter, then copy the event into another
-        const T eventCopy(*iter_events);
-        // Copy event to the proper group
-        EventList *myOutput = outputs[group];
-        if (!myOutput) {
-          // there is no such group defined. quit for this group
-          std::stringstream errss;
-          errss << "Group " << group << " has a NULL output EventList. "
-                << "\n";
-          msgss << errss.str();
-          throw std::runtime_error(errss.str());
-        }
-        // Add the copy to the output
-        myOutput->addEventQuickly(eventCopy);
-        ++iter_events;
-      } else {
-        // event occurs after the stop time, it should belonged to the next
-        // splitter
-        break;
-      }
-    } // while
-
-    // quit the loop if there is no more event left
-    if (iter_events == iter_events_end)
-      break;
-  } // for splitter
-
-  // std::cout << debug_ss.str();
-
-  return (msgss.str());
+  const EventSplitter eventSplitter(std::move(times), std::move(destinations),
+                                    EventSplitter::NO_OUTPUT);
+  splitByFullTimeWith(eventSplitter, prepared.first, docorrection, toffactor,
+                      tofshift);
 }
 
 //----------------------------------------------------------------------------------------------
 /**
  * @brief EventList::splitByFullTimeMatrixSplitter
+ *
+ * Events in the interval [vec_splitters_time[i], vec_splitters_time[i+1])
+ * go to output vecgroups[i]. When there are fewer splitters than events the
+ * events outside all the intervals are dropped, otherwise they go to output
+ * -1.
+ *
  * @param vec_splitters_time  :: vector of splitting times
  * @param vecgroups :: vector of index group for splitters
  * @param vec_outputEventList :: vector of groups of splitted events
  * @param docorrection :: flag to do TOF correction from detector to sample
  * @param toffactor :: factor multiplied to TOF for correction
  * @param tofshift :: shift to TOF in unit of SECOND for correction
- * @return
+ * @return messages about groups without an output
  */
-// TODO/FIXME/NOW - Consider to use vector to replace vec_outputEventList and
-// have an option to ignore the un-filtered events!
 std::string EventList::splitByFullTimeMatrixSplitter(
     const std::vector<int64_t> &vec_splitters_time,
     const std::vector<int> &vecgroups,
     std::map<int, EventList *> vec_outputEventList, bool docorrection,
     double toffactor, double tofshift) const {
+  this->makeRowCopy();
   // Check validity
   if (eventType == WEIGHTED_NOTIME)
     throw std::runtime_error("EventList::splitByTime() called on an EventList "
@@ -4512,59 +4599,41 @@ std::string EventList::splitByFullTimeMatrixSplitter(
   sortPulseTimeTOF();
 
   // Initialize all the output event list
-  std::map<int, EventList *>::iterator outiter;
-  for (outiter = vec_outputEventList.begin();
-       outiter != vec_outputEventList.end(); ++outiter) {
-    EventList *opeventlist = outiter->second;
-    opeventlist->clear();
-    opeventlist->setDetectorIDs(this->getDetectorIDs());
-    opeventlist->setHistogram(m_histogram);
-    // Match the output event type.
-    opeventlist->switchTo(eventType);
-  }
-
-  std::string debugmessage;
+  const auto prepared = prepareSplitOutputs(vec_outputEventList);
 
   // Do nothing if there are no entries
   if (vecgroups.empty()) {
     // Copy all events to group workspace = -1
     (*vec_outputEventList[-1]) = (*this);
     // this->duplicate(outputs[-1]);
-  } else {
-    // Split
-
-    // Try to find out which filtering algorithm to use by comparing number of
-    // splitters and number of events
-    bool sparse_splitter = vec_splitters_time.size() < this->getNumberEvents();
+    return "";
+  }
 
-    switch (eventType) {
-    case TOF:
-      if (sparse_splitter)
-        debugmessage = splitByFullTimeSparseVectorSplitterHelper(
-            vec_splitters_time, vecgroups, vec_outputEventList, this->events,
-            docorrection, toffactor, tofshift);
-      else
-        debugmessage = splitByFullTimeVectorSplitterHelper(
-            vec_splitters_time, vecgroups, vec_outputEventList, this->events,
-            docorrection, toffactor, tofshift);
-      break;
-    case WEIGHTED:
-      if (sparse_splitter)
-        debugmessage = splitByFullTimeSparseVectorSplitterHelper(
-            vec_splitters_time, vecgroups, vec_outputEventList,
-            this->weightedEvents, docorrection, toffactor, tofshift);
-      else
-        debugmessage = splitByFullTimeVectorSplitterHelper(
-            vec_splitters_time, vecgroups, vec_outputEventList,
-            this->weightedEvents, docorrection, toffactor, tofshift);
-      break;
-    case WEIGHTED_NOTIME:
-      debugmessage = "TOF type is weighted no time.  Impossible to split. ";
-      break;
+  std::stringstream msgss;
+  std::vector<int> destinations(vecgroups.size());
+  for (size_t i = 0; i < vecgroups.size(); ++i) {
+    const auto found = prepared.second.find(vecgroups[i]);
+    if (found != prepared.second.end()) {
+      destinations[i] = found->second;
+    } else {
+      destinations[i] = EventSplitter::NO_OUTPUT;
+      msgss << "Group " << vecgroups[i] << " has a NULL output EventList. "
+            << "\n";
     }
   }
 
-  return debugmessage;
+  // Keep the events outside the splitters when they are as many as the events
+  const bool sparse_splitter =
+      vec_splitters_time.size() < this->getNumberEvents();
+  const auto unfiltered = prepared.second.find(-1);
+  const int outside = (sparse_splitter || unfiltered == prepared.second.end())
+                          ? EventSplitter::NO_OUTPUT
+                          : unfiltered->second;
+
+  const EventSplitter splitter(vec_splitters_time, destinations, outside);
+  splitByFullTimeWith(splitter, prepared.first, docorrection, toffactor,
+                      tofshift);
+  return msgss.str();
 }
 
 //-------------------------------------------
@@ -4635,6 +4704,24 @@ void EventList::splitByPulseTimeHelper(Kernel::TimeSplitterType &splitter,
  */
 void EventList::splitByPulseTime(Kernel::TimeSplitterType &splitter,
                                  std::map<int, EventList *> outputs) const {
+  if (m_storageType == COMPACT_STORAGE && !splitter.empty()) {
+    // Compare pulse indices, which needs no sorting. The outputs stay compact.
+    std::map<int, CompactEvents *> compactOutputs;
+    for (auto &output : outputs) {
+      EventList *opeventlist = output.second;
+      opeventlist->clear();
+      opeventlist->setDetectorIDs(this->getDetectorIDs());
+      opeventlist->setHistogram(m_histogram);
+      opeventlist->switchTo(eventType);
+      opeventlist->setSortOrder(UNSORTED);
+      opeventlist->m_storageType = COMPACT_STORAGE;
+      compactOutputs.emplace(output.first, &opeventlist->m_compact);
+    }
+    m_compact.splitByPulseTime(splitter, compactOutputs);
+    return;
+  }
+
+  this->makeRowCopy();
   // Check for supported event type
   if (eventType == WEIGHTED_NOTIME)
     throw std::runtime_error("EventList::splitByTime() called on an EventList "
@@ -4648,6 +4735,7 @@ void EventList::splitByPulseTime(Kernel::TimeSplitterType &splitter,
   for (outiter = outputs.begin(); outiter != outputs.end(); ++outiter) {
     EventList *opeventlist = outiter->second;
     opeventlist->clear();
+    opeventlist->ensureRowStorage();
     opeventlist->setDetectorIDs(this->getDetectorIDs());
     opeventlist->setHistogram(m_histogram);
     // Match the output event type.
@@ -4680,6 +4768,7 @@ void EventList::splitByPulseTime(Kernel::TimeSplitterType &splitter,
 void EventList::splitByPulseTimeWithMatrix(
     const std::vector<int64_t> &vec_times, const std::vector<int> &vec_target,
     std::map<int, EventList *> outputs) const {
+  this->makeRowCopy();
   // Check for supported event type
   if (eventType == WEIGHTED_NOTIME)
     throw std::runtime_error("EventList::splitByTime() called on an EventList "
@@ -4693,6 +4782,7 @@ void EventList::splitByPulseTimeWithMatrix(
   for (outiter = outputs.begin(); outiter != outputs.end(); ++outiter) {
     EventList *opeventlist = outiter->second;
     opeventlist->clear();
+    opeventlist->ensureRowStorage();
     opeventlist->setDetectorIDs(this->getDetectorIDs());
     opeventlist->setHistogram(m_histogram);
     // Match the output event type.
@@ -4859,6 +4949,7 @@ void EventList::convertUnitsViaTofHelper(typename std::vector<T> &events,
  */
 void EventList::convertUnitsViaTof(Mantid::Kernel::Unit *fromUnit,
                                    Mantid::Kernel::Unit *toUnit) {
+  this->ensureRowStorage();
   // Check for initialized
   if (!fromUnit || !toUnit)
     throw std::runtime_error(
@@ -4907,6 +4998,7 @@ void EventList::convertUnitsQuicklyHelper(typename std::vector<T> &events,
  *  @param power :: the Power b to apply to the conversion
  */
 void EventList::convertUnitsQuickly(const double &factor, const double &power) {
+  this->ensureRowStorage();
   switch (eventType) {
   case TOF:
     convertUnitsQuicklyHelper(this->events, factor, power);
@@ -0,0 +1,380 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidDataObjects/EventSorter.h"
+#include "MantidDataObjects/CompactEvents.h"
+
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <new>
+
+using Mantid::Types::Event::TofEvent;
+
+namespace Mantid {
+namespace DataObjects {
+
+namespace {
+/// Lists with fewer events are sorted by comparison
+constexpr size_t MIN_EVENTS_FOR_RADIX = 2048;
+/// Lists with at least this many events are radix sorted in parallel
+constexpr size_t MIN_EVENTS_FOR_PARALLEL = 1 << 20;
+/// Smallest block of events handled by one thread of the parallel sort
+constexpr size_t MIN_BLOCK_SIZE = 1 << 16;
+
+/// Number of bytes of a key, each one being a radix sort pass
+constexpr size_t KEY_BYTES = sizeof(uint64_t);
+/// Counts of each value of a byte
+using ByteCounts = std::array<size_t, 256>;
+
+/// Map a signed integer to an unsigned one with the same order
+inline uint64_t orderedKey(const int64_t value) {
+  return static_cast<uint64_t>(value) ^ (uint64_t(1) << 63);
+}
+
+/// Map a double to an unsigned integer with the same order
+inline uint64_t orderedKey(const double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint64_t sign = uint64_t(1) << 63;
+  return (bits & sign) ? ~bits : bits | sign;
+}
+
+/// Map a float to an unsigned integer with the same order
+inline uint64_t orderedKey(const float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint32_t sign = uint32_t(1) << 31;
+  return (bits & sign) ? ~bits : bits | sign;
+}
+
+/// Sort key of the time-of-flight
+struct TofKey {
+  template <typename EventType> uint64_t operator()(const EventType &e) const {
+    return orderedKey(e.tof());
+  }
+  uint64_t operator()(const CompactEvent &e) const { return orderedKey(e.tof); }
+};
+
+/// Sort key of the pulse time
+struct PulseTimeKey {
+  template <typename EventType> uint64_t operator()(const EventType &e) const {
+    return orderedKey(e.pulseTime().totalNanoseconds());
+  }
+  uint64_t operator()(const CompactEvent &e) const { return e.pulseIndex; }
+};
+
+/// Sort key of the time at sample
+struct TimeAtSampleKey {
+  double tofFactor;
+  double tofShift;
+  template <typename EventType> uint64_t operator()(const EventType &e) const {
+    return orderedKey(calculateCorrectedFullTime(e, tofFactor, tofShift));
+  }
+};
+
+inline size_t byteOf(const uint64_t key, const size_t byte) {
+  return static_cast<size_t>((key >> (8 * byte)) & 0xff);
+}
+
+/** Count the values of every byte of the keys of a range of events
+ * @return the counts of each byte, least significant first
+ */
+template <typename EventType, typename Key>
+std::array<ByteCounts, KEY_BYTES> countBytes(const EventType *begin,
+                                             const EventType *end,
+                                             const Key &key) {
+  std::array<ByteCounts, KEY_BYTES> counts{};
+  for (auto it = begin; it != end; ++it) {
+    const auto k = key(*it);
+    for (size_t byte = 0; byte < KEY_BYTES; ++byte)
+      ++counts[byte][byteOf(k, byte)];
+  }
+  return counts;
+}
+
+/// True if every event has the same value of a byte, so it needs no pass
+inline bool isConstant(const ByteCounts &counts, const size_t numEvents) {
+  return std::any_of(counts.cbegin(), counts.cend(),
+                     [numEvents](const size_t c) { return c == numEvents; });
+}
+
+/** Allocate the scratch buffer of a radix sort, as large as the list
+ * @return false if there is not enough memory for it
+ */
+template <typename EventType>
+bool allocateBuffer(std::vector<EventType> &buffer, const size_t numEvents) {
+  try {
+    buffer.resize(numEvents);
+  } catch (const std::bad_alloc &) {
+    return false;
+  }
+  return true;
+}
+
+/** Stable least significant digit radix sort, one thread
+ * @param events :: events to sort
+ * @param key :: the sort key of an event
+ * @return false, leaving the events untouched, if there is not enough memory
+ * for the scratch buffer
+ */
+template <typename EventType, typename Key>
+bool radixSort(std::vector<EventType> &events, const Key &key) {
+  const size_t numEvents = events.size();
+  const auto counts = countBytes(events.data(), events.data() + numEvents, key);
+
+  std::vector<EventType> buffer;
+  EventType *source = events.data();
+  for (size_t byte = 0; byte < KEY_BYTES; ++byte) {
+    if (isConstant(counts[byte], numEvents))
+      continue;
+    if (buffer.empty() && !allocateBuffer(buffer, numEvents))
+      return false;
+    EventType *destination =
+        source == events.data() ? buffer.data() : events.data();
+
+    std::array<size_t, 256> offsets;
+    size_t offset = 0;
+    for (size_t value = 0; value < offsets.size(); ++value) {
+      offsets[value] = offset;
+      offset += counts[byte][value];
+    }
+    for (size_t i = 0; i < numEvents; ++i)
+      destination[offsets[byteOf(key(source[i]), byte)]++] = source[i];
+    source = destination;
+  }
+  if (source != events.data())
+    events.swap(buffer);
+  return true;
+}
+
+/** Stable least significant digit radix sort, in blocks of events handled by
+ * several threads. For each byte every block counts its values, then the
+ * blocks scatter their events to disjoint parts of the output at once.
+ * @param events :: events to sort
+ * @param key :: the sort key of an event
+ * @return false, leaving the events untouched, if there is not enough memory
+ * for the scratch buffer
+ */
+template <typename EventType, typename Key>
+bool parallelRadixSort(std::vector<EventType> &events, const Key &key) {
+  const size_t numEvents = events.size();
+  const auto numThreads =
+      static_cast<size_t>(tbb::this_task_arena::max_concurrency());
+  const size_t numBlocks =
+      std::max(size_t{1}, std::min(numThreads, numEvents / MIN_BLOCK_SIZE));
+  if (numBlocks == 1)
+    return radixSort(events, key);
+  const size_t blockSize = (numEvents + numBlocks - 1) / numBlocks;
+  const auto blockBegin = [=](const size_t block) {
+    return std::min(block * blockSize, numEvents);
+  };
+
+  // The total counts tell which bytes need a pass
+  std::vector<std::array<ByteCounts, KEY_BYTES>> blockCounts(numBlocks);
+  tbb::parallel_for(size_t{0}, numBlocks, [&](const size_t block) {
+    blockCounts[block] =
+        countBytes(events.data() + blockBegin(block),
+                   events.data() + blockBegin(block + 1), key);
+  });
+  std::array<ByteCounts, KEY_BYTES> total{};
+  for (const auto &counts : blockCounts)
+    for (size_t byte = 0; byte < KEY_BYTES; ++byte)
+      for (size_t value = 0; value < 256; ++value)
+        total[byte][value] += counts[byte][value];
+
+  std::vector<EventType> buffer;
+  EventType *source = events.data();
+  std::vector<ByteCounts> offsets(numBlocks);
+  bool firstPass = true;
+  for (size_t byte = 0; byte < KEY_BYTES; ++byte) {
+    if (isConstant(total[byte], numEvents))
+      continue;
+    if (buffer.empty() && !allocateBuffer(buffer, numEvents))
+      return false;
+    EventType *destination =
+        source == events.data() ? buffer.data() : events.data();
+
+    // After the first pass the blocks hold other events, so count again
+    if (!firstPass) {
+      tbb::parallel_for(size_t{0}, numBlocks, [&](const size_t block) {
+        auto &counts = offsets[block];
+        counts.fill(0);
+        for (size_t i = blockBegin(block); i < blockBegin(block + 1); ++i)
+          ++counts[byteOf(key(source[i]), byte)];
+      });
+    } else {
+      for (size_t block = 0; block < numBlocks; ++block)
+        offsets[block] = blockCounts[block][byte];
+    }
+    firstPass = false;
+
+    // Events of a value go after the smaller values, then after the same
+    // value from the earlier blocks, which keeps the sort stable
+    size_t offset = 0;
+    for (size_t value = 0; value < 256; ++value) {
+      for (size_t block = 0; block < numBlocks; ++block) {
+        const size_t count = offsets[block][value];
+        offsets[block][value] = offset;
+        offset += count;
+      }
+    }
+
+    tbb::parallel_for(size_t{0}, numBlocks, [&](const size_t block) {
+      auto &blockOffsets = offsets[block];
+      for (size_t i = blockBegin(block); i < blockBegin(block + 1); ++i)
+        destination[blockOffsets[byteOf(key(source[i]), byte)]++] = source[i];
+    });
+    source = destination;
+  }
+  if (source != events.data())
+    events.swap(buffer);
+  return true;
+}
+} // namespace
+
+/** Choose how to sort a list from its number of events
+ * @param numEvents :: number of events in the list
+ * @return Comparison, Radix or ParallelRadix
+ */
+EventSorter::Strategy EventSorter::chooseStrategy(const size_t numEvents) {
+  if (numEvents < MIN_EVENTS_FOR_RADIX)
+    return Strategy::Comparison;
+  if (numEvents < MIN_EVENTS_FOR_PARALLEL)
+    return Strategy::Radix;
+  return Strategy::ParallelRadix;
+}
+
+/** Sort events by a key, unless they are already in order. A radix sort
+ * that cannot get its scratch buffer falls back to std::stable_sort, which
+ * merges in place when short of memory.
+ * @param events :: events to sort
+ * @param key :: the sort key of an event
+ */
+template <typename EventType, typename Key>
+void EventSorter::sort(std::vector<EventType> &events, const Key &key) const {
+  const auto byKey = [&key](const EventType &a, const EventType &b) {
+    return key(a) < key(b);
+  };
+  if (std::is_sorted(events.cbegin(), events.cend(), byKey))
+    return;
+
+  const auto strategy = m_strategy == Strategy::Automatic
+                            ? chooseStrategy(events.size())
+                            : m_strategy;
+  bool sorted = false;
+  switch (strategy) {
+  case Strategy::Automatic:
+  case Strategy::Comparison:
+    break;
+  case Strategy::Radix:
+    sorted = radixSort(events, key);
+    break;
+  case Strategy::ParallelRadix:
+    sorted = parallelRadixSort(events, key);
+    break;
+  }
+  if (!sorted)
+    std::stable_sort(events.begin(), events.end(), byKey);
+}
+
+/** Sort events by a key, then by a second key for equal first keys
+ * @param events :: events to sort
+ * @param first :: the main sort key of an event
+ * @param second :: the sort key of events with the same main key
+ */
+template <typename EventType, typename First, typename Second>
+void EventSorter::sortByTwoKeys(std::vector<EventType> &events,
+                                const First &first,
+                                const Second &second) const {
+  const auto byKeys = [&first, &second](const EventType &a,
+                                        const EventType &b) {
+    const auto firstA = first(a);
+    const auto firstB = first(b);
+    return firstA < firstB || (firstA == firstB && second(a) < second(b));
+  };
+  if (std::is_sorted(events.cbegin(), events.cend(), byKeys))
+    return;
+  // The sorts are stable, so sorting by the less significant key first works
+  sort(events, second);
+  sort(events, first);
+}
+
+/// Sort by increasing time-of-flight
+void EventSorter::sortTof(std::vector<TofEvent> &events) const {
+  sort(events, TofKey());
+}
+
+/// Sort by increasing time-of-flight
+void EventSorter::sortTof(std::vector<WeightedEvent> &events) const {
+  sort(events, TofKey());
+}
+
+/// Sort by increasing time-of-flight
+void EventSorter::sortTof(std::vector<WeightedEventNoTime> &events) const {
+  sort(events, TofKey());
+}
+
+/// Sort by increasing time-of-flight
+void EventSorter::sortTof(std::vector<CompactEvent> &events) const {
+  sort(events, TofKey());
+}
+
+/// Sort by increasing pulse time
+void EventSorter::sortPulseTime(std::vector<TofEvent> &events) const {
+  sort(events, PulseTimeKey());
+}
+
+/// Sort by increasing pulse time
+void EventSorter::sortPulseTime(std::vector<WeightedEvent> &events) const {
+  sort(events, PulseTimeKey());
+}
+
+/// Sort by increasing pulse time, which is the order of the pulse indices
+void EventSorter::sortPulseTime(std::vector<CompactEvent> &events) const {
+  sort(events, PulseTimeKey());
+}
+
+/// Sort by increasing pulse time, then time-of-flight within a pulse
+void EventSorter::sortPulseTimeTof(std::vector<TofEvent> &events) const {
+  sortByTwoKeys(events, PulseTimeKey(), TofKey());
+}
+
+/// Sort by increasing pulse time, then time-of-flight within a pulse
+void EventSorter::sortPulseTimeTof(std::vector<WeightedEvent> &events) const {
+  sortByTwoKeys(events, PulseTimeKey(), TofKey());
+}
+
+/** Sort by increasing time at sample
+ * @param events :: events to sort
+ * @param tofFactor :: For the elastic case, L1 / (L1 + L2)
+ * @param tofShift :: Tof offset in seconds
+ */
+void EventSorter::sortTimeAtSample(std::vector<TofEvent> &events,
+                                   const double tofFactor,
+                                   const double tofShift) const {
+  sort(events, TimeAtSampleKey{tofFactor, tofShift});
+}
+
+/// Sort by increasing time at sample, see above
+void EventSorter::sortTimeAtSample(std::vector<WeightedEvent> &events,
+                                   const double tofFactor,
+                                   const double tofShift) const {
+  sort(events, TimeAtSampleKey{tofFactor, tofShift});
+}
+
+/// Sort by increasing time at sample, see above
+void EventSorter::sortTimeAtSample(std::vector<WeightedEventNoTime> &events,
+                                   const double tofFactor,
+                                   const double tofShift) const {
+  sort(events, TimeAtSampleKey{tofFactor, tofShift});
+}
+
+} // namespace DataObjects
+} // namespace Mantid
@@ -0,0 +1,174 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidDataObjects/EventSplitter.h"
+#include "MantidDataObjects/EventSorter.h"
+
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using Mantid::Types::Event::TofEvent;
+
+namespace Mantid {
+namespace DataObjects {
+
+namespace {
+/// Smallest block of events handled by one thread
+constexpr size_t MIN_BLOCK_SIZE = 1 << 16;
+
+/// Absolute time of an event in nanoseconds, as the splitting code expects
+template <typename EventType>
+inline int64_t fullTime(const EventType &event, const bool correct,
+                        const double tofFactor, const double tofShift) {
+  if (correct)
+    return calculateCorrectedFullTime(event, tofFactor, tofShift);
+  return event.pulseTime().totalNanoseconds() +
+         static_cast<int64_t>(event.tof() * 1000);
+}
+} // namespace
+
+/** Constructor
+ * @param times :: boundaries of the intervals, increasing
+ * @param destinations :: index of the output of each interval [times[i],
+ * times[i+1]), or NO_OUTPUT to drop its events; one fewer than the times
+ * @param outside :: index of the output of the events before the first or
+ * after the last interval, or NO_OUTPUT to drop them
+ * @throws std::invalid_argument if the sizes do not match or the times are
+ * not sorted
+ */
+EventSplitter::EventSplitter(std::vector<int64_t> times,
+                             std::vector<int> destinations, const int outside)
+    : m_times(std::move(times)), m_destinations(std::move(destinations)),
+      m_outside(outside) {
+  if (!m_destinations.empty() && m_times.size() != m_destinations.size() + 1)
+    throw std::invalid_argument(
+        "EventSplitter: there must be one more time than destinations");
+  if (!std::is_sorted(m_times.cbegin(), m_times.cend()))
+    throw std::invalid_argument("EventSplitter: the times must be sorted");
+}
+
+/** Find the interval holding a time
+ * @param time :: absolute time in nanoseconds
+ * @param hint :: a nearby interval, such as that of the previous event
+ * @return i such that times[i] <= time < times[i+1], or OUTSIDE
+ */
+size_t EventSplitter::findInterval(const int64_t time,
+                                   const size_t hint) const {
+  if (m_destinations.empty() || time < m_times.front() ||
+      time >= m_times.back())
+    return OUTSIDE;
+  const size_t last = m_times.size() - 1;
+  const auto begin = m_times.cbegin();
+  size_t low = std::min(hint, last - 1);
+  if (m_times[low] > time)
+    return std::upper_bound(begin, begin + low, time) - begin - 1;
+  // Gallop forward: times[low] <= time < times[high]
+  size_t step = 1;
+  size_t high = low + 1;
+  while (high < last && m_times[high] <= time) {
+    low = high;
+    step *= 2;
+    high = std::min(low + step, last);
+  }
+  return std::upper_bound(begin + low, begin + high, time) - begin - 1;
+}
+
+/** Split events between outputs. Events are appended to the outputs in the
+ * order of the input.
+ * @param events :: the events to split
+ * @param outputs :: the outputs, indexed by the destinations given to the
+ * constructor
+ * @param correct :: if true, correct the time-of-flight to the sample
+ * @param tofFactor :: factor applied to the time-of-flight when correcting
+ * @param tofShift :: shift in seconds added to the time-of-flight when
+ * correcting
+ */
+template <typename EventType>
+void EventSplitter::split(const std::vector<EventType> &events,
+                          const std::vector<std::vector<EventType> *> &outputs,
+                          const bool correct, const double tofFactor,
+                          const double tofShift) const {
+  const size_t numEvents = events.size();
+  const size_t numOutputs = outputs.size();
+  // Events without an output get this one, which is never written
+  const auto dropped = static_cast<uint32_t>(numOutputs);
+  const auto outputOf = [&](const int destination) {
+    return (destination < 0 || static_cast<size_t>(destination) >= numOutputs ||
+            !outputs[destination])
+               ? dropped
+               : static_cast<uint32_t>(destination);
+  };
+  std::vector<uint32_t> intervalOutputs(m_destinations.size());
+  std::transform(m_destinations.cbegin(), m_destinations.cend(),
+                 intervalOutputs.begin(), outputOf);
+  const uint32_t outsideOutput = outputOf(m_outside);
+
+  const size_t numBlocks = std::max(
+      std::min(static_cast<size_t>(tbb::this_task_arena::max_concurrency()),
+               numEvents / MIN_BLOCK_SIZE),
+      size_t{1});
+  const auto blockStart = [&](const size_t block) {
+    return block * numEvents / numBlocks;
+  };
+
+  // ---- Pass 1: find the output of every event and count them per block ----
+  std::vector<uint32_t> eventOutputs(numEvents);
+  std::vector<std::vector<size_t>> cursors(numBlocks);
+  tbb::parallel_for(size_t{0}, numBlocks, [&](const size_t block) {
+    auto &counts = cursors[block];
+    counts.assign(numOutputs + 1, 0);
+    size_t interval = 0;
+    for (size_t i = blockStart(block); i < blockStart(block + 1); ++i) {
+      const size_t found = findInterval(
+          fullTime(events[i], correct, tofFactor, tofShift), interval);
+      uint32_t output = outsideOutput;
+      if (found != OUTSIDE) {
+        interval = found;
+        output = intervalOutputs[found];
+      }
+      eventOutputs[i] = output;
+      ++counts[output];
+    }
+  });
+
+  // ---- Grow every output once, giving each block its own range of it ----
+  for (size_t output = 0; output < numOutputs; ++output) {
+    if (!outputs[output])
+      continue;
+    size_t position = outputs[output]->size();
+    for (auto &counts : cursors) {
+      const size_t count = counts[output];
+      counts[output] = position;
+      position += count;
+    }
+    outputs[output]->resize(position);
+  }
+
+  // ---- Pass 2: copy the events into place ----
+  tbb::parallel_for(size_t{0}, numBlocks, [&](const size_t block) {
+    auto &blockCursors = cursors[block];
+    for (size_t i = blockStart(block); i < blockStart(block + 1); ++i) {
+      const uint32_t output = eventOutputs[i];
+      if (output != dropped)
+        (*outputs[output])[blockCursors[output]++] = events[i];
+    }
+  });
+}
+
+template DLLExport void
+EventSplitter::split(const std::vector<TofEvent> &,
+                     const std::vector<std::vector<TofEvent> *> &, const bool,
+                     const double, const double) const;
+template DLLExport void
+EventSplitter::split(const std::vector<WeightedEvent> &,
+                     const std::vector<std::vector<WeightedEvent> *> &,
+                     const bool, const double, const double) const;
+
+} // namespace DataObjects
+} // namespace Mantid
@@ -13,6 +13,7 @@
 #include "MantidAPI/SpectraAxis.h"
 #include "MantidAPI/SpectrumInfo.h"
 #include "MantidAPI/WorkspaceFactory.h"
+#include "MantidDataObjects/EventSorter.h"
 #include "MantidDataObjects/EventWorkspaceMRU.h"
 #include "MantidGeometry/IDetector.h"
 #include "MantidGeometry/Instrument.h"
@@ -495,6 +496,74 @@ void EventWorkspace::switchEventType(const Mantid::API::EventType type) {
     eventList->switchTo(type);
 }
 
+namespace {
+/** Make one table of the pulse times of the events in all the lists
+ * @param lists :: event lists holding TofEvent's
+ * @return the sorted, unique pulse times
+ */
+std::shared_ptr<const PulseTimeTable>
+mergedPulseTimes(const std::vector<std::unique_ptr<EventList>> &lists) {
+  // Each thread makes a table of the pulse times of every numChunks-th list
+  const int numChunks = std::max(1, PARALLEL_GET_MAX_THREADS);
+  const auto numLists = static_cast<int>(lists.size());
+  std::vector<std::shared_ptr<const PulseTimeTable>> chunkTables(numChunks);
+  PARALLEL_FOR_NO_WSP_CHECK()
+  for (int chunk = 0; chunk < numChunks; ++chunk) {
+    PulseTimeTable times;
+    for (int i = chunk; i < numLists; i += numChunks)
+      CompactEvents::addPulseTimes(times, lists[i]->getEvents());
+    chunkTables[chunk] = CompactEvents::makePulseTimeTable(std::move(times));
+  }
+
+  PulseTimeTable times;
+  for (const auto &chunkTable : chunkTables)
+    times.insert(times.end(), chunkTable->cbegin(), chunkTable->cend());
+  return CompactEvents::makePulseTimeTable(std::move(times));
+}
+} // namespace
+
+/** Switch all event lists to the given storage layout. COLUMN_STORAGE keeps
+ * each event field in its own contiguous array, which speeds up
+ * histogramming, TOF conversion and sorting by TOF. COMPACT_STORAGE halves the
+ * memory of unweighted events, with one table of pulse times shared by all
+ * the lists.
+ *
+ * @param storage :: EventStorageType to switch to
+ * @throws std::runtime_error if COMPACT_STORAGE is requested and some events
+ * have weights
+ */
+void EventWorkspace::setStorageType(const EventStorageType storage) {
+  std::shared_ptr<const PulseTimeTable> pulseTimes;
+  if (storage == COMPACT_STORAGE) {
+    if (std::any_of(data.cbegin(), data.cend(), [](const auto &list) {
+          return list->getEventType() != API::TOF;
+        }))
+      throw std::runtime_error("EventWorkspace::setStorageType(): only "
+                               "unweighted events can use COMPACT_STORAGE");
+    pulseTimes = mergedPulseTimes(data);
+  }
+
+  PARALLEL_FOR_NO_WSP_CHECK()
+  for (int i = 0; i < static_cast<int>(this->data.size()); ++i)
+    this->data[i]->setStorageType(storage, pulseTimes);
+}
+
+/** Get the storage layout of the event lists
+ *
+ * @return COLUMN_STORAGE or COMPACT_STORAGE if every event list uses it,
+ * ROW_STORAGE otherwise
+ */
+EventStorageType EventWorkspace::getStorageType() const {
+  if (data.empty())
+    return ROW_STORAGE;
+  const auto storage = data.front()->getStorageType();
+  const bool allSame =
+      std::all_of(data.cbegin(), data.cend(), [storage](const auto &list) {
+        return list->getStorageType() == storage;
+      });
+  return allSame ? storage : ROW_STORAGE;
+}
+
 /// Returns true always - an EventWorkspace always represents histogramm-able
 /// data
 /// @returns If the data is a histogram - always true for an eventWorkspace
@@ -674,13 +743,14 @@ class EventSortingTask {
 public:
   /// ctor
   EventSortingTask(const EventWorkspace *WS, EventSortType sortType,
+                   const std::vector<size_t> &indices,
                    Mantid::API::Progress *prog)
-      : m_sortType(sortType), m_WS(WS), prog(prog) {}
+      : m_sortType(sortType), m_WS(WS), m_indices(indices), prog(prog) {}
 
   // Execute the sort as specified.
   void operator()(const tbb::blocked_range<size_t> &range) const {
-    for (size_t wi = range.begin(); wi < range.end(); ++wi) {
-      m_WS->getSpectrum(wi).sort(m_sortType);
+    for (size_t i = range.begin(); i < range.end(); ++i) {
+      m_WS->getSpectrum(m_indices[i]).sort(m_sortType);
     }
     // Report progress
     if (prog)
@@ -692,6 +762,8 @@ private:
   EventSortType m_sortType;
   /// EventWorkspace on which to sort
   const EventWorkspace *m_WS;
+  /// Workspace indices of the lists to sort
+  const std::vector<size_t> &m_indices;
   /// Optional Progress dialog.
   Mantid::API::Progress *prog;
 };
@@ -724,9 +796,24 @@ void EventWorkspace::sortAll(EventSortType sortType,
     return;
   }
 
-  // Create the thread pool, and optimize by doing the longest sorts first.
-  EventSortingTask task(this, sortType, prog);
-  tbb::parallel_for(tbb::blocked_range<size_t>(0, data.size()), task);
+  // Lists big enough to keep every thread busy on their own, like monitors
+  // or hot pixels, are sorted first and one at a time. The others are sorted
+  // in parallel with each other, each with a single thread.
+  std::vector<size_t> indices;
+  indices.reserve(data.size());
+  for (size_t wi = 0; wi < data.size(); ++wi) {
+    if (EventSorter::chooseStrategy(data[wi]->getNumberEvents()) ==
+        EventSorter::Strategy::ParallelRadix) {
+      data[wi]->sort(sortType);
+      if (prog)
+        prog->report("Sorting");
+    } else {
+      indices.emplace_back(wi);
+    }
+  }
+
+  EventSortingTask task(this, sortType, indices, prog);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, indices.size()), task);
 }
 
 /** Integrate all the spectra in the matrix workspace within the range given.
@@ -14,6 +14,7 @@
 #include "MantidKernel/Strings.h"
 #include <Poco/File.h>
 
+#include <algorithm>
 #include <utility>
 
 using file_holder_type = std::unique_ptr<::NeXus::File>;
@@ -27,6 +28,51 @@ Kernel::Logger g_log("MDBoxFlatTree");
 
 MDBoxFlatTree::MDBoxFlatTree() : m_nDim(-1) {}
 
+/** Sort boxes along the Morton (Z-order) curve through their centres, so that
+ * boxes close to each other in space are close to each other in the sequence.
+ * The centres come from the extents of the flat structure, and are scaled to
+ * the extents of the top box.
+ *
+ * @param boxes :: the boxes to sort, with IDs indexing the flat structure
+ */
+void MDBoxFlatTree::sortByMortonOrder(
+    std::vector<API::IMDNode *> &boxes) const {
+  const auto nDim = static_cast<size_t>(m_nDim);
+  // Bits per dimension of the quantized centres, so a key fits in 64 bits
+  const size_t bits = std::min<size_t>(21, 64 / nDim);
+  const double cells = static_cast<double>(uint64_t{1} << bits);
+  const auto extent = [this, nDim](const size_t id, const size_t d,
+                                   const size_t side) {
+    return m_Extents[id * nDim * 2 + d * 2 + side];
+  };
+
+  std::vector<std::pair<uint64_t, API::IMDNode *>> keyed;
+  keyed.reserve(boxes.size());
+  std::vector<uint64_t> cell(nDim);
+  for (auto box : boxes) {
+    const size_t id = box->getID();
+    for (size_t d = 0; d < nDim; ++d) {
+      const double width = extent(0, d, 1) - extent(0, d, 0);
+      const double centre = 0.5 * (extent(id, d, 0) + extent(id, d, 1));
+      const double scaled =
+          width > 0 ? (centre - extent(0, d, 0)) / width * cells : 0.;
+      cell[d] =
+          static_cast<uint64_t>(std::min(std::max(scaled, 0.), cells - 1));
+    }
+    // Interleave the bits of the cell indices, most significant first
+    uint64_t key = 0;
+    for (size_t bit = bits; bit > 0; --bit)
+      for (size_t d = 0; d < nDim; ++d)
+        key = (key << 1) | ((cell[d] >> (bit - 1)) & 1);
+    keyed.emplace_back(key, box);
+  }
+  std::stable_sort(
+      keyed.begin(), keyed.end(),
+      [](const auto &a, const auto &b) { return a.first < b.first; });
+  std::transform(keyed.cbegin(), keyed.cend(), boxes.begin(),
+                 [](const auto &k) { return k.second; });
+}
+
 /**The method initiates the MDBoxFlatTree class internal structure in the form
  *ready for saving this structure to HDD
  *
@@ -139,17 +185,23 @@ void MDBoxFlatTree::initFlatStructure(const API::IMDEventWorkspace_sptr &pws,
    on the HDD
      @param setFileBacked  -- initiate the boxes to be fileBacked. The boxes
    assumed not to be saved before.
+     @param mortonOrder  -- place the boxes in the Morton order of their
+   centres rather than in the order of their IDs.
 */
-void MDBoxFlatTree::setBoxesFilePositions(bool setFileBacked) {
+void MDBoxFlatTree::setBoxesFilePositions(bool setFileBacked,
+                                          bool mortonOrder) {
   // this will preserve file-backed workspace and information in it as we are
   // not loading old box data and not?
   // this would be right for binary access but questionable for Nexus --TODO:
   // needs testing
   // Done in INIT--> need check if ID and index in the tree are always the same.
   // Kernel::ISaveable::sortObjByFilePos(m_Boxes);
+  std::vector<API::IMDNode *> boxes(m_Boxes);
+  if (mortonOrder)
+    sortByMortonOrder(boxes);
   // calculate the box positions in the resulting file and save it on place
   uint64_t eventsStart = 0;
-  for (auto mdBox : m_Boxes) {
+  for (auto mdBox : boxes) {
     size_t ID = mdBox->getID();
 
     // avoid grid boxes;
@@ -0,0 +1,467 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidDataObjects/MDHistoOperationChain.h"
+#include "MantidDataObjects/MDHistoWorkspace.h"
+#include "MantidKernel/MultiThreaded.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Mantid {
+namespace DataObjects {
+
+/** Add a workspace: the signals and squared errors are summed, as are the
+ * numbers of events
+ * @param b :: workspace on the RHS of the operation
+ * @return *this */
+MDHistoOperationChain &MDHistoOperationChain::add(const MDHistoWorkspace &b) {
+  return addStep(Operation::AddWorkspace, &b);
+}
+
+/** Add a scalar
+ * @param signal :: signal to apply
+ * @param error :: error (not squared) to apply
+ * @return *this */
+MDHistoOperationChain &MDHistoOperationChain::add(const signal_t signal,
+                                                  const signal_t error) {
+  return addStep(Operation::AddScalar, nullptr, signal, error * error);
+}
+
+/** Subtract a workspace: the squared errors and numbers of events are summed
+ * @param b :: workspace on the RHS of the operation
+ * @return *this */
+MDHistoOperationChain &
+MDHistoOperationChain::subtract(const MDHistoWorkspace &b) {
+  return addStep(Operation::SubtractWorkspace, &b);
+}
+
+/** Subtract a scalar
+ * @param signal :: signal to apply
+ * @param error :: error (not squared) to apply
+ * @return *this */
+MDHistoOperationChain &MDHistoOperationChain::subtract(const signal_t signal,
+                                                       const signal_t error) {
+  return addStep(Operation::SubtractScalar, nullptr, signal, error * error);
+}
+
+/** Multiply by a workspace, with \f$ df^2 = b^2 da^2 + a^2 * db^2 \f$
+ * @param b :: workspace on the RHS of the operation
+ * @return *this */
+MDHistoOperationChain &
+MDHistoOperationChain::multiply(const MDHistoWorkspace &b) {
+  return addStep(Operation::MultiplyWorkspace, &b);
+}
+
+/** Multiply by a scalar, with \f$ df^2 = b^2 da^2 + a^2 * db^2 \f$
+ * @param signal :: signal to apply
+ * @param error :: error (not squared) to apply
+ * @return *this */
+MDHistoOperationChain &MDHistoOperationChain::multiply(const signal_t signal,
+                                                       const signal_t error) {
+  return addStep(Operation::MultiplyScalar, nullptr, signal, error * error);
+}
+
+/** Divide by a workspace, with \f$ df^2 = da^2 / b^2 + db^2 *f^2 / b^2 \f$
+ * @param b :: workspace on the RHS of the operation
+ * @return *this */
+MDHistoOperationChain &
+MDHistoOperationChain::divide(const MDHistoWorkspace &b) {
+  return addStep(Operation::DivideWorkspace, &b);
+}
+
+/** Divide by a scalar, with \f$ df^2 = da^2 / b^2 + db^2 *f^2 / b^2 \f$
+ * @param signal :: signal to apply
+ * @param error :: error (not squared) to apply
+ * @return *this */
+MDHistoOperationChain &MDHistoOperationChain::divide(const signal_t signal,
+                                                     const signal_t error) {
+  return addStep(Operation::DivideScalar, nullptr, signal, error * error);
+}
+
+/** Take the natural logarithm, with \f$ df^2 = da^2 / a^2 \f$
+ * @param filler :: signal of the bins with a signal <= 0, whose error is 0
+ * @return *this */
+MDHistoOperationChain &MDHistoOperationChain::log(const double filler) {
+  return addStep(Operation::Log, nullptr, filler);
+}
+
+/** Take the base-10 logarithm, with \f$ df^2 = (ln(10)^-2) * da^2 / a^2 \f$
+ * @param filler :: signal of the bins with a signal <= 0, whose error is 0
+ * @return *this */
+MDHistoOperationChain &MDHistoOperationChain::log10(const double filler) {
+  return addStep(Operation::Log10, nullptr, filler);
+}
+
+/** Take the exponential, with \f$ df^2 = f^2 * da^2 \f$
+ * @return *this */
+MDHistoOperationChain &MDHistoOperationChain::exp() {
+  return addStep(Operation::Exp, nullptr);
+}
+
+/** Raise to a power, with \f$ df^2 = f^2 * b^2 * (da^2 / a^2) \f$
+ * @param exponent :: the power
+ * @return *this */
+MDHistoOperationChain &MDHistoOperationChain::power(const double exponent) {
+  return addStep(Operation::Power, nullptr, exponent);
+}
+
+/** Boolean and with a workspace. Masked bins are false. Errors are set to 0.
+ * @param b :: workspace on the RHS of the operation
+ * @return *this */
+MDHistoOperationChain &
+MDHistoOperationChain::operatorAnd(const MDHistoWorkspace &b) {
+  return addStep(Operation::And, &b);
+}
+
+/** Boolean or with a workspace. Masked bins are false. Errors are set to 0.
+ * @param b :: workspace on the RHS of the operation
+ * @return *this */
+MDHistoOperationChain &
+MDHistoOperationChain::operatorOr(const MDHistoWorkspace &b) {
+  return addStep(Operation::Or, &b);
+}
+
+/** Boolean xor with a workspace. Masked bins are false. Errors are set to 0.
+ * @param b :: workspace on the RHS of the operation
+ * @return *this */
+MDHistoOperationChain &
+MDHistoOperationChain::operatorXor(const MDHistoWorkspace &b) {
+  return addStep(Operation::Xor, &b);
+}
+
+/** Boolean not. Masked bins are false before the operation. Errors are set
+ * to 0.
+ * @return *this */
+MDHistoOperationChain &MDHistoOperationChain::operatorNot() {
+  return addStep(Operation::Not, nullptr);
+}
+
+/** Set the signal to 1 where it is < that of a workspace, 0 elsewhere.
+ * Errors are set to 0.
+ * @param b :: workspace on the RHS of the comparison
+ * @return *this */
+MDHistoOperationChain &
+MDHistoOperationChain::lessThan(const MDHistoWorkspace &b) {
+  return addStep(Operation::LessThanWorkspace, &b);
+}
+
+/** Set the signal to 1 where it is < a value, 0 elsewhere. Errors are set to 0.
+ * @param signal :: signal value on the RHS of the comparison
+ * @return *this */
+MDHistoOperationChain &MDHistoOperationChain::lessThan(const signal_t signal) {
+  return addStep(Operation::LessThanScalar, nullptr, signal);
+}
+
+/** Set the signal to 1 where it is > that of a workspace, 0 elsewhere.
+ * Errors are set to 0.
+ * @param b :: workspace on the RHS of the comparison
+ * @return *this */
+MDHistoOperationChain &
+MDHistoOperationChain::greaterThan(const MDHistoWorkspace &b) {
+  return addStep(Operation::GreaterThanWorkspace, &b);
+}
+
+/** Set the signal to 1 where it is > a value, 0 elsewhere. Errors are set to 0.
+ * @param signal :: signal value on the RHS of the comparison
+ * @return *this */
+MDHistoOperationChain &
+MDHistoOperationChain::greaterThan(const signal_t signal) {
+  return addStep(Operation::GreaterThanScalar, nullptr, signal);
+}
+
+/** Set the signal to 1 where it is within a tolerance of that of a
+ * workspace, 0 elsewhere. Errors are set to 0.
+ * @param b :: workspace on the RHS of the comparison
+ * @param tolerance :: accept this deviation from a perfect equality
+ * @return *this */
+MDHistoOperationChain &
+MDHistoOperationChain::equalTo(const MDHistoWorkspace &b,
+                               const signal_t tolerance) {
+  return addStep(Operation::EqualToWorkspace, &b, 0., 0., tolerance);
+}
+
+/** Set the signal to 1 where it is within a tolerance of a value, 0
+ * elsewhere. Errors are set to 0.
+ * @param signal :: signal value on the RHS of the comparison
+ * @param tolerance :: accept this deviation from a perfect equality
+ * @return *this */
+MDHistoOperationChain &
+MDHistoOperationChain::equalTo(const signal_t signal,
+                               const signal_t tolerance) {
+  return addStep(Operation::EqualToScalar, nullptr, signal, 0., tolerance);
+}
+
+/** Run the chain on a workspace, in place
+ * @param ws :: the workspace on the LHS of every operation
+ * @throw std::invalid_argument if an operand does not match the workspace
+ */
+void MDHistoOperationChain::applyTo(MDHistoWorkspace &ws) const {
+  for (const auto &step : m_steps)
+    if (step.operand)
+      ws.checkWorkspaceSize(*step.operand, name(step.operation));
+
+  const size_t length = ws.getNPoints();
+  const auto nBlocks = static_cast<int64_t>((length + BLOCK_SIZE - 1) /
+                                            BLOCK_SIZE);
+  PARALLEL_FOR_IF(nBlocks > 1)
+  for (int64_t block = 0; block < nBlocks; ++block) {
+    const size_t begin = static_cast<size_t>(block) * BLOCK_SIZE;
+    const size_t end = std::min(begin + BLOCK_SIZE, length);
+    for (const auto &step : m_steps)
+      applyStep(step, ws, begin, end);
+  }
+
+  for (const auto &step : m_steps)
+    if (step.operation == Operation::AddWorkspace ||
+        step.operation == Operation::SubtractWorkspace)
+      ws.m_nEventsContributed += step.operand->m_nEventsContributed;
+}
+
+MDHistoOperationChain &
+MDHistoOperationChain::addStep(const Operation operation,
+                               const MDHistoWorkspace *operand,
+                               const signal_t value,
+                               const signal_t errorSquared,
+                               const signal_t tolerance) {
+  m_steps.push_back({operation, operand, value, errorSquared, tolerance});
+  return *this;
+}
+
+/// Name of an operation, for error messages
+std::string MDHistoOperationChain::name(const Operation operation) {
+  switch (operation) {
+  case Operation::AddWorkspace:
+    return "add";
+  case Operation::SubtractWorkspace:
+    return "subtract";
+  case Operation::MultiplyWorkspace:
+    return "multiply";
+  case Operation::DivideWorkspace:
+    return "divide";
+  case Operation::And:
+    return "&= (and)";
+  case Operation::Or:
+    return "|= (or)";
+  case Operation::Xor:
+    return "^= (xor)";
+  case Operation::LessThanWorkspace:
+    return "lessThan";
+  case Operation::GreaterThanWorkspace:
+    return "greaterThan";
+  case Operation::EqualToWorkspace:
+    return "equalTo";
+  default:
+    return "scalar";
+  }
+}
+
+/** Run one operation on some bins of a workspace. The loops are kept free of
+ * branches other than selects so that they vectorize.
+ * @param step :: the operation
+ * @param ws :: the workspace on the LHS of the operation
+ * @param begin :: index of the first bin
+ * @param end :: index past the last bin
+ */
+void MDHistoOperationChain::applyStep(const Step &step, MDHistoWorkspace &ws,
+                                      const size_t begin, const size_t end) {
+  signal_t *signals = ws.mutableSignalArray();
+  signal_t *errorsSquared = ws.mutableErrorSquaredArray();
+  signal_t *numEvents = ws.mutableNumEventsArray();
+  const bool *masks = ws.getMaskArray();
+  const signal_t *bSignals = nullptr;
+  const signal_t *bErrorsSquared = nullptr;
+  const signal_t *bNumEvents = nullptr;
+  const bool *bMasks = nullptr;
+  if (step.operand) {
+    bSignals = step.operand->getSignalArray();
+    bErrorsSquared = step.operand->getErrorSquaredArray();
+    bNumEvents = step.operand->getNumEventsArray();
+    bMasks = step.operand->getMaskArray();
+  }
+  const signal_t value = step.value;
+  const signal_t errorSquared = step.errorSquared;
+  const signal_t tolerance = step.tolerance;
+
+  switch (step.operation) {
+  case Operation::AddWorkspace:
+    for (size_t i = begin; i < end; ++i) {
+      signals[i] += bSignals[i];
+      errorsSquared[i] += bErrorsSquared[i];
+      numEvents[i] += bNumEvents[i];
+    }
+    break;
+  case Operation::AddScalar:
+    for (size_t i = begin; i < end; ++i) {
+      signals[i] += value;
+      errorsSquared[i] += errorSquared;
+    }
+    break;
+  case Operation::SubtractWorkspace:
+    for (size_t i = begin; i < end; ++i) {
+      signals[i] -= bSignals[i];
+      errorsSquared[i] += bErrorsSquared[i];
+      numEvents[i] += bNumEvents[i];
+    }
+    break;
+  case Operation::SubtractScalar:
+    for (size_t i = begin; i < end; ++i) {
+      signals[i] -= value;
+      errorsSquared[i] += errorSquared;
+    }
+    break;
+  case Operation::MultiplyWorkspace:
+    for (size_t i = begin; i < end; ++i) {
+      const signal_t a = signals[i];
+      const signal_t b = bSignals[i];
+      signals[i] = a * b;
+      errorsSquared[i] = errorsSquared[i] * b * b + bErrorsSquared[i] * a * a;
+    }
+    break;
+  case Operation::MultiplyScalar:
+    for (size_t i = begin; i < end; ++i) {
+      const signal_t a = signals[i];
+      signals[i] = a * value;
+      errorsSquared[i] =
+          errorsSquared[i] * value * value + errorSquared * a * a;
+    }
+    break;
+  case Operation::DivideWorkspace:
+    for (size_t i = begin; i < end; ++i) {
+      const signal_t b = bSignals[i];
+      const signal_t f = signals[i] / b;
+      signals[i] = f;
+      errorsSquared[i] =
+          errorsSquared[i] / (b * b) + bErrorsSquared[i] * f * f / (b * b);
+    }
+    break;
+  case Operation::DivideScalar: {
+    const signal_t relativeErrorSquared = errorSquared / (value * value);
+    for (size_t i = begin; i < end; ++i) {
+      const signal_t f = signals[i] / value;
+      signals[i] = f;
+      errorsSquared[i] =
+          errorsSquared[i] / (value * value) + relativeErrorSquared * f * f;
+    }
+    break;
+  }
+  case Operation::Log:
+    for (size_t i = begin; i < end; ++i) {
+      const signal_t a = signals[i];
+      if (a <= 0) {
+        signals[i] = value;
+        errorsSquared[i] = 0;
+      } else {
+        signals[i] = std::log(a);
+        errorsSquared[i] = errorsSquared[i] / (a * a);
+      }
+    }
+    break;
+  case Operation::Log10:
+    for (size_t i = begin; i < end; ++i) {
+      const signal_t a = signals[i];
+      if (a <= 0) {
+        signals[i] = value;
+        errorsSquared[i] = 0;
+      } else {
+        signals[i] = std::log10(a);
+        // 0.1886117  = ln(10)^-2
+        errorsSquared[i] = 0.1886117 * errorsSquared[i] / (a * a);
+      }
+    }
+    break;
+  case Operation::Exp:
+    for (size_t i = begin; i < end; ++i) {
+      const signal_t f = std::exp(signals[i]);
+      signals[i] = f;
+      errorsSquared[i] = f * f * errorsSquared[i];
+    }
+    break;
+  case Operation::Power: {
+    const signal_t exponentSquared = value * value;
+    for (size_t i = begin; i < end; ++i) {
+      const signal_t a = signals[i];
+      const signal_t f = std::pow(a, value);
+      signals[i] = f;
+      errorsSquared[i] = f * f * exponentSquared * errorsSquared[i] / (a * a);
+    }
+    break;
+  }
+  case Operation::And:
+    for (size_t i = begin; i < end; ++i) {
+      signals[i] = ((signals[i] != 0 && !masks[i]) &&
+                    (bSignals[i] != 0 && !bMasks[i]))
+                       ? 1.0
+                       : 0.0;
+      errorsSquared[i] = 0;
+    }
+    break;
+  case Operation::Or:
+    for (size_t i = begin; i < end; ++i) {
+      signals[i] = ((signals[i] != 0 && !masks[i]) ||
+                    (bSignals[i] != 0 && !bMasks[i]))
+                       ? 1.0
+                       : 0.0;
+      errorsSquared[i] = 0;
+    }
+    break;
+  case Operation::Xor:
+    for (size_t i = begin; i < end; ++i) {
+      signals[i] = ((signals[i] != 0 && !masks[i]) ^
+                    (bSignals[i] != 0 && !bMasks[i]))
+                       ? 1.0
+                       : 0.0;
+      errorsSquared[i] = 0;
+    }
+    break;
+  case Operation::Not:
+    for (size_t i = begin; i < end; ++i) {
+      signals[i] = (signals[i] == 0.0 || masks[i]);
+      errorsSquared[i] = 0;
+    }
+    break;
+  case Operation::LessThanWorkspace:
+    for (size_t i = begin; i < end; ++i) {
+      signals[i] = (signals[i] < bSignals[i]) ? 1.0 : 0.0;
+      errorsSquared[i] = 0;
+    }
+    break;
+  case Operation::LessThanScalar:
+    for (size_t i = begin; i < end; ++i) {
+      signals[i] = (signals[i] < value) ? 1.0 : 0.0;
+      errorsSquared[i] = 0;
+    }
+    break;
+  case Operation::GreaterThanWorkspace:
+    for (size_t i = begin; i < end; ++i) {
+      signals[i] = (signals[i] > bSignals[i]) ? 1.0 : 0.0;
+      errorsSquared[i] = 0;
+    }
+    break;
+  case Operation::GreaterThanScalar:
+    for (size_t i = begin; i < end; ++i) {
+      signals[i] = (signals[i] > value) ? 1.0 : 0.0;
+      errorsSquared[i] = 0;
+    }
+    break;
+  case Operation::EqualToWorkspace:
+    for (size_t i = begin; i < end; ++i) {
+      signals[i] =
+          (std::fabs(signals[i] - bSignals[i]) < tolerance) ? 1.0 : 0.0;
+      errorsSquared[i] = 0;
+    }
+    break;
+  case Operation::EqualToScalar:
+    for (size_t i = begin; i < end; ++i) {
+      signals[i] = (std::fabs(signals[i] - value) < tolerance) ? 1.0 : 0.0;
+      errorsSquared[i] = 0;
+    }
+    break;
+  }
+}
+
+} // namespace DataObjects
+} // namespace Mantid
@@ -8,11 +8,13 @@
 #include "MantidAPI/IMDIterator.h"
 #include "MantidAPI/IMDWorkspace.h"
 #include "MantidDataObjects/MDFramesToSpecialCoordinateSystem.h"
+#include "MantidDataObjects/MDHistoOperationChain.h"
 #include "MantidDataObjects/MDHistoWorkspaceIterator.h"
 #include "MantidGeometry/MDGeometry/IMDDimension.h"
 #include "MantidGeometry/MDGeometry/MDDimensionExtents.h"
 #include "MantidGeometry/MDGeometry/MDGeometryXMLBuilder.h"
 #include "MantidGeometry/MDGeometry/MDHistoDimension.h"
+#include "MantidKernel/MultiThreaded.h"
 #include "MantidKernel/Utils.h"
 #include "MantidKernel/VMD.h"
 #include "MantidKernel/WarningSuppressions.h"
@@ -764,13 +766,7 @@ MDHistoWorkspace &MDHistoWorkspace::operator+=(const MDHistoWorkspace &b) {
  * @param b :: workspace on the RHS of the operation
  * */
 void MDHistoWorkspace::add(const MDHistoWorkspace &b) {
-  checkWorkspaceSize(b, "add");
-  for (size_t i = 0; i < m_length; ++i) {
-    m_signals[i] += b.m_signals[i];
-    m_errorsSquared[i] += b.m_errorsSquared[i];
-    m_numEvents[i] += b.m_numEvents[i];
-  }
-  m_nEventsContributed += b.m_nEventsContributed;
+  MDHistoOperationChain().add(b).applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -780,11 +776,7 @@ void MDHistoWorkspace::add(const MDHistoWorkspace &b) {
  * @param error :: error (not squared) to apply
  * */
 void MDHistoWorkspace::add(const signal_t signal, const signal_t error) {
-  signal_t errorSquared = error * error;
-  for (size_t i = 0; i < m_length; ++i) {
-    m_signals[i] += signal;
-    m_errorsSquared[i] += errorSquared;
-  }
+  MDHistoOperationChain().add(signal, error).applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -803,13 +795,7 @@ MDHistoWorkspace &MDHistoWorkspace::operator-=(const MDHistoWorkspace &b) {
  * @param b :: workspace on the RHS of the operation
  * */
 void MDHistoWorkspace::subtract(const MDHistoWorkspace &b) {
-  checkWorkspaceSize(b, "subtract");
-  for (size_t i = 0; i < m_length; ++i) {
-    m_signals[i] -= b.m_signals[i];
-    m_errorsSquared[i] += b.m_errorsSquared[i];
-    m_numEvents[i] += b.m_numEvents[i];
-  }
-  m_nEventsContributed += b.m_nEventsContributed;
+  MDHistoOperationChain().subtract(b).applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -819,11 +805,7 @@ void MDHistoWorkspace::subtract(const MDHistoWorkspace &b) {
  * @param error :: error (not squared) to apply
  * */
 void MDHistoWorkspace::subtract(const signal_t signal, const signal_t error) {
-  signal_t errorSquared = error * error;
-  for (size_t i = 0; i < m_length; ++i) {
-    m_signals[i] -= signal;
-    m_errorsSquared[i] += errorSquared;
-  }
+  MDHistoOperationChain().subtract(signal, error).applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -851,20 +833,7 @@ MDHistoWorkspace &MDHistoWorkspace::operator*=(const MDHistoWorkspace &b_ws) {
  * @param b_ws :: workspace on the RHS of the operation
  * */
 void MDHistoWorkspace::multiply(const MDHistoWorkspace &b_ws) {
-  checkWorkspaceSize(b_ws, "multiply");
-  for (size_t i = 0; i < m_length; ++i) {
-    signal_t a = m_signals[i];
-    signal_t da2 = m_errorsSquared[i];
-
-    signal_t b = b_ws.m_signals[i];
-    signal_t db2 = b_ws.m_errorsSquared[i];
-
-    signal_t f = a * b;
-    signal_t df2 = da2 * b * b + db2 * a * a;
-
-    m_signals[i] = f;
-    m_errorsSquared[i] = df2;
-  }
+  MDHistoOperationChain().multiply(b_ws).applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -880,19 +849,7 @@ void MDHistoWorkspace::multiply(const MDHistoWorkspace &b_ws) {
  * @param error :: error (not squared) to apply
  * @return *this after operation */
 void MDHistoWorkspace::multiply(const signal_t signal, const signal_t error) {
-  signal_t b = signal;
-  signal_t db2 = error * error;
-
-  for (size_t i = 0; i < m_length; ++i) {
-    signal_t a = m_signals[i];
-    signal_t da2 = m_errorsSquared[i];
-
-    signal_t f = a * b;
-    signal_t df2 = da2 * b * b + db2 * a * a;
-
-    m_signals[i] = f;
-    m_errorsSquared[i] = df2;
-  }
+  MDHistoOperationChain().multiply(signal, error).applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -920,20 +877,7 @@ MDHistoWorkspace &MDHistoWorkspace::operator/=(const MDHistoWorkspace &b_ws) {
  * @param b_ws :: workspace on the RHS of the operation
  **/
 void MDHistoWorkspace::divide(const MDHistoWorkspace &b_ws) {
-  checkWorkspaceSize(b_ws, "divide");
-  for (size_t i = 0; i < m_length; ++i) {
-    signal_t a = m_signals[i];
-    signal_t da2 = m_errorsSquared[i];
-
-    signal_t b = b_ws.m_signals[i];
-    signal_t db2 = b_ws.m_errorsSquared[i];
-
-    signal_t f = a / b;
-    signal_t df2 = da2 / (b * b) + db2 * f * f / (b * b);
-
-    m_signals[i] = f;
-    m_errorsSquared[i] = df2;
-  }
+  MDHistoOperationChain().divide(b_ws).applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -949,19 +893,7 @@ void MDHistoWorkspace::divide(const MDHistoWorkspace &b_ws) {
  * @param error :: error (not squared) to apply
  **/
 void MDHistoWorkspace::divide(const signal_t signal, const signal_t error) {
-  signal_t b = signal;
-  signal_t db2 = error * error;
-  signal_t db2_relative = db2 / (b * b);
-  for (size_t i = 0; i < m_length; ++i) {
-    signal_t a = m_signals[i];
-    signal_t da2 = m_errorsSquared[i];
-
-    signal_t f = a / b;
-    signal_t df2 = da2 / (b * b) + db2_relative * f * f;
-
-    m_signals[i] = f;
-    m_errorsSquared[i] = df2;
-  }
+  MDHistoOperationChain().divide(signal, error).applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -971,17 +903,7 @@ void MDHistoWorkspace::divide(const signal_t signal, const signal_t error) {
  * \f$ df^2 = a^2 / da^2 \f$
  */
 void MDHistoWorkspace::log(double filler) {
-  for (size_t i = 0; i < m_length; ++i) {
-    signal_t a = m_signals[i];
-    signal_t da2 = m_errorsSquared[i];
-    if (a <= 0) {
-      m_signals[i] = filler;
-      m_errorsSquared[i] = 0;
-    } else {
-      m_signals[i] = std::log(a);
-      m_errorsSquared[i] = da2 / (a * a);
-    }
-  }
+  MDHistoOperationChain().log(filler).applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -991,17 +913,7 @@ void MDHistoWorkspace::log(double filler) {
  * \f$ df^2 = (ln(10)^-2) * a^2 / da^2 \f$
  */
 void MDHistoWorkspace::log10(double filler) {
-  for (size_t i = 0; i < m_length; ++i) {
-    signal_t a = m_signals[i];
-    signal_t da2 = m_errorsSquared[i];
-    if (a <= 0) {
-      m_signals[i] = filler;
-      m_errorsSquared[i] = 0;
-    } else {
-      m_signals[i] = std::log10(a);
-      m_errorsSquared[i] = 0.1886117 * da2 / (a * a); // 0.1886117  = ln(10)^-2
-    }
-  }
+  MDHistoOperationChain().log10(filler).applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -1011,12 +923,7 @@ void MDHistoWorkspace::log10(double filler) {
  * \f$ df^2 = f^2 * da^2 \f$
  */
 void MDHistoWorkspace::exp() {
-  for (size_t i = 0; i < m_length; ++i) {
-    signal_t f = std::exp(m_signals[i]);
-    signal_t da2 = m_errorsSquared[i];
-    m_signals[i] = f;
-    m_errorsSquared[i] = f * f * da2;
-  }
+  MDHistoOperationChain().exp().applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -1027,14 +934,7 @@ void MDHistoWorkspace::exp() {
  * \f$ df^2 = f^2 * b^2 * (da^2 / a^2) \f$
  */
 void MDHistoWorkspace::power(double exponent) {
-  double exponent_squared = exponent * exponent;
-  for (size_t i = 0; i < m_length; ++i) {
-    signal_t a = m_signals[i];
-    signal_t f = std::pow(a, exponent);
-    signal_t da2 = m_errorsSquared[i];
-    m_signals[i] = f;
-    m_errorsSquared[i] = f * f * exponent_squared * da2 / (a * a);
-  }
+  MDHistoOperationChain().power(exponent).applyTo(*this);
 }
 
 //==============================================================================================
@@ -1052,14 +952,7 @@ void MDHistoWorkspace::power(double exponent) {
  * @param b :: workspace on the RHS of the operation
  * @return *this after operation */
 MDHistoWorkspace &MDHistoWorkspace::operator&=(const MDHistoWorkspace &b) {
-  checkWorkspaceSize(b, "&= (and)");
-  for (size_t i = 0; i < m_length; ++i) {
-    m_signals[i] = ((m_signals[i] != 0 && !m_masks[i]) &&
-                    (b.m_signals[i] != 0 && !b.m_masks[i]))
-                       ? 1.0
-                       : 0.0;
-    m_errorsSquared[i] = 0;
-  }
+  MDHistoOperationChain().operatorAnd(b).applyTo(*this);
   return *this;
 }
 /// @endcond DOXYGEN_BUG
@@ -1072,14 +965,7 @@ MDHistoWorkspace &MDHistoWorkspace::operator&=(const MDHistoWorkspace &b) {
  * @param b :: workspace on the RHS of the operation
  * @return *this after operation */
 MDHistoWorkspace &MDHistoWorkspace::operator|=(const MDHistoWorkspace &b) {
-  checkWorkspaceSize(b, "|= (or)");
-  for (size_t i = 0; i < m_length; ++i) {
-    m_signals[i] = ((m_signals[i] != 0 && !m_masks[i]) ||
-                    (b.m_signals[i] != 0 && !b.m_masks[i]))
-                       ? 1.0
-                       : 0.0;
-    m_errorsSquared[i] = 0;
-  }
+  MDHistoOperationChain().operatorOr(b).applyTo(*this);
   return *this;
 }
 
@@ -1092,14 +978,7 @@ MDHistoWorkspace &MDHistoWorkspace::operator|=(const MDHistoWorkspace &b) {
  * @param b :: workspace on the RHS of the operation
  * @return *this after operation */
 MDHistoWorkspace &MDHistoWorkspace::operator^=(const MDHistoWorkspace &b) {
-  checkWorkspaceSize(b, "^= (xor)");
-  for (size_t i = 0; i < m_length; ++i) {
-    m_signals[i] = ((m_signals[i] != 0 && !m_masks[i]) ^
-                    (b.m_signals[i] != 0 && !b.m_masks[i]))
-                       ? 1.0
-                       : 0.0;
-    m_errorsSquared[i] = 0;
-  }
+  MDHistoOperationChain().operatorXor(b).applyTo(*this);
   return *this;
 }
 
@@ -1110,10 +989,7 @@ MDHistoWorkspace &MDHistoWorkspace::operator^=(const MDHistoWorkspace &b) {
  * 0.0 is "false", all other values are "true". All errors are set to 0.
  */
 void MDHistoWorkspace::operatorNot() {
-  for (size_t i = 0; i < m_length; ++i) {
-    m_signals[i] = (m_signals[i] == 0.0 || m_masks[i]);
-    m_errorsSquared[i] = 0;
-  }
+  MDHistoOperationChain().operatorNot().applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -1125,11 +1001,7 @@ void MDHistoWorkspace::operatorNot() {
  * @param b :: workspace on the RHS of the comparison.
  */
 void MDHistoWorkspace::lessThan(const MDHistoWorkspace &b) {
-  checkWorkspaceSize(b, "lessThan");
-  for (size_t i = 0; i < m_length; ++i) {
-    m_signals[i] = (m_signals[i] < b.m_signals[i]) ? 1.0 : 0.0;
-    m_errorsSquared[i] = 0;
-  }
+  MDHistoOperationChain().lessThan(b).applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -1141,10 +1013,7 @@ void MDHistoWorkspace::lessThan(const MDHistoWorkspace &b) {
  * @param signal :: signal value on the RHS of the comparison.
  */
 void MDHistoWorkspace::lessThan(const signal_t signal) {
-  for (size_t i = 0; i < m_length; ++i) {
-    m_signals[i] = (m_signals[i] < signal) ? 1.0 : 0.0;
-    m_errorsSquared[i] = 0;
-  }
+  MDHistoOperationChain().lessThan(signal).applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -1156,11 +1025,7 @@ void MDHistoWorkspace::lessThan(const signal_t signal) {
  * @param b :: workspace on the RHS of the comparison.
  */
 void MDHistoWorkspace::greaterThan(const MDHistoWorkspace &b) {
-  checkWorkspaceSize(b, "greaterThan");
-  for (size_t i = 0; i < m_length; ++i) {
-    m_signals[i] = (m_signals[i] > b.m_signals[i]) ? 1.0 : 0.0;
-    m_errorsSquared[i] = 0;
-  }
+  MDHistoOperationChain().greaterThan(b).applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -1172,10 +1037,7 @@ void MDHistoWorkspace::greaterThan(const MDHistoWorkspace &b) {
  * @param signal :: signal value on the RHS of the comparison.
  */
 void MDHistoWorkspace::greaterThan(const signal_t signal) {
-  for (size_t i = 0; i < m_length; ++i) {
-    m_signals[i] = (m_signals[i] > signal) ? 1.0 : 0.0;
-    m_errorsSquared[i] = 0;
-  }
+  MDHistoOperationChain().greaterThan(signal).applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -1189,12 +1051,7 @@ void MDHistoWorkspace::greaterThan(const signal_t signal) {
  */
 void MDHistoWorkspace::equalTo(const MDHistoWorkspace &b,
                                const signal_t tolerance) {
-  checkWorkspaceSize(b, "equalTo");
-  for (size_t i = 0; i < m_length; ++i) {
-    signal_t diff = fabs(m_signals[i] - b.m_signals[i]);
-    m_signals[i] = (diff < tolerance) ? 1.0 : 0.0;
-    m_errorsSquared[i] = 0;
-  }
+  MDHistoOperationChain().equalTo(b, tolerance).applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -1208,11 +1065,7 @@ void MDHistoWorkspace::equalTo(const MDHistoWorkspace &b,
  */
 void MDHistoWorkspace::equalTo(const signal_t signal,
                                const signal_t tolerance) {
-  for (size_t i = 0; i < m_length; ++i) {
-    signal_t diff = fabs(m_signals[i] - signal);
-    m_signals[i] = (diff < tolerance) ? 1.0 : 0.0;
-    m_errorsSquared[i] = 0;
-  }
+  MDHistoOperationChain().equalTo(signal, tolerance).applyTo(*this);
 }
 
 //----------------------------------------------------------------------------------------------
@@ -1235,7 +1088,9 @@ void MDHistoWorkspace::setUsingMask(const MDHistoWorkspace &mask,
                                     const MDHistoWorkspace &values) {
   checkWorkspaceSize(mask, "setUsingMask");
   checkWorkspaceSize(values, "setUsingMask");
-  for (size_t i = 0; i < m_length; ++i) {
+  const auto length = static_cast<int64_t>(m_length);
+  PARALLEL_FOR_NO_WSP_CHECK()
+  for (int64_t i = 0; i < length; ++i) {
     if (mask.m_signals[i] != 0.0) {
       m_signals[i] = values.m_signals[i];
       m_errorsSquared[i] = values.m_errorsSquared[i];
@@ -1265,7 +1120,9 @@ void MDHistoWorkspace::setUsingMask(const MDHistoWorkspace &mask,
                                     const signal_t error) {
   signal_t errorSquared = error * error;
   checkWorkspaceSize(mask, "setUsingMask");
-  for (size_t i = 0; i < m_length; ++i) {
+  const auto length = static_cast<int64_t>(m_length);
+  PARALLEL_FOR_NO_WSP_CHECK()
+  for (int64_t i = 0; i < length; ++i) {
     if (mask.m_signals[i] != 0.0) {
       m_signals[i] = signal;
       m_errorsSquared[i] = errorSquared;
@@ -0,0 +1,308 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidAPI/BoxController.h"
+#include "MantidDataObjects/BoxControllerCompressedIO.h"
+#include "MantidDataObjects/BoxControllerNeXusIO.h"
+#include "MantidKernel/Exception.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <cxxtest/TestSuite.h>
+
+#include <Poco/File.h>
+
+using Mantid::API::BoxController;
+using Mantid::DataObjects::BoxControllerCompressedIO;
+using Mantid::DataObjects::BoxControllerNeXusIO;
+
+namespace {
+/// Values of events of a box: signal, error, run index, detector ID and
+/// coordinates spread over a small region, as in an MD box
+template <typename Type>
+std::vector<Type> makeEvents(const size_t nEvents, const size_t nDims,
+                             const size_t seed) {
+  std::vector<Type> events;
+  events.reserve(nEvents * (4 + nDims));
+  for (size_t i = 0; i < nEvents; ++i) {
+    const size_t hash = (i + seed) * 2654435761u % 1000;
+    events.emplace_back(static_cast<Type>(1.));
+    events.emplace_back(static_cast<Type>(1.));
+    events.emplace_back(static_cast<Type>(seed % 3));
+    events.emplace_back(static_cast<Type>(1000 + hash));
+    for (size_t d = 0; d < nDims; ++d)
+      events.emplace_back(static_cast<Type>(
+          static_cast<double>(seed) + 0.001 * static_cast<double>(hash) +
+          0.1 * static_cast<double>(d)));
+  }
+  return events;
+}
+} // namespace
+
+class BoxControllerCompressedIOTest : public CxxTest::TestSuite {
+public:
+  static BoxControllerCompressedIOTest *createSuite() {
+    return new BoxControllerCompressedIOTest();
+  }
+  static void destroySuite(BoxControllerCompressedIOTest *suite) {
+    delete suite;
+  }
+
+  BoxControllerCompressedIOTest()
+      : m_bc(std::make_shared<BoxController>(4)),
+        m_fileName("BoxCntrlCompressedIOFile.nxs") {}
+
+  void tearDown() override {
+    Poco::File file(m_fullPath);
+    if (!m_fullPath.empty() && file.exists())
+      file.remove();
+    m_fullPath.clear();
+  }
+
+  void test_compress_float_block_round_trip() {
+    const auto events = makeEvents<float>(1000, 4, 7);
+    const auto bytes = BoxControllerCompressedIO::compressBlock(events, 8);
+    TS_ASSERT_LESS_THAN(bytes.size(), events.size() * sizeof(float));
+    std::vector<float> decompressed(events.size());
+    BoxControllerCompressedIO::decompressBlock(bytes, 8, decompressed);
+    TS_ASSERT_EQUALS(events, decompressed);
+  }
+
+  void test_compress_double_block_round_trip() {
+    const auto events = makeEvents<double>(1000, 4, 7);
+    const auto bytes = BoxControllerCompressedIO::compressBlock(events, 8);
+    TS_ASSERT_LESS_THAN(bytes.size(), events.size() * sizeof(double));
+    std::vector<double> decompressed(events.size());
+    BoxControllerCompressedIO::decompressBlock(bytes, 8, decompressed);
+    TS_ASSERT_EQUALS(events, decompressed);
+  }
+
+  void test_decompress_into_wrong_size_throws() {
+    const auto events = makeEvents<float>(10, 4, 1);
+    const auto bytes = BoxControllerCompressedIO::compressBlock(events, 8);
+    std::vector<float> decompressed(events.size() + 8);
+    TS_ASSERT_THROWS(
+        BoxControllerCompressedIO::decompressBlock(bytes, 8, decompressed),
+        const std::runtime_error &);
+  }
+
+  void test_setters() {
+    BoxControllerCompressedIO io(m_bc.get());
+    size_t coordSize;
+    std::string typeName;
+    io.getDataType(coordSize, typeName);
+    TS_ASSERT_EQUALS(4, coordSize);
+    TS_ASSERT_EQUALS("MDEvent", typeName);
+
+    TS_ASSERT_THROWS(io.setDataType(9, typeName),
+                     const std::invalid_argument &);
+    TS_ASSERT_THROWS(io.setDataType(4, "UnknownEvent"),
+                     const std::invalid_argument &);
+    TS_ASSERT_THROWS_NOTHING(io.setDataType(8, "MDLeanEvent"));
+    io.getDataType(coordSize, typeName);
+    TS_ASSERT_EQUALS(8, coordSize);
+    TS_ASSERT_EQUALS("MDLeanEvent", typeName);
+  }
+
+  void test_new_file_does_not_open_to_read() {
+    BoxControllerCompressedIO io(m_bc.get());
+    TS_ASSERT_THROWS(io.openFile(m_fileName, "r"),
+                     const Mantid::Kernel::Exception::FileError &);
+    TS_ASSERT(!io.isOpened());
+  }
+
+  void test_blocks_are_read_back_after_reopening() {
+    BoxControllerCompressedIO io(m_bc.get());
+    io.setDataType(sizeof(float), "MDEvent");
+    TS_ASSERT(io.openFile(m_fileName, "w"));
+    m_fullPath = io.getFileName();
+    const auto first = makeEvents<float>(20, 4, 1);
+    const auto second = makeEvents<float>(30, 4, 2);
+    io.saveBlock(first, 0);
+    io.saveBlock(second, 20);
+    TS_ASSERT_EQUALS(io.getFileLength(), 50);
+    io.closeFile();
+    TS_ASSERT(!io.isOpened());
+
+    TS_ASSERT(io.openFile(m_fullPath, "r"));
+    TS_ASSERT_EQUALS(io.getFileLength(), 50);
+    std::vector<float> events;
+    io.loadBlock(events, 20, 30);
+    TS_ASSERT_EQUALS(events, second);
+    // A range across both blocks
+    io.loadBlock(events, 10, 20);
+    TS_ASSERT_EQUALS(events.size(), 20 * 8);
+    TS_ASSERT(std::equal(first.cbegin() + 10 * 8, first.cend(),
+                         events.cbegin()));
+    TS_ASSERT(std::equal(second.cbegin(), second.cbegin() + 10 * 8,
+                         events.cbegin() + 10 * 8));
+    TS_ASSERT_THROWS(io.loadBlock(events, 40, 20),
+                     const Mantid::Kernel::Exception::FileError &);
+    io.closeFile();
+  }
+
+  void test_rewritten_blocks_are_read_back() {
+    BoxControllerCompressedIO io(m_bc.get());
+    io.setDataType(sizeof(double), "MDEvent");
+    TS_ASSERT(io.openFile(m_fileName, "w"));
+    m_fullPath = io.getFileName();
+    io.saveBlock(makeEvents<double>(100, 4, 1), 0);
+    io.saveBlock(makeEvents<double>(100, 4, 2), 100);
+    const auto size = io.getCompressedSize();
+
+    // A block taking fewer bytes goes back in place
+    const auto smaller = makeEvents<double>(10, 4, 3);
+    io.saveBlock(smaller, 0);
+    TS_ASSERT_EQUALS(io.getCompressedSize(), size);
+    // A larger one goes at the end
+    const auto larger = makeEvents<double>(300, 4, 4);
+    io.saveBlock(larger, 100);
+    TS_ASSERT_LESS_THAN(size, io.getCompressedSize());
+    io.closeFile();
+
+    TS_ASSERT(io.openFile(m_fullPath, "w"));
+    std::vector<double> events;
+    io.loadBlock(events, 0, 10);
+    TS_ASSERT_EQUALS(events, smaller);
+    io.loadBlock(events, 100, 300);
+    TS_ASSERT_EQUALS(events, larger);
+    io.closeFile();
+  }
+
+  void test_space_of_moved_blocks_is_reused() {
+    BoxControllerCompressedIO io(m_bc.get());
+    io.setDataType(sizeof(double), "MDEvent");
+    TS_ASSERT(io.openFile(m_fileName, "w"));
+    m_fullPath = io.getFileName();
+    io.saveBlock(makeEvents<double>(100, 4, 1), 0);
+    io.saveBlock(makeEvents<double>(100, 4, 2), 1000);
+    io.saveBlock(makeEvents<double>(100, 4, 3), 2000);
+    const auto size = io.getCompressedSize();
+
+    // A block growing again and again moves each time it no longer fits, and
+    // the space it leaves at the end of the byte array is taken back
+    std::vector<double> first;
+    for (size_t nEvents = 200; nEvents <= 1000; nEvents += 100) {
+      first = makeEvents<double>(nEvents, 4, 4);
+      io.saveBlock(first, 0);
+    }
+    const auto firstSize =
+        BoxControllerCompressedIO::compressBlock(first, 8).size();
+    TS_ASSERT_LESS_THAN_EQUALS(io.getCompressedSize(), size + firstSize);
+
+    // The second block moves to the space left by the first one
+    const auto grown = io.getCompressedSize();
+    const auto second = makeEvents<double>(150, 4, 5);
+    io.saveBlock(second, 1000);
+    TS_ASSERT_EQUALS(io.getCompressedSize(), grown);
+    io.closeFile();
+
+    // The free space is found again after reopening
+    TS_ASSERT(io.openFile(m_fullPath, "w"));
+    const auto third = makeEvents<double>(700, 4, 6);
+    io.saveBlock(third, 2000);
+    TS_ASSERT_EQUALS(io.getCompressedSize(), grown);
+    std::vector<double> events;
+    io.loadBlock(events, 0, 1000);
+    TS_ASSERT_EQUALS(events, first);
+    io.loadBlock(events, 1000, 150);
+    TS_ASSERT_EQUALS(events, second);
+    io.loadBlock(events, 2000, 700);
+    TS_ASSERT_EQUALS(events, third);
+    io.closeFile();
+  }
+
+  void test_write_double_read_float() {
+    BoxControllerCompressedIO io(m_bc.get());
+    io.setDataType(sizeof(double), "MDLeanEvent");
+    TS_ASSERT(io.openFile(m_fileName, "w"));
+    m_fullPath = io.getFileName();
+    std::vector<double> toWrite(20 * 6);
+    for (size_t i = 0; i < toWrite.size(); ++i)
+      toWrite[i] = 0.5 * static_cast<double>(i);
+    io.saveBlock(toWrite, 0);
+    io.closeFile();
+
+    io.setDataType(sizeof(float), "MDLeanEvent");
+    TS_ASSERT(io.openFile(m_fullPath, "r"));
+    std::vector<float> toRead;
+    io.loadBlock(toRead, 5, 2);
+    TS_ASSERT_EQUALS(toRead.size(), 2 * 6);
+    for (size_t i = 0; i < toRead.size(); ++i)
+      TS_ASSERT_DELTA(toRead[i], toWrite[5 * 6 + i], 1.e-6);
+    io.closeFile();
+  }
+
+private:
+  std::shared_ptr<BoxController> m_bc;
+  std::string m_fileName;
+  std::string m_fullPath;
+};
+
+class BoxControllerCompressedIOTestPerformance : public CxxTest::TestSuite {
+public:
+  static BoxControllerCompressedIOTestPerformance *createSuite() {
+    return new BoxControllerCompressedIOTestPerformance();
+  }
+  static void destroySuite(BoxControllerCompressedIOTestPerformance *suite) {
+    delete suite;
+  }
+
+  BoxControllerCompressedIOTestPerformance()
+      : m_bc(std::make_shared<BoxController>(4)) {
+    for (size_t box = 0; box < NUM_BOXES; ++box)
+      m_boxes.emplace_back(makeEvents<float>(EVENTS_PER_BOX, 4, box));
+  }
+
+  void tearDown() override {
+    for (const auto &name : m_fullPaths) {
+      Poco::File file(name);
+      if (file.exists())
+        file.remove();
+    }
+    m_fullPaths.clear();
+  }
+
+  void test_save_and_load_compressed() {
+    BoxControllerCompressedIO io(m_bc.get());
+    saveAndLoad(io, "BoxCntrlCompressedIOPerf.nxs");
+  }
+
+  void test_save_and_load_uncompressed() {
+    BoxControllerNeXusIO io(m_bc.get());
+    saveAndLoad(io, "BoxCntrlNexusIOPerf.nxs");
+  }
+
+private:
+  static constexpr size_t NUM_BOXES = 2000;
+  static constexpr size_t EVENTS_PER_BOX = 1000;
+
+  void saveAndLoad(Mantid::API::IBoxControllerIO &io,
+                   const std::string &fileName) {
+    io.setDataType(sizeof(float), "MDEvent");
+    io.openFile(fileName, "w");
+    m_fullPaths.emplace_back(io.getFileName());
+    for (size_t box = 0; box < NUM_BOXES; ++box)
+      io.saveBlock(m_boxes[box], box * EVENTS_PER_BOX);
+    io.closeFile();
+
+    io.openFile(m_fullPaths.back(), "r");
+    std::vector<float> events;
+    for (size_t box = 0; box < NUM_BOXES; ++box) {
+      io.loadBlock(events, box * EVENTS_PER_BOX, EVENTS_PER_BOX);
+      TS_ASSERT_EQUALS(events.size(), m_boxes[box].size());
+    }
+    io.closeFile();
+  }
+
+  std::shared_ptr<BoxController> m_bc;
+  std::vector<std::vector<float>> m_boxes;
+  std::vector<std::string> m_fullPaths;
+};
@@ -0,0 +1,152 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidDataObjects/CompactEvents.h"
+
+#include <cxxtest/TestSuite.h>
+
+using namespace Mantid::DataObjects;
+using Mantid::MantidVec;
+using Mantid::Kernel::SplittingInterval;
+using Mantid::Kernel::TimeSplitterType;
+using Mantid::Types::Core::DateAndTime;
+using Mantid::Types::Event::TofEvent;
+
+class CompactEventsTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static CompactEventsTest *createSuite() { return new CompactEventsTest(); }
+  static void destroySuite(CompactEventsTest *suite) { delete suite; }
+
+  void test_event_is_eight_bytes() {
+    TS_ASSERT_EQUALS(sizeof(CompactEvent), 8);
+  }
+
+  void test_makePulseTimeTable_is_sorted_and_unique() {
+    const auto table = CompactEvents::makePulseTimeTable(events());
+    TS_ASSERT_EQUALS(*table, PulseTimeTable({100, 200, 300}));
+  }
+
+  void test_addPulseTimes_then_makePulseTimeTable() {
+    PulseTimeTable times{200, 50};
+    CompactEvents::addPulseTimes(times, events());
+    CompactEvents::addPulseTimes(times, events());
+    const auto table = CompactEvents::makePulseTimeTable(std::move(times));
+    TS_ASSERT_EQUALS(*table, PulseTimeTable({50, 100, 200, 300}));
+  }
+
+  void test_assign_and_extract() {
+    CompactEvents compact;
+    compact.assign(events(), CompactEvents::makePulseTimeTable(events()));
+    TS_ASSERT_EQUALS(compact.size(), 5);
+    TS_ASSERT_EQUALS(compact.events()[0].pulseIndex, 2);
+    TS_ASSERT_EQUALS(compact.events()[3].pulseIndex, 0);
+
+    std::vector<TofEvent> out;
+    compact.extract(out);
+    TS_ASSERT_EQUALS(out, events());
+  }
+
+  void test_assign_throws_if_pulse_is_not_in_table() {
+    CompactEvents compact;
+    TS_ASSERT_THROWS(
+        compact.assign(events(), std::make_shared<PulseTimeTable>(
+                                     PulseTimeTable{100, 300})),
+        const std::invalid_argument &);
+  }
+
+  void test_push_back_only_known_pulses() {
+    CompactEvents compact;
+    TS_ASSERT(!compact.push_back(TofEvent(1., 100)));
+    compact.assign(events(), CompactEvents::makePulseTimeTable(events()));
+    TS_ASSERT(compact.push_back(TofEvent(1., 200)));
+    TS_ASSERT(!compact.push_back(TofEvent(1., 250)));
+    TS_ASSERT_EQUALS(compact.size(), 6);
+    TS_ASSERT_EQUALS(compact.pulseTime(compact.events().back()),
+                     DateAndTime(200));
+  }
+
+  void test_sorting() {
+    CompactEvents compact;
+    compact.assign(events(), CompactEvents::makePulseTimeTable(events()));
+    compact.sortTof();
+    std::vector<double> tofs;
+    compact.getTofs(tofs);
+    TS_ASSERT_EQUALS(tofs, std::vector<double>({1.5, 2.5, 10., 20., 30.}));
+
+    compact.sortPulseTime();
+    TS_ASSERT_EQUALS(compact.pulseTime(compact.events().front()),
+                     DateAndTime(100));
+    TS_ASSERT_EQUALS(compact.pulseTime(compact.events().back()),
+                     DateAndTime(300));
+    TS_ASSERT_EQUALS(compact.getPulseTimeMin(), DateAndTime(100));
+    TS_ASSERT_EQUALS(compact.getPulseTimeMax(), DateAndTime(300));
+  }
+
+  void test_histogram_by_tof() {
+    CompactEvents compact;
+    compact.assign(events(), CompactEvents::makePulseTimeTable(events()));
+    compact.sortTof();
+    const MantidVec X{0., 5., 15., 25.};
+    MantidVec Y, E;
+    compact.histogram(X, Y, E, false);
+    TS_ASSERT_EQUALS(Y, MantidVec({2., 1., 1.}));
+    TS_ASSERT_DELTA(E[0], M_SQRT2, 1e-12);
+  }
+
+  void test_histogram_by_pulse_time_needs_no_sorting() {
+    CompactEvents compact;
+    compact.assign(events(), CompactEvents::makePulseTimeTable(events()));
+    const MantidVec X{150., 250., 350.};
+    MantidVec Y;
+    compact.histogramPulseTime(X, Y);
+    TS_ASSERT_EQUALS(Y, MantidVec({2., 2.}));
+  }
+
+  void test_filterByPulseTime() {
+    CompactEvents compact, output;
+    compact.assign(events(), CompactEvents::makePulseTimeTable(events()));
+    compact.filterByPulseTime(DateAndTime(150), DateAndTime(300), output);
+    TS_ASSERT_EQUALS(output.size(), 2);
+    TS_ASSERT_EQUALS(output.pulseTimeTable(), compact.pulseTimeTable());
+    std::vector<TofEvent> out;
+    output.extract(out);
+    TS_ASSERT_EQUALS(out, std::vector<TofEvent>({{20., 200}, {2.5, 200}}));
+  }
+
+  void test_splitByPulseTime() {
+    CompactEvents compact, between, first, second;
+    compact.assign(events(), CompactEvents::makePulseTimeTable(events()));
+    // 100 is before the first interval, 200 in it, 300 after the last one
+    TimeSplitterType splitter{SplittingInterval(150, 250, 0),
+                              SplittingInterval(260, 280, 1)};
+    std::map<int, CompactEvents *> outputs{
+        {-1, &between}, {0, &first}, {1, &second}};
+    compact.splitByPulseTime(splitter, outputs);
+    TS_ASSERT_EQUALS(between.size(), 1);
+    TS_ASSERT_EQUALS(first.size(), 2);
+    TS_ASSERT_EQUALS(second.size(), 0);
+    TS_ASSERT_EQUALS(first.pulseTime(first.events()[0]), DateAndTime(200));
+  }
+
+  void test_equality_compares_pulse_times() {
+    CompactEvents a, b;
+    a.assign(events(), CompactEvents::makePulseTimeTable(events()));
+    b.assign(events(), std::make_shared<PulseTimeTable>(
+                           PulseTimeTable{50, 100, 200, 300}));
+    TS_ASSERT(a == b);
+    b.convertTof(2., 0.);
+    TS_ASSERT(!(a == b));
+  }
+
+private:
+  static std::vector<TofEvent> events() {
+    return {{10., 300}, {20., 200}, {1.5, 300}, {30., 100}, {2.5, 200}};
+  }
+};
@@ -0,0 +1,118 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidDataObjects/EventColumns.h"
+
+#include <cxxtest/TestSuite.h>
+
+using namespace Mantid::DataObjects;
+using Mantid::MantidVec;
+using Mantid::Types::Event::TofEvent;
+
+class EventColumnsTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static EventColumnsTest *createSuite() { return new EventColumnsTest(); }
+  static void destroySuite(EventColumnsTest *suite) { delete suite; }
+
+  void test_assign_and_extract_tof_events() {
+    std::vector<TofEvent> events{{3.5, 400}, {100., 200}, {50., 60}};
+    EventColumns columns;
+    columns.assign(events);
+    TS_ASSERT_EQUALS(columns.size(), 3);
+    TS_ASSERT(columns.hasPulseTimes());
+    TS_ASSERT(!columns.hasWeights());
+    TS_ASSERT_EQUALS(columns.tofs()[1], 100.);
+    TS_ASSERT_EQUALS(columns.pulseTimes()[2], 60);
+
+    std::vector<TofEvent> out;
+    columns.extract(out);
+    TS_ASSERT_EQUALS(out, events);
+  }
+
+  void test_assign_and_extract_weighted_events() {
+    std::vector<WeightedEvent> events{{3.5, 400, 2.0, 4.0},
+                                      {100., 200, 3.0, 9.0}};
+    EventColumns columns;
+    columns.assign(events);
+    TS_ASSERT(columns.hasPulseTimes());
+    TS_ASSERT(columns.hasWeights());
+
+    std::vector<WeightedEvent> out;
+    columns.extract(out);
+    TS_ASSERT_EQUALS(out, events);
+  }
+
+  void test_sortTof_moves_all_columns() {
+    std::vector<WeightedEvent> events{{100., 200, 1.0, 1.0},
+                                      {3.5, 400, 2.0, 4.0},
+                                      {50., 60, 3.0, 9.0}};
+    EventColumns columns;
+    columns.assign(events);
+    columns.sortTof();
+
+    TS_ASSERT_EQUALS(columns.tofs(), std::vector<double>({3.5, 50., 100.}));
+    TS_ASSERT_EQUALS(columns.pulseTimes(), std::vector<int64_t>({400, 60, 200}));
+    TS_ASSERT_EQUALS(columns.weights(), std::vector<float>({2.f, 3.f, 1.f}));
+    TS_ASSERT_EQUALS(columns.errorSquared(),
+                     std::vector<float>({4.f, 9.f, 1.f}));
+  }
+
+  void test_switching_columns() {
+    std::vector<TofEvent> events{{3.5, 400}, {100., 200}};
+    EventColumns columns;
+    columns.assign(events);
+    columns.addWeights();
+    TS_ASSERT(columns.hasWeights());
+    TS_ASSERT_EQUALS(columns.weights(), std::vector<float>({1.f, 1.f}));
+    columns.dropPulseTimes();
+    TS_ASSERT(!columns.hasPulseTimes());
+    TS_ASSERT(columns.pulseTimes().empty());
+
+    std::vector<WeightedEventNoTime> out;
+    columns.extract(out);
+    TS_ASSERT_EQUALS(out.size(), 2);
+    TS_ASSERT_EQUALS(out[1].tof(), 100.);
+    TS_ASSERT_EQUALS(out[1].weight(), 1.);
+  }
+
+  void test_histogram_counts() {
+    std::vector<TofEvent> events{{0.5}, {1.5}, {1.7}, {2.0}, {3.0}, {-1.0}};
+    EventColumns columns;
+    columns.assign(events);
+    columns.sortTof();
+
+    MantidVec X{0., 1., 2., 3.}, Y, E;
+    columns.histogram(X, Y, E, false);
+    // 3.0 is on the last edge and -1 below the first edge: neither counted
+    TS_ASSERT_EQUALS(Y, MantidVec({1., 2., 1.}));
+    TS_ASSERT_DELTA(E[1], M_SQRT2, 1e-12);
+  }
+
+  void test_histogram_weights() {
+    std::vector<WeightedEventNoTime> events{
+        {0.5, 2.0, 4.0}, {1.5, 1.0, 1.0}, {1.7, 3.0, 3.0}};
+    EventColumns columns;
+    columns.assign(events);
+
+    MantidVec X{0., 1., 2.}, Y, E;
+    columns.histogram(X, Y, E, true);
+    TS_ASSERT_EQUALS(Y, MantidVec({2., 4.}));
+    TS_ASSERT_DELTA(E[0], 2., 1e-12);
+    TS_ASSERT_DELTA(E[1], 2., 1e-12);
+  }
+
+  void test_convertTof() {
+    std::vector<TofEvent> events{{1.}, {2.}};
+    EventColumns columns;
+    columns.assign(events);
+    columns.convertTof(2., 1.);
+    TS_ASSERT_EQUALS(columns.tofs(), std::vector<double>({3., 5.}));
+  }
+};
@@ -0,0 +1,249 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidDataObjects/EventHistogrammer.h"
+
+#include <cxxtest/TestSuite.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace Mantid::DataObjects;
+using Mantid::MantidVec;
+using Mantid::Types::Event::TofEvent;
+using Layout = EventHistogrammer::Layout;
+
+namespace {
+MantidVec linearBins(const double start, const double width,
+                     const size_t numBins) {
+  MantidVec X(numBins + 1);
+  for (size_t i = 0; i <= numBins; ++i)
+    X[i] = start + static_cast<double>(i) * width;
+  return X;
+}
+
+MantidVec logBins(const double start, const double step,
+                  const size_t numBins) {
+  // Built the same way Rebin builds logarithmic bins
+  MantidVec X{start};
+  for (size_t i = 0; i < numBins; ++i)
+    X.emplace_back(X.back() * (1.0 + step));
+  return X;
+}
+
+/// Reference histogram using a binary search per event
+MantidVec referenceCounts(const std::vector<double> &tofs,
+                          const MantidVec &X) {
+  MantidVec Y(X.size() - 1, 0.);
+  for (const double tof : tofs) {
+    if (tof < X.front() || tof >= X.back())
+      continue;
+    const auto it = std::upper_bound(X.cbegin(), X.cend(), tof);
+    Y[std::distance(X.cbegin(), it) - 1] += 1.;
+  }
+  return Y;
+}
+
+std::vector<double> randomTofs(const size_t numEvents, const double maxTof) {
+  std::mt19937 generator(12345);
+  std::uniform_real_distribution<double> distribution(-10., maxTof);
+  std::vector<double> tofs(numEvents);
+  std::generate(tofs.begin(), tofs.end(),
+                [&]() { return distribution(generator); });
+  return tofs;
+}
+} // namespace
+
+class EventHistogrammerTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static EventHistogrammerTest *createSuite() {
+    return new EventHistogrammerTest();
+  }
+  static void destroySuite(EventHistogrammerTest *suite) { delete suite; }
+
+  void test_detectLayout() {
+    TS_ASSERT_EQUALS(EventHistogrammer::detectLayout(MantidVec{}),
+                     Layout::Arbitrary);
+    TS_ASSERT_EQUALS(EventHistogrammer::detectLayout(MantidVec{1.}),
+                     Layout::Arbitrary);
+    TS_ASSERT_EQUALS(EventHistogrammer::detectLayout(MantidVec{1., 2.}),
+                     Layout::Linear);
+    TS_ASSERT_EQUALS(EventHistogrammer::detectLayout(linearBins(-5., 0.1, 500)),
+                     Layout::Linear);
+    TS_ASSERT_EQUALS(EventHistogrammer::detectLayout(logBins(10., 0.01, 500)),
+                     Layout::Logarithmic);
+    TS_ASSERT_EQUALS(
+        EventHistogrammer::detectLayout(MantidVec{0., 1., 5., 6., 100.}),
+        Layout::Arbitrary);
+    // Decreasing edges are never treated as equally spaced
+    TS_ASSERT_EQUALS(EventHistogrammer::detectLayout(MantidVec{3., 2., 1.}),
+                     Layout::Arbitrary);
+  }
+
+  void test_linear_bins_match_reference() {
+    checkAgainstReference(linearBins(0., 0.7, 1000), Layout::Linear);
+  }
+
+  void test_log_bins_match_reference() {
+    checkAgainstReference(logBins(1., 0.004, 2000), Layout::Logarithmic);
+  }
+
+  void test_arbitrary_bins_match_reference() {
+    MantidVec X{0., 1., 2.5, 3., 40., 41., 300., 650., 700.};
+    checkAgainstReference(X, Layout::Arbitrary);
+  }
+
+  void test_events_on_bin_edges() {
+    const MantidVec X = linearBins(0., 0.1, 30);
+    // Each edge belongs to the bin above it; the last edge is excluded
+    std::vector<double> tofs(X.cbegin(), X.cend());
+    MantidVec Y;
+    EventHistogrammer(X).countEvents(tofs.data(), tofs.size(), true, Y);
+    TS_ASSERT_EQUALS(Y, MantidVec(30, 1.));
+  }
+
+  void test_sumWeights() {
+    const MantidVec X{0., 10., 20., 30.};
+    const std::vector<WeightedEvent> events{{25., 0, 2., 4.},
+                                            {5., 0, 1.5, 2.25},
+                                            {-1., 0, 100., 100.},
+                                            {26., 0, 2., 5.}};
+    MantidVec Y, E;
+    EventHistogrammer(X).sumWeights(events, false, Y, E);
+    TS_ASSERT_EQUALS(Y, MantidVec({1.5, 0., 4.}));
+    TS_ASSERT_DELTA(E[0], 1.5, 1e-12);
+    TS_ASSERT_EQUALS(E[1], 0.);
+    TS_ASSERT_DELTA(E[2], 3., 1e-12);
+  }
+
+  void test_output_is_reset() {
+    const MantidVec X{0., 1., 2.};
+    const std::vector<TofEvent> events{{0.5, 0}};
+    MantidVec Y{7., 8.};
+    EventHistogrammer(X).countEvents(events, true, Y);
+    TS_ASSERT_EQUALS(Y, MantidVec({1., 0.}));
+  }
+
+  void test_no_bins_gives_empty_output() {
+    const MantidVec X{1.};
+    const std::vector<TofEvent> events{{0.5, 0}};
+    MantidVec Y{7., 8.};
+    EventHistogrammer(X).countEvents(events, true, Y);
+    TS_ASSERT(Y.empty());
+  }
+
+  void test_layout_of_edges_changed_in_place() {
+    MantidVec X = linearBins(0., 1., 10);
+    TS_ASSERT_EQUALS(EventHistogrammer(X).layout(), Layout::Linear);
+    // A new last edge is seen
+    X.back() = 100.;
+    TS_ASSERT_EQUALS(EventHistogrammer(X).layout(), Layout::Arbitrary);
+    X.back() = 10.;
+    TS_ASSERT_EQUALS(EventHistogrammer(X).layout(), Layout::Linear);
+
+    // Moving an inner edge may leave the layout out of date, but the events
+    // still end up in the right bins
+    X[5] = 5.9;
+    std::vector<double> tofs{0.5, 5.5, 5.95, 6.5, 9.99};
+    const MantidVec reference = referenceCounts(tofs, X);
+    MantidVec Y;
+    EventHistogrammer(X).countEvents(tofs.data(), tofs.size(), true, Y);
+    TS_ASSERT_EQUALS(Y, reference);
+  }
+
+private:
+  void checkAgainstReference(const MantidVec &X, const Layout expected) {
+    const EventHistogrammer histogrammer(X);
+    TS_ASSERT_EQUALS(histogrammer.layout(), expected);
+    TS_ASSERT_EQUALS(histogrammer.numBins(), X.size() - 1);
+
+    auto tofs = randomTofs(50000, X.back() * 1.1);
+    // Make sure the edges themselves are exercised
+    tofs.insert(tofs.end(), X.cbegin(), X.cend());
+    const MantidVec reference = referenceCounts(tofs, X);
+
+    MantidVec Y;
+    histogrammer.countEvents(tofs.data(), tofs.size(), false, Y);
+    TS_ASSERT_EQUALS(Y, reference);
+
+    std::vector<WeightedEventNoTime> weighted;
+    for (const double tof : tofs)
+      weighted.emplace_back(tof, 2.0f, 4.0f);
+    MantidVec E;
+    histogrammer.sumWeights(weighted, false, Y, E);
+    for (size_t i = 0; i < reference.size(); ++i) {
+      TS_ASSERT_EQUALS(Y[i], 2. * reference[i]);
+      TS_ASSERT_DELTA(E[i], 2. * std::sqrt(reference[i]), 1e-9);
+    }
+
+    std::sort(tofs.begin(), tofs.end());
+    histogrammer.countEvents(tofs.data(), tofs.size(), true, Y);
+    TS_ASSERT_EQUALS(Y, reference);
+
+    std::vector<TofEvent> events;
+    for (const double tof : tofs)
+      events.emplace_back(tof, 0);
+    histogrammer.countEvents(events, true, Y);
+    TS_ASSERT_EQUALS(Y, reference);
+  }
+};
+
+class EventHistogrammerTestPerformance : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static EventHistogrammerTestPerformance *createSuite() {
+    return new EventHistogrammerTestPerformance();
+  }
+  static void destroySuite(EventHistogrammerTestPerformance *suite) {
+    delete suite;
+  }
+
+  EventHistogrammerTestPerformance()
+      : m_unsorted(randomTofs(10000000, 100000.)), m_sorted(m_unsorted),
+        m_linearX(linearBins(0., 1., 100000)),
+        m_logX(logBins(1., 0.0001, 115000)),
+        m_arbitraryX(m_linearX) {
+    std::sort(m_sorted.begin(), m_sorted.end());
+    for (const double tof : m_sorted)
+      m_sortedEvents.emplace_back(tof, 0);
+    // Nudge one edge so the fast path cannot be used
+    m_arbitraryX[1] = 0.5;
+  }
+
+  void test_linear_sorted() { count(m_linearX, m_sorted, true); }
+  void test_linear_unsorted() { count(m_linearX, m_unsorted, false); }
+  void test_log_sorted() { count(m_logX, m_sorted, true); }
+  void test_log_unsorted() { count(m_logX, m_unsorted, false); }
+  void test_arbitrary_sorted() { count(m_arbitraryX, m_sorted, true); }
+  void test_arbitrary_unsorted() { count(m_arbitraryX, m_unsorted, false); }
+
+  void test_linear_sorted_tof_events() {
+    MantidVec Y;
+    EventHistogrammer(m_linearX).countEvents(m_sortedEvents, true, Y);
+    TS_ASSERT_EQUALS(Y.size(), m_linearX.size() - 1);
+  }
+
+private:
+  void count(const MantidVec &X, const std::vector<double> &tofs,
+             const bool sorted) {
+    MantidVec Y;
+    EventHistogrammer(X).countEvents(tofs.data(), tofs.size(), sorted, Y);
+    TS_ASSERT_EQUALS(Y.size(), X.size() - 1);
+  }
+
+  std::vector<double> m_unsorted;
+  std::vector<double> m_sorted;
+  std::vector<TofEvent> m_sortedEvents;
+  MantidVec m_linearX;
+  MantidVec m_logX;
+  MantidVec m_arbitraryX;
+};
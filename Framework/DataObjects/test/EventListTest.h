@@ -11,6 +11,7 @@
 #include "MantidDataObjects/EventWorkspace.h"
 #include "MantidDataObjects/Histogram1D.h"
 #include "MantidKernel/CPUTimer.h"
+#include "MantidKernel/MultiThreaded.h"
 #include "MantidKernel/Timer.h"
 #include "MantidKernel/Unit.h"
 
@@ -928,6 +929,288 @@ public:
     }
   }
 
+  void test_column_storage_round_trip_all_types() {
+    for (int this_type = 0; this_type < 3; this_type++) {
+      this->fake_data();
+      el.switchTo(static_cast<EventType>(this_type));
+      const EventList rows(el);
+
+      el.setStorageType(COLUMN_STORAGE);
+      TS_ASSERT_EQUALS(el.getStorageType(), COLUMN_STORAGE);
+      TS_ASSERT_EQUALS(el.getNumberEvents(), rows.getNumberEvents());
+      TS_ASSERT_EQUALS(el.getEventType(), rows.getEventType());
+
+      el.setStorageType(ROW_STORAGE);
+      TS_ASSERT_EQUALS(el.getStorageType(), ROW_STORAGE);
+      TS_ASSERT_EQUALS(el, rows);
+    }
+  }
+
+  void test_column_storage_histogram_matches_row_storage_all_types() {
+    MantidVec X;
+    for (double tof = 0; tof < MAX_TOF; tof += BIN_DELTA)
+      X.emplace_back(tof);
+
+    for (int this_type = 0; this_type < 3; this_type++) {
+      this->fake_data();
+      el.switchTo(static_cast<EventType>(this_type));
+      EventList columns(el);
+      columns.setStorageType(COLUMN_STORAGE);
+
+      MantidVec rowY, rowE, columnY, columnE;
+      el.generateHistogram(X, rowY, rowE);
+      columns.generateHistogram(X, columnY, columnE);
+      // Histogramming must not force the list back to rows
+      TS_ASSERT_EQUALS(columns.getStorageType(), COLUMN_STORAGE);
+      TS_ASSERT_EQUALS(columns.getSortType(), TOF_SORT);
+      TS_ASSERT_EQUALS(rowY.size(), columnY.size());
+      for (size_t i = 0; i < rowY.size(); ++i) {
+        TS_ASSERT_DELTA(rowY[i], columnY[i], 1e-6);
+        TS_ASSERT_DELTA(rowE[i], columnE[i], 1e-6);
+      }
+    }
+  }
+
+  void test_column_storage_convertTof_and_sort() {
+    this->fake_data();
+    EventList columns(el);
+    columns.setStorageType(COLUMN_STORAGE);
+
+    el.convertTof(2.5, 6.78);
+    columns.convertTof(2.5, 6.78);
+    el.sortTof();
+    columns.sortTof();
+    TS_ASSERT_EQUALS(columns.getStorageType(), COLUMN_STORAGE);
+    TS_ASSERT_EQUALS(columns.getTofs(), el.getTofs());
+    TS_ASSERT_EQUALS(columns.getTofMin(), el.getTofMin());
+    TS_ASSERT_EQUALS(columns.getTofMax(), el.getTofMax());
+
+    // Row access goes back to row storage and sees the same events
+    TS_ASSERT_EQUALS(columns.getEvents(), el.getEvents());
+    TS_ASSERT_EQUALS(columns.getStorageType(), ROW_STORAGE);
+  }
+
+  void test_column_storage_switchTo_keeps_columns() {
+    this->fake_data();
+    EventList columns(el);
+    columns.setStorageType(COLUMN_STORAGE);
+
+    el.switchTo(WEIGHTED);
+    columns.switchTo(WEIGHTED);
+    TS_ASSERT_EQUALS(columns.getStorageType(), COLUMN_STORAGE);
+    TS_ASSERT_EQUALS(columns.getEventType(), WEIGHTED);
+    TS_ASSERT_EQUALS(columns.getWeightedEvents(), el.getWeightedEvents());
+
+    columns.setStorageType(COLUMN_STORAGE);
+    el.switchTo(WEIGHTED_NOTIME);
+    columns.switchTo(WEIGHTED_NOTIME);
+    TS_ASSERT_EQUALS(columns.getStorageType(), COLUMN_STORAGE);
+    TS_ASSERT_EQUALS(columns.getWeightedEventsNoTime(),
+                     el.getWeightedEventsNoTime());
+  }
+
+  void test_column_storage_clear_keeps_columns() {
+    this->fake_data();
+    el.setStorageType(COLUMN_STORAGE);
+    el.clear();
+    TS_ASSERT_EQUALS(el.getStorageType(), COLUMN_STORAGE);
+    TS_ASSERT(el.empty());
+    el.addEventQuickly(TofEvent(5., 100));
+    TS_ASSERT_EQUALS(el.getStorageType(), COLUMN_STORAGE);
+    TS_ASSERT_EQUALS(el.getNumberEvents(), 1);
+  }
+
+  void test_const_access_keeps_column_storage() {
+    this->fake_data();
+    const EventList rows(el);
+    el.setStorageType(COLUMN_STORAGE);
+    const EventList &columns = el;
+
+    TS_ASSERT_EQUALS(columns.getEvents(), rows.getEvents());
+    TS_ASSERT_EQUALS(columns.getPulseTimes(), rows.getPulseTimes());
+    TS_ASSERT_EQUALS(columns.getPulseTimeMax(), rows.getPulseTimeMax());
+    TS_ASSERT_EQUALS(columns, rows);
+    TS_ASSERT_EQUALS(columns.getStorageType(), COLUMN_STORAGE);
+
+    // Sorting by pulse time reorders the columns and the row copy
+    rows.sortPulseTime();
+    columns.sortPulseTime();
+    TS_ASSERT_EQUALS(columns.getStorageType(), COLUMN_STORAGE);
+    TS_ASSERT_EQUALS(columns.getEvents(), rows.getEvents());
+    TS_ASSERT_EQUALS(columns.getTofs(), rows.getTofs());
+
+    // Changing the columns drops the row copy
+    el.convertTof(2., 0.);
+    EventList converted(rows);
+    converted.convertTof(2., 0.);
+    TS_ASSERT_EQUALS(columns.getEvents(), converted.getEvents());
+    TS_ASSERT_EQUALS(columns.getStorageType(), COLUMN_STORAGE);
+  }
+
+  void test_column_storage_accessors_do_not_make_a_row_copy() {
+    for (int this_type = 0; this_type < 3; this_type++) {
+      this->fake_data();
+      el.switchTo(static_cast<EventType>(this_type));
+      const EventList rows(el);
+      el.setStorageType(COLUMN_STORAGE);
+      const EventList &columns = el;
+      const size_t memory = columns.getMemorySize();
+
+      TS_ASSERT_EQUALS(columns.getTofs(), rows.getTofs());
+      TS_ASSERT_EQUALS(columns.getWeights(), rows.getWeights());
+      TS_ASSERT_EQUALS(columns.getWeightErrors(), rows.getWeightErrors());
+      if (this_type != WEIGHTED_NOTIME)
+        TS_ASSERT_EQUALS(columns.getPulseTimes(), rows.getPulseTimes());
+      TS_ASSERT_EQUALS(columns.getMemorySize(), memory);
+    }
+  }
+
+  void test_concurrent_const_access_with_column_storage() {
+    MantidVec X;
+    for (double tof = 0; tof < MAX_TOF; tof += BIN_DELTA)
+      X.emplace_back(tof);
+    this->fake_data();
+    el.switchTo(WEIGHTED);
+    el.sortTof();
+    const auto rowEvents = el.getWeightedEvents();
+    el.setStorageType(COLUMN_STORAGE);
+    const EventList &columns = el;
+    MantidVec columnY, columnE;
+    columns.generateHistogram(X, columnY, columnE);
+
+    constexpr int numThreads = 16;
+    std::vector<int> failures(numThreads, 0);
+    PARALLEL_FOR_NO_WSP_CHECK()
+    for (int i = 0; i < numThreads; ++i) {
+      // Readers of the rows and histogramming from the columns interleave
+      if (i % 2 == 0) {
+        if (columns.getWeightedEvents() != rowEvents)
+          ++failures[i];
+      } else {
+        MantidVec Y, E;
+        columns.generateHistogram(X, Y, E);
+        if (Y != columnY)
+          ++failures[i];
+      }
+    }
+    TS_ASSERT_EQUALS(failures, std::vector<int>(numThreads, 0));
+    TS_ASSERT_EQUALS(columns.getStorageType(), COLUMN_STORAGE);
+    TS_ASSERT_EQUALS(columns.getWeightedEvents(), rowEvents);
+  }
+
+  void test_compact_storage_halves_memory_and_keeps_pulse_times() {
+    this->fake_data();
+    EventList compact(el);
+    compact.setStorageType(COMPACT_STORAGE);
+    TS_ASSERT_EQUALS(compact.getStorageType(), COMPACT_STORAGE);
+    TS_ASSERT_EQUALS(compact.getNumberEvents(), el.getNumberEvents());
+    TS_ASSERT_EQUALS(compact.getMemorySize() - sizeof(EventList),
+                     NUMEVENTS * sizeof(CompactEvent));
+    TS_ASSERT_LESS_THAN(compact.getMemorySize(), el.getMemorySize());
+    TS_ASSERT_EQUALS(compact.getPulseTimes(), el.getPulseTimes());
+    TS_ASSERT_EQUALS(compact.getPulseTimeMin(), el.getPulseTimeMin());
+    TS_ASSERT_EQUALS(compact.getPulseTimeMax(), el.getPulseTimeMax());
+    TS_ASSERT_EQUALS(compact.getStorageType(), COMPACT_STORAGE);
+
+    // Times of flight are kept in single precision
+    const auto events = compact.getEvents();
+    TS_ASSERT_EQUALS(compact.getStorageType(), ROW_STORAGE);
+    for (size_t i = 0; i < events.size(); ++i)
+      TS_ASSERT_DELTA(events[i].tof(), el.getEvent(i).tof(), 1.);
+  }
+
+  void test_compact_storage_needs_unweighted_events() {
+    this->fake_data(WEIGHTED);
+    TS_ASSERT_THROWS(el.setStorageType(COMPACT_STORAGE),
+                     const std::runtime_error &);
+    TS_ASSERT_EQUALS(el.getStorageType(), ROW_STORAGE);
+  }
+
+  void test_compact_storage_addEventQuickly_with_unknown_pulse() {
+    this->fake_data_only_two_times(100, 200);
+    el.setStorageType(COMPACT_STORAGE);
+    el.addEventQuickly(TofEvent(5., 100));
+    TS_ASSERT_EQUALS(el.getStorageType(), COMPACT_STORAGE);
+    el.addEventQuickly(TofEvent(5., 150));
+    TS_ASSERT_EQUALS(el.getStorageType(), ROW_STORAGE);
+    TS_ASSERT_EQUALS(el.getNumberEvents(), 4);
+    TS_ASSERT_EQUALS(el.getEvent(3).pulseTime(), DateAndTime(150));
+  }
+
+  void test_compact_storage_filterByPulseTime_stays_compact() {
+    this->fake_data();
+    EventList compact(el);
+    compact.setStorageType(COMPACT_STORAGE);
+
+    EventList rowsOut, compactOut;
+    el.filterByPulseTime(100, 200, rowsOut);
+    compact.filterByPulseTime(100, 200, compactOut);
+    TS_ASSERT_EQUALS(compact.getStorageType(), COMPACT_STORAGE);
+    TS_ASSERT_EQUALS(compactOut.getStorageType(), COMPACT_STORAGE);
+    TS_ASSERT_EQUALS(compactOut.getNumberEvents(), rowsOut.getNumberEvents());
+    TS_ASSERT_LESS_THAN_EQUALS(DateAndTime(100), compactOut.getPulseTimeMin());
+    TS_ASSERT_LESS_THAN(compactOut.getPulseTimeMax(), DateAndTime(200));
+  }
+
+  void test_compact_storage_splitByPulseTime_matches_rows() {
+    this->fake_data();
+    EventList compact(el);
+    compact.setStorageType(COMPACT_STORAGE);
+
+    TimeSplitterType split{SplittingInterval(100, 200, 0),
+                           SplittingInterval(300, 400, 1)};
+    std::vector<EventList> rowsOut(3), compactOut(3);
+    std::map<int, EventList *> rowsOutputs{
+        {-1, &rowsOut[0]}, {0, &rowsOut[1]}, {1, &rowsOut[2]}};
+    std::map<int, EventList *> compactOutputs{
+        {-1, &compactOut[0]}, {0, &compactOut[1]}, {1, &compactOut[2]}};
+    el.splitByPulseTime(split, rowsOutputs);
+    compact.splitByPulseTime(split, compactOutputs);
+
+    for (size_t i = 0; i < 3; ++i) {
+      TS_ASSERT_EQUALS(compactOut[i].getStorageType(), COMPACT_STORAGE);
+      TS_ASSERT_EQUALS(compactOut[i].getNumberEvents(),
+                       rowsOut[i].getNumberEvents());
+      rowsOut[i].sortPulseTime();
+      compactOut[i].sortPulseTime();
+      TS_ASSERT_EQUALS(compactOut[i].getPulseTimes(),
+                       rowsOut[i].getPulseTimes());
+    }
+  }
+
+  void test_compact_storage_histogram_by_pulse_time() {
+    EventList rows = this->fake_uniform_pulse_data();
+    EventList compact(rows);
+    compact.setStorageType(COMPACT_STORAGE);
+
+    MantidVec X;
+    for (int pulse_time = 0; pulse_time < BIN_DELTA * (NUMBINS + 1);
+         pulse_time += BIN_DELTA)
+      X.emplace_back(pulse_time);
+    MantidVec rowsY, rowsE, compactY, compactE;
+    rows.generateHistogramPulseTime(X, rowsY, rowsE);
+    compact.generateHistogramPulseTime(X, compactY, compactE);
+    TS_ASSERT_EQUALS(compact.getStorageType(), COMPACT_STORAGE);
+    TS_ASSERT_EQUALS(compactY, rowsY);
+    TS_ASSERT_EQUALS(compactE, rowsE);
+  }
+
+  void test_compact_storage_histogram_by_tof() {
+    this->fake_uniform_data();
+    EventList rows(el);
+    EventList compact(el);
+    compact.setStorageType(COMPACT_STORAGE);
+
+    MantidVec X;
+    for (double tof = 0; tof < MAX_TOF; tof += BIN_DELTA)
+      X.emplace_back(tof);
+    MantidVec rowsY, rowsE, compactY, compactE;
+    rows.generateHistogram(X, rowsY, rowsE);
+    compact.generateHistogram(X, compactY, compactE);
+    TS_ASSERT_EQUALS(compact.getStorageType(), COMPACT_STORAGE);
+    TS_ASSERT_EQUALS(compactY, rowsY);
+  }
+
   void test_histogram_tof_event_by_pulse_time() {
     // Generate TOF events with Pulse times uniformly distributed.
     EventList eList = this->fake_uniform_pulse_data();
@@ -1681,6 +1964,23 @@ public:
     }
   }
 
+  void test_sortPulseTime_keeps_loaded_order_within_a_pulse() {
+    // Enough events for the radix sort, in reverse pulse order and with the
+    // tofs of each pulse decreasing
+    EventList el;
+    for (int pulse = 99; pulse >= 0; --pulse)
+      for (int i = 0; i < 50; ++i)
+        el += TofEvent(1000. - i, pulse);
+
+    el.sortPulseTime();
+    for (size_t i = 1; i < el.getNumberEvents(); i++) {
+      TS_ASSERT_LESS_THAN_EQUALS(el.getEvent(i - 1).pulseTime(),
+                                 el.getEvent(i).pulseTime());
+      if (el.getEvent(i - 1).pulseTime() == el.getEvent(i).pulseTime())
+        TS_ASSERT_LESS_THAN(el.getEvent(i).tof(), el.getEvent(i - 1).tof());
+    }
+  }
+
   //-----------------------------------------------------------------------------------------------
   void test_filterByPulseTime() {
     // Go through each possible EventType (except the no-time one) as the input
@@ -2942,6 +3242,8 @@ public:
 
   void test_sort_tof() { el_random.sortTof(); }
 
+  void test_sort_pulse_time() { el_random.sortPulseTime(); }
+
   void test_compressEvents() {
     EventList out_el;
     el_sorted.compressEvents(10.0, &out_el);
@@ -2975,6 +3277,22 @@ public:
     el_sorted_weighted.generateHistogram(coarseX, Y, E);
   }
 
+  void test_histogram_fine_column_storage() {
+    el_sorted.setStorageType(COLUMN_STORAGE);
+    MantidVec Y, E;
+    el_sorted.generateHistogram(fineX, Y, E);
+  }
+
+  void test_convertTof_column_storage() {
+    el_random.setStorageType(COLUMN_STORAGE);
+    el_random.convertTof(2.5, 6.78);
+  }
+
+  void test_sort_tof_column_storage() {
+    el_random.setStorageType(COLUMN_STORAGE);
+    el_random.sortTof();
+  }
+
   void test_maskTof() {
     TS_ASSERT_EQUALS(el_sorted.getNumberEvents(), 10000000);
     el_sorted.maskTof(25e3, 75e3);
@@ -0,0 +1,186 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidDataObjects/CompactEvents.h"
+#include "MantidDataObjects/EventSorter.h"
+
+#include <cxxtest/TestSuite.h>
+
+#include <algorithm>
+#include <random>
+
+using namespace Mantid::DataObjects;
+using Mantid::Types::Event::TofEvent;
+
+class EventSorterTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static EventSorterTest *createSuite() { return new EventSorterTest(); }
+  static void destroySuite(EventSorterTest *suite) { delete suite; }
+
+  void test_chooseStrategy() {
+    TS_ASSERT_EQUALS(EventSorter::chooseStrategy(10),
+                     EventSorter::Strategy::Comparison);
+    TS_ASSERT_EQUALS(EventSorter::chooseStrategy(10000),
+                     EventSorter::Strategy::Radix);
+    TS_ASSERT_EQUALS(EventSorter::chooseStrategy(10000000),
+                     EventSorter::Strategy::ParallelRadix);
+  }
+
+  void test_sortTof_matches_stable_sort() {
+    for (const auto strategy : strategies()) {
+      auto events = randomEvents(300000);
+      auto expected = events;
+      std::stable_sort(expected.begin(), expected.end(),
+                       [](const TofEvent &a, const TofEvent &b) {
+                         return a.tof() < b.tof();
+                       });
+      EventSorter(strategy).sortTof(events);
+      TS_ASSERT(sameOrder(events, expected));
+    }
+  }
+
+  void test_sortTof_negative_values() {
+    for (const auto strategy : strategies()) {
+      std::vector<WeightedEventNoTime> events{{5., 1., 1.},  {-2.5, 1., 1.},
+                                              {0., 1., 1.},  {-100., 1., 1.},
+                                              {1e-3, 1., 1.}, {-1e-3, 1., 1.}};
+      EventSorter(strategy).sortTof(events);
+      TS_ASSERT(std::is_sorted(events.cbegin(), events.cend()));
+    }
+  }
+
+  void test_sortPulseTime_keeps_loaded_order_of_equal_pulses() {
+    for (const auto strategy : strategies()) {
+      auto events = randomEvents(300000);
+      auto expected = events;
+      std::stable_sort(expected.begin(), expected.end(),
+                       [](const TofEvent &a, const TofEvent &b) {
+                         return a.pulseTime() < b.pulseTime();
+                       });
+      EventSorter(strategy).sortPulseTime(events);
+      TS_ASSERT(sameOrder(events, expected));
+    }
+  }
+
+  void test_sortPulseTimeTof() {
+    for (const auto strategy : strategies()) {
+      auto events = randomEvents(300000);
+      std::vector<WeightedEvent> weighted(events.cbegin(), events.cend());
+      EventSorter(strategy).sortPulseTimeTof(weighted);
+      TS_ASSERT(std::is_sorted(
+          weighted.cbegin(), weighted.cend(),
+          [](const WeightedEvent &a, const WeightedEvent &b) {
+            return a.pulseTime() < b.pulseTime() ||
+                   (a.pulseTime() == b.pulseTime() && a.tof() < b.tof());
+          }));
+    }
+  }
+
+  void test_sortTimeAtSample() {
+    const double tofFactor = 0.5;
+    const double tofShift = 1e-6;
+    const auto timeAtSample = [=](const TofEvent &event) {
+      return calculateCorrectedFullTime(event, tofFactor, tofShift);
+    };
+    for (const auto strategy : strategies()) {
+      auto events = randomEvents(300000);
+      EventSorter(strategy).sortTimeAtSample(events, tofFactor, tofShift);
+      TS_ASSERT(std::is_sorted(events.cbegin(), events.cend(),
+                               [&](const TofEvent &a, const TofEvent &b) {
+                                 return timeAtSample(a) < timeAtSample(b);
+                               }));
+    }
+  }
+
+  void test_sort_compact_events() {
+    for (const auto strategy : strategies()) {
+      std::vector<CompactEvent> events{
+          {3.f, 2}, {1.f, 0}, {2.f, 2}, {-1.f, 1}, {2.f, 0}};
+      EventSorter(strategy).sortTof(events);
+      TS_ASSERT_EQUALS(events[0].tof, -1.f);
+      TS_ASSERT_EQUALS(events[2].pulseIndex, 2);
+      TS_ASSERT_EQUALS(events[3].pulseIndex, 0);
+      EventSorter(strategy).sortPulseTime(events);
+      TS_ASSERT_EQUALS(events[0].tof, 1.f);
+      TS_ASSERT_EQUALS(events[1].tof, 2.f);
+      TS_ASSERT_EQUALS(events[4].tof, 3.f);
+    }
+  }
+
+private:
+  static std::vector<EventSorter::Strategy> strategies() {
+    return {EventSorter::Strategy::Automatic,
+            EventSorter::Strategy::Comparison, EventSorter::Strategy::Radix,
+            EventSorter::Strategy::ParallelRadix};
+  }
+
+  /// Events from 1000 pulses of a run with many equal times-of-flight
+  static std::vector<TofEvent> randomEvents(const size_t numEvents) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> tof(0, 20000);
+    std::uniform_int_distribution<int64_t> pulse(0, 999);
+    const int64_t runStart = 1000000000000000000;
+    std::vector<TofEvent> events;
+    events.reserve(numEvents);
+    for (size_t i = 0; i < numEvents; ++i)
+      events.emplace_back(0.5 * tof(generator),
+                          runStart + 16666667 * pulse(generator));
+    return events;
+  }
+
+  /// Compare all of both fields, which TofEvent::operator== does not
+  static bool sameOrder(const std::vector<TofEvent> &a,
+                        const std::vector<TofEvent> &b) {
+    return std::equal(a.cbegin(), a.cend(), b.cbegin(), b.cend(),
+                      [](const TofEvent &x, const TofEvent &y) {
+                        return x.tof() == y.tof() &&
+                               x.pulseTime() == y.pulseTime();
+                      });
+  }
+};
+
+class EventSorterTestPerformance : public CxxTest::TestSuite {
+public:
+  static EventSorterTestPerformance *createSuite() {
+    return new EventSorterTestPerformance();
+  }
+  static void destroySuite(EventSorterTestPerformance *suite) { delete suite; }
+
+  EventSorterTestPerformance() : m_events(20000000) {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> tof(0., 20000.);
+    std::uniform_int_distribution<int64_t> pulse(0, 71999);
+    for (auto &event : m_events)
+      event = TofEvent(tof(generator), 16666667 * pulse(generator));
+  }
+
+  void test_sortTof_comparison() {
+    auto events = m_events;
+    EventSorter(EventSorter::Strategy::Comparison).sortTof(events);
+  }
+
+  void test_sortTof_radix() {
+    auto events = m_events;
+    EventSorter(EventSorter::Strategy::Radix).sortTof(events);
+  }
+
+  void test_sortTof_parallel_radix() {
+    auto events = m_events;
+    EventSorter(EventSorter::Strategy::ParallelRadix).sortTof(events);
+  }
+
+  void test_sortPulseTime_parallel_radix() {
+    auto events = m_events;
+    EventSorter(EventSorter::Strategy::ParallelRadix).sortPulseTime(events);
+  }
+
+private:
+  std::vector<TofEvent> m_events;
+};
@@ -0,0 +1,134 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidDataObjects/EventSplitter.h"
+
+#include <cxxtest/TestSuite.h>
+
+#include <algorithm>
+#include <random>
+
+using namespace Mantid::DataObjects;
+using Mantid::Types::Event::TofEvent;
+
+class EventSplitterTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static EventSplitterTest *createSuite() { return new EventSplitterTest(); }
+  static void destroySuite(EventSplitterTest *suite) { delete suite; }
+
+  void test_constructor_checks_splitters() {
+    TS_ASSERT_THROWS(EventSplitter({0, 10, 20}, {0}, EventSplitter::NO_OUTPUT),
+                     const std::invalid_argument &);
+    TS_ASSERT_THROWS(EventSplitter({0, 20, 10}, {0, 1}, 2),
+                     const std::invalid_argument &);
+    TS_ASSERT_THROWS_NOTHING(
+        EventSplitter({0, 10, 20}, {0, 1}, EventSplitter::NO_OUTPUT));
+  }
+
+  void test_findInterval() {
+    const EventSplitter splitter({0, 10, 20, 30, 40, 50, 60},
+                                 {0, 1, 2, 3, 4, 5}, EventSplitter::NO_OUTPUT);
+    for (const size_t hint : {0, 2, 5}) {
+      TS_ASSERT_EQUALS(splitter.findInterval(-1, hint), EventSplitter::OUTSIDE);
+      TS_ASSERT_EQUALS(splitter.findInterval(0, hint), 0);
+      TS_ASSERT_EQUALS(splitter.findInterval(9, hint), 0);
+      TS_ASSERT_EQUALS(splitter.findInterval(10, hint), 1);
+      TS_ASSERT_EQUALS(splitter.findInterval(35, hint), 3);
+      TS_ASSERT_EQUALS(splitter.findInterval(59, hint), 5);
+      TS_ASSERT_EQUALS(splitter.findInterval(60, hint), EventSplitter::OUTSIDE);
+    }
+  }
+
+  void test_split_with_outside_and_dropped_events() {
+    // Pulse times in nanoseconds, times-of-flight of one microsecond
+    std::vector<TofEvent> events;
+    for (const int64_t pulse : {5, 15, 25, 35, 100, 12, 0, -100})
+      events.emplace_back(1., pulse);
+    std::vector<TofEvent> first;
+    std::vector<TofEvent> second;
+    std::vector<TofEvent> outside;
+    // [1005, 1020) -> 0, [1020, 1030) -> dropped, [1030, 1050) -> 1
+    const EventSplitter splitter({1005, 1020, 1030, 1050},
+                                 {0, EventSplitter::NO_OUTPUT, 1}, 2);
+    splitter.split(events, {&first, &second, &outside}, false, 1., 0.);
+    TS_ASSERT_EQUALS(first.size(), 3);
+    TS_ASSERT_EQUALS(second.size(), 1);
+    TS_ASSERT_EQUALS(outside.size(), 3);
+    // The order of the input is kept
+    TS_ASSERT_EQUALS(first[0].pulseTime().totalNanoseconds(), 5);
+    TS_ASSERT_EQUALS(first[1].pulseTime().totalNanoseconds(), 15);
+    TS_ASSERT_EQUALS(first[2].pulseTime().totalNanoseconds(), 12);
+    TS_ASSERT_EQUALS(second[0].pulseTime().totalNanoseconds(), 35);
+    TS_ASSERT_EQUALS(outside[0].pulseTime().totalNanoseconds(), 100);
+    TS_ASSERT_EQUALS(outside[2].pulseTime().totalNanoseconds(), -100);
+  }
+
+  void test_split_with_correction() {
+    const std::vector<WeightedEvent> events{WeightedEvent(1000., 0, 2., 4.)};
+    std::vector<WeightedEvent> early;
+    std::vector<WeightedEvent> late;
+    const EventSplitter splitter({0, 1000000, 2000000}, {0, 1},
+                                 EventSplitter::NO_OUTPUT);
+    // 1000 us * 0.5 + 1 ms = 1.5 ms
+    splitter.split(events, {&early, &late}, true, 0.5, 1e-3);
+    TS_ASSERT(early.empty());
+    TS_ASSERT_EQUALS(late.size(), 1);
+    TS_ASSERT_EQUALS(late[0].weight(), 2.);
+  }
+
+  void test_split_matches_binary_search() {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int64_t> pulse(0, 999);
+    std::uniform_real_distribution<double> tof(0., 16000.);
+    std::vector<TofEvent> events;
+    for (size_t i = 0; i < 300000; ++i)
+      events.emplace_back(tof(generator), pulse(generator) * 16666667);
+    std::sort(events.begin(), events.end(),
+              [](const TofEvent &a, const TofEvent &b) {
+                return a.pulseTime() < b.pulseTime() ||
+                       (a.pulseTime() == b.pulseTime() && a.tof() < b.tof());
+              });
+
+    // 2000 splitters of random length into 7 outputs
+    std::uniform_int_distribution<int64_t> length(1000000, 15000000);
+    std::uniform_int_distribution<int> target(0, 6);
+    std::vector<int64_t> times{1000000};
+    std::vector<int> destinations;
+    for (size_t i = 0; i < 2000; ++i) {
+      times.emplace_back(times.back() + length(generator));
+      destinations.emplace_back(target(generator));
+    }
+    std::vector<std::vector<TofEvent>> outputs(7);
+    std::vector<std::vector<TofEvent> *> outputPointers;
+    for (auto &output : outputs)
+      outputPointers.emplace_back(&output);
+    EventSplitter(times, destinations, EventSplitter::NO_OUTPUT)
+        .split(events, outputPointers, false, 1., 0.);
+
+    std::vector<std::vector<TofEvent>> expected(7);
+    for (const auto &event : events) {
+      const int64_t time = event.pulseTime().totalNanoseconds() +
+                           static_cast<int64_t>(event.tof() * 1000);
+      const auto bound = std::upper_bound(times.cbegin(), times.cend(), time);
+      if (bound == times.cbegin() || bound == times.cend())
+        continue;
+      expected[destinations[bound - times.cbegin() - 1]].emplace_back(event);
+    }
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      TS_ASSERT_EQUALS(outputs[i].size(), expected[i].size());
+      TS_ASSERT(std::equal(outputs[i].cbegin(), outputs[i].cend(),
+                           expected[i].cbegin(), expected[i].cend(),
+                           [](const TofEvent &a, const TofEvent &b) {
+                             return a.tof() == b.tof() &&
+                                    a.pulseTime() == b.pulseTime();
+                           }));
+    }
+  }
+};
@@ -612,6 +612,60 @@ public:
     }
   }
 
+  void test_setStorageType() {
+    EventWorkspace_sptr ws =
+        WorkspaceCreationHelper::createRandomEventWorkspace(NUMBINS, NUMPIXELS);
+    const auto numEvents = ws->getNumberEvents();
+    TS_ASSERT_EQUALS(ws->getStorageType(), ROW_STORAGE);
+
+    ws->setStorageType(COLUMN_STORAGE);
+    TS_ASSERT_EQUALS(ws->getStorageType(), COLUMN_STORAGE);
+    TS_ASSERT_EQUALS(ws->getNumberEvents(), numEvents);
+
+    ws->sortAll(TOF_SORT, nullptr);
+    TS_ASSERT_EQUALS(ws->getStorageType(), COLUMN_STORAGE);
+
+    // Accessing the events as rows converts that list only
+    std::vector<TofEvent> ve = ws->getSpectrum(0).getEvents();
+    TS_ASSERT_EQUALS(ve.size(), NUMBINS);
+    for (size_t i = 0; i < ve.size() - 1; i++)
+      TS_ASSERT_LESS_THAN_EQUALS(ve[i].tof(), ve[i + 1].tof());
+    TS_ASSERT_EQUALS(ws->getSpectrum(0).getStorageType(), ROW_STORAGE);
+    TS_ASSERT_EQUALS(ws->getSpectrum(1).getStorageType(), COLUMN_STORAGE);
+    TS_ASSERT_EQUALS(ws->getStorageType(), ROW_STORAGE);
+  }
+
+  void test_setStorageType_compact_shares_pulse_times() {
+    EventWorkspace_sptr ws =
+        WorkspaceCreationHelper::createRandomEventWorkspace(NUMBINS, NUMPIXELS);
+    const auto numEvents = ws->getNumberEvents();
+    std::vector<DateAndTime> pulseTimes = ws->getSpectrum(3).getPulseTimes();
+
+    ws->setStorageType(COMPACT_STORAGE);
+    TS_ASSERT_EQUALS(ws->getStorageType(), COMPACT_STORAGE);
+    TS_ASSERT_EQUALS(ws->getNumberEvents(), numEvents);
+    TS_ASSERT_EQUALS(ws->getSpectrum(3).getPulseTimes(), pulseTimes);
+
+    // Every list refers to the same pulse time table
+    ws->getSpectrum(0).filterByPulseTime(DateAndTime(0), DateAndTime::maximum(),
+                                         ws->getSpectrum(1));
+    TS_ASSERT_EQUALS(ws->getSpectrum(1).getStorageType(), COMPACT_STORAGE);
+    TS_ASSERT_EQUALS(ws->getSpectrum(1).getNumberEvents(), NUMBINS);
+
+    ws->setStorageType(ROW_STORAGE);
+    TS_ASSERT_EQUALS(ws->getStorageType(), ROW_STORAGE);
+    TS_ASSERT_EQUALS(ws->getNumberEvents(), numEvents);
+  }
+
+  void test_setStorageType_compact_throws_for_weighted_events() {
+    EventWorkspace_sptr ws =
+        WorkspaceCreationHelper::createRandomEventWorkspace(NUMBINS, NUMPIXELS);
+    ws->getSpectrum(2).switchTo(WEIGHTED);
+    TS_ASSERT_THROWS(ws->setStorageType(COMPACT_STORAGE),
+                     const std::runtime_error &);
+    TS_ASSERT_EQUALS(ws->getStorageType(), ROW_STORAGE);
+  }
+
   /** Test sortAll() when there are more cores available than pixels.
    * This test will only work on machines with 2 cores at least.
    */
@@ -202,6 +202,49 @@ public:
     delete ew;
   }
 
+  //-------------------------------------------------------------------------------------
+  /** Append events to the existing boxes, splitting only the box given too
+   * many events */
+  void test_appendEvents() {
+    MDEventWorkspace2Lean::sptr ew =
+        MDEventsTestHelper::makeMDEW<2>(10, 0.0, 10.0, 1);
+    TS_ASSERT_EQUALS(ew->getNPoints(), 100);
+    auto box = ew->getBox();
+
+    std::vector<MDLeanEvent<2>> events;
+    for (size_t i = 0; i < 150; i++) {
+      // All in the first box, in no particular order
+      const coord_t centers[2] = {static_cast<coord_t>((i * 37) % 100) * 0.01f,
+                                  static_cast<coord_t>((i * 11) % 100) * 0.01f};
+      events.emplace_back(2.0, 4.0, centers);
+    }
+    // One in the fourth box
+    const coord_t inside[2] = {3.5f, 0.5f};
+    events.emplace_back(2.0, 4.0, inside);
+    // And one outside of the workspace
+    const coord_t outside[2] = {20.f, 0.5f};
+    events.emplace_back(2.0, 4.0, outside);
+
+    TS_ASSERT_EQUALS(ew->appendEvents(events), 1);
+    TS_ASSERT_EQUALS(ew->getNPoints(), 100 + 151);
+    TS_ASSERT_DELTA(box->getSignal(), 100 + 2.0 * 151, 1e-6);
+    TS_ASSERT_DELTA(box->getErrorSquared(), 100 + 4.0 * 151, 1e-6);
+    // Only the first box was split
+    TS_ASSERT(!box->getChild(0)->isBox());
+    TS_ASSERT_EQUALS(box->getChild(0)->getNPoints(), 151);
+    TS_ASSERT_DELTA(box->getChild(0)->getSignal(), 1 + 2.0 * 150, 1e-6);
+    TS_ASSERT(box->getChild(3)->isBox());
+    TS_ASSERT_EQUALS(box->getChild(3)->getNPoints(), 2);
+    TS_ASSERT_DELTA(box->getChild(3)->getSignal(), 3.0, 1e-6);
+    TS_ASSERT(ew->fileNeedsUpdating());
+
+    // The statistics match those of a full refresh
+    ew->refreshCache();
+    TS_ASSERT_EQUALS(ew->getNPoints(), 100 + 151);
+    TS_ASSERT_DELTA(box->getSignal(), 100 + 2.0 * 151, 1e-6);
+    TS_ASSERT_EQUALS(box->getChild(0)->getNPoints(), 151);
+  }
+
   //-------------------------------------------------------------------------------------
   /** MDBox->addEvent() tracks when a box is too big.
    * MDEventWorkspace->splitTrackedBoxes() splits them
@@ -0,0 +1,180 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidDataObjects/MDHistoOperationChain.h"
+#include "MantidDataObjects/MDHistoWorkspace.h"
+#include "MantidTestHelpers/MDEventsTestHelper.h"
+
+#include <cxxtest/TestSuite.h>
+
+using namespace Mantid::DataObjects;
+using namespace Mantid;
+
+namespace {
+/// A workspace of nBins^2 bins whose signal and error vary from bin to bin
+MDHistoWorkspace_sptr makeWorkspace(const size_t nBins, const double offset) {
+  auto ws = MDEventsTestHelper::makeFakeMDHistoWorkspace(1.0, 2, nBins);
+  for (size_t i = 0; i < ws->getNPoints(); ++i) {
+    ws->setSignalAt(i, offset + static_cast<double>(i % 17));
+    ws->setErrorSquaredAt(i, 0.5 + static_cast<double>(i % 5));
+  }
+  return ws;
+}
+
+void assertSameBins(const MDHistoWorkspace &a, const MDHistoWorkspace &b) {
+  TS_ASSERT_EQUALS(a.getNPoints(), b.getNPoints());
+  for (size_t i = 0; i < a.getNPoints(); ++i) {
+    TS_ASSERT_DELTA(a.getSignalAt(i), b.getSignalAt(i), 1e-12);
+    TS_ASSERT_DELTA(a.getErrorAt(i), b.getErrorAt(i), 1e-12);
+    TS_ASSERT_DELTA(a.getNumEventsAt(i), b.getNumEventsAt(i), 1e-12);
+  }
+  TS_ASSERT_EQUALS(a.getNEvents(), b.getNEvents());
+}
+} // namespace
+
+class MDHistoOperationChainTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static MDHistoOperationChainTest *createSuite() {
+    return new MDHistoOperationChainTest();
+  }
+  static void destroySuite(MDHistoOperationChainTest *suite) { delete suite; }
+
+  void test_empty_chain_leaves_workspace_unchanged() {
+    auto a = makeWorkspace(10, 1.0);
+    auto expected = makeWorkspace(10, 1.0);
+    MDHistoOperationChain chain;
+    TS_ASSERT_EQUALS(chain.size(), 0);
+    chain.applyTo(*a);
+    assertSameBins(*a, *expected);
+  }
+
+  void test_arithmetic_chain_matches_operations_one_by_one() {
+    // 100 x 100 bins span several blocks, the last one partly filled
+    auto b = makeWorkspace(100, 2.0);
+    auto c = makeWorkspace(100, 3.0);
+    auto expected = makeWorkspace(100, 1.0);
+    expected->subtract(*b);
+    expected->multiply(*c);
+    expected->add(0.5, 0.1);
+    expected->divide(*c);
+    expected->divide(2.0, 0.2);
+    expected->add(*b);
+    expected->exp();
+    expected->log(-1.0);
+    expected->power(2.0);
+    expected->log10(-1.0);
+
+    auto a = makeWorkspace(100, 1.0);
+    MDHistoOperationChain chain;
+    chain.subtract(*b)
+        .multiply(*c)
+        .add(0.5, 0.1)
+        .divide(*c)
+        .divide(2.0, 0.2)
+        .add(*b)
+        .exp()
+        .log(-1.0)
+        .power(2.0)
+        .log10(-1.0);
+    TS_ASSERT_EQUALS(chain.size(), 10);
+    chain.applyTo(*a);
+    assertSameBins(*a, *expected);
+  }
+
+  void test_boolean_chain_matches_operations_one_by_one() {
+    auto b = makeWorkspace(70, 4.0);
+    b->setMDMaskAt(3, true);
+    auto expected = makeWorkspace(70, 0.0);
+    expected->greaterThan(5.0);
+    *expected |= *b;
+    expected->operatorNot();
+
+    auto a = makeWorkspace(70, 0.0);
+    MDHistoOperationChain chain;
+    chain.greaterThan(5.0).operatorOr(*b).operatorNot();
+    chain.applyTo(*a);
+    assertSameBins(*a, *expected);
+    TS_ASSERT_EQUALS(a->getSignalAt(0), 0.0);
+    TS_ASSERT_EQUALS(a->getSignalAt(3), 1.0);
+    TS_ASSERT_EQUALS(a->getSignalAt(6), 0.0);
+  }
+
+  void test_comparisons() {
+    auto b = makeWorkspace(10, 3.0);
+    auto a = makeWorkspace(10, 0.0);
+    MDHistoOperationChain().equalTo(*b, 3.5).applyTo(*a);
+    for (size_t i = 0; i < a->getNPoints(); ++i) {
+      TS_ASSERT_EQUALS(a->getSignalAt(i), 1.0);
+      TS_ASSERT_EQUALS(a->getErrorAt(i), 0.0);
+    }
+    a = makeWorkspace(10, 0.0);
+    MDHistoOperationChain().lessThan(*b).equalTo(1.0, 1e-5).applyTo(*a);
+    TS_ASSERT_EQUALS(a->getSignalAt(0), 1.0);
+    a = makeWorkspace(10, 0.0);
+    MDHistoOperationChain().lessThan(2.0).applyTo(*a);
+    TS_ASSERT_EQUALS(a->getSignalAt(1), 1.0);
+    TS_ASSERT_EQUALS(a->getSignalAt(2), 0.0);
+  }
+
+  void test_workspace_used_on_both_sides() {
+    auto expected = makeWorkspace(50, 1.0);
+    expected->add(*expected);
+    expected->multiply(*expected);
+
+    auto a = makeWorkspace(50, 1.0);
+    MDHistoOperationChain().add(*a).multiply(*a).applyTo(*a);
+    assertSameBins(*a, *expected);
+  }
+
+  void test_mismatched_operand_throws_before_changing_workspace() {
+    auto a = makeWorkspace(10, 1.0);
+    auto b = makeWorkspace(10, 2.0);
+    auto wrong = makeWorkspace(11, 2.0);
+    MDHistoOperationChain chain;
+    chain.add(*b).multiply(*wrong);
+    TS_ASSERT_THROWS(chain.applyTo(*a), const std::invalid_argument &);
+    assertSameBins(*a, *makeWorkspace(10, 1.0));
+  }
+};
+
+class MDHistoOperationChainTestPerformance : public CxxTest::TestSuite {
+public:
+  static MDHistoOperationChainTestPerformance *createSuite() {
+    return new MDHistoOperationChainTestPerformance();
+  }
+  static void destroySuite(MDHistoOperationChainTestPerformance *suite) {
+    delete suite;
+  }
+
+  MDHistoOperationChainTestPerformance()
+      : m_a(makeWorkspace(2000, 1.0)), m_b(makeWorkspace(2000, 2.0)),
+        m_c(makeWorkspace(2000, 3.0)) {}
+
+  void test_chain_of_operations() {
+    MDHistoOperationChain()
+        .subtract(*m_b)
+        .divide(*m_c)
+        .multiply(2.0, 0.0)
+        .power(2.0)
+        .applyTo(*m_a);
+  }
+
+  void test_operations_one_by_one() {
+    m_a->subtract(*m_b);
+    m_a->divide(*m_c);
+    m_a->multiply(2.0, 0.0);
+    m_a->power(2.0);
+  }
+
+private:
+  MDHistoWorkspace_sptr m_a;
+  MDHistoWorkspace_sptr m_b;
+  MDHistoWorkspace_sptr m_c;
+};
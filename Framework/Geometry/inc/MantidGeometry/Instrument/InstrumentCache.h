@@ -0,0 +1,62 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidGeometry/DllConfig.h"
+
+#include <memory>
+#include <string>
+
+namespace Mantid {
+namespace Geometry {
+class Instrument;
+
+/** InstrumentCache : keeps the instruments built by the
+  InstrumentDefinitionParser in a local directory, so that an instrument
+  definition is only parsed once and later loads rebuild the instrument from
+  a binary copy.
+
+  Entries are named by the mangled name of the instrument, which holds the
+  checksum of its XML definition, so a changed definition simply misses. An
+  entry is a native binary file holding the version of Mantid that wrote it,
+  the shapes of the instrument, every component in depth first order with its
+  type, name, relative position and rotation, shape and detector ID, the
+  detectors and monitors, the source and sample, and the parameters read from
+  the definition. It is mapped into memory to be read. Grid and rectangular
+  detectors are stored by their dimensions, their pixels being created again
+  from them.
+
+  Instruments with neutronic positions, structured detectors or shapes not
+  defined in XML are not cached. Entries are written under a temporary name
+  and renamed, so a reader never sees a partial entry.
+
+  The directory is set with the instrument.cache.directory key; the cache is
+  disabled if no directory is set.
+*/
+class MANTID_GEOMETRY_DLL InstrumentCache {
+public:
+  explicit InstrumentCache(std::string directory);
+  static InstrumentCache fromConfig();
+
+  /// True if a cache directory was given
+  bool enabled() const { return !m_directory.empty(); }
+
+  std::shared_ptr<Instrument> load(const std::string &key,
+                                   const std::string &name,
+                                   const std::string &filename,
+                                   const std::string &xmlText) const;
+  bool save(const std::string &key, const Instrument &instrument) const;
+
+  std::string entryPath(const std::string &key) const;
+
+private:
+  /// Directory holding the entries
+  std::string m_directory;
+};
+
+} // namespace Geometry
+} // namespace Mantid
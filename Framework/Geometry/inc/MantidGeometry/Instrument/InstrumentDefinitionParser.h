@@ -30,6 +30,7 @@ namespace Geometry {
 class ICompAssembly;
 class IComponent;
 class Instrument;
+class InstrumentCache;
 class ObjComponent;
 class IObject;
 class ShapeFactory;
@@ -64,6 +65,10 @@ public:
 
   /// Parse XML contents
   std::shared_ptr<Instrument> parseXML(Kernel::ProgressBase *progressReporter);
+  /// Rebuild the instrument from a cache if it holds it, else parse the XML
+  std::shared_ptr<Instrument>
+  parseXMLUsingCache(const InstrumentCache &cache,
+                     Kernel::ProgressBase *progressReporter);
 
   /// Add/overwrite any parameters specified in instrument with param values
   /// specified in <component-link> XML elements
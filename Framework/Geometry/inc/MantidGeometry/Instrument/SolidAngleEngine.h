@@ -0,0 +1,73 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidGeometry/DllConfig.h"
+#include "MantidKernel/V3D.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Mantid {
+namespace Geometry {
+class ComponentInfo;
+class IObject;
+
+/** SolidAngleEngine : computes the solid angles of many components of an
+  instrument seen from a single observer, such as every detector seen from the
+  sample.
+
+  The surface of each shape is reduced once to a flat list of triangles in the
+  frame of the shape: the twelve triangles of a cuboid and the sides of a
+  cylinder as in CSGObject, or the triangulation of any other shape. The solid
+  angle of a component is then a single pass over the triangles of its shape,
+  laid out so that the compiler can vectorise it, instead of building the
+  surface again for every component.
+
+  Components are grouped by shape and by the position of the observer in the
+  frame of the shape, found to a tenth of a nanometre. The solid angle of each
+  group is computed once, so pixels that see the observer from the same place,
+  as in a ring of identical tubes facing the sample, share a result. Groups
+  are evaluated in parallel.
+
+  Components that are scaled, seen from inside their bounding box, or whose
+  shape has no such triangle list (spheres, cones, flat meshes, or shapes
+  solved by ray tracing) are passed to ComponentInfo::solidAngle.
+*/
+class MANTID_GEOMETRY_DLL SolidAngleEngine {
+public:
+  explicit SolidAngleEngine(const ComponentInfo &componentInfo);
+
+  std::vector<double> solidAngles(const std::vector<size_t> &componentIndices,
+                                  const Kernel::V3D &observer);
+
+  /// The triangles of the surface of a shape, in the frame of the shape
+  struct Surface {
+    /// True to sum only the triangles facing the observer, false to take
+    /// half the sum of the magnitudes of all the triangles
+    bool facingOnly = false;
+    std::vector<double> ax, ay, az;
+    std::vector<double> bx, by, bz;
+    std::vector<double> cx, cy, cz;
+
+    void addTriangle(const Kernel::V3D &a, const Kernel::V3D &b,
+                     const Kernel::V3D &c);
+    size_t size() const { return ax.size(); }
+    double solidAngle(const Kernel::V3D &observer) const;
+  };
+
+private:
+  const Surface *surface(const IObject &shape);
+
+  const ComponentInfo &m_componentInfo;
+  /// Surfaces built so far, null for shapes that are passed on
+  std::unordered_map<const IObject *, std::unique_ptr<Surface>> m_surfaces;
+};
+
+} // namespace Geometry
+} // namespace Mantid
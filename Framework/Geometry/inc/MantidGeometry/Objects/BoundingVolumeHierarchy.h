@@ -0,0 +1,146 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidGeometry/DllConfig.h"
+#include "MantidKernel/V3D.h"
+
+#include <boost/container/small_vector.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Mantid {
+namespace Geometry {
+
+/** BoundingVolumeHierarchy : a tree of axis-aligned boxes over the triangles
+  of a mesh, used to find the few triangles a ray may cross without testing
+  every one of them.
+
+  The tree is built with the surface area heuristic: the triangles of a node
+  are split in two along the axis and position, chosen among a few bins of
+  their centres, that minimise the expected cost of tracing a ray through the
+  children. Nodes are stored depth first in a single array, the first child of
+  a node following it.
+
+  A ray covers the points start + t * direction with minDistance() <= t <=
+  maxT, maxT being infinite unless the visitor lowers it, as a search for the
+  closest crossing does. minDistance() is slightly negative and the boxes are
+  slightly enlarged so that no triangle accepted by
+  MeshObjectCommon::rayIntersectsTriangle is left out.
+*/
+class MANTID_GEOMETRY_DLL BoundingVolumeHierarchy {
+public:
+  /// Nodes with this many triangles or fewer are leaves
+  static constexpr size_t MAX_LEAF_SIZE = 4;
+
+  BoundingVolumeHierarchy(const std::vector<uint32_t> &triangles,
+                          const std::vector<Kernel::V3D> &vertices);
+
+  /// @return the number of nodes of the tree
+  size_t numberOfNodes() const { return m_nodes.size(); }
+  /// @return the lowest distance along a ray that is considered
+  double minDistance() const { return m_minDistance; }
+
+  /**
+   * Call a visitor for every triangle whose box is crossed by a ray
+   * @param start :: the start of the ray
+   * @param direction :: the direction of the ray
+   * @param visit :: called as visit(triangle, maxT) with the index of a
+   * triangle; it may lower maxT to stop looking further along the ray
+   */
+  template <typename Visitor>
+  void forEachCandidate(const Kernel::V3D &start, const Kernel::V3D &direction,
+                        Visitor &&visit) const {
+    if (m_nodes.empty())
+      return;
+    const Ray ray(start, direction);
+    double maxT = std::numeric_limits<double>::infinity();
+    boost::container::small_vector<uint32_t, 64> stack{0};
+    while (!stack.empty()) {
+      const Node &node = m_nodes[stack.back()];
+      const auto index = stack.back();
+      stack.pop_back();
+      if (!crosses(node, ray, maxT))
+        continue;
+      if (node.count > 0) {
+        for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+          visit(m_order[i], maxT);
+      } else {
+        stack.emplace_back(node.offset);
+        stack.emplace_back(index + 1);
+      }
+    }
+  }
+
+private:
+  /// A node of the tree
+  struct Node {
+    std::array<double, 3> lower;
+    std::array<double, 3> upper;
+    /// first triangle in m_order of a leaf, or second child of a node
+    uint32_t offset;
+    /// number of triangles of a leaf, 0 for a node
+    uint32_t count;
+  };
+  /// A ray, prepared for testing against boxes
+  struct Ray {
+    Ray(const Kernel::V3D &start, const Kernel::V3D &direction)
+        : start{{start.X(), start.Y(), start.Z()}},
+          inverse{{1. / direction.X(), 1. / direction.Y(),
+                   1. / direction.Z()}} {}
+    std::array<double, 3> start;
+    std::array<double, 3> inverse;
+  };
+  /// The bounds of a triangle while building the tree
+  struct Bounds {
+    std::array<double, 3> lower;
+    std::array<double, 3> upper;
+    std::array<double, 3> centre;
+  };
+
+  uint32_t build(std::vector<Bounds> &bounds, const uint32_t begin,
+                 const uint32_t end);
+
+  /// @return true if a ray crosses the box of a node before maxT
+  bool crosses(const Node &node, const Ray &ray, const double maxT) const {
+    double tNear = m_minDistance;
+    double tFar = maxT;
+    for (size_t axis = 0; axis < 3; ++axis) {
+      if (std::isinf(ray.inverse[axis])) {
+        // Parallel to the slab
+        if (ray.start[axis] < node.lower[axis] ||
+            ray.start[axis] > node.upper[axis])
+          return false;
+        continue;
+      }
+      double t1 = (node.lower[axis] - ray.start[axis]) * ray.inverse[axis];
+      double t2 = (node.upper[axis] - ray.start[axis]) * ray.inverse[axis];
+      if (t1 > t2)
+        std::swap(t1, t2);
+      tNear = std::max(tNear, t1);
+      tFar = std::min(tFar, t2);
+      if (tNear > tFar)
+        return false;
+    }
+    return true;
+  }
+
+  std::vector<Node> m_nodes;
+  /// Triangle indices, in the order of the leaves
+  std::vector<uint32_t> m_order;
+  /// Lowest distance along a ray that is considered, to match the tolerance
+  /// of the triangle test
+  double m_minDistance;
+};
+
+} // namespace Geometry
+} // namespace Mantid
@@ -236,6 +236,7 @@ private:
   std::shared_ptr<GeometryHandler> m_handler;
   friend class GeometryHandler;
   friend class GeometryRenderer;
+  friend class SolidAngleEngine;
   /// Is geometry caching enabled?
   bool bGeometryCaching;
   /// a pointer to a class for reading from the geometry cache
@@ -11,6 +11,7 @@
 //----------------------------------------------------------------------
 #include "BoundingBox.h"
 #include "MantidGeometry/DllConfig.h"
+#include "MantidGeometry/Objects/BoundingVolumeHierarchy.h"
 #include "MantidGeometry/Objects/IObject.h"
 #include "MantidGeometry/Objects/Track.h"
 #include "MantidGeometry/Rendering/ShapeInfo.h"
@@ -18,6 +19,7 @@
 #include "MantidKernel/Matrix.h"
 #include <map>
 #include <memory>
+#include <mutex>
 
 namespace Mantid {
 //----------------------------------------------------------------------
@@ -157,6 +159,9 @@ private:
       std::vector<Kernel::V3D> &intersectionPoints,
       std::vector<Mantid::Geometry::TrackDirection> &entryExitFlags) const;
 
+  const BoundingVolumeHierarchy &boundingVolumeHierarchy() const;
+  void resetBoundingVolumeHierarchy();
+
   /// Get triangle
   bool getTriangle(const size_t index, Kernel::V3D &v1, Kernel::V3D &v2,
                    Kernel::V3D &v3) const;
@@ -187,6 +192,10 @@ private:
   /// Triangles are specified by indices into a list of vertices.
   std::vector<uint32_t> m_triangles;
   std::vector<Kernel::V3D> m_vertices;
+  /// Tree of boxes over the triangles, built when first traced through
+  mutable std::unique_ptr<const BoundingVolumeHierarchy> m_bvh;
+  /// Set once m_bvh is built
+  mutable std::unique_ptr<std::once_flag> m_bvhBuilt;
   /// material composition
   Kernel::Material m_material;
 };
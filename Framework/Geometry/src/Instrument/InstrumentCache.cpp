@@ -0,0 +1,831 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidGeometry/Instrument/InstrumentCache.h"
+#include "MantidGeometry/Instrument.h"
+#include "MantidGeometry/Instrument/CompAssembly.h"
+#include "MantidGeometry/Instrument/Component.h"
+#include "MantidGeometry/Instrument/Detector.h"
+#include "MantidGeometry/Instrument/GridDetector.h"
+#include "MantidGeometry/Instrument/ObjCompAssembly.h"
+#include "MantidGeometry/Instrument/ObjComponent.h"
+#include "MantidGeometry/Instrument/RectangularDetector.h"
+#include "MantidGeometry/Instrument/ReferenceFrame.h"
+#include "MantidGeometry/Instrument/XMLInstrumentParameter.h"
+#include "MantidGeometry/Objects/CSGObject.h"
+#include "MantidGeometry/Objects/ShapeFactory.h"
+#include "MantidKernel/ConfigService.h"
+#include "MantidKernel/Interpolation.h"
+#include "MantidKernel/Logger.h"
+#include "MantidKernel/MantidVersion.h"
+#include "MantidKernel/Material.h"
+#include "MantidKernel/Timer.h"
+#include "MantidKernel/Unit.h"
+
+#include <Poco/File.h>
+#include <Poco/Path.h>
+#include <Poco/TemporaryFile.h>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+
+using Mantid::Kernel::Quat;
+using Mantid::Kernel::V3D;
+
+namespace Mantid {
+namespace Geometry {
+
+namespace {
+/// static logger
+Kernel::Logger g_log("InstrumentCache");
+
+/// Extension of the entries
+const std::string EXTENSION = ".instrumentcache";
+/// Marks the start of an entry
+constexpr char MAGIC[8] = {'M', 'T', 'D', 'I', 'N', 'S', 'T', 'C'};
+/// Changed whenever the layout of an entry changes
+constexpr uint32_t FORMAT_VERSION = 1;
+/// Reads differently on a machine of the other byte order
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+/// Start of an entry
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint64_t fileSize;
+};
+
+/// The type of a component in an entry
+enum class Kind : uint8_t {
+  Component,
+  ObjComponent,
+  Detector,
+  CompAssembly,
+  ObjCompAssembly,
+  GridDetector,
+  RectangularDetector,
+  /// Created by the grid or rectangular detector holding it
+  Generated
+};
+
+/// How a component appears in the detector cache of the instrument
+enum class Mark : uint8_t { None, Detector, Monitor };
+
+/// The Mantid build writing or reading entries; parsing may change with it
+std::string mantidBuild() {
+  return std::string(Kernel::MantidVersion::version()) + " " +
+         Kernel::MantidVersion::revisionFull();
+}
+
+/// Writes the values of an entry one after the other
+class Writer {
+public:
+  explicit Writer(std::ostream &out) : m_out(out) {}
+
+  template <typename T> void writeValue(const T &value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only plain values can be written directly");
+    m_out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+  void writeString(const std::string &value) {
+    writeValue(static_cast<uint64_t>(value.size()));
+    m_out.write(value.data(), static_cast<std::streamsize>(value.size()));
+  }
+  void writeV3D(const V3D &value) {
+    writeValue(value.X());
+    writeValue(value.Y());
+    writeValue(value.Z());
+  }
+  void writeQuat(const Quat &value) {
+    writeValue(value.real());
+    writeValue(value.imagI());
+    writeValue(value.imagJ());
+    writeValue(value.imagK());
+  }
+
+private:
+  std::ostream &m_out;
+};
+
+/// Reads the values of an entry mapped into memory, checking its bounds
+class Reader {
+public:
+  Reader(const char *data, const size_t size)
+      : m_data(data), m_size(size), m_offset(0) {}
+
+  template <typename T> T readValue() {
+    T value;
+    std::memcpy(&value, take(sizeof(T)), sizeof(T));
+    return value;
+  }
+  std::string readString() {
+    const auto size = readValue<uint64_t>();
+    const char *data = take(size);
+    return std::string(data, static_cast<size_t>(size));
+  }
+  V3D readV3D() {
+    const auto x = readValue<double>();
+    const auto y = readValue<double>();
+    const auto z = readValue<double>();
+    return V3D(x, y, z);
+  }
+  Quat readQuat() {
+    const auto w = readValue<double>();
+    const auto a = readValue<double>();
+    const auto b = readValue<double>();
+    const auto c = readValue<double>();
+    return Quat(w, a, b, c);
+  }
+  /// Read an index into a table of some size, -1 meaning none
+  int64_t readIndex(const size_t tableSize) {
+    const auto index = readValue<int64_t>();
+    if (index < -1 || index >= static_cast<int64_t>(tableSize))
+      throw std::runtime_error("corrupt index");
+    return index;
+  }
+  bool atEnd() const { return m_offset == m_size; }
+
+private:
+  const char *take(const uint64_t size) {
+    if (size > m_size - m_offset)
+      throw std::runtime_error("truncated entry");
+    const char *data = m_data + m_offset;
+    m_offset += static_cast<size_t>(size);
+    return data;
+  }
+
+  const char *m_data;
+  size_t m_size;
+  size_t m_offset;
+};
+
+/// The exact type of a component; anything else cannot be cached
+Kind kindOf(const IComponent &component) {
+  const auto &type = typeid(component);
+  if (type == typeid(Component))
+    return Kind::Component;
+  if (type == typeid(ObjComponent))
+    return Kind::ObjComponent;
+  if (type == typeid(Detector))
+    return Kind::Detector;
+  if (type == typeid(CompAssembly))
+    return Kind::CompAssembly;
+  if (type == typeid(ObjCompAssembly))
+    return Kind::ObjCompAssembly;
+  if (type == typeid(GridDetector))
+    return Kind::GridDetector;
+  if (type == typeid(RectangularDetector))
+    return Kind::RectangularDetector;
+  throw std::invalid_argument("components of type " + component.type() +
+                              " are not cached");
+}
+
+/// Writes an instrument: its components are numbered in depth first order,
+/// the instrument itself being 0, and its shapes in order of first use
+class InstrumentWriter {
+public:
+  InstrumentWriter(Writer &out, const Instrument &instrument)
+      : m_out(out), m_instrument(instrument) {}
+
+  void write() {
+    if (m_instrument.isParametrized())
+      throw std::invalid_argument("parametrized instruments are not cached");
+    if (m_instrument.getPhysicalInstrument())
+      throw std::invalid_argument(
+          "instruments with neutronic positions are not cached");
+
+    collect(m_instrument, -1, false);
+    markDetectors();
+
+    writeInstrumentValues();
+    m_out.writeValue(static_cast<uint64_t>(m_shapes.size()));
+    for (const auto &shape : m_shapes) {
+      m_out.writeString(shape->getShapeXML());
+      m_out.writeValue(static_cast<int32_t>(shape->getName()));
+      m_out.writeString(shape->id());
+    }
+    m_out.writeValue(static_cast<uint64_t>(m_components.size() - 1));
+    for (size_t i = 1; i < m_components.size(); ++i)
+      writeComponent(m_components[i]);
+    m_out.writeValue(componentIndex(m_instrument.getSource().get()));
+    m_out.writeValue(componentIndex(m_instrument.getSample().get()));
+    writeParameters();
+  }
+
+private:
+  struct Entry {
+    const IComponent *component;
+    int64_t parent;
+    Kind kind;
+  };
+
+  void collect(const IComponent &component, const int64_t parent,
+               const bool generated) {
+    const auto index = static_cast<int64_t>(m_components.size());
+    m_componentIndex.emplace(&component, index);
+    const Kind kind = (parent < 0 || generated) ? Kind::Generated
+                                                : kindOf(component);
+    m_components.push_back({&component, parent, kind});
+
+    switch (kind) {
+    case Kind::ObjComponent:
+    case Kind::Detector:
+    case Kind::ObjCompAssembly:
+      addShape(dynamic_cast<const IObjComponent &>(component).shape());
+      break;
+    case Kind::GridDetector:
+    case Kind::RectangularDetector:
+      addShape(pixelShape(component));
+      break;
+    default:
+      break;
+    }
+
+    const auto *assembly = dynamic_cast<const ICompAssembly *>(&component);
+    if (assembly) {
+      const bool generatedChildren = generated ||
+                                     kind == Kind::GridDetector ||
+                                     kind == Kind::RectangularDetector;
+      for (int i = 0; i < assembly->nelements(); ++i)
+        collect(*assembly->getChild(i), index, generatedChildren);
+    }
+  }
+
+  /// The shape of the pixels of a grid detector, that of its first pixel
+  static std::shared_ptr<const IObject>
+  pixelShape(const IComponent &component) {
+    const auto &grid = dynamic_cast<const GridDetector &>(component);
+    if (grid.xpixels() <= 0 || grid.ypixels() <= 0)
+      return nullptr;
+    return grid.getAtXYZ(0, 0, 0)->shape();
+  }
+
+  void addShape(const std::shared_ptr<const IObject> &shape) {
+    if (!shape || m_shapeIndex.count(shape.get()) > 0)
+      return;
+    auto csgObject = std::dynamic_pointer_cast<const CSGObject>(shape);
+    if (!csgObject)
+      throw std::invalid_argument("only shapes defined in XML are cached");
+    if (csgObject->getShapeXML().empty() && csgObject->hasValidShape())
+      throw std::invalid_argument("shapes without XML are not cached");
+    if (!csgObject->material().name().empty())
+      throw std::invalid_argument("shapes with a material are not cached");
+    m_shapeIndex.emplace(shape.get(), static_cast<int64_t>(m_shapes.size()));
+    m_shapes.emplace_back(std::move(csgObject));
+  }
+
+  int64_t shapeIndex(const std::shared_ptr<const IObject> &shape) const {
+    return shape ? m_shapeIndex.at(shape.get()) : -1;
+  }
+
+  int64_t componentIndex(const IComponent *component) const {
+    if (!component)
+      return -1;
+    const auto found = m_componentIndex.find(component->getBaseComponent());
+    if (found == m_componentIndex.end())
+      throw std::invalid_argument(
+          "a component outside the instrument tree is referenced");
+    return found->second;
+  }
+
+  void markDetectors() {
+    detid2det_map detectors;
+    m_instrument.getDetectors(detectors);
+    const auto monitors = m_instrument.getMonitors();
+    for (const auto &detector : detectors)
+      m_marks.emplace(static_cast<const IComponent *>(detector.second.get()),
+                      Mark::Detector);
+    for (const auto monitor : monitors)
+      m_marks[detectors.at(monitor).get()] = Mark::Monitor;
+    for (const auto &mark : m_marks)
+      if (m_componentIndex.count(mark.first) == 0)
+        throw std::invalid_argument(
+            "a detector outside the instrument tree is referenced");
+  }
+
+  void writeInstrumentValues() {
+    m_out.writeV3D(m_instrument.getRelativePos());
+    m_out.writeQuat(m_instrument.getRelativeRot());
+    m_out.writeString(m_instrument.getDefaultView());
+    m_out.writeString(m_instrument.getDefaultAxis());
+    m_out.writeValue(m_instrument.getValidFromDate().totalNanoseconds());
+    m_out.writeValue(m_instrument.getValidToDate().totalNanoseconds());
+
+    const auto frame = m_instrument.getReferenceFrame();
+    const V3D thetaSign = frame->vecThetaSign();
+    uint8_t thetaSignAxis = 0;
+    for (uint8_t axis = 1; axis < 3; ++axis)
+      if (std::abs(thetaSign[axis]) > std::abs(thetaSign[thetaSignAxis]))
+        thetaSignAxis = axis;
+    m_out.writeValue(static_cast<uint8_t>(frame->pointingUp()));
+    m_out.writeValue(static_cast<uint8_t>(frame->pointingAlongBeam()));
+    m_out.writeValue(thetaSignAxis);
+    m_out.writeValue(static_cast<uint8_t>(frame->getHandedness()));
+    m_out.writeString(frame->origin());
+  }
+
+  void writeComponent(const Entry &entry) {
+    const IComponent &component = *entry.component;
+    m_out.writeValue(entry.kind);
+    m_out.writeValue(entry.parent);
+    m_out.writeString(component.getName());
+    m_out.writeV3D(component.getRelativePos());
+    m_out.writeQuat(component.getRelativeRot());
+    const auto mark = m_marks.find(&component);
+    m_out.writeValue(mark == m_marks.end() ? Mark::None : mark->second);
+
+    switch (entry.kind) {
+    case Kind::ObjComponent:
+    case Kind::ObjCompAssembly:
+      m_out.writeValue(shapeIndex(
+          dynamic_cast<const IObjComponent &>(component).shape()));
+      break;
+    case Kind::Detector:
+      m_out.writeValue(static_cast<int32_t>(
+          dynamic_cast<const Detector &>(component).getID()));
+      m_out.writeValue(shapeIndex(
+          dynamic_cast<const IObjComponent &>(component).shape()));
+      break;
+    case Kind::GridDetector:
+    case Kind::RectangularDetector: {
+      const auto &grid = dynamic_cast<const GridDetector &>(component);
+      m_out.writeValue(shapeIndex(pixelShape(component)));
+      m_out.writeValue(static_cast<int32_t>(grid.xpixels()));
+      m_out.writeValue(grid.xstart());
+      m_out.writeValue(grid.xstep());
+      m_out.writeValue(static_cast<int32_t>(grid.ypixels()));
+      m_out.writeValue(grid.ystart());
+      m_out.writeValue(grid.ystep());
+      m_out.writeValue(static_cast<int32_t>(grid.zpixels()));
+      m_out.writeValue(grid.zstart());
+      m_out.writeValue(grid.zstep());
+      m_out.writeValue(static_cast<int32_t>(grid.idstart()));
+      m_out.writeString(grid.idFillOrder());
+      m_out.writeValue(static_cast<int32_t>(grid.idstepbyrow()));
+      m_out.writeValue(static_cast<int32_t>(grid.idstep()));
+      break;
+    }
+    default:
+      break;
+    }
+  }
+
+  void writeParameters() {
+    const auto &units =
+        const_cast<Instrument &>(m_instrument).getLogfileUnit();
+    m_out.writeValue(static_cast<uint64_t>(units.size()));
+    for (const auto &unit : units) {
+      m_out.writeString(unit.first);
+      m_out.writeString(unit.second);
+    }
+
+    const auto &parameters = m_instrument.getLogfileCache();
+    m_out.writeValue(static_cast<uint64_t>(parameters.size()));
+    for (const auto &item : parameters) {
+      const auto &parameter = *item.second;
+      m_out.writeString(item.first.first);
+      m_out.writeValue(componentIndex(item.first.second));
+      m_out.writeString(parameter.m_logfileID);
+      m_out.writeString(parameter.m_value);
+      const auto &interpolation = parameter.m_interpolation;
+      m_out.writeValue(static_cast<uint8_t>(interpolation ? 1 : 0));
+      if (interpolation) {
+        // The text form of the definition, without losing precision
+        std::ostringstream text;
+        text << std::setprecision(std::numeric_limits<double>::max_digits10)
+             << *interpolation;
+        m_out.writeString(text.str());
+      }
+      m_out.writeString(parameter.m_formula);
+      m_out.writeString(parameter.m_formulaUnit);
+      m_out.writeString(parameter.m_resultUnit);
+      m_out.writeString(parameter.m_paramName);
+      m_out.writeString(parameter.m_type);
+      m_out.writeString(parameter.m_tie);
+      m_out.writeValue(static_cast<uint64_t>(parameter.m_constraint.size()));
+      for (const auto &constraint : parameter.m_constraint)
+        m_out.writeString(constraint);
+      m_out.writeString(parameter.m_penaltyFactor);
+      m_out.writeString(parameter.m_fittingFunction);
+      m_out.writeString(parameter.m_extractSingleValueAs);
+      m_out.writeString(parameter.m_eq);
+      m_out.writeValue(componentIndex(parameter.m_component));
+      m_out.writeValue(parameter.m_angleConvertConst);
+      m_out.writeString(parameter.m_description);
+    }
+  }
+
+  Writer &m_out;
+  const Instrument &m_instrument;
+  std::vector<Entry> m_components;
+  std::unordered_map<const IComponent *, int64_t> m_componentIndex;
+  std::vector<std::shared_ptr<const CSGObject>> m_shapes;
+  std::unordered_map<const IObject *, int64_t> m_shapeIndex;
+  std::unordered_map<const IComponent *, Mark> m_marks;
+};
+
+/// Rebuilds an instrument written by InstrumentWriter
+class InstrumentReader {
+public:
+  InstrumentReader(Reader &in, std::shared_ptr<Instrument> instrument)
+      : m_in(in), m_instrument(std::move(instrument)) {}
+
+  void read() {
+    readInstrumentValues();
+
+    const auto numShapes = m_in.readValue<uint64_t>();
+    ShapeFactory shapeFactory;
+    for (uint64_t i = 0; i < numShapes; ++i) {
+      const auto xml = m_in.readString();
+      auto shape = xml.empty() ? std::make_shared<CSGObject>()
+                               : shapeFactory.createShape(xml, false);
+      shape->setName(m_in.readValue<int32_t>());
+      shape->setID(m_in.readString());
+      m_shapes.emplace_back(std::move(shape));
+    }
+
+    const auto numComponents = m_in.readValue<uint64_t>();
+    m_components.reserve(static_cast<size_t>(numComponents) + 1);
+    m_components.emplace_back(m_instrument.get());
+    m_nextChild.emplace_back(0);
+    for (uint64_t i = 0; i < numComponents; ++i)
+      readComponent();
+
+    // As the parser does: monitors are inserted in order, detectors appended
+    // and sorted once at the end
+    std::sort(m_monitors.begin(), m_monitors.end(),
+              [](const IDetector *a, const IDetector *b) {
+                return a->getID() < b->getID();
+              });
+    for (const auto *monitor : m_monitors)
+      m_instrument->markAsMonitor(monitor);
+    for (const auto *detector : m_detectors)
+      m_instrument->markAsDetectorIncomplete(detector);
+    m_instrument->markAsDetectorFinalize();
+
+    if (const auto source = component(m_in.readIndex(m_components.size())))
+      m_instrument->markAsSource(source);
+    if (const auto sample = component(m_in.readIndex(m_components.size())))
+      m_instrument->markAsSamplePos(sample);
+
+    readParameters();
+    if (!m_in.atEnd())
+      throw std::runtime_error("unexpected data at the end of the entry");
+  }
+
+private:
+  IComponent *component(const int64_t index) const {
+    return index < 0 ? nullptr : m_components[static_cast<size_t>(index)];
+  }
+
+  std::shared_ptr<IObject> shape() {
+    const auto index = m_in.readIndex(m_shapes.size());
+    return index < 0 ? nullptr : m_shapes[static_cast<size_t>(index)];
+  }
+
+  void readInstrumentValues() {
+    m_instrument->setPos(m_in.readV3D());
+    m_instrument->setRot(m_in.readQuat());
+    const auto defaultView = m_in.readString();
+    m_instrument->setDefaultView(defaultView);
+    m_instrument->setDefaultViewAxis(m_in.readString());
+    m_instrument->setValidFromDate(
+        Types::Core::DateAndTime(m_in.readValue<int64_t>()));
+    m_instrument->setValidToDate(
+        Types::Core::DateAndTime(m_in.readValue<int64_t>()));
+
+    const auto axis = [this]() {
+      const auto value = m_in.readValue<uint8_t>();
+      if (value > Z)
+        throw std::runtime_error("corrupt reference frame");
+      return static_cast<PointingAlong>(value);
+    };
+    const auto up = axis();
+    const auto alongBeam = axis();
+    const auto thetaSign = axis();
+    const auto handedness =
+        m_in.readValue<uint8_t>() == Right ? Right : Left;
+    m_instrument->setReferenceFrame(std::make_shared<ReferenceFrame>(
+        up, alongBeam, thetaSign, handedness, m_in.readString()));
+  }
+
+  void readComponent() {
+    const auto kind = m_in.readValue<Kind>();
+    const auto parentIndex = m_in.readIndex(m_components.size());
+    auto *parent = component(parentIndex);
+    auto *assembly = dynamic_cast<ICompAssembly *>(parent);
+    if (!assembly)
+      throw std::runtime_error("corrupt component tree");
+    const auto name = m_in.readString();
+    const auto position = m_in.readV3D();
+    const auto rotation = m_in.readQuat();
+    const auto mark = m_in.readValue<Mark>();
+
+    IComponent *created = nullptr;
+    switch (kind) {
+    case Kind::Generated: {
+      auto &next = m_nextChild[static_cast<size_t>(parentIndex)];
+      if (next >= assembly->nelements())
+        throw std::runtime_error("generated component not found");
+      created = assembly->getChild(next++).get();
+      if (created->getName() != name)
+        throw std::runtime_error("generated component " + name +
+                                 " does not match");
+      break;
+    }
+    case Kind::Component:
+      created = addLeaf(assembly, std::make_unique<Component>(name, parent));
+      break;
+    case Kind::ObjComponent:
+      created = addLeaf(assembly,
+                        std::make_unique<ObjComponent>(name, shape(), parent));
+      break;
+    case Kind::Detector: {
+      const auto id = m_in.readValue<int32_t>();
+      created = addLeaf(assembly,
+                        std::make_unique<Detector>(name, id, shape(), parent));
+      break;
+    }
+    case Kind::CompAssembly:
+      // Assemblies add themselves to their parent
+      created = new CompAssembly(name, parent);
+      break;
+    case Kind::ObjCompAssembly: {
+      auto *objAssembly = new ObjCompAssembly(name, parent);
+      objAssembly->setOutline(shape());
+      created = objAssembly;
+      break;
+    }
+    case Kind::GridDetector:
+    case Kind::RectangularDetector: {
+      GridDetector *grid = kind == Kind::GridDetector
+                               ? new GridDetector(name, parent)
+                               : new RectangularDetector(name, parent);
+      grid->setPos(position);
+      grid->setRot(rotation);
+      readGrid(*grid);
+      created = grid;
+      break;
+    }
+    default:
+      throw std::runtime_error("unknown component type");
+    }
+    created->setPos(position);
+    created->setRot(rotation);
+
+    if (mark != Mark::None) {
+      const auto *detector = dynamic_cast<const IDetector *>(created);
+      if (!detector)
+        throw std::runtime_error("component " + name + " is not a detector");
+      if (mark == Mark::Monitor)
+        m_monitors.emplace_back(detector);
+      else
+        m_detectors.emplace_back(detector);
+    }
+    m_components.emplace_back(created);
+    m_nextChild.emplace_back(0);
+  }
+
+  /// Add a new leaf to its parent, which then owns it
+  static IComponent *addLeaf(ICompAssembly *parent,
+                             std::unique_ptr<IComponent> leaf) {
+    parent->add(leaf.get());
+    return leaf.release();
+  }
+
+  void readGrid(GridDetector &grid) {
+    const auto pixelShape = shape();
+    const auto xpixels = m_in.readValue<int32_t>();
+    const auto xstart = m_in.readValue<double>();
+    const auto xstep = m_in.readValue<double>();
+    const auto ypixels = m_in.readValue<int32_t>();
+    const auto ystart = m_in.readValue<double>();
+    const auto ystep = m_in.readValue<double>();
+    const auto zpixels = m_in.readValue<int32_t>();
+    const auto zstart = m_in.readValue<double>();
+    const auto zstep = m_in.readValue<double>();
+    const auto idstart = m_in.readValue<int32_t>();
+    const auto idFillOrder = m_in.readString();
+    const auto idstepbyrow = m_in.readValue<int32_t>();
+    const auto idstep = m_in.readValue<int32_t>();
+    grid.initialize(pixelShape, xpixels, xstart, xstep, ypixels, ystart,
+                    ystep, zpixels, zstart, zstep, idstart, idFillOrder,
+                    idstepbyrow, idstep);
+  }
+
+  void readParameters() {
+    auto &units = m_instrument->getLogfileUnit();
+    const auto numUnits = m_in.readValue<uint64_t>();
+    for (uint64_t i = 0; i < numUnits; ++i) {
+      auto unitName = m_in.readString();
+      units[unitName] = m_in.readString();
+    }
+
+    auto &parameters = m_instrument->getLogfileCache();
+    const auto numParameters = m_in.readValue<uint64_t>();
+    for (uint64_t i = 0; i < numParameters; ++i) {
+      const auto keyName = m_in.readString();
+      const auto *keyComponent = component(m_in.readIndex(m_components.size()));
+      const auto logfileID = m_in.readString();
+      const auto value = m_in.readString();
+      std::shared_ptr<Kernel::Interpolation> interpolation;
+      if (m_in.readValue<uint8_t>() != 0) {
+        interpolation = std::make_shared<Kernel::Interpolation>();
+        std::istringstream text(m_in.readString());
+        text >> *interpolation;
+      }
+      const auto formula = m_in.readString();
+      const auto formulaUnit = m_in.readString();
+      const auto resultUnit = m_in.readString();
+      const auto paramName = m_in.readString();
+      const auto type = m_in.readString();
+      const auto tie = m_in.readString();
+      std::vector<std::string> constraint(
+          static_cast<size_t>(m_in.readValue<uint64_t>()));
+      for (auto &bound : constraint)
+        bound = m_in.readString();
+      auto penaltyFactor = m_in.readString();
+      const auto fittingFunction = m_in.readString();
+      const auto extractSingleValueAs = m_in.readString();
+      const auto eq = m_in.readString();
+      const auto *paramComponent =
+          component(m_in.readIndex(m_components.size()));
+      const auto angleConvertConst = m_in.readValue<double>();
+      const auto description = m_in.readString();
+      parameters.emplace(
+          std::make_pair(keyName, keyComponent),
+          std::make_shared<XMLInstrumentParameter>(
+              logfileID, value, interpolation, formula, formulaUnit,
+              resultUnit, paramName, type, tie, constraint, penaltyFactor,
+              fittingFunction, extractSingleValueAs, eq, paramComponent,
+              angleConvertConst, description));
+    }
+  }
+
+  Reader &m_in;
+  std::shared_ptr<Instrument> m_instrument;
+  std::vector<std::shared_ptr<CSGObject>> m_shapes;
+  /// The components in the order of the entry, the instrument first
+  std::vector<IComponent *> m_components;
+  /// Index of the next generated child of each component
+  std::vector<int> m_nextChild;
+  std::vector<const IDetector *> m_monitors;
+  std::vector<const IDetector *> m_detectors;
+};
+} // namespace
+
+/** Constructor
+ * @param directory :: where the entries are kept; empty to disable the cache
+ */
+InstrumentCache::InstrumentCache(std::string directory)
+    : m_directory(std::move(directory)) {}
+
+/** Create using the instrument.cache.directory key of the configuration
+ * @return a new InstrumentCache, disabled if no directory is set
+ */
+InstrumentCache InstrumentCache::fromConfig() {
+  return InstrumentCache(Kernel::ConfigService::Instance().getString(
+      "instrument.cache.directory"));
+}
+
+/** Path of the entry for a key
+ * @param key :: the mangled name of the instrument
+ */
+std::string InstrumentCache::entryPath(const std::string &key) const {
+  Poco::Path path(m_directory);
+  path.makeDirectory();
+  path.setFileName(key + EXTENSION);
+  return path.toString();
+}
+
+/** Rebuild an instrument from the entry for a key, if there is one
+ * @param key :: the mangled name of the instrument
+ * @param name :: the name of the instrument
+ * @param filename :: the definition file, as given to the parser
+ * @param xmlText :: the XML definition, as given to the parser
+ * @return the instrument, as parsed from the definition, or nullptr on a miss
+ */
+std::shared_ptr<Instrument>
+InstrumentCache::load(const std::string &key, const std::string &name,
+                      const std::string &filename,
+                      const std::string &xmlText) const {
+  if (!enabled())
+    return nullptr;
+  const std::string path = entryPath(key);
+  Kernel::Timer timer;
+  try {
+    if (!Poco::File(path).exists()) {
+      g_log.information() << "Instrument cache miss for " << key << "\n";
+      return nullptr;
+    }
+
+    using namespace boost::interprocess;
+    const file_mapping file(path.c_str(), read_only);
+    mapped_region region(file, read_only);
+    region.advise(mapped_region::advice_sequential);
+    const auto *base = static_cast<const char *>(region.get_address());
+    const size_t fileSize = region.get_size();
+
+    Header header;
+    if (fileSize < sizeof(header))
+      throw std::runtime_error("truncated header");
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != FORMAT_VERSION ||
+        header.byteOrder != BYTE_ORDER_MARK || header.fileSize != fileSize)
+      throw std::runtime_error("not an entry written by this version");
+
+    Reader in(base + sizeof(header), fileSize - sizeof(header));
+    if (in.readString() != mantidBuild())
+      throw std::runtime_error("written by another build of Mantid");
+    if (in.readString() != key)
+      throw std::runtime_error("written for another instrument");
+
+    auto instrument = std::make_shared<Instrument>(name);
+    instrument->setFilename(filename);
+    instrument->setXmlText(xmlText);
+    InstrumentReader(in, instrument).read();
+
+    g_log.information() << "Instrument cache hit for " << key << ": read "
+                        << fileSize / 1024 << " kB in " << timer << "\n";
+    return instrument;
+  } catch (const std::exception &e) {
+    g_log.warning() << "Ignoring instrument cache entry " << path << ": "
+                    << e.what() << "\n";
+  }
+  return nullptr;
+}
+
+/** Save an instrument freshly parsed from its definition as the entry for a
+ * key. Failures are logged, never thrown, so they cannot fail a load.
+ * @param key :: the mangled name of the instrument
+ * @param instrument :: the instrument returned by the parser
+ * @return true if the entry was written
+ */
+bool InstrumentCache::save(const std::string &key,
+                           const Instrument &instrument) const {
+  if (!enabled())
+    return false;
+  Kernel::Timer timer;
+  std::string temporary;
+  try {
+    Poco::File(m_directory).createDirectories();
+
+    // Write under another name so readers never see a partial entry
+    temporary = Poco::TemporaryFile::tempName(m_directory);
+    std::ofstream out(temporary, std::ios::binary);
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.fileSize = 0;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    Writer writer(out);
+    writer.writeString(mantidBuild());
+    writer.writeString(key);
+    InstrumentWriter(writer, instrument).write();
+
+    // Now that the size is known, write the header again
+    header.fileSize = static_cast<uint64_t>(out.tellp());
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.close();
+    if (!out)
+      throw std::runtime_error("could not write " + temporary);
+    Poco::File(temporary).renameTo(entryPath(key));
+    g_log.information() << "Saved " << header.fileSize / 1024
+                        << " kB to the instrument cache for " << key << " in "
+                        << timer << "\n";
+    return true;
+  } catch (const std::invalid_argument &e) {
+    g_log.information() << "Instrument " << key << " is not cached: "
+                        << e.what() << "\n";
+  } catch (const std::exception &e) {
+    g_log.warning() << "Could not save to the instrument cache in "
+                    << m_directory << ": " << e.what() << "\n";
+  }
+  if (!temporary.empty()) {
+    try {
+      Poco::File(temporary).remove();
+    } catch (const std::exception &) {
+    }
+  }
+  return false;
+}
+
+} // namespace Geometry
+} // namespace Mantid
@@ -8,6 +8,7 @@
 #include <sstream>
 
 #include "MantidGeometry/Instrument/Detector.h"
+#include "MantidGeometry/Instrument/InstrumentCache.h"
 #include "MantidGeometry/Instrument/InstrumentDefinitionParser.h"
 #include "MantidGeometry/Instrument/ObjCompAssembly.h"
 #include "MantidGeometry/Instrument/RectangularDetector.h"
@@ -291,6 +292,31 @@ InstrumentDefinitionParser::parseXML(Kernel::ProgressBase *progressReporter) {
   return m_instrument;
 }
 
+//----------------------------------------------------------------------------------------------
+/** Rebuild the instrument from the entry of a cache if there is one, else
+ * fully parse the IDF XML contents and save the instrument to the cache
+ *
+ * @param cache :: the instrument cache to look in; may be disabled
+ * @param progressReporter :: Optional Progress reporter object. If NULL, no
+ * progress reporting.
+ * @return the instrument that was created
+ */
+Instrument_sptr InstrumentDefinitionParser::parseXMLUsingCache(
+    const InstrumentCache &cache, Kernel::ProgressBase *progressReporter) {
+  const std::string key = cache.enabled() ? getMangledName() : "";
+  if (key.empty())
+    return parseXML(progressReporter);
+
+  if (auto instrument =
+          cache.load(key, m_instrument->getName(),
+                     m_instrument->getFilename(), m_instrument->getXmlText()))
+    return instrument;
+
+  auto instrument = parseXML(progressReporter);
+  cache.save(key, *instrument);
+  return instrument;
+}
+
 /**
  * Collect some information about types for later use including:
  * - populate directory getTypeElement
@@ -0,0 +1,340 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidGeometry/Instrument/SolidAngleEngine.h"
+#include "MantidGeometry/Instrument/ComponentInfo.h"
+#include "MantidGeometry/Objects/CSGObject.h"
+#include "MantidGeometry/Objects/MeshObject.h"
+#include "MantidGeometry/Rendering/ShapeInfo.h"
+#include "MantidGeometry/Surfaces/Cylinder.h"
+#include "MantidKernel/MultiThreaded.h"
+#include "MantidKernel/Quat.h"
+
+#include <array>
+#include <cmath>
+#include <exception>
+
+namespace Mantid {
+namespace Geometry {
+using Kernel::Quat;
+using Kernel::V3D;
+
+namespace {
+/// Triangles more than this make CSGObject trace rays instead
+constexpr size_t MAX_CSG_TRIANGLES = 30000;
+/// Observers closer than this in the frame of a shape share a solid angle
+constexpr double OBSERVER_RESOLUTION = 1e-10;
+/// Number of triangles evaluated together
+constexpr size_t BLOCK_SIZE = 64;
+
+/// The twelve triangles of a cuboid, as in CSGObject
+void addCuboid(SolidAngleEngine::Surface &surface,
+               const std::vector<V3D> &vectors) {
+  const V3D dx = vectors[1] - vectors[0];
+  const V3D dz = vectors[3] - vectors[0];
+  const std::array<V3D, 8> pts{{vectors[2], vectors[2] + dx, vectors[1],
+                                vectors[0], vectors[2] + dz,
+                                vectors[2] + dz + dx, vectors[1] + dz,
+                                vectors[0] + dz}};
+  constexpr std::array<std::array<size_t, 3>, 12> triMap{
+      {{{1, 4, 3}},
+       {{3, 2, 1}},
+       {{5, 6, 7}},
+       {{7, 8, 5}},
+       {{1, 2, 6}},
+       {{6, 5, 1}},
+       {{2, 3, 7}},
+       {{7, 6, 2}},
+       {{3, 4, 8}},
+       {{8, 7, 3}},
+       {{1, 5, 8}},
+       {{8, 4, 1}}}};
+  for (const auto &triangle : triMap)
+    surface.addTriangle(pts[triangle[0] - 1], pts[triangle[1] - 1],
+                        pts[triangle[2] - 1]);
+}
+
+/// The sides of a cylinder, without its end caps, as in CSGObject
+void addCylinder(SolidAngleEngine::Surface &surface, const V3D &centre,
+                 const V3D &axis, const double radius, const double height) {
+  constexpr V3D initial_axis(0., 0., 1.0);
+  const Quat transform(initial_axis, axis);
+  constexpr double angle_step =
+      2 * M_PI / static_cast<double>(Cylinder::g_NSLICES);
+  const double z_step = height / Cylinder::g_NSTACKS;
+  double z0(0.0), z1(z_step);
+  for (int st = 1; st <= Cylinder::g_NSTACKS; ++st) {
+    if (st == Cylinder::g_NSTACKS)
+      z1 = height;
+    for (int sl = 0; sl < Cylinder::g_NSLICES; ++sl) {
+      double x = radius * std::cos(angle_step * sl);
+      double y = radius * std::sin(angle_step * sl);
+      V3D pt1 = V3D(x, y, z0);
+      V3D pt2 = V3D(x, y, z1);
+      const int vertex = (sl + 1) % Cylinder::g_NSLICES;
+      x = radius * std::cos(angle_step * vertex);
+      y = radius * std::sin(angle_step * vertex);
+      V3D pt3 = V3D(x, y, z0);
+      V3D pt4 = V3D(x, y, z1);
+      transform.rotate(pt1);
+      transform.rotate(pt3);
+      transform.rotate(pt2);
+      transform.rotate(pt4);
+      pt1 += centre;
+      pt2 += centre;
+      pt3 += centre;
+      pt4 += centre;
+      surface.addTriangle(pt1, pt4, pt3);
+      surface.addTriangle(pt1, pt2, pt4);
+    }
+    z0 = z1;
+    z1 += z_step;
+  }
+}
+
+/// A group of components with the same shape and relative observer
+struct GroupKey {
+  const SolidAngleEngine::Surface *surface;
+  std::array<long long, 3> observer;
+  bool operator==(const GroupKey &other) const {
+    return surface == other.surface && observer == other.observer;
+  }
+};
+
+struct GroupKeyHash {
+  size_t operator()(const GroupKey &key) const {
+    size_t seed = std::hash<const void *>()(key.surface);
+    for (const auto coordinate : key.observer)
+      seed ^= std::hash<long long>()(coordinate) + 0x9e3779b9 + (seed << 6) +
+              (seed >> 2);
+    return seed;
+  }
+};
+} // namespace
+
+/**
+ * Constructor
+ * @param componentInfo :: the components whose solid angles are wanted
+ */
+SolidAngleEngine::SolidAngleEngine(const ComponentInfo &componentInfo)
+    : m_componentInfo(componentInfo) {}
+
+/**
+ * Compute the solid angles of components seen from an observer
+ * @param componentIndices :: the indices of the components
+ * @param observer :: the position of the observer
+ * @return the solid angle of each component, in steradians
+ */
+std::vector<double>
+SolidAngleEngine::solidAngles(const std::vector<size_t> &componentIndices,
+                              const V3D &observer) {
+  const size_t count = componentIndices.size();
+  std::vector<double> result(count);
+  // Components that are passed on, by position in componentIndices
+  std::vector<size_t> passedOn;
+  std::vector<const Surface *> groupSurfaces;
+  std::vector<V3D> groupObservers;
+  // The group of each component, or count if passed on
+  std::vector<size_t> groups(count, count);
+  std::unordered_map<GroupKey, size_t, GroupKeyHash> groupIndices;
+
+  for (size_t i = 0; i < count; ++i) {
+    const auto index = componentIndices[i];
+    if (!m_componentInfo.hasValidShape(index) ||
+        (m_componentInfo.scaleFactor(index) - V3D(1.0, 1.0, 1.0)).norm() >=
+            1e-12) {
+      passedOn.emplace_back(i);
+      continue;
+    }
+    const auto &shape = m_componentInfo.shape(index);
+    const auto *shapeSurface = surface(shape);
+    if (!shapeSurface) {
+      passedOn.emplace_back(i);
+      continue;
+    }
+    // The observer in the frame of the shape
+    V3D relativeObserver = observer - m_componentInfo.position(index);
+    auto unrotate = m_componentInfo.rotation(index);
+    unrotate.inverse();
+    unrotate.rotate(relativeObserver);
+    const auto &boundingBox = shape.getBoundingBox();
+    if (boundingBox.isNonNull() &&
+        boundingBox.isPointInside(relativeObserver)) {
+      passedOn.emplace_back(i);
+      continue;
+    }
+    const GroupKey key{
+        shapeSurface,
+        {{std::llround(relativeObserver.X() / OBSERVER_RESOLUTION),
+          std::llround(relativeObserver.Y() / OBSERVER_RESOLUTION),
+          std::llround(relativeObserver.Z() / OBSERVER_RESOLUTION)}}};
+    const auto inserted = groupIndices.emplace(key, groupSurfaces.size());
+    if (inserted.second) {
+      groupSurfaces.emplace_back(shapeSurface);
+      groupObservers.emplace_back(relativeObserver);
+    }
+    groups[i] = inserted.first->second;
+  }
+
+  const auto numberOfGroups = static_cast<int64_t>(groupSurfaces.size());
+  std::vector<double> groupSolidAngles(groupSurfaces.size());
+  PARALLEL_FOR_NO_WSP_CHECK()
+  for (int64_t group = 0; group < numberOfGroups; ++group) {
+    groupSolidAngles[group] =
+        groupSurfaces[group]->solidAngle(groupObservers[group]);
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (groups[i] != count)
+      result[i] = groupSolidAngles[groups[i]];
+  }
+
+  // Exceptions may not leave a parallel region: keep the first one
+  std::exception_ptr error;
+  const auto numberPassedOn = static_cast<int64_t>(passedOn.size());
+  PARALLEL_FOR_NO_WSP_CHECK()
+  for (int64_t j = 0; j < numberPassedOn; ++j) {
+    const auto i = passedOn[j];
+    try {
+      result[i] = m_componentInfo.solidAngle(componentIndices[i], observer);
+    } catch (...) {
+      PARALLEL_CRITICAL(SolidAngleEngine_error) {
+        if (!error)
+          error = std::current_exception();
+      }
+    }
+  }
+  if (error)
+    std::rethrow_exception(error);
+  return result;
+}
+
+/**
+ * Get the triangles of the surface of a shape, building them the first time
+ * @param shape :: a shape of a component
+ * @return the surface, or nullptr if components of this shape are passed on
+ */
+const SolidAngleEngine::Surface *
+SolidAngleEngine::surface(const IObject &shape) {
+  const auto found = m_surfaces.find(&shape);
+  if (found != m_surfaces.end())
+    return found->second.get();
+
+  auto shapeSurface = std::make_unique<Surface>();
+  if (const auto *csgObject = dynamic_cast<const CSGObject *>(&shape)) {
+    const auto numberOfTriangles = csgObject->numberOfTriangles();
+    detail::ShapeInfo::GeometryShape type;
+    std::vector<V3D> vectors;
+    double innerRadius(0.0), radius(0.0), height(0.0);
+    csgObject->GetObjectGeom(type, vectors, innerRadius, radius, height);
+    if (numberOfTriangles > MAX_CSG_TRIANGLES) {
+      shapeSurface.reset();
+    } else if (type == detail::ShapeInfo::GeometryShape::CUBOID) {
+      shapeSurface->facingOnly = true;
+      addCuboid(*shapeSurface, vectors);
+    } else if (type == detail::ShapeInfo::GeometryShape::CYLINDER) {
+      shapeSurface->facingOnly = true;
+      addCylinder(*shapeSurface, vectors[0], vectors[1], radius, height);
+    } else if (type == detail::ShapeInfo::GeometryShape::SPHERE ||
+               type == detail::ShapeInfo::GeometryShape::CONE ||
+               numberOfTriangles == 0) {
+      // spheres are solved exactly, cones and the rest by ray tracing
+      shapeSurface.reset();
+    } else {
+      const auto &vertices = csgObject->getTriangleVertices();
+      const auto &faces = csgObject->getTriangleFaces();
+      const auto vertex = [&vertices](const uint32_t index) {
+        return V3D(vertices[3 * index], vertices[3 * index + 1],
+                   vertices[3 * index + 2]);
+      };
+      for (size_t i = 0; i < numberOfTriangles; ++i)
+        shapeSurface->addTriangle(vertex(faces[3 * i]),
+                                  vertex(faces[3 * i + 1]),
+                                  vertex(faces[3 * i + 2]));
+    }
+  } else if (const auto *meshObject =
+                 dynamic_cast<const MeshObject *>(&shape)) {
+    const auto &vertices = meshObject->getV3Ds();
+    const auto triangles = meshObject->getTriangles();
+    for (size_t i = 0; i + 2 < triangles.size(); i += 3)
+      shapeSurface->addTriangle(vertices[triangles[i]],
+                                vertices[triangles[i + 1]],
+                                vertices[triangles[i + 2]]);
+  } else {
+    shapeSurface.reset();
+  }
+  const auto *result = shapeSurface.get();
+  m_surfaces.emplace(&shape, std::move(shapeSurface));
+  return result;
+}
+
+/**
+ * Add a triangle to the surface
+ * @param a :: first point of the triangle
+ * @param b :: second point of the triangle
+ * @param c :: third point of the triangle
+ */
+void SolidAngleEngine::Surface::addTriangle(const V3D &a, const V3D &b,
+                                            const V3D &c) {
+  ax.emplace_back(a.X());
+  ay.emplace_back(a.Y());
+  az.emplace_back(a.Z());
+  bx.emplace_back(b.X());
+  by.emplace_back(b.Y());
+  bz.emplace_back(b.Z());
+  cx.emplace_back(c.X());
+  cy.emplace_back(c.Y());
+  cz.emplace_back(c.Z());
+}
+
+/**
+ * Compute the solid angle of the surface with the formula of Oosterom for
+ * each triangle, as CSGObject and MeshObject do
+ * @param observer :: the observer in the frame of the shape
+ * @return the solid angle in steradians
+ */
+double SolidAngleEngine::Surface::solidAngle(const V3D &observer) const {
+  const double ox = observer.X();
+  const double oy = observer.Y();
+  const double oz = observer.Z();
+  std::array<double, BLOCK_SIZE> tripleProducts;
+  std::array<double, BLOCK_SIZE> denominators;
+  double positive(0.0), negative(0.0);
+  for (size_t first = 0; first < size(); first += BLOCK_SIZE) {
+    const size_t blockSize = std::min(BLOCK_SIZE, size() - first);
+    // No branches or calls, so this loop is vectorised
+    for (size_t k = 0; k < blockSize; ++k) {
+      const size_t i = first + k;
+      const double aox = ax[i] - ox, aoy = ay[i] - oy, aoz = az[i] - oz;
+      const double box = bx[i] - ox, boy = by[i] - oy, boz = bz[i] - oz;
+      const double cox = cx[i] - ox, coy = cy[i] - oy, coz = cz[i] - oz;
+      const double modao = std::sqrt(aox * aox + aoy * aoy + aoz * aoz);
+      const double modbo = std::sqrt(box * box + boy * boy + boz * boz);
+      const double modco = std::sqrt(cox * cox + coy * coy + coz * coz);
+      const double aobo = aox * box + aoy * boy + aoz * boz;
+      const double aoco = aox * cox + aoy * coy + aoz * coz;
+      const double boco = box * cox + boy * coy + boz * coz;
+      tripleProducts[k] = aox * (boy * coz - boz * coy) +
+                          aoy * (boz * cox - box * coz) +
+                          aoz * (box * coy - boy * cox);
+      denominators[k] =
+          modao * modbo * modco + modco * aobo + modbo * aoco + modao * boco;
+    }
+    for (size_t k = 0; k < blockSize; ++k) {
+      const double sa =
+          denominators[k] != 0.0
+              ? 2.0 * std::atan2(tripleProducts[k], denominators[k])
+              : 0.0;
+      if (sa > 0.0)
+        positive += sa;
+      else
+        negative += sa;
+    }
+  }
+  return facingOnly ? positive : 0.5 * (positive - negative);
+}
+
+} // namespace Geometry
+} // namespace Mantid
@@ -0,0 +1,219 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidGeometry/Objects/BoundingVolumeHierarchy.h"
+
+#include <numeric>
+#include <stdexcept>
+
+namespace Mantid {
+namespace Geometry {
+
+namespace {
+/// Number of candidate split positions along each axis
+constexpr size_t NUMBER_OF_BINS = 16;
+/// Cost of visiting a node relative to that of testing a triangle
+constexpr double TRAVERSAL_COST = 1.0;
+
+/// An axis-aligned box, grown to hold points or other boxes
+struct Box {
+  std::array<double, 3> lower{{std::numeric_limits<double>::max(),
+                               std::numeric_limits<double>::max(),
+                               std::numeric_limits<double>::max()}};
+  std::array<double, 3> upper{{std::numeric_limits<double>::lowest(),
+                               std::numeric_limits<double>::lowest(),
+                               std::numeric_limits<double>::lowest()}};
+
+  void grow(const std::array<double, 3> &lowerPoint,
+            const std::array<double, 3> &upperPoint) {
+    for (size_t axis = 0; axis < 3; ++axis) {
+      lower[axis] = std::min(lower[axis], lowerPoint[axis]);
+      upper[axis] = std::max(upper[axis], upperPoint[axis]);
+    }
+  }
+  void grow(const Box &other) { grow(other.lower, other.upper); }
+  bool empty() const { return lower[0] > upper[0]; }
+  /// Half the surface area, which is all the heuristic needs
+  double area() const {
+    if (empty())
+      return 0.;
+    const double x = upper[0] - lower[0];
+    const double y = upper[1] - lower[1];
+    const double z = upper[2] - lower[2];
+    return x * y + y * z + z * x;
+  }
+};
+} // namespace
+
+/** Build the tree over the triangles of a mesh
+ * @param triangles :: the indices of the vertices of each triangle, three by
+ * three
+ * @param vertices :: the vertices of the mesh
+ */
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(
+    const std::vector<uint32_t> &triangles,
+    const std::vector<Kernel::V3D> &vertices)
+    : m_minDistance(0.) {
+  const size_t numberOfTriangles = triangles.size() / 3;
+  if (numberOfTriangles == 0)
+    return;
+  if (numberOfTriangles > std::numeric_limits<uint32_t>::max())
+    throw std::invalid_argument("Too many triangles for a bounding volume "
+                                "hierarchy");
+
+  std::vector<Bounds> bounds(numberOfTriangles);
+  double longestEdge = 0.;
+  Box all;
+  for (size_t i = 0; i < numberOfTriangles; ++i) {
+    const Kernel::V3D *corners[3] = {&vertices[triangles[3 * i]],
+                                     &vertices[triangles[3 * i + 1]],
+                                     &vertices[triangles[3 * i + 2]]};
+    auto &bound = bounds[i];
+    for (size_t axis = 0; axis < 3; ++axis) {
+      bound.lower[axis] = std::min({(*corners[0])[axis], (*corners[1])[axis],
+                                    (*corners[2])[axis]});
+      bound.upper[axis] = std::max({(*corners[0])[axis], (*corners[1])[axis],
+                                    (*corners[2])[axis]});
+      bound.centre[axis] = 0.5 * (bound.lower[axis] + bound.upper[axis]);
+    }
+    all.grow(bound.lower, bound.upper);
+    longestEdge = std::max(longestEdge, corners[1]->distance(*corners[0]));
+  }
+
+  // Rays are tested against triangles with a tolerance: the triangle test
+  // accepts crossings up to 1e-7 times the length of an edge behind the start
+  // of a ray, and rounding may put a crossing just outside a triangle.
+  m_minDistance = -2e-7 * longestEdge;
+  double size = 0.;
+  for (size_t axis = 0; axis < 3; ++axis)
+    size = std::max({size, std::abs(all.lower[axis]),
+                     std::abs(all.upper[axis])});
+  const double padding = 1e-9 * size + 1e-12;
+  for (auto &bound : bounds) {
+    for (size_t axis = 0; axis < 3; ++axis) {
+      bound.lower[axis] -= padding;
+      bound.upper[axis] += padding;
+    }
+  }
+
+  m_order.resize(numberOfTriangles);
+  std::iota(m_order.begin(), m_order.end(), 0);
+  m_nodes.reserve(2 * numberOfTriangles / MAX_LEAF_SIZE + 1);
+  build(bounds, 0, static_cast<uint32_t>(numberOfTriangles));
+}
+
+/** Build the node holding a range of m_order, and the nodes below it
+ * @param bounds :: the bounds of every triangle
+ * @param begin :: first index in m_order
+ * @param end :: one past the last index in m_order
+ * @return the index of the node
+ */
+uint32_t BoundingVolumeHierarchy::build(std::vector<Bounds> &bounds,
+                                        const uint32_t begin,
+                                        const uint32_t end) {
+  const auto index = static_cast<uint32_t>(m_nodes.size());
+  m_nodes.emplace_back();
+  Box box;
+  Box centres;
+  for (uint32_t i = begin; i < end; ++i) {
+    const auto &bound = bounds[m_order[i]];
+    box.grow(bound.lower, bound.upper);
+    centres.grow(bound.centre, bound.centre);
+  }
+  m_nodes[index].lower = box.lower;
+  m_nodes[index].upper = box.upper;
+
+  const uint32_t count = end - begin;
+  const auto makeLeaf = [&]() {
+    m_nodes[index].offset = begin;
+    m_nodes[index].count = count;
+    return index;
+  };
+  if (count <= MAX_LEAF_SIZE)
+    return makeLeaf();
+
+  // Find the cheapest split among the bin boundaries of each axis
+  double bestCost = std::numeric_limits<double>::max();
+  size_t bestAxis = 0;
+  size_t bestBin = 0;
+  for (size_t axis = 0; axis < 3; ++axis) {
+    const double extent = centres.upper[axis] - centres.lower[axis];
+    if (extent <= 0.)
+      continue;
+    const double scale = NUMBER_OF_BINS / extent;
+    std::array<Box, NUMBER_OF_BINS> binBoxes;
+    std::array<uint32_t, NUMBER_OF_BINS> binCounts{};
+    for (uint32_t i = begin; i < end; ++i) {
+      const auto &bound = bounds[m_order[i]];
+      const auto bin = std::min(
+          NUMBER_OF_BINS - 1,
+          static_cast<size_t>((bound.centre[axis] - centres.lower[axis]) *
+                              scale));
+      binBoxes[bin].grow(bound.lower, bound.upper);
+      ++binCounts[bin];
+    }
+    // Sweep from the right to get the area and count right of each boundary
+    std::array<double, NUMBER_OF_BINS> rightArea;
+    std::array<uint32_t, NUMBER_OF_BINS> rightCount;
+    Box right;
+    uint32_t rightTotal = 0;
+    for (size_t bin = NUMBER_OF_BINS - 1; bin > 0; --bin) {
+      right.grow(binBoxes[bin]);
+      rightTotal += binCounts[bin];
+      rightArea[bin] = right.area();
+      rightCount[bin] = rightTotal;
+    }
+    Box left;
+    uint32_t leftTotal = 0;
+    for (size_t bin = 1; bin < NUMBER_OF_BINS; ++bin) {
+      left.grow(binBoxes[bin - 1]);
+      leftTotal += binCounts[bin - 1];
+      if (leftTotal == 0 || rightCount[bin] == 0)
+        continue;
+      const double cost =
+          left.area() * leftTotal + rightArea[bin] * rightCount[bin];
+      if (cost < bestCost) {
+        bestCost = cost;
+        bestAxis = axis;
+        bestBin = bin;
+      }
+    }
+  }
+
+  uint32_t middle;
+  if (bestCost == std::numeric_limits<double>::max()) {
+    // All the centres coincide: split in two halves so leaves stay small
+    middle = begin + count / 2;
+  } else {
+    const double leafCost = box.area() * count;
+    if (TRAVERSAL_COST * box.area() + bestCost >= leafCost &&
+        count <= 4 * MAX_LEAF_SIZE)
+      return makeLeaf();
+    const double scale =
+        NUMBER_OF_BINS / (centres.upper[bestAxis] - centres.lower[bestAxis]);
+    const auto split = std::partition(
+        m_order.begin() + begin, m_order.begin() + end,
+        [&](const uint32_t triangle) {
+          const auto bin = std::min(
+              NUMBER_OF_BINS - 1,
+              static_cast<size_t>(
+                  (bounds[triangle].centre[bestAxis] -
+                   centres.lower[bestAxis]) *
+                  scale));
+          return bin < bestBin;
+        });
+    middle = static_cast<uint32_t>(split - m_order.begin());
+  }
+
+  build(bounds, begin, middle);
+  const auto second = build(bounds, middle, end);
+  m_nodes[index].offset = second;
+  m_nodes[index].count = 0;
+  return index;
+}
+
+} // namespace Geometry
+} // namespace Mantid
@@ -14,6 +14,9 @@
 #include "MantidKernel/Exception.h"
 #include "MantidKernel/Material.h"
 
+#include <boost/container/small_vector.hpp>
+
+#include <algorithm>
 #include <memory>
 
 namespace Mantid {
@@ -42,6 +45,28 @@ void MeshObject::initialize() {
 
   MeshObjectCommon::checkVertexLimit(m_vertices.size());
   m_handler = std::make_shared<GeometryHandler>(*this);
+  m_bvhBuilt = std::make_unique<std::once_flag>();
+}
+
+/**
+ * Get the tree of boxes over the triangles, building it on first use. This
+ * may be called from several threads.
+ * @return the bounding volume hierarchy of the mesh
+ */
+const BoundingVolumeHierarchy &MeshObject::boundingVolumeHierarchy() const {
+  std::call_once(*m_bvhBuilt, [this]() {
+    m_bvh = std::make_unique<const BoundingVolumeHierarchy>(m_triangles,
+                                                            m_vertices);
+  });
+  return *m_bvh;
+}
+
+/**
+ * Forget the tree of boxes after the vertices are moved
+ */
+void MeshObject::resetBoundingVolumeHierarchy() {
+  m_bvh.reset();
+  m_bvhBuilt = std::make_unique<std::once_flag>();
 }
 
 /**
@@ -180,9 +205,19 @@ int MeshObject::interceptSurface(Geometry::Track &UT) const {
  * @throws std::runtime_error if no intersection was found
  */
 double MeshObject::distance(const Track &track) const {
+  // The crossing of the first triangle in index order is returned, as when
+  // every triangle was tested in turn
+  boost::container::small_vector<uint32_t, 16> candidates;
+  boundingVolumeHierarchy().forEachCandidate(
+      track.startPoint(), track.direction(),
+      [&candidates](const uint32_t triangle, double &) {
+        candidates.emplace_back(triangle);
+      });
+  std::sort(candidates.begin(), candidates.end());
   Kernel::V3D vertex1, vertex2, vertex3, intersection;
   TrackDirection unused;
-  for (size_t i = 0; getTriangle(i, vertex1, vertex2, vertex3); ++i) {
+  for (const auto triangle : candidates) {
+    getTriangle(triangle, vertex1, vertex2, vertex3);
     if (MeshObjectCommon::rayIntersectsTriangle(
             track.startPoint(), track.direction(), vertex1, vertex2, vertex3,
             intersection, unused)) {
@@ -207,9 +242,19 @@ void MeshObject::getIntersections(
     std::vector<Kernel::V3D> &intersectionPoints,
     std::vector<TrackDirection> &entryExitFlags) const {
 
+  // Only the triangles whose boxes the ray crosses are tested, in index order
+  // so the points are listed as when every triangle was tested in turn
+  boost::container::small_vector<uint32_t, 16> candidates;
+  boundingVolumeHierarchy().forEachCandidate(
+      start, direction, [&candidates](const uint32_t triangle, double &) {
+        candidates.emplace_back(triangle);
+      });
+  std::sort(candidates.begin(), candidates.end());
+
   Kernel::V3D vertex1, vertex2, vertex3, intersection;
   TrackDirection entryExit;
-  for (size_t i = 0; getTriangle(i, vertex1, vertex2, vertex3); ++i) {
+  for (const auto triangle : candidates) {
+    getTriangle(triangle, vertex1, vertex2, vertex3);
     if (MeshObjectCommon::rayIntersectsTriangle(start, direction, vertex1,
                                                 vertex2, vertex3, intersection,
                                                 entryExit)) {
@@ -499,6 +544,7 @@ void MeshObject::rotate(const Kernel::Matrix<double> &rotationMatrix) {
   for (Kernel::V3D &vertex : m_vertices) {
     vertex.rotate(rotationMatrix);
   }
+  resetBoundingVolumeHierarchy();
 }
 
 /**
@@ -509,6 +555,7 @@ void MeshObject::translate(const Kernel::V3D &translationVector) {
   for (Kernel::V3D &vertex : m_vertices) {
     vertex += translationVector;
   }
+  resetBoundingVolumeHierarchy();
 }
 
 /**
@@ -519,6 +566,7 @@ void MeshObject::scale(const double scaleFactor) {
   for (Kernel::V3D &vertex : m_vertices) {
     vertex *= scaleFactor;
   }
+  resetBoundingVolumeHierarchy();
 }
 
 /**
@@ -544,6 +592,7 @@ void MeshObject::multiply(const Kernel::Matrix<double> &matrix) {
     Kernel::V3D newvertex(vertexout[0], vertexout[1], vertexout[2]);
     vertex = newvertex;
   }
+  resetBoundingVolumeHierarchy();
 }
 
 /**
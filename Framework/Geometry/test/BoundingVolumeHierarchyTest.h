@@ -0,0 +1,112 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidGeometry/Objects/BoundingVolumeHierarchy.h"
+#include "MantidGeometry/Objects/MeshObjectCommon.h"
+#include "MantidKernel/MersenneTwister.h"
+#include <cxxtest/TestSuite.h>
+
+#include <cmath>
+#include <set>
+
+using namespace Mantid::Geometry;
+using Mantid::Kernel::V3D;
+
+namespace {
+/// A unit sphere made of many small triangles
+void createSphere(std::vector<uint32_t> &triangles,
+                  std::vector<V3D> &vertices) {
+  const uint32_t rings = 40;
+  const uint32_t segments = 80;
+  for (uint32_t i = 0; i <= rings; ++i) {
+    const double theta = M_PI * i / rings;
+    for (uint32_t j = 0; j < segments; ++j) {
+      const double phi = 2. * M_PI * j / segments;
+      vertices.emplace_back(std::sin(theta) * std::cos(phi),
+                            std::sin(theta) * std::sin(phi), std::cos(theta));
+    }
+  }
+  for (uint32_t i = 0; i < rings; ++i) {
+    for (uint32_t j = 0; j < segments; ++j) {
+      const uint32_t a = i * segments + j;
+      const uint32_t b = i * segments + (j + 1) % segments;
+      triangles.insert(triangles.end(), {a, a + segments, b});
+      triangles.insert(triangles.end(), {b, a + segments, b + segments});
+    }
+  }
+}
+
+std::set<uint32_t> crossedTriangles(const std::vector<uint32_t> &triangles,
+                                    const std::vector<V3D> &vertices,
+                                    const V3D &start, const V3D &direction) {
+  std::set<uint32_t> crossed;
+  V3D intersection;
+  TrackDirection entryExit;
+  for (uint32_t i = 0; i < triangles.size() / 3; ++i) {
+    if (MeshObjectCommon::rayIntersectsTriangle(
+            start, direction, vertices[triangles[3 * i]],
+            vertices[triangles[3 * i + 1]], vertices[triangles[3 * i + 2]],
+            intersection, entryExit))
+      crossed.emplace(i);
+  }
+  return crossed;
+}
+} // namespace
+
+class BoundingVolumeHierarchyTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static BoundingVolumeHierarchyTest *createSuite() {
+    return new BoundingVolumeHierarchyTest();
+  }
+  static void destroySuite(BoundingVolumeHierarchyTest *suite) {
+    delete suite;
+  }
+
+  BoundingVolumeHierarchyTest() { createSphere(m_triangles, m_vertices); }
+
+  void test_empty_mesh_has_no_candidates() {
+    BoundingVolumeHierarchy bvh({}, {});
+    TS_ASSERT_EQUALS(bvh.numberOfNodes(), 0);
+    size_t visited = 0;
+    bvh.forEachCandidate(V3D(0, 0, 0), V3D(0, 0, 1),
+                         [&visited](uint32_t, double &) { ++visited; });
+    TS_ASSERT_EQUALS(visited, 0);
+  }
+
+  void test_candidates_hold_every_crossed_triangle() {
+    BoundingVolumeHierarchy bvh(m_triangles, m_vertices);
+    Mantid::Kernel::MersenneTwister rng(7, -2., 2.);
+    size_t candidates = 0;
+    for (size_t ray = 0; ray < 500; ++ray) {
+      V3D start(rng.nextValue(), rng.nextValue(), rng.nextValue());
+      V3D direction(rng.nextValue(), rng.nextValue(), rng.nextValue());
+      if (ray % 5 == 0) // along an axis
+        direction = V3D(0, 0, 1);
+      if (ray % 5 == 1) // from a vertex of the mesh
+        start = m_vertices[(ray * 37) % m_vertices.size()];
+      direction.normalize();
+      std::set<uint32_t> found;
+      bvh.forEachCandidate(start, direction,
+                           [&found](const uint32_t triangle, double &) {
+                             found.emplace(triangle);
+                           });
+      candidates += found.size();
+      for (const auto triangle :
+           crossedTriangles(m_triangles, m_vertices, start, direction))
+        TS_ASSERT(found.count(triangle) == 1);
+    }
+    // Far fewer triangles are tested than the whole mesh
+    TS_ASSERT_LESS_THAN(candidates, 500 * m_triangles.size() / 3 / 20);
+  }
+
+private:
+  std::vector<uint32_t> m_triangles;
+  std::vector<V3D> m_vertices;
+};
@@ -0,0 +1,198 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidGeometry/Instrument/ComponentInfo.h"
+#include "MantidGeometry/Instrument/DetectorInfo.h"
+#include "MantidGeometry/Instrument/InstrumentCache.h"
+#include "MantidGeometry/Instrument/InstrumentDefinitionParser.h"
+#include "MantidGeometry/Instrument/ParameterMap.h"
+#include "MantidGeometry/Instrument/RectangularDetector.h"
+#include "MantidGeometry/Instrument/ReferenceFrame.h"
+#include "MantidGeometry/Instrument/XMLInstrumentParameter.h"
+#include "MantidKernel/ConfigService.h"
+#include "MantidKernel/Strings.h"
+#include <cxxtest/TestSuite.h>
+
+#include <Poco/File.h>
+#include <Poco/Path.h>
+
+#include <fstream>
+
+using namespace Mantid::Geometry;
+using namespace Mantid::Kernel;
+using Mantid::detid2det_map;
+
+class InstrumentCacheTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static InstrumentCacheTest *createSuite() {
+    return new InstrumentCacheTest();
+  }
+  static void destroySuite(InstrumentCacheTest *suite) { delete suite; }
+
+  InstrumentCacheTest()
+      : m_directory(Poco::Path(Poco::Path(Poco::Path::temp()),
+                               "InstrumentCacheTest")
+                        .toString()) {}
+
+  void tearDown() override {
+    Poco::File directory(m_directory);
+    if (directory.exists())
+      directory.remove(true);
+  }
+
+  void test_disabled_without_directory() {
+    InstrumentCache cache("");
+    TS_ASSERT(!cache.enabled());
+    auto parser = makeParser("IDF_for_UNIT_TESTING2.xml", "UnitTesting2");
+    Instrument_sptr instrument;
+    TS_ASSERT_THROWS_NOTHING(
+        instrument = parser.parseXMLUsingCache(cache, nullptr));
+    TS_ASSERT(instrument);
+    TS_ASSERT(!cache.save(parser.getMangledName(), *instrument));
+    TS_ASSERT(!Poco::File(m_directory).exists());
+  }
+
+  void test_miss() {
+    InstrumentCache cache(m_directory);
+    TS_ASSERT(!cache.load("missing", "name", "", ""));
+  }
+
+  void test_parameters_sample_and_monitors_are_restored() {
+    InstrumentCache cache(m_directory);
+    auto parser = makeParser("IDF_for_UNIT_TESTING2.xml", "UnitTesting2");
+    const auto key = parser.getMangledName();
+    const auto parsed = parser.parseXMLUsingCache(cache, nullptr);
+    TS_ASSERT(Poco::File(cache.entryPath(key)).exists());
+
+    auto reparser = makeParser("IDF_for_UNIT_TESTING2.xml", "UnitTesting2");
+    const auto cached = reparser.parseXMLUsingCache(cache, nullptr);
+    TS_ASSERT_DIFFERS(cached, parsed);
+    assertSameInstrument(*parsed, *cached);
+    TS_ASSERT_EQUALS(cached->getFilename(), parsed->getFilename());
+    TS_ASSERT_EQUALS(cached->getXmlText(), parsed->getXmlText());
+
+    TS_ASSERT_EQUALS(cached->getSample()->getName(), "nickel-holder");
+    TS_ASSERT_DELTA(cached->getSample()->getPos().X(), 2.0, 0.01);
+    TS_ASSERT_EQUALS(cached->getSource()->getName(), "undulator");
+    TS_ASSERT_DELTA(cached->getSource()->getPos().Z(), -95.0, 0.01);
+    TS_ASSERT_EQUALS(cached->getMonitors(), parsed->getMonitors());
+    TS_ASSERT(cached->isMonitor(1001));
+
+    // The shapes are created again from their XML
+    const auto monitor = cached->getDetector(1001);
+    TS_ASSERT(monitor->isValid(V3D(0.002, 0.0, 0.0) + monitor->getPos()));
+    TS_ASSERT(!monitor->isValid(V3D(0.003, 0.0, 0.0) + monitor->getPos()));
+
+    const auto &parameters = cached->getLogfileCache();
+    TS_ASSERT_EQUALS(parameters.size(), parsed->getLogfileCache().size());
+    const auto fitting = parameters.find(
+        std::make_pair(std::string("somefunction:percentage"),
+                       static_cast<const IComponent *>(cached.get())));
+    TS_ASSERT(fitting != parameters.end());
+    if (fitting != parameters.end()) {
+      TS_ASSERT_EQUALS(fitting->second->m_value, "250.0");
+      TS_ASSERT_EQUALS(fitting->second->m_penaltyFactor, "9.1");
+      TS_ASSERT_EQUALS(fitting->second->m_constraint[0], "80%");
+      TS_ASSERT_EQUALS(fitting->second->m_component, cached.get());
+    }
+  }
+
+  void test_rectangular_detectors_are_restored() {
+    InstrumentCache cache(m_directory);
+    auto parser = makeParser("IDF_for_RECTANGULAR_UNIT_TESTING.xml",
+                             "RectangularUnitTest");
+    const auto parsed = parser.parseXMLUsingCache(cache, nullptr);
+    auto reparser = makeParser("IDF_for_RECTANGULAR_UNIT_TESTING.xml",
+                               "RectangularUnitTest");
+    const auto cached = reparser.parseXMLUsingCache(cache, nullptr);
+    assertSameInstrument(*parsed, *cached);
+
+    const auto bank1 = std::dynamic_pointer_cast<const RectangularDetector>(
+        cached->getComponentByName("bank1"));
+    TS_ASSERT(bank1);
+    if (!bank1)
+      return;
+    TS_ASSERT_EQUALS(bank1->nelements(), 100);
+    TS_ASSERT_DELTA(bank1->getAtXY(1, 0)->getPos().X(), -0.098, 1e-4);
+    TS_ASSERT_DELTA(bank1->getAtXY(1, 1)->getPos().Y(), -0.198, 1e-4);
+    TS_ASSERT_EQUALS(bank1->getAtXY(1, 1)->getID(), 1301);
+
+    // The beamline can be built from the restored tree
+    TS_ASSERT_THROWS_NOTHING(cached->parseTreeAndCacheBeamline());
+    parsed->parseTreeAndCacheBeamline();
+    ParameterMap parsedMap;
+    ParameterMap cachedMap;
+    const auto parsedBeamline = parsed->makeBeamline(parsedMap);
+    const auto cachedBeamline = cached->makeBeamline(cachedMap);
+    TS_ASSERT_EQUALS(cachedBeamline.first->size(),
+                     parsedBeamline.first->size());
+    TS_ASSERT_EQUALS(cachedBeamline.second->size(),
+                     parsedBeamline.second->size());
+    TS_ASSERT_EQUALS(cachedBeamline.second->position(0),
+                     parsedBeamline.second->position(0));
+  }
+
+  void test_corrupt_entry_is_ignored() {
+    InstrumentCache cache(m_directory);
+    auto parser = makeParser("IDF_for_UNIT_TESTING2.xml", "UnitTesting2");
+    const auto key = parser.getMangledName();
+    Poco::File(m_directory).createDirectories();
+    std::ofstream(cache.entryPath(key)) << "not an instrument";
+    TS_ASSERT(!cache.load(key, "UnitTesting2", "", ""));
+
+    // The instrument is parsed and the entry replaced
+    const auto parsed = parser.parseXMLUsingCache(cache, nullptr);
+    TS_ASSERT(parsed);
+    TS_ASSERT(cache.load(key, "UnitTesting2", "", ""));
+  }
+
+private:
+  InstrumentDefinitionParser makeParser(const std::string &idf,
+                                        const std::string &name) {
+    const std::string filename =
+        ConfigService::Instance().getInstrumentDirectory() + "/unit_testing/" +
+        idf;
+    return InstrumentDefinitionParser(filename, name,
+                                      Strings::loadFile(filename));
+  }
+
+  void assertSameInstrument(const Instrument &parsed,
+                            const Instrument &cached) {
+    TS_ASSERT_EQUALS(cached.getName(), parsed.getName());
+    TS_ASSERT_EQUALS(cached.getDefaultView(), parsed.getDefaultView());
+    TS_ASSERT_EQUALS(cached.getValidFromDate(), parsed.getValidFromDate());
+    TS_ASSERT_EQUALS(cached.getValidToDate(), parsed.getValidToDate());
+    const auto frame = cached.getReferenceFrame();
+    TS_ASSERT_EQUALS(frame->pointingUp(),
+                     parsed.getReferenceFrame()->pointingUp());
+    TS_ASSERT_EQUALS(frame->pointingAlongBeam(),
+                     parsed.getReferenceFrame()->pointingAlongBeam());
+    TS_ASSERT_EQUALS(frame->vecThetaSign(),
+                     parsed.getReferenceFrame()->vecThetaSign());
+    TS_ASSERT_EQUALS(cached.getDetectorIDs(), parsed.getDetectorIDs());
+
+    detid2det_map parsedDetectors;
+    parsed.getDetectors(parsedDetectors);
+    detid2det_map cachedDetectors;
+    cached.getDetectors(cachedDetectors);
+    TS_ASSERT_EQUALS(cachedDetectors.size(), parsedDetectors.size());
+    for (const auto &detector : parsedDetectors) {
+      const auto &other = cachedDetectors[detector.first];
+      TS_ASSERT(other);
+      if (!other)
+        return;
+      TS_ASSERT_EQUALS(other->getFullName(), detector.second->getFullName());
+      TS_ASSERT(other->getPos() == detector.second->getPos());
+      TS_ASSERT(other->getRotation() == detector.second->getRotation());
+    }
+  }
+
+  std::string m_directory;
+};
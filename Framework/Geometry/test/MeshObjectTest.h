@@ -984,6 +984,14 @@ public:
     auto moved = octahedron->getVertices();
     TS_ASSERT_DELTA(moved, checkVector, 1e-8);
   }
+
+  void testDistanceFollowsTranslation() {
+    auto geom_obj = createCube(3);
+    const Track track(V3D(1, 1, 1), V3D(0, 0, 1));
+    TS_ASSERT_DELTA(geom_obj->distance(track), 2.0, 1e-8);
+    geom_obj->translate(V3D(0, 0, 0.5));
+    TS_ASSERT_DELTA(geom_obj->distance(track), 2.5, 1e-8);
+  }
 };
 
 // -----------------------------------------------------------------------------
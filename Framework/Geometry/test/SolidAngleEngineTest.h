@@ -0,0 +1,160 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include <cxxtest/TestSuite.h>
+
+#include "MantidGeometry/Instrument/ComponentInfo.h"
+#include "MantidGeometry/Instrument/Detector.h"
+#include "MantidGeometry/Instrument/DetectorInfo.h"
+#include "MantidGeometry/Instrument/InstrumentVisitor.h"
+#include "MantidGeometry/Instrument/SolidAngleEngine.h"
+#include "MantidTestHelpers/ComponentCreationHelper.h"
+
+#include <numeric>
+
+using namespace Mantid::Geometry;
+using Mantid::Kernel::V3D;
+
+class SolidAngleEngineTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static SolidAngleEngineTest *createSuite() {
+    return new SolidAngleEngineTest();
+  }
+  static void destroySuite(SolidAngleEngineTest *suite) { delete suite; }
+
+  void test_cylinders_match_component_info() {
+    auto instrument =
+        ComponentCreationHelper::createTestInstrumentCylindrical(2);
+    assertMatchesComponentInfo(*instrument, V3D(0.0, 0.0, 0.0));
+    assertMatchesComponentInfo(*instrument, V3D(0.1, -0.3, 0.2));
+  }
+
+  void test_cuboids_match_component_info() {
+    auto instrument = createCuboidInstrument();
+    assertMatchesComponentInfo(*instrument, V3D(0.0, 0.0, 0.0));
+    assertMatchesComponentInfo(*instrument, V3D(0.4, 0.2, -0.1));
+  }
+
+  void test_spheres_are_passed_on() {
+    auto instrument = ComponentCreationHelper::createMinimalInstrument(
+        V3D(0.0, 0.0, -10.0), V3D(0.0, 0.0, 0.0), V3D(0.0, 0.0, 2.0));
+    assertMatchesComponentInfo(*instrument, V3D(0.0, 0.0, 0.0));
+  }
+
+  void test_observer_inside_a_detector() {
+    auto instrument =
+        ComponentCreationHelper::createTestInstrumentCylindrical(1);
+    auto wrappers = InstrumentVisitor::makeWrappers(*instrument);
+    const auto &componentInfo = *std::get<0>(wrappers);
+    SolidAngleEngine engine(componentInfo);
+    const auto solidAngles =
+        engine.solidAngles({0, 1}, componentInfo.position(0));
+    TS_ASSERT_DELTA(solidAngles[0], 4.0 * M_PI, 1e-12);
+    TS_ASSERT_DELTA(solidAngles[1],
+                    componentInfo.solidAngle(1, componentInfo.position(0)),
+                    1e-12);
+  }
+
+  void test_scaled_detectors_are_passed_on() {
+    auto instrument = createCuboidInstrument();
+    auto wrappers = InstrumentVisitor::makeWrappers(*instrument);
+    auto &componentInfo = *std::get<0>(wrappers);
+    componentInfo.setScaleFactor(0, V3D(2.0, 2.0, 1.0));
+    SolidAngleEngine engine(componentInfo);
+    const V3D observer(0.0, 0.0, 0.0);
+    const auto solidAngles = engine.solidAngles({0, 3}, observer);
+    TS_ASSERT_DELTA(solidAngles[0], componentInfo.solidAngle(0, observer),
+                    1e-12);
+    // The detectors are alike but for the scaling
+    TS_ASSERT_DELTA(solidAngles[0], 4.0 * solidAngles[1],
+                    0.01 * solidAngles[0]);
+  }
+
+  void test_repeated_detectors_get_the_same_value() {
+    auto instrument =
+        ComponentCreationHelper::createTestInstrumentCylindrical(1);
+    auto wrappers = InstrumentVisitor::makeWrappers(*instrument);
+    SolidAngleEngine engine(*std::get<0>(wrappers));
+    const auto solidAngles =
+        engine.solidAngles({3, 0, 3, 3}, V3D(0.0, 0.0, 0.0));
+    TS_ASSERT_EQUALS(solidAngles[0], solidAngles[2]);
+    TS_ASSERT_EQUALS(solidAngles[0], solidAngles[3]);
+    TS_ASSERT_DIFFERS(solidAngles[0], 0.0);
+  }
+
+private:
+  /// A ring of rotated cuboid detectors around the sample
+  Instrument_sptr createCuboidInstrument() {
+    auto instrument = std::make_shared<Instrument>("cuboids");
+    ComponentCreationHelper::addSourceToInstrument(instrument,
+                                                   V3D(0.0, 0.0, -10.0));
+    ComponentCreationHelper::addSampleToInstrument(instrument,
+                                                   V3D(0.0, 0.0, 0.0));
+    const auto shape =
+        ComponentCreationHelper::createCuboid(0.01, 0.05, 0.002);
+    for (int i = 0; i < 12; ++i) {
+      auto detector = new Detector("cuboid", i + 1, shape, nullptr);
+      const double angle = 30.0 * i;
+      const Mantid::Kernel::Quat rotation(angle, V3D(0.0, 1.0, 0.0));
+      V3D position(0.0, 0.1 * (i % 3), 2.0);
+      rotation.rotate(position);
+      detector->setPos(position);
+      detector->setRot(rotation);
+      instrument->add(detector);
+      instrument->markAsDetector(detector);
+    }
+    return instrument;
+  }
+
+  void assertMatchesComponentInfo(const Instrument &instrument,
+                                  const V3D &observer) {
+    auto wrappers = InstrumentVisitor::makeWrappers(instrument);
+    const auto &componentInfo = *std::get<0>(wrappers);
+    const auto &detectorInfo = *std::get<1>(wrappers);
+    std::vector<size_t> indices(detectorInfo.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    SolidAngleEngine engine(componentInfo);
+    const auto solidAngles = engine.solidAngles(indices, observer);
+    TS_ASSERT_EQUALS(solidAngles.size(), indices.size());
+    for (const auto index : indices) {
+      const double expected = componentInfo.solidAngle(index, observer);
+      TS_ASSERT_DELTA(solidAngles[index], expected, 1e-12 * expected);
+    }
+  }
+};
+
+class SolidAngleEngineTestPerformance : public CxxTest::TestSuite {
+public:
+  static SolidAngleEngineTestPerformance *createSuite() {
+    return new SolidAngleEngineTestPerformance();
+  }
+  static void destroySuite(SolidAngleEngineTestPerformance *suite) {
+    delete suite;
+  }
+
+  SolidAngleEngineTestPerformance()
+      : m_instrument(
+            ComponentCreationHelper::createTestInstrumentRectangular(6, 100)) {
+    m_wrappers = InstrumentVisitor::makeWrappers(*m_instrument);
+    m_indices.resize(std::get<1>(m_wrappers)->size());
+    std::iota(m_indices.begin(), m_indices.end(), 0);
+  }
+
+  void test_rectangular_banks() {
+    SolidAngleEngine engine(*std::get<0>(m_wrappers));
+    engine.solidAngles(m_indices, V3D(0.0, 0.0, 0.0));
+  }
+
+private:
+  Instrument_sptr m_instrument;
+  std::pair<std::unique_ptr<ComponentInfo>, std::unique_ptr<DetectorInfo>>
+      m_wrappers;
+  std::vector<size_t> m_indices;
+};
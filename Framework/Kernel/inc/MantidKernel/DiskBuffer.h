@@ -15,11 +15,17 @@
 #include <boost/multi_index/sequenced_index.hpp>
 #include <boost/multi_index_container.hpp>
 #endif
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <limits>
 #include <list>
+#include <map>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace Mantid {
@@ -37,6 +43,16 @@ class ISaveable;
   It also stores a list of "free" blocks in the output file,
   to allow new blocks to fill them later.
 
+  With background I/O switched on, a thread owned by the buffer does the
+  writes and reads handed to it by the file formats deriving from this class:
+  blocks are written behind the thread that saves them, and blocks named by
+  prefetch() are read ahead and kept until they are loaded, or until room is
+  needed for newer ones: the blocks read ahead take at most as many events as
+  the write buffer, and the oldest are forgotten first. Reading a block
+  waits for the background work touching it, so it always sees the last
+  write. The number of blocks found read ahead or not, the bytes moved and
+  the time spent waiting are counted.
+
   @date 2011-12-30
 */
 class DLLExport DiskBuffer {
@@ -57,11 +73,25 @@ public:
   /// A way to index the free space by their size
   using freeSpace_bySize_t = freeSpace_t::nth_index<1>::type;
 
+  /// Counters of the reads and writes of the file
+  struct IOStatistics {
+    /// Number of blocks loaded that had been read ahead
+    uint64_t hits = 0;
+    /// Number of blocks loaded that had to be read when asked for
+    uint64_t misses = 0;
+    /// Bytes read from the file
+    uint64_t bytesRead = 0;
+    /// Bytes written to the file
+    uint64_t bytesWritten = 0;
+    /// Time spent waiting for background reads and writes, in seconds
+    double stallTime = 0.;
+  };
+
   DiskBuffer();
   DiskBuffer(uint64_t m_writeBufferSize);
   DiskBuffer(const DiskBuffer &) = delete;
   DiskBuffer &operator=(const DiskBuffer &) = delete;
-  virtual ~DiskBuffer() = default;
+  virtual ~DiskBuffer();
 
   void toWrite(ISaveable *item);
   void flushCache();
@@ -81,6 +111,16 @@ public:
   void setFreeSpaceVector(std::vector<uint64_t> &free);
   std::string getMemoryStr() const;
 
+  // Background I/O
+  void setBackgroundIO(const bool enable);
+  /// @return true if reads and writes can be done by a background thread
+  bool hasBackgroundIO() const { return m_ioThread.joinable(); }
+  void prefetch(const ISaveable *item);
+  void waitForIO() const;
+  IOStatistics getIOStatistics() const;
+  void resetIOStatistics();
+  std::string getIOStatisticsStr() const;
+
   //-------------------------------------------------------------------------------------------
   /** Set the size of the to-write buffer, in number of events
    * @param buffer :: number of events to accumulate before writing. 0 to NOT
@@ -99,6 +139,8 @@ public:
   ///@return the memory used in the "toWrite" buffer, in number of events
   uint64_t getWriteBufferUsed() const { return m_writeBufferUsed; }
 
+  uint64_t getPrefetchedSize() const;
+
   //-------------------------------------------------------------------------------------------
   ///@return reference to the free space map (for testing only!)
   freeSpace_t &getFreeSpaceMap() { return m_free; }
@@ -118,6 +160,26 @@ public:
 protected:
   inline void writeOldObjects();
 
+  /** Read ahead the block of events at the given position and of the given
+   * size in the file. Does nothing here: file formats able to read in the
+   * background override it, reading the block with runInBackground() and
+   * keeping it with storePrefetched(). */
+  virtual void prefetchBlock(const uint64_t /*position*/,
+                             const uint64_t /*size*/) {}
+
+  void runInBackground(const uint64_t position, const uint64_t size,
+                       const bool isWrite, std::function<void()> task) const;
+  void storePrefetched(const uint64_t position, const uint64_t size,
+                       std::vector<float> &&block) const;
+  void storePrefetched(const uint64_t position, const uint64_t size,
+                       std::vector<double> &&block) const;
+  bool takePrefetched(std::vector<float> &block, const uint64_t position,
+                      const uint64_t size) const;
+  bool takePrefetched(std::vector<double> &block, const uint64_t position,
+                      const uint64_t size) const;
+  void recordRead(const uint64_t bytes) const;
+  void recordWrite(const uint64_t bytes) const;
+
   // ----------------------- To-write buffer
   // --------------------------------------
   /// Do we use the write buffer? Always now
@@ -152,6 +214,52 @@ protected:
   mutable uint64_t m_fileLength;
 
 private:
+  /// Work for the background thread, and the events it touches in the file
+  struct IOTask {
+    uint64_t position;
+    uint64_t size;
+    bool isWrite;
+    std::function<void()> run;
+  };
+  /// A block read ahead
+  struct PrefetchedBlock {
+    uint64_t size;
+    std::vector<float> floats;
+    std::vector<double> doubles;
+    /// Order in which the blocks were read ahead
+    uint64_t sequence;
+  };
+
+  void runIOTasks();
+  bool isPending(const uint64_t position, const uint64_t size,
+                 const bool readsOnly = false) const;
+  bool takeBlock(PrefetchedBlock &block, const uint64_t position,
+                 const uint64_t size) const;
+  bool makeRoomForPrefetch(const uint64_t size) const;
+
+  // ----------------------- Background I/O ------------------------------------
+  /// The thread doing the background reads and writes
+  std::thread m_ioThread;
+  /// Lock for the background work, the blocks read ahead and the counters
+  mutable std::mutex m_ioMutex;
+  /// Signalled when work is added or done
+  mutable std::condition_variable m_ioChanged;
+  /// Work not yet started, in the order it was given
+  mutable std::deque<IOTask> m_ioTasks;
+  /// Work started but not finished
+  mutable std::list<IOTask> m_ioRunning;
+  /// Whether the background thread should stop
+  bool m_ioStop;
+  /// The first error of the background work, rethrown to the caller
+  mutable std::exception_ptr m_ioError;
+  /// Blocks read ahead, by position in the file
+  mutable std::map<uint64_t, PrefetchedBlock> m_prefetched;
+  /// Number of events in the blocks read ahead or being read
+  mutable uint64_t m_prefetchedSize;
+  /// Sequence number of the next block read ahead
+  mutable uint64_t m_prefetchSequence;
+  /// Counters of the reads and writes
+  mutable IOStatistics m_ioStatistics;
 };
 
 } // namespace Kernel
@@ -6,6 +6,11 @@
 // SPDX - License - Identifier: GPL - 3.0 +
 #include "MantidKernel/DiskBuffer.h"
 #include "MantidKernel/ISaveable.h"
+#include "MantidKernel/Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
 #include <sstream>
 #include <utility>
 
@@ -14,12 +19,18 @@ using namespace Mantid::Kernel;
 namespace Mantid {
 namespace Kernel {
 
+namespace {
+/// static logger
+Logger g_log("DiskBuffer");
+} // namespace
+
 //----------------------------------------------------------------------------------------------
 /** Constructor
  */
 DiskBuffer::DiskBuffer()
     : m_writeBufferSize(50), m_writeBufferUsed(0), m_nObjectsToWrite(0),
-      m_free(), m_free_bySize(m_free.get<1>()), m_fileLength(0) {
+      m_free(), m_free_bySize(m_free.get<1>()), m_fileLength(0),
+      m_ioStop(false), m_prefetchedSize(0), m_prefetchSequence(0) {
   m_free.clear();
 }
 
@@ -33,10 +44,27 @@ DiskBuffer::DiskBuffer()
 DiskBuffer::DiskBuffer(uint64_t m_writeBufferSize)
     : m_writeBufferSize(m_writeBufferSize), m_writeBufferUsed(0),
       m_nObjectsToWrite(0), m_free(), m_free_bySize(m_free.get<1>()),
-      m_fileLength(0) {
+      m_fileLength(0), m_ioStop(false), m_prefetchedSize(0),
+      m_prefetchSequence(0) {
   m_free.clear();
 }
 
+/** Destructor. Stops the background thread after it has done all the work
+ * given to it, logging the error of the work if any. Classes giving it work
+ * referring to themselves must stop it in their own destructor. */
+DiskBuffer::~DiskBuffer() {
+  this->setBackgroundIO(false);
+  if (!m_ioError)
+    return;
+  try {
+    std::rethrow_exception(m_ioError);
+  } catch (const std::exception &e) {
+    g_log.error() << "Background disk I/O failed: " << e.what() << '\n';
+  } catch (...) {
+    g_log.error("Background disk I/O failed\n");
+  }
+}
+
 //---------------------------------------------------------------------------------------------
 /** Call this method when an object is ready to be written
  * out to disk.
@@ -191,10 +219,12 @@ void DiskBuffer::writeOldObjects() {
 
 //---------------------------------------------------------------------------------------------
 /** Flush out all the data in the memory; and writes out everything in the
- * to-write cache. */
+ * to-write cache. Waits for the writes done in the background and rethrows
+ * their error, if any. */
 void DiskBuffer::flushCache() {
   // Now write everything out.
   writeOldObjects();
+  this->waitForIO();
 }
 
 //---------------------------------------------------------------------------------------------
@@ -383,6 +413,317 @@ void DiskBuffer::setFreeSpaceVector(std::vector<uint64_t> &free) {
   }
 }
 
+//---------------------------------------------------------------------------------------------
+/** Switch the background thread doing reads and writes on or off. Switching
+ * it off waits for the work given to it and forgets the blocks read ahead.
+ * @param enable :: true to do reads and writes in the background
+ */
+void DiskBuffer::setBackgroundIO(const bool enable) {
+  if (enable == this->hasBackgroundIO())
+    return;
+  if (enable) {
+    m_ioStop = false;
+    m_ioThread = std::thread(&DiskBuffer::runIOTasks, this);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_ioMutex);
+    m_ioStop = true;
+  }
+  m_ioChanged.notify_all();
+  m_ioThread.join();
+  std::lock_guard<std::mutex> lock(m_ioMutex);
+  m_prefetched.clear();
+  m_prefetchedSize = 0;
+}
+
+/// Loop of the background thread: do the work in the order it was given
+void DiskBuffer::runIOTasks() {
+  std::unique_lock<std::mutex> lock(m_ioMutex);
+  while (true) {
+    m_ioChanged.wait(lock, [this] { return m_ioStop || !m_ioTasks.empty(); });
+    if (m_ioTasks.empty())
+      return;
+    m_ioRunning.emplace_back(std::move(m_ioTasks.front()));
+    m_ioTasks.pop_front();
+    const auto task = std::prev(m_ioRunning.end());
+    lock.unlock();
+
+    std::exception_ptr error;
+    try {
+      task->run();
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    lock.lock();
+    if (error && !m_ioError)
+      m_ioError = error;
+    if (task->isWrite) {
+      // Blocks read ahead of this write are out of date
+      const uint64_t end = task->position + task->size;
+      for (auto block = m_prefetched.begin(); block != m_prefetched.end();) {
+        if (block->first < end &&
+            block->first + block->second.size > task->position) {
+          m_prefetchedSize -= block->second.size;
+          block = m_prefetched.erase(block);
+        } else {
+          ++block;
+        }
+      }
+    } else if (error) {
+      // The read failed: give back the space reserved for it. A block read
+      // may already have been forgotten to make room, so it is not looked for.
+      m_prefetchedSize -= task->size;
+    }
+    m_ioRunning.erase(task);
+    m_ioChanged.notify_all();
+  }
+}
+
+/** Whether background work not yet finished touches some events of the file.
+ * Must be called under the background I/O lock.
+ * @param position :: position of the first event
+ * @param size :: number of events
+ * @param readsOnly :: if true, look only at the reads
+ * @return true if unfinished work reads or writes any of the events
+ */
+bool DiskBuffer::isPending(const uint64_t position, const uint64_t size,
+                           const bool readsOnly) const {
+  const auto overlaps = [position, size, readsOnly](const IOTask &task) {
+    return (!readsOnly || !task.isWrite) && task.position < position + size &&
+           position < task.position + task.size;
+  };
+  return std::any_of(m_ioTasks.cbegin(), m_ioTasks.cend(), overlaps) ||
+         std::any_of(m_ioRunning.cbegin(), m_ioRunning.cend(), overlaps);
+}
+
+/** Make room for a block to be read ahead, forgetting the blocks read ahead
+ * the longest ago and not loaded yet. Blocks still being read are kept. Must be
+ * called under the background I/O lock.
+ * @param size :: number of events in the block
+ * @return true if the blocks read ahead now leave room for the block within
+ * the size of the write buffer
+ */
+bool DiskBuffer::makeRoomForPrefetch(const uint64_t size) const {
+  while (m_prefetchedSize + size > m_writeBufferSize && !m_prefetched.empty()) {
+    const auto oldest = std::min_element(
+        m_prefetched.cbegin(), m_prefetched.cend(),
+        [](const auto &a, const auto &b) {
+          return a.second.sequence < b.second.sequence;
+        });
+    m_prefetchedSize -= oldest->second.size;
+    m_prefetched.erase(oldest);
+  }
+  return m_prefetchedSize + size <= m_writeBufferSize;
+}
+
+/** Give work to the background thread, or do it now if there is no
+ * background thread. The work is done in the order it is given, so a read
+ * sees the writes given before it. Reads make room for themselves by
+ * forgetting the oldest blocks read ahead; they are dropped if the blocks
+ * still being read leave no room within the size of the write buffer, or if
+ * the events are being read already.
+ * @param position :: position of the first event the work touches
+ * @param size :: number of events the work touches
+ * @param isWrite :: true if the work writes the events, false if it reads
+ * them ahead, storing them with storePrefetched
+ * @param task :: the work
+ */
+void DiskBuffer::runInBackground(const uint64_t position, const uint64_t size,
+                                 const bool isWrite,
+                                 std::function<void()> task) const {
+  if (!this->hasBackgroundIO()) {
+    if (isWrite)
+      task();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_ioMutex);
+    if (!isWrite) {
+      if (m_prefetched.find(position) != m_prefetched.end() ||
+          isPending(position, size, true) || !makeRoomForPrefetch(size))
+        return;
+      m_prefetchedSize += size;
+    }
+    m_ioTasks.push_back({position, size, isWrite, std::move(task)});
+  }
+  m_ioChanged.notify_all();
+}
+
+/** Keep a block read ahead. Called by the work given to runInBackground.
+ * @param position :: position of the first event of the block
+ * @param size :: number of events in the block
+ * @param block :: the values of the events
+ */
+void DiskBuffer::storePrefetched(const uint64_t position, const uint64_t size,
+                                 std::vector<float> &&block) const {
+  std::lock_guard<std::mutex> lock(m_ioMutex);
+  m_prefetched[position] = {size, std::move(block), {}, m_prefetchSequence++};
+}
+
+/** Keep a block read ahead. Called by the work given to runInBackground.
+ * @param position :: position of the first event of the block
+ * @param size :: number of events in the block
+ * @param block :: the values of the events
+ */
+void DiskBuffer::storePrefetched(const uint64_t position, const uint64_t size,
+                                 std::vector<double> &&block) const {
+  std::lock_guard<std::mutex> lock(m_ioMutex);
+  m_prefetched[position] = {size, {}, std::move(block), m_prefetchSequence++};
+}
+
+/** Take a block read ahead, after waiting for the background work touching
+ * its events. Counts a hit if the block was found and a miss otherwise.
+ * @param block :: [out] the block, if found
+ * @param position :: position of the first event of the block
+ * @param size :: number of events in the block
+ * @return true if the block was read ahead
+ */
+bool DiskBuffer::takeBlock(PrefetchedBlock &block, const uint64_t position,
+                           const uint64_t size) const {
+  std::unique_lock<std::mutex> lock(m_ioMutex);
+  if (isPending(position, size)) {
+    const auto start = std::chrono::steady_clock::now();
+    m_ioChanged.wait(lock, [&] { return !isPending(position, size); });
+    m_ioStatistics.stallTime += std::chrono::duration<double>(
+                                    std::chrono::steady_clock::now() - start)
+                                    .count();
+  }
+  if (m_ioError) {
+    auto error = m_ioError;
+    m_ioError = nullptr;
+    std::rethrow_exception(error);
+  }
+  const auto found = m_prefetched.find(position);
+  if (found == m_prefetched.end() || found->second.size != size) {
+    ++m_ioStatistics.misses;
+    return false;
+  }
+  ++m_ioStatistics.hits;
+  m_prefetchedSize -= found->second.size;
+  block = std::move(found->second);
+  m_prefetched.erase(found);
+  return true;
+}
+
+/** Take a block read ahead, converting its values if they were read as
+ * double. Waits for the background work touching its events.
+ * @param block :: [out] the values of the events, if found
+ * @param position :: position of the first event of the block
+ * @param size :: number of events in the block
+ * @return true if the block was read ahead; if not, it has to be read
+ */
+bool DiskBuffer::takePrefetched(std::vector<float> &block,
+                                const uint64_t position,
+                                const uint64_t size) const {
+  PrefetchedBlock found;
+  if (!takeBlock(found, position, size))
+    return false;
+  if (found.doubles.empty())
+    block.swap(found.floats);
+  else
+    block.assign(found.doubles.cbegin(), found.doubles.cend());
+  return true;
+}
+
+/** Take a block read ahead, converting its values if they were read as
+ * float. Waits for the background work touching its events.
+ * @param block :: [out] the values of the events, if found
+ * @param position :: position of the first event of the block
+ * @param size :: number of events in the block
+ * @return true if the block was read ahead; if not, it has to be read
+ */
+bool DiskBuffer::takePrefetched(std::vector<double> &block,
+                                const uint64_t position,
+                                const uint64_t size) const {
+  PrefetchedBlock found;
+  if (!takeBlock(found, position, size))
+    return false;
+  if (found.floats.empty())
+    block.swap(found.doubles);
+  else
+    block.assign(found.floats.cbegin(), found.floats.cend());
+  return true;
+}
+
+/// @return the number of events in the blocks read ahead or being read
+uint64_t DiskBuffer::getPrefetchedSize() const {
+  std::lock_guard<std::mutex> lock(m_ioMutex);
+  return m_prefetchedSize;
+}
+
+/** Hint that the events of an object will soon be loaded, so that they are
+ * read ahead in the background. Does nothing without background I/O, or if
+ * the object is in memory. The object must not get new events before it is
+ * loaded.
+ * @param item :: the object that will be loaded
+ */
+void DiskBuffer::prefetch(const ISaveable *item) {
+  if (item == nullptr || !this->hasBackgroundIO() || !item->wasSaved() ||
+      item->isLoaded() || item->getFileSize() == 0)
+    return;
+  this->prefetchBlock(item->getFilePosition(), item->getFileSize());
+}
+
+/** Wait for all the background work to finish, and rethrow the first error it
+ * met, if any. */
+void DiskBuffer::waitForIO() const {
+  std::unique_lock<std::mutex> lock(m_ioMutex);
+  if (!m_ioTasks.empty() || !m_ioRunning.empty()) {
+    const auto start = std::chrono::steady_clock::now();
+    m_ioChanged.wait(
+        lock, [this] { return m_ioTasks.empty() && m_ioRunning.empty(); });
+    m_ioStatistics.stallTime += std::chrono::duration<double>(
+                                    std::chrono::steady_clock::now() - start)
+                                    .count();
+  }
+  if (m_ioError) {
+    auto error = m_ioError;
+    m_ioError = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+/** Count bytes read from the file
+ * @param bytes :: the number of bytes */
+void DiskBuffer::recordRead(const uint64_t bytes) const {
+  std::lock_guard<std::mutex> lock(m_ioMutex);
+  m_ioStatistics.bytesRead += bytes;
+}
+
+/** Count bytes written to the file
+ * @param bytes :: the number of bytes */
+void DiskBuffer::recordWrite(const uint64_t bytes) const {
+  std::lock_guard<std::mutex> lock(m_ioMutex);
+  m_ioStatistics.bytesWritten += bytes;
+}
+
+/// @return the counters of the reads and writes
+DiskBuffer::IOStatistics DiskBuffer::getIOStatistics() const {
+  std::lock_guard<std::mutex> lock(m_ioMutex);
+  return m_ioStatistics;
+}
+
+/// Set the counters of the reads and writes to zero
+void DiskBuffer::resetIOStatistics() {
+  std::lock_guard<std::mutex> lock(m_ioMutex);
+  m_ioStatistics = IOStatistics();
+}
+
+/// @return a string describing the counters of the reads and writes
+std::string DiskBuffer::getIOStatisticsStr() const {
+  const auto stats = this->getIOStatistics();
+  std::ostringstream mess;
+  mess << "Blocks loaded: " << stats.hits + stats.misses << " ("
+       << stats.hits << " read ahead). MB read: " << std::fixed
+       << std::setprecision(1) << static_cast<double>(stats.bytesRead) / 1e6
+       << ", written: " << static_cast<double>(stats.bytesWritten) / 1e6
+       << ". Waited " << std::setprecision(3) << stats.stallTime
+       << " s for background I/O.";
+  return mess.str();
+}
+
 /// @return a string describing the memory buffers, for debugging.
 std::string DiskBuffer::getMemoryStr() const {
   std::ostringstream mess;
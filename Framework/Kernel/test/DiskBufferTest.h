@@ -19,6 +19,9 @@
 #include <boost/multi_index_container.hpp>
 #include <cxxtest/TestSuite.h>
 
+#include <memory>
+#include <stdexcept>
+
 using namespace Mantid;
 using namespace Mantid::Kernel;
 using Mantid::Kernel::CPUTimer;
@@ -103,6 +106,59 @@ public:
 std::string SaveableTesterWithFile::fakeFile;
 std::mutex SaveableTesterWithFile::streamMutex;
 
+//====================================================================================
+/** A DiskBuffer reading and writing blocks of a fake file in the background,
+ * as the file formats deriving from DiskBuffer do */
+class DiskBufferWithBackgroundIO : public DiskBuffer {
+public:
+  DiskBufferWithBackgroundIO() : DiskBuffer(100) {}
+  ~DiskBufferWithBackgroundIO() override { setBackgroundIO(false); }
+
+  void saveBlock(const std::vector<float> &block, const uint64_t position) {
+    auto toWrite = std::make_shared<std::vector<float>>(block);
+    runInBackground(position, block.size(), true, [this, toWrite, position]() {
+      std::lock_guard<std::mutex> lock(m_fileMutex);
+      if (m_file.size() < position + toWrite->size())
+        m_file.resize(position + toWrite->size());
+      std::copy(toWrite->cbegin(), toWrite->cend(), m_file.begin() + position);
+      recordWrite(toWrite->size() * sizeof(float));
+    });
+  }
+
+  void loadBlock(std::vector<float> &block, const uint64_t position,
+                 const uint64_t size) {
+    if (!takePrefetched(block, position, size))
+      block = readBlock(position, size);
+  }
+
+  void failInBackground() {
+    runInBackground(0, 0, true,
+                    []() { throw std::runtime_error("Disk is full"); });
+  }
+
+  /// Number of blocks read ahead
+  size_t m_prefetches = 0;
+
+protected:
+  void prefetchBlock(const uint64_t position, const uint64_t size) override {
+    ++m_prefetches;
+    runInBackground(position, size, false, [this, position, size]() {
+      storePrefetched(position, size, readBlock(position, size));
+    });
+  }
+
+private:
+  std::vector<float> readBlock(const uint64_t position, const uint64_t size) {
+    std::lock_guard<std::mutex> lock(m_fileMutex);
+    recordRead(size * sizeof(float));
+    return std::vector<float>(m_file.cbegin() + position,
+                              m_file.cbegin() + position + size);
+  }
+
+  std::vector<float> m_file;
+  std::mutex m_fileMutex;
+};
+
 //====================================================================================
 class DiskBufferTest : public CxxTest::TestSuite {
 public:
@@ -673,6 +729,142 @@ public:
     delete blockD;
     // std::cout <<  ISaveableTesterWithFile::fakeFile << "!\n";
   }
+
+  //--------------------------------------------------------------------------------
+  /// Background reads and writes
+  void test_prefetch_does_nothing_without_background_io() {
+    DiskBufferWithBackgroundIO dbuf;
+    dbuf.saveBlock({1.f, 2.f, 3.f}, 0);
+    SaveableTesterWithFile block(0, 3, 'A');
+    block.clearDataFromMemory();
+    dbuf.prefetch(&block);
+    TS_ASSERT_EQUALS(dbuf.m_prefetches, 0);
+
+    std::vector<float> events;
+    dbuf.loadBlock(events, 0, 3);
+    TS_ASSERT_EQUALS(events, std::vector<float>({1.f, 2.f, 3.f}));
+    const auto statistics = dbuf.getIOStatistics();
+    TS_ASSERT_EQUALS(statistics.hits, 0);
+    TS_ASSERT_EQUALS(statistics.misses, 1);
+    TS_ASSERT_EQUALS(statistics.bytesRead, 3 * sizeof(float));
+    TS_ASSERT_EQUALS(statistics.bytesWritten, 3 * sizeof(float));
+  }
+
+  void test_prefetched_blocks_are_loaded_from_memory() {
+    DiskBufferWithBackgroundIO dbuf;
+    dbuf.setBackgroundIO(true);
+    TS_ASSERT(dbuf.hasBackgroundIO());
+    dbuf.saveBlock({1.f, 2.f, 3.f, 4.f, 5.f}, 0);
+
+    SaveableTesterWithFile first(0, 2, 'A');
+    SaveableTesterWithFile second(2, 3, 'B');
+    // Blocks in memory or never saved are not read ahead
+    dbuf.prefetch(&first);
+    second.clearDataFromMemory();
+    second.setSaved(false);
+    dbuf.prefetch(&second);
+    TS_ASSERT_EQUALS(dbuf.m_prefetches, 0);
+
+    first.clearDataFromMemory();
+    second.setSaved(true);
+    dbuf.prefetch(&second);
+    TS_ASSERT_EQUALS(dbuf.m_prefetches, 1);
+    dbuf.waitForIO();
+
+    std::vector<float> events;
+    dbuf.loadBlock(events, 2, 3);
+    TS_ASSERT_EQUALS(events, std::vector<float>({3.f, 4.f, 5.f}));
+    dbuf.loadBlock(events, 0, 2);
+    TS_ASSERT_EQUALS(events, std::vector<float>({1.f, 2.f}));
+    // A block read ahead is used only once
+    dbuf.loadBlock(events, 2, 3);
+    auto statistics = dbuf.getIOStatistics();
+    TS_ASSERT_EQUALS(statistics.hits, 1);
+    TS_ASSERT_EQUALS(statistics.misses, 2);
+    TS_ASSERT_EQUALS(statistics.bytesRead, 8 * sizeof(float));
+
+    dbuf.resetIOStatistics();
+    statistics = dbuf.getIOStatistics();
+    TS_ASSERT_EQUALS(statistics.hits, 0);
+    TS_ASSERT_EQUALS(statistics.bytesRead, 0);
+    dbuf.setBackgroundIO(false);
+    TS_ASSERT(!dbuf.hasBackgroundIO());
+  }
+
+  void test_blocks_read_ahead_and_never_loaded_are_forgotten() {
+    // Room for 100 events read ahead
+    DiskBufferWithBackgroundIO dbuf;
+    dbuf.setBackgroundIO(true);
+    for (uint64_t position = 0; position < 300; position += 10)
+      dbuf.saveBlock(std::vector<float>(10, static_cast<float>(position)),
+                     position);
+
+    // Read ahead all the blocks but load none of them
+    std::vector<std::unique_ptr<SaveableTesterWithFile>> blocks;
+    for (uint64_t position = 0; position < 300; position += 10) {
+      blocks.emplace_back(
+          std::make_unique<SaveableTesterWithFile>(position, 10, 'A'));
+      blocks.back()->clearDataFromMemory();
+      dbuf.prefetch(blocks.back().get());
+      dbuf.waitForIO();
+      TS_ASSERT_LESS_THAN_EQUALS(dbuf.getPrefetchedSize(),
+                                 dbuf.getWriteBufferSize());
+    }
+    TS_ASSERT_EQUALS(dbuf.m_prefetches, 30);
+
+    // The oldest blocks made room for the newest ones
+    std::vector<float> events;
+    dbuf.loadBlock(events, 290, 10);
+    TS_ASSERT_EQUALS(events, std::vector<float>(10, 290.f));
+    TS_ASSERT_EQUALS(dbuf.getIOStatistics().hits, 1);
+    dbuf.loadBlock(events, 0, 10);
+    TS_ASSERT_EQUALS(events, std::vector<float>(10, 0.f));
+    TS_ASSERT_EQUALS(dbuf.getIOStatistics().misses, 1);
+    TS_ASSERT_EQUALS(dbuf.getPrefetchedSize(), 90);
+  }
+
+  void test_loads_see_the_writes_done_in_the_background() {
+    DiskBufferWithBackgroundIO dbuf;
+    dbuf.setBackgroundIO(true);
+    SaveableTesterWithFile block(0, 4, 'A');
+    block.clearDataFromMemory();
+    std::vector<float> events;
+    for (float value = 0.f; value < 50.f; value += 1.f) {
+      dbuf.saveBlock(std::vector<float>(4, value), 0);
+      // A block read ahead before a write to it is not used
+      dbuf.prefetch(&block);
+      dbuf.saveBlock(std::vector<float>(4, value + 0.5f), 0);
+      dbuf.loadBlock(events, 0, 4);
+      TS_ASSERT_EQUALS(events, std::vector<float>(4, value + 0.5f));
+    }
+    TS_ASSERT_EQUALS(dbuf.getIOStatistics().hits, 0);
+  }
+
+  void test_background_errors_are_rethrown() {
+    DiskBufferWithBackgroundIO dbuf;
+    dbuf.setBackgroundIO(true);
+    dbuf.failInBackground();
+    TS_ASSERT_THROWS(dbuf.waitForIO(), const std::runtime_error &);
+    // Only once
+    TS_ASSERT_THROWS_NOTHING(dbuf.waitForIO());
+  }
+
+  void test_flushCache_waits_for_the_writes_done_in_the_background() {
+    DiskBufferWithBackgroundIO dbuf;
+    dbuf.setBackgroundIO(true);
+    for (uint64_t position = 0; position < 400; position += 4)
+      dbuf.saveBlock(std::vector<float>(4, 1.f), position);
+    dbuf.flushCache();
+    TS_ASSERT_EQUALS(dbuf.getIOStatistics().bytesWritten,
+                     400 * sizeof(float));
+  }
+
+  void test_flushCache_rethrows_background_errors() {
+    DiskBufferWithBackgroundIO dbuf;
+    dbuf.setBackgroundIO(true);
+    dbuf.failInBackground();
+    TS_ASSERT_THROWS(dbuf.flushCache(), const std::runtime_error &);
+  }
 };
 //====================================================================================
 // THIS TEST DOES NOT PROBABLY EXIST IN A WHILD ANY MORE; LEFT JUST IN CASE
@@ -9,6 +9,7 @@
 #include "MantidAPI/DataProcessorAlgorithm.h"
 #include "MantidAPI/IMDEventWorkspace.h"
 #include "MantidAPI/WorkspaceHistory.h"
+#include "MantidDataObjects/MDEventWorkspace.h"
 #include "MantidKernel/System.h"
 #include "MantidMDAlgorithms/DllConfig.h"
 #include <set>
@@ -89,6 +90,23 @@ private:
       const std::string &filename, const bool filebackend);
 
   std::map<std::string, std::string> validateInputs() override;
+
+  /// Add the events of a workspace to the input workspace, if it can hold them
+  Mantid::API::IMDEventWorkspace_sptr
+  appendToWorkspace(const Mantid::API::IMDEventWorkspace_sptr &input_ws,
+                    const Mantid::API::IMDEventWorkspace_sptr &new_ws);
+
+  template <typename MDE, size_t nd>
+  void appendEvents(
+      typename Mantid::DataObjects::MDEventWorkspace<MDE, nd>::sptr ws);
+
+  /// Number of events copied from the new data before appending them
+  static constexpr size_t APPEND_BATCH_EVENTS = 10000000;
+
+  /// Workspace whose events are being appended
+  Mantid::API::IMDEventWorkspace_sptr m_appendSource;
+  /// Offset added to the run index of the appended events
+  uint16_t m_runIndexOffset = 0;
 };
 
 } // namespace MDAlgorithms
@@ -19,6 +19,8 @@
 #include "MantidKernel/VMD.h"
 #include "MantidMDAlgorithms/SlicingAlgorithm.h"
 
+#include <mutex>
+
 namespace Mantid {
 namespace Geometry {
 // Forward declaration
@@ -63,14 +65,77 @@ private:
   /// Run the algorithm
   void exec() override;
 
+  /// Contribution of an event or a box to one bin of the output
+  struct BinContribution {
+    size_t index;
+    signal_t signal;
+    signal_t errorSquared;
+    signal_t numEvents;
+  };
+  /// The sums of one thread when binning in parallel, on its own cache lines
+  struct alignas(64) ThreadBins {
+    /// Private copies of the output arrays, if they are small enough
+    std::vector<signal_t> signals;
+    std::vector<signal_t> errors;
+    std::vector<signal_t> numEvents;
+    /// Otherwise, the buffered contributions to every slab of the output
+    std::vector<std::vector<BinContribution>> buffers;
+  };
+
   /// Helper method
   template <typename MDE, size_t nd>
   void binByIterating(typename DataObjects::MDEventWorkspace<MDE, nd>::sptr ws);
 
   /// Method to bin a single MDBox
   template <typename MDE, size_t nd>
-  void binMDBox(DataObjects::MDBox<MDE, nd> *box, const size_t *const chunkMin,
-                const size_t *const chunkMax);
+  void binMDBox(DataObjects::MDBox<MDE, nd> *box, ThreadBins *bins);
+  /// Whether all of an MDBox falls in one bin, so its events are not loaded
+  template <typename MDE, size_t nd>
+  bool isInOneBin(DataObjects::MDBox<MDE, nd> *box, size_t &linearIndex) const;
+
+  std::vector<API::IMDNode *>
+  getBoxesToBin(API::IMDNode *root, Geometry::MDImplicitFunction *function,
+                const bool doParallel) const;
+  void prepareBlockTransform();
+  void transformBlock(const coord_t *in, const size_t inD, const size_t count,
+                      coord_t *out) const;
+  void prepareThreadBins(const size_t numThreads);
+  /** Add a contribution to a bin
+   * @param bins :: the sums of the calling thread, or nullptr to add to the
+   * output directly
+   * @param contribution :: the contribution
+   */
+  void addToBin(ThreadBins *bins, const BinContribution &contribution) {
+    const size_t index = contribution.index;
+    if (!bins) {
+      signals[index] += contribution.signal;
+      errors[index] += contribution.errorSquared;
+      numEvents[index] += contribution.numEvents;
+    } else if (m_privateBins) {
+      bins->signals[index] += contribution.signal;
+      bins->errors[index] += contribution.errorSquared;
+      bins->numEvents[index] += contribution.numEvents;
+    } else {
+      const size_t slab = index >> m_slabShift;
+      auto &buffer = bins->buffers[slab];
+      buffer.emplace_back(contribution);
+      if (buffer.size() == SLAB_BUFFER_SIZE)
+        flushSlab(slab, buffer);
+    }
+  }
+  void flushSlab(const size_t slab, std::vector<BinContribution> &buffer);
+  void mergeThreadBins();
+
+  /// Largest number of bins in the private copies of all threads
+  static constexpr size_t PRIVATE_BINS_LIMIT = 1 << 24;
+  /// Largest number of slabs the output is cut into otherwise
+  static constexpr size_t MAX_SLABS = 128;
+  /// Number of contributions to a slab a thread buffers
+  static constexpr size_t SLAB_BUFFER_SIZE = 512;
+  /// Number of events transformed together
+  static constexpr size_t BLOCK_SIZE = 256;
+  /// Number of boxes of a file-backed workspace read ahead of the binning
+  static constexpr int64_t PREFETCH_DISTANCE = 8;
 
   /// The output MDHistoWorkspace
   Mantid::DataObjects::MDHistoWorkspace_sptr outWS;
@@ -81,10 +146,28 @@ private:
 
   /// Cached values for speed up
   std::vector<size_t> indexMultiplier;
+  std::vector<size_t> numBins;
   signal_t *signals;
   signal_t *errors;
   signal_t *numEvents;
   bool m_accumulate{false};
+
+  /// Input dimension of each output dimension, for an axis-aligned transform
+  std::vector<size_t> m_alignedDimensions;
+  /// Origin and scaling of each output dimension, for an axis-aligned transform
+  std::vector<coord_t> m_alignedOrigin;
+  std::vector<coord_t> m_alignedScaling;
+  /// Rows of the matrix of an affine transform
+  std::vector<std::vector<coord_t>> m_affineRows;
+
+  /// Sums of every thread when binning in parallel
+  std::vector<ThreadBins> m_threadBins;
+  /// Whether the threads sum into private copies of the output
+  bool m_privateBins{false};
+  /// log2 of the number of bins in a slab
+  size_t m_slabShift{0};
+  /// One lock per slab of the output
+  std::vector<std::mutex> m_slabLocks;
 };
 
 } // namespace MDAlgorithms
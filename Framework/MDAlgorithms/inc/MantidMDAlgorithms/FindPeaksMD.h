@@ -17,12 +17,49 @@
 #include "MantidKernel/System.h"
 #include "MantidKernel/V3D.h"
 
+#include <unordered_map>
+#include <vector>
+
 namespace Mantid {
 namespace Geometry {
 class InstrumentRayTracer;
 }
 namespace MDAlgorithms {
 
+/** PeakCentreGrid : the centres of the peaks found so far, hashed on a grid
+ * of cubic cells as wide as the peak distance threshold in the first three
+ * dimensions. A candidate can only be closer than the threshold to the peaks
+ * in its cell and the 26 cells around it.
+ */
+class DLLExport PeakCentreGrid {
+public:
+  PeakCentreGrid(const size_t nd, const coord_t radiusSquared);
+  bool hasNeighbour(const coord_t *centre) const;
+  void add(const coord_t *centre);
+
+private:
+  struct Cell {
+    int64_t x, y, z;
+    bool operator==(const Cell &other) const {
+      return x == other.x && y == other.y && z == other.z;
+    }
+  };
+  struct CellHash {
+    size_t operator()(const Cell &cell) const;
+  };
+
+  bool cellOf(const coord_t *centre, Cell &cell) const;
+  coord_t distanceSquared(const size_t peak, const coord_t *centre) const;
+
+  const size_t m_nd;
+  const coord_t m_radiusSquared;
+  const double m_cellSize;
+  /// The centres of the peaks, one after the other
+  std::vector<coord_t> m_centres;
+  /// Indices of the peaks in each cell holding any
+  std::unordered_map<Cell, std::vector<size_t>, CellHash> m_cells;
+};
+
 /** FindPeaksMD : TODO: DESCRIPTION
  *
  * @author
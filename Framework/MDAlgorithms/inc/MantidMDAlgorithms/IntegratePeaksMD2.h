@@ -47,6 +47,9 @@ public:
   }
 
 private:
+  /// Number of peaks close to each other integrated in turn by one thread
+  static constexpr int PEAK_BATCH = 16;
+
   /// Initialise the properties
   void init() override;
   /// Run the algorithm
@@ -83,10 +86,8 @@ private:
   std::vector<Kernel::V3D> E1Vec;
 
   /// Check if peaks overlap
-  void checkOverlap(int i,
-                    const Mantid::DataObjects::PeaksWorkspace_sptr &peakWS,
-                    Mantid::Kernel::SpecialCoordinateSystem CoordinatesToUse,
-                    double radius);
+  void checkOverlap(int i, const std::vector<Mantid::Kernel::V3D> &positions,
+                    const std::vector<int> &xOrder, double radius);
 };
 
 } // namespace MDAlgorithms
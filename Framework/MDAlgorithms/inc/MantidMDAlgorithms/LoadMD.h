@@ -59,6 +59,10 @@ private:
   template <typename MDE, size_t nd>
   void doLoad(typename DataObjects::MDEventWorkspace<MDE, nd>::sptr ws);
 
+  /// Make the object reading the events of the boxes from the file
+  std::shared_ptr<API::IBoxControllerIO>
+  createEventLoader(API::BoxController *bc) const;
+
   void
   loadExperimentInfos(std::shared_ptr<Mantid::API::MultipleExperimentInfos> ws);
 
@@ -116,6 +120,9 @@ private:
   /// Version of SaveMD used to save the file
   int m_saveMDVersion;
 
+  /// whether the events are stored compressed
+  bool m_compressedEvents;
+
   /// Visual normalization
   boost::optional<Mantid::API::MDNormalization> m_visualNormalization;
   boost::optional<Mantid::API::MDNormalization> m_visualNormalizationHisto;
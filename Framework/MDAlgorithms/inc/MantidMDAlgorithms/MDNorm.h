@@ -12,6 +12,9 @@
 #include "MantidMDAlgorithms/SlicingAlgorithm.h"
 
 namespace Mantid {
+namespace Geometry {
+class DetectorInfo;
+}
 namespace MDAlgorithms {
 
 /** MDNormalization : Bin single crystal diffraction or direct geometry
@@ -46,9 +49,15 @@ private:
   getValuesFromOtherDimensions(bool &skipNormalization,
                                uint16_t expInfoIndex = 0) const;
   void cacheDimensionXValues();
+  void cacheDetectorValues(uint16_t expInfoIndex);
+  std::string normalizationSetupKey() const;
+  std::string
+  normalizationRunKey(uint16_t expInfoIndex,
+                      const std::vector<coord_t> &otherValues) const;
   void calculateNormalization(const std::vector<coord_t> &otherValues,
                               const Geometry::SymmetryOperation &so,
-                              uint16_t expInfoIndex, size_t soIndex);
+                              uint16_t expInfoIndex, size_t soIndex,
+                              std::vector<signal_t> &normalization);
   void calculateIntersections(std::vector<std::array<double, 4>> &intersections,
                               const double theta, const double phi,
                               const Kernel::DblMatrix &transform,
@@ -85,8 +94,6 @@ private:
   double m_Ei;
   /// Flag indicating if the input workspace is from diffraction
   bool m_diffraction;
-  /// Flag to accumulate normalization
-  bool m_accumulate;
   /// Flag to indicate that the energy dimension is integrated
   bool m_dEIntegrated;
   /// Sample position
@@ -95,6 +102,24 @@ private:
   Kernel::V3D m_beamDir;
   /// ki-kf for Inelastic convention; kf-ki for Crystallography convention
   std::string convention;
+
+  /// Values of a detector that do not depend on the goniometer or symmetry
+  struct DetectorValues {
+    /// Polar angle
+    double theta;
+    /// Azimuthal angle
+    double phi;
+    /// Solid angle, or 1 without a solid angle workspace
+    double solidAngle;
+    /// Workspace index in the flux workspace
+    size_t fluxIndex;
+    /// False for monitors, masked detectors and detectors without flux
+    bool used;
+  };
+  /// Values of every spectrum of the current experiment info
+  std::vector<DetectorValues> m_detectorValues;
+  /// Detectors m_detectorValues were computed for
+  const Geometry::DetectorInfo *m_detectorValuesSource;
 };
 
 } // namespace MDAlgorithms
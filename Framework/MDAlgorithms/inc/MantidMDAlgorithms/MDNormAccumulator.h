@@ -0,0 +1,115 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidGeometry/MDGeometry/MDTypes.h"
+#include "MantidKernel/MultiThreaded.h"
+#include "MantidMDAlgorithms/DllConfig.h"
+
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Mantid {
+namespace MDAlgorithms {
+
+/** MDNormAccumulator : sums the contributions of many threads into the signal
+  array of a normalization workspace, as done by MDNorm, MDNormSCD and
+  MDNormDirectSC for the segments of every detector trajectory.
+
+  Adding every contribution to a shared array with an atomic compare-and-swap
+  makes the threads fight over cache lines, so the contributions are summed in
+  one of two ways depending on the size of the array:
+  - PerThread: each thread sums into its own copy of the array and the copies
+    are added together at the end. Used when all the copies fit in
+    PER_THREAD_LIMIT elements.
+  - Tiled: the shared array is cut into at most MAX_TILES tiles, each with
+    its own lock. Each thread buffers its contributions to every tile and
+    adds them in one go, under the lock of the tile, when the buffer is full.
+    Used for large arrays.
+  The atomic summation is kept as the Atomic strategy for comparison.
+*/
+class MANTID_MDALGORITHMS_DLL MDNormAccumulator {
+public:
+  enum class Strategy { Automatic, Atomic, PerThread, Tiled };
+
+  /// Largest number of elements summed over the copies of all threads
+  static constexpr size_t PER_THREAD_LIMIT = 1 << 24;
+  /// Largest number of tiles with the Tiled strategy
+  static constexpr size_t MAX_TILES = 128;
+  /// Number of contributions to a tile a thread buffers
+  static constexpr size_t BUFFER_SIZE = 512;
+
+  MDNormAccumulator(const size_t size, const int numThreads,
+                    const Strategy strategy = Strategy::Automatic);
+
+  static Strategy chooseStrategy(const size_t size, const int numThreads);
+
+  /// The strategy in use
+  Strategy strategy() const { return m_strategy; }
+
+  /** Add a contribution to one element
+   * @param thread :: the number of the calling thread, below the numThreads
+   * given to the constructor
+   * @param index :: the index of the element
+   * @param value :: the contribution
+   */
+  void add(const int thread, const size_t index, const signal_t value) {
+    switch (m_strategy) {
+    case Strategy::PerThread: {
+      auto &sums = m_perThread[thread].sums;
+      if (sums.empty())
+        sums.resize(m_size, 0.);
+      sums[index] += value;
+      break;
+    }
+    case Strategy::Tiled: {
+      const size_t tile = index >> m_tileShift;
+      auto &buffer = m_perThread[thread].buffers[tile];
+      buffer.emplace_back(index, value);
+      if (buffer.size() == BUFFER_SIZE)
+        flush(tile, buffer);
+      break;
+    }
+    default:
+      Kernel::AtomicOp(m_atomic[index], value, std::plus<signal_t>());
+    }
+  }
+
+  void addTo(signal_t *output);
+
+private:
+  using Buffer = std::vector<std::pair<size_t, signal_t>>;
+  /// The storage of one thread, on its own cache lines
+  struct alignas(64) ThreadStorage {
+    /// Copy of the array for the PerThread strategy
+    std::vector<signal_t> sums;
+    /// Buffered contributions to every tile for the Tiled strategy
+    std::vector<Buffer> buffers;
+  };
+
+  void flush(const size_t tile, Buffer &buffer);
+
+  /// Number of elements
+  const size_t m_size;
+  /// The strategy in use
+  const Strategy m_strategy;
+  /// Storage of every thread
+  std::vector<ThreadStorage> m_perThread;
+  /// Sums for the Atomic strategy
+  std::vector<std::atomic<signal_t>> m_atomic;
+  /// Sums for the Tiled strategy
+  std::vector<signal_t> m_tiled;
+  /// log2 of the number of elements in a tile
+  size_t m_tileShift;
+  /// One lock per tile of m_tiled
+  std::vector<std::mutex> m_tileLocks;
+};
+
+} // namespace MDAlgorithms
+} // namespace Mantid
@@ -0,0 +1,70 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidGeometry/MDGeometry/MDTypes.h"
+#include "MantidMDAlgorithms/DllConfig.h"
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Mantid {
+namespace MDAlgorithms {
+
+/** MDNormCache : keeps the normalization computed by MDNorm, so that calling
+  it again on a workspace that has grown by a few runs only normalizes the new
+  runs.
+
+  An entry is found from a setup key, which describes everything the
+  normalization depends on apart from the runs: the binning, the projections,
+  the UB matrix, the symmetry operations and the solid angle and flux
+  workspaces. It holds the keys of the runs that were normalized, made from
+  their goniometer, trajectory extents, proton charge, values of the other
+  dimensions and detector positions and masks, and the sum of their
+  normalizations. It can be used when all these runs are among the runs of
+  the input. A few entries are kept, the least recently used being dropped
+  first.
+*/
+class MANTID_MDALGORITHMS_DLL MDNormCache {
+public:
+  /// Default number of entries kept
+  static constexpr size_t DEFAULT_MAX_ENTRIES = 4;
+
+  explicit MDNormCache(const size_t maxEntries = DEFAULT_MAX_ENTRIES);
+
+  static MDNormCache &instance();
+
+  bool lookup(const std::string &setup, const std::vector<std::string> &runs,
+              std::vector<signal_t> &normalization,
+              std::vector<bool> &cached);
+  void store(const std::string &setup, std::vector<std::string> runs,
+             std::vector<signal_t> normalization);
+  void clear();
+  size_t size() const;
+
+private:
+  struct Entry {
+    /// Key of everything but the runs
+    std::string setup;
+    /// Keys of the runs summed in the normalization
+    std::vector<std::string> runs;
+    /// Sum of the normalizations of the runs
+    std::vector<signal_t> normalization;
+  };
+
+  /// Largest number of entries
+  const size_t m_maxEntries;
+  /// The entries, most recently used first
+  std::list<Entry> m_entries;
+  /// Lock for the entries
+  mutable std::mutex m_mutex;
+};
+
+} // namespace MDAlgorithms
+} // namespace Mantid
@@ -33,6 +33,9 @@ public:
   const std::string category() const override;
 
 private:
+  /// Number of events copied from an input before adding them to the output
+  static constexpr uint64_t MERGE_BATCH_EVENTS = 10000000;
+
   void init() override;
   void exec() override;
   void createOutputWorkspace(std::vector<std::string> &inputs);
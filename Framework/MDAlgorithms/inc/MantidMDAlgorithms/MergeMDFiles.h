@@ -47,6 +47,9 @@ public:
   }
 
 private:
+  /// Number of events loaded in parallel before saving them to the output
+  static constexpr uint64_t MERGE_BATCH_EVENTS = 10000000;
+
   /// Initialise the properties
   void init() override;
   /// Run the algorithm
@@ -65,6 +68,8 @@ private:
   DataObjects::MDBoxFlatTree m_BoxStruct;
   // the vector of box structures for contributing files components
   std::vector<DataObjects::MDBoxFlatTree> m_fileComponentsStructure;
+  // the boxes holding events, in the order they are merged in
+  std::vector<API::IMDNode *> m_mergeOrder;
 
 protected:
   /// Set to true if the output is cloned of the first one
@@ -93,7 +98,7 @@ protected:
   /// # of events loaded from all tasks
   uint64_t m_totalLoaded;
 
-  /// Mutex for file access
+  /// Mutex for reading any of the input files
   std::mutex m_fileMutex;
 
   /// Mutex for modifying stats
@@ -10,6 +10,7 @@
 #include "MantidAPI/FileProperty.h"
 #include "MantidAPI/FrameworkManager.h"
 #include "MantidAPI/HistoryView.h"
+#include "MantidDataObjects/MDEventFactory.h"
 #include "MantidDataObjects/MDHistoWorkspaceIterator.h"
 #include "MantidKernel/ArrayBoundedValidator.h"
 #include "MantidKernel/ArrayProperty.h"
@@ -28,6 +29,17 @@ using namespace Mantid::Kernel;
 using namespace Mantid::API;
 using namespace Mantid::DataObjects;
 
+namespace {
+/// Add an offset to the run index of an event; MDLeanEvents have none
+template <size_t nd>
+void offsetRunIndex(MDLeanEvent<nd> & /*event*/, const uint16_t /*offset*/) {}
+
+template <size_t nd>
+void offsetRunIndex(MDEvent<nd> &event, const uint16_t offset) {
+  event.setRunIndex(static_cast<uint16_t>(event.getRunIndex() + offset));
+}
+} // namespace
+
 namespace Mantid {
 namespace MDAlgorithms {
 
@@ -388,12 +400,22 @@ void AccumulateMD::exec() {
 
   // If we reach here then new data exists to append to the input workspace
   // Use CreateMD with the new data to make a temp workspace
-  // Merge the temp workspace with the input workspace using MergeMD
   IMDEventWorkspace_sptr tmp_ws =
       createMDWorkspace(input_data, psi, gl, gs, efix, "", false);
   this->interruption_point();
   this->progress(0.5); // Report as CreateMD is complete
 
+  // Add the events of the temp workspace to the box structure of the input
+  // workspace if it can hold them
+  IMDEventWorkspace_sptr out_ws = appendToWorkspace(input_ws, tmp_ws);
+  if (out_ws) {
+    this->setProperty("OutputWorkspace", out_ws);
+    g_log.notice() << this->name() << " successfully appended data\n";
+    this->progress(1.0);
+    return; // POSSIBLE EXIT POINT
+  }
+
+  // Otherwise merge the temp workspace with the input workspace using MergeMD
   const std::string temp_ws_name = "TEMP_WORKSPACE_ACCUMULATEMD";
   // Currently have to use ADS here as list of workspaces can only be passed as
   // a list of workspace names as a string
@@ -406,8 +428,7 @@ void AccumulateMD::exec() {
   merge_alg->setProperty("InputWorkspaces", ws_names_to_merge);
   merge_alg->executeAsChildAlg();
 
-  API::IMDEventWorkspace_sptr out_ws =
-      merge_alg->getProperty("OutputWorkspace");
+  out_ws = merge_alg->getProperty("OutputWorkspace");
 
   this->setProperty("OutputWorkspace", out_ws);
   g_log.notice() << this->name() << " successfully appended data\n";
@@ -418,6 +439,93 @@ void AccumulateMD::exec() {
   AnalysisDataService::Instance().remove(temp_ws_name);
 }
 
+/*
+ * Add the events and experiment infos of a workspace to the input workspace,
+ * keeping the box structure of the input workspace, so that the time taken
+ * grows with the size of the new data only. The input workspace is changed
+ * in place if it is also the output workspace, and cloned otherwise.
+ * @param input_ws :: the workspace to add the events to
+ * @param new_ws :: the workspace holding the new events
+ * @returns the workspace with all the events, or nullptr if the input
+ * workspace cannot hold the new events and both must be merged by MergeMD
+ */
+IMDEventWorkspace_sptr
+AccumulateMD::appendToWorkspace(const IMDEventWorkspace_sptr &input_ws,
+                                const IMDEventWorkspace_sptr &new_ws) {
+  if (new_ws->getEventTypeName() != input_ws->getEventTypeName() ||
+      new_ws->getNumDims() != input_ws->getNumDims())
+    return nullptr;
+  // The new events must lie within the extents of the input workspace
+  for (size_t d = 0; d < input_ws->getNumDims(); ++d) {
+    const auto dim = input_ws->getDimension(d);
+    const auto new_dim = new_ws->getDimension(d);
+    if (new_dim->getName() != dim->getName() ||
+        new_dim->getMinimum() < dim->getMinimum() ||
+        new_dim->getMaximum() > dim->getMaximum())
+      return nullptr;
+  }
+  const size_t n_experiments =
+      input_ws->getNumExperimentInfo() + new_ws->getNumExperimentInfo();
+  if (n_experiments > std::numeric_limits<uint16_t>::max())
+    return nullptr;
+
+  IMDEventWorkspace_sptr out_ws = input_ws;
+  if (getPropertyValue("InputWorkspace") !=
+      getPropertyValue("OutputWorkspace")) {
+    if (input_ws->isFileBacked())
+      return nullptr;
+    out_ws = input_ws->clone();
+  }
+
+  m_runIndexOffset = out_ws->getNumExperimentInfo();
+  for (uint16_t i = 0; i < new_ws->getNumExperimentInfo(); ++i)
+    out_ws->addExperimentInfo(ExperimentInfo_sptr(
+        new_ws->getExperimentInfo(i)->cloneExperimentInfo()));
+
+  m_appendSource = new_ws;
+  CALL_MDEVENT_FUNCTION(appendEvents, out_ws);
+  m_appendSource.reset();
+  return out_ws;
+}
+
+/*
+ * Append the events of m_appendSource to a workspace, in batches of at most
+ * APPEND_BATCH_EVENTS events
+ * @param ws :: the workspace to add the events to
+ */
+template <typename MDE, size_t nd>
+void AccumulateMD::appendEvents(typename MDEventWorkspace<MDE, nd>::sptr ws) {
+  auto source =
+      std::dynamic_pointer_cast<MDEventWorkspace<MDE, nd>>(m_appendSource);
+  if (!ws || !source)
+    throw std::runtime_error(
+        "Incompatible workspace types passed to AccumulateMD.");
+
+  std::vector<API::IMDNode *> boxes;
+  source->getBox()->getBoxes(boxes, 1000, true);
+
+  std::vector<MDE> events;
+  size_t numBad = 0;
+  for (auto node : boxes) {
+    auto *box = dynamic_cast<MDBox<MDE, nd> *>(node);
+    if (!box || box->getIsMasked())
+      continue;
+    for (const auto &event : box->getConstEvents()) {
+      events.emplace_back(event);
+      offsetRunIndex(events.back(), m_runIndexOffset);
+    }
+    box->releaseEvents();
+    if (events.size() >= APPEND_BATCH_EVENTS) {
+      numBad += ws->appendEvents(events);
+      events.clear();
+    }
+  }
+  numBad += ws->appendEvents(events);
+  if (numBad > 0)
+    g_log.warning() << numBad
+                    << " events were outside the workspace and not added.\n";
+}
+
 /*
  * Use the CreateMD algorithm to create an MD workspace
  * @param data_sources :: Vector of input data sources
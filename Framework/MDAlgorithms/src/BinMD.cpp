@@ -23,9 +23,16 @@
 #include "MantidKernel/Utils.h"
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
+
 namespace Mantid {
 namespace MDAlgorithms {
 
+namespace {
+/// Number of bins summed by one thread when merging the private copies
+constexpr int64_t MERGE_BLOCK_SIZE = 1 << 14;
+} // namespace
+
 // Register the algorithm into the AlgorithmFactory
 DECLARE_ALGORITHM(BinMD)
 
@@ -71,9 +78,10 @@ void BinMD::init() {
   setPropertyGroup("IterateEvents", grp);
 
   declareProperty(
-      std::make_unique<PropertyWithValue<bool>>("Parallel", false,
+      std::make_unique<PropertyWithValue<bool>>("Parallel", true,
                                                 Direction::Input),
-      "Temporary parameter: true to run in parallel. This is ignored for "
+      "True to run in parallel: the threads share out the boxes of the "
+      "input and sum into their own bins. This is ignored for "
       "file-backed workspaces, where running in parallel makes things slower "
       "due to disk thrashing.");
   setPropertyGroup("Parallel", grp);
@@ -91,136 +99,338 @@ void BinMD::init() {
 }
 
 //----------------------------------------------------------------------------------------------
-/** Bin the contents of a MDBox
+/** Evaluate whether the entire box is in the same bin, in which case its
+ * cached signal is used and its events are not looked at
  *
  * @param box :: pointer to the MDBox to bin
- * @param chunkMin :: the minimum index in each dimension to consider "valid"
- *(inclusive)
- * @param chunkMax :: the maximum index in each dimension to consider "valid"
- *(exclusive)
+ * @param linearIndex :: [out] the index of the bin, if the box is in one bin
+ * @return true if all the vertexes of the box are in the same bin
  */
 template <typename MDE, size_t nd>
-inline void BinMD::binMDBox(MDBox<MDE, nd> *box, const size_t *const chunkMin,
-                            const size_t *const chunkMax) {
+bool BinMD::isInOneBin(MDBox<MDE, nd> *box, size_t &linearIndex) const {
+  // There is a check that the number of events is enough for it to make sense
+  // to do all this processing.
+  if (box->getNPoints() <= (1 << nd) * 2)
+    return false;
+
   // An array to hold the rotated/transformed coordinates
   auto outCenter = std::vector<coord_t>(m_outD);
+  size_t numVertexes = 0;
+  auto vertexes = box->getVertexesArray(numVertexes);
 
-  // Evaluate whether the entire box is in the same bin
-  if (box->getNPoints() > (1 << nd) * 2) {
-    // There is a check that the number of events is enough for it to make sense
-    // to do all this processing.
-    size_t numVertexes = 0;
-    auto vertexes = box->getVertexesArray(numVertexes);
-
-    // All vertexes have to be within THE SAME BIN = have the same linear index.
-    size_t lastLinearIndex = 0;
-    bool badOne = false;
-
-    for (size_t i = 0; i < numVertexes; i++) {
-      // Cache the center of the event (again for speed)
-      const coord_t *inCenter = vertexes.get() + i * nd;
-
-      // Now transform to the output dimensions
-      m_transform->apply(inCenter, outCenter.data());
-
-      // To build up the linear index
-      size_t linearIndex = 0;
-      // To mark VERTEXES outside range
-      badOne = false;
-
-      /// Loop through the dimensions on which we bin
-      for (size_t bd = 0; bd < m_outD; bd++) {
-        // What is the bin index in that dimension
-        coord_t x = outCenter[bd];
-        auto ix = size_t(x);
-        // Within range (for this chunk)?
-        if ((x >= 0) && (ix >= chunkMin[bd]) && (ix < chunkMax[bd])) {
-          // Build up the linear index
-          linearIndex += indexMultiplier[bd] * ix;
-        } else {
-          // Outside the range
-          badOne = true;
-          break;
-        }
-      } // (for each dim in MDHisto)
-
-      // Is the vertex at the same place as the last one?
-      if (!badOne) {
-        if ((i > 0) && (linearIndex != lastLinearIndex)) {
-          // Change of index
-          badOne = true;
-          break;
-        }
-        lastLinearIndex = linearIndex;
-      }
-
-      // Was the vertex completely outside the range?
-      if (badOne)
-        break;
-    } // (for each vertex)
-
-    if (!badOne) {
-      // Yes, the entire box is within a single bin
-      //        std::cout << "Box at " << box->getExtentsStr() << " is within a
-      //        single bin.\n";
-      // Add the CACHED signal from the entire box
-      signals[lastLinearIndex] += box->getSignal();
-      errors[lastLinearIndex] += box->getErrorSquared();
-      // TODO: If DataObjects get a weight, this would need to get the summed
-      // weight.
-      numEvents[lastLinearIndex] += static_cast<signal_t>(box->getNPoints());
-
-      // And don't bother looking at each event. This may save lots of time
-      // loading from disk.
-      return;
-    }
-  }
-
-  // If you get here, you could not determine that the entire box was in the
-  // same bin.
-  // So you need to iterate through events.
-  const std::vector<MDE> &events = box->getConstEvents();
-  for (auto it = events.begin(); it != events.end(); ++it) {
+  // All vertexes have to be within THE SAME BIN = have the same linear index.
+  for (size_t i = 0; i < numVertexes; i++) {
     // Cache the center of the event (again for speed)
-    const coord_t *inCenter = it->getCenter();
+    const coord_t *inCenter = vertexes.get() + i * nd;
 
     // Now transform to the output dimensions
     m_transform->apply(inCenter, outCenter.data());
 
     // To build up the linear index
-    size_t linearIndex = 0;
-    // To mark events outside range
-    bool badOne = false;
-
+    size_t vertexIndex = 0;
     /// Loop through the dimensions on which we bin
     for (size_t bd = 0; bd < m_outD; bd++) {
       // What is the bin index in that dimension
       coord_t x = outCenter[bd];
       auto ix = size_t(x);
-      // Within range (for this chunk)?
-      if ((x >= 0) && (ix >= chunkMin[bd]) && (ix < chunkMax[bd])) {
+      // Within range?
+      if ((x >= 0) && (ix < numBins[bd])) {
         // Build up the linear index
-        linearIndex += indexMultiplier[bd] * ix;
+        vertexIndex += indexMultiplier[bd] * ix;
       } else {
-        // Outside the range
-        badOne = true;
-        break;
+        // The vertex is outside the range
+        return false;
       }
     } // (for each dim in MDHisto)
 
-    if (!badOne) {
-      // Sum the signals as doubles to preserve precision
-      signals[linearIndex] += static_cast<signal_t>(it->getSignal());
-      errors[linearIndex] += static_cast<signal_t>(it->getErrorSquared());
-      // TODO: If DataObjects get a weight, this would need to get the summed
-      // weight.
-      numEvents[linearIndex] += 1.0;
+    // Is the vertex at the same place as the last one?
+    if ((i > 0) && (vertexIndex != linearIndex))
+      return false;
+    linearIndex = vertexIndex;
+  } // (for each vertex)
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------
+/** Bin the contents of a MDBox
+ *
+ * @param box :: pointer to the MDBox to bin
+ * @param bins :: the sums of the calling thread, or nullptr to add to the
+ * output workspace directly
+ */
+template <typename MDE, size_t nd>
+inline void BinMD::binMDBox(MDBox<MDE, nd> *box, ThreadBins *bins) {
+  size_t bin = 0;
+  if (isInOneBin(box, bin)) {
+    // Yes, the entire box is within a single bin
+    // Add the CACHED signal from the entire box
+    // TODO: If DataObjects get a weight, this would need to get the summed
+    // weight.
+    addToBin(bins, {bin, box->getSignal(), box->getErrorSquared(),
+                    static_cast<signal_t>(box->getNPoints())});
+
+    // And don't bother looking at each event. This may save lots of time
+    // loading from disk.
+    return;
+  }
+
+  // If you get here, you could not determine that the entire box was in the
+  // same bin.
+  // So you need to iterate through events, a block at a time.
+  const std::vector<MDE> &events = box->getConstEvents();
+  if (!events.empty()) {
+    // Coordinates of a block of events, one dimension after the other
+    std::vector<coord_t> inBlock(nd * BLOCK_SIZE);
+    std::vector<coord_t> outBlock(m_outD * BLOCK_SIZE);
+    std::vector<size_t> linearIndex(BLOCK_SIZE);
+    std::vector<char> inside(BLOCK_SIZE);
+
+    for (size_t start = 0; start < events.size(); start += BLOCK_SIZE) {
+      const size_t count = std::min(BLOCK_SIZE, events.size() - start);
+      for (size_t i = 0; i < count; ++i) {
+        const coord_t *inCenter = events[start + i].getCenter();
+        for (size_t d = 0; d < nd; ++d)
+          inBlock[d * BLOCK_SIZE + i] = inCenter[d];
+      }
+
+      // Now transform to the output dimensions
+      transformBlock(inBlock.data(), nd, count, outBlock.data());
+
+      // Build up the linear indexes, marking the events outside range
+      std::fill_n(linearIndex.begin(), count, 0);
+      std::fill_n(inside.begin(), count, 1);
+      for (size_t bd = 0; bd < m_outD; bd++) {
+        const coord_t *x = outBlock.data() + bd * BLOCK_SIZE;
+        const auto upper = static_cast<coord_t>(numBins[bd]);
+        const size_t multiplier = indexMultiplier[bd];
+        for (size_t i = 0; i < count; ++i) {
+          const bool valid = (x[i] >= 0) && (x[i] < upper);
+          inside[i] &= static_cast<char>(valid);
+          linearIndex[i] += valid ? multiplier * static_cast<size_t>(x[i]) : 0;
+        }
+      }
+
+      for (size_t i = 0; i < count; ++i) {
+        if (!inside[i])
+          continue;
+        // Sum the signals as doubles to preserve precision
+        // TODO: If DataObjects get a weight, this would need to get the summed
+        // weight.
+        const auto &event = events[start + i];
+        addToBin(bins,
+                 {linearIndex[i], static_cast<signal_t>(event.getSignal()),
+                  static_cast<signal_t>(event.getErrorSquared()), 1.0});
+      }
     }
   }
   // Done with the events list
   box->releaseEvents();
 }
 
+//----------------------------------------------------------------------------------------------
+/** Find the leaf boxes that may contribute to the output
+ *
+ * @param root :: the top box of the workspace
+ * @param function :: the implicit function of the output region
+ * @param doParallel :: true to look through the subtrees of the top boxes in
+ * parallel
+ * @return the boxes touching the implicit function
+ */
+std::vector<API::IMDNode *>
+BinMD::getBoxesToBin(API::IMDNode *root, MDImplicitFunction *function,
+                     const bool doParallel) const {
+  std::vector<API::IMDNode *> boxes;
+  if (!doParallel) {
+    // Leaf-only; no depth limit; with the implicit function passed to it.
+    root->getBoxes(boxes, 1000, true, function);
+    return boxes;
+  }
+
+  // Cut the tree deep enough for its subtrees to keep all threads busy
+  const auto enoughSubtrees = 4 * static_cast<size_t>(PARALLEL_GET_MAX_THREADS);
+  std::vector<API::IMDNode *> subtrees;
+  size_t numSubtrees = 0;
+  size_t depth = root->getDepth();
+  do {
+    subtrees.clear();
+    ++depth;
+    root->getBoxes(subtrees, depth, true, function);
+    numSubtrees = static_cast<size_t>(std::count_if(
+        subtrees.cbegin(), subtrees.cend(),
+        [](const API::IMDNode *box) { return box->getNumChildren() > 0; }));
+  } while (numSubtrees > 0 && numSubtrees < enoughSubtrees &&
+           depth < root->getDepth() + 3);
+
+  // Every thread takes the next subtree when it is done with one
+  std::vector<std::vector<API::IMDNode *>> found(subtrees.size());
+  const auto numFound = static_cast<int64_t>(subtrees.size());
+  PRAGMA_OMP(parallel for schedule(dynamic, 1))
+  for (int64_t i = 0; i < numFound; ++i) {
+    auto *subtree = subtrees[i];
+    if (subtree->getNumChildren() > 0)
+      subtree->getBoxes(found[i], 1000, true, function);
+    else
+      found[i].emplace_back(subtree);
+  }
+  for (const auto &leaves : found)
+    boxes.insert(boxes.end(), leaves.cbegin(), leaves.cend());
+  return boxes;
+}
+
+//----------------------------------------------------------------------------------------------
+/** Keep the parameters of the transform in a form that can be applied to a
+ * block of events at once
+ */
+void BinMD::prepareBlockTransform() {
+  m_alignedDimensions.clear();
+  m_alignedOrigin.clear();
+  m_alignedScaling.clear();
+  m_affineRows.clear();
+  if (const auto *aligned =
+          dynamic_cast<const CoordTransformAligned *>(m_transform.get())) {
+    m_alignedDimensions = aligned->getDimensionToBinFrom();
+    m_alignedOrigin = aligned->getOrigin();
+    m_alignedScaling = aligned->getScaling();
+  } else if (const auto *affine = dynamic_cast<const CoordTransformAffine *>(
+                 m_transform.get())) {
+    const auto &matrix = affine->getMatrix();
+    const size_t inD = m_transform->getInD();
+    m_affineRows.resize(m_outD);
+    for (size_t bd = 0; bd < m_outD; bd++)
+      m_affineRows[bd].assign(matrix[bd], matrix[bd] + inD + 1);
+  }
+}
+
+//----------------------------------------------------------------------------------------------
+/** Transform the coordinates of a block of events to the output dimensions.
+ * The coordinates are stored one dimension after the other, BLOCK_SIZE
+ * apart, so that each loop goes through contiguous values and can be
+ * vectorized. This gives the same values as m_transform->apply.
+ *
+ * @param in :: the input coordinates
+ * @param inD :: the number of input dimensions
+ * @param count :: the number of events, at most BLOCK_SIZE
+ * @param out :: [out] the output coordinates
+ */
+void BinMD::transformBlock(const coord_t *in, const size_t inD,
+                           const size_t count, coord_t *out) const {
+  if (!m_alignedDimensions.empty()) {
+    for (size_t bd = 0; bd < m_outD; bd++) {
+      const coord_t *x = in + m_alignedDimensions[bd] * BLOCK_SIZE;
+      coord_t *y = out + bd * BLOCK_SIZE;
+      const coord_t origin = m_alignedOrigin[bd];
+      const coord_t scaling = m_alignedScaling[bd];
+      for (size_t i = 0; i < count; ++i)
+        y[i] = (x[i] - origin) * scaling;
+    }
+  } else if (!m_affineRows.empty()) {
+    for (size_t bd = 0; bd < m_outD; bd++) {
+      const auto &row = m_affineRows[bd];
+      coord_t *y = out + bd * BLOCK_SIZE;
+      std::fill_n(y, count, coord_t(0));
+      for (size_t d = 0; d < inD; ++d) {
+        const coord_t *x = in + d * BLOCK_SIZE;
+        const coord_t factor = row[d];
+        for (size_t i = 0; i < count; ++i)
+          y[i] += factor * x[i];
+      }
+      // The last input coordinate is "1" always
+      const coord_t offset = row[inD];
+      for (size_t i = 0; i < count; ++i)
+        y[i] += offset;
+    }
+  } else {
+    // Any other transform, one event at a time
+    std::vector<coord_t> inCenter(inD);
+    std::vector<coord_t> outCenter(m_outD);
+    for (size_t i = 0; i < count; ++i) {
+      for (size_t d = 0; d < inD; ++d)
+        inCenter[d] = in[d * BLOCK_SIZE + i];
+      m_transform->apply(inCenter.data(), outCenter.data());
+      for (size_t bd = 0; bd < m_outD; bd++)
+        out[bd * BLOCK_SIZE + i] = outCenter[bd];
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------
+/** Set up the sums of the threads binning in parallel. Each thread sums into
+ * its own copy of the output if all the copies are small enough. Otherwise
+ * the output is cut into slabs of consecutive bins, each with its own lock,
+ * and each thread buffers its contributions to every slab, adding them under
+ * the lock of the slab when the buffer is full.
+ *
+ * @param numThreads :: the number of threads binning
+ */
+void BinMD::prepareThreadBins(const size_t numThreads) {
+  const size_t size = outWS->getNPoints();
+  m_threadBins = std::vector<ThreadBins>(numThreads);
+  m_privateBins = size * numThreads <= PRIVATE_BINS_LIMIT;
+  m_slabShift = 0;
+  m_slabLocks.clear();
+  if (m_privateBins)
+    // The copies are allocated by the threads that use them
+    return;
+
+  // Slabs of a power of two bins, so finding them is a shift
+  while ((size_t{1} << m_slabShift) * MAX_SLABS < size)
+    ++m_slabShift;
+  const size_t numSlabs =
+      (size + (size_t{1} << m_slabShift) - 1) >> m_slabShift;
+  m_slabLocks = std::vector<std::mutex>(numSlabs);
+  for (auto &bins : m_threadBins)
+    bins.buffers.resize(numSlabs);
+}
+
+//----------------------------------------------------------------------------------------------
+/** Add the buffered contributions of one thread to a slab of the output,
+ * under the lock of the slab, and empty the buffer
+ *
+ * @param slab :: the index of the slab
+ * @param buffer :: the contributions to the slab
+ */
+void BinMD::flushSlab(const size_t slab, std::vector<BinContribution> &buffer) {
+  std::lock_guard<std::mutex> lock(m_slabLocks[slab]);
+  for (const auto &contribution : buffer) {
+    signals[contribution.index] += contribution.signal;
+    errors[contribution.index] += contribution.errorSquared;
+    numEvents[contribution.index] += contribution.numEvents;
+  }
+  buffer.clear();
+}
+
+//----------------------------------------------------------------------------------------------
+/** Add the sums of all the threads to the output workspace
+ */
+void BinMD::mergeThreadBins() {
+  if (m_privateBins) {
+    std::vector<const ThreadBins *> copies;
+    for (const auto &bins : m_threadBins)
+      if (!bins.signals.empty())
+        copies.emplace_back(&bins);
+    const auto size = static_cast<int64_t>(outWS->getNPoints());
+    PARALLEL_FOR_NO_WSP_CHECK()
+    for (int64_t start = 0; start < size; start += MERGE_BLOCK_SIZE) {
+      const int64_t end = std::min(start + MERGE_BLOCK_SIZE, size);
+      for (const auto *copy : copies)
+        for (int64_t i = start; i < end; ++i) {
+          signals[i] += copy->signals[i];
+          errors[i] += copy->errors[i];
+          numEvents[i] += copy->numEvents[i];
+        }
+    }
+  } else {
+    // Each slab is emptied by a single thread, so no thread waits for a lock
+    const auto numSlabs = static_cast<int64_t>(m_slabLocks.size());
+    PARALLEL_FOR_NO_WSP_CHECK()
+    for (int64_t slab = 0; slab < numSlabs; ++slab)
+      for (auto &bins : m_threadBins)
+        flushSlab(slab, bins.buffers[slab]);
+  }
+  m_threadBins.clear();
+  m_slabLocks.clear();
+}
+
 //----------------------------------------------------------------------------------------------
 /** Perform binning by iterating through every event and placing them in the
  *output workspace
@@ -238,122 +448,133 @@ void BinMD::binByIterating(typename MDEventWorkspace<MDE, nd>::sptr ws) {
 
   // Cache some data to speed up accessing them a bit
   indexMultiplier.resize(m_outD);
+  numBins.resize(m_outD);
   for (size_t d = 0; d < m_outD; d++) {
     if (d > 0)
       indexMultiplier[d] = outWS->getIndexMultiplier()[d - 1];
     else
       indexMultiplier[d] = 1;
+    numBins[d] = m_binDimensions[d]->getNBins();
   }
   signals = outWS->mutableSignalArray();
   errors = outWS->mutableErrorSquaredArray();
   numEvents = outWS->mutableNumEventsArray();
+  prepareBlockTransform();
 
   if (!m_accumulate) {
     // Start with signal/error/numEvents at 0.0
     outWS->setTo(0.0, 0.0, 0.0);
   }
 
-  // The dimension (in the output workspace) along which we chunk for parallel
-  // processing
-  // TODO: Find the smartest dimension to chunk against
-  size_t chunkDimension = 0;
-
-  // How many bins (in that dimension) per chunk.
-  // Try to split it so each core will get 2 tasks:
-  auto chunkNumBins = int(m_binDimensions[chunkDimension]->getNBins() /
-                          (PARALLEL_GET_MAX_THREADS * 2));
-  if (chunkNumBins < 1)
-    chunkNumBins = 1;
-
   // Do we actually do it in parallel?
   bool doParallel = getProperty("Parallel");
   // Not if file-backed!
   if (bc->isFileBacked())
     doParallel = false;
-  if (!doParallel)
-    chunkNumBins = int(m_binDimensions[chunkDimension]->getNBins());
+  const int numThreads = PARALLEL_GET_MAX_THREADS;
+  if (numThreads < 2)
+    doParallel = false;
+
+  // Build an implicit function (it needs to be in the space of the
+  // MDEventWorkspace)
+  const std::vector<size_t> binMin(m_outD, 0);
+  auto function =
+      this->getImplicitFunctionForChunk(binMin.data(), numBins.data());
+
+  // Get an array with a pointer to each box touching the function
+  auto boxes = getBoxesToBin(ws->getBox(), function.get(), doParallel);
+  g_log.debug() << "Found " << boxes.size()
+                << " boxes within the implicit function.\n";
+
+  // Sort boxes by file position IF file backed. This reduces seeking time,
+  // hopefully.
+  if (bc->isFileBacked())
+    API::IMDNode::sortObjByID(boxes);
+  // In parallel, the biggest boxes go first so the threads finish together
+  if (doParallel)
+    std::sort(boxes.begin(), boxes.end(),
+              [](const API::IMDNode *a, const API::IMDNode *b) {
+                return a->getNPoints() > b->getNPoints();
+              });
 
-  // Total number of steps
-  size_t progNumSteps = 0;
   if (prog) {
     prog->setNotifyStep(0.1);
-    prog->resetNumSteps(100, 0.00, 1.0);
+    prog->resetNumSteps(static_cast<int64_t>(boxes.size()), 0.00, 1.0);
   }
 
-  // Run the chunks in parallel. There is no overlap in the output workspace so
-  // it is thread safe to write to it..
-  // cppcheck-suppress syntaxError
-    PRAGMA_OMP( parallel for schedule(dynamic,1) if (doParallel) )
-    for (int chunk = 0;
-         chunk < int(m_binDimensions[chunkDimension]->getNBins());
-         chunk += chunkNumBins) {
-      PARALLEL_START_INTERUPT_REGION
-      // Region of interest for this chunk.
-      std::vector<size_t> chunkMin(m_outD);
-      std::vector<size_t> chunkMax(m_outD);
-      for (size_t bd = 0; bd < m_outD; bd++) {
-        // Same limits in the other dimensions
-        chunkMin[bd] = 0;
-        chunkMax[bd] = m_binDimensions[bd]->getNBins();
-      }
-      // Parcel out a chunk in that single dimension dimension
-      chunkMin[chunkDimension] = size_t(chunk);
-      if (size_t(chunk + chunkNumBins) >
-          m_binDimensions[chunkDimension]->getNBins())
-        chunkMax[chunkDimension] = m_binDimensions[chunkDimension]->getNBins();
-      else
-        chunkMax[chunkDimension] = size_t(chunk + chunkNumBins);
-
-      // Build an implicit function (it needs to be in the space of the
-      // MDEventWorkspace)
-      auto function =
-          this->getImplicitFunctionForChunk(chunkMin.data(), chunkMax.data());
-
-      // Use getBoxes() to get an array with a pointer to each box
-      std::vector<API::IMDNode *> boxes;
-      // Leaf-only; no depth limit; with the implicit function passed to it.
-      ws->getBox()->getBoxes(boxes, 1000, true, function.get());
-
-      // Sort boxes by file position IF file backed. This reduces seeking time,
-      // hopefully.
-      if (bc->isFileBacked())
-        API::IMDNode::sortObjByID(boxes);
-
-      // For progress reporting, the # of boxes
-      if (prog) {
-        PARALLEL_CRITICAL(BinMD_progress) {
-          g_log.debug() << "Chunk " << chunk << ": found " << boxes.size()
-                        << " boxes within the implicit function.\n";
-          progNumSteps += boxes.size();
-          prog->setNumSteps(progNumSteps);
-        }
+  if (doParallel)
+    prepareThreadBins(static_cast<size_t>(numThreads));
+
+  // Boxes of a file-backed workspace are read ahead of the binning, in file
+  // order. Only the boxes whose events are looked at are read ahead: a block
+  // read ahead and never loaded would keep its memory.
+  const auto numBoxes = static_cast<int64_t>(boxes.size());
+  API::IBoxControllerIO *fileIO =
+      bc->isFileBacked() ? bc->getFileIO() : nullptr;
+  std::vector<API::IMDNode *> toLoad;
+  // Index in toLoad of each box, or -1 if it is not loaded
+  std::vector<int64_t> loadIndex;
+  if (fileIO) {
+    loadIndex.resize(boxes.size(), -1);
+    for (size_t i = 0; i < boxes.size(); ++i) {
+      auto *box = dynamic_cast<MDBox<MDE, nd> *>(boxes[i]);
+      size_t bin = 0;
+      if (box && !box->getIsMasked() && !isInOneBin(box, bin)) {
+        loadIndex[i] = static_cast<int64_t>(toLoad.size());
+        toLoad.emplace_back(box);
       }
+    }
+    const auto numLoads = static_cast<int64_t>(toLoad.size());
+    for (int64_t i = 0; i < std::min(PREFETCH_DISTANCE, numLoads); ++i)
+      fileIO->prefetch(toLoad[i]->getISaveable());
+  }
 
-      // Go through every box for this chunk.
-      for (auto &boxe : boxes) {
-        auto *box = dynamic_cast<MDBox<MDE, nd> *>(boxe);
-        // Perform the binning in this separate method.
-        if (box && !box->getIsMasked())
-          this->binMDBox(box, chunkMin.data(), chunkMax.data());
-
-        // Progress reporting
-        if (prog)
-          prog->report();
-        // For early cancelling of the loop
-        if (this->m_cancel)
-          break;
-      } // for each box in the vector
-      PARALLEL_END_INTERUPT_REGION
-    } // for each chunk in parallel
-    PARALLEL_CHECK_INTERUPT_REGION
-
-    // Now the implicit function
-    if (implicitFunction) {
-      if (prog)
-        prog->report("Applying implicit function.");
-      signal_t nan = std::numeric_limits<signal_t>::quiet_NaN();
-      outWS->applyImplicitFunction(implicitFunction.get(), nan, nan);
+  // Go through every box. Each thread takes the next box when it is done with
+  // one and sums into its own bins, so threads are not left idle by an
+  // unbalanced tree.
+  PRAGMA_OMP(parallel for schedule(dynamic, 1) if (doParallel))
+  for (int64_t i = 0; i < numBoxes; ++i) {
+    PARALLEL_START_INTERUPT_REGION
+    if (fileIO && loadIndex[i] >= 0) {
+      const auto ahead = static_cast<size_t>(loadIndex[i] + PREFETCH_DISTANCE);
+      if (ahead < toLoad.size())
+        fileIO->prefetch(toLoad[ahead]->getISaveable());
+    }
+    ThreadBins *bins = nullptr;
+    if (doParallel) {
+      bins = &m_threadBins[PARALLEL_THREAD_NUMBER];
+      if (m_privateBins && bins->signals.empty()) {
+        const size_t size = outWS->getNPoints();
+        bins->signals.resize(size, 0.);
+        bins->errors.resize(size, 0.);
+        bins->numEvents.resize(size, 0.);
+      }
     }
+
+    auto *box = dynamic_cast<MDBox<MDE, nd> *>(boxes[i]);
+    // Perform the binning in this separate method.
+    if (box && !box->getIsMasked())
+      this->binMDBox(box, bins);
+
+    // Progress reporting
+    if (prog)
+      prog->report();
+    PARALLEL_END_INTERUPT_REGION
+  } // for each box in parallel
+  PARALLEL_CHECK_INTERUPT_REGION
+  if (fileIO)
+    g_log.debug() << fileIO->getIOStatisticsStr() << '\n';
+
+  if (doParallel)
+    mergeThreadBins();
+
+  // Now the implicit function
+  if (implicitFunction) {
+    if (prog)
+      prog->report("Applying implicit function.");
+    signal_t nan = std::numeric_limits<signal_t>::quiet_NaN();
+    outWS->applyImplicitFunction(implicitFunction.get(), nan, nan);
+  }
 }
 
 //----------------------------------------------------------------------------------------------
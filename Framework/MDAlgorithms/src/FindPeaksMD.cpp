@@ -15,9 +15,12 @@
 #include "MantidKernel/BoundedValidator.h"
 #include "MantidKernel/EnabledWhenProperty.h"
 #include "MantidKernel/ListValidator.h"
+#include "MantidKernel/MultiThreaded.h"
 #include "MantidKernel/VMD.h"
 
-#include <map>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
 #include <vector>
 
 using namespace Mantid::Kernel;
@@ -107,8 +110,104 @@ void addDetectors(DataObjects::Peak &peak, MDBoxBase<MDE, nd> &box) {
   // Compile time deduction of the correct function call
   addDetectors(peak, box, IsFullEvent<MDE, nd>());
 }
+
+/** Sort candidate boxes by increasing density, keeping the boxes of equal
+ * density in the order they were given
+ * @param densities :: the density of each box, or NaN to skip the box
+ * @param threshold :: the density a box must exceed to be kept
+ * @return pairs of density and index of the boxes kept
+ */
+std::vector<std::pair<double, size_t>>
+sortByDensity(const std::vector<double> &densities, const double threshold) {
+  std::vector<std::pair<double, size_t>> sorted;
+  for (size_t i = 0; i < densities.size(); ++i)
+    if (densities[i] > threshold)
+      sorted.emplace_back(densities[i], i);
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const std::pair<double, size_t> &a,
+                      const std::pair<double, size_t> &b) {
+                     return a.first < b.first;
+                   });
+  return sorted;
+}
 } // namespace
 
+//----------------------------------------------------------------------------------------------
+/**
+ * @param nd :: number of dimensions of the centres
+ * @param radiusSquared :: square of the peak distance threshold
+ */
+PeakCentreGrid::PeakCentreGrid(const size_t nd, const coord_t radiusSquared)
+    : m_nd(nd), m_radiusSquared(radiusSquared),
+      // A little wider than the threshold against rounding
+      m_cellSize(1.001 * std::sqrt(static_cast<double>(radiusSquared))) {}
+
+/// @return true if a peak is closer to the given centre than the threshold
+bool PeakCentreGrid::hasNeighbour(const coord_t *centre) const {
+  Cell cell;
+  if (!cellOf(centre, cell))
+    return false;
+  for (int64_t dx = -1; dx <= 1; ++dx)
+    for (int64_t dy = -1; dy <= 1; ++dy)
+      for (int64_t dz = -1; dz <= 1; ++dz) {
+        const auto found =
+            m_cells.find({cell.x + dx, cell.y + dy, cell.z + dz});
+        if (found == m_cells.end())
+          continue;
+        for (const size_t peak : found->second)
+          if (distanceSquared(peak, centre) < m_radiusSquared)
+            return true;
+      }
+  return false;
+}
+
+/// Add the centre of a peak
+void PeakCentreGrid::add(const coord_t *centre) {
+  Cell cell;
+  if (!cellOf(centre, cell))
+    return;
+  m_cells[cell].emplace_back(m_centres.size() / m_nd);
+  m_centres.insert(m_centres.end(), centre, centre + m_nd);
+}
+
+size_t PeakCentreGrid::CellHash::operator()(const Cell &cell) const {
+  const auto x = static_cast<uint64_t>(cell.x);
+  const auto y = static_cast<uint64_t>(cell.y);
+  const auto z = static_cast<uint64_t>(cell.z);
+  return std::hash<uint64_t>()(x * 73856093u ^ y * 19349663u ^ z * 83492791u);
+}
+
+/** Find the cell of a centre
+ * @return false if no peak can be closer to the centre than the threshold:
+ * the threshold is zero or the centre is not finite
+ */
+bool PeakCentreGrid::cellOf(const coord_t *centre, Cell &cell) const {
+  if (!(m_cellSize > 0.))
+    return false;
+  int64_t index[3];
+  for (size_t d = 0; d < 3; ++d) {
+    const double scaled =
+        std::floor(static_cast<double>(centre[d]) / m_cellSize);
+    if (!std::isfinite(scaled))
+      return false;
+    // Cells far beyond any sensible extent are merged, which is safe
+    index[d] = static_cast<int64_t>(std::max(std::min(scaled, 1e15), -1e15));
+  }
+  cell = {index[0], index[1], index[2]};
+  return true;
+}
+
+coord_t PeakCentreGrid::distanceSquared(const size_t peak,
+                                        const coord_t *centre) const {
+  const coord_t *other = m_centres.data() + peak * m_nd;
+  coord_t distSquared = 0.0;
+  for (size_t d = 0; d < m_nd; d++) {
+    coord_t dist = other[d] - centre[d];
+    distSquared += (dist * dist);
+  }
+  return distSquared;
+}
+
 // Register the algorithm into the AlgorithmFactory
 DECLARE_ALGORITHM(FindPeaksMD)
 
@@ -423,31 +522,27 @@ void FindPeaksMD::findPeaks(typename MDEventWorkspace<MDE, nd>::sptr ws) {
     progress(0.10, "Getting Boxes");
     ws->getBox()->getBoxes(boxes, 1000, true);
 
-    // This pair is the <density, ptr to the box>
-    using dens_box = std::pair<double, API::IMDNode *>;
-
-    // Map that will sort the boxes by increasing density. The key = density;
-    // value = box *.
-    typename std::multimap<double, API::IMDNode *> sortedBoxes;
-
     // --------------- Sort and Filter by Density -----------------------------
     progress(0.20, "Sorting Boxes by Density");
-    auto it1 = boxes.begin();
-    auto it1_end = boxes.end();
-    for (; it1 != it1_end; it1++) {
-      auto box = *it1;
-      double value = m_useNumberOfEventsNormalization
-                         ? box->getSignalByNEvents()
-                         : box->getSignalNormalized();
-      value *= m_densityScaleFactor;
-      // Skip any boxes with too small a signal value.
-      if (value > threshold)
-        sortedBoxes.insert(dens_box(value, box));
+    std::vector<double> densities(boxes.size());
+    const auto numBoxes = static_cast<int64_t>(boxes.size());
+    PARALLEL_FOR_NO_WSP_CHECK()
+    for (int64_t i = 0; i < numBoxes; ++i) {
+      const auto box = boxes[i];
+      const double value = m_useNumberOfEventsNormalization
+                               ? box->getSignalByNEvents()
+                               : box->getSignalNormalized();
+      densities[i] = value * m_densityScaleFactor;
     }
+    // Skip any boxes with too small a signal value.
+    // Pairs of <density, index of the box>, by increasing density.
+    const auto sortedBoxes = sortByDensity(densities, threshold);
 
     // --------------- Find Peak Boxes -----------------------------
     // List of chosen possible peak boxes.
     std::vector<API::IMDNode *> peakBoxes;
+    // Their centres, to reject boxes too close to them
+    PeakCentreGrid peakCentres(nd, peakRadiusSquared);
 
     prog = std::make_unique<Progress>(this, 0.30, 0.95, m_maxPeaks);
 
@@ -455,13 +550,11 @@ void FindPeaksMD::findPeaks(typename MDEventWorkspace<MDE, nd>::sptr ws) {
     bool isMDEvent(ws->id().find("MDEventWorkspace") != std::string::npos);
 
     int64_t numBoxesFound = 0;
-    // Now we go (backwards) through the map
+    // Now we go (backwards) through the boxes
     // e.g. from highest density down to lowest density.
-    typename std::multimap<double, boxPtr>::reverse_iterator it2;
-    auto it2_end = sortedBoxes.rend();
-    for (it2 = sortedBoxes.rbegin(); it2 != it2_end; ++it2) {
+    for (auto it2 = sortedBoxes.rbegin(); it2 != sortedBoxes.rend(); ++it2) {
       signal_t density = it2->first;
-      boxPtr box = it2->second;
+      boxPtr box = boxes[it2->second];
 #ifndef MDBOX_TRACK_CENTROID
       coord_t boxCenter[nd];
       box->calculateCentroid(boxCenter);
@@ -469,30 +562,8 @@ void FindPeaksMD::findPeaks(typename MDEventWorkspace<MDE, nd>::sptr ws) {
       const coord_t *boxCenter = box->getCentroid();
 #endif
 
-      // Compare to all boxes already picked.
-      bool badBox = false;
-      for (auto &peakBoxe : peakBoxes) {
-
-#ifndef MDBOX_TRACK_CENTROID
-        coord_t otherCenter[nd];
-        (*it3)->calculateCentroid(otherCenter);
-#else
-        const coord_t *otherCenter = peakBoxe->getCentroid();
-#endif
-
-        // Distance between this box and a box we already put in.
-        coord_t distSquared = 0.0;
-        for (size_t d = 0; d < nd; d++) {
-          coord_t dist = otherCenter[d] - boxCenter[d];
-          distSquared += (dist * dist);
-        }
-
-        // Reject this box if it is too close to another previously found box.
-        if (distSquared < peakRadiusSquared) {
-          badBox = true;
-          break;
-        }
-      }
+      // Reject this box if it is too close to another previously found box.
+      bool badBox = peakCentres.hasNeighbour(boxCenter);
 
       // The box was not rejected for another reason.
       if (!badBox) {
@@ -503,6 +574,7 @@ void FindPeaksMD::findPeaks(typename MDEventWorkspace<MDE, nd>::sptr ws) {
         }
 
         peakBoxes.emplace_back(box);
+        peakCentres.add(boxCenter);
         g_log.debug() << "Found box at ";
         for (size_t d = 0; d < nd; d++)
           g_log.debug() << (d > 0 ? "," : "") << boxCenter[d];
@@ -606,13 +678,6 @@ void FindPeaksMD::findPeaksHisto(
     // Copy the instrument, sample, run to the peaks workspace.
     peakWS->copyExperimentInfoFrom(ei.get());
 
-    // This pair is the <density, box index>
-    using dens_box = std::pair<double, size_t>;
-
-    // Map that will sort the boxes by increasing density. The key = density;
-    // value = box index.
-    std::multimap<double, size_t> sortedBoxes;
-
     size_t numBoxes = ws->getNPoints();
 
     // --------- Count the overall signal density -----------------------------
@@ -635,48 +700,36 @@ void FindPeaksMD::findPeaksHisto(
 
     // -------------- Sort and Filter by Density -----------------------------
     progress(0.20, "Sorting Boxes by Density");
-    for (size_t i = 0; i < numBoxes; i++) {
-      double density = ws->getSignalNormalizedAt(i) * m_densityScaleFactor;
-      // Skip any boxes with too small a signal density.
-      if (density > thresholdDensity)
-        sortedBoxes.insert(dens_box(density, i));
-    }
+    std::vector<double> densities(numBoxes);
+    PARALLEL_FOR_NO_WSP_CHECK()
+    for (int64_t i = 0; i < static_cast<int64_t>(numBoxes); i++)
+      densities[i] = ws->getSignalNormalizedAt(i) * m_densityScaleFactor;
+    // Skip any boxes with too small a signal density.
+    // Pairs of <density, box index>, by increasing density.
+    const auto sortedBoxes = sortByDensity(densities, thresholdDensity);
 
     // --------------- Find Peak Boxes -----------------------------
     // List of chosen possible peak boxes.
     std::vector<size_t> peakBoxes;
+    // Their centres, to reject boxes too close to them
+    PeakCentreGrid peakCentres(nd, peakRadiusSquared);
+    std::vector<coord_t> boxCenter(nd);
 
     prog = std::make_unique<Progress>(this, 0.30, 0.95, m_maxPeaks);
 
     int64_t numBoxesFound = 0;
-    // Now we go (backwards) through the map
+    // Now we go (backwards) through the boxes
     // e.g. from highest density down to lowest density.
-    std::multimap<double, size_t>::reverse_iterator it2;
-    auto it2_end = sortedBoxes.rend();
-    for (it2 = sortedBoxes.rbegin(); it2 != it2_end; ++it2) {
+    for (auto it2 = sortedBoxes.rbegin(); it2 != sortedBoxes.rend(); ++it2) {
       signal_t density = it2->first;
       size_t index = it2->second;
       // Get the center of the box
-      VMD boxCenter = ws->getCenter(index);
-
-      // Compare to all boxes already picked.
-      bool badBox = false;
-      for (auto &peakBoxe : peakBoxes) {
-        VMD otherCenter = ws->getCenter(peakBoxe);
+      const VMD center = ws->getCenter(index);
+      for (size_t d = 0; d < nd; d++)
+        boxCenter[d] = static_cast<coord_t>(center[d]);
 
-        // Distance between this box and a box we already put in.
-        coord_t distSquared = 0.0;
-        for (size_t d = 0; d < nd; d++) {
-          coord_t dist = otherCenter[d] - boxCenter[d];
-          distSquared += (dist * dist);
-        }
-
-        // Reject this box if it is too close to another previously found box.
-        if (distSquared < peakRadiusSquared) {
-          badBox = true;
-          break;
-        }
-      }
+      // Reject this box if it is too close to another previously found box.
+      bool badBox = peakCentres.hasNeighbour(boxCenter.data());
 
       // The box was not rejected for another reason.
       if (!badBox) {
@@ -687,6 +740,7 @@ void FindPeaksMD::findPeaksHisto(
         }
 
         peakBoxes.emplace_back(index);
+        peakCentres.add(boxCenter.data());
         g_log.debug() << "Found box at index " << index;
         g_log.debug() << "; Density = " << density << '\n';
         // Report progres for each box found.
@@ -30,13 +30,16 @@
 #include "MantidHistogramData/LinearGenerator.h"
 #include "MantidKernel/ListValidator.h"
 #include "MantidKernel/System.h"
+#include "MantidKernel/Timer.h"
 #include "MantidKernel/Utils.h"
 #include "MantidMDAlgorithms/GSLFunctions.h"
 #include "MantidMDAlgorithms/MDBoxMaskFunction.h"
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <gsl/gsl_integration.h>
+#include <numeric>
 
 namespace Mantid {
 namespace MDAlgorithms {
@@ -51,6 +54,76 @@ using namespace Mantid::DataObjects;
 using namespace Mantid::DataObjects;
 using namespace Mantid::Geometry;
 
+namespace {
+/// The center of a peak in the given coordinates
+V3D peakCenter(const IPeak &p, const SpecialCoordinateSystem coordinates) {
+  if (coordinates == Mantid::Kernel::QLab) //"Q (lab frame)"
+    return p.getQLabFrame();
+  else if (coordinates == Mantid::Kernel::QSample) //"Q (sample frame)"
+    return p.getQSampleFrame();
+  else if (coordinates == Mantid::Kernel::HKL) //"HKL"
+    return p.getHKL();
+  return V3D();
+}
+
+/// The indices of the peaks in increasing order
+std::vector<int> peaksInIndexOrder(const int nPeaks) {
+  std::vector<int> order(nPeaks);
+  std::iota(order.begin(), order.end(), 0);
+  return order;
+}
+
+/** The indices of the peaks along a Morton (Z-order) curve through cubic
+ * cells, so that peaks close to each other in the order are close in space.
+ * @param positions :: centers of the peaks
+ * @param cellSize :: side of the cells
+ * @return the indices of the peaks
+ */
+std::vector<int> peaksInSpatialOrder(const std::vector<V3D> &positions,
+                                     const double cellSize) {
+  // Bits per dimension of the cell indices, so that a key fits in 64 bits
+  constexpr size_t bits = 21;
+  constexpr double maxCell = static_cast<double>((uint64_t{1} << bits) - 1);
+  V3D origin;
+  if (!positions.empty())
+    origin = positions.front();
+  for (const auto &pos : positions)
+    for (size_t d = 0; d < 3; ++d)
+      origin[d] = std::min(origin[d], pos[d]);
+  const double size = cellSize > 0. ? cellSize : 1.;
+
+  std::vector<std::pair<uint64_t, int>> keyed;
+  keyed.reserve(positions.size());
+  for (size_t i = 0; i < positions.size(); ++i) {
+    uint64_t cell[3];
+    for (size_t d = 0; d < 3; ++d)
+      cell[d] = static_cast<uint64_t>(
+          std::min((positions[i][d] - origin[d]) / size, maxCell));
+    // Interleave the bits of the cell indices, most significant first
+    uint64_t key = 0;
+    for (size_t bit = bits; bit > 0; --bit)
+      for (size_t d = 0; d < 3; ++d)
+        key = (key << 1) | ((cell[d] >> (bit - 1)) & 1);
+    keyed.emplace_back(key, static_cast<int>(i));
+  }
+  std::sort(keyed.begin(), keyed.end());
+  std::vector<int> order;
+  order.reserve(keyed.size());
+  for (const auto &key : keyed)
+    order.emplace_back(key.second);
+  return order;
+}
+
+/// The indices of the peaks by increasing x coordinate of their centers
+std::vector<int> peaksInXOrder(const std::vector<V3D> &positions) {
+  auto order = peaksInIndexOrder(static_cast<int>(positions.size()));
+  std::sort(order.begin(), order.end(), [&positions](const int a, const int b) {
+    return positions[a].X() < positions[b].X();
+  });
+  return order;
+}
+} // namespace
+
 /** Initialize the algorithm's properties.
  */
 void IntegratePeaksMD2::init() {
@@ -295,35 +368,48 @@ void IntegratePeaksMD2::integrate(typename MDEventWorkspace<MDE, nd>::sptr ws) {
       (std::pow(BackgroundOuterRadius, 3) - std::pow(BackgroundOuterRadius, 3));
   // volume of PeakRadius sphere
   double volumeRadius = 4.0 / 3.0 * M_PI * std::pow(PeakRadius, 3);
+
+  // Get the peak centers as positions in the dimensions of the workspace
+  int nPeaks = peakWS->getNumberPeaks();
+  std::vector<V3D> positions(nPeaks);
+  for (int i = 0; i < nPeaks; ++i)
+    positions[i] = peakCenter(peakWS->getPeak(i), CoordinatesToUse);
+  const auto xOrder = peaksInXOrder(positions);
+
+  // An earlier parallel version of this loop seg faulted sporadically when
+  // processing multiple TOPAZ runs in a script, on Scientific Linux 6.2,
+  // typically after 2 to 6 runs, and was commented out. Refs #5533. The cause
+  // was not found.
   //
-  // If the following OMP pragma is included, this algorithm seg faults
-  // sporadically when processing multiple TOPAZ runs in a script, on
-  // Scientific Linux 6.2.  Typically, it seg faults after 2 to 6 runs are
-  // processed, though occasionally it will process all 8 requested in the
-  // script without crashing.  Since the lower level codes already use OpenMP,
-  // parallelizing at this level is only marginally useful, giving about a
-  // 5-10% speedup.  Perhaps is should just be removed permanantly, but for
-  // now it is commented out to avoid the seg faults.  Refs #5533
-  // PRAGMA_OMP(parallel for schedule(dynamic, 10) )
+  // The peaks are now integrated in parallel only when the loop reads the box
+  // tree and nothing else is shared: each iteration writes only its own peak
+  // and its own entries of the radius vectors. Fitting the profiles runs child
+  // algorithms and writes a single file, and the boxes of a file-backed
+  // workspace mark themselves busy and go through the shared DiskBuffer each
+  // time their events are read, so these cases are done serially.
+  const bool fitProfiles = cylinderBool && profileFunction != "NoFit";
+  const bool runParallel = !fitProfiles && !ws->isFileBacked();
+  // Each thread takes a run of peaks close to each other, so that the boxes
+  // integrated for one peak are still in its cache for the next ones. The
+  // profiles are fitted in order as the output file lists them in order.
+  const double cellSize = 2. * std::max(PeakRadius, BackgroundOuterRadius);
+  const auto order = fitProfiles ? peaksInIndexOrder(nPeaks)
+                                 : peaksInSpatialOrder(positions, cellSize);
+  std::vector<double> peakTimes(nPeaks, 0.);
+  Timer totalTime;
+
   // Initialize progress reporting
-  int nPeaks = peakWS->getNumberPeaks();
   Progress progress(this, 0., 1., nPeaks);
-  for (int i = 0; i < nPeaks; ++i) {
-    if (this->getCancel())
-      break; // User cancellation
+  PRAGMA_OMP(parallel for schedule(dynamic, PEAK_BATCH) if (runParallel))
+  for (int n = 0; n < nPeaks; ++n) {
+    PARALLEL_START_INTERUPT_REGION
+    const int i = order[n];
+    Timer peakTime;
     progress.report();
 
     // Get a direct ref to that peak.
     IPeak &p = peakWS->getPeak(i);
-
-    // Get the peak center as a position in the dimensions of the workspace
-    V3D pos;
-    if (CoordinatesToUse == Mantid::Kernel::QLab) //"Q (lab frame)"
-      pos = p.getQLabFrame();
-    else if (CoordinatesToUse == Mantid::Kernel::QSample) //"Q (sample frame)"
-      pos = p.getQSampleFrame();
-    else if (CoordinatesToUse == Mantid::Kernel::HKL) //"HKL"
-      pos = p.getHKL();
+    const V3D &pos = positions[i];
 
     // Do not integrate if sphere is off edge of detector
 
@@ -643,7 +729,7 @@ void IntegratePeaksMD2::integrate(typename MDEventWorkspace<MDE, nd>::sptr ws) {
       }
     }
     checkOverlap(
-        i, peakWS, CoordinatesToUse,
+        i, positions, xOrder,
         2.0 * std::max(PeakRadiusVector[i], BackgroundOuterRadiusVector[i]));
     // Save it back in the peak object.
     if (signal != 0. || replaceIntensity) {
@@ -676,13 +762,29 @@ void IntegratePeaksMD2::integrate(typename MDEventWorkspace<MDE, nd>::sptr ws) {
                                  bgErrorSquared)));
     }
 
+    peakTimes[i] = peakTime.elapsed();
     g_log.information() << "Peak " << i << " at " << pos << ": signal "
                         << signal << " (sig^2 " << errorSquared
                         << "), with background "
                         << bgSignal + ratio * background_total << " (sig^2 "
                         << bgErrorSquared +
                                ratio * ratio * std::fabs(background_total)
-                        << ") subtracted.\n";
+                        << ") subtracted, in " << peakTimes[i] << " s.\n";
+    PARALLEL_END_INTERUPT_REGION
+  }
+  PARALLEL_CHECK_INTERUPT_REGION
+  if (nPeaks > 0) {
+    const auto slowest = std::max_element(peakTimes.cbegin(), peakTimes.cend());
+    g_log.information() << "Integrated " << nPeaks << " peaks in "
+                        << totalTime.elapsed() << " s"
+                        << (runParallel ? " in parallel" : "")
+                        << ". Peaks took "
+                        << std::accumulate(peakTimes.cbegin(), peakTimes.cend(),
+                                           0.) /
+                               nPeaks
+                        << " s on average; the slowest, peak "
+                        << std::distance(peakTimes.cbegin(), slowest)
+                        << ", took " << *slowest << " s.\n";
   }
   // This flag is used by the PeaksWorkspace to evaluate whether it has
   // been integrated.
@@ -961,34 +1063,33 @@ void IntegratePeaksMD2::runMaskDetectors(
   }
 }
 
-void IntegratePeaksMD2::checkOverlap(
-    int i, const Mantid::DataObjects::PeaksWorkspace_sptr &peakWS,
-    Mantid::Kernel::SpecialCoordinateSystem CoordinatesToUse, double radius) {
-  // Get a direct ref to that peak.
-  IPeak &p1 = peakWS->getPeak(i);
-  V3D pos1;
-  if (CoordinatesToUse == Kernel::QLab) //"Q (lab frame)"
-    pos1 = p1.getQLabFrame();
-  else if (CoordinatesToUse == Kernel::QSample) //"Q (sample frame)"
-    pos1 = p1.getQSampleFrame();
-  else if (CoordinatesToUse == Kernel::HKL) //"HKL"
-    pos1 = p1.getHKL();
-  for (int j = i + 1; j < peakWS->getNumberPeaks(); ++j) {
-    // Get a direct ref to rest of peaks peak.
-    IPeak &p2 = peakWS->getPeak(j);
-    V3D pos2;
-    if (CoordinatesToUse == Kernel::QLab) //"Q (lab frame)"
-      pos2 = p2.getQLabFrame();
-    else if (CoordinatesToUse == Kernel::QSample) //"Q (sample frame)"
-      pos2 = p2.getQSampleFrame();
-    else if (CoordinatesToUse == Kernel::HKL) //"HKL"
-      pos2 = p2.getHKL();
-    if (pos1.distance(pos2) < radius) {
-      g_log.warning() << " Warning:  Peak integration spheres for peaks " << i
-                      << " and " << j << " overlap.  Distance between peaks is "
-                      << pos1.distance(pos2) << '\n';
-    }
-  }
+/** Warn about the integration volume of a peak overlapping that of a peak
+ * following it in the workspace
+ * @param i :: index of the peak
+ * @param positions :: centers of all peaks
+ * @param xOrder :: indices of the peaks by increasing x coordinate
+ * @param radius :: the distance below which the peaks overlap
+ */
+void IntegratePeaksMD2::checkOverlap(int i, const std::vector<V3D> &positions,
+                                     const std::vector<int> &xOrder,
+                                     double radius) {
+  // Only the peaks in a slab of the given half width in x can be close enough
+  const V3D &pos1 = positions[i];
+  const auto byX = [&positions](const int peak, const double x) {
+    return positions[peak].X() < x;
+  };
+  auto first =
+      std::lower_bound(xOrder.cbegin(), xOrder.cend(), pos1.X() - radius, byX);
+  std::vector<int> overlapping;
+  for (auto j = first;
+       j != xOrder.cend() && positions[*j].X() < pos1.X() + radius; ++j)
+    if (*j > i && pos1.distance(positions[*j]) < radius)
+      overlapping.emplace_back(*j);
+  std::sort(overlapping.begin(), overlapping.end());
+  for (const int j : overlapping)
+    g_log.warning() << " Warning:  Peak integration spheres for peaks " << i
+                    << " and " << j << " overlap.  Distance between peaks is "
+                    << pos1.distance(positions[j]) << '\n';
 }
 
 //----------------------------------------------------------------------------------------------
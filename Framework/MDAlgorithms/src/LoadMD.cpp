@@ -11,6 +11,7 @@
 #include "MantidAPI/IMDWorkspace.h"
 #include "MantidAPI/RegisterFileLoader.h"
 #include "MantidAPI/WorkspaceHistory.h"
+#include "MantidDataObjects/BoxControllerCompressedIO.h"
 #include "MantidDataObjects/BoxControllerNeXusIO.h"
 #include "MantidDataObjects/CoordTransformAffine.h"
 #include "MantidDataObjects/MDBoxFlatTree.h"
@@ -34,9 +35,10 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/regex.hpp>
 #include <nexus/NeXusException.hpp>
-#include <vector>
 
-using file_holder_type = std::unique_ptr<Mantid::API::IBoxControllerIO>;
+#include <algorithm>
+#include <numeric>
+#include <vector>
 
 using namespace Mantid::Kernel;
 using namespace Mantid::API;
@@ -55,7 +57,8 @@ LoadMD::LoadMD()
     : m_numDims(0), // uninitialized incorrect value
       m_coordSystem(None),
       m_BoxStructureAndMethadata(true), // this is faster but rarely needed.
-      m_saveMDVersion(false), m_requiresMDFrameCorrection(false) {}
+      m_saveMDVersion(false), m_compressedEvents(false),
+      m_requiresMDFrameCorrection(false) {}
 
 /**
  * Return the confidence with which this algorithm can load the file
@@ -169,6 +172,9 @@ void LoadMD::exec() {
   // Open the entry
   m_file->openGroup(entryName, "NXentry");
   const std::map<std::string, std::string> levelEntries = m_file->getEntries();
+  m_compressedEvents =
+      levelEntries.find(BoxControllerCompressedIO::EVENT_GROUP_NAME) !=
+      levelEntries.end();
 
   // Check is SaveMD version 2 was used
   m_saveMDVersion = 0;
@@ -552,8 +558,7 @@ void LoadMD::doLoad(typename MDEventWorkspace<MDE, nd>::sptr ws) {
   // ---------------------------------------- DEAL WITH BOXES
   // ------------------------------------
   if (fileBackEnd) { // TODO:: call to the file format factory
-    auto loader = std::shared_ptr<API::IBoxControllerIO>(
-        new DataObjects::BoxControllerNeXusIO(bc.get()));
+    auto loader = createEventLoader(bc.get());
     loader->setDataType(sizeof(coord_t), MDE::getTypeName());
     bc->setFileBacked(loader, m_filename);
     // boxes have been already made file-backed when restoring the boxTree;
@@ -578,13 +583,15 @@ void LoadMD::doLoad(typename MDEventWorkspace<MDE, nd>::sptr ws) {
       g_log.information() << "Setting a DiskBuffer cache size of " << mb
                           << " MB, or " << cacheMemory << " events.\n";
     }
+    // Write changed boxes and read ahead the boxes about to be used in a
+    // background thread
+    loader->setBackgroundIO(true);
   } // Not file back end
   else if (!m_BoxStructureAndMethadata) {
     // ---------------------------------------- READ IN THE BOXES
     // ------------------------------------
     // TODO:: call to the file format factory
-    auto loader =
-        file_holder_type(new DataObjects::BoxControllerNeXusIO(bc.get()));
+    auto loader = createEventLoader(bc.get());
     loader->setDataType(sizeof(coord_t), MDE::getTypeName());
 
     loader->openFile(m_filename, "r");
@@ -592,7 +599,15 @@ void LoadMD::doLoad(typename MDEventWorkspace<MDE, nd>::sptr ws) {
     const std::vector<uint64_t> &BoxEventIndex = FlatBoxTree.getEventIndex();
     prog->setNumSteps(numBoxes);
 
-    for (size_t i = 0; i < numBoxes; i++) {
+    // Read the boxes in the order they are in the file
+    std::vector<size_t> fileOrder(numBoxes);
+    std::iota(fileOrder.begin(), fileOrder.end(), size_t{0});
+    std::stable_sort(fileOrder.begin(), fileOrder.end(),
+                     [&BoxEventIndex](const size_t a, const size_t b) {
+                       return BoxEventIndex[2 * a] < BoxEventIndex[2 * b];
+                     });
+
+    for (const auto i : fileOrder) {
       prog->report();
       auto *box = dynamic_cast<MDBox<MDE, nd> *>(boxTree[i]);
       if (!box)
@@ -629,6 +644,19 @@ void LoadMD::doLoad(typename MDEventWorkspace<MDE, nd>::sptr ws) {
   g_log.debug() << tim << " to finish up.\n";
 }
 
+/**
+ * Make the object reading the events of the boxes, for the way the events
+ * are stored in the file.
+ * @param bc : box controller of the workspace being loaded
+ * @return the event loader, not opened
+ */
+std::shared_ptr<API::IBoxControllerIO>
+LoadMD::createEventLoader(API::BoxController *bc) const {
+  if (m_compressedEvents)
+    return std::make_shared<DataObjects::BoxControllerCompressedIO>(bc);
+  return std::make_shared<DataObjects::BoxControllerNeXusIO>(bc);
+}
+
 /**
  * Load all of the affine matrices from the file, create the
  * appropriate coordinate transform and set those on the workspace.
@@ -5,6 +5,8 @@
 //   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
 // SPDX - License - Identifier: GPL - 3.0 +
 #include "MantidMDAlgorithms/MDNorm.h"
+#include "MantidMDAlgorithms/MDNormAccumulator.h"
+#include "MantidMDAlgorithms/MDNormCache.h"
 #include "MantidAPI/CommonBinsValidator.h"
 #include "MantidAPI/IMDEventWorkspace.h"
 #include "MantidAPI/InstrumentValidator.h"
@@ -17,11 +19,13 @@
 #include "MantidGeometry/Crystal/SpaceGroupFactory.h"
 #include "MantidGeometry/Crystal/SymmetryOperationFactory.h"
 #include "MantidGeometry/Instrument.h"
+#include "MantidGeometry/Instrument/DetectorInfo.h"
 #include "MantidGeometry/MDGeometry/HKL.h"
 #include "MantidGeometry/MDGeometry/MDFrameFactory.h"
 #include "MantidGeometry/MDGeometry/QSample.h"
 #include "MantidKernel/ArrayLengthValidator.h"
 #include "MantidKernel/ArrayProperty.h"
+#include "MantidKernel/ChecksumHelper.h"
 #include "MantidKernel/CompositeValidator.h"
 #include "MantidKernel/ConfigService.h"
 #include "MantidKernel/Exception.h"
@@ -57,6 +61,28 @@ constexpr double energyToK = 8.0 * M_PI * M_PI *
 static bool abs_compare(double a, double b) {
   return (std::fabs(a) < std::fabs(b));
 }
+
+/// Append the bytes of some values to a string to be hashed
+template <typename T>
+void appendBytes(std::string &buffer, const T *values, const size_t count) {
+  buffer.append(reinterpret_cast<const char *>(values), count * sizeof(T));
+}
+
+/// Append the detector IDs, X and Y values of a workspace
+void appendWorkspace(std::string &buffer,
+                     const API::MatrixWorkspace_const_sptr &workspace) {
+  if (!workspace)
+    return;
+  for (size_t i = 0; i < workspace->getNumberHistograms(); ++i) {
+    const auto &detIDs = workspace->getSpectrum(i).getDetectorIDs();
+    const std::vector<detid_t> ids(detIDs.cbegin(), detIDs.cend());
+    appendBytes(buffer, ids.data(), ids.size());
+    const auto &x = workspace->x(i);
+    const auto &y = workspace->y(i);
+    appendBytes(buffer, x.rawData().data(), x.size());
+    appendBytes(buffer, y.rawData().data(), y.size());
+  }
+}
 } // namespace
 
 // Register the algorithm into the AlgorithmFactory
@@ -70,8 +96,9 @@ MDNorm::MDNorm()
     : m_normWS(), m_inputWS(), m_isRLU(false), m_UB(3, 3, true),
       m_W(3, 3, true), m_transformation(), m_hX(), m_kX(), m_lX(), m_eX(),
       m_hIdx(-1), m_kIdx(-1), m_lIdx(-1), m_eIdx(-1), m_numExptInfos(0),
-      m_Ei(0.0), m_diffraction(true), m_accumulate(false), m_dEIntegrated(true),
-      m_samplePos(), m_beamDir(), convention("") {}
+      m_Ei(0.0), m_diffraction(true), m_dEIntegrated(true), m_samplePos(),
+      m_beamDir(), convention(""), m_detectorValues(),
+      m_detectorValuesSource(nullptr) {}
 
 /// Algorithms name for identification. @see Algorithm::name
 const std::string MDNorm::name() const { return "MDNorm"; }
@@ -199,8 +226,15 @@ void MDNorm::init() {
                   "An input MDHistoWorkspace used to accumulate normalization "
                   "from multiple MDEventWorkspaces. If unspecified a blank "
                   "MDHistoWorkspace will be created.");
+  declareProperty(
+      "UseNormalizationCache", false,
+      "Keep the normalization in memory, and reuse it when called again "
+      "with the same binning, symmetry, solid angle and flux on a workspace "
+      "that holds the same runs and new ones. Only the new runs are "
+      "normalized.");
   setPropertyGroup("TemporaryDataWorkspace", "Temporary workspaces");
   setPropertyGroup("TemporaryNormalizationWorkspace", "Temporary workspaces");
+  setPropertyGroup("UseNormalizationCache", "Temporary workspaces");
 
   declareProperty(std::make_unique<WorkspaceProperty<API::Workspace>>(
                       "OutputWorkspace", "", Kernel::Direction::Output),
@@ -476,21 +510,52 @@ void MDNorm::exec() {
   this->setProperty("OutputDataWorkspace", outputDataWS);
 
   m_numExptInfos = outputDataWS->getNumExperimentInfo();
-  // loop over all experiment infos
+  m_detectorValuesSource = nullptr;
+  cacheDimensionXValues();
+
+  // Check for other dimensions if we could measure anything in the original
+  // data
+  std::vector<bool> skipNormalization(m_numExptInfos, false);
+  std::vector<std::vector<coord_t>> otherValues;
   for (uint16_t expInfoIndex = 0; expInfoIndex < m_numExptInfos;
        expInfoIndex++) {
-    // Check for other dimensions if we could measure anything in the original
-    // data
-    bool skipNormalization = false;
-    const std::vector<coord_t> otherValues =
-        getValuesFromOtherDimensions(skipNormalization, expInfoIndex);
+    bool skip = false;
+    otherValues.emplace_back(getValuesFromOtherDimensions(skip, expInfoIndex));
+    skipNormalization[expInfoIndex] = skip;
+  }
 
-    cacheDimensionXValues();
+  // Normalization of this input alone, starting from that of the runs
+  // normalized by a previous call, if any
+  std::vector<signal_t> normalization(m_normWS->getNPoints(), 0.);
+  std::vector<bool> cached(m_numExptInfos, false);
+  const bool useCache = getProperty("UseNormalizationCache");
+  std::string setupKey;
+  std::vector<std::string> runKeys;
+  if (useCache) {
+    setupKey = normalizationSetupKey();
+    for (uint16_t expInfoIndex = 0; expInfoIndex < m_numExptInfos;
+         expInfoIndex++)
+      runKeys.emplace_back(
+          normalizationRunKey(expInfoIndex, otherValues[expInfoIndex]));
+    if (MDNormCache::instance().lookup(setupKey, runKeys, normalization,
+                                       cached))
+      g_log.information()
+          << "Reusing the normalization of "
+          << std::count(cached.cbegin(), cached.cend(), true) << " of "
+          << m_numExptInfos << " runs\n";
+  }
 
-    if (!skipNormalization) {
+  // loop over all experiment infos
+  for (uint16_t expInfoIndex = 0; expInfoIndex < m_numExptInfos;
+       expInfoIndex++) {
+    if (cached[expInfoIndex])
+      continue;
+    if (!skipNormalization[expInfoIndex]) {
+      cacheDetectorValues(expInfoIndex);
       size_t symmOpsIndex = 0;
       for (const auto &so : symmetryOps) {
-        calculateNormalization(otherValues, so, expInfoIndex, symmOpsIndex);
+        calculateNormalization(otherValues[expInfoIndex], so, expInfoIndex,
+                               symmOpsIndex, normalization);
         symmOpsIndex++;
       }
 
@@ -498,9 +563,13 @@ void MDNorm::exec() {
       g_log.warning("Binning limits are outside the limits of the MDWorkspace. "
                     "Not applying normalization.");
     }
-    // if more than one experiment info, keep accumulating
-    m_accumulate = true;
   }
+  std::transform(normalization.cbegin(), normalization.cend(),
+                 m_normWS->getSignalArray(), m_normWS->mutableSignalArray(),
+                 std::plus<signal_t>());
+  if (useCache)
+    MDNormCache::instance().store(setupKey, std::move(runKeys),
+                                  std::move(normalization));
 
   IAlgorithm_sptr divideMD = createChildAlgorithm("DivideMD", 0.99, 1.);
   divideMD->setProperty("LHSWorkspace", outputDataWS);
@@ -731,8 +800,6 @@ void MDNorm::createNormalizationWS(
   if (!m_normWS) {
     m_normWS = dataWS.clone();
     m_normWS->setTo(0., 0., 0.);
-  } else {
-    m_accumulate = true;
   }
 }
 
@@ -1137,16 +1204,144 @@ void MDNorm::cacheDimensionXValues() {
 }
 
 /**
- * Computed the normalization for the input workspace. Results are stored in
- * m_normWS
+ * Stores the angles, solid angle and flux spectrum of every detector of an
+ * experiment info, which do not change with the symmetry operation. They are
+ * kept for the next experiment info if its detectors are the same.
+ * @param expInfoIndex - current experiment info index
+ */
+void MDNorm::cacheDetectorValues(uint16_t expInfoIndex) {
+  const auto &exptInfo = *(m_inputWS->getExperimentInfo(expInfoIndex));
+  const auto &detectorInfo = exptInfo.detectorInfo();
+  const auto &spectrumInfo = exptInfo.spectrumInfo();
+  if (m_detectorValuesSource &&
+      m_detectorValues.size() == spectrumInfo.size() &&
+      detectorInfo.isEquivalent(*m_detectorValuesSource)) {
+    m_detectorValuesSource = &detectorInfo;
+    return;
+  }
+
+  API::MatrixWorkspace_const_sptr solidAngleWS =
+      getProperty("SolidAngleWorkspace");
+  API::MatrixWorkspace_const_sptr integrFlux = getProperty("FluxWorkspace");
+  const detid2index_map solidAngDetToIdx =
+      (solidAngleWS) ? solidAngleWS->getDetectorIDToWorkspaceIndexMap()
+                     : detid2index_map();
+  const detid2index_map fluxDetToIdx =
+      (m_diffraction) ? integrFlux->getDetectorIDToWorkspaceIndexMap()
+                      : detid2index_map();
+
+  m_detectorValues.assign(spectrumInfo.size(),
+                          DetectorValues{0., 0., 1., 0, false});
+  const auto ndets = static_cast<int64_t>(spectrumInfo.size());
+  const bool safe = !solidAngleWS || Kernel::threadSafe(*solidAngleWS);
+  PARALLEL_FOR_IF(safe)
+  for (int64_t i = 0; i < ndets; i++) {
+    if (!spectrumInfo.hasDetectors(i) || spectrumInfo.isMonitor(i) ||
+        spectrumInfo.isMasked(i)) {
+      continue;
+    }
+    auto &values = m_detectorValues[i];
+    const auto &detector = spectrumInfo.detector(i);
+    // If the detector is a group, this should be the ID of the first detector
+    const auto detID = detector.getID();
+    if (m_diffraction) {
+      auto index = fluxDetToIdx.find(detID);
+      if (index == fluxDetToIdx.end()) {
+        // masked detector in flux, but not in input workspace
+        continue;
+      }
+      values.fluxIndex = index->second;
+    }
+    if (solidAngleWS) {
+      auto index = solidAngDetToIdx.find(detID);
+      if (index == solidAngDetToIdx.end())
+        continue;
+      values.solidAngle = solidAngleWS->y(index->second)[0];
+    }
+    values.theta = detector.getTwoTheta(m_samplePos, m_beamDir);
+    values.phi = detector.getPhi();
+    values.used = true;
+  }
+  m_detectorValuesSource = &detectorInfo;
+}
+
+/**
+ * Key of everything the normalization depends on apart from the runs, to find
+ * it in the normalization cache
+ * @return the SHA-1 of the binning, projections, symmetry operations, solid
+ * angle and flux workspaces
+ */
+std::string MDNorm::normalizationSetupKey() const {
+  std::ostringstream setup;
+  setup.precision(17);
+  for (const auto &name : {"RLU", "QDimension0", "QDimension1", "QDimension2",
+                           "SymmetryOperations"})
+    setup << name << '=' << getPropertyValue(name) << '\n';
+  for (size_t i = 0; i < 6; i++) {
+    const std::string dimension = "Dimension" + Strings::toString(i);
+    setup << getPropertyValue(dimension + "Name") << ':'
+          << getPropertyValue(dimension + "Binning") << '\n';
+  }
+  for (size_t i = 0; i < m_inputWS->getNumDims(); i++)
+    setup << m_inputWS->getDimension(i)->getName() << '\n';
+  for (size_t i = 0; i < m_normWS->getNumDims(); i++) {
+    const auto dimension = m_normWS->getDimension(i);
+    setup << dimension->getName() << ':' << dimension->getMinimum() << ':'
+          << dimension->getMaximum() << ':' << dimension->getNBins() << '\n';
+  }
+  setup << convention << '\n' << m_diffraction << ' ' << m_Ei << '\n'
+        << m_UB << m_W << m_samplePos << m_beamDir << '\n';
+
+  std::string buffer = setup.str();
+  appendWorkspace(buffer, getProperty("SolidAngleWorkspace"));
+  appendWorkspace(buffer, getProperty("FluxWorkspace"));
+  return Kernel::ChecksumHelper::sha1FromString(buffer);
+}
+
+/**
+ * Key of one run, to find its normalization in the normalization cache
+ * @param expInfoIndex - experiment info index of the run
+ * @param otherValues - values for dimensions other than Q or DeltaE
+ * @return the SHA-1 of the goniometer, trajectory extents, proton charge and
+ * detector positions of the run
+ */
+std::string MDNorm::normalizationRunKey(
+    uint16_t expInfoIndex, const std::vector<coord_t> &otherValues) const {
+  const auto &exptInfo = *(m_inputWS->getExperimentInfo(expInfoIndex));
+  std::string buffer;
+  const auto &goniometer = exptInfo.run().getGoniometerMatrix().getVector();
+  appendBytes(buffer, goniometer.data(), goniometer.size());
+  const double protonCharge = exptInfo.run().getProtonCharge();
+  appendBytes(buffer, &protonCharge, 1);
+  appendBytes(buffer, otherValues.data(), otherValues.size());
+  for (const auto &name : {"MDNorm_low", "MDNorm_high"}) {
+    const auto *log =
+        dynamic_cast<VectorDoubleProperty *>(exptInfo.getLog(name));
+    const std::vector<double> &values = (*log)();
+    appendBytes(buffer, values.data(), values.size());
+  }
+  const auto &detectorInfo = exptInfo.detectorInfo();
+  for (size_t i = 0; i < detectorInfo.size(); ++i) {
+    const auto position = detectorInfo.position(i);
+    const double values[] = {position.X(), position.Y(), position.Z(),
+                             detectorInfo.isMasked(i) ? 1. : 0.};
+    appendBytes(buffer, values, 4);
+  }
+  return Kernel::ChecksumHelper::sha1FromString(buffer);
+}
+
+/**
+ * Computed the normalization for the input workspace
  * @param otherValues - values for dimensions other than Q or DeltaE
  * @param so - symmetry operation
  * @param expInfoIndex - current experiment info index
  * @param soIndex - the index of symmetry operation (for progress purposes)
+ * @param normalization - the normalization signal, added to
  */
 void MDNorm::calculateNormalization(const std::vector<coord_t> &otherValues,
                                     const Geometry::SymmetryOperation &so,
-                                    uint16_t expInfoIndex, size_t soIndex) {
+                                    uint16_t expInfoIndex, size_t soIndex,
+                                    std::vector<signal_t> &normalization) {
   const auto &currentExptInfo = *(m_inputWS->getExperimentInfo(expInfoIndex));
   std::vector<double> lowValues, highValues;
   auto *lowValuesLog = dynamic_cast<VectorDoubleProperty *>(
@@ -1168,26 +1363,13 @@ void MDNorm::calculateNormalization(const std::vector<coord_t> &otherValues,
   DblMatrix Qtransform = R * m_UB * soMatrix * m_W;
   Qtransform.Invert();
   const double protonCharge = currentExptInfo.run().getProtonCharge();
-  const auto &spectrumInfo = currentExptInfo.spectrumInfo();
 
-  // Mappings
-  const auto ndets = static_cast<int64_t>(spectrumInfo.size());
-  bool haveSA = false;
-  API::MatrixWorkspace_const_sptr solidAngleWS =
-      getProperty("SolidAngleWorkspace");
+  const auto ndets = static_cast<int64_t>(m_detectorValues.size());
   API::MatrixWorkspace_const_sptr integrFlux = getProperty("FluxWorkspace");
-  if (solidAngleWS != nullptr) {
-    haveSA = true;
-  }
-  const detid2index_map solidAngDetToIdx =
-      (haveSA) ? solidAngleWS->getDetectorIDToWorkspaceIndexMap()
-               : detid2index_map();
-  const detid2index_map fluxDetToIdx =
-      (m_diffraction) ? integrFlux->getDetectorIDToWorkspaceIndexMap()
-                      : detid2index_map();
 
   const size_t vmdDims = (m_diffraction) ? 3 : 4;
-  std::vector<std::atomic<signal_t>> signalArray(m_normWS->getNPoints());
+  MDNormAccumulator signalArray(m_normWS->getNPoints(),
+                                PARALLEL_GET_MAX_THREADS);
   std::vector<std::array<double, 4>> intersections;
   std::vector<double> xValues, yValues;
   std::vector<coord_t> pos, posNew;
@@ -1206,39 +1388,21 @@ PRAGMA_OMP(parallel for private(intersections, xValues, yValues, pos, posNew) if
 for (int64_t i = 0; i < ndets; i++) {
   PARALLEL_START_INTERUPT_REGION
 
-  if (!spectrumInfo.hasDetectors(i) || spectrumInfo.isMonitor(i) ||
-      spectrumInfo.isMasked(i)) {
+  const auto &detectorValues = m_detectorValues[i];
+  if (!detectorValues.used) {
     continue;
   }
-
-  const auto &detector = spectrumInfo.detector(i);
-  double theta = detector.getTwoTheta(m_samplePos, m_beamDir);
-  double phi = detector.getPhi();
-  // If the dtefctor is a group, this should be the ID of the first detector
-  const auto detID = detector.getID();
-
   // get the flux spectrum number
-  size_t wsIdx = 0;
-  if (m_diffraction) {
-    auto index = fluxDetToIdx.find(detID);
-    if (index != fluxDetToIdx.end()) {
-      wsIdx = index->second;
-    } else { // masked detector in flux, but not in input workspace
-      continue;
-    }
-  }
+  const size_t wsIdx = detectorValues.fluxIndex;
 
   // Intersections
-  this->calculateIntersections(intersections, theta, phi, Qtransform,
-                               lowValues[i], highValues[i]);
+  this->calculateIntersections(intersections, detectorValues.theta,
+                               detectorValues.phi, Qtransform, lowValues[i],
+                               highValues[i]);
   if (intersections.empty())
     continue;
   // Get solid angle for this contribution
-  double solid = protonCharge;
-  if (haveSA) {
-    solid =
-        solidAngleWS->y(solidAngDetToIdx.find(detID)->second)[0] * protonCharge;
-  }
+  const double solid = detectorValues.solidAngle * protonCharge;
   if (m_diffraction) {
     // -- calculate integrals for the intersection --
     // momentum values at intersections
@@ -1300,8 +1464,7 @@ for (int64_t i = 0; i < ndets; i++) {
     size_t linIndex = m_normWS->getLinearIndexAtCoord(posNew.data());
     if (linIndex == size_t(-1))
       continue;
-    Mantid::Kernel::AtomicOp(signalArray[linIndex], signal,
-                             std::plus<signal_t>());
+    signalArray.add(PARALLEL_THREAD_NUMBER, linIndex, signal);
   }
 
   prog->report();
@@ -1309,16 +1472,7 @@ for (int64_t i = 0; i < ndets; i++) {
   PARALLEL_END_INTERUPT_REGION
 }
 PARALLEL_CHECK_INTERUPT_REGION
-if (m_accumulate) {
-  std::transform(
-      signalArray.cbegin(), signalArray.cend(), m_normWS->getSignalArray(),
-      m_normWS->mutableSignalArray(),
-      [](const std::atomic<signal_t> &a, const signal_t &b) { return a + b; });
-} else {
-  std::copy(signalArray.cbegin(), signalArray.cend(),
-            m_normWS->mutableSignalArray());
-}
-m_accumulate = true;
+signalArray.addTo(normalization.data());
 }
 
 /**
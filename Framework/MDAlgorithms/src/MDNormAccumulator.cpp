@@ -0,0 +1,115 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidMDAlgorithms/MDNormAccumulator.h"
+
+#include <algorithm>
+
+namespace Mantid {
+namespace MDAlgorithms {
+
+namespace {
+/// Number of elements summed by one thread when merging
+constexpr int64_t MERGE_BLOCK_SIZE = 1 << 14;
+} // namespace
+
+/** Constructor
+ * @param size :: number of elements of the signal array
+ * @param numThreads :: number of threads that may add contributions
+ * @param strategy :: how to sum the contributions; Automatic chooses from the
+ * size of the array and the number of threads
+ */
+MDNormAccumulator::MDNormAccumulator(const size_t size, const int numThreads,
+                                     const Strategy strategy)
+    : m_size(size), m_strategy(strategy == Strategy::Automatic
+                                   ? chooseStrategy(size, numThreads)
+                                   : strategy),
+      m_perThread(std::max(numThreads, 1)), m_tileShift(0) {
+  switch (m_strategy) {
+  case Strategy::Atomic:
+    m_atomic = std::vector<std::atomic<signal_t>>(size);
+    break;
+  case Strategy::Tiled: {
+    // Tiles of a power of two elements, so finding them is a shift
+    while ((size_t{1} << m_tileShift) * MAX_TILES < size)
+      ++m_tileShift;
+    const size_t numTiles =
+        (size + (size_t{1} << m_tileShift) - 1) >> m_tileShift;
+    m_tiled.resize(size, 0.);
+    m_tileLocks = std::vector<std::mutex>(numTiles);
+    for (auto &storage : m_perThread)
+      storage.buffers.resize(numTiles);
+    break;
+  }
+  default:
+    // The copies are allocated by the threads that use them
+    break;
+  }
+}
+
+/** Choose how to sum the contributions
+ * @param size :: number of elements of the signal array
+ * @param numThreads :: number of threads that may add contributions
+ * @return PerThread if a copy of the array for every thread is small enough,
+ * otherwise Tiled
+ */
+MDNormAccumulator::Strategy
+MDNormAccumulator::chooseStrategy(const size_t size, const int numThreads) {
+  if (numThreads <= 1 ||
+      size * static_cast<size_t>(numThreads) <= PER_THREAD_LIMIT)
+    return Strategy::PerThread;
+  return Strategy::Tiled;
+}
+
+/** Add the buffered contributions of one thread to a tile of the shared
+ * array, under the lock of the tile, and empty the buffer
+ * @param tile :: the index of the tile
+ * @param buffer :: the contributions to the tile
+ */
+void MDNormAccumulator::flush(const size_t tile, Buffer &buffer) {
+  std::lock_guard<std::mutex> lock(m_tileLocks[tile]);
+  for (const auto &contribution : buffer)
+    m_tiled[contribution.first] += contribution.second;
+  buffer.clear();
+}
+
+/** Add the sums to an array. Must not be called while contributions are
+ * being added.
+ * @param output :: the array, of the size given to the constructor
+ */
+void MDNormAccumulator::addTo(signal_t *output) {
+  const auto size = static_cast<int64_t>(m_size);
+  switch (m_strategy) {
+  case Strategy::PerThread: {
+    std::vector<const signal_t *> copies;
+    for (const auto &storage : m_perThread)
+      if (!storage.sums.empty())
+        copies.emplace_back(storage.sums.data());
+    PARALLEL_FOR_NO_WSP_CHECK()
+    for (int64_t start = 0; start < size; start += MERGE_BLOCK_SIZE) {
+      const int64_t end = std::min(start + MERGE_BLOCK_SIZE, size);
+      for (const auto *copy : copies)
+        for (int64_t i = start; i < end; ++i)
+          output[i] += copy[i];
+    }
+    break;
+  }
+  case Strategy::Tiled:
+    for (auto &storage : m_perThread)
+      for (size_t tile = 0; tile < storage.buffers.size(); ++tile)
+        flush(tile, storage.buffers[tile]);
+    std::transform(m_tiled.cbegin(), m_tiled.cend(), output, output,
+                   std::plus<signal_t>());
+    break;
+  default:
+    std::transform(m_atomic.cbegin(), m_atomic.cend(), output, output,
+                   [](const std::atomic<signal_t> &sum,
+                      const signal_t value) { return sum + value; });
+  }
+}
+
+} // namespace MDAlgorithms
+} // namespace Mantid
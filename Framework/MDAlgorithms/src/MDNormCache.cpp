@@ -0,0 +1,96 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidMDAlgorithms/MDNormCache.h"
+
+#include <algorithm>
+#include <map>
+
+namespace Mantid {
+namespace MDAlgorithms {
+
+/** Constructor
+ * @param maxEntries :: largest number of entries kept
+ */
+MDNormCache::MDNormCache(const size_t maxEntries)
+    : m_maxEntries(std::max(maxEntries, size_t{1})) {}
+
+/// The cache shared by all MDNorm calls
+MDNormCache &MDNormCache::instance() {
+  static MDNormCache cache;
+  return cache;
+}
+
+/** Find the normalization of some of the runs
+ * @param setup :: key of everything the normalization depends on apart from
+ * the runs
+ * @param runs :: keys of the runs to normalize
+ * @param normalization :: [out] the sum of the normalizations of the cached
+ * runs, if they are found
+ * @param cached :: [out] for each run, whether it is in the normalization
+ * @return true if an entry holding only some of the runs was found
+ */
+bool MDNormCache::lookup(const std::string &setup,
+                         const std::vector<std::string> &runs,
+                         std::vector<signal_t> &normalization,
+                         std::vector<bool> &cached) {
+  cached.assign(runs.size(), false);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const auto entry =
+      std::find_if(m_entries.begin(), m_entries.end(),
+                   [&setup](const Entry &e) { return e.setup == setup; });
+  if (entry == m_entries.end())
+    return false;
+
+  // Match every cached run to a run of the input
+  std::map<std::string, std::vector<size_t>> unmatched;
+  for (size_t i = runs.size(); i > 0; --i)
+    unmatched[runs[i - 1]].emplace_back(i - 1);
+  for (const auto &run : entry->runs) {
+    auto &indices = unmatched[run];
+    if (indices.empty()) {
+      cached.assign(runs.size(), false);
+      return false;
+    }
+    cached[indices.back()] = true;
+    indices.pop_back();
+  }
+  normalization = entry->normalization;
+  m_entries.splice(m_entries.begin(), m_entries, entry);
+  return true;
+}
+
+/** Keep the normalization of some runs, replacing any entry with the same
+ * setup
+ * @param setup :: key of everything the normalization depends on apart from
+ * the runs
+ * @param runs :: keys of the runs in the normalization
+ * @param normalization :: the sum of the normalizations of the runs
+ */
+void MDNormCache::store(const std::string &setup,
+                        std::vector<std::string> runs,
+                        std::vector<signal_t> normalization) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.remove_if([&setup](const Entry &e) { return e.setup == setup; });
+  m_entries.push_front({setup, std::move(runs), std::move(normalization)});
+  while (m_entries.size() > m_maxEntries)
+    m_entries.pop_back();
+}
+
+/// Drop all entries
+void MDNormCache::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+}
+
+/// Number of entries
+size_t MDNormCache::size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_entries.size();
+}
+
+} // namespace MDAlgorithms
+} // namespace Mantid
@@ -5,6 +5,7 @@
 //   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
 // SPDX - License - Identifier: GPL - 3.0 +
 #include "MantidMDAlgorithms/MDNormDirectSC.h"
+#include "MantidMDAlgorithms/MDNormAccumulator.h"
 
 #include "MantidAPI/CommonBinsValidator.h"
 #include "MantidAPI/InstrumentValidator.h"
@@ -494,7 +495,8 @@ void MDNormDirectSC::calculateNormalization(
   }
 
   const size_t vmdDims = 4;
-  std::vector<std::atomic<signal_t>> signalArray(m_normWS->getNPoints());
+  MDNormAccumulator signalArray(m_normWS->getNPoints(),
+                                PARALLEL_GET_MAX_THREADS);
   std::vector<std::array<double, 4>> intersections;
   std::vector<coord_t> pos, posNew;
   double progStep = 0.7 / m_numExptInfos;
@@ -560,23 +562,17 @@ for (int64_t i = 0; i < ndets; i++) {
     // signal = integral between two consecutive intersections *solid angle
     // *PC
     double signal = solid * delta;
-    Mantid::Kernel::AtomicOp(signalArray[linIndex], signal,
-                             std::plus<signal_t>());
+    signalArray.add(PARALLEL_THREAD_NUMBER, linIndex, signal);
   }
   prog->report();
 
   PARALLEL_END_INTERUPT_REGION
 }
 PARALLEL_CHECK_INTERUPT_REGION
-if (m_accumulate) {
-  std::transform(
-      signalArray.cbegin(), signalArray.cend(), m_normWS->getSignalArray(),
-      m_normWS->mutableSignalArray(),
-      [](const std::atomic<signal_t> &a, const signal_t &b) { return a + b; });
-} else {
-  std::copy(signalArray.cbegin(), signalArray.cend(),
-            m_normWS->mutableSignalArray());
+if (!m_accumulate) {
+  std::fill_n(m_normWS->mutableSignalArray(), m_normWS->getNPoints(), 0.);
 }
+signalArray.addTo(m_normWS->mutableSignalArray());
 }
 
 /**
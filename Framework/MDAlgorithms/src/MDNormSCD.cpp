@@ -5,6 +5,7 @@
 //   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
 // SPDX - License - Identifier: GPL - 3.0 +
 #include "MantidMDAlgorithms/MDNormSCD.h"
+#include "MantidMDAlgorithms/MDNormAccumulator.h"
 
 #include "MantidAPI/CommonBinsValidator.h"
 #include "MantidAPI/InstrumentValidator.h"
@@ -442,7 +443,8 @@ void MDNormSCD::calculateNormalization(
       solidAngleWS->getDetectorIDToWorkspaceIndexMap();
 
   const size_t vmdDims = 4;
-  std::vector<std::atomic<signal_t>> signalArray(m_normWS->getNPoints());
+  MDNormAccumulator signalArray(m_normWS->getNPoints(),
+                                PARALLEL_GET_MAX_THREADS);
   std::vector<std::array<double, 4>> intersections;
   std::vector<double> xValues, yValues;
   std::vector<coord_t> pos, posNew;
@@ -520,23 +522,17 @@ for (int64_t i = 0; i < ndets; i++) {
     auto k = static_cast<size_t>(std::distance(intersectionsBegin, it));
     // signal = integral between two consecutive intersections
     signal_t signal = (yValues[k] - yValues[k - 1]) * solid;
-    Mantid::Kernel::AtomicOp(signalArray[linIndex], signal,
-                             std::plus<signal_t>());
+    signalArray.add(PARALLEL_THREAD_NUMBER, linIndex, signal);
   }
   prog->report();
 
   PARALLEL_END_INTERUPT_REGION
 }
 PARALLEL_CHECK_INTERUPT_REGION
-if (m_accumulate) {
-  std::transform(
-      signalArray.cbegin(), signalArray.cend(), m_normWS->getSignalArray(),
-      m_normWS->mutableSignalArray(),
-      [](const std::atomic<signal_t> &a, const signal_t &b) { return a + b; });
-} else {
-  std::copy(signalArray.cbegin(), signalArray.cend(),
-            m_normWS->mutableSignalArray());
+if (!m_accumulate) {
+  std::fill_n(m_normWS->mutableSignalArray(), m_normWS->getNPoints(), 0.);
 }
+signalArray.addTo(m_normWS->mutableSignalArray());
 }
 
 /**
@@ -226,31 +226,53 @@ void MergeMD::doPlus(typename MDEventWorkspace<MDE, nd>::sptr ws2) {
   // workspace
   std::vector<API::IMDNode *> boxes;
   box2->getBoxes(boxes, 1000, true);
-  auto numBoxes = int(boxes.size());
-
-  bool fileBasedSource(false);
-  if (ws2->isFileBacked())
-    fileBasedSource = true;
+  const size_t numBoxes = boxes.size();
+
+  const bool fileBasedSource = ws2->isFileBacked();
+
+  // The events go to the children of the top box of the output. Each thread
+  // sorts the events it copies into one bucket per child; the buckets of a
+  // child are then added to it by a single thread, without locking.
+  auto *grid1 = dynamic_cast<MDGridBox<MDE, nd> *>(box1);
+  const size_t numChildren = grid1 ? grid1->getNumChildren() : 1;
+  std::vector<std::vector<std::vector<MDE>>> buckets(
+      PARALLEL_GET_MAX_THREADS, std::vector<std::vector<MDE>>(numChildren));
+
+  // The boxes are copied in batches of about MERGE_BATCH_EVENTS events, so a
+  // file-backed input is never copied to memory at once.
+  size_t first = 0;
+  while (first < numBoxes) {
+    size_t last = first;
+    uint64_t batchEvents = 0;
+    while (last < numBoxes &&
+           (last == first ||
+            batchEvents + boxes[last]->getNPoints() <= MERGE_BATCH_EVENTS)) {
+      batchEvents += boxes[last]->getNPoints();
+      ++last;
+    }
 
-  // Add the boxes in parallel. They should be spread out enough on each
-  // core to avoid stepping on each other.
-  // cppcheck-suppress syntaxError
-    PRAGMA_OMP( parallel for if (!ws2->isFileBacked()) )
-    for (int i = 0; i < numBoxes; i++) {
+    const auto batchStart = static_cast<int64_t>(first);
+    const auto batchEnd = static_cast<int64_t>(last);
+    PRAGMA_OMP(parallel for schedule(dynamic) if (!fileBasedSource))
+    for (int64_t i = batchStart; i < batchEnd; i++) {
       PARALLEL_START_INTERUPT_REGION
       auto *box = dynamic_cast<MDBox<MDE, nd> *>(boxes[i]);
       if (box && !box->getIsMasked()) {
+        auto &threadBuckets = buckets[PARALLEL_THREAD_NUMBER];
         // Copy the events from WS2 and add them into WS1
         const std::vector<MDE> &events = box->getConstEvents();
-        // Add events, with bounds checking
-
         for (auto it = events.cbegin(); it != events.cend(); ++it) {
           // Create the event
           MDE newEvent(it->getSignal(), it->getErrorSquared(), it->getCenter());
           // Copy extra data, if any
           copyEvent(*it, newEvent, runIndexOffset);
-          // Add it to the workspace
-          box1->addEvent(newEvent);
+          size_t child = grid1 ? grid1->calculateChildIndex(newEvent) : 0;
+          // As in MDGridBox::addEvent, events on the upper boundary go to the
+          // last child and events beyond it are dropped
+          if (child == numChildren)
+            child = numChildren - 1;
+          if (child < numChildren)
+            threadBuckets[child].emplace_back(newEvent);
         }
         if (fileBasedSource)
           box->clear();
@@ -261,6 +283,25 @@ void MergeMD::doPlus(typename MDEventWorkspace<MDE, nd>::sptr ws2) {
     }
     PARALLEL_CHECK_INTERUPT_REGION
 
+    const auto nChildren = static_cast<int64_t>(numChildren);
+    PRAGMA_OMP(parallel for schedule(dynamic))
+    for (int64_t child = 0; child < nChildren; child++) {
+      PARALLEL_START_INTERUPT_REGION
+      auto *target = grid1 ? dynamic_cast<MDBoxBase<MDE, nd> *>(
+                                 grid1->getChild(static_cast<size_t>(child)))
+                           : box1;
+      for (auto &threadBuckets : buckets) {
+        auto &bucket = threadBuckets[child];
+        target->addEventsUnsafe(bucket);
+        bucket.clear();
+      }
+      PARALLEL_END_INTERUPT_REGION
+    }
+    PARALLEL_CHECK_INTERUPT_REGION
+
+    first = last;
+  }
+
     // Progress * prog2 = new Progress(this, 0.4, 0.9, 100);
     Progress *prog2 = nullptr;
     ThreadScheduler *ts = new ThreadSchedulerFIFO();
@@ -131,16 +131,22 @@ void MergeMDFiles::loadBoxData() {
   }
 
   const std::vector<int> &boxType = m_BoxStruct.getBoxType();
-  // calculate event positions in the target file.
-  uint64_t eventsStart = 0;
+  // The boxes are merged, and their events placed in the target file, in the
+  // Morton order of their centres, so the target file is written in sequence
+  // and the boxes merged together are close to each other in space.
+  m_mergeOrder.clear();
   for (auto mdBox : Boxes) {
     mdBox->clear();
-    size_t ID = mdBox->getID();
-
     // avoid grid boxes;
-    if (boxType[ID] == 2)
-      continue;
+    if (boxType[mdBox->getID()] != 2)
+      m_mergeOrder.emplace_back(mdBox);
+  }
+  m_BoxStruct.sortByMortonOrder(m_mergeOrder);
 
+  // calculate event positions in the target file.
+  uint64_t eventsStart = 0;
+  for (auto mdBox : m_mergeOrder) {
+    size_t ID = mdBox->getID();
     uint64_t nEvents = targetEventIndexes[2 * ID + 1];
     targetEventIndexes[ID * 2] = eventsStart;
     if (m_fileBasedTargetWS)
@@ -172,18 +178,28 @@ uint64_t MergeMDFiles::loadEventsFromSubBoxes(API::IMDNode *TargetBox) {
     nBoxEvents += numFileEvents[iw];
   }
 
-  // At this point memory required is known, so it is reserved all in one go
-  TargetBox->reserveMemoryForLoad(nBoxEvents);
-
-  for (size_t iw = 0; iw < this->m_EventLoader.size(); iw++) {
-    size_t ID = TargetBox->getID();
-    uint64_t fileLocation =
-        m_fileComponentsStructure[iw].getEventIndex()[2 * ID + 0];
-    if (numFileEvents[iw] == 0)
-      continue;
-    TargetBox->loadAndAddFrom(m_EventLoader[iw], fileLocation,
-                              numFileEvents[iw]);
+  // The HDF5 library is not thread-safe, even for different files, so the
+  // events of all the files are read under one lock. They are converted and
+  // added to the box outside of it, in parallel with the reads of other boxes.
+  std::vector<coord_t> eventsData;
+  {
+    std::lock_guard<std::mutex> lock(m_fileMutex);
+    std::vector<coord_t> block;
+    for (size_t iw = 0; iw < this->m_EventLoader.size(); iw++) {
+      size_t ID = TargetBox->getID();
+      uint64_t fileLocation =
+          m_fileComponentsStructure[iw].getEventIndex()[2 * ID + 0];
+      if (numFileEvents[iw] == 0)
+        continue;
+      m_EventLoader[iw]->loadBlock(block, fileLocation, numFileEvents[iw]);
+      if (eventsData.empty())
+        eventsData.swap(block);
+      else
+        eventsData.insert(eventsData.end(), block.cbegin(), block.cend());
+    }
   }
+  if (!eventsData.empty())
+    TargetBox->setEventsData(eventsData);
 
   return nBoxEvents;
 }
@@ -203,9 +219,6 @@ void MergeMDFiles::doExecByCloning(
   m_OutIWS = ws;
   m_MDEventType = ws->getEventTypeName();
 
-  // Run the tasks in parallel? TODO: enable
-  // bool Parallel = this->getProperty("Parallel");
-
   // Fix the box controller settings in the output workspace so that it splits
   // normally
   BoxController_sptr bc = ws->getBoxController();
@@ -236,70 +249,69 @@ void MergeMDFiles::doExecByCloning(
   // positions of the target workspace
   this->loadBoxData();
 
-  size_t numBoxes = m_BoxStruct.getNBoxes();
-  // Progress report based on events processed.
-  m_progress = std::make_unique<Progress>(this, 0.1, 0.9, size_t(numBoxes));
+  const size_t numBoxes = m_mergeOrder.size();
+  // Progress report based on boxes processed.
+  m_progress = std::make_unique<Progress>(this, 0.1, 0.9, numBoxes);
   m_progress->setNotifyStep(0.1);
 
-  // For tracking progress
-  // uint64_t m_totalEventsInTasks = 0;
-
-  // Prepare thread pool
   CPUTimer overallTime;
 
-  auto ts = new ThreadSchedulerFIFO();
-  ThreadPool tp(ts);
-
   Kernel::DiskBuffer *DiskBuf(nullptr);
   if (m_fileBasedTargetWS) {
     DiskBuf = bc->getFileIO();
   }
 
+  // In parallel, the boxes are loaded in batches of about MERGE_BATCH_EVENTS
+  // events, each box by one thread. The files are read one box at a time,
+  // while the events of other boxes are converted. The boxes of a batch are
+  // then saved in order, which bounds the memory used and keeps the writes
+  // sequential.
+  const bool parallel = this->getProperty("Parallel");
+  const uint64_t batchLimit = parallel ? MERGE_BATCH_EVENTS : 0;
+  const auto &targetEventIndexes = m_BoxStruct.getEventIndex();
+
   this->m_totalLoaded = 0;
-  std::vector<API::IMDNode *> &boxes = m_BoxStruct.getBoxes();
-
-  for (size_t ib = 0; ib < numBoxes; ib++) {
-    auto box = boxes[ib];
-    if (!box->isBox())
-      continue;
-    // load all contributed events into current box;
-    this->loadEventsFromSubBoxes(boxes[ib]);
-
-    if (DiskBuf) {
-      if (box->getDataInMemorySize() >
-          0) { // data position has been already pre-calculated
+  size_t first = 0;
+  while (first < numBoxes) {
+    size_t last = first;
+    uint64_t batchEvents = 0;
+    while (last < numBoxes) {
+      const uint64_t nEvents =
+          targetEventIndexes[2 * m_mergeOrder[last]->getID() + 1];
+      if (last > first && batchEvents + nEvents > batchLimit)
+        break;
+      batchEvents += nEvents;
+      ++last;
+    }
+
+    const auto batchStart = static_cast<int64_t>(first);
+    const auto batchEnd = static_cast<int64_t>(last);
+    PRAGMA_OMP(parallel for schedule(dynamic) if (batchEnd - batchStart > 1))
+    for (int64_t ib = batchStart; ib < batchEnd; ++ib) {
+      PARALLEL_START_INTERUPT_REGION
+      // load all contributed events into current box;
+      const uint64_t nLoaded = this->loadEventsFromSubBoxes(m_mergeOrder[ib]);
+      std::lock_guard<std::mutex> lock(m_statsMutex);
+      m_totalLoaded += nLoaded;
+      PARALLEL_END_INTERUPT_REGION
+    }
+    PARALLEL_CHECK_INTERUPT_REGION
+
+    for (size_t ib = first; ib < last; ++ib) {
+      auto box = m_mergeOrder[ib];
+      // data position has been already pre-calculated
+      if (DiskBuf && box->getDataInMemorySize() > 0) {
         box->getISaveable()->save();
         box->clearDataFromMemory();
-        // Kernel::ISaveable *Saver = box->getISaveable();
-        // DiskBuf->toWrite(Saver);
       }
+      m_progress->report("Loading and merging box data");
     }
-    // else
-    //{   size_t ID = box->getID();
-    //    uint64_t filePosition = targetEventIndexes[2*ID];
-    //    box->saveAt(saver.get(), filePosition);
-    //}
-    //
-    // if (!Parallel)
-    //{
-    //  // Run the task serially only
-    //  task->run();
-    //  delete task;
-    //}
-    // else
-    //{
-    //  // Enqueue to run in parallel (at the joinAll() call below).
-    //  ts->push(task);
-    //}
-
-    m_progress->reportIncrement(ib, "Loading and merging box data");
+    first = last;
   }
   if (DiskBuf) {
     DiskBuf->flushCache();
     bc->getFileIO()->flushData();
   }
-  //// Run any final tasks
-  // tp.joinAll();
   g_log.information() << overallTime << " to do all the adding.\n";
 
   // Close any open file handle
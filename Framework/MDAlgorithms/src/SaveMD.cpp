@@ -10,6 +10,7 @@
 #include "MantidAPI/IMDEventWorkspace.h"
 #include "MantidAPI/Progress.h"
 #include "MantidAPI/WorkspaceHistory.h"
+#include "MantidDataObjects/BoxControllerCompressedIO.h"
 #include "MantidDataObjects/BoxControllerNeXusIO.h"
 #include "MantidDataObjects/MDBox.h"
 #include "MantidDataObjects/MDBoxFlatTree.h"
@@ -23,6 +24,9 @@
 #include "MantidKernel/System.h"
 #include <Poco/File.h>
 
+#include <algorithm>
+#include <numeric>
+
 using file_holder_type = std::unique_ptr<::NeXus::File>;
 
 using namespace Mantid::Kernel;
@@ -41,6 +45,18 @@ void prepareUpdate(MDBoxFlatTree &BoxFlatStruct, BoxController *bc,
   // box structure
   BoxFlatStruct.initFlatStructure(ws, filename);
 }
+
+/// Indices of the boxes of a flat box structure in the order of their
+/// positions in the file, so they are written sequentially
+std::vector<size_t> boxesInFileOrder(const std::vector<uint64_t> &eventIndex) {
+  std::vector<size_t> order(eventIndex.size() / 2);
+  std::iota(order.begin(), order.end(), size_t{0});
+  std::stable_sort(order.begin(), order.end(),
+                   [&eventIndex](const size_t a, const size_t b) {
+                     return eventIndex[2 * a] < eventIndex[2 * b];
+                   });
+  return order;
+}
 } // namespace
 
 namespace Mantid {
@@ -82,6 +98,15 @@ void SaveMD::init() {
   setPropertySettings("MakeFileBacked",
                       std::make_unique<EnabledWhenProperty>("UpdateFileBackEnd",
                                                             IS_EQUAL_TO, "0"));
+
+  declareProperty("CompressEvents", false,
+                  "For an MDEventWorkspace that was created in memory:\n"
+                  "Store the events compressed, box by box, with the boxes "
+                  "ordered so that boxes close in space are close in the "
+                  "file.");
+  setPropertySettings("CompressEvents",
+                      std::make_unique<EnabledWhenProperty>("UpdateFileBackEnd",
+                                                            IS_EQUAL_TO, "0"));
 }
 
 //----------------------------------------------------------------------------------------------
@@ -95,6 +120,7 @@ template <typename MDE, size_t nd>
 void SaveMD::doSaveEvents(typename MDEventWorkspace<MDE, nd>::sptr ws) {
   bool updateFileBackend = getProperty("UpdateFileBackEnd");
   bool makeFileBackend = getProperty("MakeFileBacked");
+  bool compressEvents = getProperty("CompressEvents");
   if (updateFileBackend && makeFileBackend)
     throw std::invalid_argument(
         "Please choose either UpdateFileBackEnd or MakeFileBacked, not both.");
@@ -165,8 +191,12 @@ void SaveMD::doSaveEvents(typename MDEventWorkspace<MDE, nd>::sptr ws) {
     // the boxes file positions are unknown and we need to calculate it.
     BoxFlatStruct.initFlatStructure(ws, filename);
     // create saver class
-    auto Saver = std::shared_ptr<API::IBoxControllerIO>(
-        new DataObjects::BoxControllerNeXusIO(bc.get()));
+    std::shared_ptr<API::IBoxControllerIO> Saver;
+    if (compressEvents)
+      Saver =
+          std::make_shared<DataObjects::BoxControllerCompressedIO>(bc.get());
+    else
+      Saver = std::make_shared<DataObjects::BoxControllerNeXusIO>(bc.get());
     Saver->setDataType(sizeof(coord_t), MDE::getTypeName());
     if (makeFileBackend) {
       // store saver with box controller
@@ -175,9 +205,10 @@ void SaveMD::doSaveEvents(typename MDEventWorkspace<MDE, nd>::sptr ws) {
       std::vector<API::IMDNode *> &boxes = BoxFlatStruct.getBoxes();
       // calculate the position of the boxes on file, indicating to make them
       // saveable and that the boxes were not saved.
-      BoxFlatStruct.setBoxesFilePositions(true);
+      BoxFlatStruct.setBoxesFilePositions(true, compressEvents);
       prog->resetNumSteps(boxes.size(), 0.06, 0.90);
-      for (auto &boxe : boxes) {
+      for (const auto i : boxesInFileOrder(BoxFlatStruct.getEventIndex())) {
+        auto boxe = boxes[i];
         auto saveableTag = boxe->getISaveable();
         if (saveableTag) // only boxes can be saveable
         {
@@ -203,11 +234,11 @@ void SaveMD::doSaveEvents(typename MDEventWorkspace<MDE, nd>::sptr ws) {
     } else // just save data, and finish with it
     {
       Saver->openFile(filename, "w");
-      BoxFlatStruct.setBoxesFilePositions(false);
+      BoxFlatStruct.setBoxesFilePositions(false, compressEvents);
       std::vector<API::IMDNode *> &boxes = BoxFlatStruct.getBoxes();
       std::vector<uint64_t> &eventIndex = BoxFlatStruct.getEventIndex();
       prog->resetNumSteps(boxes.size(), 0.06, 0.90);
-      for (size_t i = 0; i < boxes.size(); i++) {
+      for (const auto i : boxesInFileOrder(eventIndex)) {
         if (eventIndex[2 * i + 1] == 0 || boxes[i]->getIsMasked())
           continue;
         boxes[i]->saveAt(Saver.get(), eventIndex[2 * i]);
@@ -70,6 +70,14 @@ void SaveMD2::init() {
   setPropertySettings("MakeFileBacked",
                       std::make_unique<EnabledWhenProperty>("UpdateFileBackEnd",
                                                             IS_EQUAL_TO, "0"));
+  declareProperty("CompressEvents", false,
+                  "For an MDEventWorkspace that was created in memory:\n"
+                  "Store the events compressed, box by box, with the boxes "
+                  "ordered so that boxes close in space are close in the "
+                  "file.");
+  setPropertySettings("CompressEvents",
+                      std::make_unique<EnabledWhenProperty>("UpdateFileBackEnd",
+                                                            IS_EQUAL_TO, "0"));
   declareProperty(
       "SaveHistory", true,
       "Option to not save the Mantid history in the file. Only for MDHisto");
@@ -236,6 +244,8 @@ void SaveMD2::exec() {
                                 getProperty("UpdateFileBackEnd"));
     saveMDv1->setProperty<bool>("MakeFileBacked",
                                 getProperty("MakeFileBacked"));
+    saveMDv1->setProperty<bool>("CompressEvents",
+                                getProperty("CompressEvents"));
     saveMDv1->execute();
   } else if (histoWS) {
     this->doSaveHisto(histoWS);
@@ -1009,6 +1009,55 @@ public:
                binned->allBasisNormalized());
   }
 
+  void test_parallel_binning_matches_serial_binning() {
+    auto in_ws = MDEventsTestHelper::makeMDEW<3>(10, 0.0, 10.0, 0);
+    in_ws->getBoxController()->setSplitThreshold(100);
+    in_ws->splitAllIfNeeded(nullptr);
+    AnalysisDataService::Instance().addOrReplace("BinMDTest_in", in_ws);
+    FrameworkManager::Instance().exec("FakeMDEventData", 4, "InputWorkspace",
+                                      "BinMDTest_in", "UniformParams", "20000");
+
+    const auto bin = [](const bool parallel, const bool axisAligned) {
+      BinMD alg;
+      alg.initialize();
+      alg.setPropertyValue("InputWorkspace", "BinMDTest_in");
+      alg.setProperty("AxisAligned", axisAligned);
+      if (axisAligned) {
+        alg.setPropertyValue("AlignedDim0", "Axis0,1.0,9.0,17");
+        alg.setPropertyValue("AlignedDim1", "Axis1,0.0,10.0,5");
+        alg.setPropertyValue("AlignedDim2", "Axis2,2.5,7.5,3");
+      } else {
+        alg.setPropertyValue("BasisVector0", "x,m,0.8,0.6,0");
+        alg.setPropertyValue("BasisVector1", "y,m,-0.6,0.8,0");
+        alg.setPropertyValue("BasisVector2", "z,m,0,0,1");
+        alg.setPropertyValue("OutputExtents", "-5,12,-6,8,0,10");
+        alg.setPropertyValue("OutputBins", "17,7,5");
+      }
+      alg.setProperty("Parallel", parallel);
+      alg.setPropertyValue("OutputWorkspace", "BinMDTest_out");
+      alg.execute();
+      TS_ASSERT(alg.isExecuted());
+      return AnalysisDataService::Instance().retrieveWS<MDHistoWorkspace>(
+          "BinMDTest_out");
+    };
+
+    for (const bool axisAligned : {true, false}) {
+      auto serial = bin(false, axisAligned);
+      auto parallel = bin(true, axisAligned);
+      TS_ASSERT_EQUALS(serial->getNPoints(), parallel->getNPoints());
+      TS_ASSERT_DELTA(serial->getNEvents(), parallel->getNEvents(), 1e-6);
+      for (size_t i = 0; i < serial->getNPoints(); ++i) {
+        TS_ASSERT_DELTA(serial->getSignalAt(i), parallel->getSignalAt(i),
+                        1e-6);
+        TS_ASSERT_DELTA(serial->getErrorAt(i), parallel->getErrorAt(i), 1e-6);
+        TS_ASSERT_DELTA(serial->getNumEventsAt(i),
+                        parallel->getNumEventsAt(i), 1e-6);
+      }
+    }
+    AnalysisDataService::Instance().remove("BinMDTest_in");
+    AnalysisDataService::Instance().remove("BinMDTest_out");
+  }
+
   void test_filebackend_and_unrecognised_instrument() {
     // The algorithm should still successfully execute, even if the workspace is
     // file-backed and the named instrument doesn't exist
@@ -1164,4 +1213,9 @@ public:
     for (size_t i = 0; i < 1; i++)
       do_test("2.0,8.0, 1", true);
   }
+
+  void test_3D_200cube_IterateEvents() {
+    for (size_t i = 0; i < 1; i++)
+      do_test("0.0,10.0, 200", true);
+  }
 };
@@ -15,9 +15,13 @@
 
 #include <cxxtest/TestSuite.h>
 
+#include <array>
+#include <random>
+
 using namespace Mantid::API;
 using namespace Mantid::MDAlgorithms;
 using namespace Mantid::DataObjects;
+using Mantid::coord_t;
 using Mantid::Geometry::Instrument_sptr;
 using Mantid::Kernel::PropertyWithValue;
 
@@ -247,6 +251,80 @@ public:
 
     AnalysisDataService::Instance().remove("MDEWS");
   }
+
+  void test_PeakCentreGrid_rejects_only_candidates_inside_the_threshold() {
+    // Cells are a little wider than the threshold of 1
+    PeakCentreGrid grid(3, 1.0f);
+    const coord_t peak[3] = {0.5f, 0.5f, 0.5f};
+    TS_ASSERT(!grid.hasNeighbour(peak));
+    grid.add(peak);
+    TS_ASSERT(grid.hasNeighbour(peak));
+
+    // Exactly at the threshold, in the next cells
+    const coord_t atPlusX[3] = {1.5f, 0.5f, 0.5f};
+    const coord_t atMinusY[3] = {0.5f, -0.5f, 0.5f};
+    TS_ASSERT(!grid.hasNeighbour(atPlusX));
+    TS_ASSERT(!grid.hasNeighbour(atMinusY));
+    // Just inside, in the next cells
+    const coord_t insidePlusX[3] = {1.499f, 0.5f, 0.5f};
+    const coord_t insideMinusZ[3] = {0.5f, 0.5f, -0.499f};
+    TS_ASSERT(grid.hasNeighbour(insidePlusX));
+    TS_ASSERT(grid.hasNeighbour(insideMinusZ));
+    // Just inside, across a corner of the cells
+    const coord_t insideCorner[3] = {1.07f, 1.07f, 1.07f};
+    TS_ASSERT(grid.hasNeighbour(insideCorner));
+    // Far away
+    const coord_t far[3] = {2.6f, 0.5f, 0.5f};
+    TS_ASSERT(!grid.hasNeighbour(far));
+  }
+
+  void test_PeakCentreGrid_matches_brute_force() {
+    // Four dimensions, only the first three of which are hashed
+    constexpr size_t nd = 4;
+    const coord_t threshold = 0.5f;
+    const coord_t radiusSquared = threshold * threshold;
+    // Candidates on a lattice as wide as the threshold, to have many exactly
+    // at the threshold of each other, then at random across many cells
+    std::vector<std::array<coord_t, nd>> candidates;
+    for (int i = -3; i <= 3; ++i)
+      for (int j = -3; j <= 3; ++j)
+        candidates.push_back({static_cast<coord_t>(i) * threshold,
+                              static_cast<coord_t>(j) * threshold, 0.1f,
+                              0.f});
+    std::mt19937 generator(12345);
+    std::uniform_real_distribution<coord_t> position(-2.f, 2.f);
+    std::uniform_real_distribution<coord_t> fourth(-0.2f, 0.2f);
+    for (size_t i = 0; i < 2000; ++i)
+      candidates.push_back({position(generator), position(generator),
+                            position(generator), fourth(generator)});
+
+    // Accept the candidates in turn, as FindPeaksMD does
+    PeakCentreGrid grid(nd, radiusSquared);
+    std::vector<std::array<coord_t, nd>> accepted;
+    size_t rejected = 0;
+    for (const auto &candidate : candidates) {
+      bool expected = false;
+      for (const auto &peak : accepted) {
+        coord_t distSquared = 0.0;
+        for (size_t d = 0; d < nd; d++) {
+          coord_t dist = peak[d] - candidate[d];
+          distSquared += (dist * dist);
+        }
+        if (distSquared < radiusSquared)
+          expected = true;
+      }
+      TS_ASSERT_EQUALS(grid.hasNeighbour(candidate.data()), expected);
+      if (expected) {
+        ++rejected;
+      } else {
+        grid.add(candidate.data());
+        accepted.emplace_back(candidate);
+      }
+    }
+    // None of the lattice is rejected, but some of the others are
+    TS_ASSERT_LESS_THAN_EQUALS(49u, accepted.size());
+    TS_ASSERT_LESS_THAN(0u, rejected);
+  }
 };
 
 //=====================================================================================
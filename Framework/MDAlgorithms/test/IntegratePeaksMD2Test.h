@@ -387,6 +387,38 @@ public:
     TS_ASSERT_DELTA(newPW->getPeak(0).getIntensity(), 1000.0, 1e-2);
   }
 
+  //-------------------------------------------------------------------------------
+  void test_exec_many_peaks_out_of_spatial_order() {
+    // --- Fake workspace with peaks on a grid ------
+    createMDEW();
+    std::vector<V3D> centers;
+    for (int i = 0; i < 4; ++i)
+      for (int j = 0; j < 4; ++j)
+        for (int k = 0; k < 3; ++k)
+          centers.emplace_back(-6. + 4. * i, -6. + 4. * j, -4. + 4. * k);
+    for (size_t n = 0; n < centers.size(); ++n)
+      addPeak(100 + n, centers[n].X(), centers[n].Y(), centers[n].Z(), 0.2);
+
+    Instrument_sptr inst =
+        ComponentCreationHelper::createTestInstrumentCylindrical(5);
+    // List the peaks in an order unrelated to their positions
+    PeaksWorkspace_sptr peakWS(new PeaksWorkspace());
+    std::vector<size_t> listed;
+    for (size_t n = 0; n < centers.size(); ++n) {
+      listed.emplace_back((n * 29) % centers.size());
+      peakWS->addPeak(Peak(inst, 1, 1.0, centers[listed.back()]));
+    }
+    AnalysisDataService::Instance().addOrReplace("IntegratePeaksMD2Test_peaks",
+                                                 peakWS);
+
+    doRun(0.5, 0.0);
+
+    for (size_t n = 0; n < listed.size(); ++n)
+      TS_ASSERT_DELTA(peakWS->getPeak(static_cast<int>(n)).getIntensity(),
+                      static_cast<double>(100 + listed[n]), 1e-2);
+    AnalysisDataService::Instance().remove("IntegratePeaksMD2Test_peaks");
+  }
+
   //-------------------------------------------------------------------------------
   /// Integrate background between start/end background radius
   void test_exec_shellBackground() {
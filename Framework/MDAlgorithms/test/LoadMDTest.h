@@ -176,7 +176,8 @@ public:
   //=================================================================================================================
   template <size_t nd>
   void do_test_exec(bool FileBackEnd, bool deleteWorkspace = true,
-                    double memory = 0, bool BoxStructureOnly = false) {
+                    double memory = 0, bool BoxStructureOnly = false,
+                    bool CompressEvents = false) {
     using MDE = MDLeanEvent<nd>;
 
     //------ Start by creating the file
@@ -209,6 +210,8 @@ public:
         saver.setProperty("InputWorkspace", "LoadMDTest_ws"));
     TS_ASSERT_THROWS_NOTHING(saver.setPropertyValue(
         "Filename", "LoadMDTest" + Strings::toString(nd) + ".nxs"));
+    TS_ASSERT_THROWS_NOTHING(
+        saver.setProperty("CompressEvents", CompressEvents));
 
     // Retrieve the full path; delete any pre-existing file
     std::string filename = saver.getPropertyValue("Filename");
@@ -412,6 +415,16 @@ public:
     do_test_exec<3>(true, true, 1.0);
   }
 
+  /// Load compressed events directly to memory
+  void test_exec_3D_compressed() {
+    do_test_exec<3>(false, true, 0, false, true);
+  }
+
+  /// Keep compressed events on file and load on demand
+  void test_exec_3D_compressed_with_FileBackEnd_andSmallBuffer() {
+    do_test_exec<3>(true, true, 1.0, false, true);
+  }
+
   /** Use the file back end,
    * then change it and save to update the file at the back end.
    */
@@ -0,0 +1,128 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidMDAlgorithms/MDNormAccumulator.h"
+
+#include <cxxtest/TestSuite.h>
+
+using Mantid::signal_t;
+using Mantid::MDAlgorithms::MDNormAccumulator;
+using Strategy = Mantid::MDAlgorithms::MDNormAccumulator::Strategy;
+
+namespace {
+/// Add contributions to random elements from all threads, then sum them
+std::vector<signal_t> addContributions(const size_t size,
+                                       const Strategy strategy,
+                                       const int64_t numAdds,
+                                       const signal_t initial = 0.) {
+  MDNormAccumulator accumulator(size, PARALLEL_GET_MAX_THREADS, strategy);
+  TS_ASSERT_EQUALS(accumulator.strategy(), strategy);
+  PARALLEL_FOR_NO_WSP_CHECK()
+  for (int64_t i = 0; i < numAdds; ++i) {
+    // A multiplicative hash spreads the contributions over the array
+    const size_t index = static_cast<size_t>(i * 2654435761LL) % size;
+    accumulator.add(PARALLEL_THREAD_NUMBER, index, 0.5);
+  }
+  std::vector<signal_t> output(size, initial);
+  accumulator.addTo(output.data());
+  return output;
+}
+
+std::vector<signal_t> expectedSums(const size_t size, const int64_t numAdds,
+                                   const signal_t initial = 0.) {
+  std::vector<signal_t> output(size, initial);
+  for (int64_t i = 0; i < numAdds; ++i)
+    output[static_cast<size_t>(i * 2654435761LL) % size] += 0.5;
+  return output;
+}
+} // namespace
+
+class MDNormAccumulatorTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static MDNormAccumulatorTest *createSuite() {
+    return new MDNormAccumulatorTest();
+  }
+  static void destroySuite(MDNormAccumulatorTest *suite) { delete suite; }
+
+  void test_chooseStrategy() {
+    TS_ASSERT_EQUALS(MDNormAccumulator::chooseStrategy(1000, 8),
+                     Strategy::PerThread);
+    TS_ASSERT_EQUALS(
+        MDNormAccumulator::chooseStrategy(MDNormAccumulator::PER_THREAD_LIMIT,
+                                          1),
+        Strategy::PerThread);
+    TS_ASSERT_EQUALS(
+        MDNormAccumulator::chooseStrategy(MDNormAccumulator::PER_THREAD_LIMIT,
+                                          2),
+        Strategy::Tiled);
+    MDNormAccumulator accumulator(10, 4);
+    TS_ASSERT_EQUALS(accumulator.strategy(), Strategy::PerThread);
+  }
+
+  void test_strategies_give_the_same_sums() {
+    // Several elements per tile, with a partial last tile
+    const size_t size = 100 * MDNormAccumulator::MAX_TILES + 7;
+    const int64_t numAdds = 400000;
+    const auto sums = expectedSums(size, numAdds, 1.);
+    for (const auto strategy :
+         {Strategy::Atomic, Strategy::PerThread, Strategy::Tiled}) {
+      TS_ASSERT_EQUALS(addContributions(size, strategy, numAdds, 1.), sums);
+    }
+  }
+
+  void test_no_contributions() {
+    for (const auto strategy :
+         {Strategy::Atomic, Strategy::PerThread, Strategy::Tiled}) {
+      MDNormAccumulator accumulator(5, 2, strategy);
+      std::vector<signal_t> output(5, 2.);
+      accumulator.addTo(output.data());
+      TS_ASSERT_EQUALS(output, std::vector<signal_t>(5, 2.));
+    }
+  }
+};
+
+class MDNormAccumulatorTestPerformance : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static MDNormAccumulatorTestPerformance *createSuite() {
+    return new MDNormAccumulatorTestPerformance();
+  }
+  static void destroySuite(MDNormAccumulatorTestPerformance *suite) {
+    delete suite;
+  }
+
+  // A 50x50x50 HKL grid
+  void test_small_grid_Atomic() {
+    addContributions(SMALL, Strategy::Atomic, ADDS);
+  }
+  void test_small_grid_PerThread() {
+    addContributions(SMALL, Strategy::PerThread, ADDS);
+  }
+  void test_small_grid_Tiled() {
+    addContributions(SMALL, Strategy::Tiled, ADDS);
+  }
+
+  // A 400x400x100 HKL grid
+  void test_large_grid_Atomic() {
+    addContributions(LARGE, Strategy::Atomic, ADDS);
+  }
+  void test_large_grid_PerThread() {
+    addContributions(LARGE, Strategy::PerThread, ADDS);
+  }
+  void test_large_grid_Tiled() {
+    addContributions(LARGE, Strategy::Tiled, ADDS);
+  }
+
+private:
+  static constexpr size_t SMALL = 50 * 50 * 50;
+  static constexpr size_t LARGE = 400 * 400 * 100;
+  static constexpr int64_t ADDS = 20000000;
+};
@@ -0,0 +1,70 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include "MantidMDAlgorithms/MDNormCache.h"
+
+#include <cxxtest/TestSuite.h>
+
+using Mantid::signal_t;
+using Mantid::MDAlgorithms::MDNormCache;
+
+class MDNormCacheTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static MDNormCacheTest *createSuite() { return new MDNormCacheTest(); }
+  static void destroySuite(MDNormCacheTest *suite) { delete suite; }
+
+  void test_miss() {
+    MDNormCache cache;
+    std::vector<signal_t> normalization{1., 2.};
+    std::vector<bool> cached;
+    TS_ASSERT(!cache.lookup("setup", {"a", "b"}, normalization, cached));
+    TS_ASSERT_EQUALS(cached, std::vector<bool>(2, false));
+    TS_ASSERT_EQUALS(normalization, std::vector<signal_t>({1., 2.}));
+  }
+
+  void test_lookup_of_fewer_runs() {
+    MDNormCache cache;
+    cache.store("setup", {"a", "b", "a"}, {1., 2.});
+    std::vector<signal_t> normalization;
+    std::vector<bool> cached;
+    TS_ASSERT(
+        cache.lookup("setup", {"c", "a", "b", "a"}, normalization, cached));
+    TS_ASSERT_EQUALS(cached, std::vector<bool>({false, true, true, true}));
+    TS_ASSERT_EQUALS(normalization, std::vector<signal_t>({1., 2.}));
+  }
+
+  void test_not_used_if_a_run_is_missing() {
+    MDNormCache cache;
+    cache.store("setup", {"a", "b", "a"}, {1., 2.});
+    std::vector<signal_t> normalization;
+    std::vector<bool> cached;
+    TS_ASSERT(!cache.lookup("setup", {"a", "b"}, normalization, cached));
+    TS_ASSERT_EQUALS(cached, std::vector<bool>(2, false));
+    TS_ASSERT(!cache.lookup("other", {"a", "b", "a"}, normalization, cached));
+  }
+
+  void test_store_replaces_and_evicts_least_recently_used() {
+    MDNormCache cache(2);
+    cache.store("first", {"a"}, {1.});
+    cache.store("second", {"a"}, {2.});
+    cache.store("second", {"a", "b"}, {3.});
+    TS_ASSERT_EQUALS(cache.size(), 2);
+    std::vector<signal_t> normalization;
+    std::vector<bool> cached;
+    // Using the first entry makes the second one the oldest
+    TS_ASSERT(cache.lookup("first", {"a"}, normalization, cached));
+    cache.store("third", {"a"}, {4.});
+    TS_ASSERT_EQUALS(cache.size(), 2);
+    TS_ASSERT(cache.lookup("first", {"a"}, normalization, cached));
+    TS_ASSERT(!cache.lookup("second", {"a", "b"}, normalization, cached));
+    cache.clear();
+    TS_ASSERT_EQUALS(cache.size(), 0);
+  }
+};
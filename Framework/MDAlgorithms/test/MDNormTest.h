@@ -0,0 +1,175 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#pragma once
+
+#include <cxxtest/TestSuite.h>
+
+#include "MantidAPI/AlgorithmManager.h"
+#include "MantidAPI/AnalysisDataService.h"
+#include "MantidAPI/Axis.h"
+#include "MantidAPI/IMDEventWorkspace.h"
+#include "MantidAPI/IMDHistoWorkspace.h"
+#include "MantidAPI/Run.h"
+#include "MantidAPI/Sample.h"
+#include "MantidGeometry/Crystal/OrientedLattice.h"
+#include "MantidGeometry/Instrument/DetectorInfo.h"
+#include "MantidGeometry/Instrument/Goniometer.h"
+#include "MantidKernel/Matrix.h"
+#include "MantidKernel/V3D.h"
+#include "MantidMDAlgorithms/MDNorm.h"
+#include "MantidMDAlgorithms/MDNormCache.h"
+#include "MantidTestHelpers/InstrumentCreationHelper.h"
+#include "MantidTestHelpers/WorkspaceCreationHelper.h"
+
+#include <cmath>
+
+using Mantid::MDAlgorithms::MDNorm;
+using Mantid::MDAlgorithms::MDNormCache;
+using namespace Mantid::API;
+using namespace Mantid::Geometry;
+using Mantid::signal_t;
+using Mantid::Kernel::DblMatrix;
+using Mantid::Kernel::V3D;
+
+class MDNormTest : public CxxTest::TestSuite {
+public:
+  // This pair of boilerplate methods prevent the suite being created statically
+  // This means the constructor isn't called when running other tests
+  static MDNormTest *createSuite() { return new MDNormTest(); }
+  static void destroySuite(MDNormTest *suite) { delete suite; }
+
+  void test_Init() {
+    MDNorm alg;
+    TS_ASSERT_THROWS_NOTHING(alg.initialize())
+    TS_ASSERT(alg.isInitialized())
+  }
+
+  void test_cached_normalization_is_not_used_after_a_goniometer_change() {
+    createInputWorkspaces();
+    MDNormCache::instance().clear();
+
+    const auto first = normalization(true);
+    // Rotate the sample of the only run
+    auto md =
+        AnalysisDataService::Instance().retrieveWS<IMDEventWorkspace>("md");
+    Goniometer goniometer;
+    goniometer.pushAxis("omega", 0., 1., 0., 30.);
+    md->getExperimentInfo(0)->mutableRun().setGoniometer(goniometer, false);
+    const auto rotated = normalization(true);
+    const auto expected = normalization(false);
+    // Calling again without any change reuses the normalization
+    const auto reused = normalization(true);
+
+    TS_ASSERT_EQUALS(first.size(), expected.size());
+    TS_ASSERT_EQUALS(rotated.size(), expected.size());
+    TS_ASSERT_EQUALS(reused.size(), expected.size());
+    if (first.size() != expected.size() || rotated.size() != expected.size() ||
+        reused.size() != expected.size())
+      return;
+    size_t changed = 0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+      const double tolerance = 1e-10 * (1. + std::abs(expected[i]));
+      TS_ASSERT_DELTA(rotated[i], expected[i], tolerance);
+      TS_ASSERT_DELTA(reused[i], expected[i], tolerance);
+      if (std::abs(first[i] - expected[i]) > tolerance)
+        ++changed;
+    }
+    // The rotation moves the trajectories to other bins
+    TS_ASSERT_LESS_THAN(0u, changed);
+
+    MDNormCache::instance().clear();
+    AnalysisDataService::Instance().clear();
+  }
+
+private:
+  /// Create a run in Q_sample, with its flux and solid angle workspaces
+  void createInputWorkspaces() {
+    constexpr size_t numberOfDetectors = 9;
+    // Momentum from 2.5 to 10
+    auto ws = WorkspaceCreationHelper::create2DWorkspaceBinned(
+        numberOfDetectors, 15, 2.5, 0.5);
+    InstrumentCreationHelper::addFullInstrumentToWorkspace(*ws, false, false,
+                                                           "testInst");
+    ws->getAxis(0)->setUnit("Momentum");
+    // Spread the detectors in angle around the sample
+    auto &detectorInfo = ws->mutableDetectorInfo();
+    for (size_t i = 0; i < numberOfDetectors; ++i) {
+      const auto index = static_cast<double>(i);
+      const double twoTheta = (30. + 10. * index) * M_PI / 180.;
+      const double phi = 20. * index * M_PI / 180.;
+      detectorInfo.setPosition(
+          i, V3D(std::sin(twoTheta) * std::cos(phi),
+                 std::sin(twoTheta) * std::sin(phi), std::cos(twoTheta)) *
+                 5.);
+    }
+    auto &run = ws->mutableRun();
+    run.addProperty("MDNorm_low", std::vector<double>(numberOfDetectors, 2.5),
+                    true);
+    run.addProperty("MDNorm_high",
+                    std::vector<double>(numberOfDetectors, 10.), true);
+    run.setProtonCharge(1.);
+    run.setGoniometer(Goniometer(DblMatrix(3, 3, true)), false);
+    ws->mutableSample().setOrientedLattice(
+        std::make_unique<OrientedLattice>(5., 5., 5., 90., 90., 90.));
+
+    // Integrated flux rising linearly with momentum
+    auto flux = ws->clone();
+    for (size_t i = 0; i < numberOfDetectors; ++i) {
+      const auto &x = flux->x(i);
+      auto &y = flux->mutableY(i);
+      for (size_t j = 0; j < y.size(); ++j)
+        y[j] = x[j + 1] - x.front();
+    }
+    AnalysisDataService::Instance().addOrReplace("flux", std::move(flux));
+    AnalysisDataService::Instance().addOrReplace("solidAngle", ws->clone());
+
+    auto convert = AlgorithmManager::Instance().createUnmanaged("ConvertToMD");
+    convert->initialize();
+    convert->setChild(true);
+    convert->setProperty("InputWorkspace", ws);
+    convert->setProperty("QDimensions", "Q3D");
+    convert->setProperty("dEAnalysisMode", "Elastic");
+    convert->setProperty("Q3DFrames", "Q_sample");
+    convert->setPropertyValue("MinValues", "-20,-20,-20");
+    convert->setPropertyValue("MaxValues", "20,20,20");
+    convert->setPropertyValue("OutputWorkspace", "md");
+    TS_ASSERT_THROWS_NOTHING(convert->execute());
+    IMDEventWorkspace_sptr md = convert->getProperty("OutputWorkspace");
+    AnalysisDataService::Instance().addOrReplace("md", md);
+  }
+
+  /// @return the signal of the normalization computed by MDNorm
+  std::vector<signal_t> normalization(const bool useCache) {
+    MDNorm alg;
+    alg.initialize();
+    alg.setRethrows(true);
+    TS_ASSERT_THROWS_NOTHING(alg.setPropertyValue("InputWorkspace", "md"));
+    TS_ASSERT_THROWS_NOTHING(
+        alg.setPropertyValue("SolidAngleWorkspace", "solidAngle"));
+    TS_ASSERT_THROWS_NOTHING(alg.setPropertyValue("FluxWorkspace", "flux"));
+    for (const auto name : {"Dimension0Binning", "Dimension1Binning",
+                            "Dimension2Binning"})
+      TS_ASSERT_THROWS_NOTHING(alg.setPropertyValue(name, "-10,1,10"));
+    TS_ASSERT_THROWS_NOTHING(
+        alg.setProperty("UseNormalizationCache", useCache));
+    TS_ASSERT_THROWS_NOTHING(alg.setPropertyValue("OutputWorkspace", "out"));
+    TS_ASSERT_THROWS_NOTHING(
+        alg.setPropertyValue("OutputDataWorkspace", "outData"));
+    TS_ASSERT_THROWS_NOTHING(
+        alg.setPropertyValue("OutputNormalizationWorkspace", "outNorm"));
+    TS_ASSERT_THROWS_NOTHING(alg.execute());
+    TS_ASSERT(alg.isExecuted());
+
+    const auto norm =
+        AnalysisDataService::Instance().retrieveWS<IMDHistoWorkspace>(
+            "outNorm");
+    if (!norm)
+      return {};
+    const signal_t *signal = norm->getSignalArray();
+    return std::vector<signal_t>(signal, signal + norm->getNPoints());
+  }
+};
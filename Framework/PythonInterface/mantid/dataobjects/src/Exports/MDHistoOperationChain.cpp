@@ -0,0 +1,100 @@
+// Mantid Repository : https://github.com/mantidproject/mantid
+//
+// Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+//   NScD Oak Ridge National Laboratory, European Spallation Source,
+//   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+// SPDX - License - Identifier: GPL - 3.0 +
+#include "MantidDataObjects/MDHistoOperationChain.h"
+#include "MantidDataObjects/MDHistoWorkspace.h"
+
+#include <boost/python/class.hpp>
+#include <boost/python/return_arg.hpp>
+#include <boost/python/with_custodian_and_ward.hpp>
+
+using Mantid::signal_t;
+using Mantid::DataObjects::MDHistoOperationChain;
+using Mantid::DataObjects::MDHistoWorkspace;
+using namespace boost::python;
+
+namespace {
+using Chain = MDHistoOperationChain;
+using WorkspaceStep = Chain &(Chain::*)(const MDHistoWorkspace &);
+using ScalarStep = Chain &(Chain::*)(const signal_t, const signal_t);
+using ThresholdStep = Chain &(Chain::*)(const signal_t);
+
+/// Return the chain, keeping the workspace operand alive as long as the chain
+using KeepOperand = return_self<with_custodian_and_ward<1, 2>>;
+} // namespace
+
+void export_MDHistoOperationChain() {
+  class_<Chain, boost::noncopyable>(
+      "MDHistoOperationChain",
+      "A chain of operations on the bins of an MDHistoWorkspace, run in a "
+      "single pass over the workspace by applyTo, without creating "
+      "intermediate workspaces.")
+      .def("add", static_cast<WorkspaceStep>(&Chain::add), KeepOperand(),
+           (arg("self"), arg("rhs")), "Add a workspace")
+      .def("add", static_cast<ScalarStep>(&Chain::add), return_self<>(),
+           (arg("self"), arg("signal"), arg("error")),
+           "Add a scalar with an error")
+      .def("subtract", static_cast<WorkspaceStep>(&Chain::subtract),
+           KeepOperand(), (arg("self"), arg("rhs")), "Subtract a workspace")
+      .def("subtract", static_cast<ScalarStep>(&Chain::subtract),
+           return_self<>(), (arg("self"), arg("signal"), arg("error")),
+           "Subtract a scalar with an error")
+      .def("multiply", static_cast<WorkspaceStep>(&Chain::multiply),
+           KeepOperand(), (arg("self"), arg("rhs")), "Multiply by a workspace")
+      .def("multiply", static_cast<ScalarStep>(&Chain::multiply),
+           return_self<>(), (arg("self"), arg("signal"), arg("error")),
+           "Multiply by a scalar with an error")
+      .def("divide", static_cast<WorkspaceStep>(&Chain::divide),
+           KeepOperand(), (arg("self"), arg("rhs")), "Divide by a workspace")
+      .def("divide", static_cast<ScalarStep>(&Chain::divide), return_self<>(),
+           (arg("self"), arg("signal"), arg("error")),
+           "Divide by a scalar with an error")
+      .def("log", &Chain::log, return_self<>(),
+           (arg("self"), arg("filler") = 0.0),
+           "Take the natural logarithm, setting bins of zero to filler")
+      .def("log10", &Chain::log10, return_self<>(),
+           (arg("self"), arg("filler") = 0.0),
+           "Take the base 10 logarithm, setting bins of zero to filler")
+      .def("exp", &Chain::exp, return_self<>(), arg("self"),
+           "Take the exponential")
+      .def("power", &Chain::power, return_self<>(),
+           (arg("self"), arg("exponent")), "Raise to a power")
+      .def("operatorAnd", &Chain::operatorAnd, KeepOperand(),
+           (arg("self"), arg("rhs")), "Boolean and with a workspace")
+      .def("operatorOr", &Chain::operatorOr, KeepOperand(),
+           (arg("self"), arg("rhs")), "Boolean or with a workspace")
+      .def("operatorXor", &Chain::operatorXor, KeepOperand(),
+           (arg("self"), arg("rhs")), "Boolean xor with a workspace")
+      .def("operatorNot", &Chain::operatorNot, return_self<>(), arg("self"),
+           "Boolean not")
+      .def("lessThan", static_cast<WorkspaceStep>(&Chain::lessThan),
+           KeepOperand(), (arg("self"), arg("rhs")),
+           "1 where the signal is less than that of a workspace, 0 elsewhere")
+      .def("lessThan", static_cast<ThresholdStep>(&Chain::lessThan),
+           return_self<>(), (arg("self"), arg("signal")),
+           "1 where the signal is less than a scalar, 0 elsewhere")
+      .def("greaterThan", static_cast<WorkspaceStep>(&Chain::greaterThan),
+           KeepOperand(), (arg("self"), arg("rhs")),
+           "1 where the signal is greater than that of a workspace, 0 "
+           "elsewhere")
+      .def("greaterThan", static_cast<ThresholdStep>(&Chain::greaterThan),
+           return_self<>(), (arg("self"), arg("signal")),
+           "1 where the signal is greater than a scalar, 0 elsewhere")
+      .def("equalTo",
+           static_cast<Chain &(Chain::*)(const MDHistoWorkspace &,
+                                         const signal_t)>(&Chain::equalTo),
+           KeepOperand(), (arg("self"), arg("rhs"), arg("tolerance") = 1e-5),
+           "1 where the signal is equal to that of a workspace, 0 elsewhere")
+      .def("equalTo",
+           static_cast<Chain &(Chain::*)(const signal_t, const signal_t)>(
+               &Chain::equalTo),
+           return_self<>(),
+           (arg("self"), arg("signal"), arg("tolerance") = 1e-5),
+           "1 where the signal is equal to a scalar, 0 elsewhere")
+      .def("applyTo", &Chain::applyTo, (arg("self"), arg("workspace")),
+           "Run the chain on the bins of a workspace, in place")
+      .def("__len__", &Chain::size, arg("self"));
+}
@@ -0,0 +1,74 @@
+# Mantid Repository : https://github.com/mantidproject/mantid
+#
+# Copyright &copy; 2021 ISIS Rutherford Appleton Laboratory UKRI,
+#   NScD Oak Ridge National Laboratory, European Spallation Source,
+#   Institut Laue - Langevin & CSNS, Institute of High Energy Physics, CAS
+# SPDX - License - Identifier: GPL - 3.0 +
+import gc
+import unittest
+import numpy as np
+
+from mantid.dataobjects import MDHistoOperationChain
+from mantid.simpleapi import CreateMDHistoWorkspace, DeleteWorkspace, mtd
+
+
+def create_workspace(name, signal, error, bins='3,4'):
+    return CreateMDHistoWorkspace(SignalInput=signal, ErrorInput=error, Dimensionality=2,
+                                  Extents='-1,1,-1,1', NumberOfBins=bins, Names='A,B',
+                                  Units='U,U', OutputWorkspace=name)
+
+
+class MDHistoOperationChainTest(unittest.TestCase):
+
+    def setUp(self):
+        self.sa = np.arange(4.0, 16.0)
+        self.sb = np.linspace(0.5, 2.0, 12)
+        self.sc = np.linspace(1.0, 3.0, 12)
+        self.ea = np.full(12, 0.5)
+        self.eb = np.full(12, 0.2)
+        self.ec = np.full(12, 0.1)
+        self.a = create_workspace('a', self.sa, self.ea)
+        self.b = create_workspace('b', self.sb, self.eb)
+        self.c = create_workspace('c', self.sc, self.ec)
+
+    def tearDown(self):
+        mtd.clear()
+
+    def test_chain_of_several_steps(self):
+        chain = MDHistoOperationChain().subtract(self.b).divide(self.c).multiply(2.0, 0.0).power(2.0)
+        self.assertEqual(len(chain), 4)
+        chain.applyTo(self.a)
+
+        # (a - b) / c * 2, then squared, with the error propagation of the single operations
+        f1 = self.sa - self.sb
+        e1 = self.ea**2 + self.eb**2
+        f2 = f1 / self.sc
+        e2 = e1 / self.sc**2 + self.ec**2 * f2**2 / self.sc**2
+        f3 = 2.0 * f2
+        e3 = 4.0 * e2
+        f4 = f3**2
+        e4 = f4**2 * 4.0 * e3 / f3**2
+        signal = self.a.getSignalArray().flatten(order='F')
+        errorSquared = self.a.getErrorSquaredArray().flatten(order='F')
+        np.testing.assert_allclose(signal, f4, rtol=1e-12)
+        np.testing.assert_allclose(errorSquared, e4, rtol=1e-12)
+
+    def test_chain_keeps_its_operands_alive(self):
+        chain = MDHistoOperationChain().add(self.b).add(self.b)
+        DeleteWorkspace('b')
+        del self.b
+        gc.collect()
+        chain.applyTo(self.a)
+        signal = self.a.getSignalArray().flatten(order='F')
+        np.testing.assert_allclose(signal, self.sa + 2.0 * self.sb, rtol=1e-12)
+
+    def test_workspaces_of_another_size_are_refused(self):
+        other = create_workspace('other', np.ones(6), np.ones(6), bins='3,2')
+        chain = MDHistoOperationChain().add(1.0, 0.0).multiply(other)
+        self.assertRaises(ValueError, chain.applyTo, self.a)
+        # Nothing was done
+        np.testing.assert_array_equal(self.a.getSignalArray().flatten(order='F'), self.sa)
+
+
+if __name__ == '__main__':
+    unittest.main()